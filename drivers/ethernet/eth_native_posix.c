@@ -66,6 +66,13 @@ struct eth_context {
 #if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK)
 	const struct device *ptp_clock;
 #endif
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM)
+	struct k_spinlock ptp_lock;
+	/* Simulated clock is ptp_base + (host - ptp_host_base) * ptp_ratio */
+	uint64_t ptp_host_base;
+	uint64_t ptp_base;
+	double ptp_ratio;
+#endif
 };
 
 #define DEFINE_RX_THREAD(x, _)						\
@@ -146,14 +153,63 @@ static void update_pkt_priority(struct gptp_hdr *hdr, struct net_pkt *pkt)
 	}
 }
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM)
+static uint64_t ptp_time_to_ns(struct net_ptp_time *tm)
+{
+	return tm->second * NSEC_PER_SEC + tm->nanosecond;
+}
+
+/* Must be called with ptp_lock held. Moves the base of the simulated
+ * clock to the current host time and returns the simulated time.
+ */
+static uint64_t ptp_sim_rebase(struct eth_context *ctx, uint64_t host)
+{
+	int64_t elapsed = host - ctx->ptp_host_base;
+
+	ctx->ptp_base += (int64_t)(elapsed * ctx->ptp_ratio);
+	ctx->ptp_host_base = host;
+
+	return ctx->ptp_base;
+}
+
+static int eth_ptp_gettime(struct eth_context *ctx, struct net_ptp_time *tm)
+{
+	k_spinlock_key_t key;
+	uint64_t now;
+	int ret;
+
+	ret = eth_clock_gettime(tm);
+	if (ret < 0) {
+		return ret;
+	}
+
+	key = k_spin_lock(&ctx->ptp_lock);
+	now = ptp_sim_rebase(ctx, ptp_time_to_ns(tm));
+	k_spin_unlock(&ctx->ptp_lock, key);
+
+	tm->second = now / NSEC_PER_SEC;
+	tm->nanosecond = now % NSEC_PER_SEC;
+
+	return 0;
+}
+#else
+static int eth_ptp_gettime(struct eth_context *ctx, struct net_ptp_time *tm)
+{
+	ARG_UNUSED(ctx);
+
+	return eth_clock_gettime(tm);
+}
+#endif /* CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM */
+
 static void update_gptp(struct net_if *iface, struct net_pkt *pkt,
 			bool send)
 {
+	struct eth_context *ctx = net_if_get_device(iface)->data;
 	struct net_ptp_time timestamp;
 	struct gptp_hdr *hdr;
 	int ret;
 
-	ret = eth_clock_gettime(&timestamp);
+	ret = eth_ptp_gettime(ctx, &timestamp);
 	if (ret < 0) {
 		return;
 	}
@@ -660,6 +716,106 @@ struct ptp_context {
 
 UTIL_LISTIFY(CONFIG_ETH_NATIVE_POSIX_INTERFACE_COUNT, DEFINE_PTP_DEV_DATA, _)
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM)
+static int ptp_clock_set_native_posix(const struct device *clk,
+				      struct net_ptp_time *tm)
+{
+	struct ptp_context *ptp_context = clk->data;
+	struct eth_context *ctx = ptp_context->eth_context;
+	struct net_ptp_time host;
+	k_spinlock_key_t key;
+	int ret;
+
+	ret = eth_clock_gettime(&host);
+	if (ret < 0) {
+		return ret;
+	}
+
+	key = k_spin_lock(&ctx->ptp_lock);
+	ctx->ptp_host_base = ptp_time_to_ns(&host);
+	ctx->ptp_base = ptp_time_to_ns(tm);
+	k_spin_unlock(&ctx->ptp_lock, key);
+
+	return 0;
+}
+
+static int ptp_clock_get_native_posix(const struct device *clk,
+				      struct net_ptp_time *tm)
+{
+	struct ptp_context *ptp_context = clk->data;
+
+	return eth_ptp_gettime(ptp_context->eth_context, tm);
+}
+
+static int ptp_clock_adjust_native_posix(const struct device *clk,
+					 int increment)
+{
+	struct ptp_context *ptp_context = clk->data;
+	struct eth_context *ctx = ptp_context->eth_context;
+	struct net_ptp_time host;
+	k_spinlock_key_t key;
+	int ret;
+
+	if ((increment <= (int32_t)(-NSEC_PER_SEC)) ||
+	    (increment >= (int32_t)NSEC_PER_SEC)) {
+		return -EINVAL;
+	}
+
+	ret = eth_clock_gettime(&host);
+	if (ret < 0) {
+		return ret;
+	}
+
+	key = k_spin_lock(&ctx->ptp_lock);
+	ptp_sim_rebase(ctx, ptp_time_to_ns(&host));
+	ctx->ptp_base += increment;
+	k_spin_unlock(&ctx->ptp_lock, key);
+
+	return 0;
+}
+
+static int ptp_clock_rate_adjust_native_posix(const struct device *clk,
+					      float ratio)
+{
+	struct ptp_context *ptp_context = clk->data;
+	struct eth_context *ctx = ptp_context->eth_context;
+	struct net_ptp_time host;
+	k_spinlock_key_t key;
+	int ret;
+
+	if (ratio <= 0.0f) {
+		return -EINVAL;
+	}
+
+	ret = eth_clock_gettime(&host);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The ratio is relative to the current rate of the clock. */
+	key = k_spin_lock(&ctx->ptp_lock);
+	ptp_sim_rebase(ctx, ptp_time_to_ns(&host));
+	ctx->ptp_ratio *= ratio;
+	k_spin_unlock(&ctx->ptp_lock, key);
+
+	return 0;
+}
+
+static void ptp_sim_init(struct eth_context *ctx)
+{
+	struct net_ptp_time host;
+
+	if (eth_clock_gettime(&host) < 0) {
+		host.second = 0;
+		host.nanosecond = 0;
+	}
+
+	ctx->ptp_host_base = ptp_time_to_ns(&host);
+	ctx->ptp_base = ctx->ptp_host_base;
+	ctx->ptp_ratio = 1.0 +
+		CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM_DRIFT_PPB / 1000000000.0;
+}
+#else
 static int ptp_clock_set_native_posix(const struct device *clk,
 				      struct net_ptp_time *tm)
 {
@@ -707,6 +863,9 @@ static int ptp_clock_rate_adjust_native_posix(const struct device *clk,
 	return 0;
 }
 
+#define ptp_sim_init(ctx)
+#endif /* CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SIM */
+
 static const struct ptp_clock_driver_api api = {
 	.set = ptp_clock_set_native_posix,
 	.get = ptp_clock_get_native_posix,
@@ -723,6 +882,7 @@ static const struct ptp_clock_driver_api api = {
 									\
 		context->ptp_clock = port;				\
 		ptp_context->eth_context = context;			\
+		ptp_sim_init(context);					\
 									\
 		return 0;						\
 	}
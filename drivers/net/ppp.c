@@ -28,7 +28,6 @@ LOG_MODULE_REGISTER(net_ppp, LOG_LEVEL);
 #include <net/net_if.h>
 #include <net/net_core.h>
 #include <sys/ring_buffer.h>
-#include <sys/crc.h>
 #include <drivers/uart.h>
 #include <drivers/console/uart_mux.h>
 #include <random/rand32.h>
@@ -36,7 +35,17 @@ LOG_MODULE_REGISTER(net_ppp, LOG_LEVEL);
 #include "../../subsys/net/ip/net_stats.h"
 #include "../../subsys/net/ip/net_private.h"
 
+#include "ppp_hdlc.h"
+
 #define UART_BUF_LEN CONFIG_NET_PPP_UART_BUF_LEN
+#define TX_BUF_LEN CONFIG_NET_PPP_TX_BUF_LEN
+
+#if defined(CONFIG_NET_PPP_ASYNC_UART)
+/* One buffer is filled while the other one is being sent */
+#define TX_BUF_COUNT 2
+#else
+#define TX_BUF_COUNT 1
+#endif
 
 enum ppp_driver_state {
 	STATE_HDLC_FRAME_START,
@@ -62,8 +71,23 @@ struct ppp_driver_context {
 	/* ppp data is read into this buf */
 	uint8_t buf[UART_BUF_LEN];
 
-	/* ppp buf use when sending data */
-	uint8_t send_buf[UART_BUF_LEN];
+	/* ppp bufs used when sending data */
+	uint8_t send_bufs[TX_BUF_COUNT][TX_BUF_LEN];
+
+	/* The send buf currently being filled */
+	uint8_t *send_buf;
+
+#if defined(CONFIG_NET_PPP_ASYNC_UART)
+	/* The UART driver receives to these buffers in turns */
+	uint8_t async_rx_bufs[2][CONFIG_NET_PPP_ASYNC_UART_RX_BUF_LEN];
+	uint8_t async_rx_next;
+
+	/* Available when no transmission is in progress */
+	struct k_sem async_tx_sem;
+#endif
+
+	/* FCS of the data received so far */
+	uint16_t fcs;
 
 	uint8_t mac_addr[6];
 	struct net_linkaddr ll_addr;
@@ -95,8 +119,10 @@ struct ppp_driver_context {
 
 static struct ppp_driver_context ppp_driver_context_data;
 
-static int ppp_save_byte(struct ppp_driver_context *ppp, uint8_t byte)
+static int ppp_save_data(struct ppp_driver_context *ppp,
+			 const uint8_t *data, size_t len)
 {
+	size_t chunk;
 	int ret;
 
 	if (!ppp->pkt) {
@@ -112,39 +138,50 @@ static int ppp_save_byte(struct ppp_driver_context *ppp, uint8_t byte)
 		net_pkt_cursor_init(ppp->pkt);
 
 		ppp->available = net_pkt_available_buffer(ppp->pkt);
+		ppp->fcs = PPP_HDLC_FCS_INIT;
 	}
 
 	/* Extra debugging can be enabled separately if really
 	 * needed. Normally it would just print too much data.
 	 */
 	if (0) {
-		LOG_DBG("Saving byte %02x", byte);
+		LOG_HEXDUMP_DBG(data, len, "Saving data");
 	}
 
-	/* This is not very intuitive but we must allocate new buffer
-	 * before we write a byte to last available cursor position.
-	 */
-	if (ppp->available == 1) {
-		ret = net_pkt_alloc_buffer(ppp->pkt,
-					   CONFIG_NET_BUF_DATA_SIZE,
-					   AF_UNSPEC, K_NO_WAIT);
-		if (ret < 0) {
-			LOG_ERR("[%p] cannot allocate new data buffer", ppp);
-			goto out_of_mem;
+	/* The FCS is calculated while the data is still in cache */
+	if (IS_ENABLED(CONFIG_NET_PPP_VERIFY_FCS)) {
+		ppp->fcs = ppp_hdlc_fcs(ppp->fcs, data, len);
+	}
+
+	while (len > 0) {
+		/* This is not very intuitive but we must allocate new buffer
+		 * before we write a byte to last available cursor position.
+		 */
+		if (ppp->available <= 1) {
+			ret = net_pkt_alloc_buffer(ppp->pkt,
+						   CONFIG_NET_BUF_DATA_SIZE,
+						   AF_UNSPEC, K_NO_WAIT);
+			if (ret < 0) {
+				LOG_ERR("[%p] cannot allocate new data buffer",
+					ppp);
+				goto out_of_mem;
+			}
+
+			ppp->available = net_pkt_available_buffer(ppp->pkt);
 		}
 
-		ppp->available = net_pkt_available_buffer(ppp->pkt);
-	}
+		chunk = MIN(len, ppp->available - 1);
 
-	if (ppp->available) {
-		ret = net_pkt_write_u8(ppp->pkt, byte);
+		ret = net_pkt_write(ppp->pkt, data, chunk);
 		if (ret < 0) {
 			LOG_ERR("[%p] Cannot write to pkt %p (%d)",
 				ppp, ppp->pkt, ret);
 			goto out_of_mem;
 		}
 
-		ppp->available--;
+		ppp->available -= chunk;
+		data += chunk;
+		len -= chunk;
 	}
 
 	return 0;
@@ -192,6 +229,32 @@ static void ppp_change_state(struct ppp_driver_context *ctx,
 	ctx->state = new_state;
 }
 
+#if defined(CONFIG_NET_PPP_ASYNC_UART) && !defined(CONFIG_NET_TEST)
+static int ppp_send_flush(struct ppp_driver_context *ppp, int off)
+{
+	int ret;
+
+	if (off == 0) {
+		return 0;
+	}
+
+	/* Wait until the other buffer has been sent */
+	k_sem_take(&ppp->async_tx_sem, K_FOREVER);
+
+	ret = uart_tx(ppp->dev, ppp->send_buf, off, SYS_FOREVER_MS);
+	if (ret < 0) {
+		LOG_ERR("[%p] Cannot send %d bytes (%d)", ppp, off, ret);
+		k_sem_give(&ppp->async_tx_sem);
+		return 0;
+	}
+
+	/* Continue filling the other buffer while this one is sent */
+	ppp->send_buf = (ppp->send_buf == ppp->send_bufs[0]) ?
+		ppp->send_bufs[1] : ppp->send_bufs[0];
+
+	return 0;
+}
+#else
 static int ppp_send_flush(struct ppp_driver_context *ppp, int off)
 {
 	if (IS_ENABLED(CONFIG_NET_TEST)) {
@@ -214,16 +277,43 @@ static int ppp_send_flush(struct ppp_driver_context *ppp, int off)
 
 	return 0;
 }
+#endif /* CONFIG_NET_PPP_ASYNC_UART && !CONFIG_NET_TEST */
 
 static int ppp_send_bytes(struct ppp_driver_context *ppp,
 			  const uint8_t *data, int len, int off)
 {
-	int i;
+	int chunk;
+
+	while (len > 0) {
+		chunk = MIN(len, TX_BUF_LEN - off);
+
+		memcpy(&ppp->send_buf[off], data, chunk);
+		off += chunk;
+		data += chunk;
+		len -= chunk;
+
+		if (off >= TX_BUF_LEN) {
+			off = ppp_send_flush(ppp, off);
+		}
+	}
+
+	return off;
+}
+
+/* Escape the data to the send buffer, RFC 1662 ch. 4.2 */
+static int ppp_send_escaped(struct ppp_driver_context *ppp,
+			    const uint8_t *data, size_t len, int off)
+{
+	size_t consumed;
 
-	for (i = 0; i < len; i++) {
-		ppp->send_buf[off++] = data[i];
+	while (len > 0) {
+		off += ppp_hdlc_escape(&ppp->send_buf[off], TX_BUF_LEN - off,
+				       data, len, &consumed);
+		data += consumed;
+		len -= consumed;
 
-		if (off >= sizeof(ppp->send_buf)) {
+		/* Flush if there is no room left for an escaped byte */
+		if (TX_BUF_LEN - off < 2) {
 			off = ppp_send_flush(ppp, off);
 		}
 	}
@@ -308,7 +398,7 @@ static int ppp_input_byte(struct ppp_driver_context *ppp, uint8_t byte)
 			 * the FCS. The address field will not be passed
 			 * to upper stack.
 			 */
-			ret = ppp_save_byte(ppp, byte);
+			ret = ppp_save_data(ppp, &byte, 1);
 			if (ret < 0) {
 				ppp_change_state(ppp, STATE_HDLC_FRAME_START);
 			}
@@ -339,7 +429,7 @@ static int ppp_input_byte(struct ppp_driver_context *ppp, uint8_t byte)
 				ppp->next_escaped = false;
 			}
 
-			ret = ppp_save_byte(ppp, byte);
+			ret = ppp_save_data(ppp, &byte, 1);
 			if (ret < 0) {
 				ppp_change_state(ppp, STATE_HDLC_FRAME_START);
 			}
@@ -357,27 +447,49 @@ static int ppp_input_byte(struct ppp_driver_context *ppp, uint8_t byte)
 	return ret;
 }
 
-static bool ppp_check_fcs(struct ppp_driver_context *ppp)
+/* Handle received data until the end of a frame. Inside a frame, the runs
+ * of bytes that need no unescaping are saved at once, the rest is handled
+ * byte by byte. Returns the number of bytes consumed, frame_end is set if
+ * the last of them ended a frame.
+ */
+static size_t ppp_input_data(struct ppp_driver_context *ppp,
+			     const uint8_t *data, size_t len, bool *frame_end)
 {
-	struct net_buf *buf;
-	uint16_t crc;
+	size_t i = 0, run;
 
-	buf = ppp->pkt->buffer;
-	if (!buf) {
-		return false;
-	}
+	*frame_end = false;
 
-	crc = crc16_ccitt(0xffff, buf->data, buf->len);
+	while (i < len) {
+		if (ppp->state == STATE_HDLC_FRAME_DATA && !ppp->next_escaped) {
+			run = ppp_hdlc_scan_rx(&data[i], len - i);
+			if (run > 0) {
+				if (ppp_save_data(ppp, &data[i], run) < 0) {
+					ppp_change_state(ppp,
+							 STATE_HDLC_FRAME_START);
+				}
 
-	buf = buf->frags;
+				i += run;
+				continue;
+			}
+		}
 
-	while (buf) {
-		crc = crc16_ccitt(crc, buf->data, buf->len);
-		buf = buf->frags;
+		if (ppp_input_byte(ppp, data[i++]) == 0) {
+			*frame_end = true;
+			break;
+		}
+	}
+
+	return i;
+}
+
+static bool ppp_check_fcs(struct ppp_driver_context *ppp)
+{
+	if (!ppp->pkt->buffer) {
+		return false;
 	}
 
-	if (crc != 0xf0b8) {
-		LOG_DBG("Invalid FCS (0x%x)", crc);
+	if (ppp->fcs != PPP_HDLC_FCS_GOOD) {
+		LOG_DBG("Invalid FCS (0x%x)", ppp->fcs);
 #if defined(CONFIG_NET_STATISTICS_PPP)
 		ppp->stats.chkerr++;
 #endif
@@ -439,31 +551,23 @@ static uint8_t *ppp_recv_cb(uint8_t *buf, size_t *off)
 {
 	struct ppp_driver_context *ppp =
 		CONTAINER_OF(buf, struct ppp_driver_context, buf);
-	size_t i, len = *off;
+	size_t i = 0, len = *off;
+	bool frame_end;
 
-	for (i = 0; i < *off; i++) {
-		if (0) {
-			/* Extra debugging can be enabled separately if really
-			 * needed. Normally it would just print too much data.
-			 */
-			LOG_DBG("[%zd] %02x", i, buf[i]);
-		}
+	while (i < len) {
+		i += ppp_input_data(ppp, &buf[i], len - i, &frame_end);
 
-		if (ppp_input_byte(ppp, buf[i]) == 0) {
-			/* Ignore empty or too short frames */
-			if (ppp->pkt && net_pkt_get_len(ppp->pkt) > 3) {
-				ppp_process_msg(ppp);
-				break;
-			}
+		/* Ignore empty or too short frames */
+		if (frame_end && ppp->pkt && net_pkt_get_len(ppp->pkt) > 3) {
+			ppp_process_msg(ppp);
+			break;
 		}
 	}
 
-	if (i == *off) {
-		*off = 0;
-	} else {
-		*off = len - i - 1;
+	*off = len - i;
 
-		memmove(&buf[0], &buf[i + 1], *off);
+	if (*off > 0) {
+		memmove(&buf[0], &buf[i], *off);
 	}
 
 	return buf;
@@ -503,59 +607,17 @@ void ppp_driver_feed_data(uint8_t *data, int data_len)
 }
 #endif
 
-static bool calc_fcs(struct net_pkt *pkt, uint16_t *fcs, uint16_t protocol)
-{
-	struct net_buf *buf;
-	uint16_t crc;
-	uint16_t c;
-
-	buf = pkt->buffer;
-	if (!buf) {
-		return false;
-	}
-
-	/* HDLC Address and Control fields */
-	c = sys_cpu_to_be16(0xff << 8 | 0x03);
-
-	crc = crc16_ccitt(0xffff, (const uint8_t *)&c, sizeof(c));
-
-	if (protocol > 0) {
-		crc = crc16_ccitt(crc, (const uint8_t *)&protocol,
-				  sizeof(protocol));
-	}
-
-	while (buf) {
-		crc = crc16_ccitt(crc, buf->data, buf->len);
-		buf = buf->frags;
-	}
-
-	crc ^= 0xffff;
-	*fcs = crc;
-
-	return true;
-}
-
-static uint16_t ppp_escape_byte(uint8_t byte, int *offset)
-{
-	if (byte == 0x7e || byte == 0x7d || byte < 0x20) {
-		*offset = 0;
-		return (0x7d << 8) | (byte ^ 0x20);
-	}
-
-	*offset = 1;
-	return byte;
-}
-
 static int ppp_send(const struct device *dev, struct net_pkt *pkt)
 {
+	static const uint8_t addr_ctrl[] = { 0xff, 0x03 };
 	struct ppp_driver_context *ppp = dev->data;
 	struct net_buf *buf = pkt->buffer;
 	uint16_t protocol = 0;
 	int send_off = 0;
 	uint32_t sync_addr_ctrl;
-	uint16_t fcs, escaped;
+	uint16_t fcs;
+	uint8_t fcs_bytes[2];
 	uint8_t byte;
-	int i, offset;
 
 #if defined(CONFIG_NET_TEST)
 	return 0;
@@ -595,26 +657,20 @@ static int ppp_send(const struct device *dev, struct net_pkt *pkt)
 		}
 	}
 
-	if (!calc_fcs(pkt, &fcs, protocol)) {
-		return -ENOMEM;
-	}
-
 	/* Sync, Address & Control fields */
 	sync_addr_ctrl = sys_cpu_to_be32(0x7e << 24 | 0xff << 16 |
 					 0x7d << 8 | 0x23);
 	send_off = ppp_send_bytes(ppp, (const uint8_t *)&sync_addr_ctrl,
 				  sizeof(sync_addr_ctrl), send_off);
 
-	if (protocol > 0) {
-		escaped = htons(ppp_escape_byte(protocol, &offset));
-		send_off = ppp_send_bytes(ppp, (uint8_t *)&escaped + offset,
-					  offset ? 1 : 2,
-					  send_off);
+	/* The FCS covers the unescaped Address and Control fields */
+	fcs = ppp_hdlc_fcs(PPP_HDLC_FCS_INIT, addr_ctrl, sizeof(addr_ctrl));
 
-		escaped = htons(ppp_escape_byte(protocol >> 8, &offset));
-		send_off = ppp_send_bytes(ppp, (uint8_t *)&escaped + offset,
-					  offset ? 1 : 2,
-					  send_off);
+	if (protocol > 0) {
+		fcs = ppp_hdlc_fcs(fcs, (const uint8_t *)&protocol,
+				   sizeof(protocol));
+		send_off = ppp_send_escaped(ppp, (const uint8_t *)&protocol,
+					    sizeof(protocol), send_off);
 	}
 
 	/* Note that we do not print the first four bytes and FCS bytes at the
@@ -626,27 +682,16 @@ static int ppp_send(const struct device *dev, struct net_pkt *pkt)
 	}
 
 	while (buf) {
-		for (i = 0; i < buf->len; i++) {
-			/* Escape illegal bytes */
-			escaped = htons(ppp_escape_byte(buf->data[i], &offset));
-			send_off = ppp_send_bytes(ppp,
-						  (uint8_t *)&escaped + offset,
-						  offset ? 1 : 2,
-						  send_off);
-		}
-
+		fcs = ppp_hdlc_fcs(fcs, buf->data, buf->len);
+		send_off = ppp_send_escaped(ppp, buf->data, buf->len,
+					    send_off);
 		buf = buf->frags;
 	}
 
-	escaped = htons(ppp_escape_byte(fcs, &offset));
-	send_off = ppp_send_bytes(ppp, (uint8_t *)&escaped + offset,
-				  offset ? 1 : 2,
-				  send_off);
-
-	escaped = htons(ppp_escape_byte(fcs >> 8, &offset));
-	send_off = ppp_send_bytes(ppp, (uint8_t *)&escaped + offset,
-				  offset ? 1 : 2,
-				  send_off);
+	fcs ^= 0xffff;
+	sys_put_le16(fcs, fcs_bytes);
+	send_off = ppp_send_escaped(ppp, fcs_bytes, sizeof(fcs_bytes),
+				    send_off);
 
 	byte = 0x7e;
 	send_off = ppp_send_bytes(ppp, &byte, 1, send_off);
@@ -661,6 +706,7 @@ static int ppp_consume_ringbuf(struct ppp_driver_context *ppp)
 {
 	uint8_t *data;
 	size_t len, tmp;
+	bool frame_end;
 	int ret;
 
 	len = ring_buf_get_claim(&ppp->rx_ringbuf, &data,
@@ -675,16 +721,16 @@ static int ppp_consume_ringbuf(struct ppp_driver_context *ppp)
 		LOG_HEXDUMP_DBG(data, len, ppp->dev->name);
 	}
 
-	tmp = len;
+	tmp = 0;
 
-	do {
-		if (ppp_input_byte(ppp, *data++) == 0) {
-			/* Ignore empty or too short frames */
-			if (ppp->pkt && net_pkt_get_len(ppp->pkt) > 3) {
-				ppp_process_msg(ppp);
-			}
+	while (tmp < len) {
+		tmp += ppp_input_data(ppp, &data[tmp], len - tmp, &frame_end);
+
+		/* Ignore empty or too short frames */
+		if (frame_end && ppp->pkt && net_pkt_get_len(ppp->pkt) > 3) {
+			ppp_process_msg(ppp);
 		}
-	} while (--tmp);
+	}
 
 	ret = ring_buf_get_finish(&ppp->rx_ringbuf, len);
 	if (ret < 0) {
@@ -722,6 +768,11 @@ static int ppp_driver_init(const struct device *dev)
 	k_thread_name_set(&ppp->cb_workq.thread, "ppp_workq");
 #endif
 
+#if defined(CONFIG_NET_PPP_ASYNC_UART)
+	k_sem_init(&ppp->async_tx_sem, 1, 1);
+#endif
+
+	ppp->send_buf = ppp->send_bufs[0];
 	ppp->pkt = NULL;
 	ppp_change_state(ppp, STATE_HDLC_FRAME_START);
 #if defined(CONFIG_PPP_CLIENT_CLIENTSERVER)
@@ -798,7 +849,78 @@ static struct net_stats_ppp *ppp_get_stats(const struct device *dev)
 }
 #endif
 
-#if !defined(CONFIG_NET_TEST)
+#if defined(CONFIG_NET_PPP_ASYNC_UART) && !defined(CONFIG_NET_TEST)
+static void ppp_uart_callback(const struct device *dev,
+			      struct uart_event *evt, void *user_data)
+{
+	struct ppp_driver_context *context = user_data;
+	int ret;
+
+	switch (evt->type) {
+	case UART_TX_DONE:
+	case UART_TX_ABORTED:
+		k_sem_give(&context->async_tx_sem);
+		break;
+
+	case UART_RX_RDY:
+		ret = ring_buf_put(&context->rx_ringbuf,
+				   evt->data.rx.buf + evt->data.rx.offset,
+				   evt->data.rx.len);
+		if (ret < evt->data.rx.len) {
+			LOG_ERR("Rx buffer doesn't have enough space. "
+				"Bytes pending: %zu, written: %d",
+				evt->data.rx.len, ret);
+		}
+
+		k_work_submit_to_queue(&context->cb_workq, &context->cb_work);
+		break;
+
+	case UART_RX_BUF_REQUEST:
+		(void)uart_rx_buf_rsp(dev,
+			context->async_rx_bufs[context->async_rx_next],
+			sizeof(context->async_rx_bufs[0]));
+		context->async_rx_next ^= 1;
+		break;
+
+	case UART_RX_STOPPED:
+		LOG_DBG("Rx stopped (%d)", evt->data.rx_stop.reason);
+		break;
+
+	case UART_RX_DISABLED:
+		/* Keep receiving after an error */
+		context->async_rx_next = 1;
+		(void)uart_rx_enable(dev, context->async_rx_bufs[0],
+				     sizeof(context->async_rx_bufs[0]),
+				     CONFIG_NET_PPP_ASYNC_UART_RX_TIMEOUT);
+		break;
+
+	default:
+		break;
+	}
+}
+
+static int ppp_uart_start(struct ppp_driver_context *context)
+{
+	int ret;
+
+	ret = uart_callback_set(context->dev, ppp_uart_callback, context);
+	if (ret < 0) {
+		LOG_ERR("Cannot set UART callback (%d)", ret);
+		return ret;
+	}
+
+	context->async_rx_next = 1;
+
+	ret = uart_rx_enable(context->dev, context->async_rx_bufs[0],
+			     sizeof(context->async_rx_bufs[0]),
+			     CONFIG_NET_PPP_ASYNC_UART_RX_TIMEOUT);
+	if (ret < 0) {
+		LOG_ERR("Cannot enable UART reception (%d)", ret);
+	}
+
+	return ret;
+}
+#elif !defined(CONFIG_NET_TEST)
 static void ppp_uart_flush(const struct device *dev)
 {
 	uint8_t c;
@@ -831,7 +953,19 @@ static void ppp_uart_isr(const struct device *uart, void *user_data)
 		k_work_submit_to_queue(&context->cb_workq, &context->cb_work);
 	}
 }
-#endif /* !CONFIG_NET_TEST */
+
+static int ppp_uart_start(struct ppp_driver_context *context)
+{
+	uart_irq_rx_disable(context->dev);
+	uart_irq_tx_disable(context->dev);
+	ppp_uart_flush(context->dev);
+	uart_irq_callback_user_data_set(context->dev, ppp_uart_isr,
+					context);
+	uart_irq_rx_enable(context->dev);
+
+	return 0;
+}
+#endif /* CONFIG_NET_PPP_ASYNC_UART && !CONFIG_NET_TEST */
 
 static int ppp_start(const struct device *dev)
 {
@@ -844,6 +978,7 @@ static int ppp_start(const struct device *dev)
 #if !defined(CONFIG_NET_TEST)
 	if (atomic_cas(&context->modem_init_done, false, true)) {
 		const char *dev_name = NULL;
+		int ret;
 
 		/* Now try to figure out what device to open. If GSM muxing
 		 * is enabled, then use it. If not, then check if modem
@@ -879,12 +1014,11 @@ static int ppp_start(const struct device *dev)
 			return -ENODEV;
 		}
 
-		uart_irq_rx_disable(context->dev);
-		uart_irq_tx_disable(context->dev);
-		ppp_uart_flush(context->dev);
-		uart_irq_callback_user_data_set(context->dev, ppp_uart_isr,
-						context);
-		uart_irq_rx_enable(context->dev);
+		ret = ppp_uart_start(context);
+		if (ret < 0) {
+			context->modem_init_done = false;
+			return ret;
+		}
 	}
 #endif /* !CONFIG_NET_TEST */
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * HDLC-like framing helpers (RFC 1662) for the PPP driver. The helpers
+ * work on whole buffers instead of single bytes.
+ */
+
+#ifndef ZEPHYR_DRIVERS_NET_PPP_HDLC_H_
+#define ZEPHYR_DRIVERS_NET_PPP_HDLC_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PPP_HDLC_FLAG 0x7e
+#define PPP_HDLC_ESCAPE 0x7d
+#define PPP_HDLC_ESCAPE_XOR 0x20
+
+/** FCS value to start the calculation with */
+#define PPP_HDLC_FCS_INIT 0xffff
+
+/** FCS of a frame including its own FCS field, if the frame is valid */
+#define PPP_HDLC_FCS_GOOD 0xf0b8
+
+/**
+ * @brief Update the 16-bit FCS (RFC 1662 ch. 4.4) with a block of data
+ *
+ * Gives the same result as crc16_ccitt().
+ *
+ * @param fcs FCS of the preceding data, PPP_HDLC_FCS_INIT at the start
+ * @param data Data to add
+ * @param len Length of data
+ *
+ * @return Updated FCS
+ */
+uint16_t ppp_hdlc_fcs(uint16_t fcs, const uint8_t *data, size_t len);
+
+/**
+ * @brief Check if a byte must be escaped when sent
+ *
+ * All the control characters are escaped, as the default async control
+ * character map is used.
+ */
+static inline bool ppp_hdlc_needs_escape(uint8_t byte)
+{
+	return byte == PPP_HDLC_FLAG || byte == PPP_HDLC_ESCAPE ||
+		byte < 0x20;
+}
+
+/**
+ * @brief Find the first flag or escape byte in received data
+ *
+ * @param data Received data
+ * @param len Length of data
+ *
+ * @return Number of bytes before the first flag or escape byte, len if
+ *         there is none.
+ */
+size_t ppp_hdlc_scan_rx(const uint8_t *data, size_t len);
+
+/**
+ * @brief Find the first byte that must be escaped in data to send
+ *
+ * @param data Data to send
+ * @param len Length of data
+ *
+ * @return Number of bytes before the first byte to escape, len if there
+ *         is none.
+ */
+size_t ppp_hdlc_scan_tx(const uint8_t *data, size_t len);
+
+/**
+ * @brief Escape data to send
+ *
+ * Stops when all the data is escaped or when the next byte does not fit
+ * in the output buffer.
+ *
+ * @param dst Output buffer
+ * @param dst_len Length of the output buffer
+ * @param src Data to escape
+ * @param src_len Length of the data
+ * @param consumed Number of bytes of src escaped is stored here
+ *
+ * @return Number of bytes written to dst
+ */
+size_t ppp_hdlc_escape(uint8_t *dst, size_t dst_len,
+		       const uint8_t *src, size_t src_len, size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_DRIVERS_NET_PPP_HDLC_H_ */
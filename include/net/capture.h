@@ -193,6 +193,122 @@ static inline int net_capture_send(const struct device *dev,
 #endif
 }
 
+/**
+ * @typedef net_capture_pcapng_write_cb_t
+ * @brief Callback used to write pcapng data.
+ *
+ * @details The callback is called from the capture writer thread.
+ *
+ * @param data Data to write
+ * @param len Length of the data
+ * @param user_data User supplied data
+ *
+ * @return 0 if ok, <0 on error, which stops the writing of the capture
+ */
+typedef int (*net_capture_pcapng_write_cb_t)(const void *data, size_t len,
+					     void *user_data);
+
+/** Parameters of a pcapng capture */
+struct net_capture_pcapng_params {
+	/** File where the capture is written. Used if write_cb is not set,
+	 * needs CONFIG_FILE_SYSTEM.
+	 */
+	const char *path;
+
+	/** Function that writes the capture data, instead of a file */
+	net_capture_pcapng_write_cb_t write_cb;
+
+	/** User data passed to write_cb */
+	void *user_data;
+
+	/** Filter expression, using a subset of the tcpdump syntax, like
+	 * "udp port 5683 or (ip6 and not icmp6)". NULL or an empty string
+	 * captures all the packets.
+	 */
+	const char *filter;
+
+	/** Maximum number of bytes stored for a packet, 0 for no limit */
+	uint16_t snaplen;
+};
+
+/** Statistics of a pcapng capture */
+struct net_capture_pcapng_stats {
+	/** Packets written to the capture */
+	uint32_t captured;
+
+	/** Packets rejected by the filter */
+	uint32_t filtered;
+
+	/** Packets dropped because the capture buffer was full */
+	uint32_t dropped;
+};
+
+/**
+ * @brief Start capturing network packets to a pcapng file.
+ *
+ * @details The packets sent and received by the network interface are
+ * filtered and copied, up to the snap length, to a ring buffer. A low
+ * priority thread writes the buffer to the file or to the write callback.
+ * This does not need a capture device set up with net_capture_setup().
+ *
+ * @param iface Network interface to capture
+ * @param params Capture parameters
+ *
+ * @return 0 if ok, -EALREADY if a pcapng capture is already running,
+ *         -EINVAL if the filter is invalid, <0 on other errors
+ */
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+int net_capture_pcapng_start(struct net_if *iface,
+			     const struct net_capture_pcapng_params *params);
+#else
+static inline int net_capture_pcapng_start(
+			struct net_if *iface,
+			const struct net_capture_pcapng_params *params)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(params);
+
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Stop the pcapng capture.
+ *
+ * @details The packets captured so far are written out before this
+ * returns.
+ *
+ * @return 0 if ok, -EALREADY if no pcapng capture is running,
+ *         <0 if writing the capture failed
+ */
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+int net_capture_pcapng_stop(void);
+#else
+static inline int net_capture_pcapng_stop(void)
+{
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Get the statistics of the current or last pcapng capture.
+ *
+ * @param stats Statistics, returned to the caller
+ *
+ * @return 0 if ok, <0 if pcapng capture is not supported
+ */
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+int net_capture_pcapng_stats_get(struct net_capture_pcapng_stats *stats);
+#else
+static inline int net_capture_pcapng_stats_get(
+			struct net_capture_pcapng_stats *stats)
+{
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+}
+#endif
+
 /** @cond INTERNAL_HIDDEN */
 
 /**
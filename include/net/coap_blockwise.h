@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief CoAP block-wise transfer engine.
+ *
+ * Transfers bodies larger than one CoAP message using the Block1 and
+ * Block2 options of RFC 7959. Several blocks are kept in flight at the
+ * same time, as done by RFC 9177, so that a transfer over a high latency
+ * link does not wait a round trip per block. Blocks are delivered to the
+ * application in order through a sink callback.
+ *
+ * The engine does not own a socket: the application passes the received
+ * messages in and the engine sends its messages through a callback.
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_COAP_BLOCKWISE_H_
+#define ZEPHYR_INCLUDE_NET_COAP_BLOCKWISE_H_
+
+#include <net/coap.h>
+
+/**
+ * @addtogroup coap COAP Library
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Room left for the CoAP header and options in a block message */
+#define COAP_BLOCKWISE_HEADER_LEN 64
+
+/** Size of the buffer holding one block message */
+#define COAP_BLOCKWISE_BUF_LEN \
+	(CONFIG_COAP_BLOCKWISE_MAX_BLOCK_SIZE + COAP_BLOCKWISE_HEADER_LEN)
+
+/**
+ * @typedef coap_blockwise_send_t
+ * @brief Callback sending a message of a block-wise transfer to the peer.
+ *
+ * @param data Message to send
+ * @param len Length of the message
+ * @param user_data User data of the transfer
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+typedef int (*coap_blockwise_send_t)(const uint8_t *data, size_t len,
+				     void *user_data);
+
+/**
+ * @typedef coap_blockwise_sink_t
+ * @brief Callback receiving the body of a block-wise transfer.
+ *
+ * The blocks are delivered in order, @a offset is the position of @a data
+ * in the body.
+ *
+ * @param offset Offset of the data in the body
+ * @param data Data of the block
+ * @param len Length of the data
+ * @param last True if this is the last block of the body
+ * @param user_data User data of the transfer
+ *
+ * @return 0 in case of success or negative to abort the transfer.
+ */
+typedef int (*coap_blockwise_sink_t)(size_t offset, const uint8_t *data,
+				     size_t len, bool last, void *user_data);
+
+/**
+ * @typedef coap_blockwise_source_t
+ * @brief Callback providing the body of a block-wise transfer.
+ *
+ * @param offset Offset in the body of the data to read
+ * @param data Buffer to read the data into
+ * @param len Length of the buffer
+ * @param last Set to true if the body ends with the data read
+ * @param user_data User data of the transfer
+ *
+ * @return Number of bytes read or negative in case of error.
+ */
+typedef int (*coap_blockwise_source_t)(size_t offset, uint8_t *data,
+				       size_t len, bool *last,
+				       void *user_data);
+
+/**
+ * @brief Block of a block-wise transfer in flight.
+ */
+struct coap_blockwise_block {
+	/** Retransmission state of the request */
+	struct coap_pending pending;
+	/** Block number */
+	uint32_t num;
+	/** Length of the payload sent or received */
+	uint16_t len;
+	/** State of the block */
+	uint8_t state;
+	/** True if this is the last block of the body */
+	bool last;
+	/** Request, replaced by the payload of the response once received */
+	uint8_t buf[COAP_BLOCKWISE_BUF_LEN];
+};
+
+/**
+ * @brief Client side of a block-wise transfer.
+ *
+ * Initialize with coap_blockwise_client_init() and start the transfer
+ * with coap_blockwise_client_get() or coap_blockwise_client_put().
+ */
+struct coap_blockwise_client {
+	struct coap_blockwise_block blocks[CONFIG_COAP_BLOCKWISE_WINDOW];
+	const char * const *path;
+	coap_blockwise_send_t send;
+	coap_blockwise_sink_t sink;
+	coap_blockwise_source_t source;
+	void *user_data;
+	/** Number of the next block to request */
+	uint32_t next_num;
+	/** Number of the next block to give to the sink */
+	uint32_t deliver_num;
+	/** Number of the block following the last one, UINT32_MAX until
+	 * the end of the body is known
+	 */
+	uint32_t end_num;
+	int status;
+	uint8_t token[4];
+	uint8_t method;
+	uint8_t window;
+	enum coap_block_size block_size;
+};
+
+/**
+ * @brief Server side of a Block1 transfer.
+ *
+ * Blocks received out of order are held until the blocks before them
+ * arrive, so that the sink sees the body in order.
+ */
+struct coap_blockwise_server {
+	struct {
+		uint32_t num;
+		uint16_t len;
+		bool used;
+		uint8_t data[CONFIG_COAP_BLOCKWISE_MAX_BLOCK_SIZE];
+	} blocks[CONFIG_COAP_BLOCKWISE_WINDOW];
+	coap_blockwise_sink_t sink;
+	void *user_data;
+	/** Number of the next block to give to the sink */
+	uint32_t deliver_num;
+	/** Message id of the first block, to tell retransmissions from a
+	 * new transfer
+	 */
+	uint16_t block0_id;
+	bool active;
+	enum coap_block_size block_size;
+};
+
+/**
+ * @brief Initialize the client side of a block-wise transfer.
+ *
+ * @param client Client to initialize
+ * @param path NULL terminated Uri-Path of the resource
+ * @param block_size Block size to propose to the server
+ * @param window Number of blocks in flight, at most
+ *        CONFIG_COAP_BLOCKWISE_WINDOW
+ * @param send Callback sending the messages
+ * @param user_data User data passed to the callbacks
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_blockwise_client_init(struct coap_blockwise_client *client,
+			       const char * const *path,
+			       enum coap_block_size block_size,
+			       uint8_t window, coap_blockwise_send_t send,
+			       void *user_data);
+
+/**
+ * @brief Start fetching the resource with a Block2 transfer.
+ *
+ * @param client Initialized client
+ * @param sink Callback receiving the body of the resource
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_blockwise_client_get(struct coap_blockwise_client *client,
+			      coap_blockwise_sink_t sink);
+
+/**
+ * @brief Start sending a body to the resource with a Block1 transfer.
+ *
+ * The last block is sent once all the other blocks are acknowledged, so
+ * that the final response of the server covers the whole body.
+ *
+ * @param client Initialized client
+ * @param method COAP_METHOD_PUT or COAP_METHOD_POST
+ * @param source Callback providing the body
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_blockwise_client_put(struct coap_blockwise_client *client,
+			      uint8_t method, coap_blockwise_source_t source);
+
+/**
+ * @brief Process a message received from the server.
+ *
+ * @param client Client of the transfer
+ * @param data Received message
+ * @param len Length of the message
+ *
+ * @return 0 if the message belongs to the transfer, -ENOENT if it does not,
+ * or another negative value if the message is malformed.
+ */
+int coap_blockwise_client_input(struct coap_blockwise_client *client,
+				uint8_t *data, uint16_t len);
+
+/**
+ * @brief Retransmit the requests whose acknowledgment timeout expired.
+ *
+ * @param client Client of the transfer
+ *
+ * @return Time in milliseconds until this needs to be called again, or
+ * SYS_FOREVER_MS if no request is waiting for an acknowledgment.
+ */
+int32_t coap_blockwise_client_process(struct coap_blockwise_client *client);
+
+/**
+ * @brief Get the state of the transfer.
+ *
+ * @param client Client of the transfer
+ *
+ * @return -EINPROGRESS while the transfer is running, 0 once it completed
+ * or negative if it failed.
+ */
+static inline int coap_blockwise_client_result(
+	const struct coap_blockwise_client *client)
+{
+	return client->status;
+}
+
+/**
+ * @brief Cancel the transfer.
+ *
+ * @param client Client of the transfer
+ */
+void coap_blockwise_client_cancel(struct coap_blockwise_client *client);
+
+/**
+ * @brief Build the response to a Block2 request.
+ *
+ * The block asked for by @a request is read from @a source. The block size
+ * of the request is used, limited to @a max_block_size and
+ * CONFIG_COAP_BLOCKWISE_MAX_BLOCK_SIZE.
+ *
+ * @param request Received request
+ * @param response Response to initialize
+ * @param data Buffer of the response
+ * @param max_len Length of the buffer
+ * @param max_block_size Largest block size to use
+ * @param total_size Size of the body, 0 if unknown
+ * @param source Callback providing the body
+ * @param user_data User data passed to @a source
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_blockwise_server_get(const struct coap_packet *request,
+			      struct coap_packet *response,
+			      uint8_t *data, uint16_t max_len,
+			      enum coap_block_size max_block_size,
+			      size_t total_size,
+			      coap_blockwise_source_t source,
+			      void *user_data);
+
+/**
+ * @brief Initialize the server side of a Block1 transfer.
+ *
+ * @param server Server to initialize
+ * @param sink Callback receiving the body
+ * @param user_data User data passed to @a sink
+ */
+void coap_blockwise_server_init(struct coap_blockwise_server *server,
+				coap_blockwise_sink_t sink, void *user_data);
+
+/**
+ * @brief Process a Block1 request and build its response.
+ *
+ * @param server Server of the transfer
+ * @param request Received request
+ * @param response Response to initialize
+ * @param data Buffer of the response
+ * @param max_len Length of the buffer
+ * @param code Response code to use once the whole body is received
+ *
+ * @return 0 if more blocks are expected, 1 once the whole body was given to
+ * the sink, or negative in case of error. A response is built in all the
+ * cases where @a response could be initialized.
+ */
+int coap_blockwise_server_put(struct coap_blockwise_server *server,
+			      const struct coap_packet *request,
+			      struct coap_packet *response,
+			      uint8_t *data, uint16_t max_len, uint8_t code);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_COAP_BLOCKWISE_H_ */
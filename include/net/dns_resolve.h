@@ -446,6 +446,103 @@ static inline int dns_cancel_addr_info(uint16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * DNS cache entry information, passed to dns_resolve_cache_foreach()
+ * callback.
+ */
+struct dns_resolve_cache_info {
+	/** Name that was resolved */
+	const char *query;
+
+	/** Resolved addresses, NULL if the name does not exist */
+	const struct sockaddr *addr;
+
+	/** Number of resolved addresses */
+	int addr_count;
+
+	/** Query type (A or AAAA) */
+	enum dns_query_type query_type;
+
+	/** Time in milliseconds until the entry expires */
+	int64_t remaining;
+};
+
+/**
+ * DNS cache statistics.
+ */
+struct dns_resolve_cache_stats {
+	/** Names resolved from the cache */
+	uint32_t hits;
+
+	/** Non-existent names found from the cache */
+	uint32_t negative_hits;
+
+	/** Names that had to be queried from the network */
+	uint32_t misses;
+
+	/** Entries replaced before they expired */
+	uint32_t evictions;
+};
+
+/**
+ * @typedef dns_resolve_cache_cb_t
+ * @brief Callback used while iterating over the DNS cache.
+ *
+ * @param info Information about the cache entry.
+ * @param user_data User data given to dns_resolve_cache_foreach().
+ */
+typedef void (*dns_resolve_cache_cb_t)(struct dns_resolve_cache_info *info,
+				       void *user_data);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE) || defined(__DOXYGEN__)
+/**
+ * @brief Go through all the valid entries of the DNS cache.
+ *
+ * @details The cache is locked while the callback is called, so the
+ * callback must not call other DNS resolver functions.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ *
+ * @return Number of entries the callback was called for.
+ */
+int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data);
+
+/**
+ * @brief Remove all the entries from the DNS cache.
+ *
+ * @details The cache is also flushed when the servers of a DNS context
+ * are changed by dns_resolve_reconfigure().
+ */
+void dns_resolve_cache_flush(void);
+
+/**
+ * @brief Get DNS cache statistics.
+ *
+ * @param stats Statistics are copied here.
+ */
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats);
+#else
+static inline int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb,
+					    void *user_data)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(user_data);
+
+	return 0;
+}
+
+static inline void dns_resolve_cache_flush(void)
+{
+}
+
+static inline void dns_resolve_cache_stats_get(
+	struct dns_resolve_cache_stats *stats)
+{
+	(void)memset(stats, 0, sizeof(*stats));
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 /**
  * @}
  */
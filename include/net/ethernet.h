@@ -164,6 +164,18 @@ enum ethernet_hw_caps {
 
 	/** TXTIME supported */
 	ETHERNET_TXTIME			= BIT(19),
+
+	/** TCP segmentation offload (TSO) supported. The driver (or the
+	 * hardware) splits TCP packets that have a non-zero
+	 * net_pkt_gso_size() into segments of that size.
+	 */
+	ETHERNET_HW_TSO			= BIT(20),
+
+	/** Large receive offload (LRO) supported. The hardware coalesces
+	 * consecutive TCP segments of a flow before passing them to the
+	 * network stack.
+	 */
+	ETHERNET_HW_LRO			= BIT(21),
 };
 
 /** @cond INTERNAL_HIDDEN */
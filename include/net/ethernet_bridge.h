@@ -28,12 +28,61 @@ extern "C" {
  * @{
  */
 
+struct net_eth_addr;
+
+/**
+ * @brief Forwarding database entry
+ */
+struct eth_bridge_fdb_entry {
+	/** Interface the address was learnt on, NULL if the entry is free */
+	struct net_if *iface;
+
+	/** Uptime in milliseconds when the address was last seen */
+	uint32_t last_seen;
+
+	/** MAC address */
+	uint8_t addr[6];
+
+	/** Static entries are never aged out nor moved by learning */
+	bool is_static;
+};
+
+/**
+ * @brief Per bridged interface statistics
+ */
+struct eth_bridge_iface_stats {
+	/** Frames received by the bridge from this interface */
+	uint32_t rx;
+
+	/** Frames sent to this interface because of a known destination */
+	uint32_t tx_forward;
+
+	/** Frames sent to this interface because they were flooded */
+	uint32_t tx_flood;
+
+	/** Frames received on this interface and not sent to any other one */
+	uint32_t drop;
+};
+
 /** @cond INTERNAL_HIDDEN */
 
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+#define ETH_BRIDGE_FDB_WAYS 4
+#define ETH_BRIDGE_FDB_BUCKETS \
+	(CONFIG_NET_ETHERNET_BRIDGE_FDB_SIZE / ETH_BRIDGE_FDB_WAYS)
+#endif
+
 struct eth_bridge {
 	struct k_mutex lock;
 	sys_slist_t interfaces;
 	sys_slist_t listeners;
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+	/* Set associative hash table, the hash of an address selects a
+	 * bucket of ETH_BRIDGE_FDB_WAYS entries.
+	 */
+	struct eth_bridge_fdb_entry
+		fdb[ETH_BRIDGE_FDB_BUCKETS][ETH_BRIDGE_FDB_WAYS];
+#endif
 };
 
 #define ETH_BRIDGE_INITIALIZER(obj) \
@@ -54,12 +103,17 @@ struct eth_bridge {
 	Z_STRUCT_SECTION_ITERABLE(eth_bridge, name) = \
 		ETH_BRIDGE_INITIALIZER(name)
 
+/** @cond INTERNAL_HIDDEN */
+
 struct eth_bridge_iface_context {
 	sys_snode_t node;
 	struct eth_bridge *instance;
+	struct eth_bridge_iface_stats stats;
 	bool allow_tx;
 };
 
+/** @endcond */
+
 struct eth_bridge_listener {
 	sys_snode_t node;
 	struct k_fifo pkt_queue;
@@ -124,6 +178,11 @@ int eth_bridge_iface_allow_tx(struct net_if *iface, bool allow);
  * The listener wishing not to receive any more packets should simply
  * unregister itself with eth_bridge_listener_remove().
  *
+ * When the forwarding database is enabled, listeners only receive the
+ * packets that are flooded, i.e. broadcast, multicast and unknown unicast
+ * ones. Packets to an address learnt on one of the bridged interfaces are
+ * only sent to that interface.
+ *
  * @param br A pointer to an initialized bridge object
  * @param l A pointer to an initialized listener instance.
  *
@@ -141,6 +200,76 @@ int eth_bridge_listener_add(struct eth_bridge *br, struct eth_bridge_listener *l
  */
 int eth_bridge_listener_remove(struct eth_bridge *br, struct eth_bridge_listener *l);
 
+/**
+ * @brief Add a static entry to the forwarding database of a bridge
+ *
+ * Packets to the given address are then only sent to the given interface.
+ * Static entries are never aged out and replace a dynamic entry for the
+ * same address.
+ *
+ * @param br A pointer to an initialized bridge object
+ * @param addr MAC address
+ * @param iface Bridged interface the address is reachable through
+ *
+ * @return 0 if OK, -EINVAL if the interface is not part of the bridge,
+ *         -ENOMEM if there is no room for the entry.
+ */
+int eth_bridge_fdb_add(struct eth_bridge *br, struct net_eth_addr *addr,
+		       struct net_if *iface);
+
+/**
+ * @brief Remove an entry from the forwarding database of a bridge
+ *
+ * @param br A pointer to an initialized bridge object
+ * @param addr MAC address
+ *
+ * @return 0 if OK, -ENOENT if the address is not known.
+ */
+int eth_bridge_fdb_remove(struct eth_bridge *br, struct net_eth_addr *addr);
+
+/**
+ * @brief Remove the learnt entries from the forwarding database of a bridge
+ *
+ * Static entries are kept.
+ *
+ * @param br A pointer to an initialized bridge object
+ * @param iface Only remove the entries of this interface, all of them
+ *        if NULL.
+ */
+void eth_bridge_fdb_flush(struct eth_bridge *br, struct net_if *iface);
+
+/**
+ * @typedef eth_bridge_fdb_cb_t
+ * @brief Callback used while iterating over forwarding database entries
+ *
+ * @param entry Forwarding database entry
+ * @param user_data User supplied data
+ */
+typedef void (*eth_bridge_fdb_cb_t)(struct eth_bridge_fdb_entry *entry,
+				    void *user_data);
+
+/**
+ * @brief Go through the valid entries of the forwarding database of a
+ *        bridge. The bridge is locked while the callback runs.
+ *
+ * @param br A pointer to an initialized bridge object
+ * @param cb Callback to call for each entry
+ * @param user_data User supplied data
+ */
+void eth_bridge_fdb_foreach(struct eth_bridge *br, eth_bridge_fdb_cb_t cb,
+			    void *user_data);
+
+/**
+ * @brief Get the bridging statistics of a bridged interface
+ *
+ * @param iface Bridged interface
+ * @param stats Where to store the statistics
+ *
+ * @return 0 if OK, -EINVAL if the interface is not part of a bridge.
+ */
+int eth_bridge_iface_get_stats(struct net_if *iface,
+			       struct eth_bridge_iface_stats *stats);
+
 /**
  * @brief Get bridge index according to pointer
  *
@@ -741,6 +741,365 @@ int lwm2m_engine_get_float64(char *pathstr, float64_value_t *buf);
  */
 int lwm2m_engine_get_objlnk(char *pathstr, struct lwm2m_objlnk *buf);
 
+/** @cond INTERNAL_HIDDEN */
+struct lwm2m_engine_obj_inst;
+struct lwm2m_engine_obj_field;
+struct lwm2m_engine_res;
+struct lwm2m_engine_res_inst;
+/** @endcond */
+
+/**
+ * @brief LwM2M resource handle
+ *
+ * A resource (instance) path resolved once with lwm2m_engine_resolve(),
+ * to get, set and notify the resource without parsing the path string
+ * and looking up the object instance on each access.
+ *
+ * A handle stays valid when object instances or resource instances are
+ * created or deleted: it is resolved again on its next use if needed.
+ */
+struct lwm2m_res_handle {
+	/** @cond INTERNAL_HIDDEN */
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res *res;
+	struct lwm2m_engine_res_inst *res_inst;
+	uint32_t res_gen;
+	uint32_t observer_gen;
+	uint16_t obj_id;
+	uint16_t obj_inst_id;
+	uint16_t res_id;
+	uint16_t res_inst_id;
+	bool observed;
+	/** @endcond */
+};
+
+/**
+ * @brief Resolve a resource (instance) path into a resource handle
+ *
+ * Example to update a temperature sensor value at a high rate:
+ *
+ * struct lwm2m_res_handle temp;
+ *
+ * lwm2m_engine_resolve("3303/0/5700", &temp);
+ * lwm2m_engine_handle_set_float32(&temp, &value);
+ *
+ * @param[in] pathstr LwM2M path string "obj/obj-inst/res(/res-inst)"
+ * @param[out] handle Resource handle to initialize
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_resolve(char *pathstr, struct lwm2m_res_handle *handle);
+
+/**
+ * @brief Notify the observers of a resource through a resource handle
+ *
+ * The set functions notify the observers when the value changes. This is
+ * for resources whose data buffer is changed directly by the application.
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ *
+ * @return Number of observers notified or negative in case of error.
+ */
+int lwm2m_engine_handle_notify(struct lwm2m_res_handle *handle);
+
+/**
+ * @brief Set resource (instance) value (opaque buffer) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] data_ptr Data buffer
+ * @param[in] data_len Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_opaque(struct lwm2m_res_handle *handle,
+				   char *data_ptr, uint16_t data_len);
+
+/**
+ * @brief Set resource (instance) value (string) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] data_ptr NULL terminated char buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_string(struct lwm2m_res_handle *handle,
+				   char *data_ptr);
+
+/**
+ * @brief Set resource (instance) value (u8) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value u8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u8(struct lwm2m_res_handle *handle, uint8_t value);
+
+/**
+ * @brief Set resource (instance) value (u16) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value u16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u16(struct lwm2m_res_handle *handle, uint16_t value);
+
+/**
+ * @brief Set resource (instance) value (u32) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value u32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u32(struct lwm2m_res_handle *handle, uint32_t value);
+
+/**
+ * @brief Set resource (instance) value (u64) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value u64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u64(struct lwm2m_res_handle *handle, uint64_t value);
+
+/**
+ * @brief Set resource (instance) value (s8) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value s8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s8(struct lwm2m_res_handle *handle, int8_t value);
+
+/**
+ * @brief Set resource (instance) value (s16) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value s16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s16(struct lwm2m_res_handle *handle, int16_t value);
+
+/**
+ * @brief Set resource (instance) value (s32) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value s32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s32(struct lwm2m_res_handle *handle, int32_t value);
+
+/**
+ * @brief Set resource (instance) value (s64) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value s64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s64(struct lwm2m_res_handle *handle, int64_t value);
+
+/**
+ * @brief Set resource (instance) value (bool) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value bool value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_bool(struct lwm2m_res_handle *handle, bool value);
+
+/**
+ * @brief Set resource (instance) value (32-bit float structure) through a
+ *        handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value 32-bit float value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *value);
+
+/**
+ * @brief Set resource (instance) value (64-bit float structure) through a
+ *        handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value 64-bit float value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *value);
+
+/**
+ * @brief Set resource (instance) value (ObjLnk) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[in] value pointer to the lwm2m_objlnk structure
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_objlnk(struct lwm2m_res_handle *handle,
+				   struct lwm2m_objlnk *value);
+
+/**
+ * @brief Get resource (instance) value (opaque buffer) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] buf Data buffer to copy data into
+ * @param[in] buflen Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_opaque(struct lwm2m_res_handle *handle,
+				   void *buf, uint16_t buflen);
+
+/**
+ * @brief Get resource (instance) value (string) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] str String buffer to copy data into
+ * @param[in] strlen Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_string(struct lwm2m_res_handle *handle,
+				   void *str, uint16_t strlen);
+
+/**
+ * @brief Get resource (instance) value (u8) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value u8 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u8(struct lwm2m_res_handle *handle, uint8_t *value);
+
+/**
+ * @brief Get resource (instance) value (u16) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value u16 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u16(struct lwm2m_res_handle *handle, uint16_t *value);
+
+/**
+ * @brief Get resource (instance) value (u32) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value u32 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u32(struct lwm2m_res_handle *handle, uint32_t *value);
+
+/**
+ * @brief Get resource (instance) value (u64) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value u64 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u64(struct lwm2m_res_handle *handle, uint64_t *value);
+
+/**
+ * @brief Get resource (instance) value (s8) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value s8 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s8(struct lwm2m_res_handle *handle, int8_t *value);
+
+/**
+ * @brief Get resource (instance) value (s16) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value s16 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s16(struct lwm2m_res_handle *handle, int16_t *value);
+
+/**
+ * @brief Get resource (instance) value (s32) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value s32 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s32(struct lwm2m_res_handle *handle, int32_t *value);
+
+/**
+ * @brief Get resource (instance) value (s64) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value s64 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s64(struct lwm2m_res_handle *handle, int64_t *value);
+
+/**
+ * @brief Get resource (instance) value (bool) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] value bool buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_bool(struct lwm2m_res_handle *handle, bool *value);
+
+/**
+ * @brief Get resource (instance) value (32-bit float structure) through a
+ *        handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] buf 32-bit float buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *buf);
+
+/**
+ * @brief Get resource (instance) value (64-bit float structure) through a
+ *        handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] buf 64-bit float buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *buf);
+
+/**
+ * @brief Get resource (instance) value (ObjLnk) through a handle
+ *
+ * @param[in] handle Resource handle resolved with lwm2m_engine_resolve()
+ * @param[out] buf lwm2m_objlnk buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_objlnk(struct lwm2m_res_handle *handle,
+				   struct lwm2m_objlnk *buf);
+
 
 /**
  * @brief Set resource (instance) read callback
@@ -62,7 +62,9 @@ enum mqtt_evt_type {
 	/** Acknowledgment for published message with QoS 1. */
 	MQTT_EVT_PUBACK,
 
-	/** Reception confirmation for published message with QoS 2. */
+	/** Reception confirmation for published message with QoS 2. Not
+	 *  notified for messages queued with mqtt_outbox_publish().
+	 */
 	MQTT_EVT_PUBREC,
 
 	/** Release of published message with QoS 2. */
@@ -442,6 +444,38 @@ struct mqtt_transport {
 };
 
 /** @brief MQTT internal state. */
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+/** @brief Message queued in the outbound queue. Internal. */
+struct mqtt_outbox_entry {
+	/** Offset of the encoded message in the outbox buffer. */
+	uint32_t offset;
+
+	/** Length of the encoded message. */
+	uint32_t len;
+
+	/** Message id of the message, 0 for QoS 0. */
+	uint16_t message_id;
+
+	/** Delivery state of the message. */
+	uint8_t state;
+};
+
+/** @brief Outbound queue of publish messages. Internal. */
+struct mqtt_outbox {
+	/** Queued messages, in the order they were queued. */
+	struct mqtt_outbox_entry entries[CONFIG_MQTT_OUTBOX_MSG_MAX];
+
+	/** Index of the oldest message in the entries array. */
+	uint16_t first;
+
+	/** Number of used entries, starting from the oldest one. */
+	uint16_t count;
+
+	/** Message id assigned to the next queued message. */
+	uint16_t next_message_id;
+};
+#endif /* CONFIG_MQTT_LIB_OUTBOX */
+
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
 	struct sys_mutex mutex;
@@ -459,6 +493,11 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	uint32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+	/** Internal. Publish messages queued with mqtt_outbox_publish(). */
+	struct mqtt_outbox outbox;
+#endif
 };
 
 /**
@@ -515,6 +554,17 @@ struct mqtt_client {
 	/** Size of transmit buffer. */
 	uint32_t tx_buf_size;
 
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+	/** Buffer holding the messages queued with mqtt_outbox_publish()
+	 *  until they are delivered. Shall not be modified while messages
+	 *  are queued.
+	 */
+	uint8_t *outbox_buf;
+
+	/** Size of outbox buffer. */
+	uint32_t outbox_buf_size;
+#endif
+
 	/** Keepalive interval for this client in seconds.
 	 *  Default is CONFIG_MQTT_KEEPALIVE.
 	 */
@@ -593,11 +643,57 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
- * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ * @return 0, -EBUSY if the message id is used by a message queued with
+ *         mqtt_outbox_publish() that is not delivered yet, or another
+ *         negative error code (errno.h) indicating reason of failure.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to queue a message for publishing through the outbound queue.
+ *
+ * @details The message, including its payload, is copied to the outbox
+ *          buffer and sent as soon as the number of QoS 1 and QoS 2 messages
+ *          awaiting acknowledgment is below
+ *          @kconfig{CONFIG_MQTT_OUTBOX_INFLIGHT_MAX}, so several messages
+ *          can be in flight at once. Queued messages are written to the
+ *          transport in batches. The library completes the QoS 2 flow
+ *          itself: @ref MQTT_EVT_PUBREC is not notified for queued
+ *          messages, so the application does not send PUBREL for them.
+ *          Messages not yet acknowledged when the connection is lost are
+ *          sent again, with the DUP flag set, once the client is connected
+ *          again. Messages can be queued while disconnected.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] param Parameters to be used for the publish message. If the
+ *                  message id is 0, the library assigns one that no queued
+ *                  message uses. Applications also publishing with
+ *                  mqtt_publish() should let the library assign the ids,
+ *                  or take them from the same counter.
+ *                  Shall not be NULL.
+ *
+ * @return Message id of the queued message (0 for QoS 0), -ENOBUFS if the
+ *         outbound queue is full, -EBUSY if the message id is used by a
+ *         queued message not delivered yet, or another negative error code
+ *         (errno.h) indicating reason of failure.
+ */
+int mqtt_outbox_publish(struct mqtt_client *client,
+			const struct mqtt_publish_param *param);
+
+/**
+ * @brief API to get the number of messages in the outbound queue that have
+ *        not been delivered yet.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ *
+ * @return Number of pending messages or a negative error code (errno.h)
+ *         indicating reason of failure.
+ */
+int mqtt_outbox_pending(struct mqtt_client *client);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
@@ -68,6 +68,12 @@ enum net_context_state {
 /* Context is bound to a specific interface */
 #define NET_CONTEXT_BOUND_TO_IFACE BIT(11)
 
+/* Return the destination address and interface of received packets */
+#define NET_CONTEXT_RECV_PKTINFO BIT(12)
+
+/* Return the timestamp of received packets */
+#define NET_CONTEXT_RECV_TIMESTAMP BIT(13)
+
 struct net_context;
 
 /**
@@ -281,6 +287,11 @@ __net_socket struct net_context {
 		/** Mutex used by condition variable */
 		struct k_mutex *lock;
 	} cond;
+
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+	/** Number of bytes of datagrams queued to recv_q */
+	atomic_t recv_q_len;
+#endif
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -312,6 +323,14 @@ __net_socket struct net_context {
 #endif
 #if defined(CONFIG_NET_CONTEXT_SNDTIMEO)
 		k_timeout_t sndtimeo;
+#endif
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+		/** Receive buffer size, 0 if not limited */
+		uint16_t rcvbuf;
+#endif
+#if defined(CONFIG_NET_CONTEXT_SNDBUF)
+		/** Send buffer size, 0 if not limited */
+		uint16_t sndbuf;
 #endif
 	} options;
 
@@ -1060,6 +1079,8 @@ enum net_context_option {
 	NET_OPT_SOCKS5		= 3,
 	NET_OPT_RCVTIMEO        = 4,
 	NET_OPT_SNDTIMEO        = 5,
+	NET_OPT_RCVBUF          = 6,
+	NET_OPT_SNDBUF          = 7,
 };
 
 /**
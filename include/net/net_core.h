@@ -71,13 +71,13 @@ extern "C" {
 #if defined(CONFIG_NET_PKT_TXTIME_STATS_DETAIL)
 
 #if defined(CONFIG_NET_PKT_RXTIME_STATS_DETAIL)
-#define NET_PKT_DETAIL_STATS_COUNT 4
+#define NET_PKT_DETAIL_STATS_COUNT 6
 #else
 #define NET_PKT_DETAIL_STATS_COUNT 3
 #endif /* CONFIG_NET_PKT_RXTIME_STATS_DETAIL */
 
 #else
-#define NET_PKT_DETAIL_STATS_COUNT 4
+#define NET_PKT_DETAIL_STATS_COUNT 6
 #endif /* CONFIG_NET_PKT_TXTIME_STATS_DETAIL */
 
 #endif /* !NET_PKT_DETAIL_STATS_COUNT */
@@ -193,6 +193,11 @@ enum net_if_flag {
 	/** Interface supports IPv6 */
 	NET_IF_IPV6,
 
+	/** Received packets are spread to several RX worker queues
+	 * according to their flow hash (receive side scaling).
+	 */
+	NET_IF_RX_RSS,
+
 /** @cond INTERNAL_HIDDEN */
 	/* Total number of flags - must be at the end of the enum */
 	NET_IF_NUM_FLAGS
@@ -411,6 +416,28 @@ struct net_traffic_class {
 	k_thread_stack_t *stack;
 };
 
+#if defined(CONFIG_NET_TC_QDISC)
+/**
+ * @brief Token bucket that limits the TX rate of a traffic class of a
+ * network interface.
+ */
+struct net_if_tx_shaper {
+	/** Rate in bytes per second, 0 if the rate is not limited */
+	uint32_t rate;
+
+	/** Max number of bytes that can be sent in a burst */
+	uint32_t burst;
+
+	/** Available tokens, in bytes multiplied by the tick rate. Can be
+	 * negative after a packet larger than the available tokens is sent.
+	 */
+	int64_t tokens;
+
+	/** Uptime in ticks when the tokens were last updated */
+	int64_t updated;
+};
+#endif
+
 /**
  * @brief Network Interface Device structure
  *
@@ -484,6 +511,21 @@ struct net_if {
 	 */
 	int tx_pending;
 #endif
+
+#if defined(CONFIG_NET_TC_QDISC)
+	/** Token bucket shapers of the TX traffic classes */
+	struct net_if_tx_shaper tx_shaper[NET_TC_TX_COUNT];
+#endif
+
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+	/** Dedicated packet slabs and data pools of the interface, used
+	 * before the common ones. NULL if the interface has none.
+	 */
+	struct k_mem_slab *rx_slab;
+	struct k_mem_slab *tx_slab;
+	struct net_buf_pool *rx_data_pool;
+	struct net_buf_pool *tx_data_pool;
+#endif
 };
 
 /**
@@ -808,6 +850,41 @@ static inline void net_if_set_mtu(struct net_if *iface,
 	iface->if_dev->mtu = mtu;
 }
 
+/**
+ * @brief Set dedicated packet pools for a network interface
+ *
+ * The packets received or sent on the interface are allocated from the
+ * given slabs and pools first, and only once these are empty from the
+ * common pools of the IP stack. This guarantees a minimum number of
+ * packets to the interface whatever the traffic on the other interfaces
+ * is. Several interfaces may share the same pools. Any of the pools can
+ * be NULL, the common pool is then used directly.
+ *
+ * @param iface Pointer to a network interface structure
+ * @param rx_slab Slab of the received packets, see NET_PKT_SLAB_DEFINE()
+ * @param tx_slab Slab of the sent packets
+ * @param rx_data_pool Pool of the received data, see
+ *        NET_PKT_DATA_POOL_DEFINE() and NET_PKT_DATA_VAR_POOL_DEFINE()
+ * @param tx_data_pool Pool of the sent data
+ */
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+static inline void net_if_setup_pools(struct net_if *iface,
+				      struct k_mem_slab *rx_slab,
+				      struct k_mem_slab *tx_slab,
+				      struct net_buf_pool *rx_data_pool,
+				      struct net_buf_pool *tx_data_pool)
+{
+	NET_ASSERT(iface);
+
+	iface->rx_slab = rx_slab;
+	iface->tx_slab = tx_slab;
+	iface->rx_data_pool = rx_data_pool;
+	iface->tx_data_pool = tx_data_pool;
+}
+#else
+#define net_if_setup_pools(iface, rx_slab, tx_slab, rx_data_pool, tx_data_pool)
+#endif
+
 /**
  * @brief Set the infinite status of the network interface address
  *
@@ -1952,6 +2029,28 @@ void net_if_call_link_cb(struct net_if *iface, struct net_linkaddr *lladdr,
  */
 bool net_if_need_calc_rx_checksum(struct net_if *iface);
 
+/**
+ * @brief Check if the network stack needs to split large TCP packets into
+ * segments or not. Some ethernet devices support TCP segmentation offload
+ * (TSO) in which case the large packet is passed to the driver as is.
+ *
+ * @param iface Network interface
+ *
+ * @return True if TCP segmentation is done in software, false otherwise.
+ */
+bool net_if_need_tcp_segmentation(struct net_if *iface);
+
+/**
+ * @brief Check if the network stack should coalesce received TCP segments
+ * or not. Some ethernet devices support large receive offload (LRO) in
+ * which case the hardware has already merged the segments.
+ *
+ * @param iface Network interface
+ *
+ * @return True if TCP segments are coalesced in software, false otherwise.
+ */
+bool net_if_need_tcp_coalescing(struct net_if *iface);
+
 /**
  * @brief Check if network packet checksum calculation can be avoided or not
  * when sending the packet. For example many ethernet devices support network
@@ -2136,6 +2235,87 @@ void net_if_unset_promisc(struct net_if *iface);
  */
 bool net_if_is_promisc(struct net_if *iface);
 
+/**
+ * @brief Enable receive side scaling for a network interface.
+ *
+ * @details After this, packets received from the interface are spread to
+ * CONFIG_NET_RX_RSS_QUEUE_COUNT RX worker threads according to their flow
+ * hash. Packets that belong to the same flow are always handled by the same
+ * worker.
+ *
+ * @param iface Pointer to network interface
+ *
+ * @return 0 on success, -ENOTSUP if receive side scaling is not supported.
+ */
+static inline int net_if_rx_rss_enable(struct net_if *iface)
+{
+#if defined(CONFIG_NET_RX_RSS)
+	net_if_flag_set(iface, NET_IF_RX_RSS);
+
+	return 0;
+#else
+	ARG_UNUSED(iface);
+
+	return -ENOTSUP;
+#endif
+}
+
+/**
+ * @brief Disable receive side scaling for a network interface.
+ *
+ * @param iface Pointer to network interface
+ */
+static inline void net_if_rx_rss_disable(struct net_if *iface)
+{
+	net_if_flag_clear(iface, NET_IF_RX_RSS);
+}
+
+/**
+ * @brief Check if receive side scaling is enabled for a network interface.
+ *
+ * @param iface Pointer to network interface
+ *
+ * @return True if received packets are spread to RX worker queues,
+ *         False otherwise.
+ */
+static inline bool net_if_rx_rss_is_enabled(struct net_if *iface)
+{
+	return IS_ENABLED(CONFIG_NET_RX_RSS) &&
+		net_if_flag_is_set(iface, NET_IF_RX_RSS);
+}
+
+/**
+ * @brief Limit the TX rate of a traffic class of a network interface.
+ *
+ * @details The packets of the traffic class are held in the TX queue while
+ * the token bucket of the interface is empty. The length of the IP packet,
+ * without the link layer header, is used for the accounting. Packets of
+ * other network interfaces in the same traffic class are not delayed.
+ *
+ * @param iface Pointer to network interface
+ * @param tc TX traffic class
+ * @param rate Rate in bytes per second, 0 removes the limit
+ * @param burst Max number of bytes that can be sent in a burst
+ *
+ * @return 0 on success, -EINVAL if the traffic class or burst is invalid,
+ *         -ENOTSUP if TX shaping is not supported.
+ */
+#if defined(CONFIG_NET_TC_QDISC)
+int net_if_tx_shaper_set(struct net_if *iface, uint8_t tc, uint32_t rate,
+			 uint32_t burst);
+#else
+static inline int net_if_tx_shaper_set(struct net_if *iface, uint8_t tc,
+				       uint32_t rate, uint32_t burst)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(tc);
+	ARG_UNUSED(rate);
+	ARG_UNUSED(burst);
+
+	return -ENOTSUP;
+}
+#endif
+
 /**
  * @brief Check if there are any pending TX network data for a given network
  *        interface.
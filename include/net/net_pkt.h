@@ -69,6 +69,13 @@ struct net_pkt {
 	/** Slab pointer from where it belongs to */
 	struct k_mem_slab *slab;
 
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+	/** Dedicated data pool of the interface the packet was allocated
+	 * on, if any.
+	 */
+	struct net_buf_pool *data_pool;
+#endif
+
 	/** buffer holding the packet */
 	union {
 		struct net_buf *frags;
@@ -121,6 +128,11 @@ struct net_pkt {
 	uint64_t txtime;
 #endif /* CONFIG_NET_PKT_TXTIME */
 
+#if defined(CONFIG_NET_TC_QDISC)
+	/** Time in cycles when the packet was queued for sending */
+	uint32_t qdisc_time;
+#endif /* CONFIG_NET_TC_QDISC */
+
 	/** Reference counter */
 	atomic_t atomic_ref;
 
@@ -192,6 +204,11 @@ struct net_pkt {
 				 * defined(CONFIG_NET_ETHERNET_BRIDGE).
 				 */
 
+	uint8_t rx_pkt : 1; /* Set to 1 if this packet was allocated for
+			     * receiving, its data then comes from the RX
+			     * pools.
+			     */
+
 	union {
 		/* IPv6 hop limit or IPv4 ttl for this network packet.
 		 * The value is shared between IPv6 and IPv4.
@@ -223,6 +240,30 @@ struct net_pkt {
 	uint16_t vlan_tci;
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	uint16_t ipv4_fragment_offset;	/* Fragment offset of this packet */
+	uint16_t ipv4_fragment_id;	/* Fragment id */
+	uint8_t ipv4_fragment_more : 1;	/* More fragments flag (MF) */
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+	/* If non-zero, this TCP packet carries more data than fits into
+	 * one segment and it must be split into segments of gso_size
+	 * bytes of payload before it is passed to the driver.
+	 */
+	uint16_t gso_size;
+#endif /* CONFIG_NET_TCP_GSO */
+
+#if defined(CONFIG_NET_CHKSUM_ON_COPY)
+	/* Checksum of the last chksum_len bytes of the packet. It is
+	 * calculated while the payload is copied into the packet so that
+	 * the payload does not need to be read again when the transport
+	 * checksum is calculated. The sum is not complemented.
+	 */
+	uint16_t chksum;
+	uint16_t chksum_len;
+#endif /* CONFIG_NET_CHKSUM_ON_COPY */
+
 #if defined(CONFIG_NET_IPV6)
 	/* Where is the start of the last header before payload data
 	 * in IPv6 packet. This is offset value from start of the IPv6
@@ -635,6 +676,151 @@ static inline uint16_t net_pkt_ip_opts_len(struct net_pkt *pkt)
 #endif
 }
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline uint16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_offset;
+}
+
+static inline void net_pkt_set_ipv4_fragment_offset(struct net_pkt *pkt,
+						    uint16_t offset)
+{
+	pkt->ipv4_fragment_offset = offset;
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_more;
+}
+
+static inline void net_pkt_set_ipv4_fragment_more(struct net_pkt *pkt,
+						  bool more)
+{
+	pkt->ipv4_fragment_more = more;
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_id(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_id;
+}
+
+static inline void net_pkt_set_ipv4_fragment_id(struct net_pkt *pkt,
+						uint16_t id)
+{
+	pkt->ipv4_fragment_id = id;
+}
+#else /* CONFIG_NET_IPV4_FRAGMENT */
+static inline uint16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_offset(struct net_pkt *pkt,
+						    uint16_t offset)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(offset);
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv4_fragment_more(struct net_pkt *pkt,
+						  bool more)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(more);
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_id(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_id(struct net_pkt *pkt,
+						uint16_t id)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(id);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	return pkt->gso_size;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt,
+					uint16_t gso_size)
+{
+	pkt->gso_size = gso_size;
+}
+#else /* CONFIG_NET_TCP_GSO */
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt,
+					uint16_t gso_size)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(gso_size);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
+#if defined(CONFIG_NET_CHKSUM_ON_COPY)
+static inline uint16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	return pkt->chksum;
+}
+
+static inline uint16_t net_pkt_payload_chksum_len(struct net_pkt *pkt)
+{
+	return pkt->chksum_len;
+}
+
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      uint16_t chksum, uint16_t len)
+{
+	pkt->chksum = chksum;
+	pkt->chksum_len = len;
+}
+#else /* CONFIG_NET_CHKSUM_ON_COPY */
+static inline uint16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline uint16_t net_pkt_payload_chksum_len(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      uint16_t chksum, uint16_t len)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(chksum);
+	ARG_UNUSED(len);
+}
+#endif /* CONFIG_NET_CHKSUM_ON_COPY */
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 static inline uint16_t net_pkt_ipv6_fragment_start(struct net_pkt *pkt)
 {
@@ -885,6 +1071,18 @@ static inline void net_pkt_set_txtime(struct net_pkt *pkt, uint64_t txtime)
 }
 #endif /* CONFIG_NET_PKT_TXTIME */
 
+#if defined(CONFIG_NET_TC_QDISC)
+static inline uint32_t net_pkt_qdisc_time(struct net_pkt *pkt)
+{
+	return pkt->qdisc_time;
+}
+
+static inline void net_pkt_set_qdisc_time(struct net_pkt *pkt, uint32_t time)
+{
+	pkt->qdisc_time = time;
+}
+#endif /* CONFIG_NET_TC_QDISC */
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS_DETAIL) || \
 	defined(CONFIG_NET_PKT_RXTIME_STATS_DETAIL)
 static inline uint32_t *net_pkt_stats_tick(struct net_pkt *pkt)
@@ -1239,6 +1437,23 @@ static inline bool net_pkt_is_being_overwritten(struct net_pkt *pkt)
 	NET_BUF_POOL_DEFINE(name, count, CONFIG_NET_BUF_DATA_SIZE,	\
 			    CONFIG_NET_BUF_USER_DATA_SIZE, NULL)
 
+/**
+ * @brief Create a variable data size net_buf pool
+ *
+ * Same as :c:macro:`NET_PKT_DATA_POOL_DEFINE` except that each net_buf
+ * is allocated with the size asked for from a memory pool, instead of
+ * having a fixed size. The macro can be used by an application to
+ * define the RX data pool of a network interface (see
+ * :c:func:`net_if_setup_pools`), so that a received frame is stored in
+ * one buffer.
+ *
+ * @param name Name of the pool.
+ * @param count Number of net_buf in this pool.
+ * @param size Size of the memory pool the data is allocated from.
+ */
+#define NET_PKT_DATA_VAR_POOL_DEFINE(name, count, size)			\
+	NET_BUF_POOL_VAR_DEFINE(name, count, size, NULL)
+
 /** @cond INTERNAL_HIDDEN */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC) || \
@@ -1960,6 +2175,28 @@ int net_pkt_read_be32(struct net_pkt *pkt, uint32_t *data);
  */
 int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length);
 
+/**
+ * @brief Write data into a net_pkt and calculate its checksum on the fly
+ *
+ * @details Works like net_pkt_write() but the Internet checksum of the
+ *          written data is calculated while the data is copied. The sum
+ *          is accumulated into the packet so that the transport layer
+ *          checksum calculation does not need to read the data again.
+ *          The written data must be the last data of the packet, and the
+ *          consecutive calls must write consecutive data. The cached sum
+ *          is dropped if the data it covers is modified or new data is
+ *          appended after it through the net_pkt API. Data modified
+ *          directly through a buffer pointer is not tracked.
+ *
+ * @param pkt    The network packet where to write
+ * @param data   Data to be written
+ * @param length Length of the data to be written
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length);
+
 /* Write uint8_t data into a net_pkt. */
 static inline int net_pkt_write_u8(struct net_pkt *pkt, uint8_t data)
 {
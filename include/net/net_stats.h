@@ -219,6 +219,89 @@ struct net_stats_ipv4_igmp {
 	net_stats_t drop;
 };
 
+/**
+ * @brief IPv4 fragmentation statistics
+ */
+struct net_stats_ipv4_frag {
+	/** Number of received IPv4 fragments */
+	net_stats_t recv;
+
+	/** Number of IPv4 packets successfully reassembled */
+	net_stats_t reassembled;
+
+	/** Number of sent IPv4 fragments */
+	net_stats_t sent;
+
+	/** Number of IPv4 packets that were split into fragments */
+	net_stats_t fragmented;
+
+	/** Number of dropped IPv4 fragments */
+	net_stats_t drop;
+
+	/** Number of reassemblies cancelled because of a timeout */
+	net_stats_t timeout;
+};
+
+/**
+ * @brief IPv6 fragment reassembly statistics
+ */
+struct net_stats_ipv6_frag {
+	/** Number of received IPv6 fragments */
+	net_stats_t recv;
+
+	/** Number of IPv6 packets successfully reassembled */
+	net_stats_t reassembled;
+
+	/** Number of dropped duplicate fragments */
+	net_stats_t duplicate;
+
+	/** Number of reassemblies cancelled because of overlapping
+	 * fragments
+	 */
+	net_stats_t overlap;
+
+	/** Number of reassemblies cancelled because the packet was too
+	 * large or had too many fragments
+	 */
+	net_stats_t too_big;
+
+	/** Number of reassemblies cancelled because of the memory limit or
+	 * a failed buffer allocation
+	 */
+	net_stats_t no_mem;
+
+	/** Number of fragments dropped because all the reassembly slots
+	 * were in use
+	 */
+	net_stats_t no_slot;
+
+	/** Number of invalid fragments dropped */
+	net_stats_t invalid;
+
+	/** Number of reassemblies cancelled because of a timeout */
+	net_stats_t timeout;
+};
+
+/**
+ * @brief IPv4 ARP cache statistics
+ */
+struct net_stats_arp {
+	/** Number of packets whose destination was found in the cache */
+	net_stats_t hit;
+
+	/** Number of packets whose destination was not in the cache */
+	net_stats_t miss;
+
+	/** Number of sent ARP requests */
+	net_stats_t request;
+
+	/** Number of valid entries replaced by new ones */
+	net_stats_t evict;
+
+	/** Number of packets dropped because of a negative cache entry */
+	net_stats_t negative;
+};
+
 /**
  * @brief Network packet transfer times for calculating average TX time
  */
@@ -274,6 +357,48 @@ struct net_stats_tc {
 	} recv[NET_TC_RX_STATS_COUNT];
 };
 
+#if defined(CONFIG_NET_RX_RSS)
+/**
+ * @brief Receive side scaling statistics
+ */
+struct net_stats_rss {
+	struct {
+		/** Number of packets passed to this RX worker queue */
+		net_stats_t pkts;
+
+		/** Number of bytes passed to this RX worker queue */
+		net_stats_t bytes;
+	} queue[CONFIG_NET_RX_RSS_QUEUE_COUNT];
+};
+#endif
+
+#if defined(CONFIG_NET_TC_QDISC)
+/**
+ * @brief TX flow queue scheduler statistics
+ */
+struct net_stats_qdisc {
+	struct {
+		/** Number of packets queued in this traffic class */
+		net_stats_t queued;
+
+		/** Number of packets dropped by CoDel */
+		net_stats_t codel_drop;
+
+		/** Number of packets dropped because the queue was full */
+		net_stats_t overlimit_drop;
+
+		/** Number of times the TX was delayed by the shaper */
+		net_stats_t shaped;
+
+		/** Max queue delay in microseconds */
+		net_stats_t delay_max;
+
+		/** Queue delay in microseconds of the sent packets */
+		struct net_stats_tx_time delay;
+	} tc[NET_TC_TX_STATS_COUNT];
+};
+#endif
+
 
 /**
  * @brief Power management statistics
@@ -342,11 +467,36 @@ struct net_stats {
 	struct net_stats_ipv4_igmp ipv4_igmp;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	/** IPv4 fragmentation statistics */
+	struct net_stats_ipv4_frag ipv4_frag;
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT)
+	/** IPv6 fragment reassembly statistics */
+	struct net_stats_ipv6_frag ipv6_frag;
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	/** IPv4 ARP cache statistics */
+	struct net_stats_arp arp;
+#endif
+
 #if NET_TC_COUNT > 1
 	/** Traffic class statistics */
 	struct net_stats_tc tc;
 #endif
 
+#if defined(CONFIG_NET_RX_RSS)
+	/** Receive side scaling statistics */
+	struct net_stats_rss rss;
+#endif
+
+#if defined(CONFIG_NET_TC_QDISC)
+	/** TX flow queue scheduler statistics */
+	struct net_stats_qdisc qdisc;
+#endif
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS)
 	/** Network packet TX time statistics */
 	struct net_stats_tx_time tx_time;
@@ -39,6 +39,33 @@ struct zsock_pollfd {
 	short revents;
 };
 
+/** Message header used by zsock_recvmmsg() and zsock_sendmmsg() */
+struct zsock_mmsghdr {
+	struct msghdr msg_hdr; /* Message header */
+	unsigned int msg_len;  /* Number of bytes transmitted */
+};
+
+/** Receive data loaned from the network stack by zsock_recv_loan() */
+struct zsock_recv_loan {
+	struct iovec *iov; /* Read-only views to the loaned data */
+	size_t iovlen;     /* Size of the iov array / number of used entries */
+	size_t len;        /* Number of bytes loaned */
+	int flags;         /* ZSOCK_MSG_TRUNC if the datagram was truncated */
+	void *pkt;         /* Private, the packet owning the loaned data */
+	void *ctx;         /* Private, the context the data was loaned from */
+};
+
+/** Event reported by zsock_epoll_wait() and registered by zsock_epoll_ctl() */
+struct zsock_epoll_event {
+	uint32_t events; /* ZSOCK_EPOLL* event mask */
+	union {
+		void *ptr;
+		int fd;
+		uint32_t u32;
+		uint64_t u64;
+	} data;          /* User data returned as is by zsock_epoll_wait() */
+};
+
 /* ZSOCK_POLL* values are compatible with Linux */
 /** zsock_poll: Poll for readability */
 #define ZSOCK_POLLIN 1
@@ -53,8 +80,33 @@ struct zsock_pollfd {
 /** zsock_poll: Invalid socket (output value only) */
 #define ZSOCK_POLLNVAL 0x20
 
+/* ZSOCK_EPOLL* values are compatible with Linux */
+/** zsock_epoll_ctl: Wait for readability */
+#define ZSOCK_EPOLLIN ZSOCK_POLLIN
+/** zsock_epoll_ctl: Wait for writability */
+#define ZSOCK_EPOLLOUT ZSOCK_POLLOUT
+/** zsock_epoll_wait: Error condition (output value only) */
+#define ZSOCK_EPOLLERR ZSOCK_POLLERR
+/** zsock_epoll_wait: Closed connection (output value only) */
+#define ZSOCK_EPOLLHUP ZSOCK_POLLHUP
+/** zsock_epoll_ctl: Disable the descriptor after one reported event */
+#define ZSOCK_EPOLLONESHOT (1U << 30)
+/** zsock_epoll_ctl: Edge-triggered notification */
+#define ZSOCK_EPOLLET (1U << 31)
+
+/** zsock_epoll_ctl: Add a descriptor to the interest list */
+#define ZSOCK_EPOLL_CTL_ADD 1
+/** zsock_epoll_ctl: Remove a descriptor from the interest list */
+#define ZSOCK_EPOLL_CTL_DEL 2
+/** zsock_epoll_ctl: Change the events of a registered descriptor */
+#define ZSOCK_EPOLL_CTL_MOD 3
+
 /** zsock_recv: Read data without removing it from socket input queue */
 #define ZSOCK_MSG_PEEK 0x02
+/** zsock_recvmsg: Control data was discarded because of lack of space
+ *  (output value only)
+ */
+#define ZSOCK_MSG_CTRUNC 0x08
 /** zsock_recv: return the real length of the datagram, even when it was longer
  *  than the passed buffer
  */
@@ -138,6 +190,23 @@ struct zsock_pollfd {
  */
 #define TLS_DTLS_HANDSHAKE_TIMEOUT_MIN 8
 #define TLS_DTLS_HANDSHAKE_TIMEOUT_MAX 9
+/** Socket option to enable TLS session resumption. It accepts and returns an
+ *  integer, TLS_SESSION_CACHE_ENABLED or TLS_SESSION_CACHE_DISABLED
+ *  (default). On a client, the session negotiated with a peer is stored and
+ *  offered again on the next connection to the same peer address and
+ *  hostname. On a server, the sessions of the clients are stored so that
+ *  they can resume them.
+ */
+#define TLS_SESSION_CACHE 10
+/** Write-only socket option to purge all cached TLS sessions. The option
+ *  value is ignored.
+ */
+#define TLS_SESSION_CACHE_PURGE 11
+/** Read-only socket option to check if the last handshake of a client
+ *  resumed a session from the TLS_SESSION_CACHE. It returns an integer,
+ *  1 if the session was resumed and 0 otherwise.
+ */
+#define TLS_SESSION_RESUMED 12
 
 /** @} */
 
@@ -150,6 +219,10 @@ struct zsock_pollfd {
 #define TLS_DTLS_ROLE_CLIENT 0 /**< Client role in a DTLS session. */
 #define TLS_DTLS_ROLE_SERVER 1 /**< Server role in a DTLS session. */
 
+/* Valid values for TLS_SESSION_CACHE option */
+#define TLS_SESSION_CACHE_DISABLED 0 /**< Disable TLS session caching. */
+#define TLS_SESSION_CACHE_ENABLED 1 /**< Enable TLS session caching. */
+
 struct zsock_addrinfo {
 	struct zsock_addrinfo *ai_next;
 	int ai_flags;
@@ -386,6 +459,109 @@ __syscall ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len,
 				 int flags, struct sockaddr *src_addr,
 				 socklen_t *addrlen);
 
+/**
+ * @brief Receive a message from an arbitrary network address
+ *
+ * @details
+ * @rst
+ * See `POSIX.1-2017 article
+ * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/recvmsg.html>`__
+ * for normative description.
+ * The received data is scattered to the buffers in ``msg_iov``. If enabled
+ * with :c:macro:`IP_PKTINFO`, :c:macro:`IPV6_RECVPKTINFO` or
+ * :c:macro:`SO_TIMESTAMPING` socket options, the destination address and
+ * the receiving interface, or the receive timestamp of the packet are
+ * returned as ancillary data in ``msg_control``.
+ * This function is also exposed as ``recvmsg()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Send multiple messages with one call
+ *
+ * @details
+ * @rst
+ * See Linux ``sendmmsg()`` for the description. Sends the messages in
+ * ``msgvec`` like :c:func:`zsock_sendmsg` would do and sets the
+ * ``msg_len`` field of each message to the number of bytes sent.
+ * This function is also exposed as ``sendmmsg()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages sent, or -1 with errno set if the first
+ *         message could not be sent.
+ */
+__syscall int zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive multiple messages with one call
+ *
+ * @details
+ * @rst
+ * See Linux ``recvmmsg()`` for the description. Each message is received
+ * like :c:func:`zsock_recvmsg` would do and the ``msg_len`` field is set
+ * to the number of bytes received. Only the first message is waited for,
+ * the call returns when there is no more data queued to the socket. The
+ * timeout parameter of the Linux API is not supported, use
+ * :c:macro:`SO_RCVTIMEO` instead.
+ * This function is also exposed as ``recvmmsg()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages received, or -1 with errno set if no message
+ *         could be received.
+ */
+__syscall int zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive data without copying it
+ *
+ * @details
+ * Instead of copying the received data to an application buffer, fills
+ * the ``iov`` array of @p loan with read-only views to the network buffers
+ * holding the data. The caller sets ``iov`` and ``iovlen`` before the call,
+ * ``iovlen`` is updated to the number of entries used. A datagram socket
+ * loans one datagram per call, the data not fitting to the ``iov`` array is
+ * discarded and ``ZSOCK_MSG_TRUNC`` is set in ``flags``. A stream socket
+ * loans the data of one received segment, the data not fitting to the
+ * ``iov`` array is left queued to the socket.
+ *
+ * The buffers are owned by the application until they are given back with
+ * zsock_recv_return(). The loaned data still counts against the receive
+ * window of a stream socket, so it should be returned as soon as possible.
+ *
+ * This function is not a system call, the loaned buffers are not
+ * accessible to user mode threads. Only native sockets are supported.
+ * ``ZSOCK_MSG_DONTWAIT`` is the only supported flag.
+ *
+ * @param sock Socket to receive from
+ * @param loan Loan descriptor
+ * @param flags Receive flags
+ *
+ * @return Number of bytes loaned, 0 on end of stream, or -1 with errno set.
+ */
+ssize_t zsock_recv_loan(int sock, struct zsock_recv_loan *loan, int flags);
+
+/**
+ * @brief Return data loaned with zsock_recv_loan()
+ *
+ * @details
+ * Releases the network buffers of @p loan back to the pool and opens the
+ * receive window of a stream socket. The loan should be returned before
+ * the socket is closed. A loan returned after that is still released, and
+ * it is never applied to another socket that reuses the descriptor.
+ *
+ * @param sock Socket the data was loaned from
+ * @param loan Loan descriptor filled by zsock_recv_loan()
+ *
+ * @return 0 on success, or -1 with errno set.
+ */
+int zsock_recv_return(int sock, struct zsock_recv_loan *loan);
+
 /**
  * @brief Receive data from a connected peer
  *
@@ -434,6 +610,79 @@ __syscall int zsock_fcntl(int sock, int cmd, int flags);
  */
 __syscall int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
 
+/**
+ * @brief Create an epoll instance
+ *
+ * @details
+ * @rst
+ * Create an epoll instance holding a persistent interest list of file
+ * descriptors, see ``epoll_create1()`` in Linux. Unlike zsock_poll(), the
+ * descriptors are looked up and prepared for waiting once, when they are
+ * registered with zsock_epoll_ctl(), instead of on every call.
+ * The returned descriptor is closed with zsock_close().
+ * This function is also exposed as ``epoll_create1()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * Requires :kconfig:`CONFIG_NET_SOCKETS_EPOLL`.
+ * @endrst
+ *
+ * @param flags Must be 0.
+ *
+ * @return New epoll file descriptor, or -1 with errno set on error.
+ */
+__syscall int zsock_epoll_create(int flags);
+
+/**
+ * @brief Add, modify or remove a descriptor of an epoll instance
+ *
+ * @details
+ * @rst
+ * See ``epoll_ctl()`` in Linux. Sockets and other descriptors supporting
+ * zsock_poll(), such as eventfd, can be registered. ``ZSOCK_EPOLLET``
+ * suppresses repeated reports of conditions that are permanently
+ * signalled, like writability or end of stream, until the descriptor
+ * is modified; reports of received data may repeat while data is
+ * queued, so the application shall still read until ``EAGAIN``.
+ * A descriptor shall be removed with ``ZSOCK_EPOLL_CTL_DEL`` before it is
+ * closed.
+ * This function is also exposed as ``epoll_ctl()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Epoll file descriptor.
+ * @param op One of ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_MOD or
+ *           ZSOCK_EPOLL_CTL_DEL.
+ * @param fd Target file descriptor.
+ * @param event Events to wait for and user data, ignored for
+ *              ZSOCK_EPOLL_CTL_DEL.
+ *
+ * @return 0 on success, or -1 with errno set on error.
+ */
+__syscall int zsock_epoll_ctl(int epfd, int op, int fd,
+			      struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for events on an epoll instance
+ *
+ * @details
+ * @rst
+ * See ``epoll_wait()`` in Linux. When more than @p maxevents descriptors
+ * are ready, the following calls continue from where the previous one
+ * stopped.
+ * This function is also exposed as ``epoll_wait()``
+ * if :kconfig:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Epoll file descriptor.
+ * @param events Array receiving the ready events.
+ * @param maxevents Size of the @p events array.
+ * @param timeout Timeout in milliseconds, -1 to wait forever.
+ *
+ * @return Number of reported events, 0 on timeout, or -1 with errno set
+ *         on error.
+ */
+__syscall int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			       int maxevents, int timeout);
+
 /**
  * @brief Get various socket options
  *
@@ -636,6 +885,8 @@ int zsock_getnameinfo(const struct sockaddr *addr, socklen_t addrlen,
 #if defined(CONFIG_NET_SOCKETS_POSIX_NAMES)
 
 #define pollfd zsock_pollfd
+#define mmsghdr zsock_mmsghdr
+#define epoll_event zsock_epoll_event
 
 static inline int socket(int family, int type, int proto)
 {
@@ -724,11 +975,53 @@ static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+static inline int sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
+static inline int recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
 }
 
+static inline int epoll_create1(int flags)
+{
+	return zsock_epoll_create(flags);
+}
+
+static inline int epoll_create(int size)
+{
+	/* The size hint is ignored, as in Linux */
+	(void)size;
+
+	return zsock_epoll_create(0);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
 static inline int getsockopt(int sock, int level, int optname,
 			     void *optval, socklen_t *optlen)
 {
@@ -796,7 +1089,19 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 #define POLLHUP ZSOCK_POLLHUP
 #define POLLNVAL ZSOCK_POLLNVAL
 
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLONESHOT ZSOCK_EPOLLONESHOT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
 #define MSG_PEEK ZSOCK_MSG_PEEK
+#define MSG_CTRUNC ZSOCK_MSG_CTRUNC
 #define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
 #define MSG_WAITALL ZSOCK_MSG_WAITALL
@@ -834,6 +1139,10 @@ struct ifreq {
 #define SO_TYPE 3
 /** sockopt: Async error (ignored, for compatibility) */
 #define SO_ERROR 4
+/** sockopt: Limit of TCP data queued for sending, 0 for no limit */
+#define SO_SNDBUF 7
+/** sockopt: Limit of received data queued to the socket, 0 for no limit */
+#define SO_RCVBUF 8
 
 /**
  * sockopt: Receive timeout
@@ -846,8 +1155,15 @@ struct ifreq {
 /** sockopt: Bind a socket to an interface */
 #define SO_BINDTODEVICE	25
 
-/** sockopt: Timestamp TX packets */
+/** sockopt: Timestamp TX packets, or RX packets if
+ *  SOF_TIMESTAMPING_RX_HARDWARE is set in the option value
+ */
 #define SO_TIMESTAMPING 37
+
+/** SO_TIMESTAMPING: Return the RX timestamp of the packet as
+ *  SO_TIMESTAMPING ancillary data (struct net_ptp_time) in zsock_recvmsg()
+ */
+#define SOF_TIMESTAMPING_RX_HARDWARE BIT(2)
 /** sockopt: Protocol used with the socket */
 #define SO_PROTOCOL 38
 
@@ -855,10 +1171,36 @@ struct ifreq {
 /** sockopt: Disable TCP buffering (ignored, for compatibility) */
 #define TCP_NODELAY 1
 
+/* Socket options for IPPROTO_IP level */
+/** sockopt: Return the destination address and the receiving interface
+ *  of the packet as IP_PKTINFO ancillary data in zsock_recvmsg()
+ */
+#define IP_PKTINFO 8
+
+/** Ancillary data returned with IP_PKTINFO */
+struct in_pktinfo {
+	unsigned int   ipi_ifindex;  /* Interface index */
+	struct in_addr ipi_spec_dst; /* Local address */
+	struct in_addr ipi_addr;     /* Destination address of the packet */
+};
+
 /* Socket options for IPPROTO_IPV6 level */
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
 #define IPV6_V6ONLY 26
 
+/** sockopt: Return the destination address and the receiving interface
+ *  of the packet as IPV6_PKTINFO ancillary data in zsock_recvmsg()
+ */
+#define IPV6_RECVPKTINFO 49
+/** Type of the ancillary data returned when IPV6_RECVPKTINFO is set */
+#define IPV6_PKTINFO 50
+
+/** Ancillary data returned with IPV6_RECVPKTINFO */
+struct in6_pktinfo {
+	struct in6_addr ipi6_addr;    /* Destination address of the packet */
+	unsigned int    ipi6_ifindex; /* Interface index */
+};
+
 /** sockopt: Socket priority */
 #define SO_PRIORITY 12
 
@@ -300,6 +300,18 @@
 #define MBEDTLS_SSL_ALPN
 #endif
 
+#if defined(CONFIG_MBEDTLS_SSL_SESSION_TICKETS)
+#define MBEDTLS_SSL_SESSION_TICKETS
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+#define MBEDTLS_SSL_TICKET_C
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+#define MBEDTLS_SSL_CACHE_C
+#endif
+
 #if defined(CONFIG_MBEDTLS_CIPHER)
 #define MBEDTLS_CIPHER_C
 #endif
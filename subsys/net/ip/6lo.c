@@ -46,6 +46,151 @@ static inline uint8_t get_6co_cid(struct net_icmpv6_nd_opt_6co *opt)
 static struct net_6lo_context ctx_6co[CONFIG_NET_MAX_6LO_CONTEXTS];
 #endif
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+/* Encoding of the source and destination addresses of a flow. It only
+ * depends on the addresses, the link layer addresses and the contexts, so
+ * the next packets of the flow can reuse it as is.
+ */
+struct net_6lo_iphc_cache {
+	struct in6_addr src;
+	struct in6_addr dst;
+	struct net_if *iface;
+	uint8_t ll_src[NET_LINK_ADDR_MAX_LENGTH];
+	uint8_t ll_dst[NET_LINK_ADDR_MAX_LENGTH];
+	uint8_t ll_src_len;
+	uint8_t ll_dst_len;
+	/* IPHC with the address and CID bits set */
+	uint16_t iphc;
+	uint8_t cid;
+	uint8_t inline_len;
+	/* Inlined source address followed by the destination address */
+	uint8_t inline_addr[2 * sizeof(struct in6_addr)];
+	bool is_used;
+};
+
+static struct net_6lo_iphc_cache iphc_cache[CONFIG_NET_6LO_IPHC_CACHE_SIZE];
+static uint8_t iphc_cache_next;
+static struct k_spinlock iphc_cache_lock;
+
+static bool iphc_cache_match(struct net_6lo_iphc_cache *entry,
+			     struct net_pkt *pkt, struct net_ipv6_hdr *ipv6)
+{
+	struct net_linkaddr *ll_src = net_pkt_lladdr_src(pkt);
+	struct net_linkaddr *ll_dst = net_pkt_lladdr_dst(pkt);
+
+	return entry->is_used &&
+	       entry->iface == net_pkt_iface(pkt) &&
+	       net_ipv6_addr_cmp(&entry->dst, &ipv6->dst) &&
+	       net_ipv6_addr_cmp(&entry->src, &ipv6->src) &&
+	       entry->ll_src_len == ll_src->len &&
+	       entry->ll_dst_len == ll_dst->len &&
+	       !memcmp(entry->ll_src, ll_src->addr, ll_src->len) &&
+	       !memcmp(entry->ll_dst, ll_dst->addr, ll_dst->len);
+}
+
+/* Put the cached address encoding of the flow, if any, before inline_ptr */
+static uint8_t *iphc_cache_get(struct net_pkt *pkt, struct net_ipv6_hdr *ipv6,
+			       uint8_t *inline_ptr, uint16_t *iphc,
+			       uint8_t *cid)
+{
+	k_spinlock_key_t key = k_spin_lock(&iphc_cache_lock);
+	struct net_6lo_iphc_cache *entry;
+	uint8_t *ret = NULL;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_6LO_IPHC_CACHE_SIZE; i++) {
+		entry = &iphc_cache[i];
+
+		if (!iphc_cache_match(entry, pkt, ipv6)) {
+			continue;
+		}
+
+		ret = inline_ptr - entry->inline_len;
+		memcpy(ret, entry->inline_addr, entry->inline_len);
+		*iphc = entry->iphc;
+		*cid = entry->cid;
+		break;
+	}
+
+	k_spin_unlock(&iphc_cache_lock, key);
+
+	return ret;
+}
+
+/* The addresses are passed separately, as the encoding overwrote them in
+ * the IPv6 header.
+ */
+static void iphc_cache_add(struct net_pkt *pkt, struct in6_addr *src,
+			   struct in6_addr *dst, uint8_t *inline_ptr,
+			   uint8_t inline_len, uint16_t iphc, uint8_t cid)
+{
+	struct net_linkaddr *ll_src = net_pkt_lladdr_src(pkt);
+	struct net_linkaddr *ll_dst = net_pkt_lladdr_dst(pkt);
+	struct net_6lo_iphc_cache *entry;
+	k_spinlock_key_t key;
+
+	if (ll_src->len > NET_LINK_ADDR_MAX_LENGTH ||
+	    ll_dst->len > NET_LINK_ADDR_MAX_LENGTH) {
+		return;
+	}
+
+	key = k_spin_lock(&iphc_cache_lock);
+
+	entry = &iphc_cache[iphc_cache_next];
+	iphc_cache_next = (iphc_cache_next + 1) %
+			  CONFIG_NET_6LO_IPHC_CACHE_SIZE;
+
+	net_ipaddr_copy(&entry->src, src);
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->iface = net_pkt_iface(pkt);
+	entry->ll_src_len = ll_src->len;
+	entry->ll_dst_len = ll_dst->len;
+	memcpy(entry->ll_src, ll_src->addr, ll_src->len);
+	memcpy(entry->ll_dst, ll_dst->addr, ll_dst->len);
+	entry->iphc = iphc;
+	entry->cid = cid;
+	entry->inline_len = inline_len;
+	memcpy(entry->inline_addr, inline_ptr, inline_len);
+	entry->is_used = true;
+
+	k_spin_unlock(&iphc_cache_lock, key);
+}
+
+static void iphc_cache_flush(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&iphc_cache_lock);
+	int i;
+
+	for (i = 0; i < CONFIG_NET_6LO_IPHC_CACHE_SIZE; i++) {
+		iphc_cache[i].is_used = false;
+	}
+
+	k_spin_unlock(&iphc_cache_lock, key);
+}
+
+#if defined(CONFIG_NET_TEST)
+int net_6lo_iphc_cache_count(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&iphc_cache_lock);
+	int i, count = 0;
+
+	for (i = 0; i < CONFIG_NET_6LO_IPHC_CACHE_SIZE; i++) {
+		if (iphc_cache[i].is_used) {
+			count++;
+		}
+	}
+
+	k_spin_unlock(&iphc_cache_lock, key);
+
+	return count;
+}
+#endif
+#else
+static inline void iphc_cache_flush(void)
+{
+}
+#endif /* CONFIG_NET_6LO_IPHC_CACHE */
+
 static const uint8_t udp_nhc_inline_size_table[] = {4, 3, 3, 1};
 
 static const uint8_t tf_inline_size_table[] = {4, 3, 1, 0};
@@ -179,7 +324,8 @@ void net_6lo_set_context(struct net_if *iface,
 	uint8_t i;
 
 	/* If the context information already exists, update or remove
-	 * as per data.
+	 * as per data. Cached encodings might use the context, so they are
+	 * dropped once it has changed.
 	 */
 	for (i = 0U; i < CONFIG_NET_MAX_6LO_CONTEXTS; i++) {
 		if (!ctx_6co[i].is_used) {
@@ -192,11 +338,13 @@ void net_6lo_set_context(struct net_if *iface,
 			/* Remove if lifetime is zero */
 			if (!context->lifetime) {
 				ctx_6co[i].is_used = false;
+				iphc_cache_flush();
 				return;
 			}
 
 			/* Update the context */
 			set_6lo_context(iface, i, context);
+			iphc_cache_flush();
 			return;
 		}
 	}
@@ -204,6 +352,7 @@ void net_6lo_set_context(struct net_if *iface,
 	/* Cache the context information. */
 	if (unused != -1) {
 		set_6lo_context(iface, unused, context);
+		iphc_cache_flush();
 		return;
 	}
 
@@ -723,12 +872,17 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 #if defined(CONFIG_NET_6LO_CONTEXT)
 	struct net_6lo_context *src_ctx = NULL;
 	struct net_6lo_context *dst_ctx = NULL;
+#endif
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	struct in6_addr flow_src, flow_dst;
+	uint8_t *addr_block_end, *cached;
 #endif
 	uint8_t compressed = 0;
 	uint16_t iphc = (NET_6LO_DISPATCH_IPHC << 8);
 	struct net_ipv6_hdr *ipv6 = NET_IPV6_HDR(pkt);
 	struct net_udp_hdr *udp;
 	uint8_t *inline_pos;
+	uint8_t cid = 0U;
 
 	if (pkt->frags->len < NET_IPV6H_LEN) {
 		NET_ERR("Invalid length %d, min %d",
@@ -752,6 +906,18 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 		inline_pos = compress_nh_udp(udp, inline_pos, false);
 	}
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	cached = iphc_cache_get(pkt, ipv6, inline_pos, &iphc, &cid);
+	if (cached) {
+		inline_pos = cached;
+		goto addr_end;
+	}
+
+	net_ipaddr_copy(&flow_src, &ipv6->src);
+	net_ipaddr_copy(&flow_dst, &ipv6->dst);
+	addr_block_end = inline_pos;
+#endif
+
 	if (net_6lo_ll_prefix_padded_with_zeros(&ipv6->dst)) {
 		inline_pos = compress_da(ipv6, pkt, inline_pos, &iphc);
 		goto da_end;
@@ -800,24 +966,30 @@ da_end:
 	inline_pos = set_sa_inline(ipv6, inline_pos, &iphc);
 sa_end:
 
+#if defined(CONFIG_NET_6LO_CONTEXT)
+	if (src_ctx) {
+		cid = src_ctx->cid << 4;
+	}
+
+	if (dst_ctx) {
+		cid |= dst_ctx->cid & 0x0F;
+	}
+#endif
+
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	iphc_cache_add(pkt, &flow_src, &flow_dst, inline_pos,
+		       addr_block_end - inline_pos, iphc, cid);
+addr_end:
+#endif
+
 	inline_pos = compress_hoplimit(ipv6, inline_pos, &iphc);
 	inline_pos = compress_nh(ipv6, inline_pos, &iphc);
 	inline_pos = compress_tfl(ipv6, inline_pos, &iphc);
 
-#if defined(CONFIG_NET_6LO_CONTEXT)
 	if (iphc & NET_6LO_IPHC_CID_1) {
 		inline_pos -= sizeof(uint8_t);
-		*inline_pos = 0;
-
-		if (src_ctx) {
-			*inline_pos = src_ctx->cid << 4;
-		}
-
-		if (dst_ctx) {
-			*inline_pos |= dst_ctx->cid & 0x0F;
-		}
+		*inline_pos = cid;
 	}
-#endif
 
 	inline_pos -= sizeof(iphc);
 	iphc = htons(iphc);
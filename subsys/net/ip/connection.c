@@ -563,6 +563,8 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 	uint16_t src_port;
 	uint16_t dst_port;
 
+	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
+
 	if (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) {
 		src_port = proto_hdr->udp->src_port;
 		dst_port = proto_hdr->udp->dst_port;
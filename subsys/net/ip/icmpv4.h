@@ -21,9 +21,13 @@
 #define NET_ICMPV4_DST_UNREACH  3	/* Destination unreachable */
 #define NET_ICMPV4_ECHO_REQUEST 8
 #define NET_ICMPV4_ECHO_REPLY   0
+#define NET_ICMPV4_TIME_EXCEEDED 11	/* Time exceeded */
 
 #define NET_ICMPV4_DST_UNREACH_NO_PROTO  2 /* Protocol not supported */
 #define NET_ICMPV4_DST_UNREACH_NO_PORT   3 /* Port unreachable */
+#define NET_ICMPV4_DST_UNREACH_FRAG_DF   4 /* Fragmentation needed, DF set */
+
+#define NET_ICMPV4_TIME_EXCEEDED_REASSEMBLY 1 /* Reassembly time exceeded */
 
 #define NET_ICMPV4_UNUSED_LEN 4
 
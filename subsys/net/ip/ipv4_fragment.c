@@ -0,0 +1,747 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include <random/rand32.h>
+#include "net_private.h"
+#include "connection.h"
+#include "icmpv4.h"
+#include "ipv4.h"
+#include "net_stats.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+/* Option types with this bit set are copied into all the fragments */
+#define NET_IPV4_OPTS_COPIED 0x80
+
+/* MF flag and DF flag in the 16 bit flags/offset field of the header */
+#define IPV4_FRAG_MF (NET_IPV4_MF << 13)
+#define IPV4_FRAG_DF (NET_IPV4_DF << 13)
+
+static void reassembly_timeout(struct k_work *work);
+static bool reassembly_init_done;
+static K_MUTEX_DEFINE(reassembly_lock);
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+static inline uint16_t ipv4_frag_field(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->offset[0] << 8) | hdr->offset[1];
+}
+
+static inline uint16_t ipv4_frag_id(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->id[0] << 8) | hdr->id[1];
+}
+
+static inline uint16_t ipv4_frag_payload_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ipv4_opts_len(pkt);
+}
+
+static struct net_ipv4_reassembly *reassembly_get(uint16_t id,
+						  struct in_addr *src,
+						  struct in_addr *dst,
+						  uint8_t protocol)
+{
+	int i, avail = -1;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (k_work_delayable_remaining_get(&reassembly[i].timer) &&
+		    reassembly[i].id == id &&
+		    reassembly[i].protocol == protocol &&
+		    net_ipv4_addr_cmp(src, &reassembly[i].src) &&
+		    net_ipv4_addr_cmp(dst, &reassembly[i].dst)) {
+			return &reassembly[i];
+		}
+
+		if (k_work_delayable_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		if (avail < 0) {
+			avail = i;
+		}
+	}
+
+	if (avail < 0) {
+		return NULL;
+	}
+
+	k_work_reschedule(&reassembly[avail].timer, IPV4_REASSEMBLY_TIMEOUT);
+
+	net_ipaddr_copy(&reassembly[avail].src, src);
+	net_ipaddr_copy(&reassembly[avail].dst, dst);
+
+	reassembly[avail].id = id;
+	reassembly[avail].protocol = protocol;
+
+	return &reassembly[avail];
+}
+
+static void reassembly_cancel(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	k_work_cancel_delayable(&reass->timer);
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] IPv4 reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		net_stats_update_ipv4_frag_drop(net_pkt_iface(reass->pkt[i]));
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reass->id = 0U;
+	reass->protocol = 0U;
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms", str, reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		k_ticks_to_ms_ceil32(
+			k_work_delayable_remaining_get(&reass->timer)));
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct net_ipv4_reassembly *reass =
+		CONTAINER_OF(dwork, struct net_ipv4_reassembly, timer);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	reassembly_info("Reassembly cancelled", reass);
+
+	if (reass->pkt[0]) {
+		net_stats_update_ipv4_frag_timeout(net_pkt_iface(reass->pkt[0]));
+
+		/* RFC 792: if the first fragment has been received, tell the
+		 * sender that the reassembly time was exceeded.
+		 */
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[0]) == 0U) {
+			net_icmpv4_send_error(reass->pkt[0],
+					      NET_ICMPV4_TIME_EXCEEDED,
+					      NET_ICMPV4_TIME_EXCEEDED_REASSEMBLY);
+		}
+	}
+
+	reassembly_cancel(reass);
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+static void reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	struct net_pkt *pkt;
+	struct net_buf *last;
+	int i;
+
+	k_work_cancel_delayable(&reass->timer);
+
+	NET_ASSERT(reass->pkt[0]);
+
+	last = net_buf_frag_last(reass->pkt[0]->buffer);
+
+	/* We start from 2nd packet which is then appended to
+	 * the first one.
+	 */
+	for (i = 1; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		int removed_len;
+
+		pkt = reass->pkt[i];
+		if (!pkt) {
+			break;
+		}
+
+		net_pkt_cursor_init(pkt);
+
+		/* Get rid of IPv4 header and options which are at
+		 * the beginning of the fragment.
+		 */
+		removed_len = net_pkt_ip_hdr_len(pkt) +
+			      net_pkt_ipv4_opts_len(pkt);
+
+		NET_DBG("Removing %d bytes from start of pkt %p",
+			removed_len, pkt->buffer);
+
+		if (net_pkt_pull(pkt, removed_len)) {
+			NET_ERR("Failed to pull headers");
+			reassembly_cancel(reass);
+			return;
+		}
+
+		/* Attach the data to previous pkt */
+		last->frags = pkt->buffer;
+		last = net_buf_frag_last(pkt->buffer);
+
+		pkt->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(pkt);
+	}
+
+	pkt = reass->pkt[0];
+	reass->pkt[0] = NULL;
+	reass->id = 0U;
+	reass->protocol = 0U;
+
+	/* Next we need to clear the fragment information from the header
+	 * of the first packet and fix the total length and checksum.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ipv4_hdr) {
+		goto error;
+	}
+
+	ipv4_hdr->offset[0] &= ~(IPV4_FRAG_MF >> 8) &
+			       ~(NET_IPV4_FRAGH_OFFSET_MASK >> 8);
+	ipv4_hdr->offset[1] = 0U;
+	ipv4_hdr->len = htons(net_pkt_get_len(pkt));
+	ipv4_hdr->chksum = 0U;
+
+	if (net_if_need_calc_rx_checksum(net_pkt_iface(pkt))) {
+		ipv4_hdr->chksum = net_calc_chksum_ipv4(pkt);
+	}
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt,
+		net_pkt_get_len(pkt));
+
+	net_stats_update_ipv4_frag_reassembled(net_pkt_iface(pkt));
+
+	/* We need to use the queue when feeding the packet back into the
+	 * IP stack as we might run out of stack if we call processing_data()
+	 * directly. As the packet does not contain link layer header, we
+	 * MUST NOT pass it to L2 so there will be a special check for that
+	 * in process_data() when handling the packet.
+	 */
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+	net_pkt_unref(pkt);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	for (i = 0; reassembly_init_done &&
+		     i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!k_work_delayable_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+/* Verify whether all the fragments have been received. Returns 1 if the
+ * packet is complete, 0 if more fragments are needed and a negative value
+ * if the fragments overlap or the packet would be too large.
+ */
+static int fragment_verify(struct net_ipv4_reassembly *reass)
+{
+	uint32_t expected = 0U;
+	uint16_t offset;
+	int i;
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			return 0;
+		}
+
+		offset = net_pkt_ipv4_fragment_offset(reass->pkt[i]);
+
+		NET_DBG("pkt %p offset %u expected %u", reass->pkt[i],
+			offset, expected);
+
+		if (offset > expected) {
+			/* There is a hole, wait for more fragments */
+			return 0;
+		}
+
+		if (offset < expected) {
+			/* Overlapping fragments are not accepted */
+			return -EINVAL;
+		}
+
+		expected += ipv4_frag_payload_len(reass->pkt[i]);
+
+		if (expected + net_pkt_ip_hdr_len(reass->pkt[0]) +
+		    net_pkt_ipv4_opts_len(reass->pkt[0]) > UINT16_MAX) {
+			return -EMSGSIZE;
+		}
+
+		if (!net_pkt_ipv4_fragment_more(reass->pkt[i])) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Insert the fragment to the reassembly chain so that the fragments are
+ * ordered by their offset.
+ */
+static int fragment_insert(struct net_ipv4_reassembly *reass,
+			   struct net_pkt *pkt)
+{
+	uint16_t offset = net_pkt_ipv4_fragment_offset(pkt);
+	int i;
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			break;
+		}
+
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[i]) == offset) {
+			/* Duplicate fragment */
+			return -EALREADY;
+		}
+
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[i]) > offset) {
+			break;
+		}
+	}
+
+	if (i == NET_IPV4_FRAGMENTS_MAX_PKT ||
+	    reass->pkt[NET_IPV4_FRAGMENTS_MAX_PKT - 1]) {
+		return -ENOMEM;
+	}
+
+	memmove(&reass->pkt[i + 1], &reass->pkt[i],
+		sizeof(void *) * (NET_IPV4_FRAGMENTS_MAX_PKT - i - 1));
+
+	NET_DBG("Storing pkt %p to slot %d offset %d", pkt, i, offset);
+
+	reass->pkt[i] = pkt;
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass = NULL;
+	enum net_verdict verdict = NET_OK;
+	uint16_t flag;
+	int ret;
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	if (!reassembly_init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+			k_work_init_delayable(&reassembly[i].timer,
+					      reassembly_timeout);
+		}
+
+		reassembly_init_done = true;
+	}
+
+	net_stats_update_ipv4_frag_recv(net_pkt_iface(pkt));
+
+	flag = ipv4_frag_field(hdr);
+
+	net_pkt_set_ipv4_fragment_offset(pkt,
+				(flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U);
+	net_pkt_set_ipv4_fragment_more(pkt, (flag & IPV4_FRAG_MF) != 0U);
+	net_pkt_set_ipv4_fragment_id(pkt, ipv4_frag_id(hdr));
+
+	if (net_pkt_ipv4_fragment_more(pkt) &&
+	    (ipv4_frag_payload_len(pkt) % 8U)) {
+		/* Only the last fragment can have a length that is not
+		 * a multiple of 8 bytes.
+		 */
+		NET_DBG("DROP: invalid fragment length %u",
+			ipv4_frag_payload_len(pkt));
+		goto drop;
+	}
+
+	reass = reassembly_get(net_pkt_ipv4_fragment_id(pkt), &hdr->src,
+			       &hdr->dst, hdr->proto);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		goto drop;
+	}
+
+	ret = fragment_insert(reass, pkt);
+	if (ret == -EALREADY) {
+		NET_DBG("Duplicate fragment offset %u for 0x%x",
+			net_pkt_ipv4_fragment_offset(pkt), reass->id);
+		goto drop;
+	} else if (ret < 0) {
+		/* We could not add this fragment into our saved fragment
+		 * list. We must discard the whole packet at this point.
+		 */
+		NET_DBG("No slots available for 0x%x", reass->id);
+		reassembly_cancel(reass);
+		goto drop;
+	}
+
+	ret = fragment_verify(reass);
+	if (ret < 0) {
+		NET_DBG("Reassembled IPv4 verify failed, dropping id %u",
+			reass->id);
+		reassembly_cancel(reass);
+		goto out;
+	} else if (ret == 0) {
+		reassembly_info("Reassembly nth pkt", reass);
+		NET_DBG("More fragments to be received");
+		goto out;
+	}
+
+	reassembly_info("Reassembly last pkt", reass);
+
+	/* All the fragments received, reassemble the packet */
+	reassemble_packet(reass);
+
+	goto out;
+
+drop:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+	verdict = NET_DROP;
+out:
+	k_mutex_unlock(&reassembly_lock);
+
+	return verdict;
+}
+
+/* Only the options that have the copied flag set are replicated into the
+ * fragments following the first one (RFC 791 ch. 3.1).
+ */
+static int get_copied_opts(uint8_t *opts, uint8_t total_len,
+			   uint8_t *copied, uint8_t *copied_len)
+{
+	uint8_t len = 0U;
+	uint8_t pos = 0U;
+
+	while (pos < total_len) {
+		uint8_t opt_type = opts[pos];
+		uint8_t opt_len;
+
+		if (opt_type == NET_IPV4_OPTS_EO) {
+			break;
+		}
+
+		if (opt_type == NET_IPV4_OPTS_NOP) {
+			pos++;
+			continue;
+		}
+
+		if (pos + 1 >= total_len) {
+			return -EINVAL;
+		}
+
+		opt_len = opts[pos + 1];
+		if (opt_len < 2U || pos + opt_len > total_len) {
+			return -EINVAL;
+		}
+
+		if (opt_type & NET_IPV4_OPTS_COPIED) {
+			memcpy(&copied[len], &opts[pos], opt_len);
+			len += opt_len;
+		}
+
+		pos += opt_len;
+	}
+
+	/* Header length is counted in 32 bit words */
+	while (len % 4U) {
+		copied[len++] = NET_IPV4_OPTS_EO;
+	}
+
+	*copied_len = len;
+
+	return 0;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt,
+			      uint16_t id,
+			      const uint8_t *opts,
+			      uint8_t opts_len,
+			      uint16_t fit_len,
+			      uint16_t frag_offset,
+			      bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	struct net_pkt *frag_pkt;
+	uint16_t flag;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     sizeof(struct net_ipv4_hdr) +
+					     opts_len + fit_len,
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	/* We copy the original IPv4 header, the options that belong to
+	 * this fragment and the payload part of this fragment.
+	 */
+	if (net_pkt_copy(frag_pkt, pkt, sizeof(struct net_ipv4_hdr)) ||
+	    (opts_len && net_pkt_write(frag_pkt, opts, opts_len)) ||
+	    net_pkt_skip(pkt, net_pkt_ipv4_opts_len(pkt) + frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_ipv4_opts_len(frag_pkt, opts_len);
+	net_pkt_set_ipv4_ttl(frag_pkt, net_pkt_ipv4_ttl(pkt));
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt,
+							   &ipv4_access);
+	if (!ipv4_hdr) {
+		goto fail;
+	}
+
+	flag = (ipv4_frag_field(ipv4_hdr) & IPV4_FRAG_DF) |
+	       (frag_offset / 8U);
+	if (!final) {
+		flag |= IPV4_FRAG_MF;
+	}
+
+	ipv4_hdr->vhl       = 0x40 | (0x0F & ((sizeof(struct net_ipv4_hdr) +
+					       opts_len) / 4U));
+	ipv4_hdr->id[0]     = id >> 8;
+	ipv4_hdr->id[1]     = id;
+	ipv4_hdr->offset[0] = flag >> 8;
+	ipv4_hdr->offset[1] = flag;
+	ipv4_hdr->len       = htons(net_pkt_get_len(frag_pkt));
+	ipv4_hdr->chksum    = 0U;
+
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		ipv4_hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(frag_pkt);
+
+	/* If everything has been ok so far, we can send the packet. */
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_stats_update_ipv4_frag_sent(net_pkt_iface(pkt));
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 uint16_t pkt_len, uint16_t mtu)
+{
+	uint8_t copied[NET_IPV4_HDR_OPTNS_MAX_LEN];
+	uint8_t opts[NET_IPV4_HDR_OPTNS_MAX_LEN];
+	uint8_t opts_len = net_pkt_ipv4_opts_len(pkt);
+	uint8_t copied_len = 0U;
+	uint16_t frag_offset;
+	uint16_t hdr_len;
+	size_t length;
+	uint16_t id;
+	int fit_len;
+	int ret;
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + opts_len;
+
+	if (opts_len) {
+		net_pkt_cursor_init(pkt);
+
+		if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt)) ||
+		    net_pkt_read(pkt, opts, opts_len)) {
+			return -ENOBUFS;
+		}
+
+		ret = get_copied_opts(opts, opts_len, copied, &copied_len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	/* The payload of all but the last fragment must be a multiple of
+	 * 8 bytes. The first fragment carries all the options so it
+	 * determines how much payload fits into each fragment.
+	 */
+	fit_len = (int)(mtu - hdr_len) & ~0x07;
+	if (fit_len <= 0) {
+		NET_DBG("No room for IPv4 payload MTU %d hdrs_len %d",
+			mtu, hdr_len);
+		return -EINVAL;
+	}
+
+	do {
+		id = sys_rand32_get();
+	} while (id == 0U);
+
+	frag_offset = 0U;
+	length = pkt_len - hdr_len;
+
+	net_stats_update_ipv4_frag_fragmented(iface);
+
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		if (frag_offset == 0U) {
+			ret = send_ipv4_fragment(pkt, id, opts, opts_len,
+						 fit_len, frag_offset, final);
+		} else {
+			ret = send_ipv4_fragment(pkt, id, copied, copied_len,
+						 fit_len, frag_offset, final);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ip_hdr;
+	size_t pkt_len;
+	uint16_t mtu;
+	uint16_t flag;
+	int ret;
+
+	NET_ASSERT(pkt && pkt->buffer);
+
+	ip_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ip_hdr) {
+		return NET_DROP;
+	}
+
+	flag = ipv4_frag_field(ip_hdr);
+
+	/* If the packet is already a fragment, there is nothing to do.
+	 * Large TCP packets are split into segments later instead.
+	 */
+	if ((flag & (IPV4_FRAG_MF | NET_IPV4_FRAGH_OFFSET_MASK)) ||
+	    net_pkt_gso_size(pkt)) {
+		return NET_OK;
+	}
+
+	/* If the MTU is not known, let the packet through as is. */
+	mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	pkt_len = net_pkt_get_len(pkt);
+
+	if (mtu == 0U || pkt_len <= mtu) {
+		return NET_OK;
+	}
+
+	if (flag & IPV4_FRAG_DF) {
+		NET_DBG("DROP: pkt %p len %zd > MTU %u and DF set", pkt,
+			pkt_len, mtu);
+		net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+		return NET_DROP;
+	}
+
+	ret = net_ipv4_send_fragmented_pkt(net_pkt_iface(pkt), pkt, pkt_len,
+					   mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			return NET_OK;
+		}
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet. This is crucial thing to do here and will
+	 * cause free memory access if not done.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet sending. */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments will be sent separately to network.
+	 */
+	return NET_CONTINUE;
+}
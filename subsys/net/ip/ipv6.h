@@ -384,33 +384,72 @@ static inline void net_ipv6_nbr_set_reachable_timer(struct net_if *iface,
 }
 #endif
 
-/* We do not have to accept larger than 1500 byte IPv6 packet (RFC 2460 ch 5).
- * This means that we should receive everything within first two fragments.
- * The first one being 1280 bytes and the second one 220 bytes.
- */
 #if !defined(NET_IPV6_FRAGMENTS_MAX_PKT)
+#if defined(CONFIG_NET_IPV6_FRAGMENT_MAX_PKT)
+#define NET_IPV6_FRAGMENTS_MAX_PKT CONFIG_NET_IPV6_FRAGMENT_MAX_PKT
+#else
 #define NET_IPV6_FRAGMENTS_MAX_PKT 2
 #endif
+#endif
+
+/** Part of the payload of a fragmented IPv6 packet that has been received */
+struct net_ipv6_frag_range {
+	/** Offset of the first byte of the fragment */
+	uint16_t start;
+
+	/** Offset of the byte following the fragment */
+	uint16_t end;
+};
 
 /** Store pending IPv6 fragment information that is needed for reassembly. */
 struct net_ipv6_reassembly {
+	/** Node in the reassembly hash table or in the free list */
+	sys_snode_t node;
+
 	/** IPv6 source address of the fragment */
 	struct in6_addr src;
 
 	/** IPv6 destination address of the fragment */
 	struct in6_addr dst;
 
+	/** Timeout for cancelling the reassembly. */
+	struct k_work_delayable timer;
+
 	/**
-	 * Timeout for cancelling the reassembly. The timer is used
-	 * also to detect if this reassembly slot is used or not.
+	 * Reassembled packet. It holds the headers of the first fragment
+	 * and the payload of all the fragments, each one copied at its
+	 * offset when received. NULL if this reassembly slot is not used.
 	 */
-	struct k_work_delayable timer;
+	struct net_pkt *pkt;
 
-	/** Pointers to pending fragments */
-	struct net_pkt *pkt[NET_IPV6_FRAGMENTS_MAX_PKT];
+	/** Fragments received, sorted by offset */
+	struct net_ipv6_frag_range range[NET_IPV6_FRAGMENTS_MAX_PKT];
 
 	/** IPv6 fragment identification */
 	uint32_t id;
+
+	/** Bytes reserved for the reassembled packet */
+	uint16_t size;
+
+	/** Length of the headers preceding the fragment header */
+	uint16_t hdr_len;
+
+	/** Offset of the next header field that points to the fragment
+	 * header
+	 */
+	uint16_t hdr_prev;
+
+	/** Payload length, known once the last fragment is received */
+	uint16_t payload_len;
+
+	/** Number of fragments received */
+	uint8_t count;
+
+	/** Next header value of the fragment header */
+	uint8_t nexthdr;
+
+	/** Has the last fragment been received */
+	bool last;
 };
 
 /**
@@ -42,10 +42,20 @@ LOG_MODULE_DECLARE(net_ipv6, CONFIG_NET_IPV6_LOG_LEVEL);
 
 static void reassembly_timeout(struct k_work *work);
 static bool reassembly_init_done;
+static K_MUTEX_DEFINE(reassembly_lock);
 
 static struct net_ipv6_reassembly
 reassembly[CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT];
 
+/* Pending reassemblies are hashed by addresses and fragment id, the unused
+ * ones are kept in the free list.
+ */
+static sys_slist_t reassembly_hash[CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE];
+static sys_slist_t reassembly_free;
+
+/* Bytes reserved by all the pending reassemblies */
+static size_t reassembly_mem;
+
 int net_ipv6_find_last_ext_hdr(struct net_pkt *pkt, uint16_t *next_hdr_off,
 			       uint16_t *last_hdr_off)
 {
@@ -121,86 +131,127 @@ fail:
 	return -EINVAL;
 }
 
-static struct net_ipv6_reassembly *reassembly_get(uint32_t id,
-						  struct in6_addr *src,
-						  struct in6_addr *dst)
+static inline sys_slist_t *reassembly_bucket(uint32_t id,
+					     const struct in6_addr *src,
+					     const struct in6_addr *dst)
 {
-	int i, avail = -1;
+	uint32_t hash = id;
+	int i;
 
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		if (k_work_delayable_remaining_get(&reassembly[i].timer) &&
-		    reassembly[i].id == id &&
-		    net_ipv6_addr_cmp(src, &reassembly[i].src) &&
-		    net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			return &reassembly[i];
-		}
+	for (i = 0; i < 4; i++) {
+		hash ^= UNALIGNED_GET(&src->s6_addr32[i]);
+		hash *= 0x45d9f3bU;
+		hash ^= UNALIGNED_GET(&dst->s6_addr32[i]);
+		hash *= 0x45d9f3bU;
+	}
 
-		if (k_work_delayable_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
+	hash ^= hash >> 16;
 
-		if (avail < 0) {
-			avail = i;
-		}
-	}
+	return &reassembly_hash[hash % CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE];
+}
 
-	if (avail < 0) {
-		return NULL;
+static void reassembly_init(void)
+{
+	int i;
+
+	/* Static initializing does not work here because of the array
+	 * so we must do it at runtime.
+	 */
+	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
+		k_work_init_delayable(&reassembly[i].timer,
+				      reassembly_timeout);
+		sys_slist_append(&reassembly_free, &reassembly[i].node);
 	}
 
-	k_work_reschedule(&reassembly[avail].timer, IPV6_REASSEMBLY_TIMEOUT);
+	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE; i++) {
+		sys_slist_init(&reassembly_hash[i]);
+	}
 
-	net_ipaddr_copy(&reassembly[avail].src, src);
-	net_ipaddr_copy(&reassembly[avail].dst, dst);
+	reassembly_init_done = true;
+}
 
-	reassembly[avail].id = id;
+static struct net_ipv6_reassembly *reassembly_find(uint32_t id,
+						   struct in6_addr *src,
+						   struct in6_addr *dst)
+{
+	struct net_ipv6_reassembly *reass;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(reassembly_bucket(id, src, dst), reass,
+				     node) {
+		if (reass->id == id &&
+		    net_ipv6_addr_cmp(src, &reass->src) &&
+		    net_ipv6_addr_cmp(dst, &reass->dst)) {
+			return reass;
+		}
+	}
 
-	return &reassembly[avail];
+	return NULL;
 }
 
-static bool reassembly_cancel(uint32_t id,
-			      struct in6_addr *src,
-			      struct in6_addr *dst)
+static struct net_ipv6_reassembly *reassembly_new(uint32_t id,
+						  struct in6_addr *src,
+						  struct in6_addr *dst,
+						  uint16_t hdr_len)
 {
-	int i, j;
+	struct net_ipv6_reassembly *reass;
+	sys_snode_t *node;
 
-	NET_DBG("Cancel 0x%x", id);
+	node = sys_slist_get(&reassembly_free);
+	if (!node) {
+		return NULL;
+	}
 
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		int32_t remaining;
+	reass = CONTAINER_OF(node, struct net_ipv6_reassembly, node);
 
-		if (reassembly[i].id != id ||
-		    !net_ipv6_addr_cmp(src, &reassembly[i].src) ||
-		    !net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			continue;
-		}
+	net_ipaddr_copy(&reass->src, src);
+	net_ipaddr_copy(&reass->dst, dst);
 
-		remaining = k_ticks_to_ms_ceil32(
-			k_work_delayable_remaining_get(&reassembly[i].timer));
-		k_work_cancel_delayable(&reassembly[i].timer);
+	reass->id = id;
+	reass->hdr_len = hdr_len;
 
-		NET_DBG("IPv6 reassembly id 0x%x remaining %d ms",
-			reassembly[i].id, remaining);
+	sys_slist_prepend(reassembly_bucket(id, src, dst), &reass->node);
 
-		reassembly[i].id = 0U;
+	k_work_reschedule(&reass->timer, IPV6_REASSEMBLY_TIMEOUT);
 
-		for (j = 0; j < NET_IPV6_FRAGMENTS_MAX_PKT; j++) {
-			if (!reassembly[i].pkt[j]) {
-				continue;
-			}
+	return reass;
+}
 
-			NET_DBG("[%d] IPv6 reassembly pkt %p %zd bytes data",
-				j, reassembly[i].pkt[j],
-				net_pkt_get_len(reassembly[i].pkt[j]));
+/* Give the slot back to the free list. The reassembled packet, if any, must
+ * have been released or handed over by the caller.
+ */
+static void reassembly_release(struct net_ipv6_reassembly *reass)
+{
+	k_work_cancel_delayable(&reass->timer);
 
-			net_pkt_unref(reassembly[i].pkt[j]);
-			reassembly[i].pkt[j] = NULL;
-		}
+	sys_slist_find_and_remove(reassembly_bucket(reass->id, &reass->src,
+						    &reass->dst),
+				  &reass->node);
+	sys_slist_append(&reassembly_free, &reass->node);
+
+	reassembly_mem -= reass->size;
+
+	reass->pkt = NULL;
+	reass->id = 0U;
+	reass->size = 0U;
+	reass->hdr_len = 0U;
+	reass->hdr_prev = 0U;
+	reass->payload_len = 0U;
+	reass->count = 0U;
+	reass->last = false;
+}
+
+static void reassembly_cancel(struct net_ipv6_reassembly *reass)
+{
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	if (reass->pkt) {
+		NET_DBG("IPv6 reassembly pkt %p %zd bytes data", reass->pkt,
+			net_pkt_get_len(reass->pkt));
 
-		return true;
+		net_pkt_unref(reass->pkt);
 	}
 
-	return false;
+	reassembly_release(reass);
 }
 
 static void reassembly_info(char *str, struct net_ipv6_reassembly *reass)
@@ -214,125 +265,215 @@ static void reassembly_info(char *str, struct net_ipv6_reassembly *reass)
 
 static void reassembly_timeout(struct k_work *work)
 {
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
 	struct net_ipv6_reassembly *reass =
-		CONTAINER_OF(work, struct net_ipv6_reassembly, timer);
+		CONTAINER_OF(dwork, struct net_ipv6_reassembly, timer);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	/* The slot might have been released, or used for another packet,
+	 * while we were waiting for the lock.
+	 */
+	if (!reass->pkt || k_work_delayable_remaining_get(&reass->timer)) {
+		goto out;
+	}
 
 	reassembly_info("Reassembly cancelled", reass);
 
-	reassembly_cancel(reass->id, &reass->src, &reass->dst);
+	net_stats_update_ipv6_frag_timeout(net_pkt_iface(reass->pkt));
+
+	reassembly_cancel(reass);
+
+out:
+	k_mutex_unlock(&reassembly_lock);
 }
 
-static void reassemble_packet(struct net_ipv6_reassembly *reass)
+/* Point the link address of the packet to a copy stored in the headroom of
+ * the buffer, as the fragment it comes from is released before the packet
+ * is reassembled.
+ */
+static void reassembly_set_lladdr(struct net_linkaddr *lladdr,
+				  struct net_buf *buf,
+				  const struct net_linkaddr *orig)
 {
-	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access, struct net_ipv6_hdr);
-	NET_PKT_DATA_ACCESS_DEFINE(frag_access, struct net_ipv6_frag_hdr);
-	union {
-		struct net_ipv6_hdr *hdr;
-		struct net_ipv6_frag_hdr *frag_hdr;
-	} ipv6;
+	if (!orig->addr || !orig->len) {
+		return;
+	}
 
-	struct net_pkt *pkt;
-	struct net_buf *last;
-	uint8_t next_hdr;
-	int i, len;
+	lladdr->addr = net_buf_add_mem(buf, orig->addr, orig->len);
+	lladdr->len = orig->len;
+	lladdr->type = orig->type;
 
-	k_work_cancel_delayable(&reass->timer);
+	net_buf_pull(buf, orig->len);
+}
 
-	NET_ASSERT(reass->pkt[0]);
+/* Extend the packet to len bytes without touching the data, the fragments
+ * are then written in place at their offset.
+ */
+static void reassembly_set_len(struct net_pkt *pkt, size_t len)
+{
+	struct net_buf *buf;
 
-	last = net_buf_frag_last(reass->pkt[0]->buffer);
+	for (buf = pkt->buffer; buf && len; buf = buf->frags) {
+		if (buf->len < len) {
+			net_buf_add(buf, MIN(len - buf->len,
+					     net_buf_tailroom(buf)));
+		}
 
-	/* We start from 2nd packet which is then appended to
-	 * the first one.
-	 */
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		int removed_len;
+		len -= buf->len;
+	}
+}
 
-		pkt = reass->pkt[i];
+/* Make sure that the reassembled packet has room for the headers and "end"
+ * bytes of payload. The packet is allocated, from the RX pool, when the
+ * first fragment is received and extended when a fragment ends past it.
+ */
+static int reassembly_reserve(struct net_ipv6_reassembly *reass,
+			      struct net_pkt *frag, uint32_t end)
+{
+	size_t size = reass->hdr_len + end;
+	size_t len, avail;
 
-		net_pkt_cursor_init(pkt);
+	if (size <= reass->size) {
+		return 0;
+	}
 
-		/* Get rid of IPv6 and fragment header which are at
-		 * the beginning of the fragment.
-		 */
-		removed_len = net_pkt_ipv6_fragment_start(pkt) +
-			      sizeof(struct net_ipv6_frag_hdr);
+	if (size > CONFIG_NET_IPV6_FRAGMENT_MAX_SIZE) {
+		NET_DBG("Reassembled packet would be %zu bytes", size);
+		return -EMSGSIZE;
+	}
+
+	if (reassembly_mem - reass->size + size >
+	    CONFIG_NET_IPV6_FRAGMENT_MEM_LIMIT) {
+		NET_DBG("Reassembly memory limit reached (%zu bytes in use)",
+			reassembly_mem);
+		return -ENOMEM;
+	}
 
-		NET_DBG("Removing %d bytes from start of pkt %p",
-			removed_len, pkt->buffer);
+	if (!reass->pkt) {
+		size_t lladdr_len = net_pkt_lladdr_src(frag)->len +
+				    net_pkt_lladdr_dst(frag)->len;
 
-		if (net_pkt_pull(pkt, removed_len)) {
-			NET_ERR("Failed to pull headers");
-			reassembly_cancel(reass->id, &reass->src, &reass->dst);
-			return;
+		/* The allocator adds room for the IPv6 header */
+		reass->pkt = net_pkt_rx_alloc_with_buffer(
+					net_pkt_iface(frag),
+					size + lladdr_len - NET_IPV6H_LEN,
+					AF_INET6, 0, FRAG_BUF_WAIT);
+		if (!reass->pkt) {
+			return -ENOMEM;
 		}
 
-		/* Attach the data to previous pkt */
-		last->frags = pkt->buffer;
-		last = net_buf_frag_last(pkt->buffer);
-
-		pkt->buffer = NULL;
-		reass->pkt[i] = NULL;
+		reassembly_set_lladdr(net_pkt_lladdr_src(reass->pkt),
+				      reass->pkt->buffer,
+				      net_pkt_lladdr_src(frag));
+		reassembly_set_lladdr(net_pkt_lladdr_dst(reass->pkt),
+				      reass->pkt->buffer,
+				      net_pkt_lladdr_dst(frag));
+
+		net_pkt_set_orig_iface(reass->pkt, net_pkt_orig_iface(frag));
+		net_pkt_set_priority(reass->pkt, net_pkt_priority(frag));
+		net_pkt_set_vlan_tag(reass->pkt, net_pkt_vlan_tag(frag));
+		net_pkt_set_ip_hdr_len(reass->pkt, sizeof(struct net_ipv6_hdr));
+		net_pkt_set_overwrite(reass->pkt, true);
+	} else {
+		len = net_pkt_get_len(reass->pkt);
+		avail = net_pkt_available_buffer(reass->pkt);
+
+		if (len + avail < size &&
+		    net_pkt_alloc_buffer(reass->pkt, size - len - avail, 0,
+					 FRAG_BUF_WAIT)) {
+			return -ENOMEM;
+		}
+	}
 
-		net_pkt_unref(pkt);
+	if (net_pkt_get_len(reass->pkt) +
+	    net_pkt_available_buffer(reass->pkt) < size) {
+		return -ENOMEM;
 	}
 
-	pkt = reass->pkt[0];
-	reass->pkt[0] = NULL;
+	reassembly_set_len(reass->pkt, size);
+
+	reassembly_mem += size - reass->size;
+	reass->size = size;
+
+	return 0;
+}
+
+/* Copy the payload of the fragment, and the headers if this is the first
+ * fragment, at their place in the reassembled packet. The cursor of the
+ * fragment is at the start of its payload.
+ */
+static int reassembly_copy(struct net_ipv6_reassembly *reass,
+			   struct net_pkt *frag, uint16_t offset, uint16_t len)
+{
+	struct net_pkt *pkt = reass->pkt;
 
-	/* Next we need to strip away the fragment header from the first packet
-	 * and set the various pointers and values in packet.
-	 */
 	net_pkt_cursor_init(pkt);
 
-	if (net_pkt_skip(pkt, net_pkt_ipv6_fragment_start(pkt))) {
-		NET_ERR("Failed to move to fragment header");
-		goto error;
-	}
+	if (offset == 0U) {
+		net_pkt_cursor_init(frag);
 
-	ipv6.frag_hdr = (struct net_ipv6_frag_hdr *)net_pkt_get_data(
-							pkt, &frag_access);
-	if (!ipv6.frag_hdr) {
-		NET_ERR("Failed to get fragment header");
-		goto error;
+		if (net_pkt_copy(pkt, frag, reass->hdr_len) ||
+		    net_pkt_skip(frag, NET_IPV6_FRAGH_LEN)) {
+			return -ENOBUFS;
+		}
+	} else if (net_pkt_skip(pkt, reass->hdr_len + offset)) {
+		return -ENOBUFS;
 	}
 
-	next_hdr = ipv6.frag_hdr->nexthdr;
+	return net_pkt_copy(pkt, frag, len);
+}
 
-	if (net_pkt_pull(pkt, sizeof(struct net_ipv6_frag_hdr))) {
-		NET_ERR("Failed to remove fragment header");
-		goto error;
-	}
+static void reassemble_packet(struct net_ipv6_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access, struct net_ipv6_hdr);
+	struct net_ipv6_hdr *ipv6_hdr;
+	struct net_pkt *pkt;
+	uint16_t hdr_prev = reass->hdr_prev;
+	uint16_t hdr_len = reass->hdr_len;
+	uint8_t nexthdr = reass->nexthdr;
+
+	/* The packet is handed over to the IP stack, the slot can be
+	 * used for another packet.
+	 */
+	pkt = reass->pkt;
+	reass->pkt = NULL;
+
+	reassembly_release(reass);
 
-	/* This one updates the previous header's nexthdr value */
-	if (net_pkt_skip(pkt, net_pkt_ipv6_hdr_prev(pkt)) ||
-	    net_pkt_write_u8(pkt, next_hdr)) {
+	/* The fragment header is not copied, so only the previous header
+	 * needs to be changed to point to the header that followed it.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_skip(pkt, hdr_prev) ||
+	    net_pkt_write_u8(pkt, nexthdr)) {
 		goto error;
 	}
 
 	net_pkt_cursor_init(pkt);
 
-	ipv6.hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt, &ipv6_access);
-	if (!ipv6.hdr) {
+	ipv6_hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt, &ipv6_access);
+	if (!ipv6_hdr) {
 		goto error;
 	}
 
-	/* Fix the total length of the IPv6 packet. */
-	len = net_pkt_ipv6_ext_len(pkt);
-	if (len > 0) {
-		NET_DBG("Old pkt %p IPv6 ext len is %d bytes", pkt, len);
-		net_pkt_set_ipv6_ext_len(pkt,
-				len - sizeof(struct net_ipv6_frag_hdr));
-	}
+	ipv6_hdr->len = htons(net_pkt_get_len(pkt) - NET_IPV6H_LEN);
 
-	len = net_pkt_get_len(pkt) - sizeof(struct net_ipv6_hdr);
+	net_pkt_set_data(pkt, &ipv6_access);
 
-	ipv6.hdr->len = htons(len);
+	net_pkt_set_ipv6_ext_len(pkt, hdr_len - NET_IPV6H_LEN);
 
-	net_pkt_set_data(pkt, &ipv6_access);
+	/* Tells process_data() that the packet has no link layer header */
+	net_pkt_set_ipv6_fragment_start(pkt, hdr_len);
 
-	NET_DBG("New pkt %p IPv6 len is %d bytes", pkt,
-		len + NET_IPV6H_LEN);
+	net_pkt_set_overwrite(pkt, false);
+	net_pkt_cursor_init(pkt);
+
+	NET_DBG("New pkt %p IPv6 len is %zd bytes", pkt,
+		net_pkt_get_len(pkt));
+
+	net_stats_update_ipv6_frag_reassembled(net_pkt_iface(pkt));
 
 	/* We need to use the queue when feeding the packet back into the
 	 * IP stack as we might run out of stack if we call processing_data()
@@ -351,210 +492,248 @@ void net_ipv6_frag_foreach(net_ipv6_frag_cb_t cb, void *user_data)
 {
 	int i;
 
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
 	for (i = 0; reassembly_init_done &&
 		     i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		if (!k_work_delayable_remaining_get(&reassembly[i].timer)) {
+		if (!reassembly[i].pkt) {
 			continue;
 		}
 
 		cb(&reassembly[i], user_data);
 	}
+
+	k_mutex_unlock(&reassembly_lock);
 }
 
-/* Verify that we have all the fragments received and in correct order.
+/* Record the fragment in the list of received ranges. Returns -EALREADY for
+ * an exact duplicate of a fragment already received, -EINVAL if it overlaps
+ * with another fragment and -ENOMEM if there are too many fragments.
  */
-static bool fragment_verify(struct net_ipv6_reassembly *reass)
+static int fragment_insert(struct net_ipv6_reassembly *reass,
+			   uint16_t start, uint16_t end)
 {
-	uint16_t offset;
-	int i, prev_len;
+	int i;
 
-	prev_len = net_pkt_get_len(reass->pkt[0]);
-	offset = net_pkt_ipv6_fragment_offset(reass->pkt[0]);
+	for (i = 0; i < reass->count; i++) {
+		if (reass->range[i].start == start &&
+		    reass->range[i].end == end) {
+			return -EALREADY;
+		}
 
-	NET_DBG("pkt %p offset %u", reass->pkt[0], offset);
+		if (start < reass->range[i].end &&
+		    reass->range[i].start < end) {
+			return -EINVAL;
+		}
 
-	if (offset != 0U) {
-		return false;
+		if (reass->range[i].start > start) {
+			break;
+		}
 	}
 
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		offset = net_pkt_ipv6_fragment_offset(reass->pkt[i]);
-
-		NET_DBG("pkt %p offset %u prev_len %d", reass->pkt[i],
-			offset, prev_len);
+	if (reass->count == NET_IPV6_FRAGMENTS_MAX_PKT) {
+		return -ENOMEM;
+	}
 
-		if (prev_len < offset) {
-			/* Something wrong with the offset value */
-			return false;
-		}
+	memmove(&reass->range[i + 1], &reass->range[i],
+		sizeof(reass->range[0]) * (reass->count - i));
 
-		prev_len = net_pkt_get_len(reass->pkt[i]);
-	}
+	reass->range[i].start = start;
+	reass->range[i].end = end;
+	reass->count++;
 
-	return true;
+	return 0;
 }
 
-static int shift_packets(struct net_ipv6_reassembly *reass, int pos)
+/* Verify that the fragments received cover the whole packet. */
+static bool fragment_verify(struct net_ipv6_reassembly *reass)
 {
+	uint16_t expected = 0U;
 	int i;
 
-	for (i = pos + 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (!reass->pkt[i]) {
-			NET_DBG("Moving [%d] %p (offset 0x%x) to [%d]",
-				pos, reass->pkt[pos],
-				net_pkt_ipv6_fragment_offset(reass->pkt[pos]),
-				i);
-
-			/* Do we have enough space in packet array to make
-			 * the move?
-			 */
-			if (((i - pos) + 1) >
-			    (NET_IPV6_FRAGMENTS_MAX_PKT - i)) {
-				return -ENOMEM;
-			}
-
-			memmove(&reass->pkt[i], &reass->pkt[pos],
-				sizeof(void *) * (i - pos));
+	if (!reass->last) {
+		return false;
+	}
 
-			return 0;
+	for (i = 0; i < reass->count; i++) {
+		if (reass->range[i].start != expected) {
+			/* There is a hole, wait for more fragments */
+			return false;
 		}
+
+		expected = reass->range[i].end;
 	}
 
-	return -EINVAL;
+	return expected == reass->payload_len;
 }
 
 enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 					      struct net_ipv6_hdr *hdr,
 					      uint8_t nexthdr)
 {
+	NET_PKT_DATA_ACCESS_DEFINE(frag_access, struct net_ipv6_frag_hdr);
 	struct net_ipv6_reassembly *reass = NULL;
+	struct net_if *iface = net_pkt_iface(pkt);
+	struct net_ipv6_frag_hdr *frag_hdr;
+	uint16_t hdr_len, offset, len;
+	uint8_t frag_nexthdr;
+	uint32_t end;
 	uint16_t flag;
-	bool found;
-	uint8_t more;
 	uint32_t id;
-	int i;
+	bool more;
+	int ret;
 
-	if (!reassembly_init_done) {
-		/* Static initializing does not work here because of the array
-		 * so we must do it at runtime.
-		 */
-		for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-			k_work_init_delayable(&reassembly[i].timer,
-					      reassembly_timeout);
-		}
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
 
-		reassembly_init_done = true;
+	if (!reassembly_init_done) {
+		reassembly_init();
 	}
 
-	/* Each fragment has a fragment header, however since we already
-	 * read the nexthdr part of it, we are not going to use
-	 * net_pkt_get_data() and access the header directly: the cursor
-	 * being 1 byte too far, let's just read the next relevant pieces.
+	net_stats_update_ipv6_frag_recv(iface);
+
+	/* The caller has already read the next header field of the
+	 * fragment header, so read the whole header again from its start.
 	 */
-	if (net_pkt_skip(pkt, 1) || /* reserved */
-	    net_pkt_read_be16(pkt, &flag) ||
-	    net_pkt_read_be32(pkt, &id)) {
-		goto drop;
+	hdr_len = net_pkt_ipv6_fragment_start(pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_skip(pkt, hdr_len)) {
+		goto invalid;
 	}
 
-	reass = reassembly_get(id, &hdr->src, &hdr->dst);
-	if (!reass) {
-		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
-		goto drop;
+	frag_hdr = (struct net_ipv6_frag_hdr *)net_pkt_get_data(pkt,
+								&frag_access);
+	if (!frag_hdr) {
+		goto invalid;
 	}
 
+	frag_nexthdr = frag_hdr->nexthdr;
+	flag = ntohs(frag_hdr->offset);
+	id = ntohl(frag_hdr->id);
+
+	net_pkt_acknowledge_data(pkt, &frag_access);
+
 	more = flag & 0x01;
-	net_pkt_set_ipv6_fragment_offset(pkt, flag & 0xfff8);
+	offset = flag & 0xfff8;
+	len = net_pkt_get_len(pkt) - hdr_len - NET_IPV6_FRAGH_LEN;
+	end = offset + len;
 
-	if (!reass->pkt[0]) {
-		NET_DBG("Storing pkt %p to slot %d offset %d",
-			pkt, 0, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[0] = pkt;
+	net_pkt_set_ipv6_fragment_offset(pkt, offset);
+	net_pkt_set_ipv6_fragment_id(pkt, id);
 
-		reassembly_info("Reassembly 1st pkt", reass);
+	if (more && (len == 0U || len % 8)) {
+		/* Fragment length is not multiple of 8, discard
+		 * the packet and send parameter problem error.
+		 */
+		NET_DBG("DROP: invalid fragment length %u", len);
+		net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
+				      NET_ICMPV6_PARAM_PROB_HEADER,
+				      offsetof(struct net_ipv6_hdr, len));
+		goto invalid;
+	}
 
-		/* Wait for more fragments to receive. */
-		goto accept;
+	reass = reassembly_find(id, &hdr->src, &hdr->dst);
+	if (!reass) {
+		reass = reassembly_new(id, &hdr->src, &hdr->dst, hdr_len);
+		if (!reass) {
+			NET_DBG("Cannot get reassembly slot, dropping pkt %p",
+				pkt);
+			net_stats_update_ipv6_frag_no_slot(iface);
+			goto drop;
+		}
 	}
 
-	/* The fragments might come in wrong order so place them
-	 * in reassembly chain in correct order.
+	/* The payload is placed after the headers of the first fragment
+	 * received, the headers of the fragment at offset 0 must then be
+	 * as long. The fragments must also end at the same place as the
+	 * last fragment.
 	 */
-	for (i = 0, found = false; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			if (net_pkt_ipv6_fragment_offset(reass->pkt[i]) <
-			    net_pkt_ipv6_fragment_offset(pkt)) {
-				continue;
-			}
-
-			/* Make room for this fragment. If there is no room,
-			 * then it will discard the whole reassembly.
-			 */
-			if (shift_packets(reass, i)) {
-				break;
-			}
-		}
+	if ((offset == 0U && hdr_len != reass->hdr_len) ||
+	    (reass->last && end > reass->payload_len) ||
+	    (!more && reass->last && end != reass->payload_len) ||
+	    (!more && reass->count &&
+	     reass->range[reass->count - 1].end > end)) {
+		NET_DBG("DROP: inconsistent fragment offset %u len %u for 0x%x",
+			offset, len, id);
+		net_stats_update_ipv6_frag_invalid(iface);
+		goto cancel;
+	}
+
+	ret = reassembly_reserve(reass, pkt, end);
+	if (ret == -EMSGSIZE) {
+		net_stats_update_ipv6_frag_too_big(iface);
+		goto cancel;
+	} else if (ret < 0) {
+		net_stats_update_ipv6_frag_no_mem(iface);
+		goto cancel;
+	}
+
+	ret = fragment_insert(reass, offset, end);
+	if (ret == -EALREADY) {
+		NET_DBG("Duplicate fragment offset %u for 0x%x", offset, id);
+		net_stats_update_ipv6_frag_duplicate(iface);
+		goto drop;
+	} else if (ret == -EINVAL) {
+		/* RFC 5722: the whole packet is discarded if any of its
+		 * fragments overlap.
+		 */
+		NET_DBG("DROP: overlapping fragment offset %u for 0x%x",
+			offset, id);
+		net_stats_update_ipv6_frag_overlap(iface);
+		goto cancel;
+	} else if (ret < 0) {
+		NET_DBG("DROP: too many fragments for 0x%x", id);
+		net_stats_update_ipv6_frag_too_big(iface);
+		goto cancel;
+	}
 
-		NET_DBG("Storing pkt %p to slot %d offset %d",
-			pkt, i, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[i] = pkt;
-		found = true;
+	if (reassembly_copy(reass, pkt, offset, len) < 0) {
+		NET_DBG("Cannot copy fragment offset %u for 0x%x", offset, id);
+		net_stats_update_ipv6_frag_no_mem(iface);
+		goto cancel;
+	}
 
-		break;
+	if (offset == 0U) {
+		reass->hdr_prev = net_pkt_ipv6_hdr_prev(pkt);
+		reass->nexthdr = frag_nexthdr;
 	}
 
-	if (!found) {
-		/* We could not add this fragment into our saved fragment
-		 * list. We must discard the whole packet at this point.
-		 */
-		NET_DBG("No slots available for 0x%x", reass->id);
-		net_pkt_unref(pkt);
-		goto drop;
+	if (!more) {
+		reass->last = true;
+		reass->payload_len = end;
 	}
 
-	if (more) {
-		if (net_pkt_get_len(pkt) % 8) {
-			/* Fragment length is not multiple of 8, discard
-			 * the packet and send parameter problem error.
-			 */
-			net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
-					      NET_ICMPV6_PARAM_PROB_OPTION, 0);
-			goto drop;
-		}
+	NET_DBG("Stored pkt %p offset %u len %u", pkt, offset, len);
 
-		reassembly_info("Reassembly nth pkt", reass);
+	/* The data has been copied, the fragment is not needed anymore */
+	net_pkt_unref(pkt);
 
+	if (!fragment_verify(reass)) {
+		reassembly_info("Reassembly nth pkt", reass);
 		NET_DBG("More fragments to be received");
 		goto accept;
 	}
 
 	reassembly_info("Reassembly last pkt", reass);
 
-	if (!fragment_verify(reass)) {
-		NET_DBG("Reassembled IPv6 verify failed, dropping id %u",
-			reass->id);
-
-		/* Let the caller release the already inserted pkt */
-		if (i < NET_IPV6_FRAGMENTS_MAX_PKT) {
-			reass->pkt[i] = NULL;
-		}
-
-		net_pkt_unref(pkt);
-		goto drop;
-	}
-
-	/* The last fragment received, reassemble the packet */
+	/* All the fragments received, pass the packet to the IP stack */
 	reassemble_packet(reass);
 
 accept:
+	k_mutex_unlock(&reassembly_lock);
+
 	return NET_OK;
 
+invalid:
+	net_stats_update_ipv6_frag_invalid(iface);
+	goto drop;
+
+cancel:
+	reassembly_cancel(reass);
+
 drop:
-	if (reass) {
-		if (reassembly_cancel(reass->id, &reass->src, &reass->dst)) {
-			return NET_OK;
-		}
-	}
+	k_mutex_unlock(&reassembly_lock);
 
 	return NET_DROP;
 }
@@ -1245,26 +1245,66 @@ static int get_context_sndtimeo(struct net_context *context,
 #endif
 }
 
+static int get_context_rcvbuf(struct net_context *context,
+			      void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+	*((uint16_t *)value) = context->options.rcvbuf;
+
+	if (len) {
+		*len = sizeof(uint16_t);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_sndbuf(struct net_context *context,
+			      void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_SNDBUF)
+	*((uint16_t *)value) = context->options.sndbuf;
+
+	if (len) {
+		*len = sizeof(uint16_t);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 /* If buf is not NULL, then use it. Otherwise read the data to be written
  * to net_pkt from msghdr.
  */
+/* If chksum is set, the Internet checksum of the data is calculated while
+ * it is copied into the packet.
+ */
 static int context_write_data(struct net_pkt *pkt, const void *buf,
-			      int buf_len, const struct msghdr *msghdr)
+			      int buf_len, const struct msghdr *msghdr,
+			      bool chksum)
 {
+	int (*write_data)(struct net_pkt *pkt, const void *data,
+			  size_t length);
 	int ret = 0;
 
+	write_data = chksum ? net_pkt_write_chksum : net_pkt_write;
+
 	if (msghdr) {
 		int i;
 
 		for (i = 0; i < msghdr->msg_iovlen; i++) {
-			ret = net_pkt_write(pkt, msghdr->msg_iov[i].iov_base,
-					    msghdr->msg_iov[i].iov_len);
+			ret = write_data(pkt, msghdr->msg_iov[i].iov_base,
+					 msghdr->msg_iov[i].iov_len);
 			if (ret < 0) {
 				break;
 			}
 		}
 	} else {
-		ret = net_pkt_write(pkt, buf, buf_len);
+		ret = write_data(pkt, buf, buf_len);
 	}
 
 	return ret;
@@ -1316,7 +1356,9 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = context_write_data(pkt, buf, len, msg);
+	ret = context_write_data(pkt, buf, len, msg,
+				 net_if_need_calc_tx_checksum(
+					 net_pkt_iface(pkt)));
 	if (ret) {
 		return ret;
 	}
@@ -1651,7 +1693,7 @@ static int context_sendto(struct net_context *context,
 
 	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
 	    net_if_is_ip_offloaded(net_context_get_iface(context))) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1680,7 +1722,7 @@ static int context_sendto(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_TCP) &&
 		   net_context_get_ip_proto(context) == IPPROTO_TCP) {
 
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1694,7 +1736,7 @@ static int context_sendto(struct net_context *context,
 		ret = net_tcp_send_data(context, cb, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1710,7 +1752,7 @@ static int context_sendto(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN &&
 		   net_context_get_ip_proto(context) == CAN_RAW) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -2206,6 +2248,43 @@ static int set_context_sndtimeo(struct net_context *context,
 #endif
 }
 
+static int set_context_rcvbuf(struct net_context *context,
+			      const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+	if (len != sizeof(uint16_t)) {
+		return -EINVAL;
+	}
+
+	context->options.rcvbuf = *((uint16_t *)value);
+
+	/* Let TCP resize the advertised window */
+	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		(void)net_tcp_update_recv_wnd(context, 0);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int set_context_sndbuf(struct net_context *context,
+			      const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_SNDBUF)
+	if (len != sizeof(uint16_t)) {
+		return -EINVAL;
+	}
+
+	context->options.sndbuf = *((uint16_t *)value);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -2236,6 +2315,12 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_SNDTIMEO:
 		ret = set_context_sndtimeo(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = set_context_rcvbuf(context, value, len);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = set_context_sndbuf(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -2273,6 +2358,12 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_SNDTIMEO:
 		ret = get_context_sndtimeo(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = get_context_rcvbuf(context, value, len);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = get_context_sndbuf(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -78,6 +78,15 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Same as above for a reassembled IPv4 packet. The first fragment
+	 * always has the more fragments flag set.
+	 */
+	if (net_pkt_ipv4_fragment_more(pkt)) {
+		locally_routed = true;
+	}
+#endif
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
@@ -99,6 +108,8 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		}
 	}
 
+	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
+
 	/* L2 processed, now we can pass IPPROTO_RAW to packet socket: */
 	ret = net_packet_socket_input(pkt, IPPROTO_RAW);
 	if (ret != NET_CONTINUE) {
@@ -378,6 +389,16 @@ static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_rx_priority2tc(prio);
 
+#if defined(CONFIG_NET_RX_RSS)
+	/* Spread the flows of this interface to the RSS workers instead
+	 * of the traffic class queues.
+	 */
+	if (net_if_rx_rss_is_enabled(iface)) {
+		net_tc_submit_to_rss_queue(iface, pkt);
+		return;
+	}
+#endif
+
 #if defined(CONFIG_NET_STATISTICS)
 	net_stats_update_tc_recv_pkt(iface, tc);
 	net_stats_update_tc_recv_bytes(iface, tc, net_pkt_get_len(pkt));
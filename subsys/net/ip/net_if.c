@@ -22,8 +22,10 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 #include <net/virtual.h>
 
 #include "net_private.h"
+#include "ipv4.h"
 #include "ipv6.h"
 #include "ipv4_autoconf_internal.h"
+#include "tcp_internal.h"
 
 #include "net_stats.h"
 
@@ -109,6 +111,11 @@ static struct k_thread tx_thread_ts;
 /* We keep track of the timestamp callbacks in this list.
  */
 static sys_slist_t timestamp_callbacks;
+
+/* Protects the timestamp callback list. The callbacks are run with this
+ * lock held, so it is kept separate from the interface lock.
+ */
+static K_MUTEX_DEFINE(timestamp_lock);
 #endif /* CONFIG_NET_PKT_TIMESTAMP_THREAD */
 
 #if CONFIG_NET_IF_LOG_LEVEL >= LOG_LEVEL_DBG
@@ -336,6 +343,17 @@ void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_tx_priority2tc(prio);
 
+#if defined(CONFIG_NET_TCP_GSO)
+	/* Large TCP packets are split here, just before they are queued,
+	 * unless the device can do the segmentation itself. The segments
+	 * are queued separately.
+	 */
+	if (net_pkt_gso_size(pkt) && net_if_need_tcp_segmentation(iface)) {
+		net_tcp_gso_segment(iface, pkt);
+		return;
+	}
+#endif
+
 	net_stats_update_tc_sent_pkt(iface, tc);
 	net_stats_update_tc_sent_bytes(iface, tc, net_pkt_get_len(pkt));
 	net_stats_update_tc_sent_priority(iface, tc, prio);
@@ -475,6 +493,11 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 		verdict = net_ipv6_prepare_for_send(pkt);
 	}
 
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+
 done:
 	/*   NET_OK in which case packet has checked successfully. In this case
 	 *   the net_context callback is called after successful delivery in
@@ -3939,6 +3962,33 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface)
 	return need_calc_checksum(iface, ETHERNET_HW_RX_CHKSUM_OFFLOAD);
 }
 
+static bool has_hw_capability(struct net_if *iface,
+			      enum ethernet_hw_caps caps)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) != &NET_L2_GET_NAME(ETHERNET)) {
+		return false;
+	}
+
+	return (net_eth_get_hw_capabilities(iface) & caps) == caps;
+#else
+	ARG_UNUSED(iface);
+	ARG_UNUSED(caps);
+
+	return false;
+#endif
+}
+
+bool net_if_need_tcp_segmentation(struct net_if *iface)
+{
+	return !has_hw_capability(iface, ETHERNET_HW_TSO);
+}
+
+bool net_if_need_tcp_coalescing(struct net_if *iface)
+{
+	return !has_hw_capability(iface, ETHERNET_HW_LRO);
+}
+
 int net_if_get_by_iface(struct net_if *iface)
 {
 	if (!(iface >= _net_if_list_start && iface < _net_if_list_end)) {
@@ -4196,17 +4246,55 @@ bool net_if_is_suspended(struct net_if *iface)
 #endif /* CONFIG_NET_POWER_MANAGEMENT */
 
 #if defined(CONFIG_NET_PKT_TIMESTAMP_THREAD)
+static void call_timestamp_cb_locked(struct net_pkt *pkt)
+{
+	sys_snode_t *sn, *sns;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&timestamp_callbacks, sn, sns) {
+		struct net_if_timestamp_cb *handle =
+			CONTAINER_OF(sn, struct net_if_timestamp_cb, node);
+
+		if (((handle->iface == NULL) ||
+		     (handle->iface == net_pkt_iface(pkt))) &&
+		    (handle->pkt == NULL || handle->pkt == pkt)) {
+			handle->cb(pkt);
+		}
+	}
+}
+
 static void net_tx_ts_thread(void)
 {
 	struct net_pkt *pkt;
+	sys_slist_t pkts;
 
 	NET_DBG("Starting TX timestamp callback thread");
 
 	while (1) {
 		pkt = k_fifo_get(&tx_ts_queue, K_FOREVER);
-		if (pkt) {
-			net_if_call_timestamp_cb(pkt);
+		if (!pkt) {
+			continue;
 		}
+
+		/* Drivers often complete several timestamps at once, so
+		 * take everything that is queued and deliver it under one
+		 * lock of the callback list. The packets are linked through
+		 * their first word, like in the fifo.
+		 */
+		sys_slist_init(&pkts);
+
+		do {
+			sys_slist_append(&pkts, (sys_snode_t *)pkt);
+			pkt = k_fifo_get(&tx_ts_queue, K_NO_WAIT);
+		} while (pkt);
+
+		k_mutex_lock(&timestamp_lock, K_FOREVER);
+
+		while (!sys_slist_is_empty(&pkts)) {
+			pkt = (struct net_pkt *)sys_slist_get(&pkts);
+			call_timestamp_cb_locked(pkt);
+		}
+
+		k_mutex_unlock(&timestamp_lock);
 	}
 }
 
@@ -4215,7 +4303,7 @@ void net_if_register_timestamp_cb(struct net_if_timestamp_cb *handle,
 				  struct net_if *iface,
 				  net_if_timestamp_callback_t cb)
 {
-	k_mutex_lock(&lock, K_FOREVER);
+	k_mutex_lock(&timestamp_lock, K_FOREVER);
 
 	sys_slist_find_and_remove(&timestamp_callbacks, &handle->node);
 	sys_slist_prepend(&timestamp_callbacks, &handle->node);
@@ -4224,36 +4312,23 @@ void net_if_register_timestamp_cb(struct net_if_timestamp_cb *handle,
 	handle->cb = cb;
 	handle->pkt = pkt;
 
-	k_mutex_unlock(&lock);
+	k_mutex_unlock(&timestamp_lock);
 }
 
 void net_if_unregister_timestamp_cb(struct net_if_timestamp_cb *handle)
 {
-	k_mutex_lock(&lock, K_FOREVER);
+	k_mutex_lock(&timestamp_lock, K_FOREVER);
 
 	sys_slist_find_and_remove(&timestamp_callbacks, &handle->node);
 
-	k_mutex_unlock(&lock);
+	k_mutex_unlock(&timestamp_lock);
 }
 
 void net_if_call_timestamp_cb(struct net_pkt *pkt)
 {
-	sys_snode_t *sn, *sns;
-
-	k_mutex_lock(&lock, K_FOREVER);
-
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&timestamp_callbacks, sn, sns) {
-		struct net_if_timestamp_cb *handle =
-			CONTAINER_OF(sn, struct net_if_timestamp_cb, node);
-
-		if (((handle->iface == NULL) ||
-		     (handle->iface == net_pkt_iface(pkt))) &&
-		    (handle->pkt == NULL || handle->pkt == pkt)) {
-			handle->cb(pkt);
-		}
-	}
-
-	k_mutex_unlock(&lock);
+	k_mutex_lock(&timestamp_lock, K_FOREVER);
+	call_timestamp_cb_locked(pkt);
+	k_mutex_unlock(&timestamp_lock);
 }
 
 void net_if_add_tx_timestamp(struct net_pkt *pkt)
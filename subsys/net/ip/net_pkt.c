@@ -118,8 +118,13 @@ K_MEM_SLAB_DEFINE(tx_pkts, sizeof(struct net_pkt), CONFIG_NET_PKT_TX_COUNT, 4);
 
 #if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
 
+#if defined(CONFIG_NET_BUF_VARIABLE_RX_DATA_SIZE)
+NET_BUF_POOL_VAR_DEFINE(rx_bufs, CONFIG_NET_BUF_RX_COUNT,
+			CONFIG_NET_BUF_RX_DATA_POOL_SIZE, NULL);
+#else
 NET_BUF_POOL_FIXED_DEFINE(rx_bufs, CONFIG_NET_BUF_RX_COUNT,
 			  CONFIG_NET_BUF_DATA_SIZE, NULL);
+#endif
 NET_BUF_POOL_FIXED_DEFINE(tx_bufs, CONFIG_NET_BUF_TX_COUNT,
 			  CONFIG_NET_BUF_DATA_SIZE, NULL);
 
@@ -362,6 +367,22 @@ void net_pkt_print_frags(struct net_pkt *pkt)
 }
 #endif /* CONFIG_NET_PKT_LOG_LEVEL >= LOG_LEVEL_DBG */
 
+static inline struct net_buf *frag_alloc(struct net_buf_pool *pool,
+					 k_timeout_t timeout)
+{
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+	/* Fragments taken from a variable data size pool get the size of
+	 * the fixed ones, as the callers expect.
+	 */
+	if (pool->alloc->cb != &net_buf_fixed_cb) {
+		return net_buf_alloc_len(pool, CONFIG_NET_BUF_DATA_SIZE,
+					 timeout);
+	}
+#endif
+
+	return net_buf_alloc(pool, timeout);
+}
+
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 struct net_buf *net_pkt_get_reserve_data_debug(struct net_buf_pool *pool,
 					       k_timeout_t timeout,
@@ -380,9 +401,9 @@ struct net_buf *net_pkt_get_reserve_data(struct net_buf_pool *pool,
 	 */
 
 	if (k_is_in_isr()) {
-		frag = net_buf_alloc(pool, K_NO_WAIT);
+		frag = frag_alloc(pool, K_NO_WAIT);
 	} else {
-		frag = net_buf_alloc(pool, timeout);
+		frag = frag_alloc(pool, timeout);
 	}
 
 	if (!frag) {
@@ -404,6 +425,43 @@ struct net_buf *net_pkt_get_reserve_data(struct net_buf_pool *pool,
 	return frag;
 }
 
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+static inline struct k_mem_slab *get_iface_slab(struct net_if *iface,
+						bool rx)
+{
+	if (!iface) {
+		return NULL;
+	}
+
+	return rx ? iface->rx_slab : iface->tx_slab;
+}
+
+static inline struct net_buf_pool *get_iface_data_pool(struct net_if *iface,
+						       bool rx)
+{
+	if (!iface) {
+		return NULL;
+	}
+
+	return rx ? iface->rx_data_pool : iface->tx_data_pool;
+}
+#else
+#define get_iface_slab(...) NULL
+#define get_iface_data_pool(...) NULL
+#endif /* CONFIG_NET_IF_NET_PKT_POOL */
+
+/* Dedicated data pool of the interface the packet was allocated on. The
+ * packet can be on another interface by now.
+ */
+static inline struct net_buf_pool *pkt_data_pool(struct net_pkt *pkt)
+{
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+	return pkt->data_pool;
+#else
+	return NULL;
+#endif
+}
+
 /* Get a fragment, try to figure out the pool from where to get
  * the data.
  */
@@ -416,6 +474,9 @@ struct net_buf *net_pkt_get_frag(struct net_pkt *pkt,
 				 k_timeout_t timeout)
 #endif
 {
+	struct net_buf_pool *pool;
+	struct net_buf *frag;
+
 #if defined(CONFIG_NET_CONTEXT_NET_PKT_POOL)
 	struct net_context *context;
 
@@ -430,7 +491,23 @@ struct net_buf *net_pkt_get_frag(struct net_pkt *pkt,
 	}
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 
-	if (pkt->slab == &rx_pkts) {
+	/* Only borrow from the common pool once the dedicated pool of the
+	 * interface is empty.
+	 */
+	pool = pkt_data_pool(pkt);
+	if (pool) {
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+		frag = net_pkt_get_reserve_data_debug(pool, K_NO_WAIT,
+						      caller, line);
+#else
+		frag = net_pkt_get_reserve_data(pool, K_NO_WAIT);
+#endif
+		if (frag) {
+			return frag;
+		}
+	}
+
+	if (pkt->rx_pkt) {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 		return net_pkt_get_reserve_rx_data_debug(timeout,
 							 caller, line);
@@ -733,6 +810,8 @@ void net_pkt_frag_add(struct net_pkt *pkt, struct net_buf *frag)
 	/* We do not use net_buf_frag_add() as this one will refcount
 	 * the frag once more if !pkt->frags
 	 */
+	net_pkt_set_payload_chksum(pkt, 0U, 0U);
+
 	if (!pkt->frags) {
 		pkt->frags = frag;
 		return;
@@ -868,7 +947,10 @@ static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 	while (size) {
 		struct net_buf *new;
 
-		new = net_buf_alloc_fixed(pool, timeout);
+		/* A variable data size pool, as the RX one can be, gives
+		 * the whole size at once.
+		 */
+		new = net_buf_alloc_len(pool, size, timeout);
 		if (!new) {
 			goto error;
 		}
@@ -988,6 +1070,13 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 		}
 	}
 
+	if (net_pkt_gso_size(pkt) && size > max_len) {
+		/* TCP has marked the packet for segmentation, it is split
+		 * into MTU sized segments before it is sent.
+		 */
+		max_len = size;
+	}
+
 	max_len -= existing;
 
 	return MIN(size, max_len);
@@ -1103,6 +1192,7 @@ int net_pkt_remove_tail(struct net_pkt *pkt, size_t length)
 	}
 
 	remaining_len -= length;
+	net_pkt_set_payload_chksum(pkt, 0U, 0U);
 
 	while (buf) {
 		if (buf->len >= remaining_len) {
@@ -1138,10 +1228,11 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 #endif
 {
 	uint64_t end = sys_clock_timeout_end_calc(timeout);
+	struct net_buf_pool *dedicated = NULL;
 	struct net_buf_pool *pool = NULL;
 	size_t alloc_len = 0;
 	size_t hdr_len = 0;
-	struct net_buf *buf;
+	struct net_buf *buf = NULL;
 
 	if (!size && proto == 0 && net_pkt_family(pkt) == AF_UNSPEC) {
 		return 0;
@@ -1173,7 +1264,8 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 	}
 
 	if (!pool) {
-		pool = pkt->slab == &tx_pkts ? &tx_bufs : &rx_bufs;
+		dedicated = pkt_data_pool(pkt);
+		pool = pkt->rx_pkt ? &rx_bufs : &tx_bufs;
 	}
 
 	if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT) &&
@@ -1187,11 +1279,25 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 		}
 	}
 
+	/* Only borrow from the common pool once the dedicated pool of the
+	 * interface is empty.
+	 */
+	if (dedicated) {
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+		buf = pkt_alloc_buffer(dedicated, alloc_len, K_NO_WAIT,
+				       caller, line);
+#else
+		buf = pkt_alloc_buffer(dedicated, alloc_len, K_NO_WAIT);
+#endif
+	}
+
+	if (!buf) {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	buf = pkt_alloc_buffer(pool, alloc_len, timeout, caller, line);
+		buf = pkt_alloc_buffer(pool, alloc_len, timeout, caller, line);
 #else
-	buf = pkt_alloc_buffer(pool, alloc_len, timeout);
+		buf = pkt_alloc_buffer(pool, alloc_len, timeout);
 #endif
+	}
 
 	if (!buf) {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
@@ -1260,6 +1366,7 @@ static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout)
 		net_pkt_set_priority(pkt, TX_DEFAULT_PRIORITY);
 	} else if (&rx_pkts == slab) {
 		net_pkt_set_priority(pkt, RX_DEFAULT_PRIORITY);
+		pkt->rx_pkt = 1U;
 	}
 
 	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS) ||
@@ -1338,16 +1445,44 @@ static struct net_pkt *pkt_alloc_on_iface(struct k_mem_slab *slab,
 
 #endif
 {
-	struct net_pkt *pkt;
+	struct k_mem_slab *dedicated;
+	struct net_pkt *pkt = NULL;
 
+	/* Only borrow from the common slab once the dedicated slab of the
+	 * interface is empty.
+	 */
+	dedicated = get_iface_slab(iface, slab == &rx_pkts);
+	if (dedicated) {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	pkt = pkt_alloc(slab, timeout, caller, line);
+		pkt = pkt_alloc(dedicated, K_NO_WAIT, caller, line);
 #else
-	pkt = pkt_alloc(slab, timeout);
+		pkt = pkt_alloc(dedicated, K_NO_WAIT);
 #endif
+		if (pkt) {
+			net_pkt_set_priority(pkt, slab == &rx_pkts ?
+					     RX_DEFAULT_PRIORITY :
+					     TX_DEFAULT_PRIORITY);
+			pkt->rx_pkt = slab == &rx_pkts;
+		}
+	}
+
+	if (!pkt) {
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+		pkt = pkt_alloc(slab, timeout, caller, line);
+#else
+		pkt = pkt_alloc(slab, timeout);
+#endif
+	}
 
 	if (pkt) {
 		net_pkt_set_iface(pkt, iface);
+
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+		/* Keep taking the data from the pools of this interface,
+		 * even once the packet is on another one.
+		 */
+		pkt->data_pool = get_iface_data_pool(iface, pkt->rx_pkt);
+#endif
 	}
 
 	return pkt;
@@ -1582,6 +1717,28 @@ static void pkt_cursor_update(struct net_pkt *pkt,
 	}
 }
 
+/* The payload checksum calculated by net_pkt_write_chksum() covers the
+ * last bytes of the packet. Forget it if the data it covers is modified,
+ * or if new data is appended after it.
+ */
+static void pkt_payload_chksum_invalidate(struct net_pkt *pkt, size_t length)
+{
+	size_t pkt_len;
+
+	if (!net_pkt_payload_chksum_len(pkt)) {
+		return;
+	}
+
+	pkt_len = net_pkt_get_len(pkt);
+
+	if (!net_pkt_is_being_overwritten(pkt) ||
+	    pkt_len < net_pkt_payload_chksum_len(pkt) ||
+	    net_pkt_get_current_offset(pkt) + length >
+	    pkt_len - net_pkt_payload_chksum_len(pkt)) {
+		net_pkt_set_payload_chksum(pkt, 0U, 0U);
+	}
+}
+
 /* Internal function that does all operation (skip/read/write/memset) */
 static int net_pkt_cursor_operate(struct net_pkt *pkt,
 				  void *data, size_t length,
@@ -1590,6 +1747,10 @@ static int net_pkt_cursor_operate(struct net_pkt *pkt,
 	/* We use such variable to avoid lengthy lines */
 	struct net_pkt_cursor *c_op = &pkt->cursor;
 
+	if (write && (data || !net_pkt_is_being_overwritten(pkt))) {
+		pkt_payload_chksum_invalidate(pkt, length);
+	}
+
 	while (c_op->buf && length) {
 		size_t d_len, len;
 		/* LS : overwrite bit  가 true 이면 false , false 이면 write 값 넘김 */
@@ -1714,6 +1875,60 @@ int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length)
 	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true);
 }
 
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length)
+{
+	struct net_pkt_cursor *c_op = &pkt->cursor;
+	size_t offset = net_pkt_payload_chksum_len(pkt);
+	uint16_t sum = net_pkt_payload_chksum(pkt);
+
+	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
+
+	if (!IS_ENABLED(CONFIG_NET_CHKSUM_ON_COPY) ||
+	    net_pkt_is_being_overwritten(pkt) ||
+	    offset + length > UINT16_MAX) {
+		/* The data written earlier is no longer at the end */
+		net_pkt_set_payload_chksum(pkt, 0U, 0U);
+
+		return net_pkt_write(pkt, data, length);
+	}
+
+	while (c_op->buf && length) {
+		size_t d_len, len;
+
+		pkt_cursor_advance(pkt, true);
+		if (c_op->buf == NULL) {
+			break;
+		}
+
+		d_len = net_buf_max_len(c_op->buf) -
+			(c_op->pos - c_op->buf->data);
+		if (!d_len) {
+			break;
+		}
+
+		len = MIN(length, d_len);
+
+		sum = net_calc_chksum_copy(sum, offset, c_op->pos, data, len);
+
+		net_buf_add(c_op->buf, len);
+		pkt_cursor_update(pkt, len, true);
+
+		data = (const uint8_t *)data + len;
+		offset += len;
+		length -= len;
+	}
+
+	net_pkt_set_payload_chksum(pkt, sum, offset);
+
+	if (length) {
+		NET_DBG("Still some length to go %zu", length);
+		return -ENOBUFS;
+	}
+
+	return 0;
+}
+
 int net_pkt_copy(struct net_pkt *pkt_dst,
 		 struct net_pkt *pkt_src,
 		 size_t length)
@@ -1721,6 +1936,8 @@ int net_pkt_copy(struct net_pkt *pkt_dst,
 	struct net_pkt_cursor *c_dst = &pkt_dst->cursor;
 	struct net_pkt_cursor *c_src = &pkt_src->cursor;
 
+	pkt_payload_chksum_invalidate(pkt_dst, length);
+
 	while (c_dst->buf && c_src->buf && length) {
 		size_t s_len, d_len, len;
 
@@ -1920,6 +2137,8 @@ int net_pkt_update_length(struct net_pkt *pkt, size_t length)
 {
 	struct net_buf *buf;
 
+	net_pkt_set_payload_chksum(pkt, 0U, 0U);
+
 	for (buf = pkt->buffer; buf; buf = buf->frags) {
 		if (buf->len < length) {
 			length -= buf->len;
@@ -1936,6 +2155,8 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 {
 	struct net_pkt_cursor *c_op = &pkt->cursor;
 
+	net_pkt_set_payload_chksum(pkt, 0U, 0U);
+
 	while (length) {
 		size_t left, rem;
 
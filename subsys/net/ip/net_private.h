@@ -90,6 +90,8 @@ static inline enum net_verdict net_ipv6_input(struct net_pkt *pkt,
 #endif
 extern bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt);
 extern void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt);
+extern void net_tc_submit_to_rss_queue(struct net_if *iface,
+				       struct net_pkt *pkt);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
 char *net_sprint_addr(sa_family_t af, const void *addr);
@@ -133,6 +135,11 @@ enum net_verdict net_gptp_recv(struct net_if *iface, struct net_pkt *pkt);
 #define net_gptp_recv(iface, pkt) NET_DROP
 #endif /* CONFIG_NET_GPTP */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 uint16_t pkt_len, uint16_t mtu);
+#endif
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 int net_ipv6_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
 				 uint16_t pkt_len);
@@ -144,6 +151,20 @@ extern char *net_sprint_ll_addr_buf(const uint8_t *ll, uint8_t ll_len,
 				    char *buf, int buflen);
 extern uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto);
 
+/**
+ * @brief Copy data and add its Internet checksum to a partial sum
+ *
+ * @param sum    Partial sum of the previous data, not complemented
+ * @param offset Offset of the copied data from the start of the summed data
+ * @param dst    Where to copy the data
+ * @param src    Data to copy
+ * @param len    Length of the data
+ *
+ * @return Updated partial sum, not complemented
+ */
+uint16_t net_calc_chksum_copy(uint16_t sum, size_t offset, void *dst,
+			      const void *src, size_t len);
+
 /**
  * @brief Deliver the incoming packet through the recv_cb of the net_context
  *        to the upper layers
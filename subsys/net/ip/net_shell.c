@@ -37,6 +37,7 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #include <sys/slist.h>
 #endif
 
+#include "ipv4.h"
 #include "ipv6.h"
 
 #if defined(CONFIG_NET_ARP)
@@ -257,6 +258,8 @@ struct ethernet_capabilities {
 static struct ethernet_capabilities eth_hw_caps[] = {
 	EC(ETHERNET_HW_TX_CHKSUM_OFFLOAD, "TX checksum offload"),
 	EC(ETHERNET_HW_RX_CHKSUM_OFFLOAD, "RX checksum offload"),
+	EC(ETHERNET_HW_TSO,               "TCP segmentation offload"),
+	EC(ETHERNET_HW_LRO,               "Large receive offload"),
 	EC(ETHERNET_HW_VLAN,              "Virtual LAN"),
 	EC(ETHERNET_HW_VLAN_TAG_STRIP,    "VLAN Tag stripping"),
 	EC(ETHERNET_AUTO_NEGOTIATION_SET, "Auto negotiation"),
@@ -1245,6 +1248,39 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv4_igmp.sent),
 	   GET_STAT(iface, ipv4_igmp.drop));
 #endif /* CONFIG_NET_STATISTICS_IGMP */
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	PR("IPv4 frag recv %d\treass\t%d\tdrop\t%d\ttimeout\t%d\n",
+	   GET_STAT(iface, ipv4_frag.recv),
+	   GET_STAT(iface, ipv4_frag.reassembled),
+	   GET_STAT(iface, ipv4_frag.drop),
+	   GET_STAT(iface, ipv4_frag.timeout));
+	PR("IPv4 frag sent %d\tfragmented\t%d\n",
+	   GET_STAT(iface, ipv4_frag.sent),
+	   GET_STAT(iface, ipv4_frag.fragmented));
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT)
+	PR("IPv6 frag recv %d\treass\t%d\tdup\t%d\ttimeout\t%d\n",
+	   GET_STAT(iface, ipv6_frag.recv),
+	   GET_STAT(iface, ipv6_frag.reassembled),
+	   GET_STAT(iface, ipv6_frag.duplicate),
+	   GET_STAT(iface, ipv6_frag.timeout));
+	PR("IPv6 frag drop overlap %d\ttoo big\t%d\tno mem\t%d\t"
+	   "no slot\t%d\tinvalid\t%d\n",
+	   GET_STAT(iface, ipv6_frag.overlap),
+	   GET_STAT(iface, ipv6_frag.too_big),
+	   GET_STAT(iface, ipv6_frag.no_mem),
+	   GET_STAT(iface, ipv6_frag.no_slot),
+	   GET_STAT(iface, ipv6_frag.invalid));
+#endif /* CONFIG_NET_STATISTICS_IPV6_FRAGMENT */
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	PR("ARP hit        %d\tmiss\t%d\trequest\t%d\n",
+	   GET_STAT(iface, arp.hit),
+	   GET_STAT(iface, arp.miss),
+	   GET_STAT(iface, arp.request));
+	PR("ARP evict      %d\tnegative\t%d\n",
+	   GET_STAT(iface, arp.evict),
+	   GET_STAT(iface, arp.negative));
+#endif /* CONFIG_NET_STATISTICS_ARP */
 #if defined(CONFIG_NET_STATISTICS_UDP) && defined(CONFIG_NET_NATIVE_UDP)
 	PR("UDP recv       %d\tsent\t%d\tdrop\t%d\n",
 	   GET_STAT(iface, udp.recv),
@@ -1283,6 +1319,42 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	print_tc_tx_stats(shell, iface);
 	print_tc_rx_stats(shell, iface);
 
+#if defined(CONFIG_NET_RX_RSS)
+	PR("RSS RX queue statistics:\n");
+	PR("Queue\tRecv pkts\tbytes\n");
+
+	for (int i = 0; i < CONFIG_NET_RX_RSS_QUEUE_COUNT; i++) {
+		PR("[%d]\t%d\t\t%d\n", i,
+		   GET_STAT(iface, rss.queue[i].pkts),
+		   GET_STAT(iface, rss.queue[i].bytes));
+	}
+#endif
+
+#if defined(CONFIG_NET_TC_QDISC)
+	PR("TX qdisc statistics:\n");
+	PR("TC\tQueued\tCoDel drop\tOverlimit\tShaped\tDelay avg/max us\n");
+
+	for (int i = 0; i < NET_TC_TX_COUNT; i++) {
+		net_stats_t count = GET_STAT(iface, qdisc.tc[i].delay.count);
+
+		PR("[%d]\t%d\t%d\t\t%d\t\t%d\t%u/%d\n", i,
+		   GET_STAT(iface, qdisc.tc[i].queued),
+		   GET_STAT(iface, qdisc.tc[i].codel_drop),
+		   GET_STAT(iface, qdisc.tc[i].overlimit_drop),
+		   GET_STAT(iface, qdisc.tc[i].shaped),
+		   count ? (uint32_t)(GET_STAT(iface,
+					       qdisc.tc[i].delay.sum) / count) :
+			   0U,
+		   GET_STAT(iface, qdisc.tc[i].delay_max));
+
+		if (iface && iface->tx_shaper[i].rate) {
+			PR("\tShaper %u bytes/s, burst %u bytes\n",
+			   iface->tx_shaper[i].rate,
+			   iface->tx_shaper[i].burst);
+		}
+	}
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ETHERNET) && \
 					defined(CONFIG_NET_STATISTICS_USER_API)
 	if (iface && net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
@@ -1577,7 +1649,45 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 	   k_ticks_to_ms_ceil32(k_work_delayable_remaining_get(&reass->timer)),
 	   src, net_sprint_ipv6_addr(&reass->dst));
 
-	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
+	PR("pkt %p %u bytes", reass->pkt, reass->size);
+
+	if (reass->last) {
+		PR(", payload %u bytes", reass->payload_len);
+	}
+
+	PR("\n");
+
+	for (i = 0; i < reass->count; i++) {
+		PR("[%d] offset %u len %u\n", i, reass->range[i].start,
+		   reass->range[i].end - reass->range[i].start);
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_IPV6_FRAGMENT */
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static void ipv4_frag_cb(struct net_ipv4_reassembly *reass,
+			 void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	char src[ADDR_LEN];
+	int i;
+
+	if (!*count) {
+		PR("\nIPv4 reassembly Id         Remain "
+		   "Src             \tDst\n");
+	}
+
+	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv4_addr(&reass->src));
+
+	PR("%p      0x%04x      %5d %16s\t%16s\n", reass, reass->id,
+	   k_ticks_to_ms_ceil32(k_work_delayable_remaining_get(&reass->timer)),
+	   src, net_sprint_ipv4_addr(&reass->dst));
+
+	for (i = 0; i < NET_IPV4_FRAGMENTS_MAX_PKT; i++) {
 		if (reass->pkt[i]) {
 			struct net_buf *frag = reass->pkt[i]->frags;
 
@@ -1598,7 +1708,7 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 
 	(*count)++;
 }
-#endif /* CONFIG_NET_IPV6_FRAGMENT */
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
@@ -1995,6 +2105,107 @@ static int cmd_net_capture_disable(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+static int cmd_net_capture_pcapng_start(const struct shell *shell,
+					size_t argc, char *argv[])
+{
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+	struct net_capture_pcapng_params params = { 0 };
+	static char filter[128];
+	int ret, arg = 1, if_index;
+	struct net_if *iface;
+	char *endptr;
+	long snaplen;
+
+	if (argc < 3) {
+		PR_WARNING("Interface index and file name are needed.\n");
+		return -ENOEXEC;
+	}
+
+	if_index = atoi(argv[arg++]);
+	iface = net_if_get_by_index(if_index);
+	if (iface == NULL) {
+		PR_WARNING("No such interface with index %d\n", if_index);
+		return -ENOEXEC;
+	}
+
+	params.path = argv[arg++];
+
+	if (argv[arg] != NULL) {
+		snaplen = strtol(argv[arg], &endptr, 10);
+		if (*endptr == '\0') {
+			if (snaplen < 0 || snaplen > UINT16_MAX) {
+				PR_WARNING("Invalid snap length %s\n",
+					   argv[arg]);
+				return -ENOEXEC;
+			}
+
+			params.snaplen = snaplen;
+			arg++;
+		}
+	}
+
+	/* The rest of the arguments are the filter expression */
+	filter[0] = '\0';
+
+	for (; arg < argc; arg++) {
+		if (strlen(filter) + strlen(argv[arg]) + 2 > sizeof(filter)) {
+			PR_WARNING("Filter is too long.\n");
+			return -ENOEXEC;
+		}
+
+		if (filter[0] != '\0') {
+			strcat(filter, " ");
+		}
+
+		strcat(filter, argv[arg]);
+	}
+
+	params.filter = filter;
+
+	ret = net_capture_pcapng_start(iface, &params);
+	if (ret < 0) {
+		PR_WARNING("Capture %s failed (%d)\n", "start", ret);
+		return -ENOEXEC;
+	}
+#else
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_NET_CAPTURE_PCAPNG", "pcapng packet capture");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_capture_pcapng_stop(const struct shell *shell,
+				       size_t argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+	struct net_capture_pcapng_stats stats;
+	int ret;
+
+	ret = net_capture_pcapng_stop();
+	if (ret < 0) {
+		PR_WARNING("Capture %s failed (%d)\n", "stop", ret);
+		return -ENOEXEC;
+	}
+
+	(void)net_capture_pcapng_stats_get(&stats);
+
+	PR("Captured %u, filtered %u, dropped %u packets\n",
+	   stats.captured, stats.filtered, stats.dropped);
+#else
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_NET_CAPTURE_PCAPNG", "pcapng packet capture");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 {
 	ARG_UNUSED(argc);
@@ -2074,6 +2285,15 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 	/* Do not print anything if no fragments are pending atm */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+	user_data.user_data = &count;
+
+	net_ipv4_frag_foreach(ipv4_frag_cb, &user_data);
+
+	/* Do not print anything if no fragments are pending atm */
+#endif
+
 #else
 	PR_INFO("Set %s to enable %s support.\n",
 		"CONFIG_NET_OFFLOAD or CONFIG_NET_NATIVE",
@@ -2225,6 +2445,83 @@ static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(struct dns_resolve_cache_info *info,
+			 void *user_data)
+{
+	const struct shell *shell = user_data;
+	int i;
+
+	PR("\t%s %s expires in %u ms\n", info->query,
+	   info->query_type == DNS_QUERY_TYPE_A ? "A" : "AAAA",
+	   (uint32_t)info->remaining);
+
+	if (info->addr_count == 0) {
+		PR("\t\tNo such name\n");
+		return;
+	}
+
+	for (i = 0; i < info->addr_count; i++) {
+		if (info->addr[i].sa_family == AF_INET) {
+			PR("\t\t%s\n",
+			   net_sprint_ipv4_addr(&net_sin(&info->addr[i])->
+						sin_addr));
+		} else if (info->addr[i].sa_family == AF_INET6) {
+			PR("\t\t%s\n",
+			   net_sprint_ipv6_addr(&net_sin6(&info->addr[i])->
+						sin6_addr));
+		}
+	}
+}
+#endif
+
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct dns_resolve_cache_stats stats;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	PR("DNS cache:\n");
+
+	if (dns_resolve_cache_foreach(dns_cache_cb, (void *)shell) == 0) {
+		PR("\tNo entries\n");
+	}
+
+	dns_resolve_cache_stats_get(&stats);
+
+	PR("Hits %u, negative hits %u, misses %u, evictions %u\n",
+	   stats.hits, stats.negative_hits, stats.misses, stats.evictions);
+#else
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_DNS_RESOLVER_CACHE", "DNS cache");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_flush(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_resolve_cache_flush();
+
+	PR("DNS cache flushed.\n");
+#else
+	PR_INFO("Set %s to enable %s support.\n",
+		"CONFIG_DNS_RESOLVER_CACHE", "DNS cache");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 			     char *argv[])
 {
@@ -3256,6 +3553,45 @@ static int cmd_net_gptp_port(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+static void gptp_print_servo_hist(const struct shell *shell,
+				  const uint32_t *hist)
+{
+	int i;
+
+	for (i = 0; i < GPTP_SERVO_HIST_SIZE; i++) {
+		if (i < GPTP_SERVO_HIST_SIZE - 1) {
+			PR("\t\t< %-8u ns : %u\n", 16U << i, hist[i]);
+		} else {
+			PR("\t\t>= %-7u ns : %u\n", 16U << (i - 1), hist[i]);
+		}
+	}
+}
+#endif /* CONFIG_NET_GPTP_STATISTICS */
+
+static void gptp_print_servo(const struct shell *shell,
+			     struct gptp_servo *servo)
+{
+	PR("Clock servo:\n");
+	PR("\tFrequency adjustment           : %d ppb\n",
+	   (int32_t)servo->applied_freq);
+
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+	PR("\tOffset samples                 : %u\n", servo->stats.samples);
+	PR("\tClock steps                    : %u\n", servo->stats.steps);
+	PR("\tLast offset                    : %lld ns\n",
+	   servo->stats.last_offset);
+	PR("\tMax offset while locked        : %llu ns\n",
+	   servo->stats.max_offset);
+	PR("\tOffset histogram               :\n");
+	gptp_print_servo_hist(shell, servo->stats.offset_hist);
+	PR("\tPath delay histogram           :\n");
+	gptp_print_servo_hist(shell, servo->stats.path_delay_hist);
+#endif /* CONFIG_NET_GPTP_STATISTICS */
+}
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
+
 static int cmd_net_gptp(const struct shell *shell, size_t argc, char *argv[])
 {
 #if defined(CONFIG_NET_GPTP)
@@ -3306,6 +3642,10 @@ static int cmd_net_gptp(const struct shell *shell, size_t argc, char *argv[])
 		PR("\tThe local clock has expired    : %s\n",
 		   domain->state.clk_master_sync_receive.rcvd_local_clock_tick
 							       ? "yes" : "no");
+
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+		gptp_print_servo(shell, &domain->servo);
+#endif
 	}
 #else
 	ARG_UNUSED(argc);
@@ -5664,6 +6004,19 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_arp,
 	SHELL_SUBCMD_SET_END
 );
 
+SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_capture_pcapng,
+	SHELL_CMD(start, NULL, "Start capturing network packets to a file.\n"
+		  "'net capture pcapng start <interface index> <file> "
+		  "[<snaplen>] [<filter>]'\n"
+		  "<snaplen> is the maximum number of bytes stored per packet,\n"
+		  "<filter> is a tcpdump like expression, for example\n"
+		  "udp port 5683 or (ip6 and not icmp6)",
+		  cmd_net_capture_pcapng_start),
+	SHELL_CMD(stop, NULL, "Stop capturing network packets to a file.",
+		  cmd_net_capture_pcapng_stop),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_capture,
 	SHELL_CMD(setup, NULL, "Setup network packet capture.\n"
 		  "'net capture setup <remote-ip-addr> <local-addr> <peer-addr>'\n"
@@ -5681,12 +6034,18 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_capture,
 		  cmd_net_capture_enable),
 	SHELL_CMD(disable, NULL, "Disable network packet capture.",
 		  cmd_net_capture_disable),
+	SHELL_CMD(pcapng, &net_cmd_capture_pcapng,
+		  "Capture network packets to a pcapng file.", NULL),
 	SHELL_SUBCMD_SET_END
 );
 
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, NULL, "Show the DNS cache.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
+	SHELL_CMD(flush, NULL, "Remove all the entries from the DNS cache.",
+		  cmd_net_dns_flush),
 	SHELL_CMD(query, NULL,
 		  "'net dns <hostname> [A or AAAA]' queries IPv4 address "
 		  "(default) or IPv6 address for a host name.",
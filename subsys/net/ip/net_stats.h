@@ -345,6 +345,197 @@ static inline void net_stats_update_ipv4_igmp_drop(struct net_if *iface)
 #define net_stats_update_ipv4_igmp_drop(iface)
 #endif /* CONFIG_NET_STATISTICS_IGMP */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT) && defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_ipv4_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.recv++);
+}
+
+static inline void net_stats_update_ipv4_frag_reassembled(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv4_frag_sent(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.sent++);
+}
+
+static inline void net_stats_update_ipv4_frag_fragmented(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.fragmented++);
+}
+
+static inline void net_stats_update_ipv4_frag_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.drop++);
+}
+
+static inline void net_stats_update_ipv4_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.timeout++);
+}
+#else
+#define net_stats_update_ipv4_frag_recv(iface)
+#define net_stats_update_ipv4_frag_reassembled(iface)
+#define net_stats_update_ipv4_frag_sent(iface)
+#define net_stats_update_ipv4_frag_fragmented(iface)
+#define net_stats_update_ipv4_frag_drop(iface)
+#define net_stats_update_ipv4_frag_timeout(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT) && defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_ipv6_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.recv++);
+}
+
+static inline void net_stats_update_ipv6_frag_reassembled(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv6_frag_duplicate(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.duplicate++);
+}
+
+static inline void net_stats_update_ipv6_frag_overlap(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.overlap++);
+}
+
+static inline void net_stats_update_ipv6_frag_too_big(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.too_big++);
+}
+
+static inline void net_stats_update_ipv6_frag_no_mem(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.no_mem++);
+}
+
+static inline void net_stats_update_ipv6_frag_no_slot(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.no_slot++);
+}
+
+static inline void net_stats_update_ipv6_frag_invalid(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.invalid++);
+}
+
+static inline void net_stats_update_ipv6_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.timeout++);
+}
+#else
+#define net_stats_update_ipv6_frag_recv(iface)
+#define net_stats_update_ipv6_frag_reassembled(iface)
+#define net_stats_update_ipv6_frag_duplicate(iface)
+#define net_stats_update_ipv6_frag_overlap(iface)
+#define net_stats_update_ipv6_frag_too_big(iface)
+#define net_stats_update_ipv6_frag_no_mem(iface)
+#define net_stats_update_ipv6_frag_no_slot(iface)
+#define net_stats_update_ipv6_frag_invalid(iface)
+#define net_stats_update_ipv6_frag_timeout(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV6_FRAGMENT */
+
+#if defined(CONFIG_NET_STATISTICS_ARP) && defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_arp_hit(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.hit++);
+}
+
+static inline void net_stats_update_arp_miss(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.miss++);
+}
+
+static inline void net_stats_update_arp_request(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.request++);
+}
+
+static inline void net_stats_update_arp_evict(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.evict++);
+}
+
+static inline void net_stats_update_arp_negative(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.negative++);
+}
+#else
+#define net_stats_update_arp_hit(iface)
+#define net_stats_update_arp_miss(iface)
+#define net_stats_update_arp_request(iface)
+#define net_stats_update_arp_evict(iface)
+#define net_stats_update_arp_negative(iface)
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
+#if defined(CONFIG_NET_RX_RSS) && defined(CONFIG_NET_STATISTICS) && \
+	defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_rss_recv(struct net_if *iface,
+					     uint8_t queue, size_t bytes)
+{
+	UPDATE_STAT(iface, stats.rss.queue[queue].pkts++);
+	UPDATE_STAT(iface, stats.rss.queue[queue].bytes += bytes);
+}
+#else
+#define net_stats_update_rss_recv(iface, queue, bytes)
+#endif /* CONFIG_NET_RX_RSS */
+
+#if defined(CONFIG_NET_TC_QDISC) && defined(CONFIG_NET_STATISTICS) && \
+	defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_qdisc_queued(struct net_if *iface,
+						 uint8_t tc)
+{
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].queued++);
+}
+
+static inline void net_stats_update_qdisc_codel_drop(struct net_if *iface,
+						     uint8_t tc)
+{
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].codel_drop++);
+}
+
+static inline void net_stats_update_qdisc_overlimit_drop(struct net_if *iface,
+							 uint8_t tc)
+{
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].overlimit_drop++);
+}
+
+static inline void net_stats_update_qdisc_shaped(struct net_if *iface,
+						 uint8_t tc)
+{
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].shaped++);
+}
+
+static inline void net_stats_update_qdisc_delay(struct net_if *iface,
+						uint8_t tc, uint32_t delay_us)
+{
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].delay.sum += delay_us);
+	UPDATE_STAT(iface, stats.qdisc.tc[tc].delay.count++);
+
+	if (delay_us > net_stats.qdisc.tc[tc].delay_max) {
+		net_stats.qdisc.tc[tc].delay_max = delay_us;
+	}
+
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+	if (delay_us > iface->stats.qdisc.tc[tc].delay_max) {
+		iface->stats.qdisc.tc[tc].delay_max = delay_us;
+	}
+#endif
+}
+#else
+#define net_stats_update_qdisc_queued(iface, tc)
+#define net_stats_update_qdisc_codel_drop(iface, tc)
+#define net_stats_update_qdisc_overlimit_drop(iface, tc)
+#define net_stats_update_qdisc_shaped(iface, tc)
+#define net_stats_update_qdisc_delay(iface, tc, delay_us)
+#endif /* CONFIG_NET_TC_QDISC */
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS) && defined(CONFIG_NET_STATISTICS)
 static inline void net_stats_update_tx_time(struct net_if *iface,
 					    uint32_t start_time,
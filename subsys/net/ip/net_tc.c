@@ -17,6 +17,13 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include "net_private.h"
 #include "net_stats.h"
 #include "net_tc_mapping.h"
+#include "tcp_internal.h"
+
+#if defined(CONFIG_NET_RX_RSS) || defined(CONFIG_NET_TC_QDISC)
+#include <net/ethernet.h>
+
+#include "ipv4.h"
+#endif
 
 /* Template for thread name. The "xx" is either "TX" denoting transmit thread,
  * or "RX" denoting receive thread. The "q[y]" denotes the traffic class queue
@@ -40,7 +47,23 @@ static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 #endif
 
-#if NET_TC_RX_COUNT > 0 || NET_TC_TX_COUNT > 0
+#if defined(CONFIG_NET_RX_RSS)
+/* Template for RSS worker thread name. The y is the queue id. */
+#define RSS_NAME_LEN sizeof("rss_q[y]")
+
+/* Stacks for RSS RX workers */
+K_KERNEL_STACK_ARRAY_DEFINE(rss_stack, CONFIG_NET_RX_RSS_QUEUE_COUNT,
+			    CONFIG_NET_RX_RSS_STACK_SIZE);
+
+static struct net_traffic_class rss_queues[CONFIG_NET_RX_RSS_QUEUE_COUNT];
+#endif
+
+#if defined(CONFIG_NET_TC_QDISC)
+static void qdisc_enqueue(uint8_t tc, struct net_pkt *pkt);
+#endif
+
+#if NET_TC_RX_COUNT > 0 || \
+	(NET_TC_TX_COUNT > 0 && !defined(CONFIG_NET_TC_QDISC))
 static void submit_to_queue(struct k_fifo *queue, struct net_pkt *pkt)
 {
 	k_fifo_put(queue, pkt);
@@ -52,7 +75,11 @@ bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
 #if NET_TC_TX_COUNT > 0
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
+#if defined(CONFIG_NET_TC_QDISC)
+	qdisc_enqueue(tc, pkt);
+#else
 	submit_to_queue(&tx_classes[tc].fifo, pkt);
+#endif
 #else
 	ARG_UNUSED(tc);
 	ARG_UNUSED(pkt);
@@ -72,6 +99,701 @@ void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt)
 #endif
 }
 
+#if defined(CONFIG_NET_RX_RSS) || defined(CONFIG_NET_TC_QDISC)
+/* One round of the MurmurHash3 (32 bit) block mixing. */
+static inline uint32_t flow_mix(uint32_t hash, uint32_t value)
+{
+	value *= 0xcc9e2d51U;
+	value = (value << 15) | (value >> 17);
+	value *= 0x1b873593U;
+
+	hash ^= value;
+	hash = (hash << 13) | (hash >> 19);
+
+	return hash * 5U + 0xe6546b64U;
+}
+
+static uint32_t flow_mix_addr(uint32_t hash, const uint8_t *addr, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i += sizeof(uint32_t)) {
+		hash = flow_mix(hash, UNALIGNED_GET((uint32_t *)&addr[i]));
+	}
+
+	return hash;
+}
+
+static inline uint32_t flow_finalize(uint32_t hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35U;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+/* Calculate a hash over the 5-tuple (addresses, protocol and ports) of the
+ * packet, starting from the IP header at the cursor. For non-IP packets, the
+ * seed is returned as is. The ports are left out for IPv4 fragments and for
+ * IPv6 packets with extension headers so that all the packets of one flow
+ * still map to the same value.
+ */
+static uint32_t flow_hash(struct net_pkt *pkt, uint16_t ptype, uint32_t seed)
+{
+	bool has_ports = false;
+	uint32_t hash = seed;
+	uint8_t proto;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && ptype == NET_ETH_PTYPE_IP) {
+		NET_PKT_DATA_ACCESS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt,
+							      &ipv4_access);
+		if (!hdr) {
+			return seed;
+		}
+
+		proto = hdr->proto;
+		hash = flow_mix_addr(hash, (uint8_t *)&hdr->src,
+				     sizeof(struct in_addr));
+		hash = flow_mix_addr(hash, (uint8_t *)&hdr->dst,
+				     sizeof(struct in_addr));
+
+		has_ports = !(hdr->offset[0] & ((NET_IPV4_MF << 5) |
+					(NET_IPV4_FRAGH_OFFSET_MASK >> 8))) &&
+			    !hdr->offset[1];
+
+		if (net_pkt_skip(pkt, (hdr->vhl & NET_IPV4_IHL_MASK) * 4U)) {
+			has_ports = false;
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   ptype == NET_ETH_PTYPE_IPV6) {
+		NET_PKT_DATA_ACCESS_DEFINE(ipv6_access, struct net_ipv6_hdr);
+		struct net_ipv6_hdr *hdr;
+
+		hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt,
+							      &ipv6_access);
+		if (!hdr) {
+			return seed;
+		}
+
+		proto = hdr->nexthdr;
+		hash = flow_mix_addr(hash, (uint8_t *)&hdr->src,
+				     sizeof(struct in6_addr));
+		hash = flow_mix_addr(hash, (uint8_t *)&hdr->dst,
+				     sizeof(struct in6_addr));
+
+		has_ports = !net_pkt_skip(pkt, sizeof(struct net_ipv6_hdr));
+	} else {
+		return seed;
+	}
+
+	hash = flow_mix(hash, proto);
+
+	if (has_ports && (proto == IPPROTO_UDP || proto == IPPROTO_TCP)) {
+		NET_PKT_DATA_ACCESS_DEFINE(ports_access, struct net_udp_hdr);
+		struct net_udp_hdr *ports;
+
+		/* Both TCP and UDP headers start with the port numbers */
+		ports = (struct net_udp_hdr *)net_pkt_get_data(pkt,
+							       &ports_access);
+		if (ports) {
+			hash = flow_mix(hash,
+					UNALIGNED_GET((uint32_t *)&ports->src_port));
+		}
+	}
+
+	return flow_finalize(hash);
+}
+#endif /* CONFIG_NET_RX_RSS || CONFIG_NET_TC_QDISC */
+
+#if defined(CONFIG_NET_RX_RSS)
+/* A reassembled packet is fed back to the RX path without its link layer
+ * header, see process_data().
+ */
+static inline bool rss_is_reassembled(struct net_pkt *pkt)
+{
+	return net_pkt_ipv6_fragment_start(pkt) ||
+	       net_pkt_ipv4_fragment_more(pkt);
+}
+
+/* Skip the link layer header and return the ethertype of the payload.
+ * For interfaces that deliver plain IP packets, and for reassembled
+ * packets, the type is guessed from the IP version field.
+ */
+static uint16_t rss_skip_ll_hdr(struct net_if *iface, struct net_pkt *pkt)
+{
+	uint16_t ptype;
+	uint8_t vtc;
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET) &&
+	    !rss_is_reassembled(pkt)) {
+		if (net_pkt_skip(pkt, 2 * sizeof(struct net_eth_addr)) ||
+		    net_pkt_read_be16(pkt, &ptype)) {
+			return 0;
+		}
+
+		if (ptype == NET_ETH_PTYPE_VLAN) {
+			if (net_pkt_skip(pkt, sizeof(uint16_t)) ||
+			    net_pkt_read_be16(pkt, &ptype)) {
+				return 0;
+			}
+		}
+
+		return ptype;
+	}
+#else
+	ARG_UNUSED(iface);
+#endif
+
+	if (net_pkt_read_u8(pkt, &vtc)) {
+		return 0;
+	}
+
+	/* Rewind back to the start of the IP header */
+	net_pkt_cursor_init(pkt);
+
+	switch (vtc & 0xf0) {
+	case 0x40:
+		ptype = NET_ETH_PTYPE_IP;
+		break;
+	case 0x60:
+		ptype = NET_ETH_PTYPE_IPV6;
+		break;
+	default:
+		ptype = 0;
+		break;
+	}
+
+	return ptype;
+}
+
+/* Hash of a received packet, the link layer header is still there */
+static uint32_t rss_hash(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct net_pkt_cursor backup;
+	uint32_t hash;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	hash = flow_hash(pkt, rss_skip_ll_hdr(iface, pkt), 0U);
+
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return hash;
+}
+
+void net_tc_submit_to_rss_queue(struct net_if *iface, struct net_pkt *pkt)
+{
+	uint8_t queue;
+
+	queue = rss_hash(iface, pkt) % CONFIG_NET_RX_RSS_QUEUE_COUNT;
+
+	net_stats_update_rss_recv(iface, queue, net_pkt_get_len(pkt));
+
+	NET_DBG("RSS queue %d pkt %p", queue, pkt);
+
+	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
+
+	submit_to_queue(&rss_queues[queue].fifo, pkt);
+}
+#endif /* CONFIG_NET_RX_RSS */
+
+#if defined(CONFIG_NET_TC_QDISC)
+/* Flow queue of the TX scheduler. The packets are linked through their
+ * first word, like in a k_fifo.
+ */
+struct qdisc_flow {
+	/* Node in the new or old flow list */
+	sys_snode_t node;
+
+	/* Queued packets */
+	sys_slist_t pkts;
+
+	/* Number of bytes queued */
+	uint32_t backlog;
+
+	/* Number of bytes the flow can still send in this round */
+	int32_t deficit;
+
+	/* CoDel state */
+	uint32_t first_above_time;
+	uint32_t drop_next;
+	uint32_t count;
+	uint32_t last_count;
+	bool dropping;
+
+	/* Is the flow in the new or old flow list */
+	bool active;
+};
+
+/* Flow queue scheduler of one TX traffic class. Flows that become active
+ * are put in the new flow list, which is served before the old flow list
+ * so that sparse flows see little queueing delay.
+ */
+struct qdisc {
+	struct k_spinlock lock;
+
+	/* Given when packets are queued or the shaper is changed */
+	struct k_sem wait;
+
+	sys_slist_t new_flows;
+	sys_slist_t old_flows;
+
+	struct qdisc_flow flows[CONFIG_NET_TC_QDISC_FLOWS];
+
+	/* Number of flows in the new and old flow lists */
+	uint16_t active;
+
+	/* Number of queued packets */
+	uint16_t len;
+
+	uint8_t tc;
+};
+
+static struct qdisc tx_qdiscs[NET_TC_TX_COUNT];
+
+/* CoDel target and interval in cycles */
+static uint32_t codel_target;
+static uint32_t codel_interval;
+
+static inline bool codel_time_after_eq(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) >= 0;
+}
+
+static uint32_t codel_isqrt(uint32_t value)
+{
+	uint32_t bit = 1U << 30;
+	uint32_t res = 0U;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	while (bit) {
+		if (value >= res + bit) {
+			value -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return res;
+}
+
+/* Time of the next drop, interval / sqrt(count) after t */
+static uint32_t codel_control_law(uint32_t t, uint32_t count)
+{
+	count = MIN(count, UINT16_MAX);
+
+	return t + (uint32_t)(((uint64_t)codel_interval << 8) /
+			      codel_isqrt(count << 16));
+}
+
+static uint32_t qdisc_hash(struct net_pkt *pkt)
+{
+	struct net_pkt_cursor backup;
+	uint16_t ptype;
+	uint32_t hash;
+
+	switch (net_pkt_family(pkt)) {
+	case AF_INET:
+		ptype = NET_ETH_PTYPE_IP;
+		break;
+	case AF_INET6:
+		ptype = NET_ETH_PTYPE_IPV6;
+		break;
+	default:
+		ptype = 0;
+		break;
+	}
+
+	/* The link layer header is not there yet */
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	hash = flow_hash(pkt, ptype, net_if_get_by_iface(net_pkt_iface(pkt)));
+
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return hash;
+}
+
+static void qdisc_drop(struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_TCP) && net_pkt_family(pkt) != AF_UNSPEC) {
+		net_pkt_set_queued(pkt, false);
+	}
+
+#if defined(CONFIG_NET_POWER_MANAGEMENT)
+	net_pkt_iface(pkt)->tx_pending--;
+#endif
+
+	net_pkt_unref(pkt);
+}
+
+static struct net_pkt *qdisc_flow_get(struct qdisc *qdisc,
+				      struct qdisc_flow *flow)
+{
+	struct net_pkt *pkt;
+
+	pkt = (struct net_pkt *)sys_slist_get(&flow->pkts);
+	if (pkt) {
+		flow->backlog -= net_pkt_get_len(pkt);
+		qdisc->len--;
+	}
+
+	return pkt;
+}
+
+/* Drop the oldest packet of the flow with the most bytes queued */
+static struct net_pkt *qdisc_drop_fattest(struct qdisc *qdisc)
+{
+	struct qdisc_flow *fattest = &qdisc->flows[0];
+	int i;
+
+	for (i = 1; i < CONFIG_NET_TC_QDISC_FLOWS; i++) {
+		if (qdisc->flows[i].backlog > fattest->backlog) {
+			fattest = &qdisc->flows[i];
+		}
+	}
+
+	return qdisc_flow_get(qdisc, fattest);
+}
+
+static void qdisc_enqueue(uint8_t tc, struct net_pkt *pkt)
+{
+	struct qdisc *qdisc = &tx_qdiscs[tc];
+	struct net_pkt *drop = NULL;
+	struct qdisc_flow *flow;
+	k_spinlock_key_t key;
+
+	flow = &qdisc->flows[qdisc_hash(pkt) % CONFIG_NET_TC_QDISC_FLOWS];
+
+	net_stats_update_qdisc_queued(net_pkt_iface(pkt), qdisc->tc);
+
+	net_pkt_set_qdisc_time(pkt, k_cycle_get_32());
+
+	key = k_spin_lock(&qdisc->lock);
+
+	sys_slist_append(&flow->pkts, (sys_snode_t *)pkt);
+	flow->backlog += net_pkt_get_len(pkt);
+	qdisc->len++;
+
+	if (!flow->active) {
+		flow->active = true;
+		flow->deficit = CONFIG_NET_TC_QDISC_QUANTUM;
+		qdisc->active++;
+
+		sys_slist_append(&qdisc->new_flows, &flow->node);
+	}
+
+	if (qdisc->len > CONFIG_NET_TC_QDISC_LIMIT) {
+		drop = qdisc_drop_fattest(qdisc);
+	}
+
+	k_spin_unlock(&qdisc->lock, key);
+
+	if (drop) {
+		NET_DBG("TC %d queue full, drop pkt %p", qdisc->tc, drop);
+
+		net_stats_update_qdisc_overlimit_drop(net_pkt_iface(drop),
+						      qdisc->tc);
+		qdisc_drop(drop);
+	}
+
+	k_sem_give(&qdisc->wait);
+}
+
+/* Check if the packet has been queued for too long. The last packet of the
+ * flow is never dropped.
+ */
+static bool codel_should_drop(struct qdisc_flow *flow, struct net_pkt *pkt,
+			      uint32_t now)
+{
+	if (now - net_pkt_qdisc_time(pkt) < codel_target ||
+	    sys_slist_is_empty(&flow->pkts)) {
+		flow->first_above_time = 0U;
+		return false;
+	}
+
+	if (flow->first_above_time == 0U) {
+		flow->first_above_time = (now + codel_interval) | 1U;
+		return false;
+	}
+
+	return codel_time_after_eq(now, flow->first_above_time);
+}
+
+static struct net_pkt *codel_dequeue(struct qdisc *qdisc,
+				     struct qdisc_flow *flow, uint32_t now,
+				     sys_slist_t *drops)
+{
+	struct net_pkt *pkt;
+	uint32_t delta;
+
+	pkt = qdisc_flow_get(qdisc, flow);
+	if (!pkt) {
+		flow->dropping = false;
+		return NULL;
+	}
+
+	if (!codel_should_drop(flow, pkt, now)) {
+		flow->dropping = false;
+		return pkt;
+	}
+
+	if (flow->dropping) {
+		while (codel_time_after_eq(now, flow->drop_next)) {
+			sys_slist_append(drops, (sys_snode_t *)pkt);
+			flow->count++;
+
+			pkt = qdisc_flow_get(qdisc, flow);
+			if (!pkt || !codel_should_drop(flow, pkt, now)) {
+				flow->dropping = false;
+				break;
+			}
+
+			flow->drop_next = codel_control_law(flow->drop_next,
+							    flow->count);
+		}
+
+		return pkt;
+	}
+
+	sys_slist_append(drops, (sys_snode_t *)pkt);
+	pkt = qdisc_flow_get(qdisc, flow);
+
+	/* Start from the previous drop rate if the flow was in the dropping
+	 * state recently.
+	 */
+	delta = flow->count - flow->last_count;
+	flow->count = 1U;
+
+	if (delta > 1U && (int32_t)(now - flow->drop_next) <
+					16LL * codel_interval) {
+		flow->count = delta;
+	}
+
+	flow->last_count = flow->count;
+	flow->drop_next = codel_control_law(now, flow->count);
+	flow->dropping = true;
+
+	return pkt;
+}
+
+static void shaper_update(struct net_if_tx_shaper *shaper, int64_t now)
+{
+	int64_t max = (int64_t)shaper->burst * CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+	int64_t elapsed = now - shaper->updated;
+
+	shaper->updated = now;
+
+	if (elapsed >= max / shaper->rate) {
+		shaper->tokens = max;
+	} else {
+		shaper->tokens = MIN(shaper->tokens + elapsed * shaper->rate,
+				     max);
+	}
+}
+
+/* Return the number of ticks until the shaper of the traffic class lets
+ * the packet through, or 0 if it can be sent now.
+ */
+static int64_t shaper_wait(struct qdisc *qdisc, struct net_pkt *pkt,
+			   int64_t now)
+{
+	struct net_if_tx_shaper *shaper;
+
+	shaper = &net_pkt_iface(pkt)->tx_shaper[qdisc->tc];
+	if (!shaper->rate) {
+		return 0;
+	}
+
+	shaper_update(shaper, now);
+
+	if (shaper->tokens > 0) {
+		return 0;
+	}
+
+	return -shaper->tokens / shaper->rate + 1;
+}
+
+static void shaper_charge(struct qdisc *qdisc, struct net_pkt *pkt)
+{
+	struct net_if_tx_shaper *shaper;
+
+	shaper = &net_pkt_iface(pkt)->tx_shaper[qdisc->tc];
+	if (shaper->rate) {
+		shaper->tokens -= (int64_t)net_pkt_get_len(pkt) *
+						CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+	}
+}
+
+static struct net_pkt *qdisc_dequeue_locked(struct qdisc *qdisc,
+					    k_timeout_t *timeout,
+					    sys_slist_t *drops)
+{
+	uint32_t now = k_cycle_get_32();
+	int64_t uptime = k_uptime_ticks();
+	int64_t wait = INT64_MAX;
+	uint16_t blocked = 0U;
+	struct qdisc_flow *flow;
+	struct net_pkt *pkt;
+	sys_slist_t *list;
+	int64_t ticks;
+
+	while (true) {
+		list = sys_slist_is_empty(&qdisc->new_flows) ?
+			&qdisc->old_flows : &qdisc->new_flows;
+
+		flow = SYS_SLIST_PEEK_HEAD_CONTAINER(list, flow, node);
+		if (!flow) {
+			*timeout = K_FOREVER;
+			return NULL;
+		}
+
+		pkt = (struct net_pkt *)sys_slist_peek_head(&flow->pkts);
+
+		ticks = pkt ? shaper_wait(qdisc, pkt, uptime) : 0;
+		if (ticks) {
+			net_stats_update_qdisc_shaped(net_pkt_iface(pkt),
+						      qdisc->tc);
+
+			/* Let the flows of the other interfaces go first, and
+			 * sleep if all the flows are held back by their
+			 * shapers.
+			 */
+			wait = MIN(wait, ticks);
+
+			sys_slist_get(list);
+			sys_slist_append(&qdisc->old_flows, &flow->node);
+
+			if (++blocked >= qdisc->active) {
+				*timeout = K_TICKS(wait);
+				return NULL;
+			}
+
+			continue;
+		}
+
+		blocked = 0U;
+
+		if (flow->deficit <= 0) {
+			flow->deficit += CONFIG_NET_TC_QDISC_QUANTUM;
+
+			sys_slist_get(list);
+			sys_slist_append(&qdisc->old_flows, &flow->node);
+			continue;
+		}
+
+		pkt = codel_dequeue(qdisc, flow, now, drops);
+		if (!pkt) {
+			sys_slist_get(list);
+
+			/* Keep an emptied new flow in the old flow list for
+			 * one more round so that it cannot get ahead of the
+			 * old flows by sending in short bursts.
+			 */
+			if (list == &qdisc->new_flows &&
+			    !sys_slist_is_empty(&qdisc->old_flows)) {
+				sys_slist_append(&qdisc->old_flows,
+						 &flow->node);
+			} else {
+				flow->active = false;
+				qdisc->active--;
+			}
+
+			continue;
+		}
+
+		flow->deficit -= net_pkt_get_len(pkt);
+		shaper_charge(qdisc, pkt);
+
+		return pkt;
+	}
+}
+
+static struct net_pkt *qdisc_dequeue(struct qdisc *qdisc,
+				     k_timeout_t *timeout)
+{
+	sys_slist_t drops;
+	struct net_pkt *pkt;
+	k_spinlock_key_t key;
+
+	sys_slist_init(&drops);
+
+	key = k_spin_lock(&qdisc->lock);
+	pkt = qdisc_dequeue_locked(qdisc, timeout, &drops);
+	k_spin_unlock(&qdisc->lock, key);
+
+	while (!sys_slist_is_empty(&drops)) {
+		struct net_pkt *drop = (struct net_pkt *)sys_slist_get(&drops);
+
+		NET_DBG("TC %d CoDel drop pkt %p", qdisc->tc, drop);
+
+		net_stats_update_qdisc_codel_drop(net_pkt_iface(drop),
+						  qdisc->tc);
+		qdisc_drop(drop);
+	}
+
+	if (pkt) {
+		net_stats_update_qdisc_delay(
+			net_pkt_iface(pkt), qdisc->tc,
+			k_cyc_to_us_floor32(k_cycle_get_32() -
+					    net_pkt_qdisc_time(pkt)));
+	}
+
+	return pkt;
+}
+
+static void qdisc_init(struct qdisc *qdisc, uint8_t tc)
+{
+	qdisc->tc = tc;
+
+	k_sem_init(&qdisc->wait, 0, 1);
+	sys_slist_init(&qdisc->new_flows);
+	sys_slist_init(&qdisc->old_flows);
+}
+
+int net_if_tx_shaper_set(struct net_if *iface, uint8_t tc, uint32_t rate,
+			 uint32_t burst)
+{
+	struct net_if_tx_shaper *shaper;
+	k_spinlock_key_t key;
+
+	if (tc >= NET_TC_TX_COUNT || (rate && !burst)) {
+		return -EINVAL;
+	}
+
+	shaper = &iface->tx_shaper[tc];
+
+	key = k_spin_lock(&tx_qdiscs[tc].lock);
+
+	shaper->rate = rate;
+	shaper->burst = burst;
+	shaper->tokens = (int64_t)burst * CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+	shaper->updated = k_uptime_ticks();
+
+	k_spin_unlock(&tx_qdiscs[tc].lock, key);
+
+	/* The held back packets might be sent now */
+	k_sem_give(&tx_qdiscs[tc].wait);
+
+	return 0;
+}
+#endif /* CONFIG_NET_TC_QDISC */
+
 int net_tx_priority2tc(enum net_priority prio)
 {
 #if NET_TC_TX_COUNT > 0
@@ -248,11 +970,16 @@ static void tc_rx_handler(struct k_fifo *fifo)
 		}
 
 		net_process_rx_packet(pkt);
+
+		/* End of the receive burst, pass the coalesced TCP data up */
+		if (k_fifo_is_empty(fifo)) {
+			net_tcp_gro_flush();
+		}
 	}
 }
 #endif
 
-#if NET_TC_TX_COUNT > 0
+#if NET_TC_TX_COUNT > 0 && !defined(CONFIG_NET_TC_QDISC)
 static void tc_tx_handler(struct k_fifo *fifo)
 {
 	struct net_pkt *pkt;
@@ -268,6 +995,77 @@ static void tc_tx_handler(struct k_fifo *fifo)
 }
 #endif
 
+#if defined(CONFIG_NET_TC_QDISC)
+static void tc_tx_qdisc_handler(struct qdisc *qdisc)
+{
+	struct net_pkt *pkt;
+	k_timeout_t timeout;
+
+	while (1) {
+		pkt = qdisc_dequeue(qdisc, &timeout);
+		if (pkt == NULL) {
+			(void)k_sem_take(&qdisc->wait, timeout);
+			continue;
+		}
+
+		net_process_tx_packet(pkt);
+	}
+}
+#endif
+
+#if defined(CONFIG_NET_RX_RSS)
+/* Create the RSS worker threads. They run at the same priority as the
+ * best effort traffic class thread and, if possible, each worker is pinned
+ * to its own CPU.
+ */
+static void rss_rx_init(void)
+{
+	uint8_t thread_priority;
+	int priority;
+	int i;
+
+	thread_priority = rx_tc2thread(net_rx_priority2tc(NET_PRIORITY_BE));
+
+	priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
+		K_PRIO_COOP(thread_priority) :
+		K_PRIO_PREEMPT(thread_priority);
+
+	for (i = 0; i < CONFIG_NET_RX_RSS_QUEUE_COUNT; i++) {
+		k_tid_t tid;
+
+		NET_DBG("[%d] Starting RSS handler %p stack size %zd "
+			"prio %d", i, &rss_queues[i].handler,
+			K_KERNEL_STACK_SIZEOF(rss_stack[i]), priority);
+
+		k_fifo_init(&rss_queues[i].fifo);
+
+		tid = k_thread_create(&rss_queues[i].handler, rss_stack[i],
+				      K_KERNEL_STACK_SIZEOF(rss_stack[i]),
+				      (k_thread_entry_t)tc_rx_handler,
+				      &rss_queues[i].fifo, NULL, NULL,
+				      priority, 0, K_FOREVER);
+		if (!tid) {
+			NET_ERR("Cannot create RSS handler thread %d", i);
+			continue;
+		}
+
+#if defined(CONFIG_SCHED_CPU_MASK) && (CONFIG_MP_NUM_CPUS > 1)
+		(void)k_thread_cpu_mask_clear(tid);
+		(void)k_thread_cpu_mask_enable(tid, i % CONFIG_MP_NUM_CPUS);
+#endif
+
+		if (IS_ENABLED(CONFIG_THREAD_NAME)) {
+			char name[RSS_NAME_LEN];
+
+			snprintk(name, sizeof(name), "rss_q[%d]", i);
+			k_thread_name_set(tid, name);
+		}
+
+		k_thread_start(tid);
+	}
+}
+#endif /* CONFIG_NET_RX_RSS */
+
 /* Create a fifo for each traffic class we are using. All the network
  * traffic goes through these classes.
  */
@@ -285,6 +1083,11 @@ void net_tc_tx_init(void)
 	net_if_foreach(net_tc_tx_stats_priority_setup, NULL);
 #endif
 
+#if defined(CONFIG_NET_TC_QDISC)
+	codel_target = k_us_to_cyc_ceil32(CONFIG_NET_TC_QDISC_TARGET_US);
+	codel_interval = k_us_to_cyc_ceil32(CONFIG_NET_TC_QDISC_INTERVAL_US);
+#endif
+
 	for (i = 0; i < NET_TC_TX_COUNT; i++) {
 		uint8_t thread_priority;
 		int priority;
@@ -305,6 +1108,15 @@ void net_tc_tx_init(void)
 							"coop" : "preempt",
 			priority);
 
+#if defined(CONFIG_NET_TC_QDISC)
+		qdisc_init(&tx_qdiscs[i], i);
+
+		tid = k_thread_create(&tx_classes[i].handler, tx_stack[i],
+				      K_KERNEL_STACK_SIZEOF(tx_stack[i]),
+				      (k_thread_entry_t)tc_tx_qdisc_handler,
+				      &tx_qdiscs[i], NULL, NULL,
+				      priority, 0, K_FOREVER);
+#else
 		k_fifo_init(&tx_classes[i].fifo);
 
 		tid = k_thread_create(&tx_classes[i].handler, tx_stack[i],
@@ -312,6 +1124,7 @@ void net_tc_tx_init(void)
 				      (k_thread_entry_t)tc_tx_handler,
 				      &tx_classes[i].fifo, NULL, NULL,
 				      priority, 0, K_FOREVER);
+#endif
 		if (!tid) {
 			NET_ERR("Cannot create TC handler thread %d", i);
 			continue;
@@ -384,5 +1197,9 @@ void net_tc_rx_init(void)
 
 		k_thread_start(tid);
 	}
+
+#if defined(CONFIG_NET_RX_RSS)
+	rss_rx_init();
+#endif
 #endif
 }
@@ -37,6 +37,22 @@ static int tcp_window = NET_IPV6_MTU;
 
 static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
 
+#if defined(CONFIG_NET_TCP_GSO)
+#define TCP_GSO_MAX_SEGS CONFIG_NET_TCP_GSO_MAX_SEGS
+#else
+#define TCP_GSO_MAX_SEGS 1
+#endif
+
+#if defined(CONFIG_NET_TCP_GRO)
+/* Connections that have coalesced data waiting to be passed to tcp_in().
+ * The list is protected by tcp_gro_list_lock and the held data of each
+ * connection by its own gro_lock.
+ */
+static sys_slist_t tcp_gro_conns = SYS_SLIST_STATIC_INIT(&tcp_gro_conns);
+static K_MUTEX_DEFINE(tcp_gro_list_lock);
+static struct k_work_delayable tcp_gro_timer;
+#endif
+
 static K_MUTEX_DEFINE(tcp_lock);
 
 static K_MEM_SLAB_DEFINE(tcp_conns_slab, sizeof(struct tcp),
@@ -718,6 +734,14 @@ static int tcp_data_get(struct tcp *conn, struct net_pkt *pkt, size_t *len)
 			goto out;
 		}
 
+#if defined(CONFIG_NET_PKT_RXTIME_STATS)
+		/* Keep the RX time statistics of the received segment */
+		net_pkt_set_create_time(up, net_pkt_create_time(pkt));
+#endif
+#if defined(CONFIG_NET_PKT_RXTIME_STATS_DETAIL)
+		memcpy(&up->detail, &pkt->detail, sizeof(up->detail));
+#endif
+
 		/* If there is any out-of-order pending data, then pass it
 		 * to the application here.
 		 */
@@ -728,6 +752,16 @@ static int tcp_data_get(struct tcp *conn, struct net_pkt *pkt, size_t *len)
 
 		net_pkt_skip(up, net_pkt_get_len(up) - *len);
 
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+		/* With a limited receive buffer the data closes the window
+		 * until the application reads it, see
+		 * net_tcp_update_recv_wnd().
+		 */
+		if (conn->context->options.rcvbuf) {
+			conn->recv_win -= MIN(*len, conn->recv_win);
+		}
+#endif
+
 		/* Do not pass data to application with TCP conn
 		 * locked as there could be an issue when the app tries
 		 * to send the data and the conn is locked. So the recv
@@ -815,6 +849,8 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		/* Append the data buffer to the pkt */
 		net_pkt_append_buffer(pkt, data->buffer);
 		data->buffer = NULL;
+
+		net_pkt_set_gso_size(pkt, net_pkt_gso_size(data));
 	}
 
 	ret = ip_header_add(conn, pkt);
@@ -888,6 +924,18 @@ static int tcp_pkt_peek(struct net_pkt *to, struct net_pkt *from, size_t pos,
 	return net_pkt_copy(to, from, len);
 }
 
+/* Size of the receive window when no data is queued to the application */
+static uint16_t tcp_recv_win_max(struct tcp *conn)
+{
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+	if (conn->context && conn->context->options.rcvbuf) {
+		return conn->context->options.rcvbuf;
+	}
+#endif
+
+	return tcp_window;
+}
+
 static bool tcp_window_full(struct tcp *conn)
 {
 	bool window_full = !(conn->unacked_len < conn->send_win);
@@ -915,23 +963,67 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
+/* Allocate the packet for len bytes of data. If the data does not fit into
+ * one segment, the packet is marked for segmentation before its buffer is
+ * allocated so that the allocation is not limited by the MTU.
+ */
+static struct net_pkt *tcp_data_pkt_alloc(struct tcp *conn, size_t len)
+{
+#if defined(CONFIG_NET_TCP_GSO)
+	struct net_pkt *pkt;
+
+	if (len > conn_mss(conn)) {
+		pkt = net_pkt_alloc_on_iface(conn->iface,
+					     TCP_PKT_ALLOC_TIMEOUT);
+		if (!pkt) {
+			return NULL;
+		}
+
+		tp_pkt_alloc(pkt, tp_basename(__FILE__), __LINE__);
+
+		net_pkt_set_family(pkt,
+				   net_context_get_family(conn->context));
+		net_pkt_set_gso_size(pkt, conn_mss(conn));
+
+		if (net_pkt_alloc_buffer(pkt, len, IPPROTO_TCP,
+					 TCP_PKT_ALLOC_TIMEOUT) < 0) {
+			tcp_pkt_unref(pkt);
+			return NULL;
+		}
+
+		return pkt;
+	}
+#endif
+
+	return tcp_pkt_alloc(conn, len);
+}
+
 static int tcp_send_data(struct tcp *conn)
 {
 	int ret = 0;
-	int pos, len;
+	int pos, len, max_len;
 	struct net_pkt *pkt;
 
+	max_len = conn_mss(conn);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_GSO)) {
+		/* Build one large packet, it is split into MSS sized
+		 * segments just before sending.
+		 */
+		max_len *= TCP_GSO_MAX_SEGS;
+	}
+
 	pos = conn->unacked_len;
 	len = MIN3(conn->send_data_total - conn->unacked_len,
 		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
+		   max_len);
 	if (len == 0) {
 		NET_DBG("conn: %p no data to send", conn);
 		ret = -ENODATA;
 		goto out;
 	}
 
-	pkt = tcp_pkt_alloc(conn, len);
+	pkt = tcp_data_pkt_alloc(conn, len);
 	if (!pkt) {
 		NET_ERR("conn: %p packet allocation failed, len=%d", conn, len);
 		ret = -ENOBUFS;
@@ -947,14 +1039,22 @@ static int tcp_send_data(struct tcp *conn)
 
 	ret = tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + conn->unacked_len);
 	if (ret == 0) {
+		int segs = DIV_ROUND_UP(len, conn_mss(conn));
+
 		conn->unacked_len += len;
 
 		if (conn->data_mode == TCP_DATA_MODE_RESEND) {
 			net_stats_update_tcp_resent(conn->iface, len);
-			net_stats_update_tcp_seg_rexmit(conn->iface);
 		} else {
 			net_stats_update_tcp_sent(conn->iface, len);
-			net_stats_update_tcp_seg_sent(conn->iface);
+		}
+
+		while (segs-- > 0) {
+			if (conn->data_mode == TCP_DATA_MODE_RESEND) {
+				net_stats_update_tcp_seg_rexmit(conn->iface);
+			} else {
+				net_stats_update_tcp_seg_sent(conn->iface);
+			}
 		}
 	}
 
@@ -1161,12 +1261,16 @@ static struct tcp *tcp_conn_alloc(void)
 	}
 
 	k_mutex_init(&conn->lock);
+#if defined(CONFIG_NET_TCP_GRO)
+	k_mutex_init(&conn->gro_lock);
+#endif
 	k_fifo_init(&conn->recv_data);
 	k_sem_init(&conn->connect_sem, 0, K_SEM_MAX_LIMIT);
 
 	conn->in_connect = false;
 	conn->state = TCP_LISTEN;
 	conn->recv_win = tcp_window;
+	conn->recv_win_max = tcp_window;
 
 	/* The ISN value will be set when we get the connection attempt or
 	 * when trying to create a connection.
@@ -1256,6 +1360,245 @@ static struct tcp *tcp_conn_search(struct net_pkt *pkt)
 	return found ? conn : NULL;
 }
 
+#if defined(CONFIG_NET_TCP_GRO)
+/* Pass the coalesced data of the connection to the state machine. Must be
+ * called with conn->gro_lock held, so that a newer segment of the same
+ * connection cannot be passed to tcp_in() before the held data. Returns
+ * true if data was delivered, the caller must then release the reference
+ * that was taken when the data was held, after it has released the lock.
+ */
+static bool tcp_gro_flush_locked(struct tcp *conn)
+{
+	struct net_pkt *pkt = conn->gro_pkt;
+
+	if (!pkt) {
+		return false;
+	}
+
+	conn->gro_pkt = NULL;
+
+	k_mutex_lock(&tcp_gro_list_lock, K_FOREVER);
+	sys_slist_find_and_remove(&tcp_gro_conns, &conn->gro_next);
+	k_mutex_unlock(&tcp_gro_list_lock);
+
+	NET_DBG("conn: %p pkt %p len %zd", conn, pkt, net_pkt_get_len(pkt));
+
+	tcp_in(conn, pkt);
+	tcp_pkt_unref(pkt);
+
+	return true;
+}
+
+/* Flush the connections that were last fed by the given thread, or all of
+ * them if owner is NULL.
+ */
+static void tcp_gro_flush_owned(k_tid_t owner)
+{
+	struct tcp *conn, *tmp;
+	bool held;
+
+	while (true) {
+		conn = NULL;
+
+		k_mutex_lock(&tcp_gro_list_lock, K_FOREVER);
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&tcp_gro_conns, tmp, gro_next) {
+			if (owner == NULL || tmp->gro_owner == owner) {
+				conn = tmp;
+				tcp_conn_ref(conn);
+				break;
+			}
+		}
+
+		k_mutex_unlock(&tcp_gro_list_lock);
+
+		if (!conn) {
+			break;
+		}
+
+		k_mutex_lock(&conn->gro_lock, K_FOREVER);
+		held = tcp_gro_flush_locked(conn);
+		k_mutex_unlock(&conn->gro_lock);
+
+		if (held) {
+			tcp_conn_unref(conn);
+		}
+
+		tcp_conn_unref(conn);
+	}
+}
+
+void net_tcp_gro_flush(void)
+{
+	tcp_gro_flush_owned(k_current_get());
+}
+
+static void tcp_gro_timeout(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	tcp_gro_flush_owned(NULL);
+}
+
+/* Only plain in-order data segments without any options are coalesced */
+static bool tcp_gro_can_merge(struct tcp *conn, struct net_pkt *pkt,
+			      struct tcphdr *th, size_t len)
+{
+	return conn->state == TCP_ESTABLISHED && !conn->in_connect &&
+		len > 0 && (th_flags(th) & ~PSH) == ACK && th_off(th) == 5 &&
+		net_pkt_ip_opts_len(pkt) == 0 &&
+		net_if_need_tcp_coalescing(net_pkt_iface(pkt));
+}
+
+static void tcp_gro_update_len(struct net_pkt *pkt)
+{
+	size_t len = net_pkt_get_len(pkt);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt,
+							      &ipv4_access);
+		if (hdr) {
+			hdr->len = htons(len);
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *hdr;
+
+		hdr = (struct net_ipv6_hdr *)net_pkt_get_data(pkt,
+							      &ipv6_access);
+		if (hdr) {
+			hdr->len = htons(len - sizeof(struct net_ipv6_hdr));
+		}
+	}
+}
+
+/* Append the data of the segment to the held data. Returns true if the
+ * packet was merged and can be released by the caller.
+ */
+static bool tcp_gro_merge(struct tcp *conn, struct net_pkt *pkt,
+			  struct tcphdr *th, size_t len)
+{
+	struct tcphdr *gro_th = th_get(conn->gro_pkt);
+	uint8_t flags = th_flags(th);
+
+	if (!gro_th || th_seq(th) != conn->gro_seq ||
+	    th_ack(th) != th_ack(gro_th) || th_win(th) != th_win(gro_th) ||
+	    net_pkt_get_len(conn->gro_pkt) + len > UINT16_MAX) {
+		return false;
+	}
+
+	/* Get rid of protocol headers and append the data */
+	if (tcp_pkt_pull(pkt, net_pkt_get_len(pkt) - len) < 0) {
+		return false;
+	}
+
+	UNALIGNED_PUT(th_flags(gro_th) | flags, &gro_th->th_flags);
+
+	net_pkt_append_buffer(conn->gro_pkt, pkt->buffer);
+	pkt->buffer = NULL;
+
+	tcp_gro_update_len(conn->gro_pkt);
+
+	conn->gro_seq += len;
+	conn->gro_segs++;
+
+	return true;
+}
+
+static void tcp_gro_hold(struct tcp *conn, struct net_pkt *pkt,
+			 struct tcphdr *th, size_t len)
+{
+	/* The held data keeps the connection alive until it is flushed */
+	tcp_conn_ref(conn);
+
+	conn->gro_pkt = pkt;
+	conn->gro_seq = th_seq(th) + len;
+	conn->gro_segs = 1U;
+
+	k_mutex_lock(&tcp_gro_list_lock, K_FOREVER);
+	sys_slist_append(&tcp_gro_conns, &conn->gro_next);
+	k_mutex_unlock(&tcp_gro_list_lock);
+
+	k_work_schedule_for_queue(&tcp_work_q, &tcp_gro_timer,
+				  K_MSEC(CONFIG_NET_TCP_GRO_FLUSH_TIMEOUT));
+}
+
+/* Coalesce the received segment with the data that is held for the
+ * connection, or pass the held data and then the segment to tcp_in().
+ * Everything is done with the GRO lock of the connection held so that the
+ * GRO timer or another RX thread cannot reorder the byte stream.
+ */
+static enum net_verdict tcp_gro_receive(struct tcp *conn, struct net_pkt *pkt)
+{
+	enum net_verdict verdict = NET_OK;
+	struct tcphdr *th = th_get(pkt);
+	uint8_t flags = th ? th_flags(th) : 0;
+	bool flush = true;
+	bool held;
+	size_t len;
+
+	/* Nothing is held before the connection is established */
+	if (conn->in_connect) {
+		tcp_in(conn, pkt);
+		return NET_DROP;
+	}
+
+	len = th ? tcp_data_len(pkt) : 0;
+
+	/* tcp_in() can release the connection, keep it alive until the
+	 * GRO lock is released.
+	 */
+	tcp_conn_ref(conn);
+
+	k_mutex_lock(&conn->gro_lock, K_FOREVER);
+
+	if (th && tcp_gro_can_merge(conn, pkt, th, len)) {
+		conn->gro_owner = k_current_get();
+
+		if (conn->gro_pkt) {
+			if (tcp_gro_merge(conn, pkt, th, len)) {
+				flush = (flags & PSH) || conn->gro_segs >=
+					CONFIG_NET_TCP_GRO_MAX_SEGS;
+
+				tcp_pkt_unref(pkt);
+				pkt = NULL;
+			}
+		} else if (!(flags & PSH)) {
+			tcp_gro_hold(conn, pkt, th, len);
+			pkt = NULL;
+			flush = false;
+		}
+	}
+
+	held = flush ? tcp_gro_flush_locked(conn) : false;
+
+	if (pkt) {
+		/* Could not coalesce, the held data was passed first */
+		tcp_in(conn, pkt);
+		verdict = NET_DROP;
+	}
+
+	k_mutex_unlock(&conn->gro_lock);
+
+	if (held) {
+		tcp_conn_unref(conn);
+	}
+
+	tcp_conn_unref(conn);
+
+	return verdict;
+}
+#endif /* CONFIG_NET_TCP_GRO */
+
 static struct tcp *tcp_conn_new(struct net_pkt *pkt);
 
 static enum net_verdict tcp_recv(struct net_conn *net_conn,
@@ -1289,10 +1632,26 @@ static enum net_verdict tcp_recv(struct net_conn *net_conn,
 		net_ipaddr_copy(&conn_old->context->remote, &conn->dst.sa);
 
 		conn->accepted_conn = conn_old;
+
+		/* The accepted connection inherits the buffer sizes */
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+		conn->context->options.rcvbuf =
+			conn_old->context->options.rcvbuf;
+		conn->recv_win = tcp_recv_win_max(conn);
+		conn->recv_win_max = conn->recv_win;
+#endif
+#if defined(CONFIG_NET_CONTEXT_SNDBUF)
+		conn->context->options.sndbuf =
+			conn_old->context->options.sndbuf;
+#endif
 	}
  in:
 	if (conn) {
+#if defined(CONFIG_NET_TCP_GRO)
+		return tcp_gro_receive(conn, pkt);
+#else
 		tcp_in(conn, pkt);
+#endif
 	}
 
 	return NET_DROP;
@@ -1874,6 +2233,17 @@ next_state:
 				conn_state(conn, TCP_CLOSED);
 				break;
 			}
+		} else if (th && tcp_unsent_len(conn) > 0 &&
+			   !tcp_window_full(conn)) {
+			/* A window update from the peer, send the data held
+			 * back by the closed window.
+			 */
+			ret = tcp_send_queued_data(conn);
+			if (ret < 0 && ret != -ENOBUFS) {
+				tcp_out(conn, RST);
+				conn_state(conn, TCP_CLOSED);
+				break;
+			}
 		}
 
 		if (th && len) {
@@ -2067,10 +2437,49 @@ int net_tcp_listen(struct net_context *context)
 
 int net_tcp_update_recv_wnd(struct net_context *context, int32_t delta)
 {
-	ARG_UNUSED(context);
-	ARG_UNUSED(delta);
+	struct tcp *conn = context->tcp;
+	int32_t max_win, old_win, new_win;
+	int ret = 0;
+
+	if (!conn) {
+		NET_ERR("context->tcp == NULL");
+		return -EPROTOTYPE;
+	}
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	/* The receive buffer size may have changed since the last update,
+	 * move the window by the same amount.
+	 */
+	max_win = tcp_recv_win_max(conn);
+	old_win = conn->recv_win;
+	new_win = old_win + delta + (max_win - conn->recv_win_max);
+	conn->recv_win_max = max_win;
+
+	if (new_win < 0 || new_win > UINT16_MAX) {
+		ret = -EINVAL;
+		new_win = CLAMP(new_win, 0, max_win);
+	} else if (new_win > max_win) {
+		new_win = max_win;
+	}
 
-	return -EPROTONOSUPPORT;
+	conn->recv_win = new_win;
+
+	NET_DBG("conn: %p recv_win %d -> %d", conn, old_win, new_win);
+
+	/* Tell the peer when the window opens from zero or from under half
+	 * of its size, so that it does not have to wait for a retransmit
+	 * timeout before sending more.
+	 */
+	if (conn->state == TCP_ESTABLISHED && new_win > old_win &&
+	    (old_win == 0 || (old_win < max_win / 2 &&
+			      new_win >= max_win / 2))) {
+		tcp_out(conn, ACK);
+	}
+
+	k_mutex_unlock(&conn->lock);
+
+	return ret;
 }
 
 /* net_context queues the outgoing data for the TCP connection */
@@ -2120,6 +2529,18 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 
 	len = net_pkt_get_len(pkt);
 
+#if defined(CONFIG_NET_CONTEXT_SNDBUF)
+	/* Block the sender until enough of the queued data has been
+	 * acknowledged. Data is always accepted to an empty queue so that
+	 * writes larger than the buffer can make progress.
+	 */
+	if (context->options.sndbuf && conn->send_data_total > 0 &&
+	    conn->send_data_total + len > context->options.sndbuf) {
+		ret = -EAGAIN;
+		goto out;
+	}
+#endif
+
 	if (conn->send_data->buffer) {
 		orig_buf = net_buf_frag_last(conn->send_data->buffer);
 	}
@@ -2401,6 +2822,153 @@ int net_tcp_finalize(struct net_pkt *pkt)
 	return net_pkt_set_data(pkt, &tcp_access);
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+static void tcp_gso_copy_attributes(struct net_pkt *seg, struct net_pkt *pkt)
+{
+	net_pkt_set_context(seg, net_pkt_context(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_vlan_tag(seg, net_pkt_vlan_tag(pkt));
+
+	net_pkt_lladdr_src(seg)->addr = net_pkt_lladdr_src(pkt)->addr;
+	net_pkt_lladdr_src(seg)->len = net_pkt_lladdr_src(pkt)->len;
+	net_pkt_lladdr_dst(seg)->addr = net_pkt_lladdr_dst(pkt)->addr;
+	net_pkt_lladdr_dst(seg)->len = net_pkt_lladdr_dst(pkt)->len;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		net_pkt_set_ipv4_ttl(seg, net_pkt_ipv4_ttl(pkt));
+		net_pkt_set_ipv4_opts_len(seg, net_pkt_ipv4_opts_len(pkt));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		net_pkt_set_ipv6_hop_limit(seg, net_pkt_ipv6_hop_limit(pkt));
+		net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+		net_pkt_set_ipv6_next_hdr(seg, net_pkt_ipv6_next_hdr(pkt));
+	}
+}
+
+/* Fix the headers that were copied from the large packet so that they
+ * describe this segment. Length and checksums are set when the segment is
+ * finalized.
+ */
+static int tcp_gso_fix_headers(struct net_pkt *seg, uint16_t ip_id,
+			       uint32_t seq, uint8_t flags)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
+	struct tcphdr *th;
+
+	net_pkt_cursor_init(seg);
+	net_pkt_set_overwrite(seg, true);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(seg) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data(seg,
+							      &ipv4_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		hdr->id[0] = ip_id >> 8;
+		hdr->id[1] = ip_id;
+		hdr->chksum = 0U;
+	}
+
+	if (net_pkt_skip(seg, net_pkt_ip_hdr_len(seg) +
+			 net_pkt_ip_opts_len(seg))) {
+		return -ENOBUFS;
+	}
+
+	th = (struct tcphdr *)net_pkt_get_data(seg, &tcp_access);
+	if (!th) {
+		return -ENOBUFS;
+	}
+
+	UNALIGNED_PUT(htonl(seq), &th->th_seq);
+	UNALIGNED_PUT(flags, &th->th_flags);
+
+	if (net_pkt_set_data(seg, &tcp_access)) {
+		return -ENOBUFS;
+	}
+
+	return tcp_finalize_pkt(seg);
+}
+
+void net_tcp_gso_segment(struct net_if *iface, struct net_pkt *pkt)
+{
+	uint16_t mss = net_pkt_gso_size(pkt);
+	size_t hdr_len, data_len, offset;
+	uint16_t ip_id = 0U;
+	struct tcphdr *th;
+	uint8_t flags;
+	uint32_t seq;
+
+	net_pkt_set_gso_size(pkt, 0U);
+
+	th = th_get(pkt);
+	if (!th) {
+		goto out;
+	}
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt) +
+		th_off(th) * 4U;
+	data_len = net_pkt_get_len(pkt) - hdr_len;
+
+	if (data_len <= mss) {
+		net_if_queue_tx(iface, pkt);
+		return;
+	}
+
+	seq = th_seq(th);
+	flags = th_flags(th);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+		ip_id = (hdr->id[0] << 8) | hdr->id[1];
+	}
+
+	NET_DBG("pkt %p len %zd mss %u", pkt, data_len, mss);
+
+	for (offset = 0; offset < data_len; offset += mss) {
+		size_t len = MIN(mss, data_len - offset);
+		bool last = (offset + len) == data_len;
+		struct net_pkt *seg;
+
+		seg = net_pkt_alloc_with_buffer(iface, hdr_len + len,
+						net_pkt_family(pkt), 0,
+						TCP_PKT_ALLOC_TIMEOUT);
+		if (!seg) {
+			NET_DBG("Cannot allocate segment, len %zd", len);
+			break;
+		}
+
+		tcp_gso_copy_attributes(seg, pkt);
+
+		/* Copy the headers and then the payload of this segment */
+		net_pkt_cursor_init(pkt);
+
+		if (net_pkt_copy(seg, pkt, hdr_len) ||
+		    net_pkt_skip(pkt, offset) ||
+		    net_pkt_copy(seg, pkt, len) ||
+		    tcp_gso_fix_headers(seg, ip_id++, seq + offset,
+					last ? flags : flags & ~(FIN | PSH))) {
+			tcp_pkt_unref(seg);
+			break;
+		}
+
+		net_if_queue_tx(iface, seg);
+	}
+
+out:
+	/* The segments carry the data now, release the large packet like
+	 * the driver would do.
+	 */
+	tcp_pkt_unref(pkt);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 struct net_tcp_hdr *net_tcp_input(struct net_pkt *pkt,
 				  struct net_pkt_data_access *tcp_access)
 {
@@ -2765,4 +3333,8 @@ void net_tcp_init(void)
 
 	k_thread_name_set(&tcp_work_q.thread, "tcp_work");
 	NET_DBG("Workq started. Thread ID: %p", &tcp_work_q.thread);
+
+#if defined(CONFIG_NET_TCP_GRO)
+	k_work_init_delayable(&tcp_gro_timer, tcp_gro_timeout);
+#endif
 }
@@ -248,11 +248,20 @@ struct tcp { /* TCP connection */
 	uint32_t seq;
 	uint32_t ack;
 	uint16_t recv_win;
+	uint16_t recv_win_max;
 	uint16_t send_win;
 	uint8_t send_data_retries;
 	bool in_retransmission : 1;
 	bool in_connect : 1;
 	bool in_close : 1;
+#if defined(CONFIG_NET_TCP_GRO)
+	struct k_mutex gro_lock;  /* serializes the delivery of held data */
+	sys_snode_t gro_next;     /* link in the list of conns with held data */
+	k_tid_t gro_owner;        /* RX thread that last fed the held data */
+	struct net_pkt *gro_pkt;  /* coalesced data waiting for tcp_in() */
+	uint32_t gro_seq;         /* next expected sequence number */
+	uint8_t gro_segs;         /* number of segments in gro_pkt */
+#endif
 };
 
 #define _flags(_fl, _op, _mask, _cond)					\
@@ -361,6 +361,29 @@ static inline int net_tcp_put(struct net_context *context)
 
 #define NET_TCP_MAX_OPT_SIZE  8
 
+#if defined(CONFIG_NET_TCP_GSO)
+/**
+ * @brief Split a large TCP packet into MSS sized segments and queue them
+ * for sending. The original packet is released.
+ *
+ * @param iface Network interface the segments are sent to
+ * @param pkt Network packet that has a non-zero GSO size
+ */
+void net_tcp_gso_segment(struct net_if *iface, struct net_pkt *pkt);
+#endif
+
+/**
+ * @brief Pass the coalesced received TCP data to the TCP state machine.
+ * This is called by an RX thread when there are no more packets waiting in
+ * its RX queue. Only the connections that were fed by the calling thread
+ * are flushed.
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_flush(void);
+#else
+static inline void net_tcp_gro_flush(void) { }
+#endif
+
 #if defined(CONFIG_NET_NATIVE_TCP)
 void net_tcp_init(void);
 #else
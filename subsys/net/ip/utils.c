@@ -487,47 +487,158 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
-static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
+static inline uint16_t chksum_fold(uint64_t sum)
 {
-	const uint8_t *end;
-	uint16_t tmp;
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
 
-	end = data + len - 1;
+	return sum;
+}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+static inline uint16_t chksum_swap(uint16_t sum)
+{
+	return (sum << 8) | (sum >> 8);
+}
 
-		data += 2;
+/* Add two partial sums, the sum of the data in the second one starts at
+ * an odd offset if odd is set.
+ */
+static inline uint16_t chksum_add(uint16_t sum, uint16_t add, bool odd)
+{
+	if (odd) {
+		add = chksum_swap(add);
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	sum += add;
+	if (sum < add) {
+		sum++;
 	}
 
 	return sum;
 }
 
-static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
+/* Value of a single byte when it is the first byte of a 16-bit word */
+static inline uint16_t chksum_byte(uint8_t byte)
+{
+	uint16_t word = 0U;
+
+	*(uint8_t *)&word = byte;
+
+	return word;
+}
+
+/* Calculate the one's complement sum of 16-bit words in host byte order.
+ * The sum is byte order independent so there is no need to swap each word,
+ * only the final result needs to be converted. The data is read 32 bits at
+ * a time and the carries are collected into the upper half of a 64-bit
+ * accumulator, so they need to be folded back only once at the end.
+ */
+static uint16_t chksum_native(const uint8_t *data, size_t len)
+{
+	const uint32_t *words;
+	uint64_t acc = 0U;
+	uint16_t first = 0U;
+	bool odd = false;
+
+	if (len == 0) {
+		return 0U;
+	}
+
+	if ((uintptr_t)data & 1) {
+		/* Sum the rest from an even address, this shifts the words
+		 * by one byte which is fixed by swapping the result.
+		 */
+		first = chksum_byte(*data);
+		odd = true;
+		data++;
+		len--;
+	}
+
+	if (((uintptr_t)data & 2) && len >= 2) {
+		acc += *(const uint16_t *)data;
+		data += 2;
+		len -= 2;
+	}
+
+	words = (const uint32_t *)data;
+
+	while (len >= 32) {
+		acc += words[0];
+		acc += words[1];
+		acc += words[2];
+		acc += words[3];
+		acc += words[4];
+		acc += words[5];
+		acc += words[6];
+		acc += words[7];
+
+		words += 8;
+		len -= 32;
+	}
+
+	while (len >= 4) {
+		acc += *words++;
+		len -= 4;
+	}
+
+	data = (const uint8_t *)words;
+
+	if (len >= 2) {
+		acc += *(const uint16_t *)data;
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		acc += chksum_byte(*data);
+	}
+
+	if (odd) {
+		return chksum_add(first, chksum_fold(acc), true);
+	}
+
+	return chksum_fold(acc);
+}
+
+static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
+{
+	return chksum_add(sum, ntohs(chksum_native(data, len)), false);
+}
+
+uint16_t net_calc_chksum_copy(uint16_t sum, size_t offset, void *dst,
+			      const void *src, size_t len)
+{
+	memcpy(dst, src, len);
+
+	/* The data is still in the cache after the copy */
+	return chksum_add(sum, calc_chksum(0U, dst, len), offset & 1);
+}
+
+/* Sum len bytes starting from the cursor, the data can span over several
+ * buffers.
+ */
+static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum,
+				       size_t len)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
-	size_t len;
+	size_t offset = 0U;
 
 	if (!cur->buf || !cur->pos) {
 		return sum;
 	}
 
-	len = cur->buf->len - (cur->pos - cur->buf->data);
+	while (cur->buf && len) {
+		size_t buf_len = cur->buf->len - (cur->pos - cur->buf->data);
 
-	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		buf_len = MIN(buf_len, len);
+
+		sum = chksum_add(sum, calc_chksum(0U, cur->pos, buf_len),
+				 offset & 1);
+
+		offset += buf_len;
+		len -= buf_len;
 
 		cur->buf = cur->buf->frags;
 		if (!cur->buf || !cur->buf->len) {
@@ -535,18 +646,6 @@ static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
 		}
 
 		cur->pos = cur->buf->data;
-
-		if (len % 2) {
-			sum += *cur->pos;
-			if (sum < *cur->pos) {
-				sum++;
-			}
-
-			cur->pos++;
-			len = cur->buf->len - 1;
-		} else {
-			len = cur->buf->len;
-		}
 	}
 
 	return sum;
@@ -589,7 +688,21 @@ uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto)
 	sum = calc_chksum(sum, pkt->cursor.pos, len);
 	net_pkt_skip(pkt, len + net_pkt_ip_opts_len(pkt));
 
-	sum = pkt_calc_chksum(pkt, sum);
+	len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ip_opts_len(pkt);
+
+	/* The sum of the payload might have been calculated already when
+	 * it was copied into the packet.
+	 */
+	if (net_pkt_payload_chksum_len(pkt) &&
+	    net_pkt_payload_chksum_len(pkt) <= len) {
+		len -= net_pkt_payload_chksum_len(pkt);
+
+		sum = pkt_calc_chksum(pkt, sum, len);
+		sum = chksum_add(sum, net_pkt_payload_chksum(pkt), len & 1);
+	} else {
+		sum = pkt_calc_chksum(pkt, sum, len);
+	}
 
 	sum = (sum == 0U) ? 0xffff : htons(sum);
 
@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 
 #include "arp.h"
 #include "net_private.h"
+#include "net_stats.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT (2 * MSEC_PER_SEC)
@@ -26,12 +27,28 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 static bool arp_cache_initialized;
 static struct arp_entry arp_entries[CONFIG_NET_ARP_TABLE_SIZE];
 
-static sys_slist_t arp_free_entries;
-static sys_slist_t arp_pending_entries;
-static sys_slist_t arp_table;
+static sys_dlist_t arp_free_entries;
+static sys_dlist_t arp_pending_entries;
+static sys_dlist_t arp_table; /* Most recently used entry first */
+
+/* Pending, valid and negative entries are hashed by interface and address */
+static sys_slist_t arp_hash[CONFIG_NET_ARP_HASH_SIZE];
 
 struct k_work_delayable arp_request_timer;
 
+static inline sys_slist_t *arp_hash_bucket(struct net_if *iface,
+					   struct in_addr *addr)
+{
+	uint32_t hash = UNALIGNED_GET(&addr->s_addr) ^ POINTER_TO_UINT(iface);
+
+	/* Mix the bits, the low bits of addresses in a subnet differ */
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3bU;
+	hash ^= hash >> 16;
+
+	return &arp_hash[hash % CONFIG_NET_ARP_HASH_SIZE];
+}
+
 static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 {
 	NET_DBG("%p", entry);
@@ -50,123 +67,141 @@ static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 	(void)memset(&entry->eth, 0, sizeof(struct net_eth_addr));
 }
 
-static struct arp_entry *arp_entry_find(sys_slist_t *list,
-					struct net_if *iface,
-					struct in_addr *dst,
-					sys_snode_t **previous)
+static void arp_entry_hash_add(struct arp_entry *entry)
+{
+	sys_slist_prepend(arp_hash_bucket(entry->iface, &entry->ip),
+			  &entry->hash_node);
+}
+
+static void arp_entry_hash_remove(struct arp_entry *entry)
+{
+	sys_slist_find_and_remove(arp_hash_bucket(entry->iface, &entry->ip),
+				  &entry->hash_node);
+}
+
+/* Remove the entry from its list and the hash, and release it */
+static void arp_entry_release(struct arp_entry *entry)
+{
+	sys_dlist_remove(&entry->node);
+	arp_entry_hash_remove(entry);
+	arp_entry_cleanup(entry, entry->state == ARP_ENTRY_PENDING);
+
+	entry->state = ARP_ENTRY_FREE;
+	sys_dlist_prepend(&arp_free_entries, &entry->node);
+}
+
+static struct arp_entry *arp_entry_find(struct net_if *iface,
+					struct in_addr *dst)
 {
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(list, entry, node) {
-		NET_DBG("iface %p dst %s",
-			iface, log_strdup(net_sprint_ipv4_addr(&entry->ip)));
+	NET_DBG("iface %p dst %s", iface,
+		log_strdup(net_sprint_ipv4_addr(dst)));
 
+	SYS_SLIST_FOR_EACH_CONTAINER(arp_hash_bucket(iface, dst), entry,
+				     hash_node) {
 		if (entry->iface == iface &&
 		    net_ipv4_addr_cmp(&entry->ip, dst)) {
 			return entry;
 		}
-
-		if (previous) {
-			*previous = &entry->node;
-		}
 	}
 
 	return NULL;
 }
 
-static inline struct arp_entry *arp_entry_find_move_first(struct net_if *iface,
-							  struct in_addr *dst)
+static inline struct arp_entry *arp_entry_find_valid(struct net_if *iface,
+						     struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
-
-	entry = arp_entry_find(&arp_table, iface, dst, &prev);
-	if (entry) {
-		/* Let's assume the target is going to be accessed
-		 * more than once here in a short time frame. So we
-		 * place the entry first in position into the table
-		 * in order to reduce subsequent find.
-		 */
-		if (&entry->node != sys_slist_peek_head(&arp_table)) {
-			sys_slist_remove(&arp_table, prev, &entry->node);
-			sys_slist_prepend(&arp_table, &entry->node);
-		}
+	entry = arp_entry_find(iface, dst);
+	if (entry && entry->state == ARP_ENTRY_VALID) {
+		return entry;
 	}
 
-	return entry;
+	return NULL;
 }
 
-static inline
-struct arp_entry *arp_entry_find_pending(struct net_if *iface,
-					 struct in_addr *dst)
+/* Make the entry valid and the most recently used one */
+static void arp_entry_set_valid(struct arp_entry *entry,
+				struct net_eth_addr *hwaddr)
 {
-	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
+	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	entry->state = ARP_ENTRY_VALID;
 
-	return arp_entry_find(&arp_pending_entries, iface, dst, NULL);
+	if (sys_dnode_is_linked(&entry->node)) {
+		sys_dlist_remove(&entry->node);
+	}
+
+	sys_dlist_prepend(&arp_table, &entry->node);
 }
 
 static struct arp_entry *arp_entry_get_pending(struct net_if *iface,
 					       struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_pending_entries, iface, dst, &prev);
+	entry = arp_entry_find(iface, dst);
+	if (entry && entry->state != ARP_ENTRY_PENDING) {
+		entry = NULL;
+	}
+
 	if (entry) {
 		/* We remove the entry from the pending list */
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
+		sys_dlist_remove(&entry->node);
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_work_cancel_delayable(&arp_request_timer);
 	}
 
 	return entry;
 }
 
-static struct arp_entry *arp_entry_get_free(void)
+/* Get a free entry, or replace the least recently used one. The entry
+ * is not in any list or in the hash when returned.
+ */
+static struct arp_entry *arp_entry_get_free(struct net_if *iface)
 {
-	sys_snode_t *node;
+	sys_dnode_t *node;
+	struct arp_entry *entry;
 
-	node = sys_slist_peek_head(&arp_free_entries);
-	if (!node) {
-		return NULL;
+	node = sys_dlist_get(&arp_free_entries);
+	if (node) {
+		return CONTAINER_OF(node, struct arp_entry, node);
 	}
 
-	/* We remove the node from the free list */
-	sys_slist_remove(&arp_free_entries, NULL, node);
-
-	return CONTAINER_OF(node, struct arp_entry, node);
-}
-
-static struct arp_entry *arp_entry_get_last_from_table(void)
-{
-	sys_snode_t *node;
-
 	/* We assume last entry is the oldest one,
 	 * so is the preferred one to be taken out.
 	 */
-
-	node = sys_slist_peek_tail(&arp_table);
+	node = sys_dlist_peek_tail(&arp_table);
 	if (!node) {
 		return NULL;
 	}
 
-	sys_slist_find_and_remove(&arp_table, node);
+	entry = CONTAINER_OF(node, struct arp_entry, node);
 
-	return CONTAINER_OF(node, struct arp_entry, node);
-}
+	NET_DBG("Replacing %s", log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
+	net_stats_update_arp_evict(iface);
+
+	sys_dlist_remove(&entry->node);
+	arp_entry_hash_remove(entry);
+	arp_entry_cleanup(entry, false);
+	entry->state = ARP_ENTRY_FREE;
+
+	return entry;
+}
 
 static void arp_entry_register_pending(struct arp_entry *entry)
 {
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
-	sys_slist_append(&arp_pending_entries, &entry->node);
+	entry->state = ARP_ENTRY_PENDING;
+	sys_dlist_append(&arp_pending_entries, &entry->node);
+	arp_entry_hash_add(entry);
 
 	entry->req_start = k_uptime_get_32();
 
@@ -184,17 +219,28 @@ static void arp_request_timeout(struct k_work *work)
 
 	ARG_UNUSED(work);
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
 					  entry, next, node) {
 		if ((int32_t)(entry->req_start +
 			    ARP_REQUEST_TIMEOUT - current) > 0) {
 			break;
 		}
 
-		arp_entry_cleanup(entry, true);
+		if (CONFIG_NET_ARP_NEGATIVE_CACHE_TIMEOUT > 0) {
+			/* Remember the failure. Negative entries are placed
+			 * last in the table, so they are replaced first.
+			 */
+			net_pkt_unref(entry->pending);
+			entry->pending = NULL;
 
-		sys_slist_remove(&arp_pending_entries, NULL, &entry->node);
-		sys_slist_append(&arp_free_entries, &entry->node);
+			entry->state = ARP_ENTRY_NEGATIVE;
+			entry->req_start = current;
+
+			sys_dlist_remove(&entry->node);
+			sys_dlist_append(&arp_table, &entry->node);
+		} else {
+			arp_entry_release(entry);
+		}
 
 		entry = NULL;
 	}
@@ -206,6 +252,13 @@ static void arp_request_timeout(struct k_work *work)
 	}
 }
 
+static inline bool arp_entry_negative_expired(struct arp_entry *entry)
+{
+	return (int32_t)(entry->req_start +
+			 CONFIG_NET_ARP_NEGATIVE_CACHE_TIMEOUT -
+			 k_uptime_get_32()) <= 0;
+}
+
 static inline struct in_addr *if_get_addr(struct net_if *iface,
 					  struct in_addr *addr)
 {
@@ -354,18 +407,29 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	/* If the destination address is already known, we do not need
 	 * to send any ARP packet.
 	 */
-	entry = arp_entry_find_move_first(net_pkt_iface(pkt), addr);
-	if (!entry) {
+	entry = arp_entry_find(net_pkt_iface(pkt), addr);
+	if (entry && entry->state == ARP_ENTRY_NEGATIVE) {
+		if (!arp_entry_negative_expired(entry)) {
+			NET_DBG("No reply from %s, dropping pkt",
+				log_strdup(net_sprint_ipv4_addr(addr)));
+			net_stats_update_arp_negative(net_pkt_iface(pkt));
+			return NULL;
+		}
+
+		arp_entry_release(entry);
+		entry = NULL;
+	}
+
+	if (!entry || entry->state != ARP_ENTRY_VALID) {
 		struct net_pkt *req;
 
-		entry = arp_entry_find_pending(net_pkt_iface(pkt), addr);
+		net_stats_update_arp_miss(net_pkt_iface(pkt));
+
 		if (!entry) {
-			/* No pending, let's try to get a new entry */
-			entry = arp_entry_get_free();
-			if (!entry) {
-				/* Then let's take one from table? */
-				entry = arp_entry_get_last_from_table();
-			}
+			/* No pending, let's try to get a new entry, or
+			 * take the least recently used one from the table.
+			 */
+			entry = arp_entry_get_free(net_pkt_iface(pkt));
 		} else {
 			/* There is a pending already */
 			entry = NULL;
@@ -382,9 +446,26 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 			NET_DBG("Resending ARP %p", req);
 		}
 
+		if (req) {
+			net_stats_update_arp_request(net_pkt_iface(pkt));
+		} else if (entry) {
+			entry->state = ARP_ENTRY_FREE;
+			sys_dlist_prepend(&arp_free_entries, &entry->node);
+		}
+
 		return req;
 	}
 
+	net_stats_update_arp_hit(net_pkt_iface(pkt));
+
+	/* Let's assume the target is going to be accessed more than once
+	 * in a short time frame, so keep the table in LRU order.
+	 */
+	if (sys_dlist_peek_head(&arp_table) != &entry->node) {
+		sys_dlist_remove(&entry->node);
+		sys_dlist_prepend(&arp_table, &entry->node);
+	}
+
 	net_pkt_lladdr_src(pkt)->addr =
 		(uint8_t *)net_if_get_link_addr(entry->iface)->addr;
 	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
@@ -404,10 +485,9 @@ static void arp_gratuitous(struct net_if *iface,
 			   struct in_addr *src,
 			   struct net_eth_addr *hwaddr)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	entry = arp_entry_find(&arp_table, iface, src, &prev);
+	entry = arp_entry_find_valid(iface, src);
 	if (entry) {
 		NET_DBG("Gratuitous ARP hwaddr %s -> %s",
 			log_strdup(net_sprint_ll_addr(
@@ -438,11 +518,14 @@ static void arp_update(struct net_if *iface,
 			arp_gratuitous(iface, src, hwaddr);
 		}
 
-		if (force) {
-			sys_snode_t *prev = NULL;
-			struct arp_entry *entry;
+		entry = arp_entry_find(iface, src);
+		if (entry && entry->state == ARP_ENTRY_NEGATIVE) {
+			/* A late reply, or the host announced itself */
+			arp_entry_set_valid(entry, hwaddr);
+			return;
+		}
 
-			entry = arp_entry_find(&arp_table, iface, src, &prev);
+		if (force) {
 			if (entry) {
 				memcpy(&entry->eth, hwaddr,
 				       sizeof(struct net_eth_addr));
@@ -450,18 +533,13 @@ static void arp_update(struct net_if *iface,
 				/* Add new entry as it was not found and force
 				 * was set.
 				 */
-				entry = arp_entry_get_free();
-				if (!entry) {
-					/* Then let's take one from table? */
-					entry = arp_entry_get_last_from_table();
-				}
-
+				entry = arp_entry_get_free(iface);
 				if (entry) {
 					entry->req_start = k_uptime_get_32();
 					entry->iface = iface;
 					net_ipaddr_copy(&entry->ip, src);
-					memcpy(&entry->eth, hwaddr, sizeof(entry->eth));
-					sys_slist_prepend(&arp_table, &entry->node);
+					arp_entry_hash_add(entry);
+					arp_entry_set_valid(entry, hwaddr);
 				}
 			}
 		}
@@ -481,10 +559,8 @@ static void arp_update(struct net_if *iface,
 	pkt = entry->pending;
 	entry->pending = NULL;
 
-	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
-
 	/* Inserting entry into the table */
-	sys_slist_prepend(&arp_table, &entry->node);
+	arp_entry_set_valid(entry, hwaddr);
 
 	net_if_queue_tx(iface, pkt);
 }
@@ -674,41 +750,30 @@ enum net_verdict net_arp_input(struct net_pkt *pkt,
 
 void net_arp_clear_cache(struct net_if *iface)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry, *next;
 
 	NET_DBG("Flushing ARP table");
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
 		if (iface && iface != entry->iface) {
-			prev = &entry->node;
 			continue;
 		}
 
-		arp_entry_cleanup(entry, false);
-
-		sys_slist_remove(&arp_table, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
+		arp_entry_release(entry);
 	}
 
-	prev = NULL;
-
 	NET_DBG("Flushing ARP pending requests");
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
 					  entry, next, node) {
 		if (iface && iface != entry->iface) {
-			prev = &entry->node;
 			continue;
 		}
 
-		arp_entry_cleanup(entry, true);
-
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
+		arp_entry_release(entry);
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_work_cancel_delayable(&arp_request_timer);
 	}
 }
@@ -718,7 +783,11 @@ int net_arp_foreach(net_arp_cb_t cb, void *user_data)
 	int ret = 0;
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+		if (entry->state != ARP_ENTRY_VALID) {
+			continue;
+		}
+
 		ret++;
 		cb(entry, user_data);
 	}
@@ -734,13 +803,18 @@ void net_arp_init(void)
 		return;
 	}
 
-	sys_slist_init(&arp_free_entries);
-	sys_slist_init(&arp_pending_entries);
-	sys_slist_init(&arp_table);
+	sys_dlist_init(&arp_free_entries);
+	sys_dlist_init(&arp_pending_entries);
+	sys_dlist_init(&arp_table);
+
+	for (i = 0; i < ARRAY_SIZE(arp_hash); i++) {
+		sys_slist_init(&arp_hash[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
 		/* Inserting entry as free */
-		sys_slist_prepend(&arp_free_entries, &arp_entries[i].node);
+		arp_entries[i].state = ARP_ENTRY_FREE;
+		sys_dlist_prepend(&arp_free_entries, &arp_entries[i].node);
 	}
 
 	k_work_init_delayable(&arp_request_timer, arp_request_timeout);
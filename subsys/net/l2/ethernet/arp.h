@@ -10,6 +10,7 @@
 #if defined(CONFIG_NET_ARP) && defined(CONFIG_NET_NATIVE)
 
 #include <sys/slist.h>
+#include <sys/dlist.h>
 #include <net/ethernet.h>
 
 #ifdef __cplusplus
@@ -49,9 +50,18 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 enum net_verdict net_arp_input(struct net_pkt *pkt,
 			       struct net_eth_hdr *eth_hdr);
 
+enum arp_entry_state {
+	ARP_ENTRY_FREE,
+	ARP_ENTRY_PENDING,  /* Request sent, waiting for the reply */
+	ARP_ENTRY_VALID,
+	ARP_ENTRY_NEGATIVE, /* Request timed out, do not ask again yet */
+};
+
 struct arp_entry {
-	sys_snode_t node;
+	sys_dnode_t node;      /* Free, pending or LRU ordered table list */
+	sys_snode_t hash_node; /* Lookup hash bucket */
 	uint32_t req_start;
+	enum arp_entry_state state;
 	struct net_if *iface;
 	struct in_addr ip;
 	union {
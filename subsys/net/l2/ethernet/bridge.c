@@ -14,9 +14,15 @@ LOG_MODULE_REGISTER(net_eth_bridge, CONFIG_NET_ETHERNET_BRIDGE_LOG_LEVEL);
 #include <net/ethernet_bridge.h>
 
 #include <sys/slist.h>
+#include <string.h>
 
 #include "bridge.h"
 
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+#define FDB_AGING_TIME_MS \
+	((uint32_t)CONFIG_NET_ETHERNET_BRIDGE_FDB_AGING_TIME * MSEC_PER_SEC)
+#endif
+
 extern struct eth_bridge _eth_bridge_list_start[];
 extern struct eth_bridge _eth_bridge_list_end[];
 
@@ -50,6 +56,236 @@ struct eth_bridge *eth_bridge_get_by_index(int index)
 	return &_eth_bridge_list_start[index - 1];
 }
 
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+static uint32_t fdb_hash(const uint8_t *addr)
+{
+	uint32_t hash = 0U;
+	int i;
+
+	for (i = 0; i < sizeof(struct net_eth_addr); i++) {
+		hash = hash * 31U + addr[i];
+	}
+
+	hash ^= hash >> 16;
+
+	return hash % ETH_BRIDGE_FDB_BUCKETS;
+}
+
+/* Tell if an entry is in use, dynamic entries not seen for too long are
+ * released here.
+ */
+static bool fdb_entry_is_valid(struct eth_bridge_fdb_entry *entry,
+			       uint32_t now)
+{
+	if (entry->iface == NULL) {
+		return false;
+	}
+
+	if (entry->is_static || now - entry->last_seen < FDB_AGING_TIME_MS) {
+		return true;
+	}
+
+	NET_DBG("entry %p aged out", entry);
+	entry->iface = NULL;
+
+	return false;
+}
+
+static struct eth_bridge_fdb_entry *fdb_lookup(struct eth_bridge *br,
+					       const uint8_t *addr,
+					       uint32_t now)
+{
+	struct eth_bridge_fdb_entry *bucket = br->fdb[fdb_hash(addr)];
+	int i;
+
+	for (i = 0; i < ETH_BRIDGE_FDB_WAYS; i++) {
+		if (fdb_entry_is_valid(&bucket[i], now) &&
+		    memcmp(bucket[i].addr, addr, sizeof(bucket[i].addr)) == 0) {
+			return &bucket[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Get a free entry in the bucket of the address, or else the least
+ * recently seen dynamic one. Returns NULL if all are static.
+ */
+static struct eth_bridge_fdb_entry *fdb_alloc(struct eth_bridge *br,
+					      const uint8_t *addr,
+					      uint32_t now)
+{
+	struct eth_bridge_fdb_entry *bucket = br->fdb[fdb_hash(addr)];
+	struct eth_bridge_fdb_entry *oldest = NULL;
+	int i;
+
+	for (i = 0; i < ETH_BRIDGE_FDB_WAYS; i++) {
+		if (!fdb_entry_is_valid(&bucket[i], now)) {
+			return &bucket[i];
+		}
+
+		if (bucket[i].is_static) {
+			continue;
+		}
+
+		if (oldest == NULL ||
+		    now - bucket[i].last_seen > now - oldest->last_seen) {
+			oldest = &bucket[i];
+		}
+	}
+
+	return oldest;
+}
+
+static void fdb_learn(struct eth_bridge *br, const uint8_t *addr,
+		      struct net_if *iface, uint32_t now)
+{
+	struct eth_bridge_fdb_entry *entry;
+
+	entry = fdb_lookup(br, addr, now);
+	if (entry == NULL) {
+		entry = fdb_alloc(br, addr, now);
+		if (entry == NULL) {
+			return;
+		}
+
+		memcpy(entry->addr, addr, sizeof(entry->addr));
+		entry->is_static = false;
+	} else if (entry->is_static) {
+		return;
+	}
+
+	/* The station may have moved to another interface */
+	entry->iface = iface;
+	entry->last_seen = now;
+}
+
+/* Must be called with the bridge locked */
+static void fdb_release(struct eth_bridge *br, struct net_if *iface,
+			bool with_static)
+{
+	struct eth_bridge_fdb_entry *entry;
+	int i, j;
+
+	for (i = 0; i < ETH_BRIDGE_FDB_BUCKETS; i++) {
+		for (j = 0; j < ETH_BRIDGE_FDB_WAYS; j++) {
+			entry = &br->fdb[i][j];
+
+			if (entry->is_static && !with_static) {
+				continue;
+			}
+
+			if (iface == NULL || entry->iface == iface) {
+				entry->iface = NULL;
+			}
+		}
+	}
+}
+
+int eth_bridge_fdb_add(struct eth_bridge *br, struct net_eth_addr *addr,
+		       struct net_if *iface)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+	struct eth_bridge_fdb_entry *entry;
+	uint32_t now = k_uptime_get_32();
+
+	if (net_if_l2(iface) != &NET_L2_GET_NAME(ETHERNET)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+
+	if (ctx->bridge.instance != br) {
+		k_mutex_unlock(&br->lock);
+		return -EINVAL;
+	}
+
+	entry = fdb_lookup(br, addr->addr, now);
+	if (entry == NULL) {
+		entry = fdb_alloc(br, addr->addr, now);
+		if (entry == NULL) {
+			k_mutex_unlock(&br->lock);
+			return -ENOMEM;
+		}
+
+		memcpy(entry->addr, addr->addr, sizeof(entry->addr));
+	}
+
+	entry->iface = iface;
+	entry->last_seen = now;
+	entry->is_static = true;
+
+	k_mutex_unlock(&br->lock);
+
+	return 0;
+}
+
+int eth_bridge_fdb_remove(struct eth_bridge *br, struct net_eth_addr *addr)
+{
+	struct eth_bridge_fdb_entry *entry;
+	int ret = 0;
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+
+	entry = fdb_lookup(br, addr->addr, k_uptime_get_32());
+	if (entry != NULL) {
+		entry->iface = NULL;
+	} else {
+		ret = -ENOENT;
+	}
+
+	k_mutex_unlock(&br->lock);
+
+	return ret;
+}
+
+void eth_bridge_fdb_flush(struct eth_bridge *br, struct net_if *iface)
+{
+	k_mutex_lock(&br->lock, K_FOREVER);
+	fdb_release(br, iface, false);
+	k_mutex_unlock(&br->lock);
+}
+
+void eth_bridge_fdb_foreach(struct eth_bridge *br, eth_bridge_fdb_cb_t cb,
+			    void *user_data)
+{
+	uint32_t now = k_uptime_get_32();
+	int i, j;
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+
+	for (i = 0; i < ETH_BRIDGE_FDB_BUCKETS; i++) {
+		for (j = 0; j < ETH_BRIDGE_FDB_WAYS; j++) {
+			if (fdb_entry_is_valid(&br->fdb[i][j], now)) {
+				cb(&br->fdb[i][j], user_data);
+			}
+		}
+	}
+
+	k_mutex_unlock(&br->lock);
+}
+#else
+int eth_bridge_fdb_add(struct eth_bridge *br, struct net_eth_addr *addr,
+		       struct net_if *iface)
+{
+	return -ENOTSUP;
+}
+
+int eth_bridge_fdb_remove(struct eth_bridge *br, struct net_eth_addr *addr)
+{
+	return -ENOTSUP;
+}
+
+void eth_bridge_fdb_flush(struct eth_bridge *br, struct net_if *iface)
+{
+}
+
+void eth_bridge_fdb_foreach(struct eth_bridge *br, eth_bridge_fdb_cb_t cb,
+			    void *user_data)
+{
+}
+#endif /* CONFIG_NET_ETHERNET_BRIDGE_FDB */
+
 int eth_bridge_iface_add(struct eth_bridge *br, struct net_if *iface)
 {
 	struct ethernet_context *ctx = net_if_l2_data(iface);
@@ -68,6 +304,7 @@ int eth_bridge_iface_add(struct eth_bridge *br, struct net_if *iface)
 
 	ctx->bridge.instance = br;
 	ctx->bridge.allow_tx = false;
+	(void)memset(&ctx->bridge.stats, 0, sizeof(ctx->bridge.stats));
 	sys_slist_append(&br->interfaces, &ctx->bridge.node);
 
 	k_mutex_unlock(&br->lock);
@@ -102,6 +339,10 @@ int eth_bridge_iface_remove(struct eth_bridge *br, struct net_if *iface)
 	sys_slist_find_and_remove(&br->interfaces, &ctx->bridge.node);
 	ctx->bridge.instance = NULL;
 
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+	fdb_release(br, iface, true);
+#endif
+
 	k_mutex_unlock(&br->lock);
 
 	NET_DBG("iface %p removed from bridge %p", iface, br);
@@ -121,6 +362,28 @@ int eth_bridge_iface_allow_tx(struct net_if *iface, bool allow)
 	return 0;
 }
 
+int eth_bridge_iface_get_stats(struct net_if *iface,
+			       struct eth_bridge_iface_stats *stats)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+	struct eth_bridge *br;
+
+	if (net_if_l2(iface) != &NET_L2_GET_NAME(ETHERNET)) {
+		return -EINVAL;
+	}
+
+	br = ctx->bridge.instance;
+	if (br == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+	*stats = ctx->bridge.stats;
+	k_mutex_unlock(&br->lock);
+
+	return 0;
+}
+
 int eth_bridge_listener_add(struct eth_bridge *br, struct eth_bridge_listener *l)
 {
 	k_mutex_lock(&br->lock, K_FOREVER);
@@ -137,75 +400,72 @@ int eth_bridge_listener_remove(struct eth_bridge *br, struct eth_bridge_listener
 	return 0;
 }
 
-static inline bool is_link_local_addr(struct net_eth_addr *addr)
+static inline bool is_link_local_addr(const uint8_t *addr)
 {
-	if (addr->addr[0] == 0x01 &&
-	    addr->addr[1] == 0x80 &&
-	    addr->addr[2] == 0xc2 &&
-	    addr->addr[3] == 0x00 &&
-	    addr->addr[4] == 0x00 &&
-	    (addr->addr[5] & 0x0f) == 0x00) {
+	if (addr[0] == 0x01 &&
+	    addr[1] == 0x80 &&
+	    addr[2] == 0xc2 &&
+	    addr[3] == 0x00 &&
+	    addr[4] == 0x00 &&
+	    (addr[5] & 0x0f) == 0x00) {
 		return true;
 	}
 
 	return false;
 }
 
-enum net_verdict net_eth_bridge_input(struct ethernet_context *ctx,
-				      struct net_pkt *pkt)
+static inline bool can_xmit(struct ethernet_context *out_ctx)
 {
-	struct eth_bridge *br = ctx->bridge.instance;
-	sys_snode_t *node;
+	return out_ctx->bridge.allow_tx &&
+	       net_if_flag_is_set(out_ctx->iface, NET_IF_UP);
+}
 
-	NET_DBG("new pkt %p", pkt);
+static bool xmit(struct net_pkt *pkt, struct ethernet_context *out_ctx)
+{
+	struct net_pkt *out_pkt;
 
-	/* Drop all link-local packets for now. */
-	if (is_link_local_addr((struct net_eth_addr *)net_pkt_lladdr_dst(pkt))) {
-		return NET_DROP;
+	out_pkt = net_pkt_shallow_clone(pkt, K_NO_WAIT);
+	if (out_pkt == NULL) {
+		return false;
 	}
 
-	k_mutex_lock(&br->lock, K_FOREVER);
+	NET_DBG("sending pkt %p as %p on iface %p", pkt, out_pkt, out_ctx->iface);
 
 	/*
-	 * Send packet to all registered interfaces for now.
-	 * Eventually we could get smarter with a MAC address cache.
+	 * Use AF_UNSPEC to avoid interference, set the output
+	 * interface and send the packet.
 	 */
+	net_pkt_set_family(out_pkt, AF_UNSPEC);
+	net_pkt_set_orig_iface(out_pkt, net_pkt_iface(pkt));
+	net_pkt_set_iface(out_pkt, out_ctx->iface);
+	net_if_queue_tx(out_ctx->iface, out_pkt);
+
+	return true;
+}
+
+/* Send the packet to the listeners and to all the interfaces but the
+ * incoming one. Returns false if it was not sent to any interface.
+ */
+static bool flood(struct eth_bridge *br, struct ethernet_context *ctx,
+		  struct net_pkt *pkt)
+{
+	bool sent = false;
+	sys_snode_t *node;
+
 	SYS_SLIST_FOR_EACH_NODE(&br->interfaces, node) {
 		struct ethernet_context *out_ctx;
-		struct net_pkt *out_pkt;
 
 		out_ctx = CONTAINER_OF(node, struct ethernet_context, bridge.node);
 
 		/* Don't xmit on the same interface as the incoming packet's */
-		if (ctx == out_ctx) {
-			continue;
-		}
-
-		/* Skip it if not allowed to transmit */
-		if (!out_ctx->bridge.allow_tx) {
-			continue;
-		}
-
-		/* Skip it if not up */
-		if (!net_if_flag_is_set(out_ctx->iface, NET_IF_UP)) {
+		if (ctx == out_ctx || !can_xmit(out_ctx)) {
 			continue;
 		}
 
-		out_pkt = net_pkt_shallow_clone(pkt, K_NO_WAIT);
-		if (out_pkt == NULL) {
-			continue;
+		if (xmit(pkt, out_ctx)) {
+			out_ctx->bridge.stats.tx_flood++;
+			sent = true;
 		}
-
-		NET_DBG("sending pkt %p as %p on iface %p", pkt, out_pkt, out_ctx->iface);
-
-		/*
-		 * Use AF_UNSPEC to avoid interference, set the output
-		 * interface and send the packet.
-		 */
-		net_pkt_set_family(out_pkt, AF_UNSPEC);
-		net_pkt_set_orig_iface(out_pkt, net_pkt_iface(pkt));
-		net_pkt_set_iface(out_pkt, out_ctx->iface);
-		net_if_queue_tx(out_ctx->iface, out_pkt);
 	}
 
 	SYS_SLIST_FOR_EACH_NODE(&br->listeners, node) {
@@ -222,6 +482,63 @@ enum net_verdict net_eth_bridge_input(struct ethernet_context *ctx,
 		k_fifo_put(&l->pkt_queue, out_pkt);
 	}
 
+	return sent;
+}
+
+enum net_verdict net_eth_bridge_input(struct ethernet_context *ctx,
+				      struct net_pkt *pkt)
+{
+	struct eth_bridge *br = ctx->bridge.instance;
+	const uint8_t *dst = net_pkt_lladdr_dst(pkt)->addr;
+	struct ethernet_context *out_ctx = NULL;
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+	const uint8_t *src = net_pkt_lladdr_src(pkt)->addr;
+	struct eth_bridge_fdb_entry *entry;
+	uint32_t now;
+#endif
+
+	NET_DBG("new pkt %p", pkt);
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+
+	ctx->bridge.stats.rx++;
+
+	/* Drop all link-local packets for now. */
+	if (is_link_local_addr(dst)) {
+		ctx->bridge.stats.drop++;
+		k_mutex_unlock(&br->lock);
+		return NET_DROP;
+	}
+
+#if defined(CONFIG_NET_ETHERNET_BRIDGE_FDB)
+	now = k_uptime_get_32();
+
+	if (!(src[0] & 0x01)) {
+		fdb_learn(br, src, ctx->iface, now);
+	}
+
+	if (!(dst[0] & 0x01)) {
+		entry = fdb_lookup(br, dst, now);
+		if (entry != NULL) {
+			out_ctx = net_if_l2_data(entry->iface);
+		}
+	}
+#endif
+
+	if (out_ctx == NULL) {
+		/* Broadcast, multicast or unknown destination */
+		if (!flood(br, ctx, pkt)) {
+			ctx->bridge.stats.drop++;
+		}
+	} else if (out_ctx == ctx || !can_xmit(out_ctx)) {
+		/* The destination is on the segment the packet comes from,
+		 * or cannot be reached.
+		 */
+		ctx->bridge.stats.drop++;
+	} else if (xmit(pkt, out_ctx)) {
+		out_ctx->bridge.stats.tx_forward++;
+	}
+
 	k_mutex_unlock(&br->lock);
 
 	net_pkt_unref(pkt);
@@ -173,19 +173,29 @@ static void bridge_show(struct eth_bridge *br, void *data)
 	k_mutex_unlock(&br->lock);
 }
 
-static int cmd_bridge_show(const struct shell *sh, size_t argc, char *argv[])
+static struct eth_bridge *get_bridge(const struct shell *sh, char *index_str)
 {
+	struct eth_bridge *br;
 	int br_idx;
+
+	br_idx = get_idx(sh, index_str);
+	if (br_idx < 0) {
+		return NULL;
+	}
+	br = eth_bridge_get_by_index(br_idx);
+	if (br == NULL) {
+		shell_warn(sh, "Bridge %d not found\n", br_idx);
+	}
+	return br;
+}
+
+static int cmd_bridge_show(const struct shell *sh, size_t argc, char *argv[])
+{
 	struct eth_bridge *br = NULL;
 
 	if (argc == 2) {
-		br_idx = get_idx(sh, argv[1]);
-		if (br_idx < 0) {
-			return br_idx;
-		}
-		br = eth_bridge_get_by_index(br_idx);
+		br = get_bridge(sh, argv[1]);
 		if (br == NULL) {
-			shell_warn(sh, "Bridge %d not found\n", br_idx);
 			return -ENOENT;
 		}
 	}
@@ -201,6 +211,199 @@ static int cmd_bridge_show(const struct shell *sh, size_t argc, char *argv[])
 	return 0;
 }
 
+static void bridge_stats(struct eth_bridge *br, void *data)
+{
+	const struct shell *sh = data;
+	int br_idx = eth_bridge_get_index(br);
+	sys_snode_t *node;
+
+	k_mutex_lock(&br->lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_NODE(&br->interfaces, node) {
+		struct ethernet_context *ctx;
+		struct eth_bridge_iface_stats *stats;
+
+		ctx = CONTAINER_OF(node, struct ethernet_context, bridge.node);
+		stats = &ctx->bridge.stats;
+
+		shell_fprintf(sh, SHELL_NORMAL,
+			      "%-10d%-10d%-12u%-12u%-12u%u\n", br_idx,
+			      net_if_get_by_iface(ctx->iface), stats->rx,
+			      stats->tx_forward, stats->tx_flood, stats->drop);
+	}
+
+	k_mutex_unlock(&br->lock);
+}
+
+static int cmd_bridge_stats(const struct shell *sh, size_t argc, char *argv[])
+{
+	struct eth_bridge *br = NULL;
+
+	if (argc == 2) {
+		br = get_bridge(sh, argv[1]);
+		if (br == NULL) {
+			return -ENOENT;
+		}
+	}
+
+	shell_fprintf(sh, SHELL_NORMAL, "bridge    iface     rx          "
+		      "forwarded   flooded     dropped\n");
+
+	if (br != NULL) {
+		bridge_stats(br, (void *)sh);
+	} else {
+		net_eth_bridge_foreach(bridge_stats, (void *)sh);
+	}
+
+	return 0;
+}
+
+static int get_mac(const struct shell *sh, char *mac_str,
+		   struct net_eth_addr *addr)
+{
+	if (net_bytes_from_str(addr->addr, sizeof(addr->addr), mac_str) < 0) {
+		shell_warn(sh, "Invalid MAC address %s\n", mac_str);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static struct net_if *get_iface(const struct shell *sh, char *index_str)
+{
+	struct net_if *iface;
+	int if_idx;
+
+	if_idx = get_idx(sh, index_str);
+	if (if_idx < 0) {
+		return NULL;
+	}
+	iface = net_if_get_by_index(if_idx);
+	if (iface == NULL) {
+		shell_warn(sh, "Interface %d not found\n", if_idx);
+	}
+	return iface;
+}
+
+static void fdb_show(struct eth_bridge_fdb_entry *entry, void *data)
+{
+	const struct shell *sh = data;
+	uint8_t *addr = entry->addr;
+
+	shell_fprintf(sh, SHELL_NORMAL,
+		      "%02x:%02x:%02x:%02x:%02x:%02x  %-10d%s\n",
+		      addr[0], addr[1], addr[2], addr[3], addr[4], addr[5],
+		      net_if_get_by_iface(entry->iface),
+		      entry->is_static ? "static" : "learnt");
+}
+
+static int cmd_bridge_fdb_show(const struct shell *sh, size_t argc,
+			       char *argv[])
+{
+	struct eth_bridge *br;
+
+	br = get_bridge(sh, argv[1]);
+	if (br == NULL) {
+		return -ENOENT;
+	}
+
+	shell_fprintf(sh, SHELL_NORMAL, "address            iface     type\n");
+	eth_bridge_fdb_foreach(br, fdb_show, (void *)sh);
+
+	return 0;
+}
+
+static int cmd_bridge_fdb_add(const struct shell *sh, size_t argc,
+			      char *argv[])
+{
+	struct net_eth_addr addr;
+	struct eth_bridge *br;
+	struct net_if *iface;
+	int ret;
+
+	br = get_bridge(sh, argv[1]);
+	if (br == NULL) {
+		return -ENOENT;
+	}
+	ret = get_mac(sh, argv[2], &addr);
+	if (ret < 0) {
+		return ret;
+	}
+	iface = get_iface(sh, argv[3]);
+	if (iface == NULL) {
+		return -ENOENT;
+	}
+
+	ret = eth_bridge_fdb_add(br, &addr, iface);
+	if (ret < 0) {
+		shell_error(sh, "error: eth_bridge_fdb_add() returned %d\n", ret);
+	}
+	return ret;
+}
+
+static int cmd_bridge_fdb_del(const struct shell *sh, size_t argc,
+			      char *argv[])
+{
+	struct net_eth_addr addr;
+	struct eth_bridge *br;
+	int ret;
+
+	br = get_bridge(sh, argv[1]);
+	if (br == NULL) {
+		return -ENOENT;
+	}
+	ret = get_mac(sh, argv[2], &addr);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = eth_bridge_fdb_remove(br, &addr);
+	if (ret < 0) {
+		shell_error(sh, "error: eth_bridge_fdb_remove() returned %d\n", ret);
+	}
+	return ret;
+}
+
+static int cmd_bridge_fdb_flush(const struct shell *sh, size_t argc,
+				char *argv[])
+{
+	struct eth_bridge *br;
+	struct net_if *iface = NULL;
+
+	br = get_bridge(sh, argv[1]);
+	if (br == NULL) {
+		return -ENOENT;
+	}
+	if (argc == 3) {
+		iface = get_iface(sh, argv[2]);
+		if (iface == NULL) {
+			return -ENOENT;
+		}
+	}
+
+	eth_bridge_fdb_flush(br, iface);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(bridge_fdb_commands,
+	SHELL_CMD_ARG(show, NULL,
+		  "Show the forwarding database of a bridge.\n"
+		  "'bridge fdb show <bridge_index>'",
+		  cmd_bridge_fdb_show, 2, 0),
+	SHELL_CMD_ARG(add, NULL,
+		  "Add a static forwarding database entry.\n"
+		  "'bridge fdb add <bridge_index> <MAC address> <interface_index>'",
+		  cmd_bridge_fdb_add, 4, 0),
+	SHELL_CMD_ARG(del, NULL,
+		  "Delete a forwarding database entry.\n"
+		  "'bridge fdb del <bridge_index> <MAC address>'",
+		  cmd_bridge_fdb_del, 3, 0),
+	SHELL_CMD_ARG(flush, NULL,
+		  "Delete the learnt forwarding database entries.\n"
+		  "'bridge fdb flush <bridge_index> [<interface_index>]'",
+		  cmd_bridge_fdb_flush, 2, 1),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(bridge_commands,
 	SHELL_CMD_ARG(addif, NULL,
 		  "Add a network interface to a bridge.\n"
@@ -218,6 +421,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(bridge_commands,
 		  "Show bridge information.\n"
 		  "'bridge show [<bridge_index>]'",
 		  cmd_bridge_show, 1, 1),
+	SHELL_CMD_ARG(stats, NULL,
+		  "Show bridged interface statistics.\n"
+		  "'bridge stats [<bridge_index>]'",
+		  cmd_bridge_stats, 1, 1),
+	SHELL_CMD(fdb, &bridge_fdb_commands,
+		  "Forwarding database commands.", NULL),
 	SHELL_SUBCMD_SET_END
 );
 
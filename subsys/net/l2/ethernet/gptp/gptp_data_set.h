@@ -19,6 +19,10 @@
 #include <net/gptp.h>
 #include "gptp_state.h"
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+#include "gptp_servo.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -569,6 +573,11 @@ struct gptp_domain {
 
 	/* Network interface linked to the PTP PORT. */
 	struct net_if *iface[CONFIG_NET_GPTP_NUM_PORTS];
+
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+	/** Servo steering the local clock towards the grandmaster. */
+	struct gptp_servo servo;
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
 };
 
 /**
@@ -734,6 +734,93 @@ static void gptp_mi_clk_slave_sync_compute(void)
 }
 
 #if defined(CONFIG_NET_GPTP_USE_DEFAULT_CLOCK_UPDATE)
+static void gptp_clock_step(const struct device *clk, int64_t second_diff,
+			    int64_t nanosecond_diff)
+{
+	struct net_ptp_time tm;
+	bool underflow = false;
+	int key;
+
+	key = irq_lock();
+	ptp_clock_get(clk, &tm);
+
+	if (second_diff < 0 && tm.second < -second_diff) {
+		NET_DBG("Do not set local clock because %lu < %ld",
+			(unsigned long int)tm.second,
+			(long int)-second_diff);
+		goto skip_clock_set;
+	}
+
+	tm.second += second_diff;
+
+	if (nanosecond_diff < 0 &&
+	    tm.nanosecond < -nanosecond_diff) {
+		underflow = true;
+	}
+
+	tm.nanosecond += nanosecond_diff;
+
+	if (underflow) {
+		tm.second--;
+		tm.nanosecond += NSEC_PER_SEC;
+	} else if (tm.nanosecond >= NSEC_PER_SEC) {
+		tm.second++;
+		tm.nanosecond -= NSEC_PER_SEC;
+	}
+
+	/* This prints too much data normally but can be enabled to see
+	 * what time we are setting to the local clock.
+	 */
+	if (0) {
+		NET_INFO("Set local clock %lu.%lu",
+			 (unsigned long int)tm.second,
+			 (unsigned long int)tm.nanosecond);
+	}
+
+	ptp_clock_set(clk, &tm);
+
+skip_clock_set:
+	irq_unlock(key);
+}
+
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+static void gptp_clock_servo(const struct device *clk,
+			     struct gptp_port_ds *port_ds,
+			     int64_t second_diff, int64_t nanosecond_diff)
+{
+	struct gptp_servo *servo = &gptp_domain.servo;
+	enum gptp_servo_state servo_state;
+	int64_t offset;
+	double freq;
+	float ratio;
+
+	offset = second_diff * NSEC_PER_SEC + nanosecond_diff;
+
+	servo_state = gptp_servo_sample(servo, offset,
+					GPTP_GLOBAL_DS()->sync_receipt_local_time,
+					&freq);
+	gptp_servo_update_stats(servo, servo_state, offset,
+				port_ds->neighbor_prop_delay);
+
+	if (servo_state == GPTP_SERVO_UNLOCKED) {
+		return;
+	}
+
+	if (servo_state == GPTP_SERVO_JUMP) {
+		gptp_clock_step(clk, second_diff, nanosecond_diff);
+	}
+
+	ratio = gptp_servo_rate_ratio(servo, freq);
+	if (ratio == 1.0f) {
+		return;
+	}
+
+	if (ptp_clock_rate_adjust(clk, ratio) == 0) {
+		gptp_servo_rate_applied(servo, ratio);
+	}
+}
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
+
 static void gptp_update_local_port_clock(void)
 {
 	struct gptp_clk_slave_sync_state *state;
@@ -743,8 +830,6 @@ static void gptp_update_local_port_clock(void)
 	int64_t nanosecond_diff;
 	int64_t second_diff;
 	const struct device *clk;
-	struct net_ptp_time tm;
-	int key;
 
 	state = &GPTP_STATE()->clk_slave_sync;
 	global_ds = GPTP_GLOBAL_DS();
@@ -781,6 +866,9 @@ static void gptp_update_local_port_clock(void)
 		nanosecond_diff = -NSEC_PER_SEC + nanosecond_diff;
 	}
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+	gptp_clock_servo(clk, port_ds, second_diff, nanosecond_diff);
+#else
 	ptp_clock_rate_adjust(clk, port_ds->neighbor_rate_ratio);
 
 	/* If time difference is too high, set the clock value.
@@ -789,48 +877,7 @@ static void gptp_update_local_port_clock(void)
 	if (second_diff || (second_diff == 0 &&
 			    (nanosecond_diff < -5000 ||
 			     nanosecond_diff > 5000))) {
-		bool underflow = false;
-
-		key = irq_lock();
-		ptp_clock_get(clk, &tm);
-
-		if (second_diff < 0 && tm.second < -second_diff) {
-			NET_DBG("Do not set local clock because %lu < %ld",
-				(unsigned long int)tm.second,
-				(long int)-second_diff);
-			goto skip_clock_set;
-		}
-
-		tm.second += second_diff;
-
-		if (nanosecond_diff < 0 &&
-		    tm.nanosecond < -nanosecond_diff) {
-			underflow = true;
-		}
-
-		tm.nanosecond += nanosecond_diff;
-
-		if (underflow) {
-			tm.second--;
-			tm.nanosecond += NSEC_PER_SEC;
-		} else if (tm.nanosecond >= NSEC_PER_SEC) {
-			tm.second++;
-			tm.nanosecond -= NSEC_PER_SEC;
-		}
-
-		/* This prints too much data normally but can be enabled to see
-		 * what time we are setting to the local clock.
-		 */
-		if (0) {
-			NET_INFO("Set local clock %lu.%lu",
-				 (unsigned long int)tm.second,
-				 (unsigned long int)tm.nanosecond);
-		}
-
-		ptp_clock_set(clk, &tm);
-
-	skip_clock_set:
-		irq_unlock(key);
+		gptp_clock_step(clk, second_diff, nanosecond_diff);
 	} else {
 		if (nanosecond_diff < -200) {
 			nanosecond_diff = -200;
@@ -840,6 +887,7 @@ static void gptp_update_local_port_clock(void)
 
 		ptp_clock_adjust(clk, nanosecond_diff);
 	}
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
 }
 #endif /* CONFIG_NET_GPTP_USE_DEFAULT_CLOCK_UPDATE */
 
@@ -852,6 +900,9 @@ static void gptp_mi_clk_slave_sync_state_machine(void)
 	switch (state->state) {
 	case GPTP_CLK_SLAVE_SYNC_INITIALIZING:
 		state->rcvd_pss = false;
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+		gptp_servo_reset(&gptp_domain.servo);
+#endif
 		state->state = GPTP_CLK_SLAVE_SYNC_SEND_SYNC_IND;
 		break;
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_gptp, CONFIG_NET_GPTP_LOG_LEVEL);
+
+#include <stdlib.h>
+
+#include "gptp_servo.h"
+#include "net_private.h"
+
+#define SERVO_KP (CONFIG_NET_GPTP_SERVO_KP / 1000.0)
+#define SERVO_KI (CONFIG_NET_GPTP_SERVO_KI / 1000.0)
+#define SERVO_MAX_PPB ((double)CONFIG_NET_GPTP_SERVO_MAX_PPB)
+
+static double servo_clamp(double ppb)
+{
+	if (ppb > SERVO_MAX_PPB) {
+		return SERVO_MAX_PPB;
+	} else if (ppb < -SERVO_MAX_PPB) {
+		return -SERVO_MAX_PPB;
+	}
+
+	return ppb;
+}
+
+void gptp_servo_reset(struct gptp_servo *servo)
+{
+	servo->count = 0U;
+}
+
+enum gptp_servo_state gptp_servo_sample(struct gptp_servo *servo,
+					int64_t offset, uint64_t local_time,
+					double *freq)
+{
+	enum gptp_servo_state state = GPTP_SERVO_UNLOCKED;
+	int64_t interval;
+
+	switch (servo->count) {
+	case 0:
+		servo->count = 1U;
+		break;
+
+	case 1:
+		interval = local_time - servo->last_local_time;
+		if (interval <= 0) {
+			break;
+		}
+
+		/* Estimate the remaining frequency error from how much the
+		 * offset changed between the first two samples.
+		 */
+		servo->drift = servo_clamp(servo->drift +
+					   (double)(offset - servo->last_offset) *
+					   NSEC_PER_SEC / interval);
+		servo->freq = servo->drift;
+		servo->count = 2U;
+
+		if (llabs(offset) > CONFIG_NET_GPTP_SERVO_STEP_THRESHOLD) {
+			state = GPTP_SERVO_JUMP;
+		} else {
+			state = GPTP_SERVO_LOCKED;
+		}
+
+		break;
+
+	case 2:
+		if (llabs(offset) > CONFIG_NET_GPTP_SERVO_STEP_THRESHOLD) {
+			NET_DBG("Offset %lld ns too large, reset servo",
+				(long long)offset);
+
+			servo->count = 0U;
+			break;
+		}
+
+		servo->drift = servo_clamp(servo->drift + SERVO_KI * offset);
+		servo->freq = servo_clamp(SERVO_KP * offset + servo->drift);
+		state = GPTP_SERVO_LOCKED;
+		break;
+	}
+
+	servo->last_offset = offset;
+	servo->last_local_time = local_time;
+
+	*freq = servo->freq;
+
+	return state;
+}
+
+float gptp_servo_rate_ratio(const struct gptp_servo *servo, double freq)
+{
+	/* The rate adjustment is relative to the current rate of the
+	 * clock, so only apply the change from the previous adjustment.
+	 */
+	return (float)((1.0 + freq / NSEC_PER_SEC) /
+		       (1.0 + servo->applied_freq / NSEC_PER_SEC));
+}
+
+void gptp_servo_rate_applied(struct gptp_servo *servo, float ratio)
+{
+	/* Near 1.0 a float moves in steps of 60 - 120 ppb, so track the
+	 * adjustment the clock actually got. Whatever was rounded away is
+	 * then part of the next ratio.
+	 */
+	servo->applied_freq = ((1.0 + servo->applied_freq / NSEC_PER_SEC) *
+			       (double)ratio - 1.0) * NSEC_PER_SEC;
+}
+
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+static int servo_hist_bucket(uint64_t value)
+{
+	int i = 0;
+
+	while (i < GPTP_SERVO_HIST_SIZE - 1 && value >= (16ULL << i)) {
+		i++;
+	}
+
+	return i;
+}
+
+void gptp_servo_update_stats(struct gptp_servo *servo,
+			     enum gptp_servo_state state, int64_t offset,
+			     double path_delay)
+{
+	struct gptp_servo_stats *stats = &servo->stats;
+	uint64_t abs_offset = llabs(offset);
+
+	stats->samples++;
+	stats->last_offset = offset;
+	stats->offset_hist[servo_hist_bucket(abs_offset)]++;
+
+	if (path_delay >= 0) {
+		stats->path_delay_hist[servo_hist_bucket(path_delay)]++;
+	}
+
+	if (state == GPTP_SERVO_JUMP) {
+		stats->steps++;
+	} else if (state == GPTP_SERVO_LOCKED &&
+		   abs_offset > stats->max_offset) {
+		stats->max_offset = abs_offset;
+	}
+}
+#endif /* CONFIG_NET_GPTP_STATISTICS */
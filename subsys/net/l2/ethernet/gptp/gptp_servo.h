@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief gPTP clock servo
+ *
+ * This is not to be included by the application.
+ */
+
+#ifndef __GPTP_SERVO_H
+#define __GPTP_SERVO_H
+
+#include <zephyr/types.h>
+#include <sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of histogram buckets. Bucket i counts the values below
+ * 16 << i nanoseconds, the last bucket counts the rest.
+ */
+#define GPTP_SERVO_HIST_SIZE 12
+
+/** State of the servo after a new offset sample. */
+enum gptp_servo_state {
+	/** Not enough samples yet, the clock is not adjusted. */
+	GPTP_SERVO_UNLOCKED,
+
+	/** The clock needs to be stepped, and its frequency adjusted. */
+	GPTP_SERVO_JUMP,
+
+	/** The frequency of the clock is adjusted. */
+	GPTP_SERVO_LOCKED,
+};
+
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+/** Servo statistics. */
+struct gptp_servo_stats {
+	/** Offset histogram, in absolute nanoseconds. */
+	uint32_t offset_hist[GPTP_SERVO_HIST_SIZE];
+
+	/** Neighbor propagation delay histogram, in nanoseconds. */
+	uint32_t path_delay_hist[GPTP_SERVO_HIST_SIZE];
+
+	/** Last offset from the grandmaster, in nanoseconds. */
+	int64_t last_offset;
+
+	/** Largest absolute offset while locked, in nanoseconds. */
+	uint64_t max_offset;
+
+	/** Number of offset samples. */
+	uint32_t samples;
+
+	/** Number of times the clock was stepped. */
+	uint32_t steps;
+};
+#endif /* CONFIG_NET_GPTP_STATISTICS */
+
+/** PI servo that steers the frequency of the local clock. */
+struct gptp_servo {
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+	struct gptp_servo_stats stats;
+#endif
+
+	/** Local time of the previous sample, in nanoseconds. */
+	uint64_t last_local_time;
+
+	/** Offset of the previous sample, in nanoseconds. */
+	int64_t last_offset;
+
+	/** Integral term, the estimated frequency error in ppb. */
+	double drift;
+
+	/** Frequency adjustment requested by the servo, in ppb. */
+	double freq;
+
+	/** Frequency adjustment the clock runs with, in ppb. */
+	double applied_freq;
+
+	/** Number of samples since the servo was reset, up to 2. */
+	uint8_t count;
+};
+
+/**
+ * @brief Reset the servo.
+ *
+ * @details The frequency estimate and the applied frequency are kept.
+ *
+ * @param servo Servo
+ */
+void gptp_servo_reset(struct gptp_servo *servo);
+
+/**
+ * @brief Feed a new offset sample to the servo.
+ *
+ * @param servo Servo
+ * @param offset Grandmaster time minus local time, in nanoseconds
+ * @param local_time Local time of the sample, in nanoseconds
+ * @param freq Frequency adjustment to apply, in ppb (returned to caller)
+ *
+ * @return What the caller needs to do with the local clock.
+ */
+enum gptp_servo_state gptp_servo_sample(struct gptp_servo *servo,
+					int64_t offset, uint64_t local_time,
+					double *freq);
+
+/**
+ * @brief Get the rate ratio that moves the clock to a new frequency.
+ *
+ * @details The ratio is relative to the adjustment the clock already runs
+ * with. If it rounds to 1.0f, the change is too small to be applied yet.
+ *
+ * @param servo Servo
+ * @param freq Frequency adjustment returned by gptp_servo_sample(), in ppb
+ *
+ * @return Ratio to pass to ptp_clock_rate_adjust().
+ */
+float gptp_servo_rate_ratio(const struct gptp_servo *servo, double freq);
+
+/**
+ * @brief Tell the servo that a rate ratio was applied to the clock.
+ *
+ * @param servo Servo
+ * @param ratio Ratio returned by gptp_servo_rate_ratio()
+ */
+void gptp_servo_rate_applied(struct gptp_servo *servo, float ratio);
+
+/**
+ * @brief Update the servo statistics.
+ *
+ * @param servo Servo
+ * @param state State returned by gptp_servo_sample()
+ * @param offset Offset passed to gptp_servo_sample()
+ * @param path_delay Neighbor propagation delay, in nanoseconds
+ */
+#if defined(CONFIG_NET_GPTP_STATISTICS)
+void gptp_servo_update_stats(struct gptp_servo *servo,
+			     enum gptp_servo_state state, int64_t offset,
+			     double path_delay);
+#else
+static inline void gptp_servo_update_stats(struct gptp_servo *servo,
+					   enum gptp_servo_state state,
+					   int64_t offset, double path_delay)
+{
+	ARG_UNUSED(servo);
+	ARG_UNUSED(state);
+	ARG_UNUSED(offset);
+	ARG_UNUSED(path_delay);
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GPTP_SERVO_H */
@@ -0,0 +1,629 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Filter expressions for network packet capture.
+ *
+ * The expressions use a subset of the tcpdump syntax:
+ *
+ *   ip, ip6, tcp, udp, icmp, icmp6
+ *   [src|dst] host <address>
+ *   [tcp|udp] [src|dst] port <number>
+ *   less <length>, greater <length>
+ *
+ * combined with "and" ("&&"), "or" ("||"), "not" ("!") and parentheses.
+ * The expression is compiled once to postfix order and evaluated on the
+ * headers of every packet, before the packet is copied anywhere.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/byteorder.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+
+#include "capture_internal.h"
+
+/* Enough for an Ethernet header with a VLAN tag, an IPv6 header with a
+ * few extension headers and the ports.
+ */
+#define FILTER_HDR_LEN 128
+
+#define IPV6_NEXTHDR_HOP	0
+#define IPV6_NEXTHDR_ROUTING	43
+#define IPV6_NEXTHDR_FRAG	44
+#define IPV6_NEXTHDR_DESTOPT	60
+
+struct filter_parser {
+	struct capture_filter *filter;
+	const char *pos;
+	char token[INET6_ADDRSTRLEN];
+	int depth;
+};
+
+struct filter_pkt {
+	const uint8_t *src;
+	const uint8_t *dst;
+	size_t len;
+	uint16_t src_port;
+	uint16_t dst_port;
+	sa_family_t family;
+	uint8_t proto;
+	bool has_ports;
+};
+
+static int parse_or(struct filter_parser *parser);
+
+/* Read the next token, an empty token marks the end of the expression */
+static int next_token(struct filter_parser *parser)
+{
+	const char *start;
+	size_t len;
+
+	while (isspace((unsigned char)*parser->pos)) {
+		parser->pos++;
+	}
+
+	start = parser->pos;
+
+	if (*start == '(' || *start == ')' || *start == '!') {
+		len = 1;
+	} else if ((start[0] == '&' && start[1] == '&') ||
+		   (start[0] == '|' && start[1] == '|')) {
+		len = 2;
+	} else {
+		for (len = 0; start[len] != '\0'; len++) {
+			if (isspace((unsigned char)start[len]) ||
+			    strchr("()!&|", start[len]) != NULL) {
+				break;
+			}
+		}
+	}
+
+	/* A lone '&' or '|' */
+	if ((len == 0 && *start != '\0') || len >= sizeof(parser->token)) {
+		return -EINVAL;
+	}
+
+	memcpy(parser->token, start, len);
+	parser->token[len] = '\0';
+	parser->pos += len;
+
+	return 0;
+}
+
+static bool token_is(struct filter_parser *parser, const char *str)
+{
+	return strcmp(parser->token, str) == 0;
+}
+
+static int emit(struct filter_parser *parser, uint8_t op, uint8_t dir,
+		uint16_t value, const struct in6_addr *addr)
+{
+	struct capture_filter *filter = parser->filter;
+	struct capture_filter_insn *insn;
+
+	if (filter->count >= ARRAY_SIZE(filter->insn)) {
+		return -E2BIG;
+	}
+
+	insn = &filter->insn[filter->count++];
+	insn->op = op;
+	insn->dir = dir;
+	insn->value = value;
+
+	if (addr) {
+		net_ipaddr_copy(&insn->addr, addr);
+	}
+
+	return 0;
+}
+
+static int parse_number(struct filter_parser *parser, uint16_t *value)
+{
+	unsigned long number;
+	char *end;
+	int ret;
+
+	ret = next_token(parser);
+	if (ret < 0) {
+		return ret;
+	}
+
+	number = strtoul(parser->token, &end, 10);
+	if (!isdigit((unsigned char)parser->token[0]) || *end != '\0' ||
+	    number > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	*value = number;
+
+	return 0;
+}
+
+/* net_addr_pton() accepts incomplete IPv4 addresses like "192.0.2" */
+static bool is_ipv4_addr(const char *str)
+{
+	int parts = 0, digits = 0, value = 0;
+
+	for (;; str++) {
+		if (isdigit((unsigned char)*str)) {
+			value = value * 10 + *str - '0';
+			if (++digits > 3 || value > UINT8_MAX) {
+				return false;
+			}
+
+			continue;
+		}
+
+		if (digits == 0 || (*str != '.' && *str != '\0')) {
+			return false;
+		}
+
+		if (++parts == 4 || *str == '\0') {
+			return parts == 4 && *str == '\0';
+		}
+
+		digits = 0;
+		value = 0;
+	}
+}
+
+static int parse_host(struct filter_parser *parser, uint8_t dir)
+{
+	struct in6_addr addr = { 0 };
+	sa_family_t family;
+	int ret;
+
+	ret = next_token(parser);
+	if (ret < 0) {
+		return ret;
+	}
+
+	family = strchr(parser->token, ':') ? AF_INET6 : AF_INET;
+
+	if ((family == AF_INET && !is_ipv4_addr(parser->token)) ||
+	    net_addr_pton(family, parser->token, &addr) < 0) {
+		return -EINVAL;
+	}
+
+	return emit(parser, CAPTURE_FILTER_HOST, dir, family, &addr);
+}
+
+/* [src|dst] host <address> or [src|dst] port <number> */
+static int parse_dir_primitive(struct filter_parser *parser, bool port_only)
+{
+	uint8_t dir = CAPTURE_FILTER_SRC_OR_DST;
+	uint16_t port;
+	int ret;
+
+	if (token_is(parser, "src") || token_is(parser, "dst")) {
+		dir = token_is(parser, "src") ? CAPTURE_FILTER_SRC :
+						CAPTURE_FILTER_DST;
+
+		ret = next_token(parser);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (!port_only && token_is(parser, "host")) {
+		return parse_host(parser, dir);
+	}
+
+	if (!token_is(parser, "port")) {
+		return -EINVAL;
+	}
+
+	ret = parse_number(parser, &port);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return emit(parser, CAPTURE_FILTER_PORT, dir, port, NULL);
+}
+
+static int parse_primitive(struct filter_parser *parser)
+{
+	static const struct {
+		const char *name;
+		uint8_t op;
+		uint16_t value;
+	} protos[] = {
+		{ "ip", CAPTURE_FILTER_FAMILY, AF_INET },
+		{ "ip6", CAPTURE_FILTER_FAMILY, AF_INET6 },
+		{ "tcp", CAPTURE_FILTER_PROTO, IPPROTO_TCP },
+		{ "udp", CAPTURE_FILTER_PROTO, IPPROTO_UDP },
+		{ "icmp", CAPTURE_FILTER_PROTO, IPPROTO_ICMP },
+		{ "icmp6", CAPTURE_FILTER_PROTO, IPPROTO_ICMPV6 },
+	};
+	const char *pos;
+	uint16_t value;
+	int ret, i;
+
+	for (i = 0; i < ARRAY_SIZE(protos); i++) {
+		if (!token_is(parser, protos[i].name)) {
+			continue;
+		}
+
+		ret = emit(parser, protos[i].op, CAPTURE_FILTER_SRC_OR_DST,
+			   protos[i].value, NULL);
+		if (ret < 0 || protos[i].op != CAPTURE_FILTER_PROTO) {
+			return ret;
+		}
+
+		/* "tcp port 80" is a shorthand for "tcp and port 80" */
+		pos = parser->pos;
+
+		ret = next_token(parser);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!token_is(parser, "src") && !token_is(parser, "dst") &&
+		    !token_is(parser, "port")) {
+			parser->pos = pos;
+			return 0;
+		}
+
+		ret = parse_dir_primitive(parser, true);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return emit(parser, CAPTURE_FILTER_AND,
+			    CAPTURE_FILTER_SRC_OR_DST, 0, NULL);
+	}
+
+	if (token_is(parser, "less") || token_is(parser, "greater")) {
+		uint8_t op = token_is(parser, "less") ? CAPTURE_FILTER_LESS :
+							CAPTURE_FILTER_GREATER;
+
+		ret = parse_number(parser, &value);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return emit(parser, op, CAPTURE_FILTER_SRC_OR_DST, value, NULL);
+	}
+
+	return parse_dir_primitive(parser, false);
+}
+
+/* Parse a negated or parenthesized operand. The nesting is bounded so a
+ * crafted expression cannot overflow the stack of the parser.
+ */
+static int parse_nested(struct filter_parser *parser,
+			int (*parse)(struct filter_parser *parser))
+{
+	int ret;
+
+	if (parser->depth >= CONFIG_NET_CAPTURE_FILTER_LEN) {
+		return -E2BIG;
+	}
+
+	parser->depth++;
+	ret = parse(parser);
+	parser->depth--;
+
+	return ret;
+}
+
+/* The parse functions below leave the token following their operand in
+ * parser->token.
+ */
+static int parse_not(struct filter_parser *parser)
+{
+	int ret;
+
+	ret = next_token(parser);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (token_is(parser, "not") || token_is(parser, "!")) {
+		ret = parse_nested(parser, parse_not);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return emit(parser, CAPTURE_FILTER_NOT,
+			    CAPTURE_FILTER_SRC_OR_DST, 0, NULL);
+	}
+
+	if (token_is(parser, "(")) {
+		ret = parse_nested(parser, parse_or);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return token_is(parser, ")") ? next_token(parser) : -EINVAL;
+	}
+
+	ret = parse_primitive(parser);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return next_token(parser);
+}
+
+static int parse_and(struct filter_parser *parser)
+{
+	int ret;
+
+	ret = parse_not(parser);
+
+	while (ret == 0 && (token_is(parser, "and") || token_is(parser, "&&"))) {
+		ret = parse_not(parser);
+		if (ret == 0) {
+			ret = emit(parser, CAPTURE_FILTER_AND,
+				   CAPTURE_FILTER_SRC_OR_DST, 0, NULL);
+		}
+	}
+
+	return ret;
+}
+
+static int parse_or(struct filter_parser *parser)
+{
+	int ret;
+
+	ret = parse_and(parser);
+
+	while (ret == 0 && (token_is(parser, "or") || token_is(parser, "||"))) {
+		ret = parse_and(parser);
+		if (ret == 0) {
+			ret = emit(parser, CAPTURE_FILTER_OR,
+				   CAPTURE_FILTER_SRC_OR_DST, 0, NULL);
+		}
+	}
+
+	return ret;
+}
+
+int capture_filter_compile(struct capture_filter *filter, const char *expr)
+{
+	struct filter_parser parser = {
+		.filter = filter,
+		.pos = expr,
+	};
+	int ret;
+
+	filter->count = 0U;
+
+	if (expr == NULL || *expr == '\0') {
+		return 0;
+	}
+
+	ret = parse_or(&parser);
+	if (ret == 0 && parser.token[0] != '\0') {
+		/* Trailing garbage, like an unbalanced ")" */
+		ret = -EINVAL;
+	}
+
+	if (ret < 0) {
+		NET_DBG("Invalid filter \"%s\" (%d)", log_strdup(expr), ret);
+		filter->count = 0U;
+		return ret;
+	}
+
+	return 0;
+}
+
+static void parse_transport(struct filter_pkt *info, const uint8_t *hdr,
+			    size_t hdr_len, size_t offset)
+{
+	if ((info->proto != IPPROTO_TCP && info->proto != IPPROTO_UDP) ||
+	    offset + 2 * sizeof(uint16_t) > hdr_len) {
+		return;
+	}
+
+	info->src_port = sys_get_be16(&hdr[offset]);
+	info->dst_port = sys_get_be16(&hdr[offset + sizeof(uint16_t)]);
+	info->has_ports = true;
+}
+
+static void parse_ipv4(struct filter_pkt *info, const uint8_t *hdr,
+		       size_t hdr_len, size_t offset)
+{
+	if (offset + sizeof(struct net_ipv4_hdr) > hdr_len) {
+		return;
+	}
+
+	info->family = AF_INET;
+	info->proto = hdr[offset + offsetof(struct net_ipv4_hdr, proto)];
+	info->src = &hdr[offset + offsetof(struct net_ipv4_hdr, src)];
+	info->dst = &hdr[offset + offsetof(struct net_ipv4_hdr, dst)];
+
+	/* Only the first fragment has the ports */
+	if (sys_get_be16(&hdr[offset + offsetof(struct net_ipv4_hdr,
+						offset)]) & 0x1fff) {
+		return;
+	}
+
+	parse_transport(info, hdr, hdr_len,
+			offset + (hdr[offset] & 0x0f) * sizeof(uint32_t));
+}
+
+static void parse_ipv6(struct filter_pkt *info, const uint8_t *hdr,
+		       size_t hdr_len, size_t offset)
+{
+	uint8_t nexthdr;
+
+	if (offset + sizeof(struct net_ipv6_hdr) > hdr_len) {
+		return;
+	}
+
+	info->family = AF_INET6;
+	info->src = &hdr[offset + offsetof(struct net_ipv6_hdr, src)];
+	info->dst = &hdr[offset + offsetof(struct net_ipv6_hdr, dst)];
+	nexthdr = hdr[offset + offsetof(struct net_ipv6_hdr, nexthdr)];
+	offset += sizeof(struct net_ipv6_hdr);
+
+	/* Skip the extension headers to find the upper layer protocol */
+	while (nexthdr == IPV6_NEXTHDR_HOP ||
+	       nexthdr == IPV6_NEXTHDR_ROUTING ||
+	       nexthdr == IPV6_NEXTHDR_FRAG ||
+	       nexthdr == IPV6_NEXTHDR_DESTOPT) {
+		if (offset + 8 > hdr_len) {
+			return;
+		}
+
+		if (nexthdr == IPV6_NEXTHDR_FRAG) {
+			if (sys_get_be16(&hdr[offset + 2]) & 0xfff8) {
+				info->proto = hdr[offset];
+				return;
+			}
+
+			nexthdr = hdr[offset];
+			offset += 8;
+		} else {
+			nexthdr = hdr[offset];
+			offset += (hdr[offset + 1] + 1) * 8;
+		}
+	}
+
+	info->proto = nexthdr;
+
+	parse_transport(info, hdr, hdr_len, offset);
+}
+
+static void parse_pkt(struct filter_pkt *info, uint16_t link_type,
+		      const uint8_t *hdr, size_t hdr_len)
+{
+	size_t offset = 0;
+	uint16_t type;
+
+	if (link_type == CAPTURE_LINKTYPE_ETHERNET) {
+		if (hdr_len < sizeof(struct net_eth_hdr)) {
+			return;
+		}
+
+		type = sys_get_be16(&hdr[offsetof(struct net_eth_hdr, type)]);
+		offset = sizeof(struct net_eth_hdr);
+
+		if (type == NET_ETH_PTYPE_VLAN) {
+			if (hdr_len < offset + 2 * sizeof(uint16_t)) {
+				return;
+			}
+
+			type = sys_get_be16(&hdr[offset + sizeof(uint16_t)]);
+			offset += 2 * sizeof(uint16_t);
+		}
+
+		if (type == NET_ETH_PTYPE_IP) {
+			parse_ipv4(info, hdr, hdr_len, offset);
+		} else if (type == NET_ETH_PTYPE_IPV6) {
+			parse_ipv6(info, hdr, hdr_len, offset);
+		}
+	} else if (link_type == CAPTURE_LINKTYPE_RAW && hdr_len > 0) {
+		if ((hdr[0] >> 4) == 4) {
+			parse_ipv4(info, hdr, hdr_len, 0);
+		} else if ((hdr[0] >> 4) == 6) {
+			parse_ipv6(info, hdr, hdr_len, 0);
+		}
+	}
+}
+
+static bool match_dir(uint8_t dir, bool src, bool dst)
+{
+	switch (dir) {
+	case CAPTURE_FILTER_SRC:
+		return src;
+	case CAPTURE_FILTER_DST:
+		return dst;
+	default:
+		return src || dst;
+	}
+}
+
+static bool match_insn(const struct capture_filter_insn *insn,
+		       const struct filter_pkt *info)
+{
+	size_t addr_len;
+
+	switch (insn->op) {
+	case CAPTURE_FILTER_FAMILY:
+		return info->family == insn->value;
+
+	case CAPTURE_FILTER_PROTO:
+		return info->family != AF_UNSPEC && info->proto == insn->value;
+
+	case CAPTURE_FILTER_HOST:
+		if (info->family != insn->value) {
+			return false;
+		}
+
+		addr_len = info->family == AF_INET ? sizeof(struct in_addr) :
+						     sizeof(struct in6_addr);
+
+		return match_dir(insn->dir,
+				 !memcmp(info->src, &insn->addr, addr_len),
+				 !memcmp(info->dst, &insn->addr, addr_len));
+
+	case CAPTURE_FILTER_PORT:
+		return info->has_ports &&
+		       match_dir(insn->dir, info->src_port == insn->value,
+				 info->dst_port == insn->value);
+
+	case CAPTURE_FILTER_LESS:
+		return info->len <= insn->value;
+
+	case CAPTURE_FILTER_GREATER:
+		return info->len >= insn->value;
+	}
+
+	return false;
+}
+
+bool capture_filter_match(const struct capture_filter *filter,
+			  uint16_t link_type, struct net_pkt *pkt)
+{
+	bool stack[CONFIG_NET_CAPTURE_FILTER_LEN];
+	struct filter_pkt info = { 0 };
+	uint8_t hdr[FILTER_HDR_LEN];
+	size_t hdr_len;
+	int i, top = 0;
+
+	if (filter->count == 0U) {
+		return true;
+	}
+
+	info.len = net_pkt_get_len(pkt);
+	hdr_len = net_buf_linearize(hdr, sizeof(hdr), pkt->buffer, 0,
+				    MIN(info.len, sizeof(hdr)));
+
+	parse_pkt(&info, link_type, hdr, hdr_len);
+
+	for (i = 0; i < filter->count; i++) {
+		const struct capture_filter_insn *insn = &filter->insn[i];
+
+		switch (insn->op) {
+		case CAPTURE_FILTER_NOT:
+			stack[top - 1] = !stack[top - 1];
+			break;
+		case CAPTURE_FILTER_AND:
+			top--;
+			stack[top - 1] = stack[top - 1] && stack[top];
+			break;
+		case CAPTURE_FILTER_OR:
+			top--;
+			stack[top - 1] = stack[top - 1] || stack[top];
+			break;
+		default:
+			stack[top++] = match_insn(insn, &info);
+			break;
+		}
+	}
+
+	return stack[0];
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture internal definitions
+ *
+ * This is not to be included by the application.
+ */
+
+#ifndef __CAPTURE_INTERNAL_H
+#define __CAPTURE_INTERNAL_H
+
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+
+/* Link types used in the pcapng interface description block */
+#define CAPTURE_LINKTYPE_ETHERNET		1
+#define CAPTURE_LINKTYPE_RAW			101
+#define CAPTURE_LINKTYPE_IEEE802_15_4_NOFCS	230
+
+#if defined(CONFIG_NET_CAPTURE_PCAPNG)
+
+enum capture_filter_op {
+	CAPTURE_FILTER_FAMILY,
+	CAPTURE_FILTER_PROTO,
+	CAPTURE_FILTER_HOST,
+	CAPTURE_FILTER_PORT,
+	CAPTURE_FILTER_LESS,
+	CAPTURE_FILTER_GREATER,
+	CAPTURE_FILTER_NOT,
+	CAPTURE_FILTER_AND,
+	CAPTURE_FILTER_OR,
+};
+
+enum capture_filter_dir {
+	CAPTURE_FILTER_SRC_OR_DST,
+	CAPTURE_FILTER_SRC,
+	CAPTURE_FILTER_DST,
+};
+
+struct capture_filter_insn {
+	/** IPv4 or IPv6 address of a host primitive */
+	struct in6_addr addr;
+
+	/** Port, length, address family or IP protocol */
+	uint16_t value;
+
+	/** One of enum capture_filter_op */
+	uint8_t op;
+
+	/** One of enum capture_filter_dir */
+	uint8_t dir;
+};
+
+/** Filter expression compiled to postfix order */
+struct capture_filter {
+	struct capture_filter_insn insn[CONFIG_NET_CAPTURE_FILTER_LEN];
+	uint8_t count;
+};
+
+/**
+ * @brief Compile a filter expression.
+ *
+ * @param filter Compiled filter
+ * @param expr Filter expression, NULL or empty to match all packets
+ *
+ * @return 0 if ok, -EINVAL if the expression is invalid, -E2BIG if it
+ *         does not fit in CONFIG_NET_CAPTURE_FILTER_LEN instructions or
+ *         nests "not" and parentheses deeper than that
+ */
+int capture_filter_compile(struct capture_filter *filter, const char *expr);
+
+/**
+ * @brief Check if a network packet passes the filter.
+ *
+ * @param filter Compiled filter
+ * @param link_type Link type of the packet data
+ * @param pkt Network packet, it is not modified
+ *
+ * @return True if the packet passes the filter
+ */
+bool capture_filter_match(const struct capture_filter *filter,
+			  uint16_t link_type, struct net_pkt *pkt);
+
+void capture_pcapng_pkt(struct net_if *iface, struct net_pkt *pkt);
+
+#else
+
+static inline void capture_pcapng_pkt(struct net_if *iface,
+				      struct net_pkt *pkt)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(pkt);
+}
+
+#endif /* CONFIG_NET_CAPTURE_PCAPNG */
+
+#endif /* __CAPTURE_INTERNAL_H */
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture to a pcapng file.
+ *
+ * The packets passing the filter are copied, truncated to the snap length,
+ * straight from their net_buf fragments into a ring buffer as pcapng
+ * enhanced packet blocks. There is no packet clone and no allocation in the
+ * sending and receiving paths. The writers evaluate the filter and copy
+ * the packet without any lock, they only serialize against each other to
+ * reserve and commit ring buffer space. A low priority thread drains the
+ * ring buffer to the file or the write callback without taking any lock.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/ring_buffer.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/capture.h>
+
+#if defined(CONFIG_FILE_SYSTEM)
+#include <fs/fs.h>
+#endif
+
+#include "capture_internal.h"
+
+#define PCAPNG_BLOCK_SHB	0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB	0x00000001
+#define PCAPNG_BLOCK_EPB	0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC	0x1a2b3c4d
+
+/* How often the writer thread drains the ring buffer when it is not
+ * filling up.
+ */
+#define DRAIN_INTERVAL K_MSEC(100)
+
+struct pcapng_shb {
+	uint32_t type;
+	uint32_t len;
+	uint32_t magic;
+	uint16_t major;
+	uint16_t minor;
+	int64_t section_len;
+	uint32_t trailer_len;
+} __packed;
+
+struct pcapng_idb {
+	uint32_t type;
+	uint32_t len;
+	uint16_t link_type;
+	uint16_t reserved;
+	uint32_t snaplen;
+	uint32_t trailer_len;
+} __packed;
+
+/* Followed by the packet data, padded to 32 bits, and the block length */
+struct pcapng_epb {
+	uint32_t type;
+	uint32_t len;
+	uint32_t iface_id;
+	uint32_t ts_high;
+	uint32_t ts_low;
+	uint32_t captured_len;
+	uint32_t orig_len;
+} __packed;
+
+/* Ring buffer space reserved for one block, in two parts when it wraps
+ * around.
+ */
+struct ring_block {
+	uint8_t *data[2];
+	uint32_t len[2];
+	uint32_t pos;
+};
+
+RING_BUF_DECLARE(pcapng_ring, CONFIG_NET_CAPTURE_PCAPNG_BUF_SIZE);
+
+/* Serializes the reservations and commits of ring buffer space, and
+ * protects the writer count and the statistics.
+ */
+static struct k_spinlock ring_lock;
+
+/* Serializes start and stop */
+static K_MUTEX_DEFINE(pcapng_lock);
+
+static K_SEM_DEFINE(drain_sem, 0, 1);
+
+static K_KERNEL_STACK_DEFINE(drain_stack,
+			     CONFIG_NET_CAPTURE_PCAPNG_STACK_SIZE);
+static struct k_thread drain_thread;
+
+static struct {
+	struct capture_filter filter;
+	struct net_capture_pcapng_stats stats;
+	struct net_if *iface;
+	net_capture_pcapng_write_cb_t write_cb;
+	void *user_data;
+#if defined(CONFIG_FILE_SYSTEM)
+	struct fs_file_t file;
+#endif
+	uint32_t snaplen;
+	/* Space reserved by the writers, committed once none is copying */
+	uint32_t reserved;
+	int writers;
+	int error;
+	uint16_t link_type;
+	bool is_enabled;
+	bool is_running;
+	bool stopping;
+} pcapng;
+
+static uint16_t get_link_type(struct net_if *iface)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		return CAPTURE_LINKTYPE_ETHERNET;
+	}
+#endif
+#if defined(CONFIG_NET_L2_IEEE802154)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(IEEE802154)) {
+		return CAPTURE_LINKTYPE_IEEE802_15_4_NOFCS;
+	}
+#endif
+
+	return CAPTURE_LINKTYPE_RAW;
+}
+
+/* Reserve len bytes of the ring buffer, with ring_lock held */
+static bool ring_reserve(struct ring_block *block, uint32_t len)
+{
+	int i;
+
+	if (ring_buf_space_get(&pcapng_ring) - pcapng.reserved < len) {
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(block->data); i++) {
+		block->len[i] = ring_buf_put_claim(&pcapng_ring,
+						   &block->data[i], len);
+		pcapng.reserved += block->len[i];
+		len -= block->len[i];
+	}
+
+	block->pos = 0U;
+
+	return true;
+}
+
+/* Unregister a writer, with ring_lock held. The reserved space is made
+ * visible to the reader when no writer is copying into it anymore.
+ */
+static void ring_release(void)
+{
+	if (--pcapng.writers > 0 || pcapng.reserved == 0U) {
+		return;
+	}
+
+	(void)ring_buf_put_finish(&pcapng_ring, pcapng.reserved);
+	pcapng.reserved = 0U;
+}
+
+/* Next contiguous part, of at most len bytes, of the reserved space */
+static uint32_t block_claim(struct ring_block *block, uint8_t **dst,
+			    uint32_t len)
+{
+	uint32_t pos = block->pos;
+	int i = 0;
+
+	if (pos >= block->len[0]) {
+		pos -= block->len[0];
+		i = 1;
+	}
+
+	*dst = block->data[i] + pos;
+	len = MIN(len, block->len[i] - pos);
+	block->pos += len;
+
+	return len;
+}
+
+static void ring_write(struct ring_block *block, const void *data,
+		       size_t len)
+{
+	const uint8_t *src = data;
+	uint32_t claimed;
+	uint8_t *dst;
+
+	while (len > 0) {
+		claimed = block_claim(block, &dst, len);
+		memcpy(dst, src, claimed);
+		src += claimed;
+		len -= claimed;
+	}
+}
+
+static void ring_write_pkt(struct ring_block *block, struct net_pkt *pkt,
+			   size_t len)
+{
+	size_t offset = 0;
+	uint32_t claimed;
+	uint8_t *dst;
+
+	while (offset < len) {
+		claimed = block_claim(block, &dst, len - offset);
+		net_buf_linearize(dst, claimed, pkt->buffer, offset, claimed);
+		offset += claimed;
+	}
+}
+
+void capture_pcapng_pkt(struct net_if *iface, struct net_pkt *pkt)
+{
+	static const uint8_t padding[sizeof(uint32_t)];
+	struct ring_block block;
+	struct pcapng_epb epb;
+	k_spinlock_key_t key;
+	uint32_t block_len;
+	bool drain = false;
+	size_t len;
+	uint64_t ts;
+
+	if (!pcapng.is_enabled || pcapng.iface != iface) {
+		return;
+	}
+
+	/* Registered writers keep the filter and the ring buffer from being
+	 * changed by a restart.
+	 */
+	key = k_spin_lock(&ring_lock);
+
+	if (!pcapng.is_enabled) {
+		k_spin_unlock(&ring_lock, key);
+		return;
+	}
+
+	pcapng.writers++;
+	k_spin_unlock(&ring_lock, key);
+
+	ts = k_ticks_to_us_floor64(k_uptime_ticks());
+
+	if (!capture_filter_match(&pcapng.filter, pcapng.link_type, pkt)) {
+		key = k_spin_lock(&ring_lock);
+		pcapng.stats.filtered++;
+		ring_release();
+		k_spin_unlock(&ring_lock, key);
+		return;
+	}
+
+	len = net_pkt_get_len(pkt);
+
+	epb.type = PCAPNG_BLOCK_EPB;
+	epb.iface_id = 0U;
+	epb.ts_high = ts >> 32;
+	epb.ts_low = (uint32_t)ts;
+	epb.orig_len = len;
+	epb.captured_len = MIN(len, pcapng.snaplen);
+
+	block_len = sizeof(epb) + ROUND_UP(epb.captured_len, sizeof(uint32_t)) +
+		    sizeof(block_len);
+	epb.len = block_len;
+
+	key = k_spin_lock(&ring_lock);
+
+	if (!ring_reserve(&block, block_len)) {
+		pcapng.stats.dropped++;
+		ring_release();
+		k_spin_unlock(&ring_lock, key);
+		k_sem_give(&drain_sem);
+		return;
+	}
+
+	k_spin_unlock(&ring_lock, key);
+
+	ring_write(&block, &epb, sizeof(epb));
+	ring_write_pkt(&block, pkt, epb.captured_len);
+	ring_write(&block, padding, block_len - sizeof(epb) -
+		   epb.captured_len - sizeof(block_len));
+	ring_write(&block, &block_len, sizeof(block_len));
+
+	key = k_spin_lock(&ring_lock);
+
+	pcapng.stats.captured++;
+	ring_release();
+
+	/* Wake up the writer before the buffer gets full */
+	drain = ring_buf_space_get(&pcapng_ring) <
+		CONFIG_NET_CAPTURE_PCAPNG_BUF_SIZE / 2;
+
+	k_spin_unlock(&ring_lock, key);
+
+	if (drain) {
+		k_sem_give(&drain_sem);
+	}
+}
+
+static int pcapng_write(const void *data, size_t len)
+{
+#if defined(CONFIG_FILE_SYSTEM)
+	ssize_t ret;
+#endif
+
+	if (pcapng.write_cb) {
+		return pcapng.write_cb(data, len, pcapng.user_data);
+	}
+
+#if defined(CONFIG_FILE_SYSTEM)
+	ret = fs_write(&pcapng.file, data, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return ret == len ? 0 : -ENOSPC;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static void pcapng_drain(void)
+{
+	uint32_t len;
+	uint8_t *data;
+	int ret;
+
+	while (true) {
+		len = ring_buf_get_claim(&pcapng_ring, &data,
+					 CONFIG_NET_CAPTURE_PCAPNG_BUF_SIZE);
+		if (len == 0U) {
+			break;
+		}
+
+		/* Keep draining after an error so that the writers only
+		 * count the packets as dropped.
+		 */
+		if (pcapng.error == 0) {
+			ret = pcapng_write(data, len);
+			if (ret < 0) {
+				NET_ERR("Cannot write capture (%d)", ret);
+				pcapng.error = ret;
+			}
+		}
+
+		ring_buf_get_finish(&pcapng_ring, len);
+	}
+}
+
+static void drain_thread_fn(void *p1, void *p2, void *p3)
+{
+	bool stopping;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	do {
+		(void)k_sem_take(&drain_sem, DRAIN_INTERVAL);
+
+		stopping = pcapng.stopping;
+		pcapng_drain();
+	} while (!stopping);
+}
+
+static int pcapng_open(const struct net_capture_pcapng_params *params)
+{
+#if defined(CONFIG_FILE_SYSTEM)
+	int ret;
+#endif
+
+	if (params->write_cb) {
+		pcapng.write_cb = params->write_cb;
+		pcapng.user_data = params->user_data;
+		return 0;
+	}
+
+	pcapng.write_cb = NULL;
+
+	if (params->path == NULL) {
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_FILE_SYSTEM)
+	fs_file_t_init(&pcapng.file);
+
+	ret = fs_open(&pcapng.file, params->path, FS_O_CREATE | FS_O_WRITE);
+	if (ret < 0) {
+		NET_ERR("Cannot open %s (%d)", log_strdup(params->path), ret);
+		return ret;
+	}
+
+	ret = fs_truncate(&pcapng.file, 0);
+	if (ret < 0) {
+		(void)fs_close(&pcapng.file);
+		return ret;
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int pcapng_close(void)
+{
+#if defined(CONFIG_FILE_SYSTEM)
+	if (pcapng.write_cb == NULL) {
+		return fs_close(&pcapng.file);
+	}
+#endif
+
+	return 0;
+}
+
+int net_capture_pcapng_start(struct net_if *iface,
+			     const struct net_capture_pcapng_params *params)
+{
+	struct pcapng_shb shb = {
+		.type = PCAPNG_BLOCK_SHB,
+		.len = sizeof(shb),
+		.magic = PCAPNG_BYTE_ORDER_MAGIC,
+		.major = 1U,
+		.minor = 0U,
+		.section_len = -1,
+		.trailer_len = sizeof(shb),
+	};
+	struct pcapng_idb idb = {
+		.type = PCAPNG_BLOCK_IDB,
+		.len = sizeof(idb),
+		.trailer_len = sizeof(idb),
+	};
+	k_spinlock_key_t key;
+	k_tid_t tid;
+	int ret;
+
+	if (iface == NULL || params == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&pcapng_lock, K_FOREVER);
+
+	if (pcapng.is_running) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	ret = capture_filter_compile(&pcapng.filter, params->filter);
+	if (ret < 0) {
+		goto out;
+	}
+
+	ret = pcapng_open(params);
+	if (ret < 0) {
+		goto out;
+	}
+
+	memset(&pcapng.stats, 0, sizeof(pcapng.stats));
+	pcapng.snaplen = params->snaplen ? params->snaplen : UINT32_MAX;
+	pcapng.link_type = get_link_type(iface);
+	pcapng.error = 0;
+	pcapng.stopping = false;
+	pcapng.is_running = true;
+
+	/* Nothing writes to the ring buffer before the capture is enabled */
+	ring_buf_reset(&pcapng_ring);
+
+	idb.link_type = pcapng.link_type;
+	idb.snaplen = params->snaplen;
+
+	ring_buf_put(&pcapng_ring, (uint8_t *)&shb, sizeof(shb));
+	ring_buf_put(&pcapng_ring, (uint8_t *)&idb, sizeof(idb));
+
+	tid = k_thread_create(&drain_thread, drain_stack,
+			      K_KERNEL_STACK_SIZEOF(drain_stack),
+			      drain_thread_fn, NULL, NULL, NULL,
+			      CONFIG_NET_CAPTURE_PCAPNG_THREAD_PRIO, 0,
+			      K_NO_WAIT);
+	k_thread_name_set(tid, "net_capture");
+
+	key = k_spin_lock(&ring_lock);
+	pcapng.iface = iface;
+	pcapng.is_enabled = true;
+	k_spin_unlock(&ring_lock, key);
+
+out:
+	k_mutex_unlock(&pcapng_lock);
+
+	return ret;
+}
+
+int net_capture_pcapng_stop(void)
+{
+	k_spinlock_key_t key;
+	bool busy;
+	int ret;
+
+	k_mutex_lock(&pcapng_lock, K_FOREVER);
+
+	if (!pcapng.is_running) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	key = k_spin_lock(&ring_lock);
+	pcapng.is_enabled = false;
+	k_spin_unlock(&ring_lock, key);
+
+	/* Wait for the writers registered before, after this none is
+	 * using the filter or copying a packet to the ring buffer.
+	 */
+	while (true) {
+		key = k_spin_lock(&ring_lock);
+		busy = pcapng.writers > 0;
+		k_spin_unlock(&ring_lock, key);
+
+		if (!busy) {
+			break;
+		}
+
+		k_msleep(1);
+	}
+
+	pcapng.stopping = true;
+	k_sem_give(&drain_sem);
+	(void)k_thread_join(&drain_thread, K_FOREVER);
+
+	ret = pcapng_close();
+	if (pcapng.error < 0) {
+		ret = pcapng.error;
+	}
+
+	pcapng.iface = NULL;
+	pcapng.is_running = false;
+
+out:
+	k_mutex_unlock(&pcapng_lock);
+
+	return ret;
+}
+
+int net_capture_pcapng_stats_get(struct net_capture_pcapng_stats *stats)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&ring_lock);
+	*stats = pcapng.stats;
+	k_spin_unlock(&ring_lock, key);
+
+	return 0;
+}
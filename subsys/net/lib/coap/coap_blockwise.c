@@ -0,0 +1,967 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_coap, CONFIG_COAP_LOG_LEVEL);
+
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <zephyr.h>
+#include <sys/byteorder.h>
+#include <sys/util.h>
+
+#include <net/net_core.h>
+#include <net/coap.h>
+#include <net/coap_blockwise.h>
+
+enum block_state {
+	BLOCK_FREE,
+	/* Last block of an upload, waiting for the other blocks to be
+	 * acknowledged before being sent.
+	 */
+	BLOCK_HELD,
+	BLOCK_SENT,
+	/* Request acknowledged, the response comes separately */
+	BLOCK_ACKED,
+	BLOCK_RECEIVED,
+};
+
+#define RESPONSE_CLASS(code) ((code) >> 5)
+
+/* Block number goes in the token after the random part */
+#define TOKEN_LEN (sizeof(((struct coap_blockwise_client *)0)->token) + \
+		   sizeof(uint32_t))
+
+static const struct sockaddr no_addr;
+
+static inline unsigned int block_value(uint32_t num, bool more,
+				       enum coap_block_size block_size)
+{
+	return (num << 4) | (more ? 0x08 : 0x00) | (block_size & 0x07);
+}
+
+static inline enum coap_block_size max_block_size(void)
+{
+	enum coap_block_size block_size = COAP_BLOCK_1024;
+
+	while (coap_block_size_to_bytes(block_size) >
+	       CONFIG_COAP_BLOCKWISE_MAX_BLOCK_SIZE) {
+		block_size--;
+	}
+
+	return block_size;
+}
+
+/* Read a block from the source at the end of the buffer of cpkt, and keep
+ * the options appended until append_block_payload() from overwriting it.
+ */
+static int read_block(struct coap_packet *cpkt, size_t offset,
+		      uint16_t bytes, coap_blockwise_source_t source,
+		      void *user_data, bool *last, uint8_t **payload)
+{
+	int len;
+
+	/* Room for the payload marker too */
+	if (cpkt->max_len - cpkt->offset < bytes + 1) {
+		return -ENOMEM;
+	}
+
+	*payload = cpkt->data + cpkt->max_len - bytes;
+	*last = false;
+
+	len = source(offset, *payload, bytes, last, user_data);
+	if (len < 0) {
+		return len;
+	}
+
+	/* Only the last block may be shorter than the block size */
+	if (len > bytes || (len < bytes && !*last)) {
+		return -EIO;
+	}
+
+	cpkt->max_len -= bytes + 1;
+
+	return len;
+}
+
+static int append_block_payload(struct coap_packet *cpkt,
+				const uint8_t *payload, uint16_t bytes,
+				uint16_t len)
+{
+	int ret;
+
+	cpkt->max_len += bytes + 1;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	ret = coap_packet_append_payload_marker(cpkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memmove(cpkt->data + cpkt->offset, payload, len);
+	cpkt->offset += len;
+
+	return 0;
+}
+
+static int response_init(struct coap_packet *response,
+			 const struct coap_packet *request,
+			 uint8_t *data, uint16_t max_len, uint8_t code)
+{
+	uint8_t token[COAP_TOKEN_MAX_LEN];
+	uint8_t tkl;
+
+	if (coap_header_get_type(request) == COAP_TYPE_CON) {
+		return coap_ack_init(response, request, data, max_len, code);
+	}
+
+	tkl = coap_header_get_token(request, token);
+
+	return coap_packet_init(response, data, max_len, COAP_VERSION_1,
+				COAP_TYPE_NON_CON, tkl, token, code,
+				coap_next_id());
+}
+
+static struct coap_blockwise_block *client_find_block(
+	struct coap_blockwise_client *client, uint32_t num, uint8_t state)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+		if (client->blocks[i].state == state &&
+		    (state == BLOCK_FREE || client->blocks[i].num == num)) {
+			return &client->blocks[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void client_finish(struct coap_blockwise_client *client, int status)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+		coap_pending_clear(&client->blocks[i].pending);
+		client->blocks[i].state = BLOCK_FREE;
+	}
+
+	client->status = status;
+
+	NET_DBG("Block-wise transfer done (%d), %u blocks", status,
+		client->deliver_num);
+}
+
+static int client_transmit(struct coap_blockwise_client *client,
+			   struct coap_blockwise_block *block)
+{
+	block->state = BLOCK_SENT;
+	block->pending.t0 = k_uptime_get_32();
+	block->pending.timeout = 0U;
+	(void)coap_pending_cycle(&block->pending);
+
+	return client->send(block->buf, block->pending.len, client->user_data);
+}
+
+static int client_send_request(struct coap_blockwise_client *client,
+			       struct coap_blockwise_block *block,
+			       uint32_t num)
+{
+	uint16_t bytes = coap_block_size_to_bytes(client->block_size);
+	uint8_t token[TOKEN_LEN];
+	const char * const *path;
+	struct coap_packet cpkt;
+	uint8_t *payload = NULL;
+	bool last = false;
+	int len = 0;
+	int ret;
+
+	memcpy(token, client->token, sizeof(client->token));
+	sys_put_be32(num, &token[sizeof(client->token)]);
+
+	ret = coap_packet_init(&cpkt, block->buf, sizeof(block->buf),
+			       COAP_VERSION_1, COAP_TYPE_CON, sizeof(token),
+			       token, client->method, coap_next_id());
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (client->source) {
+		len = read_block(&cpkt, (size_t)num * bytes, bytes,
+				 client->source, client->user_data, &last,
+				 &payload);
+		if (len < 0) {
+			return len;
+		}
+	}
+
+	for (path = client->path; *path; path++) {
+		ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH,
+						(const uint8_t *)*path,
+						strlen(*path));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (client->source) {
+		ret = coap_append_option_int(&cpkt, COAP_OPTION_BLOCK1,
+					     block_value(num, !last,
+							 client->block_size));
+		if (ret == 0) {
+			ret = append_block_payload(&cpkt, payload, bytes, len);
+		}
+	} else {
+		ret = coap_append_option_int(&cpkt, COAP_OPTION_BLOCK2,
+					     block_value(num, false,
+							 client->block_size));
+		if (ret == 0 && num == 0U) {
+			/* Ask for the size of the body, RFC 7959 section 4 */
+			ret = coap_append_option_int(&cpkt, COAP_OPTION_SIZE2,
+						     0);
+		}
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	block->num = num;
+	block->len = len;
+	block->last = last;
+
+	(void)coap_pending_init(&block->pending, &cpkt, &no_addr,
+				COAP_DEFAULT_MAX_RETRANSMIT);
+
+	if (last) {
+		client->end_num = num + 1;
+
+		if (num != client->deliver_num) {
+			block->state = BLOCK_HELD;
+			return 0;
+		}
+	}
+
+	return client_transmit(client, block);
+}
+
+/* Keep up to window requests in flight. Only the first block is requested
+ * until it is answered, as the server may ask for a smaller block size and
+ * tell the size of the body in its response.
+ */
+static int client_fill_window(struct coap_blockwise_client *client)
+{
+	struct coap_blockwise_block *block;
+	uint8_t in_flight = 0U;
+	uint8_t window;
+	int ret;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+		block = &client->blocks[i];
+
+		if (block->state == BLOCK_FREE) {
+			continue;
+		}
+
+		if (block->state == BLOCK_HELD &&
+		    block->num == client->deliver_num) {
+			ret = client_transmit(client, block);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		in_flight++;
+	}
+
+	window = client->deliver_num == 0U ? 1U : client->window;
+
+	while (in_flight < window && client->next_num < client->end_num) {
+		block = client_find_block(client, 0, BLOCK_FREE);
+		if (!block) {
+			break;
+		}
+
+		ret = client_send_request(client, block, client->next_num);
+		if (ret < 0) {
+			return ret;
+		}
+
+		client->next_num++;
+		in_flight++;
+	}
+
+	return 0;
+}
+
+/* Give the blocks received in order to the sink and request more */
+static int client_advance(struct coap_blockwise_client *client)
+{
+	uint16_t bytes = coap_block_size_to_bytes(client->block_size);
+	struct coap_blockwise_block *block;
+	bool last;
+	int ret;
+	int i;
+
+	while ((block = client_find_block(client, client->deliver_num,
+					  BLOCK_RECEIVED))) {
+		if (client->sink) {
+			ret = client->sink((size_t)block->num * bytes,
+					   block->buf, block->len, block->last,
+					   client->user_data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		last = block->last;
+		block->state = BLOCK_FREE;
+		client->deliver_num++;
+
+		if (last) {
+			client_finish(client, 0);
+			return 0;
+		}
+	}
+
+	/* The server told the body ends before a block that was not the
+	 * last one received.
+	 */
+	if (client->deliver_num >= client->end_num) {
+		return -EIO;
+	}
+
+	/* Drop the requests past the end of the body */
+	for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+		block = &client->blocks[i];
+
+		if (block->state != BLOCK_FREE &&
+		    block->num >= client->end_num) {
+			coap_pending_clear(&block->pending);
+			block->state = BLOCK_FREE;
+		}
+	}
+
+	return client_fill_window(client);
+}
+
+static int client_get_response(struct coap_blockwise_client *client,
+			       struct coap_blockwise_block *block,
+			       const struct coap_packet *response,
+			       uint8_t code)
+{
+	uint16_t bytes = coap_block_size_to_bytes(client->block_size);
+	const uint8_t *payload;
+	uint16_t len;
+	int block2, size2;
+	bool more;
+
+	/* Request past the end of the body of unknown size */
+	if (code == COAP_RESPONSE_CODE_BAD_OPTION && block->num > 0U) {
+		client->end_num = MIN(client->end_num, block->num);
+		block->state = BLOCK_FREE;
+		return 0;
+	}
+
+	if (RESPONSE_CLASS(code) != 2) {
+		NET_DBG("Block %u failed with code %u.%02u", block->num,
+			RESPONSE_CLASS(code), code & 0x1f);
+		return -EIO;
+	}
+
+	payload = coap_packet_get_payload(response, &len);
+
+	block2 = coap_get_option_int(response, COAP_OPTION_BLOCK2);
+	if (block2 < 0) {
+		/* Whole body in a single response */
+		if (block->num > 0U) {
+			return -EIO;
+		}
+
+		block2 = block_value(0, false, client->block_size);
+		bytes = len;
+	}
+
+	if (GET_BLOCK_NUM(block2) != block->num) {
+		return -EIO;
+	}
+
+	if (GET_BLOCK_SIZE(block2) != client->block_size) {
+		/* Only the first block may change the block size, and only
+		 * to a smaller one.
+		 */
+		if (block->num > 0U ||
+		    GET_BLOCK_SIZE(block2) > client->block_size) {
+			return -EIO;
+		}
+
+		client->block_size = GET_BLOCK_SIZE(block2);
+		bytes = coap_block_size_to_bytes(client->block_size);
+	}
+
+	more = GET_MORE(block2);
+	if (len > bytes || (more && len < bytes) ||
+	    len > CONFIG_COAP_BLOCKWISE_MAX_BLOCK_SIZE) {
+		return -EMSGSIZE;
+	}
+
+	size2 = coap_get_option_int(response, COAP_OPTION_SIZE2);
+	if (size2 > 0 && bytes > 0U) {
+		client->end_num = MIN(client->end_num,
+				      ceiling_fraction((uint32_t)size2, bytes));
+	}
+
+	if (!more) {
+		client->end_num = block->num + 1;
+	} else if (block->num + 1 >= client->end_num) {
+		return -EIO;
+	}
+
+	if (len > 0U) {
+		memcpy(block->buf, payload, len);
+	}
+
+	block->len = len;
+	block->last = !more;
+	block->state = BLOCK_RECEIVED;
+
+	return 0;
+}
+
+static int client_put_response(struct coap_blockwise_client *client,
+			       struct coap_blockwise_block *block,
+			       const struct coap_packet *response,
+			       uint8_t code)
+{
+	int block1;
+
+	if (RESPONSE_CLASS(code) != 2) {
+		NET_DBG("Block %u failed with code %u.%02u", block->num,
+			RESPONSE_CLASS(code), code & 0x1f);
+		return -EIO;
+	}
+
+	block1 = coap_get_option_int(response, COAP_OPTION_BLOCK1);
+	if (block1 >= 0 && GET_BLOCK_SIZE(block1) < client->block_size) {
+		/* The server took only the first block of its size */
+		if (block->num > 0U) {
+			return -EIO;
+		}
+
+		client->block_size = GET_BLOCK_SIZE(block1);
+
+		if (block->len > coap_block_size_to_bytes(client->block_size)) {
+			client->end_num = UINT32_MAX;
+			block->last = false;
+		}
+	}
+
+	block->state = BLOCK_RECEIVED;
+
+	return 0;
+}
+
+static int client_start(struct coap_blockwise_client *client)
+{
+	int ret;
+
+	memset(client->blocks, 0, sizeof(client->blocks));
+	memcpy(client->token, coap_next_token(), sizeof(client->token));
+
+	client->next_num = 0U;
+	client->deliver_num = 0U;
+	client->end_num = UINT32_MAX;
+	client->status = -EINPROGRESS;
+
+	ret = client_fill_window(client);
+	if (ret < 0) {
+		client_finish(client, ret);
+	}
+
+	return ret;
+}
+
+int coap_blockwise_client_init(struct coap_blockwise_client *client,
+			       const char * const *path,
+			       enum coap_block_size block_size,
+			       uint8_t window, coap_blockwise_send_t send,
+			       void *user_data)
+{
+	if (!client || !path || !send || window == 0U ||
+	    window > CONFIG_COAP_BLOCKWISE_WINDOW ||
+	    block_size > max_block_size()) {
+		return -EINVAL;
+	}
+
+	memset(client, 0, sizeof(*client));
+
+	client->path = path;
+	client->block_size = block_size;
+	client->window = window;
+	client->send = send;
+	client->user_data = user_data;
+
+	return 0;
+}
+
+int coap_blockwise_client_get(struct coap_blockwise_client *client,
+			      coap_blockwise_sink_t sink)
+{
+	if (!sink || client->status == -EINPROGRESS) {
+		return -EINVAL;
+	}
+
+	client->method = COAP_METHOD_GET;
+	client->sink = sink;
+	client->source = NULL;
+
+	return client_start(client);
+}
+
+int coap_blockwise_client_put(struct coap_blockwise_client *client,
+			      uint8_t method, coap_blockwise_source_t source)
+{
+	if (!source || client->status == -EINPROGRESS ||
+	    (method != COAP_METHOD_PUT && method != COAP_METHOD_POST)) {
+		return -EINVAL;
+	}
+
+	client->method = method;
+	client->sink = NULL;
+	client->source = source;
+
+	return client_start(client);
+}
+
+int coap_blockwise_client_input(struct coap_blockwise_client *client,
+				uint8_t *data, uint16_t len)
+{
+	struct coap_blockwise_block *block = NULL;
+	uint8_t token[COAP_TOKEN_MAX_LEN];
+	struct coap_packet response;
+	uint8_t type, code;
+	uint32_t num;
+	uint16_t id;
+	int ret;
+	int i;
+
+	ret = coap_packet_parse(&response, data, len, NULL, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (client->status != -EINPROGRESS) {
+		return -ENOENT;
+	}
+
+	type = coap_header_get_type(&response);
+	code = coap_header_get_code(&response);
+
+	if (code == COAP_CODE_EMPTY) {
+		id = coap_header_get_id(&response);
+
+		for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+			if (client->blocks[i].state == BLOCK_SENT &&
+			    client->blocks[i].pending.id == id) {
+				block = &client->blocks[i];
+				break;
+			}
+		}
+
+		if (!block) {
+			return -ENOENT;
+		}
+
+		if (type == COAP_TYPE_RESET) {
+			client_finish(client, -ECONNRESET);
+			return 0;
+		}
+
+		/* Separate response follows, stop retransmitting */
+		coap_pending_clear(&block->pending);
+		block->state = BLOCK_ACKED;
+
+		return 0;
+	}
+
+	if (coap_header_get_token(&response, token) != TOKEN_LEN ||
+	    memcmp(token, client->token, sizeof(client->token)) != 0) {
+		return -ENOENT;
+	}
+
+	if (type == COAP_TYPE_CON) {
+		struct coap_packet ack;
+		uint8_t buf[4];
+
+		ret = coap_ack_init(&ack, &response, buf, sizeof(buf),
+				    COAP_CODE_EMPTY);
+		if (ret == 0) {
+			(void)client->send(ack.data, ack.offset,
+					   client->user_data);
+		}
+	}
+
+	num = sys_get_be32(&token[sizeof(client->token)]);
+
+	block = client_find_block(client, num, BLOCK_SENT);
+	if (!block) {
+		block = client_find_block(client, num, BLOCK_ACKED);
+	}
+
+	/* Duplicate response */
+	if (!block) {
+		return 0;
+	}
+
+	coap_pending_clear(&block->pending);
+
+	if (client->source) {
+		ret = client_put_response(client, block, &response, code);
+	} else {
+		ret = client_get_response(client, block, &response, code);
+	}
+
+	if (ret == 0) {
+		ret = client_advance(client);
+	}
+
+	if (ret < 0) {
+		client_finish(client, ret);
+	}
+
+	return 0;
+}
+
+int32_t coap_blockwise_client_process(struct coap_blockwise_client *client)
+{
+	struct coap_blockwise_block *block;
+	uint32_t now = k_uptime_get_32();
+	int32_t next = SYS_FOREVER_MS;
+	int32_t remaining;
+	int ret;
+	int i;
+
+	if (client->status != -EINPROGRESS) {
+		return SYS_FOREVER_MS;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(client->blocks); i++) {
+		block = &client->blocks[i];
+
+		if (block->state != BLOCK_SENT) {
+			continue;
+		}
+
+		remaining = (int32_t)(block->pending.t0 +
+				      block->pending.timeout - now);
+		if (remaining <= 0) {
+			if (!coap_pending_cycle(&block->pending)) {
+				NET_DBG("Block %u timed out", block->num);
+				client_finish(client, -ETIMEDOUT);
+				return SYS_FOREVER_MS;
+			}
+
+			ret = client->send(block->buf, block->pending.len,
+					   client->user_data);
+			if (ret < 0) {
+				client_finish(client, ret);
+				return SYS_FOREVER_MS;
+			}
+
+			remaining = MAX(0, (int32_t)(block->pending.t0 +
+						     block->pending.timeout -
+						     now));
+		}
+
+		if (next == SYS_FOREVER_MS || remaining < next) {
+			next = remaining;
+		}
+	}
+
+	return next;
+}
+
+void coap_blockwise_client_cancel(struct coap_blockwise_client *client)
+{
+	if (client->status == -EINPROGRESS) {
+		client_finish(client, -ECANCELED);
+	}
+}
+
+int coap_blockwise_server_get(const struct coap_packet *request,
+			      struct coap_packet *response,
+			      uint8_t *data, uint16_t max_len,
+			      enum coap_block_size max_size,
+			      size_t total_size,
+			      coap_blockwise_source_t source,
+			      void *user_data)
+{
+	enum coap_block_size block_size = MIN(max_size, max_block_size());
+	uint8_t *payload;
+	size_t offset = 0;
+	uint16_t bytes;
+	uint32_t num;
+	bool last;
+	int block2;
+	int len;
+	int ret;
+
+	block2 = coap_get_option_int(request, COAP_OPTION_BLOCK2);
+	if (block2 >= 0) {
+		offset = (size_t)GET_BLOCK_NUM(block2) *
+			 coap_block_size_to_bytes(GET_BLOCK_SIZE(block2));
+		block_size = MIN(block_size, GET_BLOCK_SIZE(block2));
+	}
+
+	bytes = coap_block_size_to_bytes(block_size);
+	num = offset / bytes;
+
+	if (total_size > 0 && offset >= total_size) {
+		return response_init(response, request, data, max_len,
+				     COAP_RESPONSE_CODE_BAD_OPTION);
+	}
+
+	ret = response_init(response, request, data, max_len,
+			    COAP_RESPONSE_CODE_CONTENT);
+	if (ret < 0) {
+		return ret;
+	}
+
+	len = read_block(response, offset, bytes, source, user_data, &last,
+			 &payload);
+	if (len < 0) {
+		return len;
+	}
+
+	if (total_size > 0 && offset + len >= total_size) {
+		last = true;
+	}
+
+	ret = coap_append_option_int(response, COAP_OPTION_BLOCK2,
+				     block_value(num, !last, block_size));
+	if (ret == 0 && total_size > 0) {
+		ret = coap_append_option_int(response, COAP_OPTION_SIZE2,
+					     total_size);
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	return append_block_payload(response, payload, bytes, len);
+}
+
+void coap_blockwise_server_init(struct coap_blockwise_server *server,
+				coap_blockwise_sink_t sink, void *user_data)
+{
+	memset(server, 0, sizeof(*server));
+
+	server->sink = sink;
+	server->user_data = user_data;
+}
+
+/* Give the blocks held by the server in order to the sink */
+static int server_flush(struct coap_blockwise_server *server)
+{
+	uint16_t bytes = coap_block_size_to_bytes(server->block_size);
+	bool found;
+	int ret;
+	int i;
+
+	do {
+		found = false;
+
+		for (i = 0; i < ARRAY_SIZE(server->blocks); i++) {
+			if (!server->blocks[i].used ||
+			    server->blocks[i].num != server->deliver_num) {
+				continue;
+			}
+
+			ret = server->sink((size_t)server->deliver_num * bytes,
+					   server->blocks[i].data,
+					   server->blocks[i].len, false,
+					   server->user_data);
+			if (ret < 0) {
+				return ret;
+			}
+
+			server->blocks[i].used = false;
+			server->deliver_num++;
+			found = true;
+		}
+	} while (found);
+
+	return 0;
+}
+
+static int server_hold(struct coap_blockwise_server *server, uint32_t num,
+		       const uint8_t *payload, uint16_t len)
+{
+	int i, free_idx = -1;
+
+	for (i = 0; i < ARRAY_SIZE(server->blocks); i++) {
+		if (!server->blocks[i].used) {
+			free_idx = i;
+		} else if (server->blocks[i].num == num) {
+			/* Retransmission of a block already held */
+			return 0;
+		}
+	}
+
+	if (free_idx < 0) {
+		return -ENOMEM;
+	}
+
+	server->blocks[free_idx].num = num;
+	server->blocks[free_idx].len = len;
+	server->blocks[free_idx].used = true;
+	memcpy(server->blocks[free_idx].data, payload, len);
+
+	return 0;
+}
+
+static int server_block(struct coap_blockwise_server *server,
+			const struct coap_packet *request, int block1,
+			bool *more)
+{
+	uint32_t num = GET_BLOCK_NUM(block1);
+	enum coap_block_size block_size = GET_BLOCK_SIZE(block1);
+	uint16_t id = coap_header_get_id(request);
+	const uint8_t *payload;
+	uint16_t bytes;
+	uint16_t len;
+	int ret;
+	int i;
+
+	payload = coap_packet_get_payload(request, &len);
+
+	*more = GET_MORE(block1);
+
+	if (num == 0U && (!server->active || server->block0_id != id)) {
+		for (i = 0; i < ARRAY_SIZE(server->blocks); i++) {
+			server->blocks[i].used = false;
+		}
+
+		server->active = true;
+		server->deliver_num = 0U;
+		server->block0_id = id;
+		server->block_size = MIN(block_size, max_block_size());
+	}
+
+	if (!server->active) {
+		return -EINVAL;
+	}
+
+	bytes = coap_block_size_to_bytes(server->block_size);
+
+	if (num == 0U && block_size > server->block_size) {
+		/* Take the first block of our size, the client continues
+		 * with the block size of the response.
+		 */
+		if (len > bytes) {
+			len = bytes;
+			*more = true;
+		}
+	} else if (block_size != server->block_size) {
+		return -EINVAL;
+	}
+
+	if (num < server->deliver_num) {
+		/* Retransmission of a block already given to the sink */
+		return 0;
+	}
+
+	if (num >= server->deliver_num + ARRAY_SIZE(server->blocks) ||
+	    (*more && len != bytes) || len > bytes) {
+		return -EINVAL;
+	}
+
+	if (num != server->deliver_num) {
+		/* The last block is sent once the others were acknowledged */
+		if (!*more) {
+			return -EINVAL;
+		}
+
+		return server_hold(server, num, payload, len);
+	}
+
+	ret = server->sink((size_t)num * bytes, payload, len, !*more,
+			   server->user_data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	server->deliver_num++;
+
+	if (!*more) {
+		return 1;
+	}
+
+	return server_flush(server);
+}
+
+int coap_blockwise_server_put(struct coap_blockwise_server *server,
+			      const struct coap_packet *request,
+			      struct coap_packet *response,
+			      uint8_t *data, uint16_t max_len, uint8_t code)
+{
+	const uint8_t *payload;
+	uint8_t resp_code;
+	uint16_t len;
+	bool more;
+	int block1;
+	int status;
+	int ret;
+
+	block1 = coap_get_option_int(request, COAP_OPTION_BLOCK1);
+	if (block1 < 0) {
+		/* Whole body in a single request */
+		server->active = false;
+		payload = coap_packet_get_payload(request, &len);
+
+		status = server->sink(0, payload, len, true, server->user_data);
+
+		ret = response_init(response, request, data, max_len,
+				    status < 0 ?
+				    COAP_RESPONSE_CODE_INTERNAL_ERROR : code);
+
+		return status < 0 ? status : (ret < 0 ? ret : 1);
+	}
+
+	status = server_block(server, request, block1, &more);
+	if (status == -EINVAL || status == -ENOMEM) {
+		resp_code = COAP_RESPONSE_CODE_INCOMPLETE;
+	} else if (status < 0) {
+		server->active = false;
+		resp_code = COAP_RESPONSE_CODE_INTERNAL_ERROR;
+	} else {
+		resp_code = more ? COAP_RESPONSE_CODE_CONTINUE : code;
+	}
+
+	ret = response_init(response, request, data, max_len, resp_code);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (status >= 0) {
+		ret = coap_append_option_int(response, COAP_OPTION_BLOCK1,
+					     block_value(GET_BLOCK_NUM(block1),
+							 false,
+							 server->block_size));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return status;
+}
@@ -0,0 +1,255 @@
+/** @file
+ * @brief DNS response cache
+ *
+ * Remembers the addresses, and the non-existent names, received from
+ * DNS servers until their TTL expires.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include <net/net_ip.h>
+#include <net/dns_resolve.h>
+
+#include "dns_cache.h"
+
+struct dns_cache_entry {
+	/** Resolved addresses, none if the name does not exist */
+	struct sockaddr addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+
+	/** Uptime in milliseconds when the entry expires */
+	int64_t expires;
+
+	/** Query type (A or AAAA) */
+	enum dns_query_type type;
+
+	/** Number of addresses */
+	uint8_t addr_count;
+
+	/** Resolved name */
+	char query[CONFIG_DNS_RESOLVER_CACHE_MAX_NAME_LEN + 1];
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES];
+static struct dns_resolve_cache_stats dns_cache_stats;
+static K_MUTEX_DEFINE(dns_cache_lock);
+
+static inline bool entry_matches(struct dns_cache_entry *entry,
+				 const char *query,
+				 enum dns_query_type type,
+				 int64_t now)
+{
+	/* DNS names are case insensitive, RFC 4343 */
+	return entry->expires > now && entry->type == type &&
+		strncasecmp(entry->query, query, sizeof(entry->query)) == 0;
+}
+
+/* Must be invoked with cache lock held */
+static struct dns_cache_entry *cache_find(const char *query,
+					  enum dns_query_type type,
+					  int64_t now)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (entry_matches(&dns_cache[i], query, type, now)) {
+			return &dns_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Return the entry of the name, or take an expired entry or the one that
+ * expires first for it. Must be invoked with cache lock held.
+ */
+static struct dns_cache_entry *cache_get(const char *query,
+					 enum dns_query_type type,
+					 int64_t now)
+{
+	struct dns_cache_entry *entry = NULL;
+	size_t len = strlen(query);
+	int i;
+
+	if (len >= sizeof(dns_cache[0].query)) {
+		NET_DBG("Name %s too long to be cached", log_strdup(query));
+		return NULL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (entry_matches(&dns_cache[i], query, type, now)) {
+			return &dns_cache[i];
+		}
+
+		if (!entry || dns_cache[i].expires < entry->expires) {
+			entry = &dns_cache[i];
+		}
+	}
+
+	if (entry->expires > now) {
+		NET_DBG("Evicting %s from DNS cache",
+			log_strdup(entry->query));
+		dns_cache_stats.evictions++;
+	}
+
+	memcpy(entry->query, query, len + 1);
+	entry->type = type;
+	entry->addr_count = 0U;
+
+	return entry;
+}
+
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   struct sockaddr *addr, int max)
+{
+	struct dns_cache_entry *entry;
+	int count;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	entry = cache_find(query, type, k_uptime_get());
+	if (!entry) {
+		dns_cache_stats.misses++;
+		count = -ENOENT;
+		goto out;
+	}
+
+	if (entry->addr_count == 0U) {
+		dns_cache_stats.negative_hits++;
+		count = 0;
+		goto out;
+	}
+
+	dns_cache_stats.hits++;
+
+	count = MIN(entry->addr_count, max);
+	memcpy(addr, entry->addr, count * sizeof(struct sockaddr));
+
+out:
+	k_mutex_unlock(&dns_cache_lock);
+
+	return count;
+}
+
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct sockaddr *addr, uint32_t ttl, bool first)
+{
+	int64_t now = k_uptime_get();
+	int64_t expires = now + (int64_t)ttl * MSEC_PER_SEC;
+	struct dns_cache_entry *entry;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	/* The rest of the addresses are only cached if the first one of
+	 * the response was.
+	 */
+	if (first && ttl > 0) {
+		entry = cache_get(query, type, now);
+		if (entry) {
+			entry->addr_count = 0U;
+			entry->expires = expires;
+		}
+	} else {
+		entry = cache_find(query, type, now);
+		if (entry) {
+			entry->expires = MIN(entry->expires, expires);
+		}
+	}
+
+	if (!entry || entry->expires <= now) {
+		goto out;
+	}
+
+	if (entry->addr_count < ARRAY_SIZE(entry->addr)) {
+		memcpy(&entry->addr[entry->addr_count++], addr,
+		       sizeof(struct sockaddr));
+	}
+
+out:
+	k_mutex_unlock(&dns_cache_lock);
+}
+
+void dns_cache_add_negative(const char *query, enum dns_query_type type,
+			    uint32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	int64_t now;
+
+	ttl = MIN(ttl, CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL_MAX);
+	if (ttl == 0U) {
+		return;
+	}
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	entry = cache_get(query, type, now);
+	if (entry) {
+		entry->addr_count = 0U;
+		entry->expires = now + (int64_t)ttl * MSEC_PER_SEC;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+}
+
+int dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data)
+{
+	struct dns_resolve_cache_info info;
+	int64_t now;
+	int i, count = 0;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (dns_cache[i].expires <= now) {
+			continue;
+		}
+
+		info.query = dns_cache[i].query;
+		info.query_type = dns_cache[i].type;
+		info.addr_count = dns_cache[i].addr_count;
+		info.addr = info.addr_count ? dns_cache[i].addr : NULL;
+		info.remaining = dns_cache[i].expires - now;
+
+		cb(&info, user_data);
+		count++;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	return count;
+}
+
+void dns_resolve_cache_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		dns_cache[i].expires = 0;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+}
+
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats)
+{
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+	memcpy(stats, &dns_cache_stats, sizeof(*stats));
+	k_mutex_unlock(&dns_cache_lock);
+}
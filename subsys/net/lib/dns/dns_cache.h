@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DNS_CACHE_H_
+#define DNS_CACHE_H_
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+#include <net/net_ip.h>
+#include <net/dns_resolve.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @brief Look up a name from the DNS cache
+ *
+ * @param query Name to resolve
+ * @param type Query type (A or AAAA)
+ * @param addr Cached addresses are copied here
+ * @param max Number of addresses that fit in addr
+ *
+ * @retval >0 Number of addresses copied to addr
+ * @retval 0 if the name is known not to exist
+ * @retval -ENOENT if the name is not in the cache
+ */
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   struct sockaddr *addr, int max);
+
+/**
+ * @brief Add a resolved address to the DNS cache
+ *
+ * @param query Name that was resolved
+ * @param type Query type (A or AAAA)
+ * @param addr Resolved address
+ * @param ttl TTL of the address in seconds
+ * @param first Set for the first address of a response, this replaces
+ *        the earlier addresses of the name.
+ */
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct sockaddr *addr, uint32_t ttl, bool first);
+
+/**
+ * @brief Remember that a name does not exist
+ *
+ * @param query Name that was queried
+ * @param type Query type (A or AAAA)
+ * @param ttl Negative caching TTL in seconds
+ */
+void dns_cache_add_negative(const char *query, enum dns_query_type type,
+			    uint32_t ttl);
+#else
+#define dns_cache_find(...) -ENOENT
+#define dns_cache_add(...)
+#define dns_cache_add_negative(...)
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DNS_CACHE_H_ */
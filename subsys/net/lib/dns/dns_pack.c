@@ -177,6 +177,74 @@ int dns_unpack_answer(struct dns_msg_t *dns_msg, int dname_ptr, uint32_t *ttl,
 	return 0;
 }
 
+int dns_unpack_soa_ttl(struct dns_msg_t *dns_msg, uint32_t *ttl)
+{
+	int nscount = dns_unpack_header_nscount(dns_msg->msg);
+	uint32_t offset = dns_msg->answer_offset;
+	int dname_len, mname_len, rname_len;
+	uint32_t hdr_len;
+	uint16_t rdlength;
+	uint8_t *rr, *rdata;
+
+	while (nscount-- > 0) {
+		if (offset >= dns_msg->msg_size) {
+			return -EINVAL;
+		}
+
+		rr = dns_msg->msg + offset;
+
+		dname_len = skip_fqdn(rr, dns_msg->msg_size - offset);
+		if (dname_len < 0) {
+			return dname_len;
+		}
+
+		/* name + type + class + ttl + rdlength */
+		hdr_len = dname_len + DNS_COMMON_UINT_SIZE +
+			DNS_COMMON_UINT_SIZE + DNS_TTL_LEN + DNS_RDLENGTH_LEN;
+		if (offset + hdr_len > dns_msg->msg_size) {
+			return -EINVAL;
+		}
+
+		rdlength = dns_answer_rdlength(dname_len, rr);
+		if (offset + hdr_len + rdlength > dns_msg->msg_size) {
+			return -EINVAL;
+		}
+
+		if (dns_answer_type(dname_len, rr) != DNS_RR_TYPE_SOA) {
+			offset += hdr_len + rdlength;
+			continue;
+		}
+
+		/* MNAME, RNAME, SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM,
+		 * see RFC 1035 ch. 3.3.13
+		 */
+		rdata = rr + hdr_len;
+
+		mname_len = skip_fqdn(rdata, rdlength);
+		if (mname_len < 0) {
+			return mname_len;
+		}
+
+		rname_len = skip_fqdn(rdata + mname_len, rdlength - mname_len);
+		if (rname_len < 0) {
+			return rname_len;
+		}
+
+		if (mname_len + rname_len + 5 * DNS_TTL_LEN > rdlength) {
+			return -EINVAL;
+		}
+
+		rdata += mname_len + rname_len + 4 * DNS_TTL_LEN;
+
+		*ttl = MIN((uint32_t)dns_answer_ttl(dname_len, rr),
+			   ntohl(UNALIGNED_GET((uint32_t *)rdata)));
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
 int dns_unpack_response_header(struct dns_msg_t *msg, int src_id)
 {
 	uint8_t *dns_header;
@@ -26,6 +26,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <net/dns_resolve.h>
 #include "dns_pack.h"
 #include "dns_internal.h"
+#include "dns_cache.h"
 
 #define DNS_SERVER_COUNT CONFIG_DNS_RESOLVER_MAX_SERVERS
 #define SERVER_COUNT     (DNS_SERVER_COUNT + DNS_MAX_MCAST_SERVERS)
@@ -472,7 +473,7 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 		     uint16_t *query_hash)
 {
 	struct dns_addrinfo info = { 0 };
-	uint32_t ttl; /* RR ttl, so far it is not passed to caller */
+	uint32_t ttl; /* RR ttl, only used by the DNS cache */
 	uint8_t *src, *addr;
 	const char *query_name;
 	int address_size;
@@ -633,6 +634,12 @@ query_known:
 			src = dns_msg->msg + dns_msg->response_position;
 			memcpy(addr, src, address_size);
 
+			if (ctx->queries[*query_idx].query) {
+				dns_cache_add(ctx->queries[*query_idx].query,
+					      ctx->queries[*query_idx].query_type,
+					      &info.ai_addr, ttl, items == 0);
+			}
+
 			invoke_query_callback(DNS_EAI_INPROGRESS, &info,
 					      &ctx->queries[*query_idx]);
 			items++;
@@ -701,6 +708,16 @@ query_known:
 	}
 
 	if (items == 0) {
+		/* Remember that the name does not exist, RFC 2308 */
+		if (IS_ENABLED(CONFIG_DNS_RESOLVER_CACHE) &&
+		    dns_header_rcode(dns_msg->msg) == DNS_HEADER_NAMEERROR &&
+		    ctx->queries[*query_idx].query &&
+		    dns_unpack_soa_ttl(dns_msg, &ttl) == 0) {
+			dns_cache_add_negative(ctx->queries[*query_idx].query,
+					       ctx->queries[*query_idx].query_type,
+					       ttl);
+		}
+
 		ret = DNS_EAI_NODATA;
 	} else {
 		ret = DNS_EAI_ALLDONE;
@@ -1056,6 +1073,47 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx, uint16_t dns_id)
 	return dns_resolve_cancel_with_name(ctx, dns_id, NULL, 0);
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static int resolve_from_cache(const char *query, enum dns_query_type type,
+			      dns_resolve_cb_t cb, void *user_data)
+{
+	struct sockaddr addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+	struct dns_addrinfo info = { 0 };
+	int count, i;
+
+	count = dns_cache_find(query, type, addr, ARRAY_SIZE(addr));
+	if (count < 0) {
+		return count;
+	}
+
+	NET_DBG("Resolving %s from cache (%d addresses)", log_strdup(query),
+		count);
+
+	if (count == 0) {
+		/* Name error cached earlier */
+		cb(DNS_EAI_NODATA, NULL, user_data);
+		return 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		memcpy(&info.ai_addr, &addr[i], sizeof(info.ai_addr));
+		info.ai_family = addr[i].sa_family;
+
+		if (info.ai_family == AF_INET) {
+			info.ai_addrlen = sizeof(struct sockaddr_in);
+		} else {
+			info.ai_addrlen = sizeof(struct sockaddr_in6);
+		}
+
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+	}
+
+	cb(DNS_EAI_ALLDONE, NULL, user_data);
+
+	return 0;
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 static void query_timeout(struct k_work *work)
 {
 	struct dns_pending_query *pending_query =
@@ -1179,6 +1237,17 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		return 0;
 	}
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/* No need to query the name if it was resolved recently */
+	if (resolve_from_cache(query, type, cb, user_data) == 0) {
+		if (dns_id) {
+			*dns_id = 0U;
+		}
+
+		return 0;
+	}
+#endif
+
 try_resolve:
 	k_mutex_lock(&ctx->lock, K_FOREVER);
 
@@ -1410,6 +1479,9 @@ int dns_resolve_reconfigure(struct dns_resolve_context *ctx,
 		}
 	}
 
+	/* The new servers might give different answers */
+	dns_resolve_cache_flush();
+
 	err = dns_resolve_init_locked(ctx, servers, servers_sa);
 
 unlock:
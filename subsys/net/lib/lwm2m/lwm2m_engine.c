@@ -46,6 +46,12 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_SENML_JSON_SUPPORT
+#include "lwm2m_rw_senml_json.h"
+#endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -110,6 +116,23 @@ static sys_slist_t engine_obj_list;
 static sys_slist_t engine_obj_inst_list;
 static sys_slist_t engine_service_list;
 
+/* Hash indexes of the registered objects and object instances, the
+ * entries of a bucket are chained through their index_next member.
+ */
+#define OBJ_INDEX_SIZE		16
+#define OBJ_INST_INDEX_SIZE	32
+
+static struct lwm2m_engine_obj *engine_obj_index[OBJ_INDEX_SIZE];
+static struct lwm2m_engine_obj_inst *engine_obj_inst_index[OBJ_INST_INDEX_SIZE];
+
+/* Generations used to tell resource handles that their cached object
+ * pointers or observer state may be stale: the first one changes when
+ * objects or object instances are removed, the second one when observers
+ * are added or removed.
+ */
+static uint32_t engine_res_gen;
+static uint32_t engine_observer_gen;
+
 static K_KERNEL_STACK_DEFINE(engine_thread_stack,
 			      CONFIG_LWM2M_ENGINE_STACK_SIZE);
 static struct k_thread engine_thread_data;
@@ -375,6 +398,27 @@ int lwm2m_notify_observer_path(struct lwm2m_obj_path *path)
 				     path->res_id);
 }
 
+/* Notify the observers of a resource handle. Whether the resource has
+ * observers is remembered until the observers change, so updating a
+ * resource nobody observes does not go through the observer lists.
+ */
+static int handle_notify(struct lwm2m_res_handle *handle)
+{
+	int ret;
+
+	if (handle->observer_gen == engine_observer_gen && !handle->observed) {
+		return 0;
+	}
+
+	ret = lwm2m_notify_observer(handle->obj_id, handle->obj_inst_id,
+				    handle->res_id);
+
+	handle->observed = ret > 0;
+	handle->observer_gen = engine_observer_gen;
+
+	return ret;
+}
+
 static int engine_add_observer(struct lwm2m_message *msg,
 			       const uint8_t *token, uint8_t tkl,
 			       uint16_t format)
@@ -513,6 +557,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	observe_node_data[i].counter = OBSERVE_COUNTER_START;
 	sys_slist_append(&msg->ctx->observer,
 			 &observe_node_data[i].node);
+	engine_observer_gen++;
 
 	LOG_DBG("OBSERVER ADDED %u/%u/%u(%u) token:'%s' addr:%s",
 		msg->path.obj_id, msg->path.obj_inst_id,
@@ -549,6 +594,7 @@ static int engine_remove_observer(struct lwm2m_ctx *ctx, const uint8_t *token, u
 	}
 
 	sys_slist_remove(&ctx->observer, prev_node, &found_obj->node);
+	engine_observer_gen++;
 	(void)memset(found_obj, 0, sizeof(*found_obj));
 
 	LOG_DBG("observer '%s' removed", log_strdup(sprint_token(token, tkl)));
@@ -599,6 +645,7 @@ static int engine_remove_observer_by_path(struct lwm2m_obj_path *path)
 	LOG_INF("Removing observer for path %s",
 		lwm2m_path_log_strdup(buf, path));
 	sys_slist_remove(&engine_observer_list, prev_node, &found_obj->node);
+	engine_observer_gen++;
 	(void)memset(found_obj, 0, sizeof(*found_obj));
 
 	return 0;
@@ -623,28 +670,55 @@ static void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id)
 
 			sys_slist_remove(&sock_ctx[i]->observer, prev_node, &obs->node);
 			(void)memset(obs, 0, sizeof(*obs));
+			engine_observer_gen++;
 		}
 	}
 }
 
 /* engine object */
 
+static inline int obj_index_hash(uint16_t obj_id)
+{
+	return obj_id % OBJ_INDEX_SIZE;
+}
+
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
+	struct lwm2m_engine_obj **bucket =
+		&engine_obj_index[obj_index_hash(obj->obj_id)];
+
 	sys_slist_append(&engine_obj_list, &obj->node);
+
+	obj->index_next = *bucket;
+	*bucket = obj;
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
+	struct lwm2m_engine_obj **iter =
+		&engine_obj_index[obj_index_hash(obj->obj_id)];
+
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+
+	while (*iter) {
+		if (*iter == obj) {
+			*iter = obj->index_next;
+			break;
+		}
+
+		iter = &(*iter)->index_next;
+	}
+
+	engine_res_gen++;
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	for (obj = engine_obj_index[obj_index_hash(obj_id)]; obj;
+	     obj = obj->index_next) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -671,16 +745,43 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 
 /* engine object instance */
 
+static inline int obj_inst_index_hash(uint16_t obj_id, uint16_t obj_inst_id)
+{
+	return (obj_id * 31U + obj_inst_id) % OBJ_INST_INDEX_SIZE;
+}
+
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
+	struct lwm2m_engine_obj_inst **bucket =
+		&engine_obj_inst_index[obj_inst_index_hash(
+			obj_inst->obj->obj_id, obj_inst->obj_inst_id)];
+
 	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+
+	obj_inst->index_next = *bucket;
+	*bucket = obj_inst;
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
+	struct lwm2m_engine_obj_inst **iter =
+		&engine_obj_inst_index[obj_inst_index_hash(
+			obj_inst->obj->obj_id, obj_inst->obj_inst_id)];
+
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+
+	while (*iter) {
+		if (*iter == obj_inst) {
+			*iter = obj_inst->index_next;
+			break;
+		}
+
+		iter = &(*iter)->index_next;
+	}
+
+	engine_res_gen++;
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -688,8 +789,13 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	if (obj_id < 0 || obj_inst_id < 0) {
+		return NULL;
+	}
+
+	for (obj_inst = engine_obj_inst_index[obj_inst_index_hash(
+						obj_id, obj_inst_id)];
+	     obj_inst; obj_inst = obj_inst->index_next) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -1199,6 +1305,18 @@ static int select_writer(struct lwm2m_output_context *out, uint16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_JSON_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_JSON:
+		out->writer = &senml_json_writer;
+		break;
+#endif
+
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1230,6 +1348,18 @@ static int select_reader(struct lwm2m_input_context *in, uint16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_JSON_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_JSON:
+		in->reader = &senml_json_reader;
+		break;
+#endif
+
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		in->reader = &senml_cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1472,12 +1602,55 @@ int lwm2m_engine_delete_obj_inst(char *pathstr)
 }
 
 
-int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, uint16_t data_len,
-			      uint8_t data_flags)
+/* resource handles */
+
+/* Look up the objects of the resource instance of a handle */
+static int handle_resolve(struct lwm2m_res_handle *handle)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = handle->obj_id,
+		.obj_inst_id = handle->obj_inst_id,
+		.res_id = handle->res_id,
+		.res_inst_id = handle->res_inst_id,
+		.level = LWM2M_PATH_LEVEL_RESOURCE_INST,
+	};
+	int ret;
+
+	handle->res_inst = NULL;
+
+	ret = path_to_objs(&path, &handle->obj_inst, &handle->obj_field,
+			   &handle->res, &handle->res_inst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!handle->res_inst) {
+		LOG_ERR("res instance %d not found", handle->res_inst_id);
+		return -ENOENT;
+	}
+
+	handle->res_gen = engine_res_gen;
+
+	return 0;
+}
+
+/* Look the objects of a handle up again if objects, object instances or
+ * the resource instance were removed since they were resolved.
+ */
+static int handle_validate(struct lwm2m_res_handle *handle)
+{
+	if (handle->res_inst && handle->res_gen == engine_res_gen &&
+	    handle->res_inst->res_inst_id == handle->res_inst_id) {
+		return 0;
+	}
+
+	return handle_resolve(handle);
+}
+
+int lwm2m_engine_resolve(char *pathstr, struct lwm2m_res_handle *handle)
 {
 	struct lwm2m_obj_path path;
-	struct lwm2m_engine_res_inst *res_inst = NULL;
-	int ret = 0;
+	int ret;
 
 	/* translate path -> path_obj */
 	ret = string_to_path(pathstr, &path, '/');
@@ -1490,66 +1663,69 @@ int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, uint16_t data_len,
 		return -EINVAL;
 	}
 
-	/* look up resource obj */
-	ret = path_to_objs(&path, NULL, NULL, NULL, &res_inst);
+	(void)memset(handle, 0, sizeof(*handle));
+	handle->obj_id = path.obj_id;
+	handle->obj_inst_id = path.obj_inst_id;
+	handle->res_id = path.res_id;
+	handle->res_inst_id = path.res_inst_id;
+
+	/* unknown until the first notification */
+	handle->observed = true;
+
+	return handle_resolve(handle);
+}
+
+int lwm2m_engine_handle_notify(struct lwm2m_res_handle *handle)
+{
+	return handle_notify(handle);
+}
+
+int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, uint16_t data_len,
+			      uint8_t data_flags)
+{
+	struct lwm2m_res_handle handle;
+	int ret;
+
+	ret = lwm2m_engine_resolve(pathstr, &handle);
 	if (ret < 0) {
 		return ret;
 	}
 
-	if (!res_inst) {
-		LOG_ERR("res instance %d not found", path.res_inst_id);
-		return -ENOENT;
-	}
-
 	/* assign data elements */
-	res_inst->data_ptr = data_ptr;
-	res_inst->data_len = data_len;
-	res_inst->max_data_len = data_len;
-	res_inst->data_flags = data_flags;
+	handle.res_inst->data_ptr = data_ptr;
+	handle.res_inst->data_len = data_len;
+	handle.res_inst->max_data_len = data_len;
+	handle.res_inst->data_flags = data_flags;
 
-	return ret;
+	return 0;
 }
 
-static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
+static int engine_set(struct lwm2m_res_handle *handle, void *value,
+		      uint16_t len)
 {
-	struct lwm2m_obj_path path;
 	struct lwm2m_engine_obj_inst *obj_inst;
 	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res *res = NULL;
-	struct lwm2m_engine_res_inst *res_inst = NULL;
+	struct lwm2m_engine_res *res;
+	struct lwm2m_engine_res_inst *res_inst;
 	void *data_ptr = NULL;
 	size_t max_data_len = 0;
 	int ret = 0;
 	bool changed = false;
 
-	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
+	ret = handle_validate(handle);
 	if (ret < 0) {
 		return ret;
 	}
 
-	if (path.level < 3) {
-		LOG_ERR("path must have at least 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res, &res_inst);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res_inst) {
-		LOG_ERR("res instance %d not found", path.res_inst_id);
-		return -ENOENT;
-	}
+	obj_inst = handle->obj_inst;
+	obj_field = handle->obj_field;
+	res = handle->res;
+	res_inst = handle->res_inst;
 
 	if (LWM2M_HAS_RES_FLAG(res_inst, LWM2M_RES_DATA_FLAG_RO)) {
 		LOG_ERR("res instance data pointer is read-only "
-			"[%u/%u/%u/%u:%u]", path.obj_id, path.obj_inst_id,
-			path.res_id, path.res_inst_id, path.level);
+			"[%u/%u/%u/%u]", handle->obj_id, handle->obj_inst_id,
+			handle->res_id, handle->res_inst_id);
 		return -EACCES;
 	}
 
@@ -1565,9 +1741,9 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 	}
 
 	if (!data_ptr) {
-		LOG_ERR("res instance data pointer is NULL [%u/%u/%u/%u:%u]",
-			path.obj_id, path.obj_inst_id, path.res_id,
-			path.res_inst_id, path.level);
+		LOG_ERR("res instance data pointer is NULL [%u/%u/%u/%u]",
+			handle->obj_id, handle->obj_inst_id, handle->res_id,
+			handle->res_inst_id);
 		return -EINVAL;
 	}
 
@@ -1575,7 +1751,7 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 	if (len > max_data_len -
 		(obj_field->data_type == LWM2M_RES_TYPE_STRING ? 1 : 0)) {
 		LOG_ERR("length %u is too long for res instance %d data",
-			len, path.res_id);
+			len, handle->res_id);
 		return -ENOMEM;
 	}
 
@@ -1676,12 +1852,27 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 	}
 
 	if (changed && LWM2M_HAS_PERM(obj_field, LWM2M_PERM_R)) {
-		NOTIFY_OBSERVER_PATH(&path);
+		handle_notify(handle);
 	}
 
 	return ret;
 }
 
+static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
+{
+	struct lwm2m_res_handle handle;
+	int ret;
+
+	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
+
+	ret = lwm2m_engine_resolve(pathstr, &handle);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_set(&handle, value, len);
+}
+
 int lwm2m_engine_set_opaque(char *pathstr, char *data_ptr, uint16_t data_len)
 {
 	return lwm2m_engine_set(pathstr, data_ptr, data_len);
@@ -1754,78 +1945,123 @@ int lwm2m_engine_set_objlnk(char *pathstr, struct lwm2m_objlnk *value)
 	return lwm2m_engine_set(pathstr, value, sizeof(struct lwm2m_objlnk));
 }
 
+int lwm2m_engine_handle_set_opaque(struct lwm2m_res_handle *handle,
+				   char *data_ptr, uint16_t data_len)
+{
+	return engine_set(handle, data_ptr, data_len);
+}
+
+int lwm2m_engine_handle_set_string(struct lwm2m_res_handle *handle,
+				   char *data_ptr)
+{
+	return engine_set(handle, data_ptr, strlen(data_ptr));
+}
+
+int lwm2m_engine_handle_set_u8(struct lwm2m_res_handle *handle, uint8_t value)
+{
+	return engine_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_u16(struct lwm2m_res_handle *handle, uint16_t value)
+{
+	return engine_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_u32(struct lwm2m_res_handle *handle, uint32_t value)
+{
+	return engine_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_u64(struct lwm2m_res_handle *handle, uint64_t value)
+{
+	return engine_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_s8(struct lwm2m_res_handle *handle, int8_t value)
+{
+	return engine_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_s16(struct lwm2m_res_handle *handle, int16_t value)
+{
+	return engine_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_s32(struct lwm2m_res_handle *handle, int32_t value)
+{
+	return engine_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_s64(struct lwm2m_res_handle *handle, int64_t value)
+{
+	return engine_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_bool(struct lwm2m_res_handle *handle, bool value)
+{
+	uint8_t temp = (value != 0 ? 1 : 0);
+
+	return engine_set(handle, &temp, 1);
+}
+
+int lwm2m_engine_handle_set_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *value)
+{
+	return engine_set(handle, value, sizeof(float32_value_t));
+}
+
+int lwm2m_engine_handle_set_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *value)
+{
+	return engine_set(handle, value, sizeof(float64_value_t));
+}
+
+int lwm2m_engine_handle_set_objlnk(struct lwm2m_res_handle *handle,
+				   struct lwm2m_objlnk *value)
+{
+	return engine_set(handle, value, sizeof(struct lwm2m_objlnk));
+}
+
 /* user data getter functions */
 
 int lwm2m_engine_get_res_data(char *pathstr, void **data_ptr, uint16_t *data_len,
 			      uint8_t *data_flags)
 {
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_res_inst *res_inst = NULL;
-	int ret = 0;
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have at least 3 parts");
-		return -EINVAL;
-	}
+	struct lwm2m_res_handle handle;
+	int ret;
 
-	/* look up resource obj */
-	ret = path_to_objs(&path, NULL, NULL, NULL, &res_inst);
+	ret = lwm2m_engine_resolve(pathstr, &handle);
 	if (ret < 0) {
 		return ret;
 	}
 
-	if (!res_inst) {
-		LOG_ERR("res instance %d not found", path.res_inst_id);
-		return -ENOENT;
-	}
-
-	*data_ptr = res_inst->data_ptr;
-	*data_len = res_inst->data_len;
-	*data_flags = res_inst->data_flags;
+	*data_ptr = handle.res_inst->data_ptr;
+	*data_len = handle.res_inst->data_len;
+	*data_flags = handle.res_inst->data_flags;
 
 	return 0;
 }
 
-static int lwm2m_engine_get(char *pathstr, void *buf, uint16_t buflen)
+static int engine_get(struct lwm2m_res_handle *handle, void *buf,
+		      uint16_t buflen)
 {
-	int ret = 0;
-	struct lwm2m_obj_path path;
 	struct lwm2m_engine_obj_inst *obj_inst;
 	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res *res = NULL;
-	struct lwm2m_engine_res_inst *res_inst = NULL;
+	struct lwm2m_engine_res *res;
+	struct lwm2m_engine_res_inst *res_inst;
 	void *data_ptr = NULL;
 	size_t data_len = 0;
+	int ret;
 
-	LOG_DBG("path:%s, buf:%p, buflen:%d", log_strdup(pathstr), buf, buflen);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have at least 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res, &res_inst);
+	ret = handle_validate(handle);
 	if (ret < 0) {
 		return ret;
 	}
 
-	if (!res_inst) {
-		LOG_ERR("res instance %d not found", path.res_inst_id);
-		return -ENOENT;
-	}
+	obj_inst = handle->obj_inst;
+	obj_field = handle->obj_field;
+	res = handle->res;
+	res_inst = handle->res_inst;
 
 	/* setup initial data elements */
 	data_ptr = res_inst->data_ptr;
@@ -1922,6 +2158,21 @@ static int lwm2m_engine_get(char *pathstr, void *buf, uint16_t buflen)
 	return 0;
 }
 
+static int lwm2m_engine_get(char *pathstr, void *buf, uint16_t buflen)
+{
+	struct lwm2m_res_handle handle;
+	int ret;
+
+	LOG_DBG("path:%s, buf:%p, buflen:%d", log_strdup(pathstr), buf, buflen);
+
+	ret = lwm2m_engine_resolve(pathstr, &handle);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_get(&handle, buf, buflen);
+}
+
 int lwm2m_engine_get_opaque(char *pathstr, void *buf, uint16_t buflen)
 {
 	return lwm2m_engine_get(pathstr, buf, buflen);
@@ -2000,6 +2251,89 @@ int lwm2m_engine_get_objlnk(char *pathstr, struct lwm2m_objlnk *buf)
 	return lwm2m_engine_get(pathstr, buf, sizeof(struct lwm2m_objlnk));
 }
 
+int lwm2m_engine_handle_get_opaque(struct lwm2m_res_handle *handle,
+				   void *buf, uint16_t buflen)
+{
+	return engine_get(handle, buf, buflen);
+}
+
+int lwm2m_engine_handle_get_string(struct lwm2m_res_handle *handle,
+				   void *buf, uint16_t buflen)
+{
+	return engine_get(handle, buf, buflen);
+}
+
+int lwm2m_engine_handle_get_u8(struct lwm2m_res_handle *handle, uint8_t *value)
+{
+	return engine_get(handle, value, 1);
+}
+
+int lwm2m_engine_handle_get_u16(struct lwm2m_res_handle *handle, uint16_t *value)
+{
+	return engine_get(handle, value, 2);
+}
+
+int lwm2m_engine_handle_get_u32(struct lwm2m_res_handle *handle, uint32_t *value)
+{
+	return engine_get(handle, value, 4);
+}
+
+int lwm2m_engine_handle_get_u64(struct lwm2m_res_handle *handle, uint64_t *value)
+{
+	return engine_get(handle, value, 8);
+}
+
+int lwm2m_engine_handle_get_s8(struct lwm2m_res_handle *handle, int8_t *value)
+{
+	return engine_get(handle, value, 1);
+}
+
+int lwm2m_engine_handle_get_s16(struct lwm2m_res_handle *handle, int16_t *value)
+{
+	return engine_get(handle, value, 2);
+}
+
+int lwm2m_engine_handle_get_s32(struct lwm2m_res_handle *handle, int32_t *value)
+{
+	return engine_get(handle, value, 4);
+}
+
+int lwm2m_engine_handle_get_s64(struct lwm2m_res_handle *handle, int64_t *value)
+{
+	return engine_get(handle, value, 8);
+}
+
+int lwm2m_engine_handle_get_bool(struct lwm2m_res_handle *handle, bool *value)
+{
+	int ret = 0;
+	int8_t temp = 0;
+
+	ret = lwm2m_engine_handle_get_s8(handle, &temp);
+	if (!ret) {
+		*value = temp != 0;
+	}
+
+	return ret;
+}
+
+int lwm2m_engine_handle_get_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *buf)
+{
+	return engine_get(handle, buf, sizeof(float32_value_t));
+}
+
+int lwm2m_engine_handle_get_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *buf)
+{
+	return engine_get(handle, buf, sizeof(float64_value_t));
+}
+
+int lwm2m_engine_handle_get_objlnk(struct lwm2m_res_handle *handle,
+				   struct lwm2m_objlnk *buf)
+{
+	return engine_get(handle, buf, sizeof(struct lwm2m_objlnk));
+}
+
 int lwm2m_engine_get_resource(char *pathstr, struct lwm2m_engine_res **res)
 {
 	int ret;
@@ -2755,6 +3089,49 @@ int lwm2m_write_handler(struct lwm2m_engine_obj_inst *obj_inst,
 	return ret;
 }
 
+/*
+ * This function is exposed for the content format readers which carry a
+ * path with each value: write the value at the current input position to
+ * the resource (instance) named by pathstr.
+ */
+int lwm2m_write_path_handler(struct lwm2m_message *msg, char *pathstr)
+{
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_obj_field *obj_field = NULL;
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	int ret;
+
+	ret = string_to_path(pathstr, &msg->path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (msg->path.level < LWM2M_PATH_LEVEL_RESOURCE) {
+		return -EINVAL;
+	}
+
+	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, NULL);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = path_to_objs(&msg->path, NULL, &obj_field, &res, &res_inst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+		return -EPERM;
+	}
+
+	if (!res_inst) {
+		return -ENOENT;
+	}
+
+	return lwm2m_write_handler(obj_inst, res, res_inst, obj_field, msg);
+}
+
 static int lwm2m_write_attr_handler(struct lwm2m_engine_obj *obj,
 				    struct lwm2m_message *msg)
 {
@@ -3166,6 +3543,16 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 		return do_read_op_json(msg, content_format);
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_JSON_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_JSON:
+		return do_read_op_senml_json(msg, content_format);
+#endif
+
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -3555,6 +3942,16 @@ static int do_write_op(struct lwm2m_message *msg,
 		return do_write_op_json(msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_JSON_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_JSON:
+		return do_write_op_senml_json(msg);
+#endif
+
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -4480,6 +4877,8 @@ int lwm2m_engine_context_close(struct lwm2m_ctx *client_ctx)
 		(void)memset(obs, 0, sizeof(*obs));
 	}
 
+	engine_observer_gen++;
+
 	for (i = 0, msg = messages; i < ARRAY_SIZE(messages); i++, msg++) {
 		if (msg->ctx == client_ctx) {
 			lwm2m_reset_message(msg, true);
@@ -4518,6 +4917,7 @@ int lwm2m_socket_add(struct lwm2m_ctx *ctx)
 	sock_fds[sock_nfds].fd = ctx->sock_fd;
 	sock_fds[sock_nfds].events = POLLIN;
 	sock_nfds++;
+	engine_observer_gen++;
 
 	return 0;
 }
@@ -4541,6 +4941,7 @@ void lwm2m_socket_del(struct lwm2m_ctx *ctx)
 		/* Remove the last entry. */
 		sock_ctx[sock_nfds] = NULL;
 		sock_fds[sock_nfds].fd = -1;
+		engine_observer_gen++;
 		break;
 	}
 }
@@ -184,6 +184,9 @@ struct lwm2m_engine_obj {
 	/* object list */
 	sys_snode_t node;
 
+	/* next object in the same bucket of the object index */
+	struct lwm2m_engine_obj *index_next;
+
 	/* object field definitions */
 	struct lwm2m_engine_obj_field *fields;
 
@@ -381,6 +384,9 @@ struct lwm2m_engine_obj_inst {
 	/* instance list */
 	sys_snode_t node;
 
+	/* next instance in the same bucket of the object instance index */
+	struct lwm2m_engine_obj_inst *index_next;
+
 	struct lwm2m_engine_obj *obj;
 	struct lwm2m_engine_res *resources;
 
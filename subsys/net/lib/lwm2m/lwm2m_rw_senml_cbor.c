@@ -0,0 +1,985 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML-CBOR (RFC 8428) reader / writer.
+ *
+ * A payload is an array of records, each a map holding the record name and
+ * one value. The base name, "/<obj>/<obj inst>/" or "/<obj>/" for object
+ * level reads, is only carried in the first record, the names of the other
+ * records are relative to it.
+ *
+ * The writer encodes every record straight into the CoAP packet buffer. The
+ * number of records is not known before the end of the payload, so the array
+ * header is inserted in front of them when the payload is ended.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/byteorder.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_util.h"
+
+/* CBOR major types */
+#define CBOR_MAJOR_UINT		0
+#define CBOR_MAJOR_NINT		1
+#define CBOR_MAJOR_BSTR		2
+#define CBOR_MAJOR_TSTR		3
+#define CBOR_MAJOR_ARRAY	4
+#define CBOR_MAJOR_MAP		5
+#define CBOR_MAJOR_TAG		6
+#define CBOR_MAJOR_SIMPLE	7
+
+/* CBOR additional information */
+#define CBOR_AI_UINT8		24
+#define CBOR_AI_UINT16		25
+#define CBOR_AI_UINT32		26
+#define CBOR_AI_UINT64		27
+#define CBOR_AI_INDEFINITE	31
+
+#define CBOR_FALSE		0xf4
+#define CBOR_TRUE		0xf5
+#define CBOR_FLOAT32		0xfa
+#define CBOR_FLOAT64		0xfb
+#define CBOR_BREAK		0xff
+
+/* Length value of the indefinite length items */
+#define CBOR_INDEFINITE		UINT64_MAX
+
+/* Maximum nesting of the items skipped by the reader */
+#define CBOR_MAX_DEPTH		4
+
+/* SenML labels */
+#define SENML_LABEL_BN		-2
+#define SENML_LABEL_N		0
+#define SENML_LABEL_V		2
+#define SENML_LABEL_VS		3
+#define SENML_LABEL_VB		4
+#define SENML_LABEL_VD		8
+
+/* Value keys, CBOR encoded. Object links have no SenML label. */
+#define KEY_V			"\x02"
+#define KEY_VS			"\x03"
+#define KEY_VB			"\x04"
+#define KEY_VD			"\x08"
+#define KEY_VLO			"\x63" "vlo"
+
+#define KEY(k)			(k), (sizeof(k) - 1)
+
+/* Map header, base name, name, value key and a 9 byte value header */
+#define RECORD_BUF_LEN		64
+
+/* "65535/65535/65535" */
+#define NAME_LEN		17
+
+struct cbor_out_formatter_data {
+	/* offset position storage */
+	uint16_t mark_pos;
+
+	/* number of records written */
+	uint16_t record_count;
+
+	/* flags */
+	uint8_t writer_flags;
+
+	/* path storage */
+	uint8_t path_level;
+
+	/* the payload did not fit in the packet */
+	bool no_space;
+};
+
+static uint8_t cbor_encode_hdr(uint8_t *buf, uint8_t major, uint64_t value)
+{
+	major <<= 5;
+
+	if (value < CBOR_AI_UINT8) {
+		buf[0] = major | value;
+		return 1;
+	}
+
+	if (value <= UINT8_MAX) {
+		buf[0] = major | CBOR_AI_UINT8;
+		buf[1] = value;
+		return 2;
+	}
+
+	if (value <= UINT16_MAX) {
+		buf[0] = major | CBOR_AI_UINT16;
+		sys_put_be16(value, &buf[1]);
+		return 3;
+	}
+
+	if (value <= UINT32_MAX) {
+		buf[0] = major | CBOR_AI_UINT32;
+		sys_put_be32(value, &buf[1]);
+		return 5;
+	}
+
+	buf[0] = major | CBOR_AI_UINT64;
+	sys_put_be64(value, &buf[1]);
+	return 9;
+}
+
+static uint8_t cbor_encode_int(uint8_t *buf, int64_t value)
+{
+	if (value < 0) {
+		return cbor_encode_hdr(buf, CBOR_MAJOR_NINT,
+				       (uint64_t)-(value + 1));
+	}
+
+	return cbor_encode_hdr(buf, CBOR_MAJOR_UINT, value);
+}
+
+static uint8_t put_id(char *buf, uint16_t id)
+{
+	char tmp[5];
+	uint8_t len = 0U, i = 0U;
+
+	do {
+		tmp[len++] = '0' + id % 10U;
+		id /= 10U;
+	} while (id > 0U);
+
+	while (len > 0U) {
+		buf[i++] = tmp[--len];
+	}
+
+	return i;
+}
+
+static uint8_t put_text(uint8_t *buf, const char *text, uint8_t len)
+{
+	uint8_t pos;
+
+	pos = cbor_encode_hdr(buf, CBOR_MAJOR_TSTR, len);
+	memcpy(buf + pos, text, len);
+
+	return pos + len;
+}
+
+/*
+ * Encode the record map header, the names and the value key into buf,
+ * return the encoded length.
+ */
+static uint8_t put_record_prefix(struct cbor_out_formatter_data *fd,
+				 struct lwm2m_obj_path *path,
+				 const char *key, uint8_t key_len,
+				 uint8_t *buf)
+{
+	char name[NAME_LEN];
+	uint8_t len = 0U, pos;
+
+	if (fd->record_count == 0U) {
+		/* the first record also carries the base name */
+		pos = cbor_encode_hdr(buf, CBOR_MAJOR_MAP, 3);
+		pos += cbor_encode_int(buf + pos, SENML_LABEL_BN);
+
+		name[len++] = '/';
+		len += put_id(name + len, path->obj_id);
+		name[len++] = '/';
+		if (fd->path_level >= 2U) {
+			len += put_id(name + len, path->obj_inst_id);
+			name[len++] = '/';
+		}
+
+		pos += put_text(buf + pos, name, len);
+		len = 0U;
+	} else {
+		pos = cbor_encode_hdr(buf, CBOR_MAJOR_MAP, 2);
+	}
+
+	if (fd->path_level < 2U) {
+		len += put_id(name + len, path->obj_inst_id);
+		name[len++] = '/';
+	}
+
+	len += put_id(name + len, path->res_id);
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		name[len++] = '/';
+		len += put_id(name + len, path->res_inst_id);
+	}
+
+	buf[pos++] = SENML_LABEL_N;
+	pos += put_text(buf + pos, name, len);
+
+	memcpy(buf + pos, key, key_len);
+
+	return pos + key_len;
+}
+
+/*
+ * Append an encoded record and the optional data following it to the
+ * packet. Nothing is left in the packet when it does not fit.
+ */
+static size_t put_record(struct lwm2m_output_context *out,
+			 uint8_t *buf, uint8_t len,
+			 const void *data, size_t data_len)
+{
+	struct cbor_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	if (buf_append(CPKT_BUF_WRITE(out->out_cpkt), buf, len) < 0 ||
+	    (data_len > 0 &&
+	     buf_append(CPKT_BUF_WRITE(out->out_cpkt), (uint8_t *)data,
+			data_len) < 0)) {
+		out->out_cpkt->offset = start;
+		fd->no_space = true;
+		return 0;
+	}
+
+	fd->record_count++;
+
+	return len + data_len;
+}
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	/* store position for inserting the array header */
+	fd->mark_pos = out->out_cpkt->offset;
+	fd->record_count = 0U;
+
+	return 0;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[3];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = cbor_encode_hdr(buf, CBOR_MAJOR_ARRAY, fd->record_count);
+	if (buf_insert(CPKT_BUF_WRITE(out->out_cpkt), fd->mark_pos,
+		       buf, len) < 0) {
+		fd->no_space = true;
+		return 0;
+	}
+
+	return len;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int64_t value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, KEY(KEY_V), buf);
+	len += cbor_encode_int(buf + len, value);
+
+	return put_record(out, buf, len, NULL, 0);
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int32_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int16_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, int8_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_data(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       const char *key, uint8_t key_len, uint8_t major,
+		       const void *data, size_t data_len)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, key, key_len, buf);
+	len += cbor_encode_hdr(buf + len, major, data_len);
+
+	return put_record(out, buf, len, data, data_len);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_data(out, path, KEY(KEY_VS), CBOR_MAJOR_TSTR, buf, buflen);
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_data(out, path, KEY(KEY_VD), CBOR_MAJOR_BSTR, buf, buflen);
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, KEY(KEY_V), buf);
+	buf[len++] = CBOR_FLOAT32;
+	if (lwm2m_f32_to_b32(value, buf + len, 4) < 0) {
+		return 0;
+	}
+
+	return put_record(out, buf, len + 4, NULL, 0);
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, KEY(KEY_V), buf);
+	buf[len++] = CBOR_FLOAT64;
+	if (lwm2m_f64_to_b64(value, buf + len, 8) < 0) {
+		return 0;
+	}
+
+	return put_record(out, buf, len + 8, NULL, 0);
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, KEY(KEY_VB), buf);
+	buf[len++] = value ? CBOR_TRUE : CBOR_FALSE;
+
+	return put_record(out, buf, len, NULL, 0);
+}
+
+static size_t put_objlnk(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 struct lwm2m_objlnk *value)
+{
+	char objlnk[sizeof("65535:65535")];
+	uint8_t len;
+
+	len = put_id(objlnk, value->obj_id);
+	objlnk[len++] = ':';
+	len += put_id(objlnk + len, value->obj_inst);
+
+	return put_data(out, path, KEY(KEY_VLO), CBOR_MAJOR_TSTR,
+			objlnk, len);
+}
+
+/* Read an item header, the value of simple items is read with it */
+static int cbor_get_hdr(struct lwm2m_input_context *in,
+			uint8_t *major, uint64_t *value)
+{
+	uint8_t buf[8];
+	uint8_t ai;
+	int len;
+
+	if (buf_read_u8(&ai, CPKT_BUF_READ(in->in_cpkt), &in->offset) < 0) {
+		return -ENODATA;
+	}
+
+	*major = ai >> 5;
+	ai &= 0x1f;
+
+	if (ai < CBOR_AI_UINT8) {
+		*value = ai;
+		return 1;
+	}
+
+	if (ai == CBOR_AI_INDEFINITE) {
+		*value = CBOR_INDEFINITE;
+		return 1;
+	}
+
+	if (ai > CBOR_AI_UINT64) {
+		return -EBADMSG;
+	}
+
+	len = 1 << (ai - CBOR_AI_UINT8);
+	if (buf_read(buf, len, CPKT_BUF_READ(in->in_cpkt), &in->offset) < 0) {
+		return -ENODATA;
+	}
+
+	switch (len) {
+	case 1:
+		*value = buf[0];
+		break;
+	case 2:
+		*value = sys_get_be16(buf);
+		break;
+	case 4:
+		*value = sys_get_be32(buf);
+		break;
+	default:
+		*value = sys_get_be64(buf);
+		break;
+	}
+
+	return len + 1;
+}
+
+/* Consume the break ending an indefinite length item, if it is next */
+static bool cbor_get_break(struct lwm2m_input_context *in)
+{
+	if (in->offset < in->in_cpkt->offset &&
+	    in->in_cpkt->data[in->offset] == CBOR_BREAK) {
+		in->offset++;
+		return true;
+	}
+
+	return false;
+}
+
+static int cbor_skip(struct lwm2m_input_context *in, int depth)
+{
+	uint64_t value, i;
+	uint8_t major;
+	int ret;
+
+	if (depth > CBOR_MAX_DEPTH) {
+		return -EBADMSG;
+	}
+
+	ret = cbor_get_hdr(in, &major, &value);
+	if (ret < 0) {
+		return ret;
+	}
+
+	switch (major) {
+	case CBOR_MAJOR_BSTR:
+	case CBOR_MAJOR_TSTR:
+		if (value == CBOR_INDEFINITE || value > UINT16_MAX) {
+			return -ENOTSUP;
+		}
+
+		return buf_skip(value, CPKT_BUF_READ(in->in_cpkt),
+				&in->offset);
+
+	case CBOR_MAJOR_ARRAY:
+	case CBOR_MAJOR_MAP:
+		if (value != CBOR_INDEFINITE && major == CBOR_MAJOR_MAP) {
+			value *= 2U;
+		}
+
+		for (i = 0U; value == CBOR_INDEFINITE || i < value; i++) {
+			if (value == CBOR_INDEFINITE && cbor_get_break(in)) {
+				break;
+			}
+
+			ret = cbor_skip(in, depth + 1);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		return 0;
+
+	case CBOR_MAJOR_TAG:
+		return cbor_skip(in, depth + 1);
+
+	default:
+		return 0;
+	}
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, int64_t *value)
+{
+	uint16_t start = in->offset;
+	uint64_t tmp;
+	uint8_t major;
+
+	if (cbor_get_hdr(in, &major, &tmp) < 0) {
+		return 0;
+	}
+
+	if (major == CBOR_MAJOR_UINT) {
+		*value = (int64_t)tmp;
+	} else if (major == CBOR_MAJOR_NINT) {
+		*value = -1 - (int64_t)tmp;
+	} else {
+		in->offset = start;
+		return 0;
+	}
+
+	return in->offset - start;
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, int32_t *value)
+{
+	int64_t tmp = 0;
+	size_t len;
+
+	len = get_s64(in, &tmp);
+	if (len > 0) {
+		*value = (int32_t)tmp;
+	}
+
+	return len;
+}
+
+/* Read the header of a string, return the string length */
+static int get_str_hdr(struct lwm2m_input_context *in, uint8_t expected)
+{
+	uint64_t len;
+	uint8_t major;
+
+	if (cbor_get_hdr(in, &major, &len) < 0 || major != expected ||
+	    len == CBOR_INDEFINITE ||
+	    in->offset + len > in->in_cpkt->offset) {
+		return -EBADMSG;
+	}
+
+	return (int)len;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen)
+{
+	uint16_t start = in->offset;
+	int len;
+
+	len = get_str_hdr(in, CBOR_MAJOR_TSTR);
+	if (len < 0 || buflen == 0) {
+		in->offset = start;
+		return 0;
+	}
+
+	memcpy(buf, in->in_cpkt->data + in->offset, MIN(len, buflen - 1));
+	buf[MIN(len, buflen - 1)] = '\0';
+	in->offset += len;
+
+	return in->offset - start;
+}
+
+/* Read a float or an integer as a float64 value */
+static size_t get_float(struct lwm2m_input_context *in,
+			float64_value_t *value, bool *is_float32)
+{
+	uint16_t start = in->offset;
+	float32_value_t f32;
+	uint8_t buf[8];
+	uint64_t tmp;
+	uint8_t major;
+	int len;
+
+	*is_float32 = false;
+
+	len = cbor_get_hdr(in, &major, &tmp);
+	if (len < 0) {
+		return 0;
+	}
+
+	if (major == CBOR_MAJOR_UINT || major == CBOR_MAJOR_NINT) {
+		value->val1 = major == CBOR_MAJOR_UINT ?
+			      (int64_t)tmp : -1 - (int64_t)tmp;
+		value->val2 = 0;
+	} else if (major == CBOR_MAJOR_SIMPLE && len == 5) {
+		sys_put_be32(tmp, buf);
+		lwm2m_b32_to_f32(buf, 4, &f32);
+		value->val1 = f32.val1;
+		value->val2 = f32.val2;
+		*is_float32 = true;
+	} else if (major == CBOR_MAJOR_SIMPLE && len == 9) {
+		sys_put_be64(tmp, buf);
+		lwm2m_b64_to_f64(buf, 8, value);
+	} else {
+		in->offset = start;
+		return 0;
+	}
+
+	return in->offset - start;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	float64_value_t f64;
+	bool is_float32;
+	size_t len;
+
+	len = get_float(in, &f64, &is_float32);
+	if (len > 0) {
+		value->val1 = (int32_t)f64.val1;
+		value->val2 = (int32_t)(is_float32 ? f64.val2 :
+			f64.val2 / (LWM2M_FLOAT64_DEC_MAX /
+				    LWM2M_FLOAT32_DEC_MAX));
+	}
+
+	return len;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	bool is_float32;
+	size_t len;
+
+	len = get_float(in, value, &is_float32);
+	if (len > 0 && is_float32) {
+		value->val2 *= LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX;
+	}
+
+	return len;
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	uint8_t tmp;
+
+	if (buf_read_u8(&tmp, CPKT_BUF_READ(in->in_cpkt), &in->offset) < 0) {
+		return 0;
+	}
+
+	if (tmp != CBOR_TRUE && tmp != CBOR_FALSE) {
+		in->offset--;
+		return 0;
+	}
+
+	*value = tmp == CBOR_TRUE;
+
+	return 1;
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 uint8_t *value, size_t buflen,
+			 struct lwm2m_opaque_context *opaque,
+			 bool *last_block)
+{
+	int len;
+
+	/* Get the byte string header only on first read. */
+	if (opaque->remaining == 0) {
+		len = get_str_hdr(in, CBOR_MAJOR_BSTR);
+		if (len <= 0) {
+			*last_block = true;
+			return 0;
+		}
+
+		opaque->len = len;
+		opaque->remaining = len;
+	}
+
+	return lwm2m_engine_get_opaque_more(in, value, buflen,
+					    opaque, last_block);
+}
+
+static size_t get_objlnk(struct lwm2m_input_context *in,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("65535:65535")];
+	char *end;
+	size_t len;
+
+	len = get_string(in, buf, sizeof(buf));
+	if (len == 0) {
+		return 0;
+	}
+
+	value->obj_id = strtoul(buf, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+
+	value->obj_inst = strtoul(end + 1, NULL, 10);
+
+	return len;
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+	.put_objlnk = put_objlnk,
+};
+
+const struct lwm2m_reader senml_cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+	.get_objlnk = get_objlnk,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_message *msg, int content_format)
+{
+	struct cbor_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	/* save the level for output processing */
+	fd.path_level = msg->path.level;
+	ret = lwm2m_perform_read_op(msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	/* Do not send a payload with records or the array header missing */
+	if (ret == 0 && fd.no_space) {
+		LOG_ERR("Payload does not fit in the message");
+		ret = -ENOMEM;
+	}
+
+	return ret;
+}
+
+/* Read a name into buf, skip it if it does not fit */
+static int get_name(struct lwm2m_input_context *in, char *buf, size_t buflen)
+{
+	int len;
+
+	len = get_str_hdr(in, CBOR_MAJOR_TSTR);
+	if (len < 0) {
+		return len;
+	}
+
+	if (len >= buflen) {
+		in->offset += len;
+		return -ENOMEM;
+	}
+
+	memcpy(buf, in->in_cpkt->data + in->offset, len);
+	buf[len] = '\0';
+	in->offset += len;
+
+	return 0;
+}
+
+/*
+ * Parse the next record, store its names and point value_offset at its
+ * value. value_offset is left at 0 for records without a value.
+ */
+static int get_record(struct lwm2m_input_context *in,
+		      char *base_name, char *name, uint16_t *value_offset)
+{
+	char key[sizeof("vlo")];
+	uint64_t count, i;
+	uint8_t major;
+	int64_t label;
+	uint64_t tmp;
+	int ret;
+
+	ret = cbor_get_hdr(in, &major, &count);
+	if (ret < 0 || major != CBOR_MAJOR_MAP) {
+		return -EBADMSG;
+	}
+
+	name[0] = '\0';
+	*value_offset = 0U;
+
+	for (i = 0U; count == CBOR_INDEFINITE || i < count; i++) {
+		if (count == CBOR_INDEFINITE && cbor_get_break(in)) {
+			break;
+		}
+
+		ret = cbor_get_hdr(in, &major, &tmp);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (major == CBOR_MAJOR_UINT) {
+			label = (int64_t)tmp;
+		} else if (major == CBOR_MAJOR_NINT) {
+			label = -1 - (int64_t)tmp;
+		} else if (major == CBOR_MAJOR_TSTR) {
+			/* only "vlo" is expected as a string label */
+			in->offset -= ret;
+			ret = get_name(in, key, sizeof(key));
+			if (ret < 0 && ret != -ENOMEM) {
+				return ret;
+			}
+
+			label = (ret == 0 && strcmp(key, "vlo") == 0) ?
+				SENML_LABEL_V : INT64_MIN;
+		} else {
+			return -EBADMSG;
+		}
+
+		if (label == SENML_LABEL_BN) {
+			ret = get_name(in, base_name, MAX_RESOURCE_LEN);
+		} else if (label == SENML_LABEL_N) {
+			ret = get_name(in, name, MAX_RESOURCE_LEN);
+		} else {
+			if (label == SENML_LABEL_V || label == SENML_LABEL_VS ||
+			    label == SENML_LABEL_VB || label == SENML_LABEL_VD) {
+				*value_offset = in->offset;
+			}
+
+			ret = cbor_skip(in, 0);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int do_write_op_senml_cbor(struct lwm2m_message *msg)
+{
+	struct lwm2m_input_context *in = &msg->in;
+	char base_name[MAX_RESOURCE_LEN];
+	char name[MAX_RESOURCE_LEN];
+	char full_name[MAX_RESOURCE_LEN];
+	uint16_t value_offset, offset;
+	uint64_t count, i;
+	uint8_t major;
+	int ret;
+
+	base_name[0] = '\0';
+
+	ret = cbor_get_hdr(in, &major, &count);
+	if (ret < 0 || major != CBOR_MAJOR_ARRAY) {
+		LOG_ERR("Error parsing records!");
+		return -EINVAL;
+	}
+
+	for (i = 0U; count == CBOR_INDEFINITE || i < count; i++) {
+		if (count == CBOR_INDEFINITE && cbor_get_break(in)) {
+			break;
+		}
+
+		ret = get_record(in, base_name, name, &value_offset);
+		if (ret < 0) {
+			LOG_ERR("Error parsing record %u (%d)", (uint32_t)i,
+				ret);
+			return -EINVAL;
+		}
+
+		if (value_offset == 0U) {
+			continue;
+		}
+
+		/* combine base_name + name */
+		ret = snprintk(full_name, sizeof(full_name), "%s%s",
+			       base_name, name);
+		if (ret < 0 || ret >= sizeof(full_name)) {
+			return -EINVAL;
+		}
+
+		/* read the value, then carry on after the record */
+		offset = in->offset;
+		in->offset = value_offset;
+		ret = lwm2m_write_path_handler(msg, full_name);
+		in->offset = offset;
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
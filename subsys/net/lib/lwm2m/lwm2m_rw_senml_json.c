@@ -0,0 +1,1046 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML-JSON (RFC 8428) reader / writer.
+ *
+ * A payload is an array of records, each an object holding the record name
+ * and one value. The base name, "/<obj>/<obj inst>/" or "/<obj>/" for object
+ * level reads, is only carried in the first record, the names of the other
+ * records are relative to it. Opaque values are base64url encoded.
+ *
+ * The writer formats every record straight into the CoAP packet buffer.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_json
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_json.h"
+#include "lwm2m_engine.h"
+
+/* Record prefix and a formatted number */
+#define RECORD_BUF_LEN		96
+
+/* Chunk size for escaped strings and base64url data */
+#define CHUNK_LEN		32
+
+/* Longest label, "vlo", and a character to tell longer ones apart */
+#define LABEL_LEN		5
+
+struct json_out_formatter_data {
+	/* number of records written */
+	uint16_t record_count;
+
+	/* flags */
+	uint8_t writer_flags;
+
+	/* path storage */
+	uint8_t path_level;
+
+	/* the payload did not fit in the packet */
+	bool no_space;
+};
+
+static const char base64url[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static uint8_t put_u64(char *buf, uint64_t value)
+{
+	char tmp[20];
+	uint8_t len = 0U, i = 0U;
+
+	do {
+		tmp[len++] = '0' + value % 10U;
+		value /= 10U;
+	} while (value > 0U);
+
+	while (len > 0U) {
+		buf[i++] = tmp[--len];
+	}
+
+	return i;
+}
+
+static uint8_t put_s64_text(char *buf, int64_t value)
+{
+	if (value < 0) {
+		buf[0] = '-';
+		return 1 + put_u64(buf + 1, (uint64_t)-(value + 1) + 1U);
+	}
+
+	return put_u64(buf, value);
+}
+
+/* Format a fixed point value with digits decimals, without trailing zeros */
+static uint8_t put_fixed(char *buf, int64_t val1, int64_t val2,
+			 uint8_t digits)
+{
+	uint8_t len = 0U;
+	uint64_t frac;
+	int i;
+
+	/* handle negative val2 when val1 is 0 */
+	if (val1 == 0 && val2 < 0) {
+		buf[len++] = '-';
+	}
+
+	len += put_s64_text(buf + len, val1);
+	buf[len++] = '.';
+
+	frac = val2 < 0 ? -val2 : val2;
+	for (i = digits - 1; i >= 0; i--) {
+		buf[len + i] = '0' + frac % 10U;
+		frac /= 10U;
+	}
+
+	/* clear ending zeroes, but leave 1 if needed */
+	while (digits > 1U && buf[len + digits - 1] == '0') {
+		digits--;
+	}
+
+	return len + digits;
+}
+
+static uint8_t put_str(char *buf, const char *str)
+{
+	uint8_t len = strlen(str);
+
+	memcpy(buf, str, len);
+
+	return len;
+}
+
+/*
+ * Format the record opening, the names and the value label into buf,
+ * return the formatted length.
+ */
+static uint8_t put_record_prefix(struct json_out_formatter_data *fd,
+				 struct lwm2m_obj_path *path,
+				 const char *label, char *buf)
+{
+	uint8_t len;
+
+	if (fd->record_count == 0U) {
+		/* the first record also carries the base name */
+		len = put_str(buf, "{\"bn\":\"/");
+		len += put_u64(buf + len, path->obj_id);
+		buf[len++] = '/';
+		if (fd->path_level >= 2U) {
+			len += put_u64(buf + len, path->obj_inst_id);
+			buf[len++] = '/';
+		}
+
+		len += put_str(buf + len, "\",\"n\":\"");
+	} else {
+		len = put_str(buf, ",{\"n\":\"");
+	}
+
+	if (fd->path_level < 2U) {
+		len += put_u64(buf + len, path->obj_inst_id);
+		buf[len++] = '/';
+	}
+
+	len += put_u64(buf + len, path->res_id);
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		buf[len++] = '/';
+		len += put_u64(buf + len, path->res_inst_id);
+	}
+
+	len += put_str(buf + len, "\",\"");
+	len += put_str(buf + len, label);
+	len += put_str(buf + len, "\":");
+
+	return len;
+}
+
+static int append(struct lwm2m_output_context *out, const char *buf,
+		  uint16_t len)
+{
+	return buf_append(CPKT_BUF_WRITE(out->out_cpkt), (uint8_t *)buf, len);
+}
+
+/* Append a record holding a scalar value */
+static size_t put_record(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path, const char *label,
+			 const char *value, uint8_t value_len)
+{
+	struct json_out_formatter_data *fd;
+	char buf[RECORD_BUF_LEN];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, label, buf);
+	memcpy(buf + len, value, value_len);
+	len += value_len;
+	buf[len++] = '}';
+
+	if (append(out, buf, len) < 0) {
+		fd->no_space = true;
+		return 0;
+	}
+
+	fd->record_count++;
+
+	return len;
+}
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct json_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->record_count = 0U;
+
+	if (append(out, "[", 1) < 0) {
+		fd->no_space = true;
+		return 0;
+	}
+
+	return 1;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct json_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	if (append(out, "]", 1) < 0) {
+		fd->no_space = true;
+		return 0;
+	}
+
+	return 1;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct json_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct json_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int64_t value)
+{
+	char buf[sizeof("-9223372036854775808")];
+
+	return put_record(out, path, "v", buf, put_s64_text(buf, value));
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int32_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int16_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, int8_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	char buf[sizeof("-2147483648.000000")];
+
+	return put_record(out, path, "v", buf,
+			  put_fixed(buf, value->val1, value->val2, 6));
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	char buf[sizeof("-9223372036854775808.000000000")];
+
+	return put_record(out, path, "v", buf,
+			  put_fixed(buf, value->val1, value->val2, 9));
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	return value ? put_record(out, path, "vb", "true", 4) :
+		       put_record(out, path, "vb", "false", 5);
+}
+
+static size_t put_objlnk(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("\"65535:65535\"")];
+	uint8_t len;
+
+	buf[0] = '"';
+	len = 1U + put_u64(buf + 1, value->obj_id);
+	buf[len++] = ':';
+	len += put_u64(buf + len, value->obj_inst);
+	buf[len++] = '"';
+
+	return put_record(out, path, "vlo", buf, len);
+}
+
+/*
+ * Append a record holding a quoted value, formatted in chunks by the
+ * encode callback. Nothing is left in the packet when it does not fit.
+ */
+static size_t put_quoted(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path, const char *label,
+			 const uint8_t *data, size_t data_len,
+			 uint8_t (*encode)(char *chunk, const uint8_t *data,
+					   size_t *pos, size_t data_len))
+{
+	struct json_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	char buf[RECORD_BUF_LEN];
+	size_t pos = 0;
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	len = put_record_prefix(fd, path, label, buf);
+	buf[len++] = '"';
+	if (append(out, buf, len) < 0) {
+		goto error;
+	}
+
+	while (pos < data_len) {
+		len = encode(buf, data, &pos, data_len);
+		if (append(out, buf, len) < 0) {
+			goto error;
+		}
+	}
+
+	if (append(out, "\"}", 2) < 0) {
+		goto error;
+	}
+
+	fd->record_count++;
+
+	return out->out_cpkt->offset - start;
+
+error:
+	out->out_cpkt->offset = start;
+	fd->no_space = true;
+	return 0;
+}
+
+/* Escape up to CHUNK_LEN bytes of a string */
+static uint8_t encode_string(char *chunk, const uint8_t *data, size_t *pos,
+			     size_t data_len)
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8_t len = 0U;
+	uint8_t c;
+
+	/* an escaped character takes up to 6 bytes */
+	while (*pos < data_len && len <= CHUNK_LEN - 6) {
+		c = data[(*pos)++];
+		if (c == '"' || c == '\\') {
+			chunk[len++] = '\\';
+			chunk[len++] = c;
+		} else if (c < 0x20) {
+			len += put_str(chunk + len, "\\u00");
+			chunk[len++] = hex[c >> 4];
+			chunk[len++] = hex[c & 0xf];
+		} else {
+			chunk[len++] = c;
+		}
+	}
+
+	return len;
+}
+
+/* Base64url encode up to CHUNK_LEN bytes of data, without padding */
+static uint8_t encode_base64url(char *chunk, const uint8_t *data, size_t *pos,
+				size_t data_len)
+{
+	uint8_t len = 0U;
+	uint32_t bits;
+	size_t n;
+
+	while (*pos < data_len && len <= CHUNK_LEN - 4) {
+		n = MIN(data_len - *pos, 3);
+		bits = data[*pos] << 16;
+		if (n > 1) {
+			bits |= data[*pos + 1] << 8;
+		}
+
+		if (n > 2) {
+			bits |= data[*pos + 2];
+		}
+
+		chunk[len++] = base64url[(bits >> 18) & 0x3f];
+		chunk[len++] = base64url[(bits >> 12) & 0x3f];
+		if (n > 1) {
+			chunk[len++] = base64url[(bits >> 6) & 0x3f];
+		}
+
+		if (n > 2) {
+			chunk[len++] = base64url[bits & 0x3f];
+		}
+
+		*pos += n;
+	}
+
+	return len;
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_quoted(out, path, "vs", buf, buflen, encode_string);
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_quoted(out, path, "vd", buf, buflen, encode_base64url);
+}
+
+static int peek_char(struct lwm2m_input_context *in)
+{
+	if (in->offset >= in->in_cpkt->offset) {
+		return -1;
+	}
+
+	return in->in_cpkt->data[in->offset];
+}
+
+static int next_char(struct lwm2m_input_context *in)
+{
+	int c = peek_char(in);
+
+	if (c >= 0) {
+		in->offset++;
+	}
+
+	return c;
+}
+
+/* Skip whitespace, return the next character without consuming it */
+static int skip_ws(struct lwm2m_input_context *in)
+{
+	int c;
+
+	while ((c = peek_char(in)) == ' ' || c == '\t' || c == '\n' ||
+	       c == '\r') {
+		in->offset++;
+	}
+
+	return c;
+}
+
+/* Read the exponent of a number, starting at the 'e' */
+static int read_exponent(struct lwm2m_input_context *in, int *exp)
+{
+	uint16_t start;
+	bool neg;
+	int c;
+
+	in->offset++;
+	neg = peek_char(in) == '-';
+	if (neg || peek_char(in) == '+') {
+		in->offset++;
+	}
+
+	start = in->offset;
+	while ((c = peek_char(in)) >= 0 && isdigit(c)) {
+		/* anything larger is out of range anyway */
+		if (*exp < 1000) {
+			*exp = *exp * 10 + (c - '0');
+		}
+
+		in->offset++;
+	}
+
+	if (in->offset == start) {
+		return -EBADMSG;
+	}
+
+	if (neg) {
+		*exp = -*exp;
+	}
+
+	return 0;
+}
+
+/* Read a number, the fraction scaled to frac_max */
+static size_t read_number(struct lwm2m_input_context *in,
+			  int64_t *value1, int64_t *value2, int64_t frac_max)
+{
+	uint16_t start = in->offset;
+	int64_t scale = LWM2M_FLOAT64_DEC_MAX;
+	int64_t frac = 0;
+	bool neg = false;
+	int exp = 0;
+	int c;
+
+	*value1 = 0;
+
+	if (peek_char(in) == '-') {
+		neg = true;
+		in->offset++;
+	}
+
+	while ((c = peek_char(in)) >= 0 && isdigit(c)) {
+		*value1 = *value1 * 10 + (c - '0');
+		in->offset++;
+	}
+
+	if (c == '.') {
+		in->offset++;
+		while ((c = peek_char(in)) >= 0 && isdigit(c)) {
+			scale /= 10;
+			frac += (c - '0') * scale;
+			in->offset++;
+		}
+	}
+
+	if (in->offset == start + neg) {
+		/* no digits */
+		goto error;
+	}
+
+	if (c == 'e' || c == 'E') {
+		if (read_exponent(in, &exp) < 0) {
+			goto error;
+		}
+	}
+
+	/* move the decimal point, saturate when out of range */
+	for (; exp > 0; exp--) {
+		if (*value1 > INT64_MAX / 10 - 10) {
+			*value1 = INT64_MAX;
+			frac = 0;
+			break;
+		}
+
+		frac *= 10;
+		*value1 = *value1 * 10 + frac / LWM2M_FLOAT64_DEC_MAX;
+		frac %= LWM2M_FLOAT64_DEC_MAX;
+	}
+
+	for (; exp < 0 && (*value1 > 0 || frac > 0); exp++) {
+		frac = (*value1 % 10) * (LWM2M_FLOAT64_DEC_MAX / 10) +
+		       frac / 10;
+		*value1 /= 10;
+	}
+
+	frac /= LWM2M_FLOAT64_DEC_MAX / frac_max;
+
+	if (neg) {
+		*value1 = -*value1;
+
+		/* handle negative val2 when val1 is 0 */
+		if (*value1 == 0) {
+			frac = -frac;
+		}
+	}
+
+	if (value2) {
+		*value2 = frac;
+	}
+
+	return in->offset - start;
+
+error:
+	in->offset = start;
+	return 0;
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, int64_t *value)
+{
+	return read_number(in, value, NULL, 1);
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, int32_t *value)
+{
+	int64_t tmp = 0;
+	size_t len;
+
+	len = read_number(in, &tmp, NULL, 1);
+	if (len > 0) {
+		*value = (int32_t)tmp;
+	}
+
+	return len;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	int64_t tmp1, tmp2;
+	size_t len;
+
+	len = read_number(in, &tmp1, &tmp2, LWM2M_FLOAT32_DEC_MAX);
+	if (len > 0) {
+		value->val1 = (int32_t)tmp1;
+		value->val2 = (int32_t)tmp2;
+	}
+
+	return len;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	return read_number(in, &value->val1, &value->val2,
+			   LWM2M_FLOAT64_DEC_MAX);
+}
+
+static int hex_value(uint8_t c)
+{
+	if (isdigit(c)) {
+		return c - '0';
+	}
+
+	return (tolower(c) - 'a' + 10) & 0xf;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen)
+{
+	uint16_t start = in->offset;
+	size_t len = 0;
+	int c;
+
+	if (buflen == 0 || next_char(in) != '"') {
+		goto error;
+	}
+
+	while ((c = next_char(in)) != '"') {
+		if (c < 0) {
+			goto error;
+		}
+
+		if (c == '\\') {
+			c = next_char(in);
+			switch (c) {
+			case 'b':
+				c = '\b';
+				break;
+			case 'f':
+				c = '\f';
+				break;
+			case 'n':
+				c = '\n';
+				break;
+			case 'r':
+				c = '\r';
+				break;
+			case 't':
+				c = '\t';
+				break;
+			case 'u':
+				/* only the ASCII range is supported */
+				if (in->offset + 4 > in->in_cpkt->offset) {
+					goto error;
+				}
+
+				c = hex_value(in->in_cpkt->data[in->offset + 2]) << 4 |
+				    hex_value(in->in_cpkt->data[in->offset + 3]);
+				in->offset += 4;
+				break;
+			default:
+				if (c < 0) {
+					goto error;
+				}
+
+				break;
+			}
+		}
+
+		if (len < buflen - 1) {
+			buf[len++] = c;
+		}
+	}
+
+	buf[len] = '\0';
+
+	return in->offset - start;
+
+error:
+	in->offset = start;
+	return 0;
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	uint16_t remaining = in->in_cpkt->offset - in->offset;
+	uint8_t *buf = in->in_cpkt->data + in->offset;
+
+	if (remaining >= 4 && strncmp(buf, "true", 4) == 0) {
+		*value = true;
+		in->offset += 4;
+		return 4;
+	}
+
+	if (remaining >= 5 && strncmp(buf, "false", 5) == 0) {
+		*value = false;
+		in->offset += 5;
+		return 5;
+	}
+
+	return 0;
+}
+
+static int base64url_value(int c)
+{
+	if (c == '+') {
+		return 62;
+	}
+
+	if (c == '/') {
+		return 63;
+	}
+
+	if (c <= 0 || !strchr(base64url, c)) {
+		return -1;
+	}
+
+	return strchr(base64url, c) - base64url;
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 uint8_t *value, size_t buflen,
+			 struct lwm2m_opaque_context *opaque,
+			 bool *last_block)
+{
+	uint32_t bits = 0U;
+	size_t len = 0;
+	int c, nbits = 0;
+
+	/* the whole value is decoded in one go */
+	*last_block = true;
+
+	if (next_char(in) != '"') {
+		return 0;
+	}
+
+	while ((c = base64url_value(peek_char(in))) >= 0) {
+		in->offset++;
+		bits = (bits << 6) | c;
+		nbits += 6;
+		if (nbits < 8) {
+			continue;
+		}
+
+		nbits -= 8;
+		if (len < buflen) {
+			value[len++] = bits >> nbits;
+		}
+	}
+
+	/* skip padding and the closing quote */
+	while ((c = next_char(in)) == '=') {
+	}
+
+	if (c != '"') {
+		return 0;
+	}
+
+	opaque->len = len;
+	opaque->remaining = 0U;
+
+	return len;
+}
+
+static size_t get_objlnk(struct lwm2m_input_context *in,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("65535:65535")];
+	char *end;
+	size_t len;
+
+	len = get_string(in, buf, sizeof(buf));
+	if (len == 0) {
+		return 0;
+	}
+
+	value->obj_id = strtoul(buf, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+
+	value->obj_inst = strtoul(end + 1, NULL, 10);
+
+	return len;
+}
+
+const struct lwm2m_writer senml_json_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+	.put_objlnk = put_objlnk,
+};
+
+const struct lwm2m_reader senml_json_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+	.get_objlnk = get_objlnk,
+};
+
+int do_read_op_senml_json(struct lwm2m_message *msg, int content_format)
+{
+	struct json_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	/* save the level for output processing */
+	fd.path_level = msg->path.level;
+	ret = lwm2m_perform_read_op(msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	/* Do not send a payload with records or the brackets missing */
+	if (ret == 0 && fd.no_space) {
+		LOG_ERR("Payload does not fit in the message");
+		ret = -ENOMEM;
+	}
+
+	return ret;
+}
+
+/* Skip a string or a scalar value */
+static int skip_value(struct lwm2m_input_context *in)
+{
+	int c;
+
+	if (peek_char(in) == '"') {
+		in->offset++;
+		while ((c = next_char(in)) != '"') {
+			if (c == '\\') {
+				c = next_char(in);
+			}
+
+			if (c < 0) {
+				return -EBADMSG;
+			}
+		}
+
+		return 0;
+	}
+
+	while ((c = peek_char(in)) >= 0 && c != ',' && c != '}' &&
+	       c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+		if (c == '{' || c == '[') {
+			return -EBADMSG;
+		}
+
+		in->offset++;
+	}
+
+	return c < 0 ? -EBADMSG : 0;
+}
+
+/* Read a name into a MAX_RESOURCE_LEN buffer, fail if it does not fit */
+static int get_name(struct lwm2m_input_context *in, char *buf)
+{
+	char tmp[MAX_RESOURCE_LEN + 1];
+
+	if (get_string(in, tmp, sizeof(tmp)) == 0) {
+		return -EBADMSG;
+	}
+
+	if (strlen(tmp) >= MAX_RESOURCE_LEN) {
+		return -ENOMEM;
+	}
+
+	strcpy(buf, tmp);
+
+	return 0;
+}
+
+/*
+ * Parse the next record, store its names and point value_offset at its
+ * value. value_offset is left at 0 for records without a value.
+ */
+static int get_record(struct lwm2m_input_context *in,
+		      char *base_name, char *name, uint16_t *value_offset)
+{
+	char label[LABEL_LEN];
+	int ret, c;
+
+	if (next_char(in) != '{') {
+		return -EBADMSG;
+	}
+
+	name[0] = '\0';
+	*value_offset = 0U;
+
+	if (skip_ws(in) == '}') {
+		in->offset++;
+		return 0;
+	}
+
+	do {
+		skip_ws(in);
+		if (get_string(in, label, sizeof(label)) == 0 ||
+		    skip_ws(in) != ':') {
+			return -EBADMSG;
+		}
+
+		in->offset++;
+		skip_ws(in);
+
+		if (strcmp(label, "bn") == 0) {
+			ret = get_name(in, base_name);
+		} else if (strcmp(label, "n") == 0) {
+			ret = get_name(in, name);
+		} else {
+			if (strcmp(label, "v") == 0 ||
+			    strcmp(label, "vs") == 0 ||
+			    strcmp(label, "vb") == 0 ||
+			    strcmp(label, "vd") == 0 ||
+			    strcmp(label, "vlo") == 0) {
+				*value_offset = in->offset;
+			}
+
+			ret = skip_value(in);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		c = skip_ws(in);
+		in->offset++;
+	} while (c == ',');
+
+	return c == '}' ? 0 : -EBADMSG;
+}
+
+int do_write_op_senml_json(struct lwm2m_message *msg)
+{
+	struct lwm2m_input_context *in = &msg->in;
+	char base_name[MAX_RESOURCE_LEN];
+	char name[MAX_RESOURCE_LEN];
+	char full_name[MAX_RESOURCE_LEN];
+	uint16_t value_offset, offset;
+	int ret, c;
+
+	base_name[0] = '\0';
+
+	if (skip_ws(in) != '[') {
+		LOG_ERR("Error parsing records!");
+		return -EINVAL;
+	}
+
+	in->offset++;
+	if (skip_ws(in) == ']') {
+		return 0;
+	}
+
+	do {
+		skip_ws(in);
+		ret = get_record(in, base_name, name, &value_offset);
+		if (ret < 0) {
+			LOG_ERR("Error parsing record (%d)", ret);
+			return -EINVAL;
+		}
+
+		c = skip_ws(in);
+		in->offset++;
+
+		if (value_offset == 0U) {
+			continue;
+		}
+
+		/* combine base_name + name */
+		ret = snprintk(full_name, sizeof(full_name), "%s%s",
+			       base_name, name);
+		if (ret < 0 || ret >= sizeof(full_name)) {
+			return -EINVAL;
+		}
+
+		/* read the value, then carry on after the record */
+		offset = in->offset;
+		in->offset = value_offset;
+		ret = lwm2m_write_path_handler(msg, full_name);
+		in->offset = offset;
+
+		if (ret < 0) {
+			return ret;
+		}
+	} while (c == ',');
+
+	return c == ']' ? 0 : -EINVAL;
+}
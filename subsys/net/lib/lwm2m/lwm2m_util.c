@@ -108,7 +108,7 @@ int lwm2m_f64_to_b64(float64_value_t *f64, uint8_t *b64, size_t len)
 	}
 
 	/* sign handled later */
-	v = abs(f64->val1);
+	v = llabs(f64->val1);
 
 	/* add whole value to fraction */
 	while (v > 0) {
@@ -123,7 +123,7 @@ int lwm2m_f64_to_b64(float64_value_t *f64, uint8_t *b64, size_t len)
 	}
 
 	/* sign handled later */
-	v = abs(f64->val2);
+	v = llabs(f64->val2);
 
 	/* add decimal to fraction */
 	i = e;
@@ -197,19 +197,19 @@ int lwm2m_b32_to_f32(uint8_t *b32, size_t len, float32_value_t *f32)
 	e -= 127;
 
 	/* enable "hidden" fraction bit 23 which is always 1 */
-	f  = ((int32_t)1 << 22);
+	f  = ((int32_t)1 << 23);
 	/* calc fraction: bits 22-0 */
 	f += ((int32_t)(b32[1] & 0x7F) << 16);
 	f += ((int32_t)b32[2] << 8);
 	f += b32[3];
 
 	/* handle whole number */
-	if (e > -1) {
-		/* precision overflow */
-		if (e > 23) {
-			e = 23;
-		}
-
+	if (e > 30) {
+		/* out of range, saturate */
+		f32->val1 = sign ? INT32_MIN : INT32_MAX;
+	} else if (e > 23) {
+		f32->val1 = (f << (e - 23)) * (sign ? -1 : 1);
+	} else if (e > -1) {
 		f32->val1 = (f >> (23 - e)) * (sign ? -1 : 1);
 	}
 
@@ -230,6 +230,11 @@ int lwm2m_b32_to_f32(uint8_t *b32, size_t len, float32_value_t *f32)
 		}
 	}
 
+	/* handle negative val2 when val1 is 0 */
+	if (sign && f32->val1 == 0) {
+		f32->val2 = -f32->val2;
+	}
+
 	return 0;
 }
 
@@ -268,12 +273,12 @@ int lwm2m_b64_to_f64(uint8_t *b64, size_t len, float64_value_t *f64)
 	f += b64[7];
 
 	/* handle whole number */
-	if (e > -1) {
-		/* precision overflow */
-		if (e > 52) {
-			e = 52;
-		}
-
+	if (e > 62) {
+		/* out of range, saturate */
+		f64->val1 = sign ? INT64_MIN : INT64_MAX;
+	} else if (e > 52) {
+		f64->val1 = (f << (e - 52)) * (sign ? -1 : 1);
+	} else if (e > -1) {
 		f64->val1 = (f >> (52 - e)) * (sign ? -1 : 1);
 	}
 
@@ -294,5 +299,10 @@ int lwm2m_b64_to_f64(uint8_t *b64, size_t len, float64_value_t *f64)
 		}
 	}
 
+	/* handle negative val2 when val1 is 0 */
+	if (sign && f64->val1 == 0) {
+		f64->val2 = -f64->val2;
+	}
+
 	return 0;
 }
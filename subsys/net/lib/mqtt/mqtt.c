@@ -261,6 +261,15 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+	/* The id is still used by a message of the outbound queue */
+	if (param->message.topic.qos != MQTT_QOS_0_AT_MOST_ONCE &&
+	    mqtt_outbox_holds(client, param->message_id)) {
+		err_code = -EBUSY;
+		goto error;
+	}
+#endif
+
 	err_code = publish_encode(param, &packet);
 	if (err_code < 0) {
 		goto error;
@@ -287,6 +296,63 @@ error:
 	return err_code;
 }
 
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+int mqtt_outbox_publish(struct mqtt_client *client,
+			const struct mqtt_publish_param *param)
+{
+	int err_code, message_id;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(param);
+
+	MQTT_TRC("[CID %p]:[State 0x%02x]: >> Topic size 0x%08x, "
+		 "Data size 0x%08x", client, client->internal.state,
+		 param->message.topic.topic.size,
+		 param->message.payload.len);
+
+	mqtt_mutex_lock(client);
+
+	message_id = mqtt_outbox_enqueue(client, param);
+	if (message_id < 0) {
+		goto error;
+	}
+
+	/* If not connected yet, the message is sent after CONNACK. */
+	if (!MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		goto error;
+	}
+
+	/* On failure the message stays queued for the next connection. */
+	err_code = mqtt_outbox_flush(client);
+	if (err_code < 0) {
+		MQTT_TRC("Transport write failed, err_code = %d, "
+			 "closing connection", err_code);
+		client_disconnect(client, err_code, true);
+	}
+
+error:
+	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
+		 client, client->internal.state, message_id);
+
+	mqtt_mutex_unlock(client);
+
+	return message_id;
+}
+
+int mqtt_outbox_pending(struct mqtt_client *client)
+{
+	int pending;
+
+	NULL_PARAM_CHECK(client);
+
+	mqtt_mutex_lock(client);
+	pending = mqtt_outbox_count(client);
+	mqtt_mutex_unlock(client);
+
+	return pending;
+}
+#endif /* CONFIG_MQTT_LIB_OUTBOX */
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
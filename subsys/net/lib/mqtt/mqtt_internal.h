@@ -393,6 +393,62 @@ int subscribe_ack_decode(struct buf_ctx *buf,
 int unsubscribe_ack_decode(struct buf_ctx *buf,
 			   struct mqtt_unsuback_param *param);
 
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+/**@brief Encode a publish message into the outbound queue.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] param Publish message parameters.
+ *
+ * @return Message id of the queued message, an error code otherwise.
+ */
+int mqtt_outbox_enqueue(struct mqtt_client *client,
+			const struct mqtt_publish_param *param);
+
+/**@brief Write the queued messages the in-flight window allows, and the
+ *        pending PUBREL packets, to the transport.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_outbox_flush(struct mqtt_client *client);
+
+/**@brief Update the outbound queue on reception of PUBACK, PUBREC or
+ *        PUBCOMP.
+ *
+ * @param[in] client Identifies the client for which the packet was received.
+ * @param[in] type Packet type.
+ * @param[in] message_id Message id of the packet.
+ */
+void mqtt_outbox_ack(struct mqtt_client *client, uint8_t type,
+		     uint16_t message_id);
+
+/**@brief Prepare the messages that were not acknowledged on the previous
+ *        connection for retransmission.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ */
+void mqtt_outbox_reconnect(struct mqtt_client *client);
+
+/**@brief Check if a message id is used by a message of the outbound queue
+ *        not delivered yet.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] message_id Message id to look for.
+ *
+ * @return true if the message id is in use, false otherwise.
+ */
+bool mqtt_outbox_holds(struct mqtt_client *client, uint16_t message_id);
+
+/**@brief Count the messages in the outbound queue not delivered yet.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ *
+ * @return Number of pending messages.
+ */
+int mqtt_outbox_count(struct mqtt_client *client);
+#endif /* CONFIG_MQTT_LIB_OUTBOX */
+
 #ifdef __cplusplus
 }
 #endif
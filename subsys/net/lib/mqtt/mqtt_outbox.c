@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file mqtt_outbox.c
+ *
+ * @brief Outbound queue of MQTT publish messages.
+ *
+ * Messages are encoded into the application provided outbox buffer, which
+ * is used as a ring: a message is stored contiguously after the newest one
+ * and its space is released once it and all the older messages are
+ * delivered. Up to CONFIG_MQTT_OUTBOX_INFLIGHT_MAX QoS 1 and QoS 2 messages
+ * can wait for acknowledgment at the same time.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_mqtt_outbox, CONFIG_MQTT_LOG_LEVEL);
+
+#include <string.h>
+
+#include "mqtt_transport.h"
+#include "mqtt_internal.h"
+#include "mqtt_os.h"
+
+/* Maximum number of packets written with one transport write */
+#define OUTBOX_BATCH_MAX 8
+
+/* Buffer needed to encode a PUBREL packet */
+#define PUBREL_BUF_LEN (MQTT_FIXED_HEADER_MAX_SIZE + sizeof(uint16_t))
+
+enum outbox_state {
+	/* Delivered, kept only until the older messages are delivered */
+	OUTBOX_FREE,
+
+	/* Waiting to be sent */
+	OUTBOX_QUEUED,
+
+	/* Sent, waiting for PUBACK or PUBREC */
+	OUTBOX_WAIT_ACK,
+
+	/* PUBREC received, PUBREL waiting to be sent */
+	OUTBOX_RELEASE,
+
+	/* PUBREL sent, waiting for PUBCOMP */
+	OUTBOX_WAIT_COMP,
+};
+
+static struct mqtt_outbox_entry *outbox_entry(struct mqtt_outbox *outbox,
+					      int index)
+{
+	return &outbox->entries[(outbox->first + index) %
+				CONFIG_MQTT_OUTBOX_MSG_MAX];
+}
+
+/* Release the space of the oldest delivered messages */
+static void outbox_release(struct mqtt_outbox *outbox)
+{
+	while (outbox->count > 0 &&
+	       outbox_entry(outbox, 0)->state == OUTBOX_FREE) {
+		outbox->first = (outbox->first + 1) % CONFIG_MQTT_OUTBOX_MSG_MAX;
+		outbox->count--;
+	}
+}
+
+static void outbox_free(struct mqtt_outbox *outbox,
+			struct mqtt_outbox_entry *entry)
+{
+	entry->state = OUTBOX_FREE;
+	outbox_release(outbox);
+}
+
+/* Find len contiguous bytes after the newest message */
+static int outbox_alloc(struct mqtt_client *client, uint32_t len,
+			uint32_t *offset)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_outbox_entry *newest;
+	uint32_t head, tail;
+
+	if (outbox->count == 0) {
+		head = 0U;
+		tail = 0U;
+	} else {
+		newest = outbox_entry(outbox, outbox->count - 1);
+		head = outbox_entry(outbox, 0)->offset;
+		tail = newest->offset + newest->len;
+	}
+
+	if (outbox->count == 0 || tail > head) {
+		/* Used space is [head, tail), try after it, then before it */
+		if (client->outbox_buf_size - tail >= len) {
+			*offset = tail;
+			return 0;
+		}
+
+		if (head >= len) {
+			*offset = 0U;
+			return 0;
+		}
+	} else if (head - tail >= len) {
+		/* Used space wraps around, only [tail, head) is free */
+		*offset = tail;
+		return 0;
+	}
+
+	return -ENOBUFS;
+}
+
+int mqtt_outbox_enqueue(struct mqtt_client *client,
+			const struct mqtt_publish_param *param)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_publish_param msg = *param;
+	struct mqtt_outbox_entry *entry;
+	struct buf_ctx packet;
+	uint32_t offset, len;
+	int err_code;
+
+	if (client->outbox_buf == NULL) {
+		return -ENOMEM;
+	}
+
+	if (outbox->count == CONFIG_MQTT_OUTBOX_MSG_MAX) {
+		return -ENOBUFS;
+	}
+
+	if (msg.message.payload.len > MQTT_MAX_PAYLOAD_SIZE) {
+		return -EMSGSIZE;
+	}
+
+	/* The acknowledgments of two messages with the same id could not be
+	 * told apart.
+	 */
+	if (msg.message.topic.qos != MQTT_QOS_0_AT_MOST_ONCE &&
+	    msg.message_id != 0U && mqtt_outbox_holds(client, msg.message_id)) {
+		return -EBUSY;
+	}
+
+	/* publish_encode() reserves room for the largest fixed header and
+	 * puts the actual one right before the variable header.
+	 */
+	len = MQTT_FIXED_HEADER_MAX_SIZE +
+	      GET_UT8STR_BUFFER_SIZE(&msg.message.topic.topic) +
+	      (msg.message.topic.qos ? sizeof(uint16_t) : 0) +
+	      msg.message.payload.len;
+
+	err_code = outbox_alloc(client, len, &offset);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	if (msg.message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		msg.message_id = 0U;
+	} else if (msg.message_id == 0U) {
+		/* At most CONFIG_MQTT_OUTBOX_MSG_MAX - 1 ids are in use */
+		do {
+			if (++outbox->next_message_id == 0U) {
+				outbox->next_message_id = 1U;
+			}
+		} while (mqtt_outbox_holds(client, outbox->next_message_id));
+
+		msg.message_id = outbox->next_message_id;
+	}
+
+	packet.cur = client->outbox_buf + offset;
+	packet.end = packet.cur + len;
+
+	err_code = publish_encode(&msg, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	memcpy(packet.end, msg.message.payload.data, msg.message.payload.len);
+
+	entry = outbox_entry(outbox, outbox->count++);
+	entry->offset = packet.cur - client->outbox_buf;
+	entry->len = packet.end - packet.cur + msg.message.payload.len;
+	entry->message_id = msg.message_id;
+	entry->state = OUTBOX_QUEUED;
+
+	MQTT_TRC("[CID %p]: Queued message id 0x%04x, %u bytes", client,
+		 entry->message_id, entry->len);
+
+	return entry->message_id;
+}
+
+bool mqtt_outbox_holds(struct mqtt_client *client, uint16_t message_id)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_outbox_entry *entry;
+	int i;
+
+	for (i = 0; i < outbox->count; i++) {
+		entry = outbox_entry(outbox, i);
+		if (entry->state != OUTBOX_FREE &&
+		    entry->message_id == message_id) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int mqtt_outbox_count(struct mqtt_client *client)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	int i, pending = 0;
+
+	for (i = 0; i < outbox->count; i++) {
+		if (outbox_entry(outbox, i)->state != OUTBOX_FREE) {
+			pending++;
+		}
+	}
+
+	return pending;
+}
+
+void mqtt_outbox_ack(struct mqtt_client *client, uint8_t type,
+		     uint16_t message_id)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_outbox_entry *entry;
+	int i;
+
+	if (message_id == 0U) {
+		return;
+	}
+
+	for (i = 0; i < outbox->count; i++) {
+		entry = outbox_entry(outbox, i);
+		if (entry->message_id != message_id) {
+			continue;
+		}
+
+		if (type == MQTT_PKT_TYPE_PUBACK &&
+		    entry->state == OUTBOX_WAIT_ACK) {
+			outbox_free(outbox, entry);
+		} else if (type == MQTT_PKT_TYPE_PUBREC &&
+			   entry->state == OUTBOX_WAIT_ACK) {
+			entry->state = OUTBOX_RELEASE;
+		} else if (type == MQTT_PKT_TYPE_PUBCOMP &&
+			   (entry->state == OUTBOX_WAIT_COMP ||
+			    entry->state == OUTBOX_RELEASE)) {
+			outbox_free(outbox, entry);
+		} else {
+			continue;
+		}
+
+		return;
+	}
+}
+
+void mqtt_outbox_reconnect(struct mqtt_client *client)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_outbox_entry *entry;
+	int i;
+
+	for (i = 0; i < outbox->count; i++) {
+		entry = outbox_entry(outbox, i);
+
+		if (entry->state == OUTBOX_WAIT_ACK) {
+			client->outbox_buf[entry->offset] |=
+							MQTT_HEADER_DUP_MASK;
+			entry->state = OUTBOX_QUEUED;
+		} else if (entry->state == OUTBOX_WAIT_COMP) {
+			entry->state = OUTBOX_RELEASE;
+		}
+	}
+}
+
+static int outbox_write(struct mqtt_client *client,
+			struct mqtt_outbox_entry **batch,
+			struct iovec *io_vector, int count)
+{
+	struct msghdr msg;
+	int err_code, i;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = count;
+
+	MQTT_TRC("[%p]: Transport writing %d messages.", client, count);
+
+	err_code = mqtt_transport_write_msg(client, &msg);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+	for (i = 0; i < count; i++) {
+		if (batch[i]->state == OUTBOX_RELEASE) {
+			batch[i]->state = OUTBOX_WAIT_COMP;
+		} else if (batch[i]->message_id != 0U) {
+			batch[i]->state = OUTBOX_WAIT_ACK;
+		} else {
+			/* Released by the caller, which is still walking
+			 * through the entries.
+			 */
+			batch[i]->state = OUTBOX_FREE;
+		}
+	}
+
+	return 0;
+}
+
+int mqtt_outbox_flush(struct mqtt_client *client)
+{
+	struct mqtt_outbox *outbox = &client->internal.outbox;
+	struct mqtt_outbox_entry *batch[OUTBOX_BATCH_MAX];
+	struct iovec io_vector[OUTBOX_BATCH_MAX];
+	uint8_t pubrel[OUTBOX_BATCH_MAX][PUBREL_BUF_LEN];
+	struct mqtt_outbox_entry *entry;
+	bool window_full = false;
+	int inflight = 0, count = 0, i, err_code = 0;
+
+	for (i = 0; i < outbox->count; i++) {
+		entry = outbox_entry(outbox, i);
+		if (entry->state != OUTBOX_FREE &&
+		    entry->state != OUTBOX_QUEUED) {
+			inflight++;
+		}
+	}
+
+	for (i = 0; i < outbox->count; i++) {
+		entry = outbox_entry(outbox, i);
+
+		if (entry->state == OUTBOX_RELEASE) {
+			struct mqtt_pubrel_param param = {
+				.message_id = entry->message_id,
+			};
+			struct buf_ctx packet = {
+				.cur = pubrel[count],
+				.end = pubrel[count] + PUBREL_BUF_LEN,
+			};
+
+			(void)publish_release_encode(&param, &packet);
+
+			io_vector[count].iov_base = packet.cur;
+			io_vector[count].iov_len = packet.end - packet.cur;
+		} else if (entry->state == OUTBOX_QUEUED && !window_full) {
+			/* Keep the order of the messages, none is sent
+			 * after the window is full.
+			 */
+			if (entry->message_id != 0U) {
+				if (inflight >= CONFIG_MQTT_OUTBOX_INFLIGHT_MAX) {
+					window_full = true;
+					continue;
+				}
+
+				inflight++;
+			}
+
+			io_vector[count].iov_base =
+					client->outbox_buf + entry->offset;
+			io_vector[count].iov_len = entry->len;
+		} else {
+			continue;
+		}
+
+		batch[count++] = entry;
+
+		if (count == OUTBOX_BATCH_MAX) {
+			err_code = outbox_write(client, batch, io_vector,
+						count);
+			if (err_code < 0) {
+				break;
+			}
+
+			count = 0;
+		}
+	}
+
+	if (err_code == 0 && count > 0) {
+		err_code = outbox_write(client, batch, io_vector, count);
+	}
+
+	outbox_release(outbox);
+
+	return err_code;
+}
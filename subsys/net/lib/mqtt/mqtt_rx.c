@@ -42,6 +42,9 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 						MQTT_CONNECTION_ACCEPTED) {
 				/* Set state. */
 				MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+				mqtt_outbox_reconnect(client);
+#endif
 			} else {
 				err_code = -ECONNREFUSED;
 			}
@@ -77,6 +80,12 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
 		evt.result = err_code;
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+		if (err_code == 0) {
+			mqtt_outbox_ack(client, MQTT_PKT_TYPE_PUBACK,
+					evt.param.puback.message_id);
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
@@ -85,6 +94,17 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
 		evt.result = err_code;
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+		/* The outbox sends PUBREL for its own messages, the application
+		 * would send it a second time.
+		 */
+		if (err_code == 0 &&
+		    mqtt_outbox_holds(client, evt.param.pubrec.message_id)) {
+			mqtt_outbox_ack(client, MQTT_PKT_TYPE_PUBREC,
+					evt.param.pubrec.message_id);
+			notify_event = false;
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -101,6 +121,12 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
 		evt.result = err_code;
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+		if (err_code == 0) {
+			mqtt_outbox_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					evt.param.pubcomp.message_id);
+		}
+#endif
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
@@ -142,6 +168,13 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		event_notify(client, &evt);
 	}
 
+#if defined(CONFIG_MQTT_LIB_OUTBOX)
+	/* An acknowledgment or a new connection can let queued messages go */
+	if (err_code == 0 && MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		err_code = mqtt_outbox_flush(client);
+	}
+#endif
+
 	return err_code;
 }
 
@@ -7,6 +7,7 @@
 
 /* libc headers */
 #include <fcntl.h>
+#include <limits.h>
 
 /* Zephyr headers */
 #include <logging/log.h>
@@ -127,6 +128,39 @@ static int fifo_wait_non_empty(struct k_fifo *fifo, k_timeout_t timeout)
 	return k_poll(events, ARRAY_SIZE(events), timeout);
 }
 
+#if defined(CONFIG_NET_CONTEXT_RCVBUF)
+/* Account a datagram to the receive queue. Returns false if the datagram
+ * does not fit to the receive buffer of the socket.
+ */
+static bool sock_recv_q_reserve(struct net_context *ctx, struct net_pkt *pkt)
+{
+	size_t len = net_pkt_get_len(pkt);
+
+	if (net_context_get_type(ctx) != SOCK_DGRAM) {
+		return true;
+	}
+
+	if (ctx->options.rcvbuf &&
+	    (size_t)atomic_get(&ctx->recv_q_len) + len > ctx->options.rcvbuf) {
+		return false;
+	}
+
+	atomic_add(&ctx->recv_q_len, len);
+
+	return true;
+}
+
+static void sock_recv_q_release(struct net_context *ctx, struct net_pkt *pkt)
+{
+	if (net_context_get_type(ctx) == SOCK_DGRAM) {
+		atomic_sub(&ctx->recv_q_len, net_pkt_get_len(pkt));
+	}
+}
+#else
+#define sock_recv_q_reserve(ctx, pkt) true
+#define sock_recv_q_release(ctx, pkt)
+#endif /* CONFIG_NET_CONTEXT_RCVBUF */
+
 static void zsock_flush_queue(struct net_context *ctx)
 {
 	bool is_listen = net_context_get_state(ctx) == NET_CONTEXT_LISTENING;
@@ -139,6 +173,7 @@ static void zsock_flush_queue(struct net_context *ctx)
 			net_context_put(p);
 		} else {
 			NET_DBG("discarding pkt %p", p);
+			sock_recv_q_release(ctx, p);
 			net_pkt_unref(p);
 		}
 	}
@@ -373,8 +408,10 @@ static void zsock_received_cb(struct net_context *ctx,
 	/* Normal packet */
 	net_pkt_set_eof(pkt, false);
 
-	if (net_context_get_type(ctx) == SOCK_STREAM) {
-		net_context_update_recv_wnd(ctx, -net_pkt_remaining_data(pkt));
+	if (!sock_recv_q_reserve(ctx, pkt)) {
+		NET_DBG("Receive buffer full, dropping pkt %p", pkt);
+		net_pkt_unref(pkt);
+		goto unlock;
 	}
 
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
@@ -983,18 +1020,140 @@ static int wait_data(struct net_context *ctx, k_timeout_t *timeout)
 	return 0;
 }
 
+static int sock_get_pkt_dst_addr(struct net_pkt *pkt, void *addr)
+{
+	struct net_pkt_cursor backup;
+	int ret = 0;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *ipv4_hdr;
+
+		ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(
+							pkt, &ipv4_access);
+		if (!ipv4_hdr) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		net_ipaddr_copy((struct in_addr *)addr, &ipv4_hdr->dst);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *ipv6_hdr;
+
+		ipv6_hdr = (struct net_ipv6_hdr *)net_pkt_get_data(
+							pkt, &ipv6_access);
+		if (!ipv6_hdr) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		net_ipaddr_copy((struct in6_addr *)addr, &ipv6_hdr->dst);
+	} else {
+		ret = -ENOTSUP;
+	}
+
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return ret;
+}
+
+/* Reserve space for one control message, returns a pointer to its data or
+ * NULL if it does not fit.
+ */
+static void *sock_cmsg_add(struct msghdr *msg, size_t *used, int level,
+			   int type, size_t len)
+{
+	struct cmsghdr *cmsg;
+
+	if (*used + CMSG_SPACE(len) > msg->msg_controllen) {
+		msg->msg_flags |= ZSOCK_MSG_CTRUNC;
+		return NULL;
+	}
+
+	cmsg = (struct cmsghdr *)((uint8_t *)msg->msg_control + *used);
+	cmsg->cmsg_len = CMSG_LEN(len);
+	cmsg->cmsg_level = level;
+	cmsg->cmsg_type = type;
+
+	*used += CMSG_SPACE(len);
+
+	return CMSG_DATA(cmsg);
+}
+
+static void sock_add_ancillary_data(struct net_context *ctx,
+				    struct net_pkt *pkt,
+				    struct msghdr *msg)
+{
+	size_t used = 0;
+	void *data;
+
+#if defined(CONFIG_NET_PKT_TIMESTAMP)
+	if (ctx->flags & NET_CONTEXT_RECV_TIMESTAMP) {
+		data = sock_cmsg_add(msg, &used, SOL_SOCKET, SO_TIMESTAMPING,
+				     sizeof(struct net_ptp_time));
+		if (data) {
+			memcpy(data, net_pkt_timestamp(pkt),
+			       sizeof(struct net_ptp_time));
+		}
+	}
+#endif
+
+	/* Packets from offloaded IP stack do not have IP headers */
+	if ((ctx->flags & NET_CONTEXT_RECV_PKTINFO) &&
+	    !(IS_ENABLED(CONFIG_NET_OFFLOAD) &&
+	      net_if_is_ip_offloaded(net_pkt_iface(pkt)))) {
+		if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		    net_pkt_family(pkt) == AF_INET) {
+			struct in_pktinfo info = { 0 };
+
+			info.ipi_ifindex =
+				net_if_get_by_iface(net_pkt_iface(pkt));
+			(void)sock_get_pkt_dst_addr(pkt, &info.ipi_addr);
+			net_ipaddr_copy(&info.ipi_spec_dst, &info.ipi_addr);
+
+			data = sock_cmsg_add(msg, &used, IPPROTO_IP,
+					     IP_PKTINFO, sizeof(info));
+			if (data) {
+				memcpy(data, &info, sizeof(info));
+			}
+		} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+			   net_pkt_family(pkt) == AF_INET6) {
+			struct in6_pktinfo info = { 0 };
+
+			info.ipi6_ifindex =
+				net_if_get_by_iface(net_pkt_iface(pkt));
+			(void)sock_get_pkt_dst_addr(pkt, &info.ipi6_addr);
+
+			data = sock_cmsg_add(msg, &used, IPPROTO_IPV6,
+					     IPV6_PKTINFO, sizeof(info));
+			if (data) {
+				memcpy(data, &info, sizeof(info));
+			}
+		}
+	}
+
+	msg->msg_controllen = used;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
-				       void *buf,
-				       size_t max_len,
-				       int flags,
-				       struct sockaddr *src_addr,
-				       socklen_t *addrlen)
+				       struct msghdr *msg,
+				       int flags)
 {
 	k_timeout_t timeout = K_FOREVER;
 	size_t recv_len = 0;
-	size_t read_len;
+	size_t read_len = 0;
 	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
+	size_t i;
 
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
 		timeout = K_NO_WAIT;
@@ -1023,6 +1182,9 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 		pkt = k_fifo_peek_head(&ctx->recv_q);
 	} else {
 		pkt = k_fifo_get(&ctx->recv_q, timeout);
+		if (pkt) {
+			sock_recv_q_release(ctx, pkt);
+		}
 	}
 
 	if (!pkt) {
@@ -1032,7 +1194,11 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 
 	net_pkt_cursor_backup(pkt, &backup);
 
-	if (src_addr && addrlen) {
+	msg->msg_flags = 0;
+
+	if (msg->msg_name && msg->msg_namelen) {
+		struct sockaddr *src_addr = msg->msg_name;
+
 		if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
 		    net_if_is_ip_offloaded(net_context_get_iface(ctx))) {
 			/*
@@ -1043,7 +1209,8 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 			 */
 			if (ctx->flags & NET_CONTEXT_REMOTE_ADDR_SET) {
 				memcpy(src_addr, &ctx->remote,
-				       MIN(*addrlen, sizeof(ctx->remote)));
+				       MIN(msg->msg_namelen,
+					   sizeof(ctx->remote)));
 			} else {
 				errno = ENOTSUP;
 				goto fail;
@@ -1052,7 +1219,7 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 			int rv;
 
 			rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-						   src_addr, *addrlen);
+						   src_addr, msg->msg_namelen);
 			if (rv < 0) {
 				errno = -rv;
 				LOG_ERR("sock_get_pkt_src_addr %d", rv);
@@ -1064,21 +1231,38 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 		 * size of source address
 		 */
 		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
+			msg->msg_namelen = sizeof(struct sockaddr_in);
 		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
+			msg->msg_namelen = sizeof(struct sockaddr_in6);
 		} else {
 			errno = ENOTSUP;
 			goto fail;
 		}
 	}
 
+	if (msg->msg_control && msg->msg_controllen) {
+		sock_add_ancillary_data(ctx, pkt, msg);
+	} else {
+		msg->msg_controllen = 0;
+	}
+
 	recv_len = net_pkt_remaining_data(pkt);
-	read_len = MIN(recv_len, max_len);
 
-	if (net_pkt_read(pkt, buf, read_len)) {
-		errno = ENOBUFS;
-		goto fail;
+	/* Scatter the datagram to the buffers */
+	for (i = 0; i < msg->msg_iovlen && read_len < recv_len; i++) {
+		size_t len = MIN(recv_len - read_len,
+				 msg->msg_iov[i].iov_len);
+
+		if (net_pkt_read(pkt, msg->msg_iov[i].iov_base, len)) {
+			errno = ENOBUFS;
+			goto fail;
+		}
+
+		read_len += len;
+	}
+
+	if (read_len < recv_len) {
+		msg->msg_flags |= ZSOCK_MSG_TRUNC;
 	}
 
 	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS) &&
@@ -1235,7 +1419,24 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	}
 
 	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
+		struct iovec iov = {
+			.iov_base = buf,
+			.iov_len = max_len,
+		};
+		struct msghdr msg = {
+			.msg_name = addrlen ? src_addr : NULL,
+			.msg_namelen = addrlen ? *addrlen : 0,
+			.msg_iov = &iov,
+			.msg_iovlen = 1,
+		};
+		ssize_t ret;
+
+		ret = zsock_recv_dgram(ctx, &msg, flags);
+		if (ret >= 0 && addrlen) {
+			*addrlen = msg.msg_namelen;
+		}
+
+		return ret;
 	} else if (sock_type == SOCK_STREAM) {
 		return zsock_recv_stream(ctx, buf, max_len, flags);
 	} else {
@@ -1283,6 +1484,460 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	ssize_t recv_len = 0;
+	size_t i;
+
+	if (msg == NULL || (msg->msg_iovlen > 0 && msg->msg_iov == NULL)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, msg, flags);
+	} else if (sock_type != SOCK_STREAM) {
+		__ASSERT(0, "Unknown socket type");
+		return 0;
+	}
+
+	msg->msg_namelen = 0;
+	msg->msg_controllen = 0;
+	msg->msg_flags = 0;
+
+	/* Fill the buffers in order, only the first one is waited for */
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		ssize_t ret;
+
+		if (msg->msg_iov[i].iov_len == 0) {
+			continue;
+		}
+
+		ret = zsock_recv_stream(ctx, msg->msg_iov[i].iov_base,
+					msg->msg_iov[i].iov_len, flags);
+		if (ret < 0) {
+			if (recv_len > 0 && errno == EAGAIN) {
+				break;
+			}
+
+			return -1;
+		}
+
+		recv_len += ret;
+
+		if (ret < msg->msg_iov[i].iov_len ||
+		    (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return recv_len;
+}
+
+ssize_t z_impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	VTABLE_CALL(recvmsg, sock, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+static inline ssize_t z_vrfy_zsock_recvmsg(int sock, struct msghdr *msg,
+					   int flags)
+{
+	struct msghdr msg_copy;
+	struct iovec *iov = NULL;
+	size_t iov_size;
+	ssize_t ret;
+	size_t i;
+
+	Z_OOPS(z_user_from_copy(&msg_copy, (void *)msg, sizeof(msg_copy)));
+
+	if (msg_copy.msg_iovlen > 0) {
+		if (size_mul_overflow(msg_copy.msg_iovlen,
+				      sizeof(struct iovec), &iov_size)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		iov = z_user_alloc_from_copy(msg_copy.msg_iov, iov_size);
+		if (!iov) {
+			errno = ENOMEM;
+			return -1;
+		}
+
+		for (i = 0; i < msg_copy.msg_iovlen; i++) {
+			if (Z_SYSCALL_MEMORY_WRITE(iov[i].iov_base,
+						   iov[i].iov_len)) {
+				k_free(iov);
+				errno = EFAULT;
+				return -1;
+			}
+		}
+	}
+
+	msg_copy.msg_iov = iov;
+
+	if ((msg_copy.msg_name && msg_copy.msg_namelen &&
+	     Z_SYSCALL_MEMORY_WRITE(msg_copy.msg_name,
+				    msg_copy.msg_namelen)) ||
+	    (msg_copy.msg_control && msg_copy.msg_controllen &&
+	     Z_SYSCALL_MEMORY_WRITE(msg_copy.msg_control,
+				    msg_copy.msg_controllen))) {
+		k_free(iov);
+		errno = EFAULT;
+		return -1;
+	}
+
+	ret = z_impl_zsock_recvmsg(sock, &msg_copy, flags);
+
+	k_free(iov);
+
+	Z_OOPS(z_user_to_copy(&msg->msg_namelen, &msg_copy.msg_namelen,
+			      sizeof(msg_copy.msg_namelen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_controllen, &msg_copy.msg_controllen,
+			      sizeof(msg_copy.msg_controllen)));
+	Z_OOPS(z_user_to_copy(&msg->msg_flags, &msg_copy.msg_flags,
+			      sizeof(msg_copy.msg_flags)));
+
+	return ret;
+}
+#include <syscalls/zsock_recvmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+/* The batched calls look up the socket and take its lock only once */
+int z_impl_zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	struct k_mutex *lock;
+	unsigned int i;
+	void *obj;
+	ssize_t ret;
+
+	obj = get_sock_vtable(sock, &vtable, &lock);
+	if (obj == NULL || vtable->sendmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	vlen = MIN(vlen, INT_MAX);
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+
+	for (i = 0; i < vlen; i++) {
+		ret = vtable->sendmsg(obj, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+	}
+
+	k_mutex_unlock(lock);
+
+	/* An error is reported only if nothing was sent */
+	return (i == 0 && vlen > 0) ? -1 : i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_sendmmsg(int sock,
+					struct zsock_mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i, len;
+	ssize_t ret;
+
+	vlen = MIN(vlen, INT_MAX);
+
+	for (i = 0; i < vlen; i++) {
+		ret = z_vrfy_zsock_sendmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		len = ret;
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_len, &len, sizeof(len)));
+	}
+
+	return (i == 0 && vlen > 0) ? -1 : i;
+}
+#include <syscalls/zsock_sendmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	struct k_mutex *lock;
+	unsigned int i;
+	void *obj;
+	ssize_t ret;
+
+	obj = get_sock_vtable(sock, &vtable, &lock);
+	if (obj == NULL || vtable->recvmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	vlen = MIN(vlen, INT_MAX);
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+
+	for (i = 0; i < vlen; i++) {
+		ret = vtable->recvmsg(obj, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+
+		/* Only wait for the first message */
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	k_mutex_unlock(lock);
+
+	return (i == 0 && vlen > 0) ? -1 : i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_recvmmsg(int sock,
+					struct zsock_mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i, len;
+	ssize_t ret;
+
+	vlen = MIN(vlen, INT_MAX);
+
+	for (i = 0; i < vlen; i++) {
+		ret = z_vrfy_zsock_recvmsg(sock, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		len = ret;
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_len, &len, sizeof(len)));
+
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return (i == 0 && vlen > 0) ? -1 : i;
+}
+#include <syscalls/zsock_recvmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+#if defined(CONFIG_NET_SOCKETS_RECV_LOAN)
+/* Fill the loan with views to the packet data from the cursor onwards and
+ * move the cursor past the loaned data.
+ */
+static size_t sock_loan_pkt_data(struct net_pkt *pkt,
+				 struct zsock_recv_loan *loan)
+{
+	size_t remaining = net_pkt_remaining_data(pkt);
+	struct net_buf *buf = pkt->cursor.buf;
+	uint8_t *pos = pkt->cursor.pos;
+	size_t loaned = 0;
+	size_t i = 0;
+
+	while (buf && remaining > 0 && i < loan->iovlen) {
+		size_t len = MIN(remaining, buf->len - (pos - buf->data));
+
+		if (len > 0) {
+			loan->iov[i].iov_base = pos;
+			loan->iov[i].iov_len = len;
+			loaned += len;
+			remaining -= len;
+			i++;
+		}
+
+		buf = buf->frags;
+		if (buf) {
+			pos = buf->data;
+		}
+	}
+
+	loan->iovlen = i;
+
+	net_pkt_set_overwrite(pkt, true);
+	(void)net_pkt_skip(pkt, loaned);
+
+	return loaned;
+}
+
+static ssize_t zsock_recv_loan_ctx(struct net_context *ctx,
+				   struct zsock_recv_loan *loan, int flags)
+{
+	const bool stream = net_context_get_type(ctx) == SOCK_STREAM;
+	k_timeout_t timeout = K_FOREVER;
+	struct net_pkt *pkt;
+	bool dequeue = true;
+	int ret;
+
+	if (stream && net_context_get_state(ctx) != NET_CONTEXT_CONNECTED) {
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	loan->len = 0;
+	loan->flags = 0;
+	loan->pkt = NULL;
+	loan->ctx = NULL;
+
+	if (stream && sock_is_eof(ctx)) {
+		loan->iovlen = 0;
+		return 0;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	} else {
+		net_context_get_option(ctx, NET_OPT_RCVTIMEO, &timeout, NULL);
+
+		ret = wait_data(ctx, &timeout);
+		if (ret < 0) {
+			errno = -ret;
+			return -1;
+		}
+	}
+
+	pkt = k_fifo_peek_head(&ctx->recv_q);
+	if (!pkt) {
+		if (stream && sock_is_eof(ctx)) {
+			loan->iovlen = 0;
+			return 0;
+		}
+
+		errno = EAGAIN;
+		return -1;
+	}
+
+	loan->len = sock_loan_pkt_data(pkt, loan);
+
+	if (net_pkt_remaining_data(pkt) > 0) {
+		if (stream) {
+			/* The rest of the segment stays queued, the loan
+			 * holds a reference of its own.
+			 */
+			net_pkt_ref(pkt);
+			dequeue = false;
+		} else {
+			loan->flags |= ZSOCK_MSG_TRUNC;
+		}
+	}
+
+	if (dequeue) {
+		k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+
+		if (stream && net_pkt_eof(pkt)) {
+			sock_set_eof(ctx);
+		}
+
+		if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS)) {
+			net_socket_update_tc_rx_time(pkt, k_cycle_get_32());
+		}
+	}
+
+	/* The context is referenced until the loan is returned, so that the
+	 * loan cannot be applied to another socket that reuses the context.
+	 */
+	net_context_ref(ctx);
+
+	loan->pkt = pkt;
+	loan->ctx = ctx;
+
+	return loan->len;
+}
+
+ssize_t zsock_recv_loan(int sock, struct zsock_recv_loan *loan, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	struct k_mutex *lock;
+	void *obj;
+	ssize_t ret;
+
+	obj = get_sock_vtable(sock, &vtable, &lock);
+	if (obj == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (vtable != &sock_fd_op_vtable) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if (!loan || !loan->iov || loan->iovlen == 0 ||
+	    (flags & (ZSOCK_MSG_PEEK | ZSOCK_MSG_WAITALL))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+
+	ret = zsock_recv_loan_ctx(obj, loan, flags);
+
+	k_mutex_unlock(lock);
+
+	return ret;
+}
+
+int zsock_recv_return(int sock, struct zsock_recv_loan *loan)
+{
+	const struct socket_op_vtable *vtable;
+	struct k_mutex *lock = NULL;
+	struct net_context *ctx;
+	void *obj;
+
+	if (!loan) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!loan->pkt) {
+		return 0;
+	}
+
+	ctx = loan->ctx;
+
+	/* Serialize with the socket calls if the socket is still open. If
+	 * it was closed, the context is only referenced by the loan.
+	 */
+	obj = get_sock_vtable(sock, &vtable, &lock);
+	if (obj != ctx || vtable != &sock_fd_op_vtable) {
+		lock = NULL;
+	}
+
+	if (lock) {
+		(void)k_mutex_lock(lock, K_FOREVER);
+	}
+
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		if (loan->len > 0 &&
+		    net_context_get_state(ctx) == NET_CONTEXT_CONNECTED) {
+			net_context_update_recv_wnd(ctx, loan->len);
+		}
+	} else {
+		sock_recv_q_release(ctx, loan->pkt);
+	}
+
+	if (lock) {
+		k_mutex_unlock(lock);
+	}
+
+	net_pkt_unref(loan->pkt);
+	loan->pkt = NULL;
+	loan->ctx = NULL;
+
+	net_context_unref(ctx);
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_RECV_LOAN */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1683,6 +2338,34 @@ int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 			return 0;
 		}
+
+		case SO_RCVBUF:
+		case SO_SNDBUF:
+			if ((optname == SO_RCVBUF &&
+			     IS_ENABLED(CONFIG_NET_CONTEXT_RCVBUF)) ||
+			    (optname == SO_SNDBUF &&
+			     IS_ENABLED(CONFIG_NET_CONTEXT_SNDBUF))) {
+				uint16_t size;
+
+				if (*optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				ret = net_context_get_option(
+					ctx, optname == SO_RCVBUF ?
+					NET_OPT_RCVBUF : NET_OPT_SNDBUF,
+					&size, NULL);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				*(int *)optval = size;
+
+				return 0;
+			}
+			break;
 		}
 
 		break;
@@ -1729,6 +2412,49 @@ int z_vrfy_zsock_getsockopt(int sock, int level, int optname,
 #include <syscalls/zsock_getsockopt_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+/* Enable or disable returning ancillary data in recvmsg(), the flag is set
+ * if any of the bits in mask are set in the integer option value.
+ */
+static int sock_set_recv_flag(struct net_context *ctx, uint16_t flag,
+			      int mask, const void *optval, socklen_t optlen)
+{
+	if (optval == NULL || optlen != sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (*(const int *)optval & mask) {
+		ctx->flags |= flag;
+	} else {
+		ctx->flags &= ~flag;
+	}
+
+	return 0;
+}
+
+static int sock_set_buf_size(struct net_context *ctx,
+			     enum net_context_option option,
+			     const void *optval, socklen_t optlen)
+{
+	uint16_t size;
+	int ret;
+
+	if (optlen != sizeof(int) || *(int *)optval < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	size = MIN(*(int *)optval, UINT16_MAX);
+
+	ret = net_context_set_option(ctx, option, &size, sizeof(size));
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
 int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 const void *optval, socklen_t optlen)
 {
@@ -1758,6 +2484,22 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 			break;
 
+		case SO_RCVBUF:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_RCVBUF)) {
+				return sock_set_buf_size(ctx, NET_OPT_RCVBUF,
+							 optval, optlen);
+			}
+
+			break;
+
+		case SO_SNDBUF:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_SNDBUF)) {
+				return sock_set_buf_size(ctx, NET_OPT_SNDBUF,
+							 optval, optlen);
+			}
+
+			break;
+
 		case SO_RCVTIMEO:
 			if (IS_ENABLED(CONFIG_NET_CONTEXT_RCVTIMEO)) {
 				const struct zsock_timeval *tv = optval;
@@ -1896,6 +2638,15 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			return 0;
 		}
 
+		case SO_TIMESTAMPING:
+			if (IS_ENABLED(CONFIG_NET_PKT_TIMESTAMP)) {
+				return sock_set_recv_flag(
+					ctx, NET_CONTEXT_RECV_TIMESTAMP,
+					SOF_TIMESTAMPING_RX_HARDWARE,
+					optval, optlen);
+			}
+
+			break;
 		}
 
 		break;
@@ -1910,6 +2661,20 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		}
 		break;
 
+	case IPPROTO_IP:
+		switch (optname) {
+		case IP_PKTINFO:
+			if (IS_ENABLED(CONFIG_NET_IPV4) &&
+			    net_context_get_family(ctx) == AF_INET) {
+				return sock_set_recv_flag(
+					ctx, NET_CONTEXT_RECV_PKTINFO,
+					~0, optval, optlen);
+			}
+
+			break;
+		}
+		break;
+
 	case IPPROTO_IPV6:
 		switch (optname) {
 		case IPV6_V6ONLY:
@@ -1917,6 +2682,16 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case IPV6_RECVPKTINFO:
+			if (IS_ENABLED(CONFIG_NET_IPV6) &&
+			    net_context_get_family(ctx) == AF_INET6) {
+				return sock_set_recv_flag(
+					ctx, NET_CONTEXT_RECV_PKTINFO,
+					~0, optval, optlen);
+			}
+
+			break;
 		}
 		break;
 	}
@@ -2168,6 +2943,11 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -2208,4 +2988,5 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 	.getsockname = sock_getsockname_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
 };
@@ -0,0 +1,702 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* epoll-style readiness notification on top of the fdtable.
+ *
+ * Each registered descriptor gets a fixed set of k_poll events in the
+ * epoll instance, filled in once by ZFD_IOCTL_POLL_PREPARE when the
+ * descriptor is added. zsock_epoll_wait() then passes the persistent
+ * event array to k_poll() as is and only calls back into the descriptor
+ * (ZFD_IOCTL_POLL_UPDATE) for the entries that were signalled. A
+ * reported level-triggered entry is prepared again on the next wait, so
+ * that conditions which are not backed by a k_poll object (writability,
+ * end of stream) are picked up.
+ *
+ * Event slot 0 is a signal raised by zsock_epoll_ctl() and close, which
+ * makes a waiting thread release the instance lock so that the interest
+ * list can be changed while somebody waits on it.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <kernel.h>
+#include <init.h>
+#include <syscall_handler.h>
+#include <sys/fdtable.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+
+#include "sockets_internal.h"
+
+/* Number of k_poll events a descriptor may use (POLLIN and POLLOUT) */
+#define EPOLL_FD_EVENTS 2
+
+#define EPOLL_ENTRY_ALWAYS BIT(0)    /* Prepare reported immediate readiness */
+#define EPOLL_ENTRY_REPREPARE BIT(1) /* Prepare again before next wait */
+#define EPOLL_ENTRY_DISARMED BIT(2)  /* EPOLLET, immediate readiness reported */
+#define EPOLL_ENTRY_DISABLED BIT(3)  /* EPOLLONESHOT, event reported */
+
+#define EPOLL_EVENTS_SUPPORTED (ZSOCK_EPOLLIN | ZSOCK_EPOLLOUT | \
+				ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP | \
+				ZSOCK_EPOLLONESHOT | ZSOCK_EPOLLET)
+
+struct epoll_entry {
+	void *obj;
+	const struct fd_op_vtable *vtable;
+	struct zsock_epoll_event event;
+	int fd;
+	uint8_t flags;
+};
+
+struct epoll_instance {
+	struct k_mutex lock;
+	struct k_poll_signal ctl_sig;
+	struct epoll_entry entries[CONFIG_NET_SOCKETS_EPOLL_MAX_FDS];
+	struct k_poll_event events[1 + CONFIG_NET_SOCKETS_EPOLL_MAX_FDS *
+				   EPOLL_FD_EVENTS];
+	int count;
+	int next;
+	bool in_use;
+};
+
+static struct epoll_instance epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static K_MUTEX_DEFINE(epoll_alloc_lock);
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+static inline struct k_poll_event *entry_events(struct epoll_instance *ep,
+						int idx)
+{
+	return &ep->events[1 + idx * EPOLL_FD_EVENTS];
+}
+
+static inline int epoll_num_events(struct epoll_instance *ep)
+{
+	return 1 + ep->count * EPOLL_FD_EVENTS;
+}
+
+static void entry_ignore(struct epoll_instance *ep, int idx)
+{
+	struct k_poll_event *pev = entry_events(ep, idx);
+	int i;
+
+	for (i = 0; i < EPOLL_FD_EVENTS; i++) {
+		k_poll_event_init(&pev[i], K_POLL_TYPE_IGNORE,
+				  K_POLL_MODE_NOTIFY_ONLY, NULL);
+	}
+}
+
+static bool entry_is_stale(struct epoll_entry *entry)
+{
+	const struct fd_op_vtable *vtable;
+	void *obj;
+
+	obj = z_get_fd_obj_and_vtable(entry->fd, &vtable, NULL);
+
+	return obj != entry->obj || vtable != entry->vtable;
+}
+
+/* Fill in the k_poll events of an entry. Called with the instance locked. */
+static int entry_prepare(struct epoll_instance *ep, int idx)
+{
+	struct epoll_entry *entry = &ep->entries[idx];
+	struct k_poll_event *pev = entry_events(ep, idx);
+	struct k_poll_event *pev_end = pev + EPOLL_FD_EVENTS;
+	struct zsock_pollfd pfd = {
+		.fd = entry->fd,
+		.events = entry->event.events &
+			  (ZSOCK_EPOLLIN | ZSOCK_EPOLLOUT),
+	};
+	const struct fd_op_vtable *vtable;
+	struct k_mutex *lock;
+	void *obj;
+	int ret;
+
+	entry_ignore(ep, idx);
+	entry->flags &= ~(EPOLL_ENTRY_ALWAYS | EPOLL_ENTRY_REPREPARE);
+
+	obj = z_get_fd_obj_and_vtable(entry->fd, &vtable, &lock);
+	if (obj != entry->obj || vtable != entry->vtable) {
+		return -EBADF;
+	}
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+	ret = z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_PREPARE,
+				   &pfd, &pev, pev_end);
+	k_mutex_unlock(lock);
+
+	if (ret == -EALREADY) {
+		entry->flags |= EPOLL_ENTRY_ALWAYS;
+		ret = 0;
+	} else if (ret == -EXDEV) {
+		/* Offloaded sockets are polled by the offload driver */
+		ret = -EOPNOTSUPP;
+	} else if (ret == -1) {
+		/* Some descriptors return -1 and set errno */
+		ret = -errno;
+	}
+
+	return ret;
+}
+
+/* Get the events of a signalled entry. Called with the instance locked. */
+static uint32_t entry_update(struct epoll_instance *ep, int idx)
+{
+	struct epoll_entry *entry = &ep->entries[idx];
+	struct k_poll_event *pev = entry_events(ep, idx);
+	struct zsock_pollfd pfd = {
+		.fd = entry->fd,
+		.events = entry->event.events &
+			  (ZSOCK_EPOLLIN | ZSOCK_EPOLLOUT),
+	};
+	const struct fd_op_vtable *vtable;
+	struct k_mutex *lock;
+	void *obj;
+	int ret;
+
+	obj = z_get_fd_obj_and_vtable(entry->fd, &vtable, &lock);
+	if (obj != entry->obj || vtable != entry->vtable) {
+		return 0;
+	}
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+	ret = z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_UPDATE,
+				   &pfd, &pev);
+	k_mutex_unlock(lock);
+
+	if (ret != 0) {
+		/* Not ready after all (e.g. TLS handshake in progress) */
+		return 0;
+	}
+
+	return (uint32_t)pfd.revents;
+}
+
+static bool entry_signalled(struct epoll_instance *ep, int idx)
+{
+	struct epoll_entry *entry = &ep->entries[idx];
+	struct k_poll_event *pev = entry_events(ep, idx);
+	int i;
+
+	if (entry->flags & EPOLL_ENTRY_DISABLED) {
+		return false;
+	}
+
+	if ((entry->flags & EPOLL_ENTRY_ALWAYS) &&
+	    !(entry->flags & EPOLL_ENTRY_DISARMED)) {
+		return true;
+	}
+
+	for (i = 0; i < EPOLL_FD_EVENTS; i++) {
+		if (pev[i].type != K_POLL_TYPE_IGNORE &&
+		    pev[i].state != K_POLL_STATE_NOT_READY) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void entry_remove(struct epoll_instance *ep, int idx)
+{
+	int last = ep->count - 1;
+
+	/* Keep the interest list contiguous, so k_poll() only gets the
+	 * events in use.
+	 */
+	if (idx != last) {
+		ep->entries[idx] = ep->entries[last];
+		memcpy(entry_events(ep, idx), entry_events(ep, last),
+		       EPOLL_FD_EVENTS * sizeof(struct k_poll_event));
+	}
+
+	ep->count--;
+
+	if (ep->next >= ep->count) {
+		ep->next = 0;
+	}
+}
+
+static int entry_find(struct epoll_instance *ep, int fd)
+{
+	int i;
+
+	for (i = 0; i < ep->count; i++) {
+		if (ep->entries[i].fd == fd) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/* Take the instance lock, interrupting a thread waiting on it */
+static void epoll_lock(struct epoll_instance *ep)
+{
+	k_poll_signal_raise(&ep->ctl_sig, 0);
+	(void)k_mutex_lock(&ep->lock, K_FOREVER);
+}
+
+static ssize_t epoll_read_op(void *obj, void *buf, size_t sz)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(sz);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_op(void *obj, const void *buf, size_t sz)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buf);
+	ARG_UNUSED(sz);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_close_op(void *obj)
+{
+	struct epoll_instance *ep = obj;
+
+	epoll_lock(ep);
+
+	ep->count = 0;
+	ep->in_use = false;
+
+	k_mutex_unlock(&ep->lock);
+
+	return 0;
+}
+
+static int epoll_ioctl_op(void *obj, unsigned int request, va_list args)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(request);
+	ARG_UNUSED(args);
+
+	/* Nesting epoll instances and poll() on them is not supported */
+	errno = EOPNOTSUPP;
+	return -1;
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_op,
+	.write = epoll_write_op,
+	.close = epoll_close_op,
+	.ioctl = epoll_ioctl_op,
+};
+
+int z_impl_zsock_epoll_create(int flags)
+{
+	struct epoll_instance *ep = NULL;
+	int fd = -1;
+	int i;
+
+	if (flags != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	(void)k_mutex_lock(&epoll_alloc_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			break;
+		}
+	}
+
+	if (ep == NULL) {
+		errno = ENOMEM;
+		goto out;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		goto out;
+	}
+
+	k_poll_signal_reset(&ep->ctl_sig);
+	ep->count = 0;
+	ep->next = 0;
+	ep->in_use = true;
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	NET_DBG("epoll %p fd %d", ep, fd);
+
+out:
+	k_mutex_unlock(&epoll_alloc_lock);
+
+	return fd;
+}
+
+/* The locks are initialized once, a thread woken up by close may still be
+ * waiting for the lock of a freed instance.
+ */
+static int epoll_init(const struct device *unused)
+{
+	struct epoll_instance *ep;
+	int i;
+
+	ARG_UNUSED(unused);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		ep = &epoll_instances[i];
+
+		k_mutex_init(&ep->lock);
+		k_poll_signal_init(&ep->ctl_sig);
+		k_poll_event_init(&ep->events[0], K_POLL_TYPE_SIGNAL,
+				  K_POLL_MODE_NOTIFY_ONLY, &ep->ctl_sig);
+	}
+
+	return 0;
+}
+
+SYS_INIT(epoll_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_create(int flags)
+{
+	return z_impl_zsock_epoll_create(flags);
+}
+#include <syscalls/zsock_epoll_create_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+static int epoll_ctl_add(struct epoll_instance *ep, int epfd, int fd,
+			 struct zsock_epoll_event *event)
+{
+	struct epoll_entry *entry;
+	int ret;
+
+	if (entry_find(ep, fd) >= 0) {
+		return -EEXIST;
+	}
+
+	if (ep->count == ARRAY_SIZE(ep->entries)) {
+		return -ENOSPC;
+	}
+
+	entry = &ep->entries[ep->count];
+
+	/* In a user mode call, only net sockets the caller has access to
+	 * can be registered, the same way as with zsock_poll().
+	 */
+	entry->obj = z_impl_zsock_get_context_object(fd);
+	if (entry->obj == NULL) {
+		return -EBADF;
+	}
+
+	(void)z_get_fd_obj_and_vtable(fd, &entry->vtable, NULL);
+	if (fd == epfd || entry->vtable == &epoll_fd_op_vtable) {
+		return -EINVAL;
+	}
+
+	entry->fd = fd;
+	entry->event = *event;
+	entry->flags = 0;
+
+	ret = entry_prepare(ep, ep->count);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ep->count++;
+
+	return 0;
+}
+
+int z_impl_zsock_epoll_ctl(int epfd, int op, int fd,
+			   struct zsock_epoll_event *event)
+{
+	struct epoll_instance *ep;
+	int idx, ret = 0;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL &&
+	    (event == NULL || (event->events & ~EPOLL_EVENTS_SUPPORTED))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	epoll_lock(ep);
+
+	if (!ep->in_use) {
+		ret = -EBADF;
+		goto out;
+	}
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		ret = epoll_ctl_add(ep, epfd, fd, event);
+		break;
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		idx = entry_find(ep, fd);
+		if (idx < 0) {
+			ret = -ENOENT;
+			break;
+		}
+
+		ep->entries[idx].event = *event;
+		ep->entries[idx].flags = 0;
+
+		ret = entry_prepare(ep, idx);
+		if (ret < 0) {
+			entry_remove(ep, idx);
+		}
+
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		idx = entry_find(ep, fd);
+		if (idx < 0) {
+			ret = -ENOENT;
+			break;
+		}
+
+		entry_remove(ep, idx);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+out:
+	k_mutex_unlock(&ep->lock);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_ctl(int epfd, int op, int fd,
+					 struct zsock_epoll_event *event)
+{
+	struct zsock_epoll_event event_copy;
+
+	if (op != ZSOCK_EPOLL_CTL_DEL) {
+		Z_OOPS(z_user_from_copy(&event_copy, event,
+					sizeof(event_copy)));
+		event = &event_copy;
+	}
+
+	return z_impl_zsock_epoll_ctl(epfd, op, fd, event);
+}
+#include <syscalls/zsock_epoll_ctl_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+/* Prepare the interest list for k_poll(). Returns true if some entry is
+ * known to be ready without waiting.
+ */
+static bool epoll_wait_prepare(struct epoll_instance *ep)
+{
+	bool ready = false;
+	int i = 0;
+
+	while (i < ep->count) {
+		struct epoll_entry *entry = &ep->entries[i];
+		struct k_poll_event *pev = entry_events(ep, i);
+		int j;
+
+		/* Closed descriptors are dropped, as in Linux */
+		if (entry_is_stale(entry)) {
+			NET_DBG("epoll %p drop closed fd %d", ep, entry->fd);
+			entry_remove(ep, i);
+			continue;
+		}
+
+		if ((entry->flags & EPOLL_ENTRY_REPREPARE) &&
+		    entry_prepare(ep, i) < 0) {
+			entry_remove(ep, i);
+			continue;
+		}
+
+		for (j = 0; j < EPOLL_FD_EVENTS; j++) {
+			pev[j].state = K_POLL_STATE_NOT_READY;
+		}
+
+		if ((entry->flags & EPOLL_ENTRY_ALWAYS) &&
+		    !(entry->flags & (EPOLL_ENTRY_DISARMED |
+				      EPOLL_ENTRY_DISABLED))) {
+			ready = true;
+		}
+
+		i++;
+	}
+
+	ep->events[0].state = K_POLL_STATE_NOT_READY;
+
+	return ready;
+}
+
+static int epoll_wait_collect(struct epoll_instance *ep,
+			      struct zsock_epoll_event *events, int maxevents)
+{
+	int count = ep->count;
+	int ret = 0;
+	int n, idx;
+
+	/* Start from where the previous call stopped, so that a busy
+	 * descriptor at the head of the list cannot starve the others.
+	 */
+	for (n = 0, idx = ep->next; n < count && ret < maxevents; n++) {
+		struct epoll_entry *entry;
+		uint32_t revents;
+
+		if (idx >= count) {
+			idx = 0;
+		}
+
+		entry = &ep->entries[idx];
+
+		if (!entry_signalled(ep, idx)) {
+			idx++;
+			continue;
+		}
+
+		revents = entry_update(ep, idx) &
+			  (entry->event.events | ZSOCK_EPOLLERR |
+			   ZSOCK_EPOLLHUP);
+		if (revents == 0U) {
+			idx++;
+			continue;
+		}
+
+		events[ret].events = revents;
+		events[ret].data = entry->event.data;
+		ret++;
+
+		if (entry->event.events & ZSOCK_EPOLLONESHOT) {
+			entry->flags |= EPOLL_ENTRY_DISABLED;
+			entry_ignore(ep, idx);
+		} else if (entry->event.events & ZSOCK_EPOLLET) {
+			if (entry->flags & EPOLL_ENTRY_ALWAYS) {
+				entry->flags |= EPOLL_ENTRY_DISARMED;
+			}
+		} else {
+			entry->flags |= EPOLL_ENTRY_REPREPARE;
+		}
+
+		idx++;
+	}
+
+	ep->next = idx >= count ? 0 : idx;
+
+	return ret;
+}
+
+int z_impl_zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			    int maxevents, int timeout)
+{
+	struct epoll_instance *ep;
+	k_timeout_t tmo, wait;
+	uint64_t end;
+	int ret;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	tmo = timeout < 0 ? K_FOREVER : K_MSEC(timeout);
+	end = sys_clock_timeout_end_calc(tmo);
+
+	(void)k_mutex_lock(&ep->lock, K_FOREVER);
+
+	for (;;) {
+		if (!ep->in_use) {
+			ret = -EBADF;
+			break;
+		}
+
+		wait = tmo;
+
+		if (epoll_wait_prepare(ep)) {
+			wait = K_NO_WAIT;
+		} else if (!K_TIMEOUT_EQ(tmo, K_NO_WAIT) &&
+			   !K_TIMEOUT_EQ(tmo, K_FOREVER)) {
+			int64_t remaining = end - sys_clock_tick_get();
+
+			wait = remaining <= 0 ? K_NO_WAIT :
+				Z_TIMEOUT_TICKS(remaining);
+		}
+
+		ret = k_poll(ep->events, epoll_num_events(ep), wait);
+		/* EAGAIN when timeout expired, EINTR when cancelled (i.e. EOF) */
+		if (ret != 0 && ret != -EAGAIN && ret != -EINTR) {
+			break;
+		}
+
+		ret = epoll_wait_collect(ep, events, maxevents);
+
+		if (ep->events[0].state != K_POLL_STATE_NOT_READY) {
+			k_poll_signal_reset(&ep->ctl_sig);
+
+			if (ret == 0) {
+				/* Let the pending zsock_epoll_ctl() or close
+				 * run, then wait on the updated list.
+				 */
+				k_mutex_unlock(&ep->lock);
+				(void)k_mutex_lock(&ep->lock, K_FOREVER);
+				continue;
+			}
+		}
+
+		if (ret > 0 || K_TIMEOUT_EQ(tmo, K_NO_WAIT)) {
+			break;
+		}
+
+		if (!K_TIMEOUT_EQ(tmo, K_FOREVER) &&
+		    end <= sys_clock_tick_get()) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&ep->lock);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_epoll_wait(int epfd,
+					  struct zsock_epoll_event *events,
+					  int maxevents, int timeout)
+{
+	if (maxevents > 0) {
+		Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(events, maxevents,
+						    sizeof(*events)));
+	}
+
+	return z_impl_zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+#include <syscalls/zsock_epoll_wait_mrsh.c>
+#endif /* CONFIG_USERSPACE */
@@ -65,6 +65,7 @@ struct socket_op_vtable {
 	ssize_t (*sendmsg)(void *obj, const struct msghdr *msg, int flags);
 	int (*getsockname)(void *obj, struct sockaddr *addr,
 			   socklen_t *addrlen);
+	ssize_t (*recvmsg)(void *obj, struct msghdr *msg, int flags);
 };
 
 #endif /* _SOCKETS_INTERNAL_H_ */
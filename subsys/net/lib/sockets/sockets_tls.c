@@ -32,8 +32,19 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/ssl_cookie.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
+#include <mbedtls/platform.h>
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+#include <mbedtls/ssl_cache.h>
+#endif
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+#include <mbedtls/ssl_ticket.h>
+#endif
 #endif /* CONFIG_MBEDTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#include <sys/crc.h>
+#endif
+
 #include "sockets_internal.h"
 #include "tls_internal.h"
 
@@ -96,6 +107,11 @@ __net_socket struct tls_context {
 	/** Information whether TLS handshake is currently in progress. */
 	bool handshake_in_progress;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	/** Information whether the last handshake resumed a cached session. */
+	bool session_resumed;
+#endif
+
 	/** Information whether TLS handshake is complete or not. */
 	struct k_sem tls_established;
 
@@ -127,6 +143,9 @@ __net_socket struct tls_context {
 		uint32_t dtls_handshake_timeout_min;
 		uint32_t dtls_handshake_timeout_max;
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
+
+		/** Information whether sessions are cached for resumption. */
+		bool cache_enabled;
 	} options;
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -170,6 +189,52 @@ static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 /* A mutex for protecting TLS context allocation. */
 static struct k_mutex context_lock;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/** A TLS session stored by a client for resumption. */
+struct tls_session_cache {
+	/** Peer address the session was negotiated with. */
+	struct sockaddr peer_addr;
+
+	/** CRC32 of the peer hostname, 0 if hostname was not set. */
+	uint32_t hostname_hash;
+
+	/** Value of the use counter at the last use, for replacement. */
+	uint32_t timestamp;
+
+	/** Session serialized with mbedtls_ssl_session_save(). */
+	unsigned char *session;
+
+	/** Length of the serialized session. */
+	size_t session_len;
+};
+
+/* Sessions of TLS/DTLS clients. */
+static struct tls_session_cache
+	client_cache[CONFIG_NET_SOCKETS_TLS_MAX_CLIENT_SESSION_COUNT];
+
+/* A mutex for protecting the client session cache. */
+static struct k_mutex client_cache_lock;
+
+/* Counter of client session cache uses, for the LRU replacement. */
+static uint32_t client_cache_use;
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C) || defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+/* A mutex for protecting the server session cache and ticket keys, which
+ * are shared by all TLS/DTLS servers.
+ */
+static struct k_mutex server_cache_lock;
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+static mbedtls_ssl_cache_context server_cache;
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+static mbedtls_ssl_ticket_context server_ticket;
+static bool server_ticket_ready;
+#endif
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 bool net_socket_is_tls(void *obj)
 {
 	return PART_OF_ARRAY(tls_contexts, (struct tls_context *)obj);
@@ -258,6 +323,74 @@ static int dtls_timing_get_delay(void *data)
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+static void tls_server_cache_init(void)
+{
+	mbedtls_ssl_cache_init(&server_cache);
+	mbedtls_ssl_cache_set_max_entries(
+		&server_cache, CONFIG_NET_SOCKETS_TLS_MAX_SERVER_SESSION_COUNT);
+	mbedtls_ssl_cache_set_timeout(&server_cache,
+				      CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+}
+
+/* mbedTLS does not lock the cache unless MBEDTLS_THREADING_C is enabled,
+ * so serialize the servers here.
+ */
+static int tls_server_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&server_cache_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_get(data, session);
+	k_mutex_unlock(&server_cache_lock);
+
+	return ret;
+}
+
+static int tls_server_cache_set(void *data, const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&server_cache_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&server_cache_lock);
+
+	return ret;
+}
+#endif /* CONFIG_MBEDTLS_SSL_CACHE_C */
+
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+static int tls_server_ticket_write(void *p_ticket,
+				   const mbedtls_ssl_session *session,
+				   unsigned char *start,
+				   const unsigned char *end,
+				   size_t *tlen, uint32_t *lifetime)
+{
+	int ret;
+
+	k_mutex_lock(&server_cache_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_write(p_ticket, session, start, end, tlen,
+				       lifetime);
+	k_mutex_unlock(&server_cache_lock);
+
+	return ret;
+}
+
+static int tls_server_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+				   unsigned char *buf, size_t len)
+{
+	int ret;
+
+	k_mutex_lock(&server_cache_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+	k_mutex_unlock(&server_cache_lock);
+
+	return ret;
+}
+#endif /* CONFIG_MBEDTLS_SSL_TICKET_C */
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 /* Initialize TLS internals. */
 static int tls_init(const struct device *unused)
 {
@@ -276,6 +409,29 @@ static int tls_init(const struct device *unused)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	k_mutex_init(&client_cache_lock);
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C) || defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+	k_mutex_init(&server_cache_lock);
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+	tls_server_cache_init();
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_init(&server_ticket);
+	if (mbedtls_ssl_ticket_setup(&server_ticket, tls_ctr_drbg_random, NULL,
+				     MBEDTLS_CIPHER_AES_256_GCM,
+				     CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME)) {
+		NET_WARN("Failed to set up TLS session tickets");
+	} else {
+		server_ticket_ready = true;
+	}
+#endif
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	return 0;
 }
 
@@ -447,6 +603,235 @@ static inline int time_left(uint32_t start, uint32_t timeout)
 	return timeout - elapsed;
 }
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static uint32_t tls_session_hostname_hash(struct tls_context *context)
+{
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (context->options.is_hostname_set && context->ssl.hostname) {
+		return crc32_ieee(context->ssl.hostname,
+				  strlen(context->ssl.hostname));
+	}
+#endif
+
+	return 0;
+}
+
+static bool tls_session_is_match(struct tls_session_cache *entry,
+				 const struct sockaddr *peer_addr,
+				 uint32_t hostname_hash)
+{
+	if (entry->session == NULL ||
+	    entry->hostname_hash != hostname_hash ||
+	    entry->peer_addr.sa_family != peer_addr->sa_family) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && peer_addr->sa_family == AF_INET6) {
+		struct sockaddr_in6 *addr1 = net_sin6(peer_addr);
+		struct sockaddr_in6 *addr2 = net_sin6(&entry->peer_addr);
+
+		return (addr1->sin6_port == addr2->sin6_port) &&
+			net_ipv6_addr_cmp(&addr1->sin6_addr, &addr2->sin6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		   peer_addr->sa_family == AF_INET) {
+		struct sockaddr_in *addr1 = net_sin(peer_addr);
+		struct sockaddr_in *addr2 = net_sin(&entry->peer_addr);
+
+		return (addr1->sin_port == addr2->sin_port) &&
+			net_ipv4_addr_cmp(&addr1->sin_addr, &addr2->sin_addr);
+	}
+
+	return false;
+}
+
+/* Must be invoked with client cache lock held */
+static struct tls_session_cache *tls_session_find(
+					const struct sockaddr *peer_addr,
+					uint32_t hostname_hash)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+		if (tls_session_is_match(&client_cache[i], peer_addr,
+					 hostname_hash)) {
+			return &client_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be invoked with client cache lock held */
+static void tls_session_free(struct tls_session_cache *entry)
+{
+	mbedtls_free(entry->session);
+	(void)memset(entry, 0, sizeof(*entry));
+}
+
+/* Store the session negotiated by a client after a successful handshake. */
+static void tls_session_store(struct tls_context *context,
+			      const struct sockaddr *peer_addr,
+			      socklen_t addrlen)
+{
+	struct tls_session_cache *entry;
+	mbedtls_ssl_session session, cached;
+	uint32_t hostname_hash;
+	unsigned char *data;
+	size_t len = 0;
+	int ret, i;
+
+	context->session_resumed = false;
+
+	if (!context->options.cache_enabled ||
+	    addrlen > sizeof(entry->peer_addr)) {
+		return;
+	}
+
+	hostname_hash = tls_session_hostname_hash(context);
+
+	mbedtls_ssl_session_init(&session);
+
+	ret = mbedtls_ssl_get_session(&context->ssl, &session);
+	if (ret != 0) {
+		NET_DBG("Failed to get TLS session: -%x", -ret);
+		goto exit;
+	}
+
+	/* The first call only returns the length of the serialized session */
+	(void)mbedtls_ssl_session_save(&session, NULL, 0, &len);
+	if (len == 0) {
+		goto exit;
+	}
+
+	data = mbedtls_calloc(1, len);
+	if (data == NULL) {
+		NET_DBG("No memory for TLS session (%zu bytes)", len);
+		goto exit;
+	}
+
+	ret = mbedtls_ssl_session_save(&session, data, len, &len);
+	if (ret != 0) {
+		NET_DBG("Failed to save TLS session: -%x", -ret);
+		mbedtls_free(data);
+		goto exit;
+	}
+
+	k_mutex_lock(&client_cache_lock, K_FOREVER);
+
+	entry = tls_session_find(peer_addr, hostname_hash);
+	if (entry != NULL) {
+		/* A resumed session keeps the master secret of the cached
+		 * one.
+		 */
+		mbedtls_ssl_session_init(&cached);
+
+		if (mbedtls_ssl_session_load(&cached, entry->session,
+					     entry->session_len) == 0 &&
+		    memcmp(cached.master, session.master,
+			   sizeof(session.master)) == 0) {
+			context->session_resumed = true;
+		}
+
+		mbedtls_ssl_session_free(&cached);
+	} else {
+		/* Take a free entry or the least recently used one. */
+		entry = &client_cache[0];
+
+		for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+			if (client_cache[i].session == NULL) {
+				entry = &client_cache[i];
+				break;
+			}
+
+			if ((int32_t)(client_cache[i].timestamp -
+				      entry->timestamp) < 0) {
+				entry = &client_cache[i];
+			}
+		}
+	}
+
+	tls_session_free(entry);
+
+	memcpy(&entry->peer_addr, peer_addr, addrlen);
+	entry->hostname_hash = hostname_hash;
+	entry->timestamp = ++client_cache_use;
+	entry->session = data;
+	entry->session_len = len;
+
+	k_mutex_unlock(&client_cache_lock);
+
+exit:
+	mbedtls_ssl_session_free(&session);
+}
+
+/* Offer a cached session to the peer, must be invoked after
+ * tls_mbedtls_init().
+ */
+static void tls_session_restore(struct tls_context *context,
+				const struct sockaddr *peer_addr)
+{
+	struct tls_session_cache *entry;
+	mbedtls_ssl_session session;
+	int ret;
+
+	if (!context->options.cache_enabled) {
+		return;
+	}
+
+	mbedtls_ssl_session_init(&session);
+
+	k_mutex_lock(&client_cache_lock, K_FOREVER);
+
+	entry = tls_session_find(peer_addr,
+				 tls_session_hostname_hash(context));
+	if (entry == NULL) {
+		goto exit;
+	}
+
+	ret = mbedtls_ssl_session_load(&session, entry->session,
+				       entry->session_len);
+	if (ret == 0) {
+		ret = mbedtls_ssl_set_session(&context->ssl, &session);
+	}
+
+	if (ret != 0) {
+		NET_DBG("Failed to restore TLS session: -%x", -ret);
+		tls_session_free(entry);
+		goto exit;
+	}
+
+	entry->timestamp = ++client_cache_use;
+
+exit:
+	k_mutex_unlock(&client_cache_lock);
+
+	mbedtls_ssl_session_free(&session);
+}
+
+static void tls_session_purge(void)
+{
+	int i;
+
+	k_mutex_lock(&client_cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(client_cache); i++) {
+		tls_session_free(&client_cache[i]);
+	}
+
+	k_mutex_unlock(&client_cache_lock);
+
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+	k_mutex_lock(&server_cache_lock, K_FOREVER);
+	mbedtls_ssl_cache_free(&server_cache);
+	tls_server_cache_init();
+	k_mutex_unlock(&server_cache_lock);
+#endif
+}
+#else
+#define tls_session_store(...)
+#define tls_session_restore(...)
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 static bool dtls_is_peer_addr_valid(struct tls_context *context,
 				    const struct sockaddr *peer_addr,
@@ -977,6 +1362,24 @@ static int tls_mbedtls_init(struct tls_context *context, bool is_server)
 		return ret;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	if (is_server && context->options.cache_enabled) {
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_C)
+		mbedtls_ssl_conf_session_cache(&context->config, &server_cache,
+					       tls_server_cache_get,
+					       tls_server_cache_set);
+#endif
+#if defined(CONFIG_MBEDTLS_SSL_TICKET_C)
+		if (server_ticket_ready) {
+			mbedtls_ssl_conf_session_tickets_cb(&context->config,
+						tls_server_ticket_write,
+						tls_server_ticket_parse,
+						&server_ticket);
+		}
+#endif
+	}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #if defined(CONFIG_MBEDTLS_SSL_ALPN)
 	if (ALPN_MAX_PROTOCOLS && context->options.alpn_list[0] != NULL) {
 		ret = mbedtls_ssl_conf_alpn_protocols(&context->config,
@@ -1236,6 +1639,71 @@ static int tls_opt_dtls_handshake_timeout_set(struct tls_context *context,
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static int tls_opt_session_cache_set(struct tls_context *context,
+				     const void *optval, socklen_t optlen)
+{
+	int *val = (int *)optval;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	if (*val != TLS_SESSION_CACHE_DISABLED &&
+	    *val != TLS_SESSION_CACHE_ENABLED) {
+		return -EINVAL;
+	}
+
+	context->options.cache_enabled = (*val == TLS_SESSION_CACHE_ENABLED);
+
+	return 0;
+}
+
+static int tls_opt_session_cache_get(struct tls_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	int *val = (int *)optval;
+
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*val = context->options.cache_enabled ? TLS_SESSION_CACHE_ENABLED :
+						TLS_SESSION_CACHE_DISABLED;
+
+	return 0;
+}
+
+static int tls_opt_session_cache_purge_set(struct tls_context *context,
+					   const void *optval,
+					   socklen_t optlen)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(optval);
+	ARG_UNUSED(optlen);
+
+	tls_session_purge();
+
+	return 0;
+}
+
+static int tls_opt_session_resumed_get(struct tls_context *context,
+				       void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->session_resumed ? 1 : 0;
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 static int tls_opt_alpn_list_get(struct tls_context *context,
 				 void *optval, socklen_t *optlen)
 {
@@ -1432,6 +1900,8 @@ int ztls_connect_ctx(struct tls_context *ctx, const struct sockaddr *addr,
 			goto error;
 		}
 
+		tls_session_restore(ctx, addr);
+
 		/* Do not use any socket flags during the handshake. */
 		ctx->flags = 0;
 
@@ -1442,6 +1912,8 @@ int ztls_connect_ctx(struct tls_context *ctx, const struct sockaddr *addr,
 		if (ret < 0) {
 			goto error;
 		}
+
+		tls_session_store(ctx, addr, addrlen);
 	} else {
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 		/* Just store the address. */
@@ -1572,6 +2044,8 @@ static ssize_t sendto_dtls_client(struct tls_context *ctx, const void *buf,
 		if (ret < 0) {
 			goto error;
 		}
+
+		tls_session_restore(ctx, &ctx->dtls_peer_addr);
 	}
 
 	if (!is_handshake_complete(ctx)) {
@@ -1582,6 +2056,9 @@ static ssize_t sendto_dtls_client(struct tls_context *ctx, const void *buf,
 		if (ret < 0) {
 			goto error;
 		}
+
+		tls_session_store(ctx, &ctx->dtls_peer_addr,
+				  ctx->dtls_peer_addrlen);
 	}
 
 	return send_tls(ctx, buf, len, flags);
@@ -2325,6 +2802,16 @@ int ztls_getsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		break;
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_RESUMED:
+		err = tls_opt_session_resumed_get(ctx, optval, optlen);
+		break;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -2386,6 +2873,16 @@ int ztls_setsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		break;
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_CACHE_PURGE:
+		err = tls_opt_session_cache_purge_set(ctx, optval, optlen);
+		break;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
@@ -440,6 +440,47 @@ static int websocket_ioctl_vmeth(void *obj, unsigned int request, va_list args)
 	return sock_fd_op_vtable.fd_vtable.ioctl(obj, request, args);
 }
 
+/* Copy len bytes from src to dst and XOR them with the masking value.
+ * The offset is the position of src[0] within the message payload and
+ * selects the masking byte to start with. The bulk of the data is masked
+ * a machine word at a time.
+ */
+static void websocket_mask_copy(uint8_t *dst, const uint8_t *src, size_t len,
+				uint32_t masking_value, uint64_t offset)
+{
+	uint8_t key[sizeof(uintptr_t)];
+	uintptr_t key_word, word;
+	size_t i = 0, j;
+
+	/* Start the key from the masking byte that applies to src[0] */
+	for (j = 0; j < sizeof(key); j++) {
+		key[j] = masking_value >> (8 * (3 - (offset + j) % 4));
+	}
+
+	/* Go byte by byte until the destination is word aligned */
+	while (i < len && POINTER_TO_UINT(&dst[i]) % sizeof(uintptr_t)) {
+		dst[i] = src[i] ^ key[i % 4];
+		i++;
+	}
+
+	/* Word size is a multiple of 4 so the key pattern stays in phase
+	 * for every word, it only needs to start from the right byte.
+	 */
+	for (j = 0; j < sizeof(key); j++) {
+		((uint8_t *)&key_word)[j] = key[(i + j) % 4];
+	}
+
+	for (; len - i >= sizeof(uintptr_t); i += sizeof(uintptr_t)) {
+		memcpy(&word, &src[i], sizeof(word));
+		word ^= key_word;
+		memcpy(&dst[i], &word, sizeof(word));
+	}
+
+	for (; i < len; i++) {
+		dst[i] = src[i] ^ key[i % 4];
+	}
+}
+
 static int websocket_prepare_and_send(struct websocket_context *ctx,
 				      uint8_t *header, size_t header_len,
 				      uint8_t *payload, size_t payload_len,
@@ -486,6 +527,7 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 {
 	struct websocket_context *ctx;
 	uint8_t header[MAX_HEADER_LEN], hdr_len = 2;
+	uint8_t mask_buf[CONFIG_WEBSOCKET_MASK_BUF_LEN];
 	uint8_t *data_to_send = (uint8_t *)payload;
 	int ret;
 
@@ -550,8 +592,6 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 
 	/* Add masking value if needed */
 	if (mask) {
-		int i;
-
 		ctx->masking_value = sys_rand32_get();
 
 		header[hdr_len++] |= ctx->masking_value >> 24;
@@ -559,17 +599,21 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		header[hdr_len++] |= ctx->masking_value >> 8;
 		header[hdr_len++] |= ctx->masking_value;
 
-		data_to_send = k_malloc(payload_len);
-		if (!data_to_send) {
-			return -ENOMEM;
+		/* The caller's payload cannot be masked in place, so small
+		 * payloads are masked into a stack buffer and only the large
+		 * ones need a heap allocation.
+		 */
+		if (payload_len <= sizeof(mask_buf)) {
+			data_to_send = mask_buf;
+		} else {
+			data_to_send = k_malloc(payload_len);
+			if (!data_to_send) {
+				return -ENOMEM;
+			}
 		}
 
-		memcpy(data_to_send, payload, payload_len);
-
-		for (i = 0; i < payload_len; i++) {
-			data_to_send[i] ^=
-				ctx->masking_value >> (8 * (3 - i % 4));
-		}
+		websocket_mask_copy(data_to_send, payload, payload_len,
+				    ctx->masking_value, 0);
 	}
 
 	ret = websocket_prepare_and_send(ctx, header, hdr_len,
@@ -580,7 +624,7 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 	}
 
 quit:
-	if (data_to_send != payload) {
+	if (data_to_send != payload && data_to_send != mask_buf) {
 		k_free(data_to_send);
 	}
 
@@ -820,7 +864,14 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 
 	NET_ASSERT(ctx->tmp_buf_pos >= can_copy);
 
-	memmove(buf, ctx->tmp_buf, can_copy);
+	/* Unmask the data while copying it to the caller */
+	if (ctx->masked) {
+		websocket_mask_copy(buf, ctx->tmp_buf, can_copy,
+				    ctx->masking_value, ctx->total_read);
+	} else {
+		memmove(buf, ctx->tmp_buf, can_copy);
+	}
+
 	recv_len = can_copy;
 
 	if (left > 0) {
@@ -830,21 +881,6 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	ctx->tmp_buf_pos = left;
 	ctx->total_read += recv_len;
 
-	/* Unmask the data */
-	if (ctx->masked) {
-		/* As we might have less than 4 received bytes, we must select
-		 * which byte from masking value to take. The mask_shift will
-		 * tell that.
-		 */
-		int mask_shift = (ctx->total_read - recv_len) % sizeof(uint32_t);
-		int i;
-
-		for (i = 0; i < recv_len; i++) {
-			buf[i] ^= ctx->masking_value >>
-				(8 * (3 - (i + mask_shift) % 4));
-		}
-	}
-
 #if HEXDUMP_RECV_PACKETS
 	LOG_HEXDUMP_DBG(buf, recv_len, "Payload");
 #endif
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * 6LoWPAN header compression benchmark. Measures the time taken to compress
+ * and uncompress the IPv6/UDP header of packets that belong to the same
+ * flow, as sent and received by a busy 802.15.4 node.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#include "6lo.h"
+#include "icmpv6.h"
+
+#define ITERATIONS 500
+#define PAYLOAD_LEN 40
+
+struct flow {
+	const char *name;
+	struct in6_addr src;
+	struct in6_addr dst;
+};
+
+static uint8_t src_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaa, 0xbb };
+static uint8_t dst_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbb, 0xaa };
+
+static struct net_icmpv6_nd_opt_6co ctx = {
+	.context_len = 0x40,
+	.flag = 0x11,
+	.lifetime = 0x1234,
+	.prefix = { { { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0 } } },
+};
+
+static const struct flow flows[] = {
+	{
+		.name = "inline",
+		.src = { { { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x02, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x01 } } },
+		.dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x03, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x02 } } },
+	},
+	{
+		/* Prefix from the context, IID from the link layer address */
+		.name = "context",
+		.src = { { { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0xaa, 0xbb } } },
+		.dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0xbb, 0xaa } } },
+	},
+};
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, src_mac, sizeof(src_mac),
+			     NET_LINK_IEEE802154);
+}
+
+static int bench_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_6lo_bench, "net_6lo_bench", NULL, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &bench_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static struct net_pkt *create_pkt(struct net_if *iface,
+				  const struct flow *flow)
+{
+	struct net_ipv6_hdr *ipv6;
+	struct net_udp_hdr *udp;
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+
+	pkt = net_pkt_alloc_on_iface(iface, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	frag = net_pkt_get_frag(pkt, K_NO_WAIT);
+	if (!frag) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_frag_add(pkt, frag);
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+
+	net_pkt_lladdr_src(pkt)->addr = src_mac;
+	net_pkt_lladdr_src(pkt)->len = sizeof(src_mac);
+	net_pkt_lladdr_dst(pkt)->addr = dst_mac;
+	net_pkt_lladdr_dst(pkt)->len = sizeof(dst_mac);
+
+	ipv6 = net_buf_add(frag, NET_IPV6H_LEN);
+	memset(ipv6, 0, NET_IPV6H_LEN);
+	ipv6->vtc = 0x60;
+	ipv6->len = htons(NET_UDPH_LEN + PAYLOAD_LEN);
+	ipv6->nexthdr = IPPROTO_UDP;
+	ipv6->hop_limit = 64U;
+	net_ipaddr_copy(&ipv6->src, &flow->src);
+	net_ipaddr_copy(&ipv6->dst, &flow->dst);
+
+	udp = net_buf_add(frag, NET_UDPH_LEN);
+	udp->src_port = htons(5683);
+	udp->dst_port = htons(5683);
+	udp->len = ipv6->len;
+	udp->chksum = 0U;
+
+	memset(net_buf_add(frag, PAYLOAD_LEN), 0x5a, PAYLOAD_LEN);
+
+	return pkt;
+}
+
+static int run(struct net_if *iface, const struct flow *flow)
+{
+	uint32_t start, compress = 0U, uncompress = 0U;
+	struct net_pkt *pkt;
+	int i;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		pkt = create_pkt(iface, flow);
+		if (!pkt) {
+			printk("Cannot allocate packet\n");
+			return -ENOMEM;
+		}
+
+		net_pkt_cursor_init(pkt);
+
+		start = k_cycle_get_32();
+		if (net_6lo_compress(pkt, true) < 0) {
+			printk("%s: compression failed\n", flow->name);
+			net_pkt_unref(pkt);
+			return -EINVAL;
+		}
+		compress += k_cycle_get_32() - start;
+
+		start = k_cycle_get_32();
+		if (!net_6lo_uncompress(pkt)) {
+			printk("%s: uncompression failed\n", flow->name);
+			net_pkt_unref(pkt);
+			return -EINVAL;
+		}
+		uncompress += k_cycle_get_32() - start;
+
+		net_pkt_unref(pkt);
+	}
+
+	printk("%s: compress %u ns, uncompress %u ns\n", flow->name,
+	       (uint32_t)(k_cyc_to_ns_floor64(compress) / ITERATIONS),
+	       (uint32_t)(k_cyc_to_ns_floor64(uncompress) / ITERATIONS));
+
+	return 0;
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	int i;
+
+	net_6lo_set_context(iface, &ctx);
+
+	for (i = 0; i < ARRAY_SIZE(flows); i++) {
+		if (run(iface, &flows[i]) < 0) {
+			return;
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * ARP cache benchmark. Fills the ARP cache with many neighbours and
+ * measures how long net_arp_prepare() takes to resolve the link layer
+ * address of a packet sent to one of them.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "arp.h"
+
+#define NEIGHBOURS 1000
+#define ROUNDS 10
+
+/* Visit the neighbours in a different order than they were added */
+#define STRIDE 7
+
+static struct in_addr my_addr = { { { 10, 0, 0, 1 } } };
+static struct in_addr netmask = { { { 255, 0, 0, 0 } } };
+
+static uint8_t mac_addr[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+static void neighbour_addr(int idx, struct in_addr *addr,
+			   struct net_eth_addr *hwaddr)
+{
+	idx++;
+
+	addr->s4_addr[0] = 10;
+	addr->s4_addr[1] = 1;
+	addr->s4_addr[2] = idx >> 8;
+	addr->s4_addr[3] = idx & 0xff;
+
+	hwaddr->addr[0] = 0x02;
+	hwaddr->addr[1] = 0x00;
+	hwaddr->addr[2] = 0x00;
+	hwaddr->addr[3] = 0x00;
+	hwaddr->addr[4] = idx >> 8;
+	hwaddr->addr[5] = idx & 0xff;
+}
+
+static int bench_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+/* The ARP replies to the neighbours are dropped here */
+static int bench_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static const struct ethernet_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_arp_bench, "net_arp_bench",
+		bench_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, ETHERNET_L2,
+		NET_L2_GET_CTX_TYPE(ETHERNET_L2), NET_ETH_MTU);
+
+/* Feed in an ARP request from neighbour idx, which adds it to the cache */
+static int add_neighbour(struct net_if *iface, int idx)
+{
+	struct net_eth_addr hwaddr;
+	struct net_arp_hdr *hdr;
+	struct net_eth_hdr *eth;
+	struct in_addr addr;
+	struct net_pkt *pkt;
+
+	neighbour_addr(idx, &addr, &hwaddr);
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	eth = NET_ETH_HDR(pkt);
+
+	(void)memset(&eth->dst.addr, 0xff, sizeof(struct net_eth_addr));
+	memcpy(&eth->src.addr, &hwaddr, sizeof(struct net_eth_addr));
+	eth->type = htons(NET_ETH_PTYPE_ARP);
+
+	net_buf_add(pkt->buffer, sizeof(struct net_eth_hdr));
+	net_buf_pull(pkt->buffer, sizeof(struct net_eth_hdr));
+
+	hdr = NET_ARP_HDR(pkt);
+
+	hdr->hwtype = htons(NET_ARP_HTYPE_ETH);
+	hdr->protocol = htons(NET_ETH_PTYPE_IP);
+	hdr->hwlen = sizeof(struct net_eth_addr);
+	hdr->protolen = sizeof(struct in_addr);
+	hdr->opcode = htons(NET_ARP_REQUEST);
+
+	(void)memset(&hdr->dst_hwaddr.addr, 0x00, sizeof(struct net_eth_addr));
+	memcpy(&hdr->src_hwaddr.addr, &hwaddr, sizeof(struct net_eth_addr));
+
+	net_ipaddr_copy(&hdr->src_ipaddr, &addr);
+	net_ipaddr_copy(&hdr->dst_ipaddr, &my_addr);
+
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	if (net_arp_input(pkt, eth) != NET_OK) {
+		net_pkt_unref(pkt);
+		return -EINVAL;
+	}
+
+	/* Let the TX thread get rid of the reply */
+	k_yield();
+
+	return 0;
+}
+
+static int lookup(struct net_pkt *pkt, int idx, uint64_t *cycles)
+{
+	struct net_eth_addr hwaddr;
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *ret;
+	uint32_t start;
+
+	ipv4 = NET_IPV4_HDR(pkt);
+	neighbour_addr(idx, &ipv4->dst, &hwaddr);
+
+	start = k_cycle_get_32();
+	ret = net_arp_prepare(pkt, &ipv4->dst, NULL);
+	*cycles += k_cycle_get_32() - start;
+
+	if (ret != pkt) {
+		/* An ARP request instead of the packet means a miss */
+		if (ret) {
+			net_pkt_unref(ret);
+		}
+
+		return -ENOENT;
+	}
+
+	if (memcmp(net_pkt_lladdr_dst(pkt)->addr, &hwaddr,
+		   sizeof(struct net_eth_addr))) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	struct net_if_addr *ifaddr;
+	struct net_ipv4_hdr *ipv4;
+	uint64_t cycles = 0;
+	struct net_pkt *pkt;
+	struct net_if *iface;
+	int i, round, idx, ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(ETHERNET));
+	if (!iface) {
+		printk("No Ethernet interface\n");
+		return;
+	}
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	if (!ifaddr) {
+		printk("Cannot add IPv4 address\n");
+		return;
+	}
+
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	for (i = 0; i < NEIGHBOURS; i++) {
+		ret = add_neighbour(iface, i);
+		if (ret < 0) {
+			printk("Cannot add neighbour %d (%d)\n", i, ret);
+			return;
+		}
+	}
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_ipv4_hdr),
+					AF_INET, 0, K_SECONDS(1));
+	if (!pkt) {
+		printk("Out of packets\n");
+		return;
+	}
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	(void)memset(ipv4, 0, sizeof(*ipv4));
+	net_ipaddr_copy(&ipv4->src, &my_addr);
+
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0, idx = round; i < NEIGHBOURS; i++) {
+			ret = lookup(pkt, idx, &cycles);
+			if (ret < 0) {
+				printk("Lookup of neighbour %d failed (%d)\n",
+				       idx, ret);
+				goto out;
+			}
+
+			idx = (idx + STRIDE) % NEIGHBOURS;
+		}
+	}
+
+	printk("%d neighbours, %d buckets: %u ns per lookup\n", NEIGHBOURS,
+	       CONFIG_NET_ARP_HASH_SIZE,
+	       (uint32_t)(k_cyc_to_ns_floor64(cycles) /
+			  (ROUNDS * NEIGHBOURS)));
+
+	printk("fin\n");
+
+out:
+	net_pkt_unref(pkt);
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Ethernet bridge forwarding benchmark. Frames between emulated hosts,
+ * one behind each port of a bridge, are injected into the ports and
+ * counted by their drivers when the bridge sends them. Prints the
+ * forwarding rate and the number of frames sent for frames to known and
+ * to unknown unicast addresses.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/ethernet.h>
+#include <net/ethernet_bridge.h>
+
+#define PORTS 4
+#define FRAMES CONFIG_NET_BRIDGE_BENCHMARK_FRAMES
+#define PAYLOAD_LEN 64
+
+/* Local experimental EtherType, so that other frames are not counted */
+#define BENCH_PTYPE 0x88b5
+
+BUILD_ASSERT(NET_TC_RX_COUNT == 0 && NET_TC_TX_COUNT == 0,
+	     "Frames must be forwarded in the benchmark thread");
+
+struct port_context {
+	struct net_if *iface;
+	uint32_t sent;
+	uint8_t mac[6];
+};
+
+static struct port_context ports[PORTS];
+static uint8_t payload[PAYLOAD_LEN];
+
+static ETH_BRIDGE_INIT(bench_bridge);
+
+static void port_iface_init(struct net_if *iface)
+{
+	const struct device *dev = net_if_get_device(iface);
+	struct port_context *ctx = dev->data;
+
+	ctx->iface = iface;
+
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	ctx->mac[0] = 0x00;
+	ctx->mac[1] = 0x00;
+	ctx->mac[2] = 0x5e;
+	ctx->mac[3] = 0x00;
+	ctx->mac[4] = 0x53;
+	ctx->mac[5] = ctx - ports;
+
+	net_if_set_link_addr(iface, ctx->mac, sizeof(ctx->mac),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+static int port_send(const struct device *dev, struct net_pkt *pkt)
+{
+	struct port_context *ctx = dev->data;
+
+	if (NET_ETH_HDR(pkt)->type == htons(BENCH_PTYPE)) {
+		ctx->sent++;
+	}
+
+	return 0;
+}
+
+static enum ethernet_hw_caps port_get_capabilities(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return ETHERNET_PROMISC_MODE;
+}
+
+static int port_set_config(const struct device *dev,
+			   enum ethernet_config_type type,
+			   const struct ethernet_config *config)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(config);
+
+	return type == ETHERNET_CONFIG_TYPE_PROMISC_MODE ? 0 : -EINVAL;
+}
+
+static const struct ethernet_api port_api = {
+	.iface_api.init = port_iface_init,
+	.get_capabilities = port_get_capabilities,
+	.set_config = port_set_config,
+	.send = port_send,
+};
+
+static int port_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+#define BENCH_PORT(n)							\
+	ETH_NET_DEVICE_INIT(bench_port##n, "bench_port" #n, port_init,	\
+			    NULL, &ports[n], NULL,			\
+			    CONFIG_ETH_INIT_PRIORITY, &port_api,	\
+			    NET_ETH_MTU)
+
+BENCH_PORT(0);
+BENCH_PORT(1);
+BENCH_PORT(2);
+BENCH_PORT(3);
+
+/* MAC address of the emulated host behind a port */
+static void host_addr(int port, struct net_eth_addr *addr)
+{
+	addr->addr[0] = 0x02;
+	addr->addr[1] = 0x00;
+	addr->addr[2] = 0x00;
+	addr->addr[3] = 0x00;
+	addr->addr[4] = 0x01;
+	addr->addr[5] = port;
+}
+
+static struct net_pkt *host_frame(int port, const struct net_eth_addr *dst)
+{
+	struct net_eth_hdr hdr;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_with_buffer(ports[port].iface,
+					   sizeof(hdr) + PAYLOAD_LEN,
+					   AF_UNSPEC, 0, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	host_addr(port, &hdr.src);
+	memcpy(&hdr.dst, dst, sizeof(hdr.dst));
+	hdr.type = htons(BENCH_PTYPE);
+
+	if (net_pkt_write(pkt, &hdr, sizeof(hdr)) < 0 ||
+	    net_pkt_write(pkt, payload, sizeof(payload)) < 0) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+
+static int inject(int port, struct net_pkt *pkt, uint64_t *total)
+{
+	uint32_t start;
+	int ret;
+
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	start = k_cycle_get_32();
+	ret = net_recv_data(ports[port].iface, pkt);
+	*total += k_cycle_get_32() - start;
+
+	if (ret < 0) {
+		net_pkt_unref(pkt);
+	}
+
+	return ret;
+}
+
+static uint32_t frames_per_s(uint64_t cycles)
+{
+	uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+	return ns ? (uint32_t)(FRAMES * 1000000000ULL / ns) : 0;
+}
+
+static uint32_t sent(void)
+{
+	uint32_t count = 0U;
+	int i;
+
+	for (i = 0; i < PORTS; i++) {
+		count += ports[i].sent;
+		ports[i].sent = 0U;
+	}
+
+	return count;
+}
+
+/* Send FRAMES frames from the hosts in turn, to the host behind the next
+ * port if known is set, else to an address that is never seen.
+ */
+static int bench_forward(const char *name, bool known)
+{
+	struct net_eth_addr dst;
+	uint64_t total = 0U;
+	int i, port, ret;
+
+	for (i = 0; i < FRAMES; i++) {
+		port = i % PORTS;
+
+		if (known) {
+			host_addr((port + 1) % PORTS, &dst);
+		} else {
+			host_addr(PORTS, &dst);
+			dst.addr[4] = 0xff;
+		}
+
+		ret = inject(port, host_frame(port, &dst), &total);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	printk("%s: %u frames/s, %u sent\n", name, frames_per_s(total), sent());
+
+	return 0;
+}
+
+/* Let the bridge learn where the hosts are with a broadcast frame from
+ * each of them.
+ */
+static int learn(void)
+{
+	struct net_eth_addr bcast;
+	uint64_t total = 0U;
+	int i, ret;
+
+	memset(&bcast, 0xff, sizeof(bcast));
+
+	for (i = 0; i < PORTS; i++) {
+		ret = inject(i, host_frame(i, &bcast), &total);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	(void)sent();
+
+	return 0;
+}
+
+static int setup(void)
+{
+	int i, ret;
+
+	for (i = 0; i < PORTS; i++) {
+		ret = eth_bridge_iface_add(&bench_bridge, ports[i].iface);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = eth_bridge_iface_allow_tx(ports[i].iface, true);
+		if (ret < 0) {
+			return ret;
+		}
+
+		net_if_up(ports[i].iface);
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	int ret;
+
+	memset(payload, 0xa5, sizeof(payload));
+
+	ret = setup();
+	if (ret == 0) {
+		ret = learn();
+	}
+
+	if (ret == 0) {
+		ret = bench_forward("known unicast", true);
+	}
+
+	if (ret == 0) {
+		ret = bench_forward("unknown unicast", false);
+	}
+
+	if (ret < 0) {
+		printk("Benchmark failed (%d)\n", ret);
+		return;
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Network packet capture benchmark. Measures the time the pcapng capture
+ * adds to every captured packet, with and without snap length and filter.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+#include <net/capture.h>
+
+#define ITERATIONS 1024
+#define BURST 32
+#define PKT_LEN 512
+
+struct run {
+	const char *name;
+	const char *filter;
+	uint16_t snaplen;
+};
+
+static const struct run runs[] = {
+	{ .name = "all" },
+	{ .name = "snaplen", .snaplen = 64 },
+	{ .name = "filter match", .filter = "udp port 5683" },
+	{ .name = "filter miss", .filter = "tcp or icmp6" },
+};
+
+static size_t written;
+
+static int bench_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int bench_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_capture_bench, "net_capture_bench", bench_dev_init,
+		NULL, NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static int discard(const void *data, size_t len, void *user_data)
+{
+	written += len;
+
+	return 0;
+}
+
+static struct net_pkt *create_pkt(struct net_if *iface)
+{
+	struct net_ipv6_hdr ipv6 = {
+		.vtc = 0x60,
+		.len = htons(PKT_LEN - sizeof(struct net_ipv6_hdr)),
+		.nexthdr = IPPROTO_UDP,
+		.hop_limit = 64U,
+		.src = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x01 } } },
+		.dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x02 } } },
+	};
+	struct net_udp_hdr udp = {
+		.src_port = htons(49152),
+		.dst_port = htons(5683),
+		.len = ipv6.len,
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, PKT_LEN, AF_INET6, IPPROTO_UDP,
+					K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_pkt_write(pkt, &ipv6, sizeof(ipv6)) < 0 ||
+	    net_pkt_write(pkt, &udp, sizeof(udp)) < 0 ||
+	    net_pkt_memset(pkt, 0x5a, PKT_LEN - sizeof(ipv6) - sizeof(udp)) <
+									0) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static int run(struct net_if *iface, struct net_pkt *pkt,
+	       const struct run *run)
+{
+	struct net_capture_pcapng_params params = {
+		.write_cb = discard,
+		.filter = run->filter,
+		.snaplen = run->snaplen,
+	};
+	struct net_capture_pcapng_stats stats;
+	uint32_t start, cycles = 0U;
+	int i, j, ret;
+
+	ret = net_capture_pcapng_start(iface, &params);
+	if (ret < 0) {
+		printk("%s: cannot start capture (%d)\n", run->name, ret);
+		return ret;
+	}
+
+	for (i = 0; i < ITERATIONS; i += BURST) {
+		start = k_cycle_get_32();
+		for (j = 0; j < BURST; j++) {
+			net_capture_pkt(iface, pkt);
+		}
+		cycles += k_cycle_get_32() - start;
+
+		/* Let the writer thread drain the capture buffer */
+		k_sleep(K_MSEC(1));
+	}
+
+	ret = net_capture_pcapng_stop();
+	if (ret < 0) {
+		printk("%s: cannot stop capture (%d)\n", run->name, ret);
+		return ret;
+	}
+
+	(void)net_capture_pcapng_stats_get(&stats);
+
+	printk("%s: %u ns per packet, %u dropped\n", run->name,
+	       (uint32_t)(k_cyc_to_ns_floor64(cycles) / ITERATIONS),
+	       stats.dropped);
+
+	return 0;
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	struct net_pkt *pkt;
+	int i;
+
+	pkt = create_pkt(iface);
+	if (!pkt) {
+		printk("Cannot create packet\n");
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(runs); i++) {
+		if (run(iface, pkt, &runs[i]) < 0) {
+			goto out;
+		}
+	}
+
+	printk("%zu bytes written\n", written);
+	printk("fin\n");
+
+out:
+	net_pkt_unref(pkt);
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Internet checksum benchmark. Measures the checksum calculation of UDP
+ * packets with different payload sizes and compares the results against
+ * a simple reference implementation.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <random/rand32.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+#include <net/ethernet.h>
+#include <net/udp.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define ITERATIONS 200
+#define MAX_PAYLOAD 1400
+
+#define SRC_PORT 4242
+#define DST_PORT 4243
+
+static const size_t payload_sizes[] = { 1, 21, 64, 255, 512, 1024,
+					MAX_PAYLOAD };
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static uint8_t payload[MAX_PAYLOAD];
+static uint8_t flat[NET_UDPH_LEN + MAX_PAYLOAD];
+
+static struct net_if *iface;
+
+static uint8_t *chksum_get_mac(const struct device *dev)
+{
+	static uint8_t mac_addr[6];
+
+	if (mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		mac_addr[0] = 0x00;
+		mac_addr[1] = 0x00;
+		mac_addr[2] = 0x5E;
+		mac_addr[3] = 0x00;
+		mac_addr[4] = 0x53;
+		mac_addr[5] = sys_rand32_get();
+	}
+
+	return mac_addr;
+}
+
+static void chksum_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = chksum_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, 6, NET_LINK_ETHERNET);
+}
+
+static int chksum_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int chksum_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static struct dummy_api chksum_if_api = {
+	.iface_api.init = chksum_iface_init,
+	.send = chksum_send,
+};
+
+NET_DEVICE_INIT(net_chksum_test, "net_chksum_test",
+		chksum_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&chksum_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2),
+		NET_ETH_MTU);
+
+/* Sum the data one 16-bit word at a time */
+static uint32_t ref_sum(uint32_t sum, const uint8_t *data, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (data[i] << 8) | data[i + 1];
+	}
+
+	if (len & 1) {
+		sum += data[len - 1] << 8;
+	}
+
+	return sum;
+}
+
+/* Checksum of the UDP header and payload in the flat buffer, including the
+ * IPv4 pseudo header. Returned in network byte order.
+ */
+static uint16_t ref_udp_chksum(size_t len)
+{
+	uint32_t sum;
+
+	sum = ref_sum(0, my_addr.s4_addr, sizeof(my_addr));
+	sum = ref_sum(sum, peer_addr.s4_addr, sizeof(peer_addr));
+	sum += IPPROTO_UDP + len;
+	sum = ref_sum(sum, flat, len);
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	sum = ~sum & 0xffff;
+
+	return htons(sum == 0U ? 0xffff : sum);
+}
+
+static void ref_udp_prepare(size_t len)
+{
+	struct net_udp_hdr *hdr = (struct net_udp_hdr *)flat;
+
+	hdr->src_port = htons(SRC_PORT);
+	hdr->dst_port = htons(DST_PORT);
+	hdr->len = htons(NET_UDPH_LEN + len);
+	hdr->chksum = 0U;
+
+	memcpy(flat + NET_UDPH_LEN, payload, len);
+}
+
+static struct net_pkt *create_pkt(size_t len, bool copy_chksum)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, len, AF_INET, IPPROTO_UDP,
+					K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_ipv4_create(pkt, &my_addr, &peer_addr) ||
+	    net_udp_create(pkt, htons(SRC_PORT), htons(DST_PORT))) {
+		goto fail;
+	}
+
+	if (copy_chksum) {
+		ret = net_pkt_write_chksum(pkt, payload, len);
+	} else {
+		ret = net_pkt_write(pkt, payload, len);
+	}
+
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	return pkt;
+
+fail:
+	net_pkt_unref(pkt);
+	return NULL;
+}
+
+static uint16_t pkt_udp_chksum(struct net_pkt *pkt)
+{
+	struct net_udp_hdr hdr, *udp_hdr;
+
+	net_pkt_cursor_init(pkt);
+
+	udp_hdr = net_udp_get_hdr(pkt, &hdr);
+	if (!udp_hdr) {
+		return 0U;
+	}
+
+	return udp_hdr->chksum;
+}
+
+static uint32_t ns_per_iteration(uint32_t cycles)
+{
+	return (uint32_t)(k_cyc_to_ns_floor64(cycles) / ITERATIONS);
+}
+
+static int run(size_t len)
+{
+	uint32_t start, ref_ns, pkt_ns, send_ns, copy_ns;
+	volatile uint16_t result;
+	struct net_pkt *pkt;
+	uint16_t expected;
+	int i;
+
+	ref_udp_prepare(len);
+	expected = ref_udp_chksum(NET_UDPH_LEN + len);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = ref_udp_chksum(NET_UDPH_LEN + len);
+	}
+	ref_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	pkt = create_pkt(len, false);
+	if (!pkt) {
+		printk("Cannot create pkt, size %zu\n", len);
+		return -ENOMEM;
+	}
+
+	if (pkt_udp_chksum(pkt) != expected) {
+		printk("FAIL: size %zu chksum 0x%04x expected 0x%04x\n", len,
+		       ntohs(pkt_udp_chksum(pkt)), ntohs(expected));
+		net_pkt_unref(pkt);
+		return -EINVAL;
+	}
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = net_calc_verify_chksum_udp(pkt);
+	}
+	pkt_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	net_pkt_unref(pkt);
+
+	if (result != 0U) {
+		printk("FAIL: size %zu verify 0x%04x\n", len, result);
+		return -EINVAL;
+	}
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		pkt = create_pkt(len, false);
+		if (!pkt) {
+			return -ENOMEM;
+		}
+
+		net_pkt_unref(pkt);
+	}
+	send_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		pkt = create_pkt(len, true);
+		if (!pkt) {
+			return -ENOMEM;
+		}
+
+		if (pkt_udp_chksum(pkt) != expected) {
+			printk("FAIL: size %zu copy chksum 0x%04x "
+			       "expected 0x%04x\n", len,
+			       ntohs(pkt_udp_chksum(pkt)), ntohs(expected));
+			net_pkt_unref(pkt);
+			return -EINVAL;
+		}
+
+		net_pkt_unref(pkt);
+	}
+	copy_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	printk("size %zu: ref %u ns, pkt %u ns, send %u ns, "
+	       "send copy %u ns\n", len, ref_ns, pkt_ns, send_ns, copy_ns);
+
+	return 0;
+}
+
+void main(void)
+{
+	int i;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	if (!iface) {
+		printk("Cannot find dummy interface\n");
+		return;
+	}
+
+	sys_rand_get(payload, sizeof(payload));
+
+	printk("Iterations %d, net_buf data size %d\n", ITERATIONS,
+	       CONFIG_NET_BUF_DATA_SIZE);
+
+	for (i = 0; i < ARRAY_SIZE(payload_sizes); i++) {
+		if (run(payload_sizes[i]) < 0) {
+			return;
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * CoAP block-wise transfer benchmark. Fetches and sends a body between a
+ * client and a server over the loopback interface, with the responses of
+ * the server delayed to emulate a long round trip time, and measures the
+ * transfer time with one and with several blocks in flight.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/socket.h>
+#include <net/coap.h>
+#include <net/coap_blockwise.h>
+
+#define BODY_LEN (16 * 1024)
+#define RTT_MS 100
+#define SERVER_PORT 5683
+#define MAX_DELAYED (2 * CONFIG_COAP_BLOCKWISE_WINDOW)
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const char * const path[] = { "fw", "image", NULL };
+
+static struct sockaddr_in addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(SERVER_PORT),
+	.sin_addr = { { { 192, 0, 2, 1 } } },
+};
+
+/* Responses held by the server until their round trip time passed */
+static struct {
+	uint8_t data[COAP_BLOCKWISE_BUF_LEN];
+	uint16_t len;
+	int64_t due;
+	struct sockaddr addr;
+	socklen_t addr_len;
+} delayed[MAX_DELAYED];
+
+static struct coap_blockwise_server server;
+static size_t received;
+static bool body_ok;
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+
+static inline uint8_t body_byte(size_t offset)
+{
+	return (uint8_t)(offset * 7 + (offset >> 8));
+}
+
+static int source(size_t offset, uint8_t *data, size_t len, bool *last,
+		  void *user_data)
+{
+	size_t i;
+
+	ARG_UNUSED(user_data);
+
+	len = offset < BODY_LEN ? MIN(len, BODY_LEN - offset) : 0;
+
+	for (i = 0; i < len; i++) {
+		data[i] = body_byte(offset + i);
+	}
+
+	*last = offset + len == BODY_LEN;
+
+	return len;
+}
+
+static int sink(size_t offset, const uint8_t *data, size_t len, bool last,
+		void *user_data)
+{
+	size_t i;
+
+	ARG_UNUSED(last);
+	ARG_UNUSED(user_data);
+
+	for (i = 0; i < len; i++) {
+		if (data[i] != body_byte(offset + i)) {
+			body_ok = false;
+		}
+	}
+
+	received += len;
+
+	return 0;
+}
+
+static void server_input(uint8_t *data, uint16_t len, struct sockaddr *from,
+			 socklen_t from_len)
+{
+	struct coap_packet request, response;
+	int i, ret;
+
+	if (coap_packet_parse(&request, data, len, NULL, 0) < 0) {
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(delayed); i++) {
+		if (delayed[i].len == 0U) {
+			break;
+		}
+	}
+
+	if (i == ARRAY_SIZE(delayed)) {
+		return;
+	}
+
+	if (coap_header_get_code(&request) == COAP_METHOD_GET) {
+		ret = coap_blockwise_server_get(&request, &response,
+						delayed[i].data,
+						sizeof(delayed[i].data),
+						COAP_BLOCK_1024, BODY_LEN,
+						source, NULL);
+	} else {
+		ret = coap_blockwise_server_put(&server, &request, &response,
+						delayed[i].data,
+						sizeof(delayed[i].data),
+						COAP_RESPONSE_CODE_CHANGED);
+	}
+
+	if (ret < 0) {
+		printk("Server failed (%d)\n", ret);
+		return;
+	}
+
+	delayed[i].len = response.offset;
+	delayed[i].due = k_uptime_get() + RTT_MS;
+	memcpy(&delayed[i].addr, from, from_len);
+	delayed[i].addr_len = from_len;
+}
+
+/* Send the responses that are due, return the time until the next one */
+static int server_flush(int sock)
+{
+	int64_t now = k_uptime_get();
+	int timeout = -1;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(delayed); i++) {
+		if (delayed[i].len == 0U) {
+			continue;
+		}
+
+		if (delayed[i].due <= now) {
+			(void)zsock_sendto(sock, delayed[i].data,
+					   delayed[i].len, 0, &delayed[i].addr,
+					   delayed[i].addr_len);
+			delayed[i].len = 0U;
+			continue;
+		}
+
+		if (timeout < 0 || delayed[i].due - now < timeout) {
+			timeout = delayed[i].due - now;
+		}
+	}
+
+	return timeout;
+}
+
+static void server_loop(void *p1, void *p2, void *p3)
+{
+	static uint8_t buf[COAP_BLOCKWISE_BUF_LEN];
+	struct zsock_pollfd fds = {
+		.fd = POINTER_TO_INT(p1),
+		.events = ZSOCK_POLLIN,
+	};
+	struct sockaddr from;
+	socklen_t from_len;
+	int len;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		if (zsock_poll(&fds, 1, server_flush(fds.fd)) <= 0) {
+			continue;
+		}
+
+		from_len = sizeof(from);
+		len = zsock_recvfrom(fds.fd, buf, sizeof(buf), 0, &from,
+				     &from_len);
+		if (len > 0) {
+			server_input(buf, len, &from, from_len);
+		}
+	}
+}
+
+static int start_server(void)
+{
+	int sock;
+
+	sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		return -errno;
+	}
+
+	if (zsock_bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		return -errno;
+	}
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_loop,
+			INT_TO_POINTER(sock), NULL, NULL, SERVER_PRIORITY, 0,
+			K_NO_WAIT);
+
+	return 0;
+}
+
+static int client_send(const uint8_t *data, size_t len, void *user_data)
+{
+	int sock = POINTER_TO_INT(user_data);
+
+	if (zsock_send(sock, data, len, 0) < 0) {
+		return -errno;
+	}
+
+	return 0;
+}
+
+/* Run one transfer, return its duration in milliseconds */
+static int run(bool get, uint8_t window)
+{
+	static struct coap_blockwise_client client;
+	static uint8_t buf[COAP_BLOCKWISE_BUF_LEN];
+	struct zsock_pollfd fds = {
+		.events = ZSOCK_POLLIN,
+	};
+	int64_t start;
+	int len, ret;
+
+	fds.fd = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (fds.fd < 0) {
+		return -errno;
+	}
+
+	if (zsock_connect(fds.fd, (struct sockaddr *)&addr,
+			  sizeof(addr)) < 0) {
+		ret = -errno;
+		goto out;
+	}
+
+	ret = coap_blockwise_client_init(&client, path, COAP_BLOCK_512, window,
+					 client_send, INT_TO_POINTER(fds.fd));
+	if (ret < 0) {
+		goto out;
+	}
+
+	coap_blockwise_server_init(&server, sink, NULL);
+	received = 0;
+	body_ok = true;
+
+	start = k_uptime_get();
+
+	if (get) {
+		ret = coap_blockwise_client_get(&client, sink);
+	} else {
+		ret = coap_blockwise_client_put(&client, COAP_METHOD_PUT,
+						source);
+	}
+
+	while (ret == 0 &&
+	       coap_blockwise_client_result(&client) == -EINPROGRESS) {
+		if (zsock_poll(&fds, 1,
+			       coap_blockwise_client_process(&client)) <= 0) {
+			continue;
+		}
+
+		len = zsock_recv(fds.fd, buf, sizeof(buf), 0);
+		if (len > 0) {
+			(void)coap_blockwise_client_input(&client, buf, len);
+		}
+	}
+
+	if (ret == 0) {
+		ret = coap_blockwise_client_result(&client);
+	}
+
+	if (ret == 0 && (received != BODY_LEN || !body_ok)) {
+		ret = -EIO;
+	}
+
+	if (ret == 0) {
+		ret = (int)(k_uptime_get() - start);
+	}
+
+out:
+	(void)zsock_close(fds.fd);
+
+	return ret;
+}
+
+void main(void)
+{
+	static const uint8_t windows[] = { 1, CONFIG_COAP_BLOCKWISE_WINDOW };
+	int i, j, ret;
+
+	ret = start_server();
+	if (ret < 0) {
+		printk("Cannot start server (%d)\n", ret);
+		return;
+	}
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < ARRAY_SIZE(windows); j++) {
+			ret = run(i == 0, windows[j]);
+			if (ret < 0) {
+				printk("Transfer failed (%d)\n", ret);
+				return;
+			}
+
+			printk("%s window %u: %d ms\n", i == 0 ? "get" : "put",
+			       windows[j], ret);
+		}
+	}
+
+	printk("fin\n");
+}
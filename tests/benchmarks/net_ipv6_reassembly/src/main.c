@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * IPv6 fragment reassembly benchmark. Measures the time taken to reassemble
+ * a packet received in several fragments, in order and in reverse order.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#include "ipv6.h"
+
+#define ITERATIONS 200
+#define FRAGMENTS 8
+#define FRAG_LEN 376 /* Multiple of 8 */
+#define LAST_FRAG_LEN (3000 - NET_IPV6H_LEN - (FRAGMENTS - 1) * FRAG_LEN)
+
+static const struct in6_addr src_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0,
+					      0, 0, 0, 0, 0, 0, 0, 0, 0,
+					      0x02 } } };
+static const struct in6_addr dst_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0,
+					      0, 0, 0, 0, 0, 0, 0, 0, 0,
+					      0x01 } } };
+
+static int bench_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int bench_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_ipv6_reass_bench, "net_ipv6_reass_bench", bench_dev_init,
+		NULL, NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static struct net_pkt *create_fragment(struct net_if *iface, uint32_t id,
+				       int idx)
+{
+	uint16_t offset = idx * FRAG_LEN;
+	bool last = idx == FRAGMENTS - 1;
+	uint16_t len = last ? LAST_FRAG_LEN : FRAG_LEN;
+	struct net_ipv6_frag_hdr frag_hdr = {
+		.nexthdr = IPPROTO_UDP,
+		.offset = htons(offset | (last ? 0 : 1)),
+		.id = htonl(id),
+	};
+	struct net_ipv6_hdr ipv6 = {
+		.vtc = 0x60,
+		.len = htons(sizeof(frag_hdr) + len),
+		.nexthdr = NET_IPV6_NEXTHDR_FRAG,
+		.hop_limit = 64U,
+	};
+	struct net_pkt *pkt;
+
+	net_ipaddr_copy(&ipv6.src, &src_addr);
+	net_ipaddr_copy(&ipv6.dst, &dst_addr);
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(ipv6) +
+					   sizeof(frag_hdr) + len,
+					   AF_UNSPEC, 0, K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_pkt_write(pkt, &ipv6, sizeof(ipv6)) < 0 ||
+	    net_pkt_write(pkt, &frag_hdr, sizeof(frag_hdr)) < 0 ||
+	    net_pkt_memset(pkt, 0x5a, len) < 0) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(ipv6));
+	net_pkt_set_ipv6_fragment_start(pkt, sizeof(ipv6));
+	net_pkt_set_ipv6_hdr_prev(pkt, offsetof(struct net_ipv6_hdr, nexthdr));
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static int run(struct net_if *iface, const char *name, bool reverse)
+{
+	struct net_pkt *frags[FRAGMENTS] = { NULL };
+	struct net_ipv6_hdr ipv6 = { 0 };
+	uint32_t start, cycles = 0U;
+	enum net_verdict verdict;
+	int i, j, idx;
+
+	net_ipaddr_copy(&ipv6.src, &src_addr);
+	net_ipaddr_copy(&ipv6.dst, &dst_addr);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		for (j = 0; j < FRAGMENTS; j++) {
+			frags[j] = create_fragment(iface, i, j);
+			if (!frags[j]) {
+				printk("Cannot create fragment\n");
+				goto fail;
+			}
+		}
+
+		start = k_cycle_get_32();
+
+		for (j = 0; j < FRAGMENTS; j++) {
+			idx = reverse ? FRAGMENTS - 1 - j : j;
+
+			verdict = net_ipv6_handle_fragment_hdr(
+				frags[idx], &ipv6, NET_IPV6_NEXTHDR_FRAG);
+			if (verdict != NET_OK) {
+				printk("%s: fragment %d dropped\n", name, idx);
+				goto fail;
+			}
+
+			frags[idx] = NULL;
+		}
+
+		cycles += k_cycle_get_32() - start;
+
+		/* Let the RX thread release the reassembled packet */
+		k_sleep(K_MSEC(1));
+	}
+
+	printk("%s: %u ns per packet, %u ns per fragment\n", name,
+	       (uint32_t)(k_cyc_to_ns_floor64(cycles) / ITERATIONS),
+	       (uint32_t)(k_cyc_to_ns_floor64(cycles) /
+			  (ITERATIONS * FRAGMENTS)));
+
+	return 0;
+
+fail:
+	for (j = 0; j < FRAGMENTS; j++) {
+		if (frags[j]) {
+			net_pkt_unref(frags[j]);
+		}
+	}
+
+	return -EINVAL;
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+
+	if (run(iface, "in order", false) < 0 ||
+	    run(iface, "reverse", true) < 0) {
+		return;
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * LwM2M content format benchmark. Reads a Device object instance and a
+ * Temperature object instance, as done for a READ or a notification, with
+ * the OMA JSON, SenML JSON and SenML CBOR writers, and prints the payload
+ * size and the time needed to format it.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_json.h"
+#include "lwm2m_rw_senml_json.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+#define ITERATIONS 1000
+#define BUF_LEN 1024
+
+struct format {
+	const char *name;
+	uint16_t content_format;
+	const struct lwm2m_writer *writer;
+	int (*read_op)(struct lwm2m_message *msg, int content_format);
+};
+
+static const struct format formats[] = {
+	{ "json", LWM2M_FORMAT_OMA_JSON, &json_writer, do_read_op_json },
+	{ "senml-json", LWM2M_FORMAT_APP_SENML_JSON, &senml_json_writer,
+	  do_read_op_senml_json },
+	{ "senml-cbor", LWM2M_FORMAT_APP_SENML_CBOR, &senml_cbor_writer,
+	  do_read_op_senml_cbor },
+};
+
+static const struct {
+	const char *name;
+	struct lwm2m_obj_path path;
+} paths[] = {
+	{ "/3/0", { .obj_id = 3, .obj_inst_id = 0, .level = 2 } },
+	{ "/3303/0", { .obj_id = 3303, .obj_inst_id = 0, .level = 2 } },
+};
+
+static struct lwm2m_message msg;
+static uint8_t buf[BUF_LEN];
+
+static uint8_t bat_level = 95;
+static uint8_t bat_status = LWM2M_DEVICE_BATTERY_STATUS_NORMAL;
+static int32_t mem_free = 15;
+static int32_t mem_total = 25;
+static int32_t power_mv[] = { 3800, 5000 };
+static int32_t power_ma[] = { 125, 900 };
+
+static int setup(void)
+{
+	float32_value_t temp = { 23, 500000 };
+	char path[sizeof("3/0/7/0")];
+	int i;
+
+	lwm2m_engine_set_res_data("3/0/0", "Zephyr", sizeof("Zephyr"),
+				  LWM2M_RES_DATA_FLAG_RO);
+	lwm2m_engine_set_res_data("3/0/1", "OMA-LWM2M Sample Client",
+				  sizeof("OMA-LWM2M Sample Client"),
+				  LWM2M_RES_DATA_FLAG_RO);
+	lwm2m_engine_set_res_data("3/0/2", "345000123",
+				  sizeof("345000123"),
+				  LWM2M_RES_DATA_FLAG_RO);
+	lwm2m_engine_set_res_data("3/0/3", "1.0", sizeof("1.0"),
+				  LWM2M_RES_DATA_FLAG_RO);
+	lwm2m_engine_set_res_data("3/0/9", &bat_level, sizeof(bat_level), 0);
+	lwm2m_engine_set_res_data("3/0/10", &mem_free, sizeof(mem_free), 0);
+	lwm2m_engine_set_res_data("3/0/20", &bat_status, sizeof(bat_status),
+				  0);
+	lwm2m_engine_set_res_data("3/0/21", &mem_total, sizeof(mem_total), 0);
+
+	for (i = 0; i < ARRAY_SIZE(power_mv); i++) {
+		snprintk(path, sizeof(path), "3/0/7/%d", i);
+		lwm2m_engine_create_res_inst(path);
+		lwm2m_engine_set_res_data(path, &power_mv[i],
+					  sizeof(power_mv[i]), 0);
+
+		snprintk(path, sizeof(path), "3/0/8/%d", i);
+		lwm2m_engine_create_res_inst(path);
+		lwm2m_engine_set_res_data(path, &power_ma[i],
+					  sizeof(power_ma[i]), 0);
+	}
+
+	if (lwm2m_engine_create_obj_inst("3303/0") < 0) {
+		return -ENOENT;
+	}
+
+	lwm2m_engine_set_float32("3303/0/5700", &temp);
+
+	return 0;
+}
+
+/* Format one read, return the payload length */
+static int read_once(const struct format *fmt,
+		     const struct lwm2m_obj_path *path, uint32_t *cycles)
+{
+	uint16_t len;
+	uint32_t start;
+	int ret;
+
+	ret = coap_packet_init(&msg.cpkt, buf, sizeof(buf), COAP_VERSION_1,
+			       COAP_TYPE_ACK, 0, NULL,
+			       COAP_RESPONSE_CODE_CONTENT, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	msg.out.out_cpkt = &msg.cpkt;
+	msg.out.writer = fmt->writer;
+	memcpy(&msg.path, path, sizeof(msg.path));
+
+	start = k_cycle_get_32();
+	ret = fmt->read_op(&msg, fmt->content_format);
+	*cycles = k_cycle_get_32() - start;
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!coap_packet_get_payload(&msg.cpkt, &len)) {
+		return -ENODATA;
+	}
+
+	return len;
+}
+
+static int bench(const struct format *fmt, int p)
+{
+	uint64_t total = 0U;
+	uint32_t cycles;
+	int i, len = 0;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		len = read_once(fmt, &paths[p].path, &cycles);
+		if (len < 0) {
+			return len;
+		}
+
+		total += cycles;
+	}
+
+	printk("%s %s: %d bytes, %u ns\n", fmt->name, paths[p].name, len,
+	       (uint32_t)(k_cyc_to_ns_floor64(total) / ITERATIONS));
+
+	return 0;
+}
+
+void main(void)
+{
+	int i, j, ret;
+
+	ret = setup();
+
+	for (i = 0; ret == 0 && i < ARRAY_SIZE(paths); i++) {
+		for (j = 0; ret == 0 && j < ARRAY_SIZE(formats); j++) {
+			ret = bench(&formats[j], i);
+		}
+	}
+
+	if (ret < 0) {
+		printk("Benchmark failed (%d)\n", ret);
+		return;
+	}
+
+	printk("fin\n");
+}
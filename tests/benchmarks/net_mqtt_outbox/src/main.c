@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * MQTT outbound queue benchmark. Publishes QoS 1 messages to a minimal
+ * broker stand-in over the loopback interface, first waiting for each
+ * PUBACK before the next publish, then through the outbound queue with
+ * several messages in flight. The broker delays its acknowledgments to
+ * emulate the network round trip.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+#define MESSAGES 200
+#define RTT_MS 5
+#define TIMEOUT_MS 1000
+#define BROKER_PORT 1883
+
+#define BROKER_STACK_SIZE 2048
+#define BROKER_PRIORITY K_PRIO_PREEMPT(8)
+
+#define TOPIC "benchmark/data"
+
+static struct sockaddr_in addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(BROKER_PORT),
+	.sin_addr = { { { 192, 0, 2, 1 } } },
+};
+
+K_THREAD_STACK_DEFINE(broker_stack, BROKER_STACK_SIZE);
+static struct k_thread broker_thread;
+static uint8_t broker_buf[1024];
+
+static struct mqtt_client client;
+static uint8_t rx_buf[256];
+static uint8_t tx_buf[256];
+static uint8_t outbox_buf[1024];
+static uint8_t payload[32];
+
+static bool connected;
+static int acked;
+
+/* Length of the first packet in buf, 0 if it is not complete yet */
+static size_t packet_len(const uint8_t *buf, size_t len, size_t *hdr_len)
+{
+	uint32_t remaining = 0U;
+	size_t i;
+
+	for (i = 1; i < len && i <= 4; i++) {
+		remaining |= (buf[i] & 0x7f) << (7 * (i - 1));
+
+		if (!(buf[i] & 0x80)) {
+			*hdr_len = i + 1;
+			return len >= *hdr_len + remaining ?
+				*hdr_len + remaining : 0;
+		}
+	}
+
+	return 0;
+}
+
+/* Accept one client and answer CONNECT and QoS 1 PUBLISH packets. The
+ * answers to the packets read together are sent together, after RTT_MS.
+ */
+static void broker(void *p1, void *p2, void *p3)
+{
+	int listener = POINTER_TO_INT(p1);
+	uint8_t acks[128];
+	size_t len = 0, acks_len, pkt_len, hdr_len;
+	uint16_t topic_len;
+	int sock, ret;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	sock = zsock_accept(listener, NULL, NULL);
+	if (sock < 0) {
+		printk("accept failed (%d)\n", errno);
+		return;
+	}
+
+	while (true) {
+		ret = zsock_recv(sock, &broker_buf[len], sizeof(broker_buf) - len,
+				 0);
+		if (ret <= 0) {
+			break;
+		}
+
+		len += ret;
+		acks_len = 0;
+
+		while (acks_len + 4 <= sizeof(acks) &&
+		       (pkt_len = packet_len(broker_buf, len, &hdr_len)) > 0) {
+			switch (broker_buf[0] & 0xf0) {
+			case 0x10: /* CONNECT, accept it */
+				acks[acks_len++] = 0x20;
+				acks[acks_len++] = 0x02;
+				acks[acks_len++] = 0x00;
+				acks[acks_len++] = 0x00;
+				break;
+			case 0x30: /* PUBLISH, acknowledge QoS 1 */
+				if ((broker_buf[0] & 0x06) != 0x02) {
+					break;
+				}
+
+				topic_len = sys_get_be16(&broker_buf[hdr_len]);
+				acks[acks_len++] = 0x40;
+				acks[acks_len++] = 0x02;
+				memcpy(&acks[acks_len],
+				       &broker_buf[hdr_len + 2 + topic_len], 2);
+				acks_len += 2;
+				break;
+			case 0xe0: /* DISCONNECT */
+				goto out;
+			}
+
+			len -= pkt_len;
+			memmove(broker_buf, &broker_buf[pkt_len], len);
+		}
+
+		if (acks_len > 0) {
+			k_msleep(RTT_MS);
+
+			if (zsock_send(sock, acks, acks_len, 0) < 0) {
+				break;
+			}
+		}
+	}
+
+out:
+	(void)zsock_close(sock);
+}
+
+static int start_broker(void)
+{
+	int sock;
+
+	sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		return -errno;
+	}
+
+	if (zsock_bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    zsock_listen(sock, 1) < 0) {
+		return -errno;
+	}
+
+	k_thread_create(&broker_thread, broker_stack,
+			K_THREAD_STACK_SIZEOF(broker_stack), broker,
+			INT_TO_POINTER(sock), NULL, NULL, BROKER_PRIORITY, 0,
+			K_NO_WAIT);
+
+	return 0;
+}
+
+static void mqtt_evt_handler(struct mqtt_client *const c,
+			     const struct mqtt_evt *evt)
+{
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+	case MQTT_EVT_PUBACK:
+		acked++;
+		break;
+	default:
+		break;
+	}
+}
+
+/* Wait for data from the broker and process it */
+static int wait_input(void)
+{
+	struct zsock_pollfd fds = {
+		.fd = client.transport.tcp.sock,
+		.events = ZSOCK_POLLIN,
+	};
+
+	if (zsock_poll(&fds, 1, TIMEOUT_MS) <= 0) {
+		return -ETIMEDOUT;
+	}
+
+	return mqtt_input(&client);
+}
+
+static int client_connect(void)
+{
+	int ret;
+
+	mqtt_client_init(&client);
+
+	client.broker = &addr;
+	client.evt_cb = mqtt_evt_handler;
+	client.client_id.utf8 = (uint8_t *)"benchmark";
+	client.client_id.size = strlen("benchmark");
+	client.rx_buf = rx_buf;
+	client.rx_buf_size = sizeof(rx_buf);
+	client.tx_buf = tx_buf;
+	client.tx_buf_size = sizeof(tx_buf);
+	client.outbox_buf = outbox_buf;
+	client.outbox_buf_size = sizeof(outbox_buf);
+	client.transport.type = MQTT_TRANSPORT_NON_SECURE;
+
+	ret = mqtt_connect(&client);
+
+	while (ret == 0 && !connected) {
+		ret = wait_input();
+	}
+
+	return ret;
+}
+
+static void set_param(struct mqtt_publish_param *param, uint16_t message_id)
+{
+	memset(param, 0, sizeof(*param));
+
+	param->message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
+	param->message.topic.topic.utf8 = (uint8_t *)TOPIC;
+	param->message.topic.topic.size = strlen(TOPIC);
+	param->message.payload.data = payload;
+	param->message.payload.len = sizeof(payload);
+	param->message_id = message_id;
+}
+
+/* Publish and wait for the PUBACK of each message */
+static int run_sync(void)
+{
+	struct mqtt_publish_param param;
+	int i, ret;
+
+	for (i = 0; i < MESSAGES; i++) {
+		set_param(&param, i + 1);
+
+		ret = mqtt_publish(&client, &param);
+		if (ret < 0) {
+			return ret;
+		}
+
+		while (acked <= i) {
+			ret = wait_input();
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Queue the messages, processing acknowledgments when the queue is full */
+static int run_outbox(void)
+{
+	struct mqtt_publish_param param;
+	int queued = 0, ret;
+
+	set_param(&param, 0);
+
+	while (queued < MESSAGES) {
+		ret = mqtt_outbox_publish(&client, &param);
+		if (ret == -ENOBUFS) {
+			ret = wait_input();
+		} else if (ret >= 0) {
+			queued++;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	while ((ret = mqtt_outbox_pending(&client)) > 0) {
+		ret = wait_input();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return ret;
+}
+
+static int bench(const char *name, int (*run)(void))
+{
+	int64_t start, elapsed;
+	int ret;
+
+	acked = 0;
+	start = k_uptime_get();
+
+	ret = run();
+	if (ret < 0) {
+		printk("%s run failed (%d)\n", name, ret);
+		return ret;
+	}
+
+	elapsed = MAX(k_uptime_get() - start, 1);
+
+	printk("%s: %u messages per second\n", name,
+	       (uint32_t)(MESSAGES * 1000 / elapsed));
+
+	return 0;
+}
+
+void main(void)
+{
+	int ret;
+
+	memset(payload, 'x', sizeof(payload));
+
+	ret = start_broker();
+	if (ret < 0) {
+		printk("Cannot start broker (%d)\n", ret);
+		return;
+	}
+
+	ret = client_connect();
+	if (ret < 0) {
+		printk("Cannot connect (%d)\n", ret);
+		return;
+	}
+
+	if (bench("synchronous", run_sync) < 0 ||
+	    bench("outbox", run_outbox) < 0) {
+		return;
+	}
+
+	(void)mqtt_disconnect(&client);
+
+	printk("fin\n");
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * PPP HDLC framing benchmark. Measures the FCS calculation, the scan for
+ * flag and escape bytes in received data and the escaping of sent data,
+ * and compares them against byte at a time implementations.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/crc.h>
+#include <random/rand32.h>
+
+#include "ppp_hdlc.h"
+
+#define ITERATIONS 200
+#define FRAME_LEN 1500
+
+static uint8_t frame[FRAME_LEN];
+static uint8_t escaped[2 * FRAME_LEN];
+
+/* Count the flag and escape bytes one byte at a time */
+static size_t ref_scan_rx(const uint8_t *data, size_t len)
+{
+	size_t i, count = 0;
+
+	for (i = 0; i < len; i++) {
+		if (data[i] == PPP_HDLC_FLAG || data[i] == PPP_HDLC_ESCAPE) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static size_t scan_rx(const uint8_t *data, size_t len)
+{
+	size_t i = 0, count = 0;
+
+	while (true) {
+		i += ppp_hdlc_scan_rx(&data[i], len - i);
+		if (i == len) {
+			break;
+		}
+
+		count++;
+		i++;
+	}
+
+	return count;
+}
+
+/* Escape the data one byte at a time */
+static size_t ref_escape(uint8_t *dst, const uint8_t *src, size_t len)
+{
+	size_t i, out = 0;
+
+	for (i = 0; i < len; i++) {
+		if (ppp_hdlc_needs_escape(src[i])) {
+			dst[out++] = PPP_HDLC_ESCAPE;
+			dst[out++] = src[i] ^ PPP_HDLC_ESCAPE_XOR;
+		} else {
+			dst[out++] = src[i];
+		}
+	}
+
+	return out;
+}
+
+static uint32_t ns_per_iteration(uint32_t cycles)
+{
+	return (uint32_t)(k_cyc_to_ns_floor64(cycles) / ITERATIONS);
+}
+
+void main(void)
+{
+	uint32_t start, ref_ns, ns;
+	volatile size_t result;
+	size_t consumed;
+	int i;
+
+	sys_rand_get(frame, sizeof(frame));
+
+	if (crc16_ccitt(PPP_HDLC_FCS_INIT, frame, sizeof(frame)) !=
+	    ppp_hdlc_fcs(PPP_HDLC_FCS_INIT, frame, sizeof(frame)) ||
+	    ref_scan_rx(frame, sizeof(frame)) !=
+	    scan_rx(frame, sizeof(frame))) {
+		printk("Results differ\n");
+		return;
+	}
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = crc16_ccitt(PPP_HDLC_FCS_INIT, frame, sizeof(frame));
+	}
+	ref_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = ppp_hdlc_fcs(PPP_HDLC_FCS_INIT, frame, sizeof(frame));
+	}
+	ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	printk("fcs: byte %u ns, slice-by-4 %u ns\n", ref_ns, ns);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = ref_scan_rx(frame, sizeof(frame));
+	}
+	ref_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = scan_rx(frame, sizeof(frame));
+	}
+	ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	printk("rx scan: byte %u ns, word %u ns\n", ref_ns, ns);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = ref_escape(escaped, frame, sizeof(frame));
+	}
+	ref_ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < ITERATIONS; i++) {
+		result = ppp_hdlc_escape(escaped, sizeof(escaped), frame,
+					 sizeof(frame), &consumed);
+	}
+	ns = ns_per_iteration(k_cycle_get_32() - start);
+
+	printk("tx escape: byte %u ns, word %u ns\n", ref_ns, ns);
+
+	printk("fin\n");
+}
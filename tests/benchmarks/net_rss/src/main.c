@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Receive side scaling benchmark. Generates UDP traffic with several flows
+ * and measures how long it takes to process it with and without spreading
+ * the flows to the RSS worker threads.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <random/rand32.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define NUM_FLOWS 16
+#define PKTS_PER_FLOW 128
+#define TOTAL_PKTS (NUM_FLOWS * PKTS_PER_FLOW)
+
+/* Simulated application work per received packet */
+#define WORK_PER_PKT_US 10
+
+#define SRC_PORT_BASE 10000
+#define DST_PORT 4242
+
+struct flow_data {
+	uint32_t flow;
+	uint32_t seq;
+};
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+
+static struct net_if *iface;
+static struct net_conn_handle *handle;
+
+/* Each flow is handled by one worker only so the expected sequence numbers
+ * do not need any locking.
+ */
+static uint32_t expected_seq[NUM_FLOWS];
+static atomic_t received;
+static atomic_t reordered;
+static K_SEM_DEFINE(all_received, 0, 1);
+
+static uint8_t *rss_get_mac(const struct device *dev)
+{
+	static uint8_t mac_addr[6];
+
+	if (mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		mac_addr[0] = 0x00;
+		mac_addr[1] = 0x00;
+		mac_addr[2] = 0x5E;
+		mac_addr[3] = 0x00;
+		mac_addr[4] = 0x53;
+		mac_addr[5] = sys_rand32_get();
+	}
+
+	return mac_addr;
+}
+
+static void rss_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = rss_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, 6, NET_LINK_ETHERNET);
+}
+
+static int rss_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int rss_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static struct dummy_api rss_if_api = {
+	.iface_api.init = rss_iface_init,
+	.send = rss_send,
+};
+
+NET_DEVICE_INIT(net_rss_test, "net_rss_test",
+		rss_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&rss_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static enum net_verdict udp_received(struct net_conn *conn,
+				     struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr,
+				     void *user_data)
+{
+	struct flow_data data;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			 net_pkt_ip_opts_len(pkt) +
+			 sizeof(struct net_udp_hdr)) ||
+	    net_pkt_read(pkt, &data, sizeof(data))) {
+		printk("Cannot read pkt %p\n", pkt);
+		return NET_DROP;
+	}
+
+	if (data.flow >= NUM_FLOWS) {
+		return NET_DROP;
+	}
+
+	if (data.seq != expected_seq[data.flow]) {
+		atomic_inc(&reordered);
+	}
+
+	expected_seq[data.flow] = data.seq + 1;
+
+	k_busy_wait(WORK_PER_PKT_US);
+
+	net_pkt_unref(pkt);
+
+	if (atomic_inc(&received) == TOTAL_PKTS - 1) {
+		k_sem_give(&all_received);
+	}
+
+	return NET_OK;
+}
+
+static int send_pkt(uint32_t flow, uint32_t seq)
+{
+	struct in_addr src = { { { 198, 51, 100, 1 + (flow % 8) } } };
+	struct flow_data data = {
+		.flow = flow,
+		.seq = seq,
+	};
+	struct net_pkt *pkt;
+
+	/* Blocks until the workers have released some packets */
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(data), AF_INET,
+					   IPPROTO_UDP, K_FOREVER);
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	if (net_ipv4_create(pkt, &src, &my_addr) ||
+	    net_udp_create(pkt, htons(SRC_PORT_BASE + flow),
+			   htons(DST_PORT)) ||
+	    net_pkt_write(pkt, &data, sizeof(data))) {
+		net_pkt_unref(pkt);
+		return -ENOBUFS;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	if (net_recv_data(iface, pkt) < 0) {
+		net_pkt_unref(pkt);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void run(bool rss)
+{
+	uint32_t start, elapsed_us;
+	uint32_t seq, flow;
+	int ret;
+
+	if (rss) {
+		net_if_rx_rss_enable(iface);
+	} else {
+		net_if_rx_rss_disable(iface);
+	}
+
+	(void)memset(expected_seq, 0, sizeof(expected_seq));
+	atomic_set(&received, 0);
+	atomic_set(&reordered, 0);
+	k_sem_reset(&all_received);
+
+	start = k_cycle_get_32();
+
+	for (seq = 0U; seq < PKTS_PER_FLOW; seq++) {
+		for (flow = 0U; flow < NUM_FLOWS; flow++) {
+			ret = send_pkt(flow, seq);
+			if (ret < 0) {
+				printk("Cannot send pkt (%d)\n", ret);
+				return;
+			}
+		}
+	}
+
+	if (k_sem_take(&all_received, K_SECONDS(30))) {
+		printk("Timeout, received %d of %d pkts\n",
+		       (int)atomic_get(&received), TOTAL_PKTS);
+		return;
+	}
+
+	elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	printk("RSS %s: %d pkts in %u us, %u pkts/s, %d reordered\n",
+	       rss ? "on" : "off", TOTAL_PKTS, elapsed_us,
+	       (uint32_t)(((uint64_t)TOTAL_PKTS * USEC_PER_SEC) /
+			  MAX(elapsed_us, 1U)),
+	       (int)atomic_get(&reordered));
+}
+
+void main(void)
+{
+	struct sockaddr_in local_addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(DST_PORT),
+	};
+	int ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	if (!iface) {
+		printk("Cannot find dummy interface\n");
+		return;
+	}
+
+	if (!net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0)) {
+		printk("Cannot add IPv4 address\n");
+		return;
+	}
+
+	net_ipaddr_copy(&local_addr.sin_addr, &my_addr);
+
+	ret = net_udp_register(AF_INET, NULL,
+			       (struct sockaddr *)&local_addr,
+			       0, DST_PORT, NULL, udp_received, NULL,
+			       &handle);
+	if (ret < 0) {
+		printk("Cannot register UDP handler (%d)\n", ret);
+		return;
+	}
+
+	printk("Flows %d, pkts per flow %d, RSS queues %d, CPUs %d\n",
+	       NUM_FLOWS, PKTS_PER_FLOW, CONFIG_NET_RX_RSS_QUEUE_COUNT,
+	       CONFIG_MP_NUM_CPUS);
+
+	run(false);
+	run(true);
+
+	net_udp_unregister(handle);
+
+	printk("fin\n");
+}
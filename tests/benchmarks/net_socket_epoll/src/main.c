@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * epoll benchmark. Sends a UDP datagram to one of many sockets over the
+ * loopback interface and measures how long zsock_poll() and
+ * zsock_epoll_wait() take to find the ready socket.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+
+#include <net/socket.h>
+
+#define MAX_SOCKETS 500
+#define ROUNDS 100
+#define DATAGRAM_LEN 16
+
+#define BASE_PORT 4242
+
+static const int socket_counts[] = { 10, 100, MAX_SOCKETS };
+
+static int socks[MAX_SOCKETS];
+static struct zsock_pollfd pollfds[MAX_SOCKETS];
+static struct zsock_epoll_event events[8];
+static uint8_t buf[DATAGRAM_LEN];
+
+static struct sockaddr_in addr = {
+	.sin_family = AF_INET,
+};
+
+/* Send a datagram to socket idx and let the stack deliver it */
+static int send_to(int client, int idx)
+{
+	addr.sin_port = htons(BASE_PORT + idx);
+
+	if (zsock_sendto(client, buf, sizeof(buf), 0,
+			 (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		return -errno;
+	}
+
+	k_msleep(1);
+
+	return 0;
+}
+
+static int run_poll(int client, int count, uint64_t *cycles)
+{
+	uint32_t start;
+	int round, i, ret;
+
+	for (i = 0; i < count; i++) {
+		pollfds[i].fd = socks[i];
+		pollfds[i].events = ZSOCK_POLLIN;
+	}
+
+	for (round = 0; round < ROUNDS; round++) {
+		ret = send_to(client, (round * 7) % count);
+		if (ret < 0) {
+			return ret;
+		}
+
+		start = k_cycle_get_32();
+		ret = zsock_poll(pollfds, count, -1);
+		*cycles += k_cycle_get_32() - start;
+
+		if (ret != 1) {
+			return ret < 0 ? -errno : -EIO;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (pollfds[i].revents & ZSOCK_POLLIN) {
+				break;
+			}
+		}
+
+		if (i == count ||
+		    zsock_recv(socks[i], buf, sizeof(buf), 0) < 0) {
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+static int run_epoll(int client, int count, uint64_t *cycles)
+{
+	struct zsock_epoll_event ev = {
+		.events = ZSOCK_EPOLLIN,
+	};
+	uint32_t start;
+	int round, i, ret;
+	int epfd;
+
+	epfd = zsock_epoll_create(0);
+	if (epfd < 0) {
+		return -errno;
+	}
+
+	for (i = 0; i < count; i++) {
+		ev.data.fd = socks[i];
+
+		ret = zsock_epoll_ctl(epfd, ZSOCK_EPOLL_CTL_ADD, socks[i], &ev);
+		if (ret < 0) {
+			ret = -errno;
+			goto out;
+		}
+	}
+
+	for (round = 0; round < ROUNDS; round++) {
+		ret = send_to(client, (round * 7) % count);
+		if (ret < 0) {
+			goto out;
+		}
+
+		start = k_cycle_get_32();
+		ret = zsock_epoll_wait(epfd, events, ARRAY_SIZE(events), -1);
+		*cycles += k_cycle_get_32() - start;
+
+		if (ret != 1) {
+			ret = ret < 0 ? -errno : -EIO;
+			goto out;
+		}
+
+		if (zsock_recv(events[0].data.fd, buf, sizeof(buf), 0) < 0) {
+			ret = -EIO;
+			goto out;
+		}
+	}
+
+	ret = 0;
+
+out:
+	zsock_close(epfd);
+
+	return ret;
+}
+
+static uint32_t us_per_round(uint64_t cycles)
+{
+	return (uint32_t)(k_cyc_to_us_floor64(cycles) / ROUNDS);
+}
+
+static int run(int client, int count)
+{
+	uint64_t poll_cycles = 0, epoll_cycles = 0;
+	int ret;
+
+	ret = run_poll(client, count, &poll_cycles);
+	if (ret < 0) {
+		printk("poll failed (%d)\n", ret);
+		return ret;
+	}
+
+	ret = run_epoll(client, count, &epoll_cycles);
+	if (ret < 0) {
+		printk("epoll failed (%d)\n", ret);
+		return ret;
+	}
+
+	printk("%d sockets: poll %u us, epoll %u us per wait\n", count,
+	       us_per_round(poll_cycles), us_per_round(epoll_cycles));
+
+	return 0;
+}
+
+void main(void)
+{
+	int client, i, opened = 0;
+
+	printk("Rounds %d, datagram length %d\n", ROUNDS, DATAGRAM_LEN);
+
+	zsock_inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&addr.sin_addr);
+
+	client = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (client < 0) {
+		printk("Cannot create client socket (%d)\n", errno);
+		return;
+	}
+
+	for (opened = 0; opened < MAX_SOCKETS; opened++) {
+		socks[opened] = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (socks[opened] < 0) {
+			printk("Cannot create socket %d (%d)\n", opened, errno);
+			goto out;
+		}
+
+		addr.sin_port = htons(BASE_PORT + opened);
+
+		if (zsock_bind(socks[opened], (struct sockaddr *)&addr,
+			       sizeof(addr)) < 0) {
+			printk("Cannot bind socket %d (%d)\n", opened, errno);
+			zsock_close(socks[opened]);
+			goto out;
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(socket_counts); i++) {
+		if (run(client, socket_counts[i]) < 0) {
+			goto out;
+		}
+	}
+
+	printk("fin\n");
+
+out:
+	for (i = 0; i < opened; i++) {
+		zsock_close(socks[i]);
+	}
+
+	zsock_close(client);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Batched socket API benchmark. Sends UDP datagrams over the loopback
+ * interface one by one and in batches, and measures the datagram rate.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/socket.h>
+
+#define BATCH 16
+#define ROUNDS 256
+#define TOTAL (BATCH * ROUNDS)
+#define DATAGRAM_LEN 64
+
+#define SERVER_PORT 4242
+
+#define STACK_SIZE 4096
+
+struct bench_data {
+	struct zsock_mmsghdr msgs[BATCH];
+	struct iovec iov[BATCH];
+	uint8_t bufs[BATCH][DATAGRAM_LEN];
+};
+
+#if defined(CONFIG_USERSPACE)
+static K_THREAD_STACK_DEFINE(bench_stack, STACK_SIZE);
+static struct k_thread bench_thread;
+#endif
+
+static int run_single(int client, int server, struct sockaddr_in *addr,
+		      struct bench_data *data)
+{
+	int round, i, ret;
+
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < BATCH; i++) {
+			ret = zsock_sendto(client, data->bufs[i], DATAGRAM_LEN,
+					   0, (struct sockaddr *)addr,
+					   sizeof(*addr));
+			if (ret < 0) {
+				return -errno;
+			}
+		}
+
+		for (i = 0; i < BATCH; i++) {
+			ret = zsock_recvfrom(server, data->bufs[i],
+					     DATAGRAM_LEN, 0, NULL, NULL);
+			if (ret < 0) {
+				return -errno;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void prepare_msgs(struct bench_data *data, struct sockaddr_in *addr)
+{
+	int i;
+
+	for (i = 0; i < BATCH; i++) {
+		data->iov[i].iov_base = data->bufs[i];
+		data->iov[i].iov_len = DATAGRAM_LEN;
+
+		data->msgs[i].msg_hdr.msg_name = addr;
+		data->msgs[i].msg_hdr.msg_namelen = addr ? sizeof(*addr) : 0;
+		data->msgs[i].msg_hdr.msg_iov = &data->iov[i];
+		data->msgs[i].msg_hdr.msg_iovlen = 1;
+		data->msgs[i].msg_hdr.msg_control = NULL;
+		data->msgs[i].msg_hdr.msg_controllen = 0;
+	}
+}
+
+static int run_batch(int client, int server, struct sockaddr_in *addr,
+		     struct bench_data *data)
+{
+	int round, count, ret;
+
+	for (round = 0; round < ROUNDS; round++) {
+		prepare_msgs(data, addr);
+
+		ret = zsock_sendmmsg(client, data->msgs, BATCH, 0);
+		if (ret != BATCH) {
+			return ret < 0 ? -errno : -EIO;
+		}
+
+		prepare_msgs(data, NULL);
+
+		/* recvmmsg() returns what is queued, it may need more calls */
+		for (count = 0; count < BATCH; count += ret) {
+			ret = zsock_recvmmsg(server, &data->msgs[count],
+					     BATCH - count, 0);
+			if (ret < 0) {
+				return -errno;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void report(const char *name, int64_t ticks)
+{
+	uint32_t us = (uint32_t)k_ticks_to_us_floor64(ticks);
+
+	printk("%s: %d datagrams in %u us, %u datagrams/s\n", name, TOTAL, us,
+	       (uint32_t)(((uint64_t)TOTAL * USEC_PER_SEC) / MAX(us, 1U)));
+}
+
+static void bench_run(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	struct bench_data data;
+	int client, server, ret;
+	int64_t start;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	zsock_inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&addr.sin_addr);
+
+	server = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	client = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (server < 0 || client < 0) {
+		printk("Cannot create sockets (%d)\n", errno);
+		return;
+	}
+
+	if (zsock_bind(server, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("Cannot bind (%d)\n", errno);
+		goto out;
+	}
+
+	memset(data.bufs, 0xaa, sizeof(data.bufs));
+
+	start = k_uptime_ticks();
+	ret = run_single(client, server, &addr, &data);
+	if (ret < 0) {
+		printk("Single failed (%d)\n", ret);
+		goto out;
+	}
+	report("single", k_uptime_ticks() - start);
+
+	start = k_uptime_ticks();
+	ret = run_batch(client, server, &addr, &data);
+	if (ret < 0) {
+		printk("Batch failed (%d)\n", ret);
+		goto out;
+	}
+	report("batch", k_uptime_ticks() - start);
+
+	printk("fin\n");
+
+out:
+	zsock_close(client);
+	zsock_close(server);
+}
+
+void main(void)
+{
+	printk("Batch %d, rounds %d, datagram length %d, %s mode\n", BATCH,
+	       ROUNDS, DATAGRAM_LEN,
+	       IS_ENABLED(CONFIG_USERSPACE) ? "user" : "kernel");
+
+#if defined(CONFIG_USERSPACE)
+	k_thread_create(&bench_thread, bench_stack,
+			K_THREAD_STACK_SIZEOF(bench_stack), bench_run,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(8),
+			K_USER | K_INHERIT_PERMS, K_FOREVER);
+
+	/* The system calls copy the message headers to the kernel heap */
+	k_thread_system_pool_assign(&bench_thread);
+
+	k_thread_start(&bench_thread);
+	k_thread_join(&bench_thread, K_FOREVER);
+#else
+	bench_run(NULL, NULL, NULL);
+#endif
+}
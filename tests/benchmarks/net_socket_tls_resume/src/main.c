@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * TLS session resumption benchmark. Connects a TLS client to a TLS server
+ * over the loopback interface and measures how long the connection takes
+ * with a full handshake and with a resumed session.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+#define ROUNDS 10
+#define SERVER_PORT 4243
+#define PSK_TAG 1
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+};
+static const char psk_id[] = "benchmark_identity";
+
+static const sec_tag_t sec_tags[] = { PSK_TAG };
+
+static struct sockaddr_in addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(SERVER_PORT),
+	.sin_addr = { { { 192, 0, 2, 1 } } },
+};
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+
+/* Accept the connections and echo one byte on each of them */
+static void server(void *p1, void *p2, void *p3)
+{
+	int listener = POINTER_TO_INT(p1);
+	int sock;
+	char byte;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		sock = zsock_accept(listener, NULL, NULL);
+		if (sock < 0) {
+			printk("accept failed (%d)\n", errno);
+			return;
+		}
+
+		if (zsock_recv(sock, &byte, 1, 0) == 1) {
+			(void)zsock_send(sock, &byte, 1, 0);
+		}
+
+		(void)zsock_close(sock);
+	}
+}
+
+static int setup_socket(int sock, int cache)
+{
+	if (zsock_setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+			     sizeof(sec_tags)) < 0) {
+		return -errno;
+	}
+
+	if (zsock_setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+			     sizeof(cache)) < 0) {
+		return -errno;
+	}
+
+	return 0;
+}
+
+static int start_server(void)
+{
+	int sock, ret;
+
+	sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	if (sock < 0) {
+		return -errno;
+	}
+
+	ret = setup_socket(sock, TLS_SESSION_CACHE_ENABLED);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (zsock_bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    zsock_listen(sock, 1) < 0) {
+		return -errno;
+	}
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server,
+			INT_TO_POINTER(sock), NULL, NULL, SERVER_PRIORITY, 0,
+			K_NO_WAIT);
+
+	return 0;
+}
+
+/* Connect rounds times, measuring the time spent in connect */
+static int run(int cache, int rounds, uint64_t *cycles)
+{
+	uint32_t start;
+	int round, sock, ret;
+	char byte = 'x';
+
+	for (round = 0; round < rounds; round++) {
+		sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+		if (sock < 0) {
+			return -errno;
+		}
+
+		ret = setup_socket(sock, cache);
+		if (ret < 0) {
+			(void)zsock_close(sock);
+			return ret;
+		}
+
+		start = k_cycle_get_32();
+		ret = zsock_connect(sock, (struct sockaddr *)&addr,
+				    sizeof(addr));
+		*cycles += k_cycle_get_32() - start;
+
+		if (ret < 0) {
+			ret = -errno;
+			(void)zsock_close(sock);
+			return ret;
+		}
+
+		if (zsock_send(sock, &byte, 1, 0) != 1 ||
+		    zsock_recv(sock, &byte, 1, 0) != 1) {
+			ret = -EIO;
+		}
+
+		(void)zsock_close(sock);
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Let the server close its end of the connection */
+		k_msleep(10);
+	}
+
+	return 0;
+}
+
+static void report(const char *name, uint64_t cycles)
+{
+	printk("%s handshake: %u us per connection\n", name,
+	       (uint32_t)(k_cyc_to_us_floor64(cycles) / ROUNDS));
+}
+
+void main(void)
+{
+	uint64_t full = 0, resumed = 0;
+	int ret;
+
+	ret = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK, psk, sizeof(psk));
+	if (ret == 0) {
+		ret = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, strlen(psk_id));
+	}
+
+	if (ret < 0) {
+		printk("Cannot add credentials (%d)\n", ret);
+		return;
+	}
+
+	ret = start_server();
+	if (ret < 0) {
+		printk("Cannot start server (%d)\n", ret);
+		return;
+	}
+
+	ret = run(TLS_SESSION_CACHE_DISABLED, ROUNDS, &full);
+	if (ret < 0) {
+		printk("Full handshake failed (%d)\n", ret);
+		return;
+	}
+
+	/* The first connection stores the session, it is not resumed */
+	ret = run(TLS_SESSION_CACHE_ENABLED, 1, &resumed);
+	if (ret == 0) {
+		resumed = 0;
+		ret = run(TLS_SESSION_CACHE_ENABLED, ROUNDS, &resumed);
+	}
+
+	if (ret < 0) {
+		printk("Resumed handshake failed (%d)\n", ret);
+		return;
+	}
+
+	report("full", full);
+	report("resumed", resumed);
+
+	printk("fin\n");
+}
@@ -0,0 +1,534 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * IP stack packet processing benchmark. The packets of an emulated peer
+ * are injected through a dummy network interface and received with
+ * sockets, and the packets sent with sockets are taken by the driver of
+ * that interface. Prints the UDP and TCP packet rates, the time spent in
+ * each stage of the receive path and the cost of allocating a net_pkt.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/fdtable.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/dummy.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/socket.h>
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "tcp2_priv.h"
+
+#define PAYLOAD_LEN CONFIG_NET_STACK_BENCHMARK_PAYLOAD_LEN
+#define CONN_COUNT CONFIG_NET_STACK_BENCHMARK_CONNECTIONS
+#define PACKETS CONFIG_NET_STACK_BENCHMARK_PACKETS
+
+#define MY_PORT 4242
+#define PEER_PORT 5000
+#define PEER_ISN 1000
+#define PEER_WIN 65535U
+
+BUILD_ASSERT(NET_TC_RX_COUNT == 0 && NET_TC_TX_COUNT == 0,
+	     "Packets must be processed in the benchmark thread");
+
+/* Order of the time stamps taken by the stack in the receive path */
+enum {
+	TICK_RX,
+	TICK_L2,
+	TICK_CONN,
+	TICK_SOCKET,
+	TICK_COUNT,
+};
+
+/* Cycles spent in each stage, summed over all the packets */
+struct stages {
+	uint64_t total;
+	uint64_t l2;
+	uint64_t ip;
+	uint64_t conn;
+	uint64_t socket;
+};
+
+/* TCP state of the peer for one connection */
+static struct peer {
+	/** Next sequence number sent by the peer */
+	uint32_t seq;
+	/** Next sequence number expected from the stack */
+	uint32_t ack;
+	int sock;
+} peers[CONN_COUNT];
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface;
+static uint8_t payload[PAYLOAD_LEN];
+static uint8_t buf[PAYLOAD_LEN];
+static int udp_socks[CONN_COUNT];
+
+/* Follow the sequence numbers sent by the stack, so that the peer can
+ * acknowledge them.
+ */
+static void track_tcp(struct net_pkt *pkt)
+{
+	struct tcphdr th;
+	struct peer *peer;
+	uint16_t port;
+	uint32_t end;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt)) ||
+	    net_pkt_read(pkt, &th, sizeof(th))) {
+		return;
+	}
+
+	port = ntohs(th.th_dport);
+	if (port < PEER_PORT || port >= PEER_PORT + CONN_COUNT) {
+		return;
+	}
+
+	peer = &peers[port - PEER_PORT];
+
+	end = ntohl(th.th_seq) + net_pkt_get_len(pkt) -
+	      net_pkt_ip_hdr_len(pkt) - th.th_off * 4U;
+	if (th.th_flags & (SYN | FIN)) {
+		end++;
+	}
+
+	if ((int32_t)(end - peer->ack) > 0) {
+		peer->ack = end;
+	}
+}
+
+static int bench_dev_send(const struct device *dev, struct net_pkt *pkt)
+{
+	ARG_UNUSED(dev);
+
+	if (net_pkt_family(pkt) == AF_INET &&
+	    NET_IPV4_HDR(pkt)->proto == IPPROTO_TCP) {
+		track_tcp(pkt);
+	}
+
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int bench_dev_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static const struct dummy_api bench_dev_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_dev_send,
+};
+
+NET_DEVICE_INIT(bench_dev, "bench_dev", bench_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &bench_dev_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV4_MTU);
+
+static uint32_t to_ns(uint64_t cycles)
+{
+	return (uint32_t)(k_cyc_to_ns_floor64(cycles) / PACKETS);
+}
+
+static uint32_t pkts_per_s(uint64_t cycles)
+{
+	uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+	return ns ? (uint32_t)(PACKETS * 1000000000ULL / ns) : 0;
+}
+
+/* Build a packet of the peer, with a payload of PAYLOAD_LEN bytes if
+ * data is set.
+ */
+static struct net_pkt *peer_pkt(enum net_ip_protocol proto, int conn,
+				 uint8_t flags, bool data)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
+	size_t len = data ? PAYLOAD_LEN : 0;
+	struct net_pkt *pkt;
+	struct tcphdr *th;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, len, AF_INET, proto,
+					   K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_ipv4_create(pkt, &peer_addr, &my_addr)) {
+		goto fail;
+	}
+
+	if (proto == IPPROTO_UDP) {
+		if (net_udp_create(pkt, htons(PEER_PORT + conn),
+				   htons(MY_PORT + conn))) {
+			goto fail;
+		}
+	} else {
+		th = (struct tcphdr *)net_pkt_get_data(pkt, &tcp_access);
+		if (!th) {
+			goto fail;
+		}
+
+		memset(th, 0, sizeof(*th));
+		th->th_sport = htons(PEER_PORT + conn);
+		th->th_dport = htons(MY_PORT);
+		th->th_seq = htonl(peers[conn].seq);
+		th->th_ack = (flags & ACK) ? htonl(peers[conn].ack) : 0;
+		th->th_off = sizeof(*th) / 4U;
+		th->th_flags = flags;
+		th->th_win = htons(PEER_WIN);
+
+		if (net_pkt_set_data(pkt, &tcp_access)) {
+			goto fail;
+		}
+	}
+
+	if (len && net_pkt_write(pkt, payload, len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv4_finalize(pkt, proto)) {
+		goto fail;
+	}
+
+	return pkt;
+
+fail:
+	net_pkt_unref(pkt);
+	return NULL;
+}
+
+static int inject(struct net_pkt *pkt)
+{
+	int ret;
+
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	ret = net_recv_data(iface, pkt);
+	if (ret < 0) {
+		net_pkt_unref(pkt);
+	}
+
+	return ret;
+}
+
+static int bench_alloc(void)
+{
+	uint64_t rx = 0, tx = 0;
+	struct net_pkt *pkt;
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < PACKETS; i++) {
+		start = k_cycle_get_32();
+		pkt = net_pkt_rx_alloc_with_buffer(iface, PAYLOAD_LEN, AF_INET,
+						   IPPROTO_UDP, K_NO_WAIT);
+		if (!pkt) {
+			return -ENOMEM;
+		}
+
+		net_pkt_unref(pkt);
+		rx += k_cycle_get_32() - start;
+
+		start = k_cycle_get_32();
+		pkt = net_pkt_alloc_with_buffer(iface, PAYLOAD_LEN, AF_INET,
+						IPPROTO_UDP, K_NO_WAIT);
+		if (!pkt) {
+			return -ENOMEM;
+		}
+
+		net_pkt_unref(pkt);
+		tx += k_cycle_get_32() - start;
+	}
+
+	printk("alloc: rx %u ns, tx %u ns\n", to_ns(rx), to_ns(tx));
+
+	return 0;
+}
+
+/* Inject a packet and receive it, timing each stage of the stack from
+ * the time stamps the stack put in the packet.
+ */
+static int receive_pkt(struct net_pkt *pkt, int sock, struct stages *stages)
+{
+	struct net_context *ctx = z_get_fd_obj(sock, NULL, 0);
+	uint32_t start, queued, tick[TICK_COUNT];
+	int ret;
+
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	start = k_cycle_get_32();
+
+	ret = inject(pkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	queued = k_cycle_get_32();
+
+	pkt = k_fifo_peek_tail(&ctx->recv_q);
+	if (!pkt || net_pkt_stats_tick_count(pkt) < TICK_COUNT) {
+		return -EIO;
+	}
+
+	memcpy(tick, net_pkt_stats_tick(pkt), sizeof(tick));
+
+	stages->total += queued - start;
+	stages->l2 += tick[TICK_L2] - tick[TICK_RX];
+	stages->ip += tick[TICK_CONN] - tick[TICK_L2];
+	stages->conn += tick[TICK_SOCKET] - tick[TICK_CONN];
+
+	start = k_cycle_get_32();
+
+	ret = zsock_recv(sock, buf, sizeof(buf), ZSOCK_MSG_DONTWAIT);
+	if (ret != PAYLOAD_LEN) {
+		return ret < 0 ? -errno : -EIO;
+	}
+
+	start = k_cycle_get_32() - start;
+	stages->socket += start;
+	stages->total += start;
+
+	return 0;
+}
+
+static void print_rx(const char *name, const struct stages *stages)
+{
+	printk("%s rx: %u pkts/s, l2 %u ns, ip %u ns, conn %u ns, "
+	       "socket %u ns\n", name, pkts_per_s(stages->total),
+	       to_ns(stages->l2), to_ns(stages->ip), to_ns(stages->conn),
+	       to_ns(stages->socket));
+}
+
+/* Send a packet, adding the time it took to total */
+static int send_pkt(int sock, const struct sockaddr *addr, uint64_t *total)
+{
+	uint32_t start = k_cycle_get_32();
+	int ret;
+
+	ret = zsock_sendto(sock, payload, PAYLOAD_LEN, 0, addr,
+			   addr ? sizeof(struct sockaddr_in) : 0);
+	if (ret != PAYLOAD_LEN) {
+		return ret < 0 ? -errno : -EIO;
+	}
+
+	*total += k_cycle_get_32() - start;
+
+	return 0;
+}
+
+static int bench_udp(void)
+{
+	struct sockaddr_in addr = { .sin_family = AF_INET };
+	struct stages stages = { 0 };
+	uint64_t tx = 0;
+	int i, ret;
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		udp_socks[i] = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (udp_socks[i] < 0) {
+			return -errno;
+		}
+
+		addr.sin_addr = my_addr;
+		addr.sin_port = htons(MY_PORT + i);
+
+		if (zsock_bind(udp_socks[i], (struct sockaddr *)&addr,
+			       sizeof(addr)) < 0) {
+			return -errno;
+		}
+	}
+
+	for (i = 0; i < PACKETS; i++) {
+		ret = receive_pkt(peer_pkt(IPPROTO_UDP, i % CONN_COUNT, 0, true),
+			      udp_socks[i % CONN_COUNT], &stages);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	print_rx("udp", &stages);
+
+	addr.sin_addr = peer_addr;
+
+	for (i = 0; i < PACKETS; i++) {
+		addr.sin_port = htons(PEER_PORT + i % CONN_COUNT);
+
+		ret = send_pkt(udp_socks[i % CONN_COUNT],
+			   (struct sockaddr *)&addr, &tx);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	printk("udp tx: %u pkts/s\n", pkts_per_s(tx));
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		(void)zsock_close(udp_socks[i]);
+	}
+
+	return 0;
+}
+
+/* Open a connection from the peer with a three way handshake */
+static int tcp_connect(int listen_sock, int conn)
+{
+	struct peer *peer = &peers[conn];
+	int ret;
+
+	peer->seq = PEER_ISN;
+	peer->ack = 0;
+
+	ret = inject(peer_pkt(IPPROTO_TCP, conn, SYN, false));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (peer->ack == 0) {
+		return -ECONNREFUSED;
+	}
+
+	peer->seq++;
+
+	ret = inject(peer_pkt(IPPROTO_TCP, conn, ACK, false));
+	if (ret < 0) {
+		return ret;
+	}
+
+	peer->sock = zsock_accept(listen_sock, NULL, NULL);
+	if (peer->sock < 0) {
+		return -errno;
+	}
+
+	return 0;
+}
+
+static int bench_tcp(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(MY_PORT),
+		.sin_addr = my_addr,
+	};
+	struct stages stages = { 0 };
+	struct peer *peer;
+	uint64_t tx = 0;
+	int listen_sock;
+	int i, ret;
+
+	listen_sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listen_sock < 0) {
+		return -errno;
+	}
+
+	if (zsock_bind(listen_sock, (struct sockaddr *)&addr,
+		       sizeof(addr)) < 0 ||
+	    zsock_listen(listen_sock, CONN_COUNT) < 0) {
+		return -errno;
+	}
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		ret = tcp_connect(listen_sock, i);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	for (i = 0; i < PACKETS; i++) {
+		peer = &peers[i % CONN_COUNT];
+
+		ret = receive_pkt(peer_pkt(IPPROTO_TCP, i % CONN_COUNT,
+				       PSH | ACK, true),
+			      peer->sock, &stages);
+		if (ret < 0) {
+			return ret;
+		}
+
+		peer->seq += PAYLOAD_LEN;
+	}
+
+	print_rx("tcp", &stages);
+
+	for (i = 0; i < PACKETS; i++) {
+		peer = &peers[i % CONN_COUNT];
+
+		ret = send_pkt(peer->sock, NULL, &tx);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Acknowledge the data so that the send window stays open */
+		ret = inject(peer_pkt(IPPROTO_TCP, i % CONN_COUNT, ACK,
+				      false));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	printk("tcp tx: %u pkts/s\n", pkts_per_s(tx));
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		(void)zsock_close(peers[i].sock);
+	}
+
+	(void)zsock_close(listen_sock);
+
+	return 0;
+}
+
+void main(void)
+{
+	int ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+
+	if (!net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0)) {
+		printk("Cannot add address\n");
+		return;
+	}
+
+	memset(payload, 0xa5, sizeof(payload));
+
+	ret = bench_alloc();
+	if (ret == 0) {
+		ret = bench_udp();
+	}
+
+	if (ret == 0) {
+		ret = bench_tcp();
+	}
+
+	if (ret < 0) {
+		printk("Benchmark failed (%d)\n", ret);
+		return;
+	}
+
+	printk("fin\n");
+}
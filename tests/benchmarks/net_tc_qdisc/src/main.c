@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Network TX queueing benchmark. Measures the queueing delay of a sparse
+ * flow behind a bulk transfer, and the rate of the TX shaper.
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#define BULK_PKTS 32
+#define BULK_LEN 512
+#define CONTROL_LEN 64
+
+/* Time it takes to send one packet, in microseconds */
+#define LINK_DELAY_US 200
+
+#define SHAPER_PKTS 50
+#define SHAPER_RATE 51200
+#define SHAPER_BURST BULK_LEN
+
+static K_SEM_DEFINE(sent_sem, 0, K_SEM_MAX_LIMIT);
+static uint32_t control_sent;
+
+/* Number of bulk packets sent before the control packet */
+static int bulk_sent;
+static int bulk_before_control;
+
+static int bench_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int bench_send(const struct device *dev, struct net_pkt *pkt)
+{
+	if (net_pkt_get_len(pkt) == CONTROL_LEN) {
+		control_sent = k_cycle_get_32();
+		bulk_before_control = bulk_sent;
+	} else {
+		bulk_sent++;
+	}
+
+	k_busy_wait(LINK_DELAY_US);
+
+	k_sem_give(&sent_sem);
+
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_tc_qdisc_bench, "net_tc_qdisc_bench", bench_dev_init,
+		NULL, NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static int queue_pkt(struct net_if *iface, uint16_t src_port, size_t len)
+{
+	struct net_ipv4_hdr ipv4 = {
+		.vhl = 0x45,
+		.len = htons(len),
+		.ttl = 64U,
+		.proto = IPPROTO_UDP,
+		.src = { { 192, 0, 2, 1 } },
+		.dst = { { 192, 0, 2, 2 } },
+	};
+	struct net_udp_hdr udp = {
+		.src_port = htons(src_port),
+		.dst_port = htons(4242),
+		.len = htons(len - sizeof(ipv4)),
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, len, AF_INET, IPPROTO_UDP,
+					K_FOREVER);
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	if (net_pkt_write(pkt, &ipv4, sizeof(ipv4)) < 0 ||
+	    net_pkt_write(pkt, &udp, sizeof(udp)) < 0 ||
+	    net_pkt_memset(pkt, 0x5a, len - sizeof(ipv4) - sizeof(udp)) < 0) {
+		net_pkt_unref(pkt);
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_if_queue_tx(iface, pkt);
+
+	return 0;
+}
+
+static int run_control(struct net_if *iface)
+{
+	uint32_t start;
+	int i, ret = 0;
+
+	/* Queue the whole burst before the TX thread gets to run */
+	k_sched_lock();
+
+	for (i = 0; i < BULK_PKTS && !ret; i++) {
+		ret = queue_pkt(iface, 5000, BULK_LEN);
+	}
+
+	start = k_cycle_get_32();
+
+	if (!ret) {
+		ret = queue_pkt(iface, 1883, CONTROL_LEN);
+	}
+
+	k_sched_unlock();
+
+	if (ret < 0) {
+		printk("Cannot queue packets (%d)\n", ret);
+		return ret;
+	}
+
+	for (i = 0; i < BULK_PKTS + 1; i++) {
+		k_sem_take(&sent_sem, K_FOREVER);
+	}
+
+	printk("control packet: %u us, sent after %d of %d bulk packets\n",
+	       (uint32_t)(k_cyc_to_ns_floor64(control_sent - start) / 1000U),
+	       bulk_before_control, BULK_PKTS);
+
+	return 0;
+}
+
+static int run_shaper(struct net_if *iface)
+{
+	uint32_t start, cycles, ms, rate;
+	int i, ret;
+
+	ret = net_if_tx_shaper_set(iface, net_tx_priority2tc(NET_PRIORITY_BE),
+				   SHAPER_RATE, SHAPER_BURST);
+	if (ret == -ENOTSUP) {
+		printk("shaper: not supported\n");
+		return 0;
+	} else if (ret < 0) {
+		printk("Cannot set shaper (%d)\n", ret);
+		return ret;
+	}
+
+	start = k_cycle_get_32();
+
+	/* One packet at a time, so that none of them is dropped */
+	for (i = 0; i < SHAPER_PKTS; i++) {
+		ret = queue_pkt(iface, 5000, BULK_LEN);
+		if (ret < 0) {
+			printk("Cannot queue packet (%d)\n", ret);
+			return ret;
+		}
+
+		k_sem_take(&sent_sem, K_FOREVER);
+	}
+
+	cycles = k_cycle_get_32() - start;
+	ms = (uint32_t)(k_cyc_to_ns_floor64(cycles) / 1000000U);
+
+	rate = ms ? SHAPER_PKTS * BULK_LEN * 1000U / ms : 0U;
+
+	printk("shaper: %u bytes in %u ms, %u bytes/s, %s %u\n",
+	       SHAPER_PKTS * BULK_LEN, ms, rate,
+	       (rate >= SHAPER_RATE - SHAPER_RATE / 10U &&
+		rate <= SHAPER_RATE + SHAPER_RATE / 10U) ?
+	       "within 10% of" : "expected", SHAPER_RATE);
+
+	(void)net_if_tx_shaper_set(iface,
+				   net_tx_priority2tc(NET_PRIORITY_BE), 0, 0);
+
+	return 0;
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+
+	if (run_control(iface) < 0 || run_shaper(iface) < 0) {
+		return;
+	}
+
+	printk("fin\n");
+}
@@ -1168,9 +1168,136 @@ void test_loop(void)
 	net_pkt_print();
 }
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE) && defined(CONFIG_NET_6LO_CONTEXT)
+extern int net_6lo_iphc_cache_count(void);
+
+#define COMPRESSED_MAX (NET_IPV6UDPH_LEN + SIZE_OF_LARGE_DATA)
+
+/* Compress a packet made from data, copy the result to buf */
+static size_t compress_to_buf(struct net_6lo_data *data, uint8_t *buf)
+{
+	struct net_pkt *pkt;
+	size_t len;
+
+	pkt = create_pkt(data);
+	zassert_not_null(pkt, "failed to create buffer");
+
+	net_pkt_cursor_init(pkt);
+
+	zassert_true((net_6lo_compress(pkt, data->iphc) >= 0),
+		     "compression failed");
+
+	len = net_pkt_get_len(pkt);
+	zassert_true(len <= COMPRESSED_MAX, "compressed packet too long");
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_pkt_read(pkt, buf, len), 0, "cannot read packet");
+
+	net_pkt_unref(pkt);
+
+	return len;
+}
+
+void test_iphc_cache(void)
+{
+	struct net_if *iface =
+		net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	static uint8_t uncached[COMPRESSED_MAX];
+	static uint8_t cached[COMPRESSED_MAX];
+	size_t uncached_len, cached_len;
+	int count;
+
+	net_6lo_set_context(iface, &ctx2);
+
+	for (count = 0; count < ARRAY_SIZE(tests); count++) {
+		if (!tests[count].data->iphc) {
+			continue;
+		}
+
+		/* Announcing a context again empties the cache, so the first
+		 * packet goes through the whole encoding like with the cache
+		 * disabled. The second one reuses the cached encoding.
+		 */
+		net_6lo_set_context(iface, &ctx1);
+		zassert_equal(net_6lo_iphc_cache_count(), 0,
+			      "cache not flushed");
+
+		uncached_len = compress_to_buf(tests[count].data, uncached);
+		zassert_equal(net_6lo_iphc_cache_count(), 1,
+			      "%s: flow not cached", tests[count].name);
+
+		cached_len = compress_to_buf(tests[count].data, cached);
+		zassert_equal(net_6lo_iphc_cache_count(), 1,
+			      "%s: cached flow not used", tests[count].name);
+
+		zassert_equal(cached_len, uncached_len,
+			      "%s: wrong length from the cache",
+			      tests[count].name);
+		zassert_mem_equal(cached, uncached, uncached_len,
+				  "%s: wrong encoding from the cache",
+				  tests[count].name);
+	}
+}
+
+void test_iphc_cache_context_change(void)
+{
+	struct net_if *iface =
+		net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	struct net_icmpv6_nd_opt_6co changed = ctx1;
+	static uint8_t expected[COMPRESSED_MAX];
+	static uint8_t buf[COMPRESSED_MAX];
+	size_t expected_len, len;
+
+	/* Both addresses of the flow are compressed with context 1 */
+	net_6lo_set_context(iface, &ctx1);
+	expected_len = compress_to_buf(&test_data_15, expected);
+	zassert_equal(net_6lo_iphc_cache_count(), 1, "flow not cached");
+
+	/* Once the prefix of the context changes, the addresses are inlined */
+	changed.prefix.s6_addr[0] = 0xee;
+	net_6lo_set_context(iface, &changed);
+	zassert_equal(net_6lo_iphc_cache_count(), 0,
+		      "cache not flushed on update");
+
+	len = compress_to_buf(&test_data_15, buf);
+	zassert_true(len > expected_len, "encoding of the old context used");
+
+	/* Removing the context is a change as well */
+	changed.lifetime = 0U;
+	net_6lo_set_context(iface, &changed);
+	zassert_equal(net_6lo_iphc_cache_count(), 0,
+		      "cache not flushed on removal");
+
+	/* And so is adding it back */
+	(void)compress_to_buf(&test_data_15, buf);
+	zassert_equal(net_6lo_iphc_cache_count(), 1, "flow not cached");
+
+	net_6lo_set_context(iface, &ctx1);
+	zassert_equal(net_6lo_iphc_cache_count(), 0,
+		      "cache not flushed on addition");
+
+	len = compress_to_buf(&test_data_15, buf);
+	zassert_equal(len, expected_len, "context not used");
+	zassert_mem_equal(buf, expected, expected_len, "context not used");
+}
+#else
+void test_iphc_cache(void)
+{
+	ztest_test_skip();
+}
+
+void test_iphc_cache_context_change(void)
+{
+	ztest_test_skip();
+}
+#endif
+
 /*test case main entry*/
 void test_main(void)
 {
-	ztest_test_suite(test_6lo, ztest_unit_test(test_loop));
+	ztest_test_suite(test_6lo,
+			 ztest_unit_test(test_loop),
+			 ztest_unit_test(test_iphc_cache),
+			 ztest_unit_test(test_iphc_cache_context_change));
 	ztest_run_test_suite(test_6lo);
 }
@@ -647,9 +647,172 @@ void test_arp(void)
 	}
 }
 
+static struct in_addr my_addr = { { { 192, 168, 0, 1 } } };
+
+static struct net_pkt *prepare_ipv4_pkt(struct net_if *iface,
+					struct in_addr *dst)
+{
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *pkt;
+	int len = strlen(app_data);
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_ipv4_hdr) +
+					len, AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	net_ipaddr_copy(&ipv4->src, &my_addr);
+	net_ipaddr_copy(&ipv4->dst, dst);
+
+	memcpy(net_buf_add(pkt->buffer, len), app_data, len);
+
+	return pkt;
+}
+
+/* Feed in an ARP request from peer, which adds the peer to the cache */
+static void feed_arp_request(struct net_if *iface, struct in_addr *peer,
+			     struct net_eth_addr *peer_hwaddr)
+{
+	struct net_eth_hdr *eth_hdr = NULL;
+	struct net_arp_hdr *arp_hdr;
+	struct net_pkt *pkt, *pkt2;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem request");
+
+	setup_eth_header(iface, pkt, peer_hwaddr, NET_ETH_PTYPE_ARP);
+
+	arp_hdr = (struct net_arp_hdr *)(pkt->buffer->data +
+					 (sizeof(struct net_eth_hdr)));
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	net_ipaddr_copy(&arp_hdr->dst_ipaddr, &my_addr);
+	net_ipaddr_copy(&arp_hdr->src_ipaddr, peer);
+
+	pkt2 = prepare_arp_request(iface, pkt, peer_hwaddr, &eth_hdr);
+	zassert_not_null(pkt2, "ARP request generation failed.");
+
+	req_test = true;
+
+	(void)net_arp_input(pkt2, eth_hdr);
+
+	/* Yielding so that network interface TX thread can proceed. */
+	k_yield();
+
+	net_pkt_unref(pkt);
+}
+
+static bool arp_entry_exists(struct in_addr *addr,
+			     struct net_eth_addr *expected)
+{
+	entry_found = false;
+	expected_hwaddr = expected;
+	net_arp_foreach(arp_cb, addr);
+
+	return entry_found;
+}
+
+void test_arp_lru(void)
+{
+	struct net_eth_addr hw1 = { { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x01 } };
+	struct net_eth_addr hw2 = { { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x02 } };
+	struct net_eth_addr hw3 = { { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x03 } };
+	struct in_addr peer1 = { { { 192, 168, 0, 11 } } };
+	struct in_addr peer2 = { { { 192, 168, 0, 12 } } };
+	struct in_addr peer3 = { { { 192, 168, 0, 13 } } };
+	struct net_if *iface;
+	struct net_pkt *pkt, *pkt2;
+
+	iface = net_if_lookup_by_dev(DEVICE_GET(net_arp_test));
+
+	net_arp_clear_cache(NULL);
+
+	feed_arp_request(iface, &peer1, &hw1);
+	feed_arp_request(iface, &peer2, &hw2);
+
+	zassert_true(arp_entry_exists(&peer1, &hw1), "Peer 1 not found");
+	zassert_true(arp_entry_exists(&peer2, &hw2), "Peer 2 not found");
+
+	/* Use peer 1, so peer 2 becomes the least recently used entry */
+	pkt = prepare_ipv4_pkt(iface, &peer1);
+
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_equal_ptr(pkt2, pkt, "Peer 1 should be in the cache");
+	zassert_mem_equal(net_pkt_lladdr_dst(pkt)->addr, &hw1,
+			  sizeof(struct net_eth_addr), "Invalid link address");
+
+	net_pkt_unref(pkt);
+
+	/* The cache is full, the new peer replaces peer 2 */
+	zassert_equal(CONFIG_NET_ARP_TABLE_SIZE, 2, "Test needs 2 entries");
+
+	feed_arp_request(iface, &peer3, &hw3);
+
+	zassert_true(arp_entry_exists(&peer1, &hw1), "Peer 1 not found");
+	zassert_false(arp_entry_exists(&peer2, &hw2), "Peer 2 not replaced");
+	zassert_true(arp_entry_exists(&peer3, &hw3), "Peer 3 not found");
+
+	net_arp_clear_cache(NULL);
+}
+
+void test_arp_negative_cache(void)
+{
+	struct net_eth_addr hw4 = { { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x04 } };
+	struct in_addr peer4 = { { { 192, 168, 0, 14 } } };
+	struct net_if *iface;
+	struct net_pkt *pkt, *pkt2;
+
+	iface = net_if_lookup_by_dev(DEVICE_GET(net_arp_test));
+
+	net_arp_clear_cache(NULL);
+
+	pkt = prepare_ipv4_pkt(iface, &peer4);
+
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_not_null(pkt2, "ARP request not created");
+	zassert_not_equal(pkt2, pkt, "ARP request not created");
+	net_pkt_unref(pkt2);
+
+	/* Let the request time out */
+	k_sleep(K_MSEC(2 * MSEC_PER_SEC + 100));
+
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_is_null(pkt2, "Negative entry not used");
+
+	/* After the negative entry expires, a new request is sent */
+	k_sleep(K_MSEC(CONFIG_NET_ARP_NEGATIVE_CACHE_TIMEOUT));
+
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_not_null(pkt2, "ARP request not created");
+	zassert_not_equal(pkt2, pkt, "ARP request not created");
+	net_pkt_unref(pkt2);
+
+	/* A host that answers late becomes reachable */
+	net_arp_clear_cache(NULL);
+	k_sleep(K_MSEC(10));
+
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_not_null(pkt2, "ARP request not created");
+	net_pkt_unref(pkt2);
+
+	k_sleep(K_MSEC(2 * MSEC_PER_SEC + 100));
+
+	feed_arp_request(iface, &peer4, &hw4);
+	zassert_true(arp_entry_exists(&peer4, &hw4), "Peer 4 not found");
+
+	net_pkt_unref(pkt);
+
+	net_arp_clear_cache(NULL);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_arp_fn,
-		ztest_unit_test(test_arp));
+		ztest_unit_test(test_arp),
+		ztest_unit_test(test_arp_lru),
+		ztest_unit_test(test_arp_negative_cache));
 	ztest_run_test_suite(test_arp_fn);
 }
@@ -352,6 +352,131 @@ static void test_recv_with_bridge(void)
 	check_free_packet_count();
 }
 
+/*
+ * Simulate the reception of a frame between two given hosts
+ */
+static void recv_frame(struct net_if *iface, const uint8_t *src,
+		       const uint8_t *dst)
+{
+	struct net_pkt *pkt;
+	struct net_eth_hdr eth_hdr;
+	static uint8_t data[] = { 'f', 'd', 'b', '\0' };
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(eth_hdr) + sizeof(data),
+					   AF_UNSPEC, 0, K_FOREVER);
+	zassert_not_null(pkt, "");
+
+	memcpy(eth_hdr.dst.addr, dst, sizeof(eth_hdr.dst.addr));
+	memcpy(eth_hdr.src.addr, src, sizeof(eth_hdr.src.addr));
+	eth_hdr.type = htons(NET_ETH_PTYPE_ALL);
+
+	ret = net_pkt_write(pkt, &eth_hdr, sizeof(eth_hdr));
+	zassert_equal(ret, 0, "");
+
+	ret = net_pkt_write(pkt, data, sizeof(data));
+	zassert_equal(ret, 0, "");
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "");
+
+	/* give time to the processing threads to run */
+	k_sleep(K_MSEC(100));
+}
+
+/*
+ * Return a bit mask of the interfaces that sent a packet and release
+ * the packets.
+ */
+static int sent_mask(void)
+{
+	int i, mask = 0;
+
+	for (i = 0; i < ARRAY_SIZE(eth_fake_data); i++) {
+		if (eth_fake_data[i].sent_pkt != NULL) {
+			net_pkt_unref(eth_fake_data[i].sent_pkt);
+			eth_fake_data[i].sent_pkt = NULL;
+			mask |= BIT(i);
+		}
+	}
+
+	return mask;
+}
+
+static void test_fdb(void)
+{
+	static const uint8_t host_a[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0a };
+	static const uint8_t host_b[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0b };
+	static const uint8_t host_c[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0c };
+	static const uint8_t bcast[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	struct eth_bridge_iface_stats stats0, stats2;
+	struct net_eth_addr addr;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_NET_ETHERNET_BRIDGE_FDB)) {
+		ztest_test_skip();
+	}
+
+	eth_bridge_fdb_flush(&test_bridge, NULL);
+
+	/* nothing is known about host B, the frame is flooded */
+	recv_frame(fake_iface[0], host_a, host_b);
+	zassert_equal(sent_mask(), BIT(2), "");
+
+	/* host A was learnt on fake_iface[0], the reply is only sent there */
+	recv_frame(fake_iface[2], host_b, host_a);
+	zassert_equal(sent_mask(), BIT(0), "");
+
+	/* and host B on fake_iface[2] */
+	recv_frame(fake_iface[0], host_a, host_b);
+	zassert_equal(sent_mask(), BIT(2), "");
+
+	/* broadcast frames are still flooded */
+	recv_frame(fake_iface[0], host_a, bcast);
+	zassert_equal(sent_mask(), BIT(2), "");
+
+	/* frames for the incoming segment are filtered */
+	recv_frame(fake_iface[0], host_c, host_a);
+	zassert_equal(sent_mask(), 0, "");
+
+	/* host A moved to fake_iface[1] */
+	recv_frame(fake_iface[1], host_a, bcast);
+	zassert_equal(sent_mask(), BIT(0) | BIT(2), "");
+	recv_frame(fake_iface[2], host_b, host_a);
+	zassert_equal(sent_mask(), 0, "");
+
+	/* static entries are not moved by learning */
+	memcpy(addr.addr, host_c, sizeof(addr.addr));
+	ret = eth_bridge_fdb_add(&test_bridge, &addr, fake_iface[2]);
+	zassert_equal(ret, 0, "");
+
+	recv_frame(fake_iface[0], host_c, host_b);
+	zassert_equal(sent_mask(), BIT(2), "");
+	recv_frame(fake_iface[0], host_a, host_c);
+	zassert_equal(sent_mask(), BIT(2), "");
+
+	ret = eth_bridge_fdb_remove(&test_bridge, &addr);
+	zassert_equal(ret, 0, "");
+	ret = eth_bridge_fdb_remove(&test_bridge, &addr);
+	zassert_equal(ret, -ENOENT, "");
+
+	/* learnt entries age out */
+	k_sleep(K_SECONDS(CONFIG_NET_ETHERNET_BRIDGE_FDB_AGING_TIME));
+	recv_frame(fake_iface[0], host_c, host_b);
+	zassert_equal(sent_mask(), BIT(2), "");
+
+	ret = eth_bridge_iface_get_stats(fake_iface[0], &stats0);
+	zassert_equal(ret, 0, "");
+	ret = eth_bridge_iface_get_stats(fake_iface[2], &stats2);
+	zassert_equal(ret, 0, "");
+
+	zassert_equal(stats2.tx_forward, 3, "");
+	zassert_equal(stats0.tx_forward, 1, "");
+	zassert_true(stats0.drop >= 1, "");
+
+	check_free_packet_count();
+}
+
 static void test_recv_after_bridging(void)
 {
 	int ret;
@@ -375,6 +500,7 @@ void test_main(void)
 			 ztest_unit_test(test_recv_before_bridging),
 			 ztest_unit_test(test_setup_bridge),
 			 ztest_unit_test(test_recv_with_bridge),
+			 ztest_unit_test(test_fdb),
 			 ztest_unit_test(test_recv_after_bridging));
 
 	ztest_run_test_suite(net_eth_bridge_test);
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <stdlib.h>
+
+#include "gptp_servo.h"
+
+#define STEP_THRESHOLD CONFIG_NET_GPTP_SERVO_STEP_THRESHOLD
+#define MAX_PPB ((double)CONFIG_NET_GPTP_SERVO_MAX_PPB)
+
+/* Sync interval of the simulated clocks, in nanoseconds */
+#define SYNC_INTERVAL (NSEC_PER_SEC / 8)
+
+/* Resolution of a float rate ratio just above 1.0, in ppb */
+#define FLOAT_STEP_PPB (1e9 / (1 << 23))
+
+/* The float ratios keep the locked offset moving by a few steps of the
+ * ratio resolution over one sync interval.
+ */
+#define LOCKED_OFFSET_NS \
+	((int64_t)(3 * FLOAT_STEP_PPB * SYNC_INTERVAL / NSEC_PER_SEC))
+
+/* Local clock steered by the servo, following a grandmaster clock. The
+ * local clock runs off by drift ppb, and its rate is multiplied by the
+ * float ratios the servo applies, like with ptp_clock_rate_adjust().
+ */
+struct sim_clock {
+	struct gptp_servo servo;
+	double master;
+	double local;
+	double drift;
+	double rate;
+	double freq;
+};
+
+static void sim_init(struct sim_clock *sim, double offset)
+{
+	(void)memset(sim, 0, sizeof(*sim));
+
+	sim->local = 1000.0 * NSEC_PER_SEC;
+	sim->master = sim->local + offset;
+	sim->rate = 1.0;
+}
+
+/* Feed the current offset to the servo, apply what it asks for and let
+ * one sync interval pass.
+ */
+static enum gptp_servo_state sim_sync(struct sim_clock *sim, int64_t *offset)
+{
+	enum gptp_servo_state state;
+	float ratio;
+
+	*offset = (int64_t)(sim->master - sim->local);
+
+	state = gptp_servo_sample(&sim->servo, *offset,
+				  (uint64_t)sim->local, &sim->freq);
+	if (state == GPTP_SERVO_JUMP) {
+		sim->local = sim->master;
+	}
+
+	if (state != GPTP_SERVO_UNLOCKED) {
+		ratio = gptp_servo_rate_ratio(&sim->servo, sim->freq);
+		if (ratio != 1.0f) {
+			sim->rate *= ratio;
+			gptp_servo_rate_applied(&sim->servo, ratio);
+		}
+	}
+
+	sim->master += SYNC_INTERVAL;
+	sim->local += SYNC_INTERVAL * (1.0 + sim->drift / NSEC_PER_SEC) *
+		sim->rate;
+
+	return state;
+}
+
+static void test_step(void)
+{
+	struct sim_clock sim;
+	int64_t offset;
+	int i;
+
+	sim_init(&sim, 5 * NSEC_PER_MSEC);
+	sim.drift = -50000.0;
+
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_UNLOCKED,
+		      "Servo locked after one sample");
+	zassert_equal(sim.freq, 0.0, "Frequency adjusted after one sample");
+
+	/* The second sample estimates the frequency error from how much the
+	 * offset changed, and asks for a step as the offset is too large.
+	 */
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_JUMP,
+		      "Clock not stepped");
+	zassert_within(sim.freq, -sim.drift, 10.0,
+		       "Wrong frequency estimate %d ppb", (int)sim.freq);
+
+	/* After the step the servo is locked right away */
+	for (i = 0; i < 20; i++) {
+		zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_LOCKED,
+			      "Servo not locked after the step");
+		zassert_true(llabs(offset) <= LOCKED_OFFSET_NS,
+			     "Offset %d ns after the step", (int)offset);
+	}
+}
+
+static void test_small_offset_no_step(void)
+{
+	struct sim_clock sim;
+	int64_t offset;
+
+	sim_init(&sim, STEP_THRESHOLD / 2);
+
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_UNLOCKED,
+		      "Servo locked after one sample");
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_LOCKED,
+		      "Clock stepped for a small offset");
+	zassert_equal(offset, STEP_THRESHOLD / 2, "Clock stepped");
+}
+
+static void test_convergence(void)
+{
+	struct sim_clock sim;
+	int64_t offset;
+	int i;
+
+	sim_init(&sim, 0);
+
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_UNLOCKED,
+		      "Servo locked after one sample");
+	zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_LOCKED,
+		      "Servo not locked");
+
+	/* The frequency of the local clock changes once the servo is locked.
+	 * The integral term has to pick up the new frequency error.
+	 */
+	sim.drift = 2000.0;
+
+	for (i = 0; i < 200; i++) {
+		zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_LOCKED,
+			      "Servo lost lock at sample %d", i);
+	}
+
+	for (i = 0; i < 20; i++) {
+		zassert_equal(sim_sync(&sim, &offset), GPTP_SERVO_LOCKED,
+			      "Servo lost lock");
+		zassert_true(llabs(offset) <= LOCKED_OFFSET_NS,
+			     "Offset %d ns not converged", (int)offset);
+		zassert_within(sim.freq, -sim.drift, FLOAT_STEP_PPB,
+			       "Frequency %d ppb not converged",
+			       (int)sim.freq);
+	}
+}
+
+static void test_float_ratio(void)
+{
+	struct sim_clock sim;
+	int64_t offset;
+	float ratio;
+	int i;
+
+	/* A change below the float resolution cannot be applied. The clock
+	 * is left alone and the change is still pending in the next ratio.
+	 */
+	sim_init(&sim, 0);
+
+	ratio = gptp_servo_rate_ratio(&sim.servo, FLOAT_STEP_PPB / 4);
+	zassert_equal(ratio, 1.0f, "Too small change not rounded away");
+	zassert_not_equal(gptp_servo_rate_ratio(&sim.servo,
+						2 * FLOAT_STEP_PPB),
+			  1.0f, "Change not applied");
+
+	gptp_servo_rate_applied(&sim.servo,
+				gptp_servo_rate_ratio(&sim.servo, 1000.0));
+	zassert_within(sim.servo.applied_freq, 1000.0, FLOAT_STEP_PPB,
+		       "Wrong applied frequency");
+	zassert_not_equal(sim.servo.applied_freq, 1000.0,
+			  "Rounding of the ratio lost");
+
+	/* A frequency error below the float resolution is corrected by
+	 * switching between the ratios around it. The servo keeps track of
+	 * the rate the clock really runs at.
+	 */
+	sim_init(&sim, 0);
+	sim.drift = 17.0;
+
+	for (i = 0; i < 1000; i++) {
+		zassert_not_equal(sim_sync(&sim, &offset), GPTP_SERVO_JUMP,
+				  "Clock stepped");
+		zassert_within(sim.servo.applied_freq,
+			       (sim.rate - 1.0) * NSEC_PER_SEC, 0.001,
+			       "Applied frequency %d ppb does not match clock",
+			       (int)sim.servo.applied_freq);
+
+		if (i >= 500) {
+			zassert_true(llabs(offset) <= LOCKED_OFFSET_NS,
+				     "Offset %d ns not settled", (int)offset);
+		}
+	}
+}
+
+static void test_clamp(void)
+{
+	struct gptp_servo servo = { 0 };
+	double freq;
+	int i;
+
+	/* An offset change just below the threshold over a short interval
+	 * is a huge frequency error.
+	 */
+	zassert_equal(gptp_servo_sample(&servo, 0, NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_UNLOCKED, "Servo locked after one sample");
+	zassert_equal(gptp_servo_sample(&servo, STEP_THRESHOLD,
+					NSEC_PER_SEC + NSEC_PER_MSEC, &freq),
+		      GPTP_SERVO_LOCKED, "Servo not locked");
+	zassert_equal(freq, MAX_PPB, "Frequency not clamped");
+	zassert_equal(servo.drift, MAX_PPB, "Frequency estimate not clamped");
+
+	/* Both the integral and the proportional term are limited */
+	for (i = 0; i < 100; i++) {
+		zassert_equal(gptp_servo_sample(&servo, -STEP_THRESHOLD,
+						(i + 2) * NSEC_PER_SEC, &freq),
+			      GPTP_SERVO_LOCKED, "Servo not locked");
+		zassert_true(freq >= -MAX_PPB && freq <= MAX_PPB,
+			     "Frequency %d ppb not clamped", (int)freq);
+	}
+
+	zassert_equal(freq, -MAX_PPB, "Frequency not clamped");
+	zassert_equal(servo.drift, -MAX_PPB, "Frequency estimate not clamped");
+}
+
+static void test_reset_on_large_offset(void)
+{
+	struct gptp_servo servo = { 0 };
+	double freq, drift;
+
+	zassert_equal(gptp_servo_sample(&servo, 0, NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_UNLOCKED, "Servo locked after one sample");
+	zassert_equal(gptp_servo_sample(&servo, 100, 2 * NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_LOCKED, "Servo not locked");
+
+	/* A jump of the grandmaster time while locked starts over */
+	zassert_equal(gptp_servo_sample(&servo, STEP_THRESHOLD + 1,
+					3 * NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_UNLOCKED, "Servo not reset");
+	zassert_equal(servo.count, 0U, "Servo not reset");
+
+	zassert_equal(gptp_servo_sample(&servo, STEP_THRESHOLD + 1,
+					4 * NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_UNLOCKED, "Servo locked after one sample");
+	zassert_equal(gptp_servo_sample(&servo, STEP_THRESHOLD + 1,
+					5 * NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_JUMP, "Clock not stepped");
+
+	/* An explicit reset keeps the frequency estimate */
+	drift = servo.drift;
+	gptp_servo_reset(&servo);
+
+	zassert_equal(gptp_servo_sample(&servo, 0, 6 * NSEC_PER_SEC, &freq),
+		      GPTP_SERVO_UNLOCKED, "Servo not reset");
+	zassert_equal(servo.drift, drift, "Frequency estimate lost");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(gptp_servo,
+			 ztest_unit_test(test_step),
+			 ztest_unit_test(test_small_offset_no_step),
+			 ztest_unit_test(test_convergence),
+			 ztest_unit_test(test_float_ratio),
+			 ztest_unit_test(test_clamp),
+			 ztest_unit_test(test_reset_on_large_offset)
+			 );
+
+	ztest_run_test_suite(gptp_servo);
+}
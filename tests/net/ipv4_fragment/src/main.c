@@ -0,0 +1,445 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+/* Interface 1 address */
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+
+/* Address of the peer */
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 1234
+#define PEER_PORT 4321
+
+#define TEST_MTU 500
+#define TEST_DATA_LEN 1200
+
+/* With 20 byte IPv4 header, 480 bytes of payload fits into one fragment */
+#define TEST_FRAG_PAYLOAD_LEN 480
+#define TEST_FRAG_COUNT 3
+
+#define WAIT_TIME K_SECONDS(1)
+
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+static struct net_if *iface1;
+
+static bool test_started;
+static bool test_failed;
+static struct k_sem wait_data;
+static struct k_sem wait_recv;
+
+static int frag_count;
+static uint16_t frag_id;
+static uint8_t test_data[TEST_DATA_LEN];
+
+struct net_if_test {
+	uint8_t idx;
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int verify_fragment(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	uint16_t expected_len;
+	uint16_t offset;
+	uint16_t id;
+	bool more;
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		return -ENOBUFS;
+	}
+
+	offset = ((hdr->offset[0] << 8) | hdr->offset[1]);
+	more = (offset & (NET_IPV4_MF << 13)) != 0U;
+	offset = (offset & NET_IPV4_FRAGH_OFFSET_MASK) * 8U;
+	id = (hdr->id[0] << 8) | hdr->id[1];
+
+	NET_DBG("Fragment %d id 0x%x offset %u more %d len %u",
+		frag_count, id, offset, more, ntohs(hdr->len));
+
+	if (frag_count == 0) {
+		frag_id = id;
+	} else if (id != frag_id) {
+		NET_DBG("Fragment id mismatch 0x%x vs 0x%x", id, frag_id);
+		return -EINVAL;
+	}
+
+	if (offset != frag_count * TEST_FRAG_PAYLOAD_LEN) {
+		NET_DBG("Invalid offset %u", offset);
+		return -EINVAL;
+	}
+
+	if (frag_count < TEST_FRAG_COUNT - 1) {
+		expected_len = sizeof(struct net_ipv4_hdr) +
+			TEST_FRAG_PAYLOAD_LEN;
+		if (!more) {
+			NET_DBG("Fragment More flag should be set");
+			return -EINVAL;
+		}
+	} else {
+		expected_len = sizeof(struct net_ipv4_hdr) +
+			sizeof(struct net_udp_hdr) + TEST_DATA_LEN -
+			(TEST_FRAG_COUNT - 1) * TEST_FRAG_PAYLOAD_LEN;
+		if (more) {
+			NET_DBG("Fragment More flag should be unset");
+			return -EINVAL;
+		}
+	}
+
+	if (ntohs(hdr->len) != expected_len ||
+	    net_pkt_get_len(pkt) != expected_len) {
+		NET_DBG("Invalid length %u, expected %u", ntohs(hdr->len),
+			expected_len);
+		return -EINVAL;
+	}
+
+	if (net_calc_chksum_ipv4(pkt) != 0U) {
+		NET_DBG("Invalid IPv4 header checksum");
+		return -EINVAL;
+	}
+
+	frag_count++;
+
+	return 0;
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	if (test_started) {
+		/* Verify the fragments */
+		if (verify_fragment(pkt) < 0) {
+			NET_DBG("Fragments cannot be verified");
+			test_failed = true;
+		} else {
+			k_sem_give(&wait_data);
+		}
+	}
+
+	net_pkt_unref(pkt);
+	zassert_false(test_failed, "Fragment verify failed");
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 NULL,
+			 &net_iface1_data,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 TEST_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	static uint8_t buf[TEST_DATA_LEN];
+
+	NET_DBG("Data %p received, %zd bytes", pkt,
+		net_pkt_remaining_data(pkt));
+
+	if (net_pkt_remaining_data(pkt) != TEST_DATA_LEN ||
+	    net_pkt_read(pkt, buf, sizeof(buf)) ||
+	    memcmp(buf, test_data, sizeof(buf))) {
+		NET_DBG("Reassembled data mismatch");
+		test_failed = true;
+	}
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_recv);
+
+	return NET_OK;
+}
+
+static void setup_udp_handler(const struct in_addr *raddr,
+			      const struct in_addr *laddr,
+			      uint16_t remote_port,
+			      uint16_t local_port)
+{
+	static struct net_conn_handle *handle;
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	int ret;
+
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, laddr);
+	local_addr.sa_family = AF_INET;
+
+	net_ipaddr_copy(&net_sin(&remote_addr)->sin_addr, raddr);
+	remote_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, &remote_addr, &local_addr,
+			       remote_port, local_port, NULL, udp_data_received,
+			       NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+	int i;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+	k_sem_init(&wait_recv, 0, UINT_MAX);
+
+	for (i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = i;
+	}
+
+	iface1 = net_if_get_by_index(1);
+	zassert_not_null(iface1, "Interface 1");
+
+	ifaddr = net_if_ipv4_addr_add(iface1, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "addr1");
+
+	net_if_up(iface1);
+
+	setup_udp_handler(&peer_addr, &my_addr, PEER_PORT, MY_PORT);
+
+	test_failed = false;
+	test_started = true;
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	struct net_pkt *pkt;
+	int i, ret;
+
+	frag_count = 0;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, TEST_DATA_LEN, AF_INET,
+					IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(MY_PORT), htons(PEER_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	ret = net_pkt_write(pkt, test_data, sizeof(test_data));
+	zassert_equal(ret, 0, "Cannot append data");
+
+	net_pkt_cursor_init(pkt);
+	ret = net_ipv4_finalize(pkt, IPPROTO_UDP);
+	zassert_equal(ret, 0, "Cannot finalize packet");
+
+	test_failed = false;
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send (%d)", ret);
+
+	for (i = 0; i < TEST_FRAG_COUNT; i++) {
+		ret = k_sem_take(&wait_data, WAIT_TIME);
+		zassert_equal(ret, 0, "Timeout while waiting fragment %d", i);
+	}
+
+	zassert_false(test_failed, "Fragment verify failed");
+	zassert_equal(frag_count, TEST_FRAG_COUNT, "Invalid fragment count");
+}
+
+static struct net_pkt *create_fragment(uint16_t id, uint16_t offset,
+				       bool more, const uint8_t *payload,
+				       size_t len)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface1,
+					   sizeof(struct net_ipv4_hdr) + len,
+					   AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET);
+
+	ret = net_ipv4_create_full(pkt, &peer_addr, &my_addr, 0U, id,
+				   more ? NET_IPV4_MF : 0U, offset / 8U, 64U);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_pkt_write(pkt, payload, len);
+	zassert_equal(ret, 0, "Cannot append data");
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	zassert_not_null(hdr, "IPv4 header");
+
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->proto = IPPROTO_UDP;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, false);
+
+	return pkt;
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	static uint8_t payload[sizeof(struct net_udp_hdr) + TEST_DATA_LEN];
+	struct net_udp_hdr *udp_hdr = (struct net_udp_hdr *)payload;
+	struct net_pkt *frags[TEST_FRAG_COUNT];
+	/* Deliver the fragments out of order */
+	static const int order[TEST_FRAG_COUNT] = { 1, 2, 0 };
+	uint16_t id = 0x1234;
+	int i, ret;
+
+	udp_hdr->src_port = htons(PEER_PORT);
+	udp_hdr->dst_port = htons(MY_PORT);
+	udp_hdr->len = htons(sizeof(payload));
+	udp_hdr->chksum = 0U;
+
+	memcpy(payload + sizeof(struct net_udp_hdr), test_data,
+	       sizeof(test_data));
+
+	for (i = 0; i < TEST_FRAG_COUNT; i++) {
+		uint16_t offset = i * TEST_FRAG_PAYLOAD_LEN;
+		bool more = i < TEST_FRAG_COUNT - 1;
+		size_t len = more ? TEST_FRAG_PAYLOAD_LEN :
+			sizeof(payload) - offset;
+
+		frags[i] = create_fragment(id, offset, more, payload + offset,
+					   len);
+	}
+
+	test_failed = false;
+
+	for (i = 0; i < TEST_FRAG_COUNT; i++) {
+		ret = net_recv_data(iface1, frags[order[i]]);
+		zassert_equal(ret, 0, "Cannot receive fragment %d", order[i]);
+	}
+
+	ret = k_sem_take(&wait_recv, WAIT_TIME);
+	zassert_equal(ret, 0, "Timeout while waiting reassembled data");
+	zassert_false(test_failed, "Reassembled data verify failed");
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	/* Only the first fragment is received so the reassembly must
+	 * be cancelled after the timeout and no data delivered. The ICMPv4
+	 * error sent on timeout is not a fragment so do not verify it.
+	 */
+	test_started = false;
+
+	pkt = create_fragment(0x4321, 0U, true, test_data,
+			      TEST_FRAG_PAYLOAD_LEN);
+
+	ret = net_recv_data(iface1, pkt);
+	zassert_equal(ret, 0, "Cannot receive fragment");
+
+	ret = k_sem_take(&wait_recv,
+			 K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT + 1));
+	zassert_not_equal(ret, 0, "Data received from incomplete packet");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
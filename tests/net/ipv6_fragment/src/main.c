@@ -911,6 +911,19 @@ static uint16_t pkt_recv_data_len;
 
 #define ALLOC_TIMEOUT K_MSEC(500)
 
+/* The reassembly tests send the fragments of a UDP datagram of REASS_LEN
+ * bytes. The data is large enough for the fragments that go past the
+ * maximum packet size.
+ */
+#define REASS_SRC_PORT 4353
+#define REASS_DST_PORT 25349
+#define REASS_LEN 1300
+#define REASS_DATA_LEN 1504
+
+static uint8_t reass_data[REASS_DATA_LEN];
+static struct net_pkt *reass_pkt;
+static K_SEM_DEFINE(reass_wait, 0, 1);
+
 struct net_if_test {
 	uint8_t idx;
 	uint8_t mac_addr[sizeof(struct net_eth_addr)];
@@ -1412,10 +1425,26 @@ static enum net_verdict udp_data_received(struct net_conn *conn,
 	return NET_OK;
 }
 
+static enum net_verdict reass_data_received(struct net_conn *conn,
+					    struct net_pkt *pkt,
+					    union net_ip_header *ip_hdr,
+					    union net_proto_header *proto_hdr,
+					    void *user_data)
+{
+	NET_DBG("Reassembled pkt %p received", pkt);
+
+	/* Kept for check_reassembled() */
+	reass_pkt = pkt;
+	k_sem_give(&reass_wait);
+
+	return NET_OK;
+}
+
 static void setup_udp_handler(const struct in6_addr *raddr,
 			      const struct in6_addr *laddr,
 			      uint16_t remote_port,
-			      uint16_t local_port)
+			      uint16_t local_port,
+			      net_conn_cb_t cb)
 {
 	static struct net_conn_handle *handle;
 	struct sockaddr remote_addr = { 0 };
@@ -1429,11 +1458,61 @@ static void setup_udp_handler(const struct in6_addr *raddr,
 	remote_addr.sa_family = AF_INET6;
 
 	ret = net_udp_register(AF_INET6, &remote_addr, &local_addr,
-			       remote_port, local_port, NULL, udp_data_received,
-			       NULL, &handle);
+			       remote_port, local_port, NULL, cb, NULL,
+			       &handle);
 	zassert_equal(ret, 0, "Cannot register UDP handler");
 }
 
+/* Fill the data of the fragments with a byte pattern, and make its start
+ * a valid UDP datagram from my_addr2 to my_addr1.
+ */
+static void reass_data_init(void)
+{
+	struct net_ipv6_hdr ipv6_hdr = {
+		.vtc = 0x60,
+		.len = htons(REASS_LEN),
+		.nexthdr = IPPROTO_UDP,
+		.hop_limit = 64U,
+	};
+	struct net_udp_hdr udp_hdr = {
+		.src_port = htons(REASS_SRC_PORT),
+		.dst_port = htons(REASS_DST_PORT),
+		.len = htons(REASS_LEN),
+	};
+	struct net_pkt *pkt;
+	uint16_t i;
+	int ret;
+
+	for (i = 0U; i < sizeof(reass_data); i++) {
+		reass_data[i] = i & 0xff;
+	}
+
+	net_ipaddr_copy(&ipv6_hdr.src, &my_addr2);
+	net_ipaddr_copy(&ipv6_hdr.dst, &my_addr1);
+
+	pkt = net_pkt_alloc_with_buffer(iface1, sizeof(ipv6_hdr) + REASS_LEN,
+					AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(ipv6_hdr));
+
+	ret = net_pkt_write(pkt, &ipv6_hdr, sizeof(ipv6_hdr));
+	zassert_true(ret == 0, "IPv6 header append failed");
+
+	ret = net_pkt_write(pkt, &udp_hdr, sizeof(udp_hdr));
+	zassert_true(ret == 0, "UDP header append failed");
+
+	ret = net_pkt_write(pkt, reass_data + sizeof(udp_hdr),
+			    REASS_LEN - sizeof(udp_hdr));
+	zassert_true(ret == 0, "UDP payload append failed");
+
+	udp_hdr.chksum = net_calc_chksum_udp(pkt);
+	net_pkt_unref(pkt);
+
+	memcpy(reass_data, &udp_hdr, sizeof(udp_hdr));
+}
+
 static void test_setup(void)
 {
 	struct net_if_addr *ifaddr;
@@ -1486,7 +1565,13 @@ static void test_setup(void)
 	/* Remote and local are swapped so that we can receive the sent
 	 * packet.
 	 */
-	setup_udp_handler(&my_addr1, &my_addr2, 4352, 25348);
+	setup_udp_handler(&my_addr1, &my_addr2, 4352, 25348,
+			  udp_data_received);
+
+	/* Receives the packets reassembled by the reassembly tests */
+	reass_data_init();
+	setup_udp_handler(&my_addr2, &my_addr1, REASS_SRC_PORT,
+			  REASS_DST_PORT, reass_data_received);
 
 	/* The interface might receive data which might fail the checks
 	 * in the iface sending function, so we need to reset the failure
@@ -2043,6 +2128,167 @@ static void test_recv_ipv6_fragment(void)
 	zassert_true(ret == NET_OK, "IPv6 frag2 reassembly failed");
 }
 
+static void count_reassembly_cb(struct net_ipv6_reassembly *reass,
+				void *user_data)
+{
+	int *count = user_data;
+
+	(*count)++;
+}
+
+static int pending_reassemblies(void)
+{
+	int count = 0;
+
+	net_ipv6_frag_foreach(count_reassembly_cb, &count);
+
+	return count;
+}
+
+static enum net_verdict recv_ipv6_fragment(uint32_t id, uint16_t offset,
+					   bool more, uint16_t len)
+{
+	struct net_ipv6_frag_hdr frag_hdr;
+	struct net_ipv6_hdr ipv6_hdr;
+	enum net_verdict verdict;
+	struct net_pkt *pkt;
+	int ret;
+
+	zassert_true(offset + len <= sizeof(reass_data), "Fragment too long");
+
+	memcpy(&ipv6_hdr, ipv6_reass_frag1, sizeof(struct net_ipv6_hdr));
+	ipv6_hdr.len = htons(sizeof(frag_hdr) + len);
+
+	frag_hdr.nexthdr = IPPROTO_UDP;
+	frag_hdr.reserved = 0U;
+	frag_hdr.offset = htons(offset | (more ? 1 : 0));
+	frag_hdr.id = htonl(id);
+
+	pkt = net_pkt_alloc_with_buffer(iface1, sizeof(ipv6_hdr) +
+					sizeof(frag_hdr) + len,
+					AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv6_hdr));
+
+	ret = net_pkt_write(pkt, &ipv6_hdr, sizeof(ipv6_hdr));
+	zassert_true(ret == 0, "IPv6 header append failed");
+
+	ret = net_pkt_write(pkt, &frag_hdr, sizeof(frag_hdr));
+	zassert_true(ret == 0, "IPv6 fragment header append failed");
+
+	ret = net_pkt_write(pkt, reass_data + offset, len);
+	zassert_true(ret == 0, "IPv6 payload append failed");
+
+	net_pkt_set_ipv6_fragment_start(pkt, sizeof(struct net_ipv6_hdr));
+	net_pkt_set_ipv6_hdr_prev(pkt, offsetof(struct net_ipv6_hdr, nexthdr));
+	net_pkt_set_overwrite(pkt, true);
+
+	/* Like net_ipv6_input(), the next header of the fragment header has
+	 * already been read.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_skip(pkt, sizeof(struct net_ipv6_hdr) + 1);
+
+	verdict = net_ipv6_handle_fragment_hdr(pkt, &ipv6_hdr,
+					       NET_IPV6_NEXTHDR_FRAG);
+	if (verdict == NET_DROP) {
+		net_pkt_unref(pkt);
+	}
+
+	return verdict;
+}
+
+/* Wait for the packet reassembled from the fragments, and check that it
+ * is the datagram they carried without the fragment header.
+ */
+static void check_reassembled(void)
+{
+	static uint8_t data[REASS_LEN];
+	struct net_ipv6_hdr ipv6_hdr;
+	struct net_pkt *pkt;
+	int ret;
+
+	zassert_equal(k_sem_take(&reass_wait, WAIT_TIME), 0,
+		      "Reassembled packet not received");
+
+	pkt = reass_pkt;
+	reass_pkt = NULL;
+
+	zassert_equal(net_pkt_get_len(pkt), sizeof(ipv6_hdr) + REASS_LEN,
+		      "Wrong reassembled packet length");
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	ret = net_pkt_read(pkt, &ipv6_hdr, sizeof(ipv6_hdr));
+	zassert_true(ret == 0, "Cannot read IPv6 header");
+
+	zassert_equal(ntohs(ipv6_hdr.len), REASS_LEN,
+		      "Payload length not updated");
+	zassert_equal(ipv6_hdr.nexthdr, IPPROTO_UDP,
+		      "Next header not updated");
+
+	ret = net_pkt_read(pkt, data, sizeof(data));
+	zassert_true(ret == 0, "Cannot read payload");
+
+	zassert_mem_equal(data, reass_data, sizeof(data),
+			  "Wrong reassembled payload");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_recv_ipv6_fragment_reverse(void)
+{
+	zassert_equal(recv_ipv6_fragment(0x1001, 1232U, false, 68U), NET_OK,
+		      "Last fragment not accepted");
+	zassert_equal(pending_reassemblies(), 1, "Reassembly not pending");
+
+	zassert_equal(recv_ipv6_fragment(0x1001, 0U, true, 1232U), NET_OK,
+		      "First fragment not accepted");
+	zassert_equal(pending_reassemblies(), 0, "Reassembly not completed");
+
+	check_reassembled();
+}
+
+static void test_recv_ipv6_fragment_duplicate(void)
+{
+	zassert_equal(recv_ipv6_fragment(0x1002, 0U, true, 1232U), NET_OK,
+		      "First fragment not accepted");
+	zassert_equal(recv_ipv6_fragment(0x1002, 0U, true, 1232U), NET_DROP,
+		      "Duplicate fragment accepted");
+	zassert_equal(pending_reassemblies(), 1,
+		      "Duplicate fragment cancelled the reassembly");
+
+	zassert_equal(recv_ipv6_fragment(0x1002, 1232U, false, 68U), NET_OK,
+		      "Last fragment not accepted");
+	zassert_equal(pending_reassemblies(), 0, "Reassembly not completed");
+
+	check_reassembled();
+}
+
+static void test_recv_ipv6_fragment_overlap(void)
+{
+	zassert_equal(recv_ipv6_fragment(0x1003, 0U, true, 1232U), NET_OK,
+		      "First fragment not accepted");
+	zassert_equal(recv_ipv6_fragment(0x1003, 1224U, false, 76U), NET_DROP,
+		      "Overlapping fragment accepted");
+	zassert_equal(pending_reassemblies(), 0,
+		      "Overlapping fragment did not cancel the reassembly");
+}
+
+static void test_recv_ipv6_fragment_too_big(void)
+{
+	zassert_equal(recv_ipv6_fragment(0x1004, 0U, true, 1232U), NET_OK,
+		      "First fragment not accepted");
+	/* 40 bytes of header and 1504 bytes of payload */
+	zassert_equal(recv_ipv6_fragment(0x1004, 1496U, false, 8U), NET_DROP,
+		      "Too large packet accepted");
+	zassert_equal(pending_reassemblies(), 0,
+		      "Too large packet did not cancel the reassembly");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(net_ipv6_fragment_test,
@@ -2059,7 +2305,11 @@ void test_main(void)
 			 ztest_unit_test(test_send_ipv6_fragment),
 			 ztest_unit_test(test_send_ipv6_fragment_large_hbho),
 			 ztest_unit_test(test_send_ipv6_fragment_without_hbho),
-			 ztest_unit_test(test_recv_ipv6_fragment)
+			 ztest_unit_test(test_recv_ipv6_fragment),
+			 ztest_unit_test(test_recv_ipv6_fragment_reverse),
+			 ztest_unit_test(test_recv_ipv6_fragment_duplicate),
+			 ztest_unit_test(test_recv_ipv6_fragment_overlap),
+			 ztest_unit_test(test_recv_ipv6_fragment_too_big)
 			 );
 
 	ztest_run_test_suite(net_ipv6_fragment_test);
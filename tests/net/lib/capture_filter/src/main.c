@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <net/net_pkt.h>
+
+#include "capture_internal.h"
+
+#define FILTER_LEN CONFIG_NET_CAPTURE_FILTER_LEN
+
+/* 192.0.2.1:1000 -> 192.0.2.2:5683, 36 bytes */
+static const uint8_t ipv4_udp[] = {
+	0x45, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x00,
+	0x40, 0x11, 0x00, 0x00, 0xc0, 0x00, 0x02, 0x01,
+	0xc0, 0x00, 0x02, 0x02,
+	0x03, 0xe8, 0x16, 0x33, 0x00, 0x10, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/* [2001:db8::1]:49152 -> [2001:db8::2]:80, 60 bytes */
+static const uint8_t ipv6_tcp[] = {
+	0x60, 0x00, 0x00, 0x00, 0x00, 0x14, 0x06, 0x40,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+	0xc0, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x50, 0x02, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+};
+
+/* Echo request 2001:db8::2 -> 2001:db8::1, 48 bytes */
+static const uint8_t ipv6_icmp[] = {
+	0x60, 0x00, 0x00, 0x00, 0x00, 0x08, 0x3a, 0x40,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/* [2001:db8::1]:53 -> [2001:db8::2]:53 after a hop-by-hop options
+ * header, 56 bytes
+ */
+static const uint8_t ipv6_hbh_udp[] = {
+	0x60, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x40,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+	0x11, 0x00, 0x01, 0x04, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x35, 0x00, 0x35, 0x00, 0x08, 0x00, 0x00,
+};
+
+/* The IPv4 UDP packet in an Ethernet frame */
+static const uint8_t eth_hdr[] = {
+	0x02, 0x00, 0x5e, 0x00, 0x53, 0x02, 0x02, 0x00,
+	0x5e, 0x00, 0x53, 0x01, 0x08, 0x00,
+};
+
+struct test_match {
+	const char *expr;
+	bool ipv4_udp;
+	bool ipv6_tcp;
+	bool ipv6_icmp;
+	bool ipv6_hbh_udp;
+};
+
+static const struct test_match matches[] = {
+	{ "", true, true, true, true },
+	{ "ip", true, false, false, false },
+	{ "ip6", false, true, true, true },
+	{ "udp", true, false, false, true },
+	{ "tcp", false, true, false, false },
+	{ "icmp6", false, false, true, false },
+	{ "host 192.0.2.1", true, false, false, false },
+	{ "src host 192.0.2.2", false, false, false, false },
+	{ "dst host 192.0.2.2", true, false, false, false },
+	{ "host 2001:db8::2", false, true, true, true },
+	{ "src host 2001:db8::2", false, false, true, false },
+	{ "port 5683", true, false, false, false },
+	{ "src port 49152", false, true, false, false },
+	{ "dst port 49152", false, false, false, false },
+	{ "udp port 53", false, false, false, true },
+	{ "tcp port 5683", false, false, false, false },
+	{ "tcp dst port 80", false, true, false, false },
+	{ "less 48", true, false, true, false },
+	{ "greater 56", false, true, false, true },
+	{ "udp or icmp6", true, false, true, true },
+	{ "udp && ip6", false, false, false, true },
+	{ "!udp", false, true, true, false },
+	{ "not not udp", true, false, false, true },
+};
+
+/* Expressions that only differ by their grouping */
+static const struct test_match precedence[] = {
+	{ "ip or ip6 and tcp", true, true, false, false },
+	{ "(ip or ip6) and tcp", false, true, false, false },
+	{ "ip6 and tcp or udp", true, true, false, true },
+	{ "ip6 and (tcp or udp)", false, true, false, true },
+	{ "not ip or udp", true, true, true, true },
+	{ "not (ip or udp)", false, true, true, false },
+	{ "not ip6 and udp", true, false, false, false },
+	{ "not (ip6 and udp)", true, true, true, false },
+};
+
+static const char * const invalid[] = {
+	"foo",
+	"ip and",
+	"or ip",
+	"ip tcp",
+	"(ip",
+	"ip)",
+	"()",
+	"not",
+	"ip & tcp",
+	"ip | tcp",
+	"host",
+	"host 192.0.2",
+	"host 192.0.2.256",
+	"host 192.0.2.1.",
+	"host 192.0..2",
+	"host 2001:db8::g",
+	"src",
+	"src ip",
+	"port",
+	"port 65536",
+	"port -1",
+	"port 0x10",
+	"tcp port",
+	"udp host 192.0.2.1",
+	"less",
+	"greater large",
+};
+
+static struct capture_filter filter;
+
+static struct net_pkt *create_pkt(const uint8_t *hdr, size_t hdr_len,
+				  const uint8_t *data, size_t len)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(NULL, hdr_len + len, AF_UNSPEC, 0,
+					K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	if (hdr_len > 0) {
+		zassert_equal(net_pkt_write(pkt, hdr, hdr_len), 0,
+			      "Cannot write header");
+	}
+
+	zassert_equal(net_pkt_write(pkt, data, len), 0, "Cannot write data");
+
+	return pkt;
+}
+
+static bool match(const char *expr, uint16_t link_type,
+		  const uint8_t *data, size_t len)
+{
+	struct net_pkt *pkt;
+	bool ret;
+
+	zassert_equal(capture_filter_compile(&filter, expr), 0,
+		      "Cannot compile \"%s\"", expr);
+
+	pkt = create_pkt(NULL, 0, data, len);
+	ret = capture_filter_match(&filter, link_type, pkt);
+	net_pkt_unref(pkt);
+
+	return ret;
+}
+
+static void check_matches(const struct test_match *tests, size_t count)
+{
+	const struct test_match *test;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		test = &tests[i];
+
+		zassert_equal(match(test->expr, CAPTURE_LINKTYPE_RAW,
+				    ipv4_udp, sizeof(ipv4_udp)),
+			      test->ipv4_udp, "\"%s\" on IPv4 UDP", test->expr);
+		zassert_equal(match(test->expr, CAPTURE_LINKTYPE_RAW,
+				    ipv6_tcp, sizeof(ipv6_tcp)),
+			      test->ipv6_tcp, "\"%s\" on IPv6 TCP", test->expr);
+		zassert_equal(match(test->expr, CAPTURE_LINKTYPE_RAW,
+				    ipv6_icmp, sizeof(ipv6_icmp)),
+			      test->ipv6_icmp, "\"%s\" on ICMPv6", test->expr);
+		zassert_equal(match(test->expr, CAPTURE_LINKTYPE_RAW,
+				    ipv6_hbh_udp, sizeof(ipv6_hbh_udp)),
+			      test->ipv6_hbh_udp,
+			      "\"%s\" on IPv6 UDP with options", test->expr);
+	}
+}
+
+static void test_match(void)
+{
+	check_matches(matches, ARRAY_SIZE(matches));
+}
+
+static void test_precedence(void)
+{
+	check_matches(precedence, ARRAY_SIZE(precedence));
+}
+
+static void test_match_ethernet(void)
+{
+	struct net_pkt *pkt;
+
+	zassert_equal(capture_filter_compile(&filter,
+					     "udp dst port 5683 and "
+					     "src host 192.0.2.1"), 0,
+		      "Cannot compile filter");
+
+	pkt = create_pkt(eth_hdr, sizeof(eth_hdr), ipv4_udp,
+			 sizeof(ipv4_udp));
+
+	zassert_true(capture_filter_match(&filter, CAPTURE_LINKTYPE_ETHERNET,
+					  pkt), "Ethernet frame not matched");
+
+	/* Without link header the data is not recognized */
+	zassert_false(capture_filter_match(&filter, CAPTURE_LINKTYPE_RAW,
+					   pkt), "Ethernet frame parsed as IP");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_compile_invalid(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_equal(capture_filter_compile(&filter, invalid[i]),
+			      -EINVAL, "\"%s\" accepted", invalid[i]);
+		zassert_equal(filter.count, 0, "Invalid filter kept");
+	}
+
+	zassert_equal(capture_filter_compile(&filter, NULL), 0,
+		      "Empty filter rejected");
+	zassert_equal(filter.count, 0, "Empty filter not empty");
+}
+
+/* Append count times str to buf */
+static void repeat(char *buf, size_t size, const char *str, int count)
+{
+	while (count-- > 0) {
+		strncat(buf, str, size - strlen(buf) - 1);
+	}
+}
+
+static void test_compile_too_long(void)
+{
+	static char expr[4 * FILTER_LEN + 64];
+	/* n primitives and n - 1 operators, completed with a "not" */
+	int primitives = (FILTER_LEN + 1) / 2;
+	int nots = FILTER_LEN - (2 * primitives - 1);
+
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "not ", nots);
+	strcat(expr, "ip");
+	repeat(expr, sizeof(expr), " or ip", primitives - 1);
+
+	zassert_equal(capture_filter_compile(&filter, expr), 0,
+		      "Filter of %d instructions rejected", FILTER_LEN);
+	zassert_equal(filter.count, FILTER_LEN, "Wrong number of instructions");
+
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "not ", nots + 1);
+	strcat(expr, "ip");
+	repeat(expr, sizeof(expr), " or ip", primitives - 1);
+
+	zassert_equal(capture_filter_compile(&filter, expr), -E2BIG,
+		      "Too long filter accepted");
+	zassert_equal(filter.count, 0, "Too long filter kept");
+}
+
+static void test_compile_deep_nesting(void)
+{
+	static char expr[4 * FILTER_LEN + 64];
+
+	/* Parentheses do not add instructions, only their depth is limited */
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "(", FILTER_LEN);
+	strcat(expr, "ip");
+	repeat(expr, sizeof(expr), ")", FILTER_LEN);
+
+	zassert_equal(capture_filter_compile(&filter, expr), 0,
+		      "Nesting of %d rejected", FILTER_LEN);
+	zassert_equal(filter.count, 1, "Wrong number of instructions");
+
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "(", FILTER_LEN + 1);
+	strcat(expr, "ip");
+	repeat(expr, sizeof(expr), ")", FILTER_LEN + 1);
+
+	zassert_equal(capture_filter_compile(&filter, expr), -E2BIG,
+		      "Nesting of %d accepted", FILTER_LEN + 1);
+	zassert_equal(filter.count, 0, "Too deep filter kept");
+
+	/* The depth is checked before the expression is read to its end */
+	memset(expr, '(', sizeof(expr) - 1);
+	expr[sizeof(expr) - 1] = '\0';
+
+	zassert_equal(capture_filter_compile(&filter, expr), -E2BIG,
+		      "Deep unbalanced nesting accepted");
+
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "not ", FILTER_LEN + 1);
+	strcat(expr, "ip");
+
+	zassert_equal(capture_filter_compile(&filter, expr), -E2BIG,
+		      "Deep negation accepted");
+
+	expr[0] = '\0';
+	repeat(expr, sizeof(expr), "!(", FILTER_LEN);
+	strcat(expr, "ip");
+	repeat(expr, sizeof(expr), ")", FILTER_LEN);
+
+	zassert_equal(capture_filter_compile(&filter, expr), -E2BIG,
+		      "Deep negated groups accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(capture_filter,
+			 ztest_unit_test(test_match),
+			 ztest_unit_test(test_precedence),
+			 ztest_unit_test(test_match_ethernet),
+			 ztest_unit_test(test_compile_invalid),
+			 ztest_unit_test(test_compile_too_long),
+			 ztest_unit_test(test_compile_deep_nesting)
+			 );
+
+	ztest_run_test_suite(capture_filter);
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/coap.h>
+#include <net/coap_blockwise.h>
+
+#define BODY_LEN 3000
+#define MSG_LEN 320
+#define MAX_MSGS 16
+
+static const char * const path[] = { "fw", "image", NULL };
+
+static uint8_t body[BODY_LEN];
+static size_t body_len;
+static uint8_t received[BODY_LEN];
+static size_t received_len;
+static int last_count;
+
+/* Messages in flight between the client and the server */
+static struct {
+	uint8_t data[MSG_LEN];
+	uint16_t len;
+	bool to_server;
+} msgs[MAX_MSGS];
+static int msg_count;
+static int max_requests;
+static int drop_count;
+
+static struct coap_blockwise_server server;
+static enum coap_block_size server_block_size;
+static int server_done;
+
+static void queue_msg(const uint8_t *data, size_t len, bool to_server)
+{
+	int requests = 0;
+	int i;
+
+	zassert_true(msg_count < MAX_MSGS, "Too many messages");
+	zassert_true(len <= MSG_LEN, "Message too long");
+
+	memcpy(msgs[msg_count].data, data, len);
+	msgs[msg_count].len = len;
+	msgs[msg_count].to_server = to_server;
+	msg_count++;
+
+	for (i = 0; i < msg_count; i++) {
+		requests += msgs[i].to_server;
+	}
+
+	max_requests = MAX(max_requests, requests);
+}
+
+static int send_cb(const uint8_t *data, size_t len, void *user_data)
+{
+	if (drop_count > 0) {
+		drop_count--;
+		return 0;
+	}
+
+	queue_msg(data, len, true);
+
+	return 0;
+}
+
+static int sink_cb(size_t offset, const uint8_t *data, size_t len, bool last,
+		   void *user_data)
+{
+	zassert_equal(offset, received_len, "Block out of order");
+	zassert_true(offset + len <= sizeof(received), "Body too long");
+
+	memcpy(&received[offset], data, len);
+	received_len += len;
+	last_count += last;
+
+	return 0;
+}
+
+static int source_cb(size_t offset, uint8_t *data, size_t len, bool *last,
+		     void *user_data)
+{
+	if (offset >= body_len) {
+		*last = true;
+		return 0;
+	}
+
+	len = MIN(len, body_len - offset);
+	memcpy(data, &body[offset], len);
+	*last = offset + len == body_len;
+
+	return len;
+}
+
+static void server_input(uint8_t *data, uint16_t len)
+{
+	struct coap_packet request, response;
+	uint8_t buf[MSG_LEN];
+	int ret;
+
+	ret = coap_packet_parse(&request, data, len, NULL, 0);
+	zassert_equal(ret, 0, "Cannot parse request (%d)", ret);
+
+	if (coap_header_get_code(&request) == COAP_METHOD_GET) {
+		ret = coap_blockwise_server_get(&request, &response, buf,
+						sizeof(buf), server_block_size,
+						body_len, source_cb, NULL);
+	} else {
+		ret = coap_blockwise_server_put(&server, &request, &response,
+						buf, sizeof(buf),
+						COAP_RESPONSE_CODE_CHANGED);
+		server_done += ret == 1;
+	}
+
+	zassert_true(ret >= 0, "Server failed (%d)", ret);
+
+	queue_msg(response.data, response.offset, false);
+}
+
+/* Deliver the messages in the order they were sent until the transfer
+ * ends or no message is left.
+ */
+static void run(struct coap_blockwise_client *client)
+{
+	uint8_t data[MSG_LEN];
+	uint16_t len;
+	bool to_server;
+
+	while (msg_count > 0 &&
+	       coap_blockwise_client_result(client) == -EINPROGRESS) {
+		memcpy(data, msgs[0].data, msgs[0].len);
+		len = msgs[0].len;
+		to_server = msgs[0].to_server;
+
+		msg_count--;
+		memmove(&msgs[0], &msgs[1], msg_count * sizeof(msgs[0]));
+
+		if (to_server) {
+			server_input(data, len);
+		} else {
+			(void)coap_blockwise_client_input(client, data, len);
+		}
+	}
+}
+
+static void reset(size_t len)
+{
+	int i;
+
+	for (i = 0; i < sizeof(body); i++) {
+		body[i] = i * 7;
+	}
+
+	body_len = len;
+	received_len = 0;
+	last_count = 0;
+	msg_count = 0;
+	max_requests = 0;
+	drop_count = 0;
+	server_done = 0;
+	server_block_size = COAP_BLOCK_1024;
+
+	coap_blockwise_server_init(&server, sink_cb, NULL);
+}
+
+static void check_body(void)
+{
+	zassert_equal(received_len, body_len, "Invalid body length %zu",
+		      received_len);
+	zassert_mem_equal(received, body, body_len, "Invalid body");
+	zassert_equal(last_count, 1, "Last block given %d times", last_count);
+}
+
+static void test_blockwise_get(void)
+{
+	struct coap_blockwise_client client;
+	int ret;
+
+	reset(BODY_LEN);
+
+	ret = coap_blockwise_client_init(&client, path, COAP_BLOCK_256, 4,
+					 send_cb, NULL);
+	zassert_equal(ret, 0, "Cannot init client (%d)", ret);
+
+	ret = coap_blockwise_client_get(&client, sink_cb);
+	zassert_equal(ret, 0, "Cannot start transfer (%d)", ret);
+
+	/* Only the first block is requested before the size is known */
+	zassert_equal(msg_count, 1, "Invalid number of requests");
+
+	run(&client);
+
+	zassert_equal(coap_blockwise_client_result(&client), 0,
+		      "Transfer failed");
+	zassert_equal(max_requests, 4, "Requests not pipelined");
+	check_body();
+}
+
+static void test_blockwise_get_smaller_block(void)
+{
+	struct coap_blockwise_client client;
+	int ret;
+
+	reset(1000);
+	server_block_size = COAP_BLOCK_64;
+
+	ret = coap_blockwise_client_init(&client, path, COAP_BLOCK_256, 4,
+					 send_cb, NULL);
+	zassert_equal(ret, 0, "Cannot init client (%d)", ret);
+
+	ret = coap_blockwise_client_get(&client, sink_cb);
+	zassert_equal(ret, 0, "Cannot start transfer (%d)", ret);
+
+	run(&client);
+
+	zassert_equal(coap_blockwise_client_result(&client), 0,
+		      "Transfer failed");
+	zassert_equal(client.block_size, COAP_BLOCK_64,
+		      "Block size not negotiated");
+	check_body();
+}
+
+static void test_blockwise_put(void)
+{
+	struct coap_blockwise_client client;
+	int ret;
+
+	reset(BODY_LEN);
+
+	ret = coap_blockwise_client_init(&client, path, COAP_BLOCK_128, 4,
+					 send_cb, NULL);
+	zassert_equal(ret, 0, "Cannot init client (%d)", ret);
+
+	ret = coap_blockwise_client_put(&client, COAP_METHOD_PUT, source_cb);
+	zassert_equal(ret, 0, "Cannot start transfer (%d)", ret);
+
+	run(&client);
+
+	zassert_equal(coap_blockwise_client_result(&client), 0,
+		      "Transfer failed");
+	zassert_equal(max_requests, 4, "Requests not pipelined");
+	zassert_equal(server_done, 1, "Server not done");
+	check_body();
+}
+
+static int put_block(uint32_t num, bool more, uint16_t id)
+{
+	struct coap_packet request, response;
+	uint8_t req_buf[MSG_LEN], rsp_buf[MSG_LEN];
+	int ret;
+
+	ret = coap_packet_init(&request, req_buf, sizeof(req_buf),
+			       COAP_VERSION_1, COAP_TYPE_CON, 0, NULL,
+			       COAP_METHOD_PUT, id);
+	zassert_equal(ret, 0, "Cannot init request");
+
+	ret = coap_append_option_int(&request, COAP_OPTION_BLOCK1,
+				     (num << 4) | (more ? 0x08 : 0) |
+				     COAP_BLOCK_16);
+	zassert_equal(ret, 0, "Cannot append Block1");
+
+	ret = coap_packet_append_payload_marker(&request);
+	zassert_equal(ret, 0, "Cannot append payload marker");
+
+	ret = coap_packet_append_payload(&request, &body[num * 16], 16);
+	zassert_equal(ret, 0, "Cannot append payload");
+
+	ret = coap_blockwise_server_put(&server, &request, &response,
+					rsp_buf, sizeof(rsp_buf),
+					COAP_RESPONSE_CODE_CHANGED);
+
+	memcpy(msgs[0].data, rsp_buf, response.offset);
+	msgs[0].len = response.offset;
+
+	return ret;
+}
+
+static uint8_t last_response_code(void)
+{
+	struct coap_packet response;
+
+	zassert_equal(coap_packet_parse(&response, msgs[0].data, msgs[0].len,
+					NULL, 0), 0, "Invalid response");
+
+	return coap_header_get_code(&response);
+}
+
+static void test_blockwise_server_reorder(void)
+{
+	int ret;
+
+	reset(64);
+
+	/* Block 1 is held until block 0 arrives */
+	ret = put_block(1, true, 1);
+	zassert_equal(ret, -EINVAL, "Block accepted without a transfer");
+
+	ret = put_block(0, true, 2);
+	zassert_equal(ret, 0, "Block 0 refused (%d)", ret);
+
+	ret = put_block(2, true, 3);
+	zassert_equal(ret, 0, "Block 2 refused (%d)", ret);
+	zassert_equal(last_response_code(), COAP_RESPONSE_CODE_CONTINUE,
+		      "Invalid response code");
+	zassert_equal(received_len, 16, "Block 2 given to the sink");
+
+	/* The last block is refused while blocks before it are missing */
+	ret = put_block(3, false, 4);
+	zassert_equal(ret, -EINVAL, "Last block accepted too early");
+	zassert_equal(last_response_code(), COAP_RESPONSE_CODE_INCOMPLETE,
+		      "Invalid response code");
+
+	ret = put_block(1, true, 5);
+	zassert_equal(ret, 0, "Block 1 refused (%d)", ret);
+	zassert_equal(received_len, 48, "Held block not given to the sink");
+
+	/* Retransmission of a block given to the sink already */
+	ret = put_block(0, true, 2);
+	zassert_equal(ret, 0, "Duplicate refused (%d)", ret);
+	zassert_equal(received_len, 48, "Duplicate given to the sink");
+
+	ret = put_block(3, false, 6);
+	zassert_equal(ret, 1, "Transfer not done (%d)", ret);
+	zassert_equal(last_response_code(), COAP_RESPONSE_CODE_CHANGED,
+		      "Invalid response code");
+
+	check_body();
+}
+
+static void test_blockwise_retransmit(void)
+{
+	struct coap_blockwise_client client;
+	int32_t timeout;
+	int ret;
+
+	reset(600);
+
+	ret = coap_blockwise_client_init(&client, path, COAP_BLOCK_256, 4,
+					 send_cb, NULL);
+	zassert_equal(ret, 0, "Cannot init client (%d)", ret);
+
+	/* First request is lost */
+	drop_count = 1;
+
+	ret = coap_blockwise_client_get(&client, sink_cb);
+	zassert_equal(ret, 0, "Cannot start transfer (%d)", ret);
+	zassert_equal(msg_count, 0, "Request not dropped");
+
+	timeout = coap_blockwise_client_process(&client);
+	zassert_true(timeout > 0 && timeout <= CONFIG_COAP_INIT_ACK_TIMEOUT_MS,
+		     "Invalid timeout %d", timeout);
+
+	k_msleep(timeout);
+
+	(void)coap_blockwise_client_process(&client);
+	zassert_equal(msg_count, 1, "Request not retransmitted");
+
+	run(&client);
+
+	zassert_equal(coap_blockwise_client_result(&client), 0,
+		      "Transfer failed");
+	zassert_equal(coap_blockwise_client_process(&client), SYS_FOREVER_MS,
+		      "Timer left running");
+	check_body();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(coap_blockwise_tests,
+			 ztest_unit_test(test_blockwise_get),
+			 ztest_unit_test(test_blockwise_get_smaller_block),
+			 ztest_unit_test(test_blockwise_put),
+			 ztest_unit_test(test_blockwise_server_reorder),
+			 ztest_unit_test(test_blockwise_retransmit));
+
+	ztest_run_test_suite(coap_blockwise_tests);
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <sys/crc.h>
+#include <dns_pack.h>
+#include <dns_internal.h>
+#include <dns_cache.h>
+
+#define MAX_BUF_SIZE	512
+
+#define DNAME1 "www.zephyrproject.org"
+#define DNAME2 "nx.example.com"
+
+static struct dns_resolve_context dns_ctx;
+
+/* Domain: www.zephyrproject.org
+ * Type: standard query (IPv4)
+ * Transaction ID: 0xb041
+ * TTL: 3028
+ * RData: 140.211.169.8
+ */
+static uint8_t resp_ipv4[] = { 0xb0, 0x41, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01,
+			       0x00, 0x00, 0x00, 0x00, 0x03, 0x77, 0x77, 0x77,
+			       0x0d, 0x7a, 0x65, 0x70, 0x68, 0x79, 0x72, 0x70,
+			       0x72, 0x6f, 0x6a, 0x65, 0x63, 0x74, 0x03, 0x6f,
+			       0x72, 0x67, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0,
+			       0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x0b,
+			       0xd4, 0x00, 0x04, 0x8c, 0xd3, 0xa9, 0x08 };
+
+/* Offset of the answer TTL in resp_ipv4 */
+#define RESP_IPV4_TTL_POS 45
+
+static const uint8_t resp_ipv4_addr[] = { 140, 211, 169, 8 };
+
+/* Domain: nx.example.com
+ * Type: standard query (IPv4)
+ * Transaction ID: 0x1234
+ * Response code: No such name
+ * Authority: example.com SOA, TTL 3600, MINIMUM 60
+ */
+static uint8_t resp_nxdomain[] = {
+	/* Header */
+	0x12, 0x34, 0x81, 0x83, 0x00, 0x01, 0x00, 0x00,
+	0x00, 0x01, 0x00, 0x00,
+
+	/* Question */
+	0x02, 0x6e, 0x78, 0x07, 0x65, 0x78, 0x61, 0x6d,
+	0x70, 0x6c, 0x65, 0x03, 0x63, 0x6f, 0x6d, 0x00,
+	0x00, 0x01, 0x00, 0x01,
+
+	/* Authority */
+	0xc0, 0x0f, 0x00, 0x06, 0x00, 0x01, 0x00, 0x00,
+	0x0e, 0x10, 0x00, 0x20,
+	/* MNAME ns.example.com */
+	0x02, 0x6e, 0x73, 0xc0, 0x0f,
+	/* RNAME host.example.com */
+	0x04, 0x68, 0x6f, 0x73, 0x74, 0xc0, 0x0f,
+	/* SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM */
+	0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10,
+	0x00, 0x00, 0x03, 0x84, 0x00, 0x09, 0x3a, 0x80,
+	0x00, 0x00, 0x00, 0x3c,
+};
+
+static struct {
+	enum dns_resolve_status status;
+	struct sockaddr addr;
+	int count;
+} result;
+
+static void resolve_cb(enum dns_resolve_status status,
+		       struct dns_addrinfo *info,
+		       void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	result.status = status;
+
+	if (status == DNS_EAI_INPROGRESS && info) {
+		memcpy(&result.addr, &info->ai_addr, sizeof(result.addr));
+		result.count++;
+	}
+}
+
+/* Feed in a response as if it was received for a query of name */
+static int feed_response(const char *name, enum dns_query_type type,
+			 uint8_t *buf, size_t len)
+{
+	struct dns_msg_t dns_msg = { 0 };
+	uint8_t qname[MAX_BUF_SIZE];
+	uint16_t qname_len;
+	uint16_t dns_id = 0;
+	int query_idx = -1;
+	uint16_t query_hash = 0;
+	int ret;
+
+	ret = dns_msg_pack_qname(&qname_len, qname, sizeof(qname) - 2, name);
+	zassert_equal(ret, 0, "Cannot pack %s", name);
+
+	/* Query hash is calculated over the labels and the query type */
+	UNALIGNED_PUT(htons(type), (uint16_t *)(qname + qname_len));
+
+	dns_msg.msg = buf;
+	dns_msg.msg_size = len;
+
+	dns_ctx.queries[0].cb = resolve_cb;
+	dns_ctx.queries[0].id = dns_unpack_header_id(buf);
+	dns_ctx.queries[0].query = name;
+	dns_ctx.queries[0].query_type = type;
+	dns_ctx.queries[0].query_hash = crc16_ansi(qname, qname_len + 2);
+	dns_ctx.state = DNS_RESOLVE_CONTEXT_ACTIVE;
+
+	return dns_validate_msg(&dns_ctx, &dns_msg, &dns_id, &query_idx,
+				NULL, &query_hash);
+}
+
+static int resolve(const char *name, enum dns_query_type type)
+{
+	memset(&result, 0, sizeof(result));
+
+	return dns_resolve_name(&dns_ctx, name, type, NULL, resolve_cb, NULL,
+				1000);
+}
+
+static void cache_cb(struct dns_resolve_cache_info *info, void *user_data)
+{
+	struct dns_resolve_cache_info *found = user_data;
+
+	if (strcmp(info->query, found->query) == 0) {
+		found->addr_count = info->addr_count;
+		found->remaining = info->remaining;
+	}
+}
+
+static bool cache_lookup(const char *name, struct dns_resolve_cache_info *info)
+{
+	memset(info, 0, sizeof(*info));
+	info->query = name;
+	info->remaining = -1;
+
+	dns_resolve_cache_foreach(cache_cb, info);
+
+	return info->remaining >= 0;
+}
+
+static void test_dns_cache_positive(void)
+{
+	struct dns_resolve_cache_stats before, after;
+	struct sockaddr addr;
+	int ret;
+
+	dns_resolve_cache_flush();
+	dns_resolve_cache_stats_get(&before);
+
+	ret = feed_response(DNAME1, DNS_QUERY_TYPE_A, resp_ipv4,
+			    sizeof(resp_ipv4));
+	zassert_equal(ret, DNS_EAI_ALLDONE, "DNS message failed (%d)", ret);
+
+	/* DNS names are case insensitive */
+	ret = resolve("WWW.ZephyrProject.org", DNS_QUERY_TYPE_A);
+	zassert_equal(ret, 0, "Cannot resolve from cache (%d)", ret);
+	zassert_equal(result.status, DNS_EAI_ALLDONE, "Not done (%d)",
+		      result.status);
+	zassert_equal(result.count, 1, "Invalid address count %d",
+		      result.count);
+	zassert_equal(result.addr.sa_family, AF_INET, "Invalid family");
+	zassert_mem_equal(&net_sin(&result.addr)->sin_addr, resp_ipv4_addr,
+			  sizeof(resp_ipv4_addr), "Invalid address");
+
+	/* Other query types are not resolved from this entry */
+	ret = dns_cache_find(DNAME1, DNS_QUERY_TYPE_AAAA, &addr, 1);
+	zassert_equal(ret, -ENOENT, "AAAA query found (%d)", ret);
+
+	dns_resolve_cache_stats_get(&after);
+	zassert_equal(after.hits, before.hits + 1, "Invalid hit count");
+	zassert_equal(after.misses, before.misses + 1, "Invalid miss count");
+}
+
+static void test_dns_cache_negative(void)
+{
+	struct dns_resolve_cache_stats before, after;
+	struct dns_resolve_cache_info info;
+	int ret;
+
+	dns_resolve_cache_flush();
+	dns_resolve_cache_stats_get(&before);
+
+	ret = feed_response(DNAME2, DNS_QUERY_TYPE_A, resp_nxdomain,
+			    sizeof(resp_nxdomain));
+	zassert_equal(ret, DNS_EAI_NODATA, "Name was found (%d)", ret);
+
+	zassert_true(cache_lookup(DNAME2, &info), "Name error not cached");
+	zassert_equal(info.addr_count, 0, "Addresses for name error");
+
+	/* SOA MINIMUM is 60 s, limited by Kconfig to 30 s */
+	zassert_true(info.remaining <= 30 * MSEC_PER_SEC,
+		     "Name error cached too long (%d ms)",
+		     (int)info.remaining);
+
+	ret = resolve(DNAME2, DNS_QUERY_TYPE_A);
+	zassert_equal(ret, 0, "Cannot resolve from cache (%d)", ret);
+	zassert_equal(result.status, DNS_EAI_NODATA, "Name found (%d)",
+		      result.status);
+	zassert_equal(result.count, 0, "Addresses for name error");
+
+	dns_resolve_cache_stats_get(&after);
+	zassert_equal(after.negative_hits, before.negative_hits + 1,
+		      "Invalid negative hit count");
+}
+
+static void test_dns_cache_ttl(void)
+{
+	uint8_t resp[sizeof(resp_ipv4)];
+	struct sockaddr addr;
+	int ret;
+
+	dns_resolve_cache_flush();
+
+	memcpy(resp, resp_ipv4, sizeof(resp));
+	UNALIGNED_PUT(htonl(1), (uint32_t *)(resp + RESP_IPV4_TTL_POS));
+
+	ret = feed_response(DNAME1, DNS_QUERY_TYPE_A, resp, sizeof(resp));
+	zassert_equal(ret, DNS_EAI_ALLDONE, "DNS message failed (%d)", ret);
+
+	ret = dns_cache_find(DNAME1, DNS_QUERY_TYPE_A, &addr, 1);
+	zassert_equal(ret, 1, "Address not cached (%d)", ret);
+
+	k_sleep(K_MSEC(1100));
+
+	ret = dns_cache_find(DNAME1, DNS_QUERY_TYPE_A, &addr, 1);
+	zassert_equal(ret, -ENOENT, "Address not expired (%d)", ret);
+
+	/* TTL 0 means the answer must not be cached */
+	UNALIGNED_PUT(htonl(0), (uint32_t *)(resp + RESP_IPV4_TTL_POS));
+
+	ret = feed_response(DNAME1, DNS_QUERY_TYPE_A, resp, sizeof(resp));
+	zassert_equal(ret, DNS_EAI_ALLDONE, "DNS message failed (%d)", ret);
+
+	ret = dns_cache_find(DNAME1, DNS_QUERY_TYPE_A, &addr, 1);
+	zassert_equal(ret, -ENOENT, "Address with TTL 0 cached (%d)", ret);
+}
+
+static void test_dns_cache_eviction(void)
+{
+	struct dns_resolve_cache_stats before, after;
+	struct dns_resolve_cache_info info;
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_addr = { { { 192, 0, 2, 1 } } },
+	};
+
+	dns_resolve_cache_flush();
+	dns_resolve_cache_stats_get(&before);
+
+	dns_cache_add("a.example.com", DNS_QUERY_TYPE_A,
+		      (struct sockaddr *)&addr, 100, true);
+	dns_cache_add("b.example.com", DNS_QUERY_TYPE_A,
+		      (struct sockaddr *)&addr, 10, true);
+
+	/* The cache holds two names, the one expiring first is replaced */
+	dns_cache_add("c.example.com", DNS_QUERY_TYPE_A,
+		      (struct sockaddr *)&addr, 100, true);
+
+	zassert_true(cache_lookup("a.example.com", &info), "a evicted");
+	zassert_false(cache_lookup("b.example.com", &info), "b not evicted");
+	zassert_true(cache_lookup("c.example.com", &info), "c not added");
+
+	dns_resolve_cache_stats_get(&after);
+	zassert_equal(after.evictions, before.evictions + 1,
+		      "Invalid eviction count");
+
+	dns_resolve_cache_flush();
+
+	zassert_equal(dns_resolve_cache_foreach(cache_cb, &info), 0,
+		      "Cache not flushed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache_tests,
+			 ztest_unit_test(test_dns_cache_positive),
+			 ztest_unit_test(test_dns_cache_negative),
+			 ztest_unit_test(test_dns_cache_ttl),
+			 ztest_unit_test(test_dns_cache_eviction));
+
+	ztest_run_test_suite(dns_cache_tests);
+}
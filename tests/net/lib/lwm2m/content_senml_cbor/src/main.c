@@ -0,0 +1,522 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+#define TEST_OBJ_ID		65535
+
+#define TEST_STRING_ID		0
+#define TEST_OPAQUE_ID		1
+#define TEST_S64_ID		2
+#define TEST_S32_ID		3
+#define TEST_BOOL_ID		4
+#define TEST_FLOAT32_ID		5
+#define TEST_FLOAT64_ID		6
+#define TEST_OBJLNK_ID		7
+#define TEST_MULTI_ID		8
+
+#define TEST_MAX_ID		9
+
+#define TEST_MULTI_COUNT	2
+#define TEST_DATA_LEN		32
+
+/* CBOR encoded base name "/65535/0/" and the first record prefix */
+#define BN_INST			0x21, 0x69, '/', '6', '5', '5', '3', '5', \
+				'/', '0', '/'
+#define BN_OBJ			0x21, 0x67, '/', '6', '5', '5', '3', '5', '/'
+
+static struct lwm2m_engine_obj test_obj;
+static struct lwm2m_engine_obj_field test_fields[] = {
+	OBJ_FIELD_DATA(TEST_STRING_ID, RW, STRING),
+	OBJ_FIELD_DATA(TEST_OPAQUE_ID, RW, OPAQUE),
+	OBJ_FIELD_DATA(TEST_S64_ID, RW, S64),
+	OBJ_FIELD_DATA(TEST_S32_ID, RW, S32),
+	OBJ_FIELD_DATA(TEST_BOOL_ID, RW, BOOL),
+	OBJ_FIELD_DATA(TEST_FLOAT32_ID, RW, FLOAT32),
+	OBJ_FIELD_DATA(TEST_FLOAT64_ID, RW, FLOAT64),
+	OBJ_FIELD_DATA(TEST_OBJLNK_ID, RW, OBJLNK),
+	OBJ_FIELD_DATA(TEST_MULTI_ID, RW, S32),
+};
+
+static struct lwm2m_engine_obj_inst test_inst;
+static struct lwm2m_engine_res test_res[TEST_MAX_ID];
+static struct lwm2m_engine_res_inst
+			test_res_inst[TEST_MAX_ID - 1 + TEST_MULTI_COUNT];
+
+static char test_string[TEST_DATA_LEN];
+static uint8_t test_opaque[TEST_DATA_LEN];
+static int64_t test_s64;
+static int32_t test_s32;
+static bool test_bool;
+static float32_value_t test_float32;
+static float64_value_t test_float64;
+static struct lwm2m_objlnk test_objlnk;
+static int32_t test_multi[TEST_MULTI_COUNT];
+
+static struct lwm2m_ctx test_ctx;
+static struct lwm2m_message test_msg;
+static uint8_t test_payload[MAX_PACKET_SIZE];
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	int i = 0, j = 0;
+
+	init_res_instance(test_res_inst, ARRAY_SIZE(test_res_inst));
+
+	INIT_OBJ_RES_DATA(TEST_STRING_ID, test_res, i, test_res_inst, j,
+			  test_string, sizeof(test_string));
+	INIT_OBJ_RES_DATA(TEST_OPAQUE_ID, test_res, i, test_res_inst, j,
+			  test_opaque, sizeof(test_opaque));
+	INIT_OBJ_RES_DATA(TEST_S64_ID, test_res, i, test_res_inst, j,
+			  &test_s64, sizeof(test_s64));
+	INIT_OBJ_RES_DATA(TEST_S32_ID, test_res, i, test_res_inst, j,
+			  &test_s32, sizeof(test_s32));
+	INIT_OBJ_RES_DATA(TEST_BOOL_ID, test_res, i, test_res_inst, j,
+			  &test_bool, sizeof(test_bool));
+	INIT_OBJ_RES_DATA(TEST_FLOAT32_ID, test_res, i, test_res_inst, j,
+			  &test_float32, sizeof(test_float32));
+	INIT_OBJ_RES_DATA(TEST_FLOAT64_ID, test_res, i, test_res_inst, j,
+			  &test_float64, sizeof(test_float64));
+	INIT_OBJ_RES_DATA(TEST_OBJLNK_ID, test_res, i, test_res_inst, j,
+			  &test_objlnk, sizeof(test_objlnk));
+	INIT_OBJ_RES_MULTI_DATA(TEST_MULTI_ID, test_res, i, test_res_inst, j,
+				TEST_MULTI_COUNT, true,
+				test_multi, sizeof(test_multi[0]));
+
+	test_inst.resources = test_res;
+	test_inst.resource_count = i;
+
+	return &test_inst;
+}
+
+static void test_obj_init(void)
+{
+	test_obj.obj_id = TEST_OBJ_ID;
+	test_obj.fields = test_fields;
+	test_obj.field_count = ARRAY_SIZE(test_fields);
+	test_obj.max_instance_count = 1U;
+	test_obj.create_cb = test_obj_create;
+	lwm2m_register_obj(&test_obj);
+
+	(void)lwm2m_engine_create_obj_inst("65535/0");
+}
+
+static void test_obj_set(void)
+{
+	static const uint8_t opaque[] = { 0x00, 0xff, 0x10, 0x7f, 0x80 };
+
+	strcpy(test_string, "Zephyr");
+	zassert_equal(lwm2m_engine_set_opaque("65535/0/1", (char *)opaque,
+					      sizeof(opaque)), 0,
+		      "Cannot set opaque value");
+	test_s64 = -5000000000LL;
+	test_s32 = 123456;
+	test_bool = true;
+	test_float32.val1 = -12;
+	test_float32.val2 = 250000;
+	test_float64.val1 = 0;
+	test_float64.val2 = -125000000;
+	test_objlnk.obj_id = 3303U;
+	test_objlnk.obj_inst = 1U;
+	test_multi[0] = -1;
+	test_multi[1] = 70000;
+}
+
+static void test_obj_clear(void)
+{
+	(void)memset(test_string, 0, sizeof(test_string));
+	(void)memset(test_opaque, 0, sizeof(test_opaque));
+	test_s64 = 0;
+	test_s32 = 0;
+	test_bool = false;
+	(void)memset(&test_float32, 0, sizeof(test_float32));
+	(void)memset(&test_float64, 0, sizeof(test_float64));
+	(void)memset(&test_objlnk, 0, sizeof(test_objlnk));
+	(void)memset(test_multi, 0, sizeof(test_multi));
+}
+
+/* Format a read of path into a response of at most max_len bytes */
+static int read_msg(uint8_t level, uint16_t res_id, uint16_t max_len)
+{
+	struct lwm2m_message *msg = &test_msg;
+	int ret;
+
+	(void)memset(msg, 0, sizeof(*msg));
+	msg->ctx = &test_ctx;
+	msg->path.obj_id = TEST_OBJ_ID;
+	msg->path.obj_inst_id = 0U;
+	msg->path.res_id = res_id;
+	msg->path.level = level;
+
+	ret = coap_packet_init(&msg->cpkt, msg->msg_data, max_len,
+			       COAP_VERSION_1, COAP_TYPE_ACK, 0, NULL,
+			       COAP_RESPONSE_CODE_CONTENT, 0);
+	zassert_equal(ret, 0, "Cannot create response");
+
+	msg->out.out_cpkt = &msg->cpkt;
+	msg->out.writer = &senml_cbor_writer;
+
+	return do_read_op_senml_cbor(msg, LWM2M_FORMAT_APP_SENML_CBOR);
+}
+
+/* Format a read of path, return the payload */
+static uint8_t *read_path(uint8_t level, uint16_t res_id, uint16_t *len)
+{
+	struct lwm2m_message *msg = &test_msg;
+	uint8_t *payload;
+	int ret;
+
+	ret = read_msg(level, res_id, sizeof(msg->msg_data));
+	zassert_equal(ret, 0, "Read failed (%d)", ret);
+
+	payload = coap_packet_get_payload(&msg->cpkt, len);
+	zassert_not_null(payload, "No payload");
+
+	return payload;
+}
+
+/* Parse a write payload */
+static int write_payload(const uint8_t *payload, uint16_t len)
+{
+	struct lwm2m_message *msg = &test_msg;
+
+	zassert_true(len <= sizeof(test_payload), "Payload too long");
+	memcpy(test_payload, payload, len);
+
+	(void)memset(msg, 0, sizeof(*msg));
+	msg->ctx = &test_ctx;
+	msg->cpkt.data = test_payload;
+	msg->cpkt.offset = len;
+	msg->cpkt.max_len = len;
+	msg->in.in_cpkt = &msg->cpkt;
+	msg->in.reader = &senml_cbor_reader;
+
+	return do_write_op_senml_cbor(msg);
+}
+
+/* Write a single encoded value to a resource of instance 0 */
+static int write_value(char res_id, const uint8_t *value, uint16_t len)
+{
+	uint8_t payload[32] = {
+		0x81, 0xa3, BN_INST, 0x00, 0x61, res_id, 0x02
+	};
+	uint16_t prefix_len = 17U;
+
+	memcpy(payload + prefix_len, value, len);
+
+	return write_payload(payload, prefix_len + len);
+}
+
+static void test_read_resource(void)
+{
+	static const uint8_t expected[] = {
+		0x81, 0xa3, BN_INST, 0x00, 0x61, '3', 0x02, 0x24
+	};
+	uint8_t *payload;
+	uint16_t len;
+
+	test_s32 = -5;
+
+	payload = read_path(3U, TEST_S32_ID, &len);
+	zassert_equal(len, sizeof(expected), "Wrong payload length");
+	zassert_mem_equal(payload, expected, sizeof(expected),
+			  "Wrong payload");
+}
+
+static void test_read_resource_instances(void)
+{
+	static const uint8_t expected[] = {
+		0x82,
+		0xa3, BN_INST, 0x00, 0x63, '8', '/', '0', 0x02, 0x20,
+		0xa2, 0x00, 0x63, '8', '/', '1', 0x02, 0x1a,
+		0x00, 0x01, 0x11, 0x70,
+	};
+	uint8_t *payload;
+	uint16_t len;
+
+	test_multi[0] = -1;
+	test_multi[1] = 70000;
+
+	payload = read_path(3U, TEST_MULTI_ID, &len);
+	zassert_equal(len, sizeof(expected), "Wrong payload length");
+	zassert_mem_equal(payload, expected, sizeof(expected),
+			  "Wrong payload");
+}
+
+static void test_read_object(void)
+{
+	static const uint8_t first[] = {
+		0xa3, BN_OBJ, 0x00, 0x63, '0', '/', '0', 0x03, 0x66,
+		'Z', 'e', 'p', 'h', 'y', 'r'
+	};
+	static const uint8_t second[] = {
+		0xa2, 0x00, 0x63, '0', '/', '1', 0x08, 0x45
+	};
+	uint8_t *payload;
+	uint16_t len;
+
+	test_obj_set();
+
+	/* On an object read the instance is part of the record names */
+	payload = read_path(1U, 0U, &len);
+	zassert_equal(payload[0], 0x80 | (TEST_MAX_ID + TEST_MULTI_COUNT - 1),
+		      "Wrong record count");
+	zassert_mem_equal(payload + 1, first, sizeof(first),
+			  "Wrong first record");
+	zassert_mem_equal(payload + 1 + sizeof(first), second, sizeof(second),
+			  "Wrong second record");
+}
+
+static void test_read_no_space(void)
+{
+	uint16_t total, len, max_len;
+	int ret;
+
+	test_obj_set();
+
+	(void)read_path(1U, 0U, &len);
+	total = test_msg.cpkt.offset;
+
+	/* Leave out anything from the last byte to the whole payload. Be it
+	 * records or the array header, the read is aborted instead of sending a
+	 * malformed payload.
+	 */
+	for (max_len = total - 1; max_len >= total - len; max_len--) {
+		ret = read_msg(1U, 0U, max_len);
+		zassert_equal(ret, -ENOMEM, "Read of %u bytes not aborted (%d)",
+			      max_len, ret);
+	}
+}
+
+static void test_round_trip(void)
+{
+	static const uint8_t opaque[] = { 0x00, 0xff, 0x10, 0x7f, 0x80 };
+	uint8_t *payload;
+	uint16_t len;
+	void *data;
+	uint16_t data_len;
+	uint8_t flags;
+
+	test_obj_set();
+	payload = read_path(2U, 0U, &len);
+
+	test_obj_clear();
+	zassert_equal(write_payload(payload, len), 0, "Write failed");
+
+	zassert_equal(strcmp(test_string, "Zephyr"), 0, "Wrong string");
+	zassert_equal(lwm2m_engine_get_res_data("65535/0/1", &data, &data_len,
+						&flags), 0,
+		      "Cannot get opaque value");
+	zassert_equal(data_len, sizeof(opaque), "Wrong opaque length");
+	zassert_mem_equal(test_opaque, opaque, sizeof(opaque),
+			  "Wrong opaque value");
+	zassert_equal(test_s64, -5000000000LL, "Wrong s64");
+	zassert_equal(test_s32, 123456, "Wrong s32");
+	zassert_true(test_bool, "Wrong bool");
+	zassert_equal(test_float32.val1, -12, "Wrong float32");
+	zassert_equal(test_float32.val2, 250000, "Wrong float32");
+	zassert_equal(test_float64.val1, 0, "Wrong float64");
+	zassert_equal(test_float64.val2, -125000000, "Wrong float64");
+	zassert_equal(test_objlnk.obj_id, 3303U, "Wrong objlnk");
+	zassert_equal(test_objlnk.obj_inst, 1U, "Wrong objlnk");
+	zassert_equal(test_multi[0], -1, "Wrong resource instance 0");
+	zassert_equal(test_multi[1], 70000, "Wrong resource instance 1");
+}
+
+static void test_write_base_name(void)
+{
+	static const uint8_t payload[] = {
+		0x84,
+		/* {bn: "/65535/0/", n: "3", v: 7} */
+		0xa3, BN_INST, 0x00, 0x61, '3', 0x02, 0x07,
+		/* {n: "2", v: -100}, relative to the last base name */
+		0xa2, 0x00, 0x61, '2', 0x02, 0x38, 0x63,
+		/* {bn: "/65535/", n: "0/4", vb: true} */
+		0xa3, BN_OBJ, 0x00, 0x63, '0', '/', '4', 0x04, 0xf5,
+		/* {n: "0/8/1", v: 5} */
+		0xa2, 0x00, 0x65, '0', '/', '8', '/', '1', 0x02, 0x05,
+	};
+
+	test_obj_clear();
+	zassert_equal(write_payload(payload, sizeof(payload)), 0,
+		      "Write failed");
+
+	zassert_equal(test_s32, 7, "Wrong s32");
+	zassert_equal(test_s64, -100, "Wrong s64");
+	zassert_true(test_bool, "Wrong bool");
+	zassert_equal(test_multi[0], 0, "Wrong resource instance 0");
+	zassert_equal(test_multi[1], 5, "Wrong resource instance 1");
+}
+
+static void test_write_base_time(void)
+{
+	static const uint8_t payload[] = {
+		/* indefinite length array */
+		0x9f,
+		/* {bn: "/65535/0/", bt: 1600000000, n: "3", v: 11} */
+		0xa4, BN_INST, 0x22, 0x1a, 0x5f, 0x5e, 0x10, 0x00,
+		0x00, 0x61, '3', 0x02, 0x0b,
+		/* {n: "2", t: -5, u: "Cel", v: 12}, indefinite length map */
+		0xbf, 0x00, 0x61, '2', 0x06, 0x24, 0x01, 0x63, 'C', 'e', 'l',
+		0x02, 0x0c, 0xff,
+		/* {bn: "/65535/0/"}, a record without a value */
+		0xa1, BN_INST,
+		0xff,
+	};
+
+	test_obj_clear();
+	zassert_equal(write_payload(payload, sizeof(payload)), 0,
+		      "Write failed");
+
+	/* Time is not used, the values are written as current ones */
+	zassert_equal(test_s32, 11, "Wrong s32");
+	zassert_equal(test_s64, 12, "Wrong s64");
+}
+
+static void test_write_float(void)
+{
+	static const struct {
+		char res_id;
+		uint8_t value[9];
+		uint8_t len;
+		int64_t val1;
+		int64_t val2;
+	} values[] = {
+		/* float32 -0.5 */
+		{ '5', { 0xfa, 0xbf, 0x00, 0x00, 0x00 }, 5, 0, -500000 },
+		/* float32 1e9 */
+		{ '5', { 0xfa, 0x4e, 0x6e, 0x6b, 0x28 }, 5, 1000000000, 0 },
+		/* float64 2.25 */
+		{ '5', { 0xfb, 0x40, 0x02 }, 9, 2, 250000 },
+		/* integer -3 */
+		{ '5', { 0x22 }, 1, -3, 0 },
+		/* float64 1e15 */
+		{ '6', { 0xfb, 0x43, 0x0c, 0x6b, 0xf5, 0x26, 0x34 }, 9,
+		  1000000000000000LL, 0 },
+		/* float64 1e18 */
+		{ '6', { 0xfb, 0x43, 0xab, 0xc1, 0x6d, 0x67, 0x4e, 0xc8 }, 9,
+		  1000000000000000000LL, 0 },
+		/* float64 -2^-10 */
+		{ '6', { 0xfb, 0xbf, 0x50 }, 9, 0, -976562 },
+		/* float32 -1.5 */
+		{ '6', { 0xfa, 0xbf, 0xc0, 0x00, 0x00 }, 5, -1, 500000000 },
+	};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(values); i++) {
+		test_obj_clear();
+		zassert_equal(write_value(values[i].res_id, values[i].value,
+					  values[i].len), 0,
+			      "Write %d failed", i);
+
+		if (values[i].res_id == '5') {
+			zassert_equal(test_float32.val1, values[i].val1,
+				      "Wrong whole part %d", i);
+			zassert_equal(test_float32.val2, values[i].val2,
+				      "Wrong fraction %d", i);
+		} else {
+			zassert_equal(test_float64.val1, values[i].val1,
+				      "Wrong whole part %d", i);
+			zassert_equal(test_float64.val2, values[i].val2,
+				      "Wrong fraction %d", i);
+		}
+	}
+}
+
+static void test_write_malformed(void)
+{
+	/* not an array */
+	static const uint8_t no_array[] = {
+		0xa2, 0x00, 0x61, '3', 0x02, 0x01
+	};
+	/* a record is not a map */
+	static const uint8_t no_map[] = {
+		0x81, 0x03
+	};
+	/* fewer records than announced */
+	static const uint8_t truncated[] = {
+		0x82, 0xa3, BN_INST, 0x00, 0x61, '3', 0x02, 0x01
+	};
+	/* name longer than the payload */
+	static const uint8_t short_name[] = {
+		0x81, 0xa2, 0x00, 0x6a, '3'
+	};
+	/* indefinite length name */
+	static const uint8_t chunked_name[] = {
+		0x81, 0xa2, 0x00, 0x7f, 0x61, '3', 0xff, 0x02, 0x01
+	};
+	/* name longer than a path */
+	static const uint8_t long_name[] = {
+		0x81, 0xa2, 0x00, 0x78, 0x18,
+		'/', '6', '5', '5', '3', '5', '/', '0', '/', '3', '/', '0',
+		'0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0',
+		0x02, 0x01
+	};
+	/* reserved additional information */
+	static const uint8_t reserved[] = {
+		0x81, 0xbc
+	};
+	/* too deeply nested value of an ignored label */
+	static const uint8_t nested[] = {
+		0x81, 0xa3, BN_INST, 0x00, 0x61, '3',
+		0x05, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x01
+	};
+	/* name of an object instance */
+	static const uint8_t no_resource[] = {
+		0x81, 0xa3, BN_OBJ, 0x00, 0x61, '0', 0x02, 0x01
+	};
+	/* unknown resource */
+	static const uint8_t unknown[] = {
+		0x81, 0xa3, BN_INST, 0x00, 0x62, '9', '9', 0x02, 0x01
+	};
+
+	zassert_equal(write_payload(no_array, sizeof(no_array)), -EINVAL,
+		      "Payload without an array accepted");
+	zassert_equal(write_payload(no_map, sizeof(no_map)), -EINVAL,
+		      "Record without a map accepted");
+	zassert_equal(write_payload(truncated, sizeof(truncated)), -EINVAL,
+		      "Truncated payload accepted");
+	zassert_equal(write_payload(short_name, sizeof(short_name)), -EINVAL,
+		      "Truncated name accepted");
+	zassert_equal(write_payload(chunked_name, sizeof(chunked_name)),
+		      -EINVAL, "Indefinite length name accepted");
+	zassert_equal(write_payload(long_name, sizeof(long_name)), -EINVAL,
+		      "Too long name accepted");
+	zassert_equal(write_payload(reserved, sizeof(reserved)), -EINVAL,
+		      "Reserved encoding accepted");
+	zassert_equal(write_payload(nested, sizeof(nested)), -EINVAL,
+		      "Too deep nesting accepted");
+	zassert_equal(write_payload(no_resource, sizeof(no_resource)),
+		      -EINVAL, "Object instance written");
+	zassert_true(write_payload(unknown, sizeof(unknown)) < 0,
+		     "Unknown resource written");
+}
+
+void test_main(void)
+{
+	test_obj_init();
+
+	ztest_test_suite(lwm2m_content_senml_cbor,
+			 ztest_unit_test(test_read_resource),
+			 ztest_unit_test(test_read_resource_instances),
+			 ztest_unit_test(test_read_object),
+			 ztest_unit_test(test_read_no_space),
+			 ztest_unit_test(test_round_trip),
+			 ztest_unit_test(test_write_base_name),
+			 ztest_unit_test(test_write_base_time),
+			 ztest_unit_test(test_write_float),
+			 ztest_unit_test(test_write_malformed)
+			 );
+
+	ztest_run_test_suite(lwm2m_content_senml_cbor);
+}
@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_senml_json.h"
+
+#define TEST_OBJ_ID		65535
+
+#define TEST_STRING_ID		0
+#define TEST_OPAQUE_ID		1
+#define TEST_S64_ID		2
+#define TEST_S32_ID		3
+#define TEST_BOOL_ID		4
+#define TEST_FLOAT32_ID		5
+#define TEST_FLOAT64_ID		6
+#define TEST_OBJLNK_ID		7
+#define TEST_MULTI_ID		8
+
+#define TEST_MAX_ID		9
+
+#define TEST_MULTI_COUNT	2
+#define TEST_DATA_LEN		32
+
+#define TEST_STRING		"Ze\"ph\\yr\n"
+
+static struct lwm2m_engine_obj test_obj;
+static struct lwm2m_engine_obj_field test_fields[] = {
+	OBJ_FIELD_DATA(TEST_STRING_ID, RW, STRING),
+	OBJ_FIELD_DATA(TEST_OPAQUE_ID, RW, OPAQUE),
+	OBJ_FIELD_DATA(TEST_S64_ID, RW, S64),
+	OBJ_FIELD_DATA(TEST_S32_ID, RW, S32),
+	OBJ_FIELD_DATA(TEST_BOOL_ID, RW, BOOL),
+	OBJ_FIELD_DATA(TEST_FLOAT32_ID, RW, FLOAT32),
+	OBJ_FIELD_DATA(TEST_FLOAT64_ID, RW, FLOAT64),
+	OBJ_FIELD_DATA(TEST_OBJLNK_ID, RW, OBJLNK),
+	OBJ_FIELD_DATA(TEST_MULTI_ID, RW, S32),
+};
+
+static struct lwm2m_engine_obj_inst test_inst;
+static struct lwm2m_engine_res test_res[TEST_MAX_ID];
+static struct lwm2m_engine_res_inst
+			test_res_inst[TEST_MAX_ID - 1 + TEST_MULTI_COUNT];
+
+static char test_string[TEST_DATA_LEN];
+static uint8_t test_opaque[TEST_DATA_LEN];
+static int64_t test_s64;
+static int32_t test_s32;
+static bool test_bool;
+static float32_value_t test_float32;
+static float64_value_t test_float64;
+static struct lwm2m_objlnk test_objlnk;
+static int32_t test_multi[TEST_MULTI_COUNT];
+
+static struct lwm2m_ctx test_ctx;
+static struct lwm2m_message test_msg;
+static char test_payload[MAX_PACKET_SIZE];
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	int i = 0, j = 0;
+
+	init_res_instance(test_res_inst, ARRAY_SIZE(test_res_inst));
+
+	INIT_OBJ_RES_DATA(TEST_STRING_ID, test_res, i, test_res_inst, j,
+			  test_string, sizeof(test_string));
+	INIT_OBJ_RES_DATA(TEST_OPAQUE_ID, test_res, i, test_res_inst, j,
+			  test_opaque, sizeof(test_opaque));
+	INIT_OBJ_RES_DATA(TEST_S64_ID, test_res, i, test_res_inst, j,
+			  &test_s64, sizeof(test_s64));
+	INIT_OBJ_RES_DATA(TEST_S32_ID, test_res, i, test_res_inst, j,
+			  &test_s32, sizeof(test_s32));
+	INIT_OBJ_RES_DATA(TEST_BOOL_ID, test_res, i, test_res_inst, j,
+			  &test_bool, sizeof(test_bool));
+	INIT_OBJ_RES_DATA(TEST_FLOAT32_ID, test_res, i, test_res_inst, j,
+			  &test_float32, sizeof(test_float32));
+	INIT_OBJ_RES_DATA(TEST_FLOAT64_ID, test_res, i, test_res_inst, j,
+			  &test_float64, sizeof(test_float64));
+	INIT_OBJ_RES_DATA(TEST_OBJLNK_ID, test_res, i, test_res_inst, j,
+			  &test_objlnk, sizeof(test_objlnk));
+	INIT_OBJ_RES_MULTI_DATA(TEST_MULTI_ID, test_res, i, test_res_inst, j,
+				TEST_MULTI_COUNT, true,
+				test_multi, sizeof(test_multi[0]));
+
+	test_inst.resources = test_res;
+	test_inst.resource_count = i;
+
+	return &test_inst;
+}
+
+static void test_obj_init(void)
+{
+	test_obj.obj_id = TEST_OBJ_ID;
+	test_obj.fields = test_fields;
+	test_obj.field_count = ARRAY_SIZE(test_fields);
+	test_obj.max_instance_count = 1U;
+	test_obj.create_cb = test_obj_create;
+	lwm2m_register_obj(&test_obj);
+
+	(void)lwm2m_engine_create_obj_inst("65535/0");
+}
+
+static void test_obj_set(void)
+{
+	static const uint8_t opaque[] = { 0x00, 0xff, 0x10, 0x7f, 0x80 };
+
+	strcpy(test_string, TEST_STRING);
+	zassert_equal(lwm2m_engine_set_opaque("65535/0/1", (char *)opaque,
+					      sizeof(opaque)), 0,
+		      "Cannot set opaque value");
+	test_s64 = -5000000000LL;
+	test_s32 = 123456;
+	test_bool = true;
+	test_float32.val1 = -12;
+	test_float32.val2 = 250000;
+	test_float64.val1 = 0;
+	test_float64.val2 = -125000000;
+	test_objlnk.obj_id = 3303U;
+	test_objlnk.obj_inst = 1U;
+	test_multi[0] = -1;
+	test_multi[1] = 70000;
+}
+
+static void test_obj_clear(void)
+{
+	(void)memset(test_string, 0, sizeof(test_string));
+	(void)memset(test_opaque, 0, sizeof(test_opaque));
+	test_s64 = 0;
+	test_s32 = 0;
+	test_bool = false;
+	(void)memset(&test_float32, 0, sizeof(test_float32));
+	(void)memset(&test_float64, 0, sizeof(test_float64));
+	(void)memset(&test_objlnk, 0, sizeof(test_objlnk));
+	(void)memset(test_multi, 0, sizeof(test_multi));
+}
+
+/* Format a read of path into a response of at most max_len bytes */
+static int read_msg(uint8_t level, uint16_t res_id, uint16_t max_len)
+{
+	struct lwm2m_message *msg = &test_msg;
+	int ret;
+
+	(void)memset(msg, 0, sizeof(*msg));
+	msg->ctx = &test_ctx;
+	msg->path.obj_id = TEST_OBJ_ID;
+	msg->path.obj_inst_id = 0U;
+	msg->path.res_id = res_id;
+	msg->path.level = level;
+
+	ret = coap_packet_init(&msg->cpkt, msg->msg_data, max_len,
+			       COAP_VERSION_1, COAP_TYPE_ACK, 0, NULL,
+			       COAP_RESPONSE_CODE_CONTENT, 0);
+	zassert_equal(ret, 0, "Cannot create response");
+
+	msg->out.out_cpkt = &msg->cpkt;
+	msg->out.writer = &senml_json_writer;
+
+	return do_read_op_senml_json(msg, LWM2M_FORMAT_APP_SENML_JSON);
+}
+
+/* Format a read of path, return the NUL terminated payload */
+static const char *read_path(uint8_t level, uint16_t res_id)
+{
+	struct lwm2m_message *msg = &test_msg;
+	uint8_t *payload;
+	uint16_t len;
+	int ret;
+
+	ret = read_msg(level, res_id, sizeof(msg->msg_data));
+	zassert_equal(ret, 0, "Read failed (%d)", ret);
+
+	payload = coap_packet_get_payload(&msg->cpkt, &len);
+	zassert_not_null(payload, "No payload");
+	zassert_true(len < sizeof(test_payload), "Payload too long");
+
+	memcpy(test_payload, payload, len);
+	test_payload[len] = '\0';
+
+	return test_payload;
+}
+
+/* Parse a write payload */
+static int write_payload(const char *payload)
+{
+	struct lwm2m_message *msg = &test_msg;
+	uint16_t len = strlen(payload);
+
+	zassert_true(len <= sizeof(test_payload), "Payload too long");
+	memmove(test_payload, payload, len);
+
+	(void)memset(msg, 0, sizeof(*msg));
+	msg->ctx = &test_ctx;
+	msg->cpkt.data = (uint8_t *)test_payload;
+	msg->cpkt.offset = len;
+	msg->cpkt.max_len = len;
+	msg->in.in_cpkt = &msg->cpkt;
+	msg->in.reader = &senml_json_reader;
+
+	return do_write_op_senml_json(msg);
+}
+
+/* Write a single value to a resource of instance 0 */
+static int write_value(char res_id, const char *value)
+{
+	char payload[64];
+
+	snprintk(payload, sizeof(payload),
+		 "[{\"bn\":\"/65535/0/\",\"n\":\"%c\",\"v\":%s}]",
+		 res_id, value);
+
+	return write_payload(payload);
+}
+
+static void test_read_resource(void)
+{
+	test_s32 = -5;
+
+	zassert_equal(strcmp(read_path(3U, TEST_S32_ID),
+			     "[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":-5}]"),
+		      0, "Wrong payload");
+}
+
+static void test_read_resource_instances(void)
+{
+	test_multi[0] = -1;
+	test_multi[1] = 70000;
+
+	zassert_equal(strcmp(read_path(3U, TEST_MULTI_ID),
+			     "[{\"bn\":\"/65535/0/\",\"n\":\"8/0\",\"v\":-1},"
+			     "{\"n\":\"8/1\",\"v\":70000}]"),
+		      0, "Wrong payload");
+}
+
+static void test_read_object(void)
+{
+	static const char expected[] =
+		"[{\"bn\":\"/65535/\",\"n\":\"0/0\","
+		"\"vs\":\"Ze\\\"ph\\\\yr\\u000a\"},"
+		"{\"n\":\"0/1\",\"vd\":\"AP8Qf4A\"},"
+		"{\"n\":\"0/2\",\"v\":-5000000000},"
+		"{\"n\":\"0/3\",\"v\":123456},"
+		"{\"n\":\"0/4\",\"vb\":true},"
+		"{\"n\":\"0/5\",\"v\":-12.25},"
+		"{\"n\":\"0/6\",\"v\":-0.125},"
+		"{\"n\":\"0/7\",\"vlo\":\"3303:1\"},"
+		"{\"n\":\"0/8/0\",\"v\":-1},"
+		"{\"n\":\"0/8/1\",\"v\":70000}]";
+
+	test_obj_set();
+
+	/* On an object read the instance is part of the record names */
+	zassert_equal(strcmp(read_path(1U, 0U), expected), 0,
+		      "Wrong payload");
+}
+
+static void test_read_no_space(void)
+{
+	uint16_t total, len, max_len;
+	int ret;
+
+	test_obj_set();
+
+	(void)read_path(1U, 0U);
+	total = test_msg.cpkt.offset;
+	len = strlen(test_payload);
+
+	/* Leave out anything from the last byte to the whole payload. Be it
+	 * records or the brackets, the read is aborted instead of sending a
+	 * malformed payload.
+	 */
+	for (max_len = total - 1; max_len >= total - len; max_len--) {
+		ret = read_msg(1U, 0U, max_len);
+		zassert_equal(ret, -ENOMEM, "Read of %u bytes not aborted (%d)",
+			      max_len, ret);
+	}
+}
+
+static void test_round_trip(void)
+{
+	static const uint8_t opaque[] = { 0x00, 0xff, 0x10, 0x7f, 0x80 };
+	const char *payload;
+	void *data;
+	uint16_t data_len;
+	uint8_t flags;
+
+	test_obj_set();
+	payload = read_path(2U, 0U);
+
+	test_obj_clear();
+	zassert_equal(write_payload(payload), 0, "Write failed");
+
+	zassert_equal(strcmp(test_string, TEST_STRING), 0, "Wrong string");
+	zassert_equal(lwm2m_engine_get_res_data("65535/0/1", &data, &data_len,
+						&flags), 0,
+		      "Cannot get opaque value");
+	zassert_equal(data_len, sizeof(opaque), "Wrong opaque length");
+	zassert_mem_equal(test_opaque, opaque, sizeof(opaque),
+			  "Wrong opaque value");
+	zassert_equal(test_s64, -5000000000LL, "Wrong s64");
+	zassert_equal(test_s32, 123456, "Wrong s32");
+	zassert_true(test_bool, "Wrong bool");
+	zassert_equal(test_float32.val1, -12, "Wrong float32");
+	zassert_equal(test_float32.val2, 250000, "Wrong float32");
+	zassert_equal(test_float64.val1, 0, "Wrong float64");
+	zassert_equal(test_float64.val2, -125000000, "Wrong float64");
+	zassert_equal(test_objlnk.obj_id, 3303U, "Wrong objlnk");
+	zassert_equal(test_objlnk.obj_inst, 1U, "Wrong objlnk");
+	zassert_equal(test_multi[0], -1, "Wrong resource instance 0");
+	zassert_equal(test_multi[1], 70000, "Wrong resource instance 1");
+}
+
+static void test_write_base_name(void)
+{
+	test_obj_clear();
+	zassert_equal(write_payload(
+			      "[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":7},"
+			      "{\"n\":\"2\",\"v\":-100},"
+			      "{\"bn\":\"/65535/\",\"n\":\"0/4\",\"vb\":true},"
+			      "{\"n\":\"0/8/1\",\"v\":5}]"), 0,
+		      "Write failed");
+
+	zassert_equal(test_s32, 7, "Wrong s32");
+	zassert_equal(test_s64, -100, "Wrong s64");
+	zassert_true(test_bool, "Wrong bool");
+	zassert_equal(test_multi[0], 0, "Wrong resource instance 0");
+	zassert_equal(test_multi[1], 5, "Wrong resource instance 1");
+}
+
+static void test_write_base_time(void)
+{
+	test_obj_clear();
+	zassert_equal(write_payload(
+			      "[ {\"bn\": \"/65535/0/\", \"bt\": 1.6e9,\n"
+			      "   \"n\": \"3\", \"v\": 11},\n"
+			      "  {\"n\": \"2\", \"t\": -5, \"u\": \"Cel\",\n"
+			      "   \"v\": 12},\n"
+			      "  {\"bn\": \"/65535/0/\"} ]"), 0,
+		      "Write failed");
+
+	/* Time is not used, the values are written as current ones */
+	zassert_equal(test_s32, 11, "Wrong s32");
+	zassert_equal(test_s64, 12, "Wrong s64");
+}
+
+static void test_write_float(void)
+{
+	static const struct {
+		char res_id;
+		const char *value;
+		int64_t val1;
+		int64_t val2;
+	} values[] = {
+		{ '5', "-0.5", 0, -500000 },
+		{ '5', "-0.000001", 0, -1 },
+		{ '5', "2.5E-1", 0, 250000 },
+		{ '5', "1e9", 1000000000, 0 },
+		{ '5', "-3", -3, 0 },
+		{ '6', "123.456789123", 123, 456789123 },
+		{ '6', "-0.0009765625", 0, -976562 },
+		{ '6', "1e15", 1000000000000000LL, 0 },
+		{ '6', "-1.5e3", -1500, 0 },
+		{ '6', "1.0E+18", 1000000000000000000LL, 0 },
+		{ '6', "12345.678e-3", 12, 345678000 },
+		{ '6', "1e-30", 0, 0 },
+		/* out of range values saturate */
+		{ '6', "1e30", INT64_MAX, 0 },
+	};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(values); i++) {
+		test_obj_clear();
+		zassert_equal(write_value(values[i].res_id, values[i].value),
+			      0, "Write %d failed", i);
+
+		if (values[i].res_id == '5') {
+			zassert_equal(test_float32.val1, values[i].val1,
+				      "Wrong whole part %d", i);
+			zassert_equal(test_float32.val2, values[i].val2,
+				      "Wrong fraction %d", i);
+		} else {
+			zassert_equal(test_float64.val1, values[i].val1,
+				      "Wrong whole part %d", i);
+			zassert_equal(test_float64.val2, values[i].val2,
+				      "Wrong fraction %d", i);
+		}
+	}
+}
+
+static void test_write_malformed(void)
+{
+	static const char * const payloads[] = {
+		/* not an array */
+		"{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":1}",
+		/* unterminated array */
+		"[",
+		"[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":1}",
+		/* a record is not an object */
+		"[\"3\"]",
+		/* trailing comma */
+		"[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":1},]",
+		/* missing comma */
+		"[{\"bn\":\"/65535/0/\",\"n\":\"3\" \"v\":1}]",
+		/* label or name is not a string */
+		"[{bn:\"/65535/0/\",\"n\":\"3\",\"v\":1}]",
+		"[{\"bn\":\"/65535/0/\",\"n\":3,\"v\":1}]",
+		/* unterminated string */
+		"[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"vs\":\"abc}]",
+		/* nested value */
+		"[{\"bn\":\"/65535/0/\",\"n\":\"3\",\"v\":{\"v\":1}}]",
+		/* name longer than a path */
+		"[{\"n\":\"/65535/0/3/000000000000\",\"v\":1}]",
+		/* name of an object instance */
+		"[{\"bn\":\"/65535/\",\"n\":\"0\",\"v\":1}]",
+	};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(payloads); i++) {
+		zassert_equal(write_payload(payloads[i]), -EINVAL,
+			      "Malformed payload %d accepted", i);
+	}
+
+	zassert_true(write_payload("[{\"bn\":\"/65535/0/\",\"n\":\"99\","
+				   "\"v\":1}]") < 0,
+		     "Unknown resource written");
+}
+
+void test_main(void)
+{
+	test_obj_init();
+
+	ztest_test_suite(lwm2m_content_senml_json,
+			 ztest_unit_test(test_read_resource),
+			 ztest_unit_test(test_read_resource_instances),
+			 ztest_unit_test(test_read_object),
+			 ztest_unit_test(test_read_no_space),
+			 ztest_unit_test(test_round_trip),
+			 ztest_unit_test(test_write_base_name),
+			 ztest_unit_test(test_write_base_time),
+			 ztest_unit_test(test_write_float),
+			 ztest_unit_test(test_write_malformed)
+			 );
+
+	ztest_run_test_suite(lwm2m_content_senml_json);
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <net/socket.h>
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_engine.h"
+
+#define SERVER_ADDR "192.0.2.1"
+#define SERVER_PORT 5683
+#define SERVER_URL "coap://" SERVER_ADDR ":5683"
+
+#define TEMP_VALUE "3303/0/5700"
+#define TEMP_VALUE_1 "3303/1/5700"
+
+#define RECV_TIMEOUT_MS 1000
+
+static struct lwm2m_ctx client_ctx;
+static int server_sock = -1;
+static struct sockaddr client_addr;
+
+static void set_temp(struct lwm2m_res_handle *handle, int32_t val1)
+{
+	float32_value_t value = { .val1 = val1, .val2 = 0 };
+
+	zassert_equal(lwm2m_engine_handle_set_float32(handle, &value), 0,
+		      "Cannot set value through handle");
+}
+
+static int32_t get_temp(struct lwm2m_res_handle *handle)
+{
+	float32_value_t value;
+
+	zassert_equal(lwm2m_engine_handle_get_float32(handle, &value), 0,
+		      "Cannot get value through handle");
+
+	return value.val1;
+}
+
+static void test_handle_stale_after_delete(void)
+{
+	struct lwm2m_res_handle h0, h1;
+	float32_value_t value;
+
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/0"), 0,
+		      "Cannot create instance 0");
+
+	zassert_equal(lwm2m_engine_resolve(TEMP_VALUE, &h0), 0,
+		      "Cannot resolve handle");
+	zassert_equal(lwm2m_engine_resolve(TEMP_VALUE_1, &h1), -ENOENT,
+		      "Handle to a missing instance resolved");
+
+	set_temp(&h0, 21);
+	zassert_equal(get_temp(&h0), 21, "Wrong value through handle");
+	zassert_equal(lwm2m_engine_get_float32(TEMP_VALUE, &value), 0,
+		      "Cannot get value through path");
+	zassert_equal(value.val1, 21, "Handle and path disagree");
+
+	/* Creating and deleting another instance keeps the handle valid */
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/1"), 0,
+		      "Cannot create instance 1");
+	zassert_equal(lwm2m_engine_resolve(TEMP_VALUE_1, &h1), 0,
+		      "Cannot resolve handle");
+	set_temp(&h1, 5);
+	zassert_equal(get_temp(&h0), 21, "Value changed by another instance");
+
+	zassert_equal(lwm2m_engine_delete_obj_inst("3303/1"), 0,
+		      "Cannot delete instance 1");
+	zassert_equal(get_temp(&h0), 21, "Handle lost after other delete");
+
+	/* A handle to a deleted instance fails instead of touching the freed
+	 * resources.
+	 */
+	zassert_equal(lwm2m_engine_handle_get_float32(&h1, &value), -ENOENT,
+		      "Stale handle used");
+	zassert_equal(lwm2m_engine_handle_set_float32(&h1, &value), -ENOENT,
+		      "Stale handle used");
+
+	/* Once the instance is created again the handle resolves to it */
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/1"), 0,
+		      "Cannot create instance 1");
+	set_temp(&h1, 7);
+	zassert_equal(lwm2m_engine_get_float32(TEMP_VALUE_1, &value), 0,
+		      "Cannot get value through path");
+	zassert_equal(value.val1, 7, "Handle not resolved to new instance");
+
+	zassert_equal(lwm2m_engine_delete_obj_inst("3303/1"), 0,
+		      "Cannot delete instance 1");
+}
+
+static void server_start(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	struct timeval timeo = {
+		.tv_sec = RECV_TIMEOUT_MS / MSEC_PER_SEC,
+	};
+	socklen_t addrlen = sizeof(client_addr);
+
+	zassert_equal(inet_pton(AF_INET, SERVER_ADDR, &addr.sin_addr), 1,
+		      "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(server_sock >= 0, "Cannot create server socket");
+	zassert_equal(bind(server_sock, (struct sockaddr *)&addr,
+			   sizeof(addr)), 0, "Cannot bind server socket");
+	zassert_equal(setsockopt(server_sock, SOL_SOCKET, SO_RCVTIMEO,
+				 &timeo, sizeof(timeo)), 0,
+		      "Cannot set receive timeout");
+
+	zassert_equal(lwm2m_engine_set_string("0/0/0", SERVER_URL), 0,
+		      "Cannot set server URL");
+
+	(void)memset(&client_ctx, 0, sizeof(client_ctx));
+	client_ctx.sec_obj_inst = 0;
+	client_ctx.srv_obj_inst = 0;
+
+	zassert_equal(lwm2m_engine_start(&client_ctx), 0,
+		      "Cannot start LwM2M engine");
+	zassert_equal(getsockname(client_ctx.sock_fd, &client_addr,
+				  &addrlen), 0, "Cannot get client address");
+}
+
+static void server_stop(void)
+{
+	lwm2m_engine_context_close(&client_ctx);
+	close(server_sock);
+	server_sock = -1;
+}
+
+/* Send an observe request for the temperature value to the client */
+static void server_observe(uint8_t observe)
+{
+	static const char * const path[] = { "3303", "0", "5700" };
+	uint8_t token[] = { 0x0b, 0x5e };
+	struct coap_option options[4];
+	struct coap_packet cpkt;
+	uint8_t buf[128];
+	uint16_t id = coap_next_id();
+	int i, ret;
+
+	ret = coap_packet_init(&cpkt, buf, sizeof(buf), COAP_VERSION_1,
+			       COAP_TYPE_CON, sizeof(token), token,
+			       COAP_METHOD_GET, id);
+	zassert_equal(ret, 0, "Cannot create request");
+
+	ret = coap_append_option_int(&cpkt, COAP_OPTION_OBSERVE, observe);
+	zassert_equal(ret, 0, "Cannot add observe option");
+
+	for (i = 0; i < ARRAY_SIZE(path); i++) {
+		ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH,
+						path[i], strlen(path[i]));
+		zassert_equal(ret, 0, "Cannot add path option");
+	}
+
+	ret = coap_append_option_int(&cpkt, COAP_OPTION_ACCEPT,
+				     LWM2M_FORMAT_PLAIN_TEXT);
+	zassert_equal(ret, 0, "Cannot add accept option");
+
+	ret = sendto(server_sock, cpkt.data, cpkt.offset, 0, &client_addr,
+		     sizeof(struct sockaddr_in));
+	zassert_equal(ret, cpkt.offset, "Cannot send request");
+
+	/* Wait for the response to the request, skip notifications */
+	do {
+		ret = recv(server_sock, buf, sizeof(buf), 0);
+		zassert_true(ret > 0, "No response from client");
+
+		ret = coap_packet_parse(&cpkt, buf, ret, options,
+					ARRAY_SIZE(options));
+		zassert_equal(ret, 0, "Invalid response");
+	} while (coap_header_get_id(&cpkt) != id);
+
+	zassert_equal(coap_header_get_code(&cpkt), COAP_RESPONSE_CODE_CONTENT,
+		      "Observe request failed");
+}
+
+static void test_handle_observer_invalidation(void)
+{
+	struct lwm2m_res_handle handle;
+
+	zassert_equal(lwm2m_engine_resolve(TEMP_VALUE, &handle), 0,
+		      "Cannot resolve handle");
+
+	server_start();
+
+	/* Nobody observes the value, which the handle remembers */
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 0,
+		      "Unobserved resource notified");
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 0,
+		      "Unobserved resource notified");
+
+	/* A new observer makes the handle look at the observers again */
+	server_observe(0);
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 1,
+		      "New observer not notified");
+	set_temp(&handle, 22);
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 1,
+		      "Observer not notified");
+
+	/* Cancelling the observation is seen as well */
+	server_observe(1);
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 0,
+		      "Cancelled observer notified");
+
+	/* Deleting the instance removes its observers and the handle is
+	 * resolved again once the instance is back.
+	 */
+	server_observe(0);
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 1,
+		      "New observer not notified");
+
+	zassert_equal(lwm2m_engine_delete_obj_inst("3303/0"), 0,
+		      "Cannot delete instance 0");
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 0,
+		      "Observer of deleted instance notified");
+	zassert_equal(lwm2m_engine_handle_set_float32(
+			      &handle, &(float32_value_t){ 0 }), -ENOENT,
+		      "Stale handle used");
+
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/0"), 0,
+		      "Cannot create instance 0");
+	set_temp(&handle, 23);
+	zassert_equal(get_temp(&handle), 23, "Wrong value through handle");
+
+	/* Closing the context drops its observers */
+	server_observe(0);
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 1,
+		      "New observer not notified");
+
+	server_stop();
+
+	zassert_equal(lwm2m_engine_handle_notify(&handle), 0,
+		      "Observer of closed context notified");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_engine,
+			 ztest_unit_test(test_handle_stale_after_delete),
+			 ztest_unit_test(test_handle_observer_invalidation)
+			 );
+
+	ztest_run_test_suite(lwm2m_engine);
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <sys/byteorder.h>
+
+#include "lwm2m_util.h"
+
+struct test_float32 {
+	uint32_t b32;
+	float32_value_t f32;
+	/* exactly representable in both formats */
+	bool exact;
+};
+
+struct test_float64 {
+	uint64_t b64;
+	float64_value_t f64;
+	bool exact;
+};
+
+static const struct test_float32 floats32[] = {
+	{ 0x00000000, { 0, 0 }, true },
+	{ 0x3f800000, { 1, 0 }, true },
+	{ 0x3fc00000, { 1, 500000 }, true },
+	/* negative values, the fraction takes the sign when there is no
+	 * whole part
+	 */
+	{ 0xbfc00000, { -1, 500000 }, true },
+	{ 0xc1440000, { -12, 250000 }, true },
+	{ 0xbf000000, { 0, -500000 }, true },
+	/* fractions < 1 */
+	{ 0x3e800000, { 0, 250000 }, true },
+	{ 0x3f400000, { 0, 750000 }, true },
+	{ 0xbe000000, { 0, -125000 }, true },
+	{ 0x3a800000, { 0, 976 }, false },
+	/* below the resolution of the fraction */
+	{ 0x33d6bf95, { 0, 0 }, false },
+	/* whole numbers beyond the 24 bit mantissa */
+	{ 0x4b800000, { 16777216, 0 }, true },
+	{ 0x4e6e6b28, { 1000000000, 0 }, true },
+	{ 0xce6e6b28, { -1000000000, 0 }, true },
+	/* out of range values saturate */
+	{ 0x7f61b1e6, { INT32_MAX, 0 }, false },
+	{ 0xff61b1e6, { INT32_MIN, 0 }, false },
+};
+
+static const struct test_float64 floats64[] = {
+	{ 0x0000000000000000, { 0, 0 }, true },
+	{ 0x3ff8000000000000, { 1, 500000000 }, true },
+	{ 0xbff8000000000000, { -1, 500000000 }, true },
+	{ 0xbfe0000000000000, { 0, -500000000 }, true },
+	{ 0x3fd0000000000000, { 0, 250000000 }, true },
+	{ 0xbfc0000000000000, { 0, -125000000 }, true },
+	{ 0x3f50000000000000, { 0, 976562 }, false },
+	{ 0x3d719799812dea11, { 0, 0 }, false },
+	/* whole numbers beyond the 32 bit range */
+	{ 0x41e65a0bc0000000, { 3000000000LL, 0 }, true },
+	{ 0xc1e65a0bc0100000, { -3000000000LL, 500000000 }, true },
+	/* whole numbers beyond the 53 bit mantissa */
+	{ 0x430c6bf526340000, { 1000000000000000LL, 0 }, true },
+	{ 0x4340000000000000, { 9007199254740992LL, 0 }, true },
+	{ 0x43abc16d674ec800, { 1000000000000000000LL, 0 }, true },
+	{ 0xc3abc16d674ec800, { -1000000000000000000LL, 0 }, true },
+	/* out of range values saturate */
+	{ 0x7e37e43c8800759c, { INT64_MAX, 0 }, false },
+	{ 0xfe37e43c8800759c, { INT64_MIN, 0 }, false },
+};
+
+static void test_b32_to_f32(void)
+{
+	float32_value_t f32;
+	uint8_t b32[4];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(floats32); i++) {
+		sys_put_be32(floats32[i].b32, b32);
+
+		zassert_equal(lwm2m_b32_to_f32(b32, sizeof(b32), &f32), 0,
+			      "Conversion %d failed", i);
+		zassert_equal(f32.val1, floats32[i].f32.val1,
+			      "Wrong whole part %d: %d", i, f32.val1);
+		zassert_equal(f32.val2, floats32[i].f32.val2,
+			      "Wrong fraction %d: %d", i, f32.val2);
+	}
+
+	zassert_equal(lwm2m_b32_to_f32(b32, 8, &f32), -EINVAL,
+		      "Wrong length accepted");
+}
+
+static void test_f32_to_b32(void)
+{
+	float32_value_t f32;
+	uint8_t b32[4];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(floats32); i++) {
+		if (!floats32[i].exact) {
+			continue;
+		}
+
+		f32 = floats32[i].f32;
+
+		zassert_equal(lwm2m_f32_to_b32(&f32, b32, sizeof(b32)), 0,
+			      "Conversion %d failed", i);
+		zassert_equal(sys_get_be32(b32), floats32[i].b32,
+			      "Wrong binary32 %d: %08x", i,
+			      sys_get_be32(b32));
+	}
+
+	zassert_equal(lwm2m_f32_to_b32(&f32, b32, 8), -EINVAL,
+		      "Wrong length accepted");
+}
+
+static void test_b64_to_f64(void)
+{
+	float64_value_t f64;
+	uint8_t b64[8];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(floats64); i++) {
+		sys_put_be64(floats64[i].b64, b64);
+
+		zassert_equal(lwm2m_b64_to_f64(b64, sizeof(b64), &f64), 0,
+			      "Conversion %d failed", i);
+		zassert_equal(f64.val1, floats64[i].f64.val1,
+			      "Wrong whole part %d", i);
+		zassert_equal(f64.val2, floats64[i].f64.val2,
+			      "Wrong fraction %d", i);
+	}
+
+	zassert_equal(lwm2m_b64_to_f64(b64, 4, &f64), -EINVAL,
+		      "Wrong length accepted");
+}
+
+static void test_f64_to_b64(void)
+{
+	float64_value_t f64;
+	uint8_t b64[8];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(floats64); i++) {
+		if (!floats64[i].exact) {
+			continue;
+		}
+
+		f64 = floats64[i].f64;
+
+		zassert_equal(lwm2m_f64_to_b64(&f64, b64, sizeof(b64)), 0,
+			      "Conversion %d failed", i);
+		zassert_equal(sys_get_be64(b64), floats64[i].b64,
+			      "Wrong binary64 %d", i);
+	}
+
+	zassert_equal(lwm2m_f64_to_b64(&f64, b64, 4), -EINVAL,
+		      "Wrong length accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_util,
+			 ztest_unit_test(test_b32_to_f32),
+			 ztest_unit_test(test_f32_to_b32),
+			 ztest_unit_test(test_b64_to_f64),
+			 ztest_unit_test(test_f64_to_b64)
+			 );
+
+	ztest_run_test_suite(lwm2m_util);
+}
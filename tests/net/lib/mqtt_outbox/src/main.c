@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Tests of the outbound queue. The client is connected to one end of a
+ * socket pair, the test plays the broker on the other end.
+ */
+
+#include <ztest.h>
+#include <fcntl.h>
+#include <net/socket.h>
+#include <sys/byteorder.h>
+#include <mqtt_internal.h>
+
+#define TOPIC "sensors"
+#define PAYLOAD_LEN 16
+#define PACKETS_MAX 8
+
+/* Space taken by a QoS 1 or QoS 2 message in the outbox buffer */
+#define MSG_LEN (MQTT_FIXED_HEADER_MAX_SIZE + sizeof(uint16_t) + \
+		 sizeof(TOPIC) - 1 + sizeof(uint16_t) + PAYLOAD_LEN)
+
+#define PUBLISH_DUP 0x08
+
+#define INFLIGHT_MAX CONFIG_MQTT_OUTBOX_INFLIGHT_MAX
+
+BUILD_ASSERT(INFLIGHT_MAX == 2 && CONFIG_MQTT_OUTBOX_MSG_MAX == 4,
+	     "Tests expect the queue sizes of prj.conf");
+
+/* Packet received by the broker */
+struct packet {
+	uint8_t type_and_flags;
+	uint16_t message_id;
+	uint8_t payload[PAYLOAD_LEN];
+};
+
+static struct mqtt_client client;
+static uint8_t rx_buf[64];
+static uint8_t tx_buf[64];
+static uint8_t outbox_buf[CONFIG_MQTT_OUTBOX_MSG_MAX * MSG_LEN];
+static int sock[2] = { -1, -1 };
+
+static struct packet packets[PACKETS_MAX];
+static uint8_t broker_buf[256];
+static int pubrec_evts;
+
+static void evt_handler(struct mqtt_client *const c,
+			const struct mqtt_evt *evt)
+{
+	ARG_UNUSED(c);
+
+	if (evt->type == MQTT_EVT_PUBREC) {
+		pubrec_evts++;
+	}
+}
+
+static void outbox_setup(void)
+{
+	int ret;
+
+	mqtt_client_init(&client);
+	pubrec_evts = 0;
+
+	ret = zsock_socketpair(AF_UNIX, SOCK_STREAM, 0, sock);
+	zassert_equal(ret, 0, "Cannot create socket pair (%d)", errno);
+
+	/* The broker only reads what the client wrote */
+	ret = zsock_fcntl(sock[1], F_SETFL, O_NONBLOCK);
+	zassert_equal(ret, 0, "Cannot set broker socket non-blocking");
+
+	client.evt_cb = evt_handler;
+	client.rx_buf = rx_buf;
+	client.rx_buf_size = sizeof(rx_buf);
+	client.tx_buf = tx_buf;
+	client.tx_buf_size = sizeof(tx_buf);
+	client.outbox_buf = outbox_buf;
+	client.outbox_buf_size = sizeof(outbox_buf);
+	client.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client.transport.tcp.sock = sock[0];
+
+	MQTT_SET_STATE(&client, MQTT_STATE_TCP_CONNECTED |
+		       MQTT_STATE_CONNECTED);
+}
+
+static void outbox_teardown(void)
+{
+	(void)zsock_close(sock[0]);
+	(void)zsock_close(sock[1]);
+}
+
+/* Read and split what the client sent since the last call */
+static int broker_recv(void)
+{
+	size_t len = 0, pos = 0, hdr_len, topic_len;
+	struct packet *pkt;
+	int count = 0, ret;
+
+	while ((ret = zsock_recv(sock[1], &broker_buf[len],
+				 sizeof(broker_buf) - len, 0)) > 0) {
+		len += ret;
+	}
+
+	while (pos < len) {
+		zassert_true(count < PACKETS_MAX, "Too many packets");
+		zassert_true(broker_buf[pos + 1] < 0x80, "Packet too long");
+
+		pkt = &packets[count++];
+		hdr_len = 2;
+		pkt->type_and_flags = broker_buf[pos];
+		pkt->message_id = 0U;
+
+		if ((pkt->type_and_flags & 0xF0) == MQTT_PKT_TYPE_PUBLISH) {
+			topic_len = sys_get_be16(&broker_buf[pos + hdr_len]);
+			hdr_len += sizeof(uint16_t) + topic_len;
+
+			if (pkt->type_and_flags & MQTT_HEADER_QOS_MASK) {
+				pkt->message_id = sys_get_be16(
+						&broker_buf[pos + hdr_len]);
+				hdr_len += sizeof(uint16_t);
+			}
+
+			memcpy(pkt->payload, &broker_buf[pos + hdr_len],
+			       PAYLOAD_LEN);
+		} else if ((pkt->type_and_flags & 0xF0) ==
+			   MQTT_PKT_TYPE_PUBREL) {
+			pkt->message_id = sys_get_be16(
+						&broker_buf[pos + hdr_len]);
+		}
+
+		pos += 2 + broker_buf[pos + 1];
+	}
+
+	zassert_equal(pos, len, "Truncated packet");
+
+	return count;
+}
+
+/* Send a packet with a message id, or CONNACK, to the client */
+static void broker_send(uint8_t type, uint16_t message_id)
+{
+	uint8_t buf[4] = { type, 2 };
+	int ret;
+
+	sys_put_be16(message_id, &buf[2]);
+
+	ret = zsock_send(sock[1], buf, sizeof(buf), 0);
+	zassert_equal(ret, sizeof(buf), "Cannot send to client");
+
+	zassert_equal(mqtt_input(&client), 0, "Input failed");
+}
+
+static void set_param(struct mqtt_publish_param *param, uint8_t qos,
+		      uint16_t message_id, uint8_t fill)
+{
+	static uint8_t payload[PAYLOAD_LEN];
+
+	memset(payload, fill, sizeof(payload));
+	memset(param, 0, sizeof(*param));
+
+	param->message.topic.qos = qos;
+	param->message.topic.topic.utf8 = (uint8_t *)TOPIC;
+	param->message.topic.topic.size = sizeof(TOPIC) - 1;
+	param->message.payload.data = payload;
+	param->message.payload.len = sizeof(payload);
+	param->message_id = message_id;
+}
+
+static int publish(uint8_t qos, uint16_t message_id, uint8_t fill)
+{
+	struct mqtt_publish_param param;
+
+	set_param(&param, qos, message_id, fill);
+
+	return mqtt_outbox_publish(&client, &param);
+}
+
+static void check_publish(const struct packet *pkt, uint16_t message_id,
+			  uint8_t fill, bool dup)
+{
+	int i;
+
+	zassert_equal(pkt->type_and_flags & 0xF0, MQTT_PKT_TYPE_PUBLISH,
+		      "Not a PUBLISH");
+	zassert_equal(pkt->message_id, message_id, "Wrong message id %u",
+		      pkt->message_id);
+	zassert_equal(!!(pkt->type_and_flags & PUBLISH_DUP), dup,
+		      "Wrong DUP flag");
+
+	for (i = 0; i < PAYLOAD_LEN; i++) {
+		zassert_equal(pkt->payload[i], fill, "Corrupted payload");
+	}
+}
+
+static void test_outbox_full(void)
+{
+	int ids[4], i;
+
+	/* Room for three messages and a half */
+	client.outbox_buf_size = 3 * MSG_LEN + MSG_LEN / 2;
+
+	for (i = 0; i < 3; i++) {
+		ids[i] = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'a' + i);
+		zassert_true(ids[i] > 0, "Cannot queue message %d", i);
+	}
+
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'x'), -ENOBUFS,
+		      "Message queued in a full buffer");
+	zassert_equal(broker_recv(), 2, "Window not respected");
+
+	/* Delivering the oldest message frees the start of the buffer, the
+	 * next message wraps around.
+	 */
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[0]);
+	zassert_equal(broker_recv(), 1, "Window not moved");
+	check_publish(&packets[0], ids[2], 'c', false);
+
+	ids[3] = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'd');
+	zassert_true(ids[3] > 0, "Cannot queue message after wrap-around");
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'x'), -ENOBUFS,
+		      "Message queued over the oldest one");
+
+	/* The wrapped message is sent intact */
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[1]);
+	zassert_equal(broker_recv(), 1, "Wrapped message not sent");
+	check_publish(&packets[0], ids[3], 'd', false);
+
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[2]);
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[3]);
+	zassert_equal(mqtt_outbox_pending(&client), 0,
+		      "Messages left in the queue");
+
+	/* The entry table can be full before the buffer */
+	client.outbox_buf_size = sizeof(outbox_buf);
+	MQTT_SET_STATE_EXCLUSIVE(&client, MQTT_STATE_TCP_CONNECTED);
+
+	for (i = 0; i < CONFIG_MQTT_OUTBOX_MSG_MAX; i++) {
+		zassert_equal(publish(MQTT_QOS_0_AT_MOST_ONCE, 0, 'q'), 0,
+			      "Cannot queue message %d", i);
+	}
+
+	zassert_equal(publish(MQTT_QOS_0_AT_MOST_ONCE, 0, 'q'), -ENOBUFS,
+		      "Message queued in a full table");
+	zassert_equal(broker_recv(), 0, "Message sent while disconnected");
+}
+
+static void test_outbox_inflight_window(void)
+{
+	int ids[INFLIGHT_MAX + 2], i;
+
+	for (i = 0; i < ARRAY_SIZE(ids); i++) {
+		ids[i] = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'a' + i);
+		zassert_true(ids[i] > 0, "Cannot queue message %d", i);
+	}
+
+	/* Only the window is sent, in order */
+	zassert_equal(broker_recv(), INFLIGHT_MAX,
+		      "Window not respected");
+
+	for (i = 0; i < INFLIGHT_MAX; i++) {
+		check_publish(&packets[i], ids[i], 'a' + i, false);
+	}
+
+	zassert_equal(mqtt_outbox_pending(&client), ARRAY_SIZE(ids),
+		      "Wrong number of pending messages");
+
+	/* Each acknowledgment lets one more message go */
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[0]);
+	zassert_equal(broker_recv(), 1, "Window not moved");
+	check_publish(&packets[0], ids[INFLIGHT_MAX], 'a' + INFLIGHT_MAX,
+		      false);
+
+	/* An unknown or repeated acknowledgment does not */
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[0]);
+	zassert_equal(broker_recv(), 0, "Window moved by stale PUBACK");
+
+	broker_send(MQTT_PKT_TYPE_PUBACK, ids[1]);
+	zassert_equal(broker_recv(), 1, "Window not moved");
+	check_publish(&packets[0], ids[INFLIGHT_MAX + 1],
+		      'a' + INFLIGHT_MAX + 1, false);
+
+	for (i = 2; i < ARRAY_SIZE(ids); i++) {
+		broker_send(MQTT_PKT_TYPE_PUBACK, ids[i]);
+	}
+
+	zassert_equal(mqtt_outbox_pending(&client), 0,
+		      "Messages left in the queue");
+	zassert_equal(broker_recv(), 0, "Unexpected packet");
+}
+
+static void test_outbox_qos2(void)
+{
+	int id;
+
+	id = publish(MQTT_QOS_2_EXACTLY_ONCE, 0, 'a');
+	zassert_true(id > 0, "Cannot queue message");
+
+	zassert_equal(broker_recv(), 1, "Message not sent");
+	check_publish(&packets[0], id, 'a', false);
+	zassert_equal(packets[0].type_and_flags & MQTT_HEADER_QOS_MASK,
+		      MQTT_QOS_2_EXACTLY_ONCE << 1, "Wrong QoS");
+
+	/* PUBCOMP before PUBREC is ignored */
+	broker_send(MQTT_PKT_TYPE_PUBCOMP, id);
+	zassert_equal(mqtt_outbox_pending(&client), 1,
+		      "Message delivered without PUBREC");
+	zassert_equal(broker_recv(), 0, "Unexpected packet");
+
+	/* PUBREC is answered with PUBREL */
+	broker_send(MQTT_PKT_TYPE_PUBREC, id);
+	zassert_equal(broker_recv(), 1, "PUBREL not sent");
+	zassert_equal(packets[0].type_and_flags, MQTT_PKT_TYPE_PUBREL | 0x02,
+		      "Not a PUBREL");
+	zassert_equal(packets[0].message_id, id, "Wrong PUBREL message id");
+	zassert_equal(mqtt_outbox_pending(&client), 1,
+		      "Message delivered without PUBCOMP");
+
+	/* A repeated PUBREC is ignored */
+	broker_send(MQTT_PKT_TYPE_PUBREC, id);
+	zassert_equal(broker_recv(), 0, "PUBREL sent twice");
+
+	/* The application is not asked to release the queued message, but
+	 * still is for the other ones.
+	 */
+	zassert_equal(pubrec_evts, 0, "PUBREC of a queued message notified");
+
+	broker_send(MQTT_PKT_TYPE_PUBREC, id + 1);
+	zassert_equal(pubrec_evts, 1, "PUBREC not notified");
+	zassert_equal(broker_recv(), 0, "PUBREL sent for unknown message");
+
+	broker_send(MQTT_PKT_TYPE_PUBCOMP, id);
+	zassert_equal(mqtt_outbox_pending(&client), 0,
+		      "Message not delivered");
+	zassert_equal(broker_recv(), 0, "Unexpected packet");
+}
+
+static void test_outbox_reconnect(void)
+{
+	int id1, id2, id3;
+
+	id1 = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'a');
+	id2 = publish(MQTT_QOS_2_EXACTLY_ONCE, 0, 'b');
+	zassert_true(id1 > 0 && id2 > 0, "Cannot queue messages");
+
+	zassert_equal(broker_recv(), 2, "Messages not sent");
+	check_publish(&packets[0], id1, 'a', false);
+	check_publish(&packets[1], id2, 'b', false);
+
+	broker_send(MQTT_PKT_TYPE_PUBREC, id2);
+	zassert_equal(broker_recv(), 1, "PUBREL not sent");
+
+	/* Connection lost, a message is queued while disconnected */
+	MQTT_SET_STATE_EXCLUSIVE(&client, MQTT_STATE_TCP_CONNECTED);
+
+	id3 = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'c');
+	zassert_true(id3 > 0, "Cannot queue message while disconnected");
+	zassert_equal(broker_recv(), 0, "Message sent while disconnected");
+
+	/* After CONNACK the unacknowledged PUBLISH is sent again with DUP,
+	 * the PUBREL is sent again, and the new message follows when the
+	 * window allows it.
+	 */
+	broker_send(MQTT_PKT_TYPE_CONNACK, 0);
+	zassert_equal(broker_recv(), 2, "Wrong number of packets resent");
+	check_publish(&packets[0], id1, 'a', true);
+	zassert_equal(packets[1].type_and_flags, MQTT_PKT_TYPE_PUBREL | 0x02,
+		      "PUBREL not resent");
+	zassert_equal(packets[1].message_id, id2, "Wrong PUBREL message id");
+
+	broker_send(MQTT_PKT_TYPE_PUBACK, id1);
+	broker_send(MQTT_PKT_TYPE_PUBCOMP, id2);
+
+	zassert_equal(broker_recv(), 1, "New message not sent");
+	check_publish(&packets[0], id3, 'c', false);
+
+	broker_send(MQTT_PKT_TYPE_PUBACK, id3);
+	zassert_equal(mqtt_outbox_pending(&client), 0,
+		      "Messages left in the queue");
+}
+
+static void test_outbox_message_id(void)
+{
+	struct mqtt_publish_param param;
+	int id;
+
+	/* Ids the application picked are not assigned again */
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 1, 'a'), 1,
+		      "Application message id not used");
+	id = publish(MQTT_QOS_1_AT_LEAST_ONCE, 0, 'b');
+	zassert_equal(id, 2, "Message id in use assigned");
+
+	/* Ids in use are rejected, by both publish paths */
+	zassert_equal(publish(MQTT_QOS_2_EXACTLY_ONCE, id, 'c'), -EBUSY,
+		      "Message id in use accepted");
+
+	set_param(&param, MQTT_QOS_1_AT_LEAST_ONCE, 1, 'c');
+	zassert_equal(mqtt_publish(&client, &param), -EBUSY,
+		      "Message id in use accepted by mqtt_publish()");
+
+	set_param(&param, MQTT_QOS_0_AT_MOST_ONCE, 1, 'c');
+	zassert_equal(mqtt_publish(&client, &param), 0,
+		      "QoS 0 message rejected");
+
+	set_param(&param, MQTT_QOS_1_AT_LEAST_ONCE, 3, 'c');
+	zassert_equal(mqtt_publish(&client, &param), 0,
+		      "Free message id rejected");
+
+	/* Once delivered, the id can be used again */
+	broker_send(MQTT_PKT_TYPE_PUBACK, 1);
+	zassert_equal(publish(MQTT_QOS_1_AT_LEAST_ONCE, 1, 'd'), 1,
+		      "Message id of delivered message rejected");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_outbox,
+		ztest_unit_test_setup_teardown(test_outbox_full,
+					       outbox_setup, outbox_teardown),
+		ztest_unit_test_setup_teardown(test_outbox_inflight_window,
+					       outbox_setup, outbox_teardown),
+		ztest_unit_test_setup_teardown(test_outbox_qos2,
+					       outbox_setup, outbox_teardown),
+		ztest_unit_test_setup_teardown(test_outbox_reconnect,
+					       outbox_setup, outbox_teardown),
+		ztest_unit_test_setup_teardown(test_outbox_message_id,
+					       outbox_setup, outbox_teardown));
+	ztest_run_test_suite(mqtt_outbox);
+}
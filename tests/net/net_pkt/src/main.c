@@ -16,6 +16,8 @@
 
 #include <ztest.h>
 
+#include "net_private.h"
+
 static uint8_t mac_addr[sizeof(struct net_eth_addr)];
 static struct net_if *eth_if;
 static uint8_t small_buffer[512];
@@ -1058,6 +1060,256 @@ void test_net_pkt_remove_tail(void)
 	net_pkt_unref(pkt);
 }
 
+#define CHKSUM_PAYLOAD_LEN 301
+
+static struct net_pkt *chksum_pkt_create(bool on_copy)
+{
+	struct net_ipv4_hdr ipv4_hdr = {
+		.vhl = 0x45,
+		.ttl = 64,
+		.proto = IPPROTO_UDP,
+		.src = { { { 192, 0, 2, 1 } } },
+		.dst = { { { 192, 0, 2, 2 } } },
+	};
+	struct net_udp_hdr udp_hdr = {
+		.src_port = htons(4242),
+		.dst_port = htons(4243),
+		.len = htons(sizeof(udp_hdr) + CHKSUM_PAYLOAD_LEN),
+	};
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(eth_if, sizeof(udp_hdr) +
+					CHKSUM_PAYLOAD_LEN, AF_INET,
+					IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Pkt not allocated");
+
+	net_pkt_set_ip_hdr_len(pkt, sizeof(ipv4_hdr));
+
+	ret = net_pkt_write(pkt, &ipv4_hdr, sizeof(ipv4_hdr));
+	zassert_equal(ret, 0, "Cannot write IPv4 header");
+
+	ret = net_pkt_write(pkt, &udp_hdr, sizeof(udp_hdr));
+	zassert_equal(ret, 0, "Cannot write UDP header");
+
+	/* Write the payload in two parts so that the second one starts at
+	 * an odd offset.
+	 */
+	if (on_copy) {
+		ret = net_pkt_write_chksum(pkt, small_buffer, 11);
+		ret |= net_pkt_write_chksum(pkt, small_buffer + 11,
+					    CHKSUM_PAYLOAD_LEN - 11);
+	} else {
+		ret = net_pkt_write(pkt, small_buffer, CHKSUM_PAYLOAD_LEN);
+	}
+
+	zassert_equal(ret, 0, "Cannot write payload");
+
+	return pkt;
+}
+
+typedef void (*chksum_pkt_modify_t)(struct net_pkt *pkt);
+
+static void chksum_pkt_overwrite(struct net_pkt *pkt)
+{
+	uint8_t data[3] = { 0xde, 0xad, 0xbe };
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+		     sizeof(struct net_udp_hdr) + 133);
+	net_pkt_write(pkt, data, sizeof(data));
+	net_pkt_set_overwrite(pkt, false);
+}
+
+static void chksum_pkt_memset(struct net_pkt *pkt)
+{
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+		     sizeof(struct net_udp_hdr) + 7);
+	net_pkt_memset(pkt, 0x5a, 200);
+	net_pkt_set_overwrite(pkt, false);
+}
+
+static void chksum_pkt_append(struct net_pkt *pkt)
+{
+	/* The cursor is still at the end of the payload */
+	net_pkt_write_u8(pkt, 0x42);
+}
+
+static void chksum_pkt_remove_tail(struct net_pkt *pkt)
+{
+	net_pkt_remove_tail(pkt, 5);
+}
+
+static void chksum_pkt_write_header(struct net_pkt *pkt)
+{
+	uint16_t port = htons(1234);
+
+	/* Writing the headers does not touch the payload */
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt));
+	net_pkt_write(pkt, &port, sizeof(port));
+	net_pkt_set_overwrite(pkt, false);
+}
+
+static void chksum_pkt_check(chksum_pkt_modify_t modify, bool cache_kept)
+{
+	struct net_pkt *pkt, *ref;
+
+	pkt = chksum_pkt_create(true);
+	ref = chksum_pkt_create(false);
+
+	if (IS_ENABLED(CONFIG_NET_CHKSUM_ON_COPY)) {
+		zassert_equal(net_pkt_payload_chksum_len(pkt),
+			      CHKSUM_PAYLOAD_LEN, "Payload sum not cached");
+	}
+
+	zassert_equal(net_calc_chksum(pkt, IPPROTO_UDP),
+		      net_calc_chksum(ref, IPPROTO_UDP),
+		      "Checksum mismatch before modification");
+
+	modify(pkt);
+	modify(ref);
+
+	zassert_equal(net_pkt_payload_chksum_len(pkt) != 0U,
+		      IS_ENABLED(CONFIG_NET_CHKSUM_ON_COPY) && cache_kept,
+		      "Payload sum cache not updated");
+
+	zassert_equal(net_calc_chksum(pkt, IPPROTO_UDP),
+		      net_calc_chksum(ref, IPPROTO_UDP),
+		      "Checksum mismatch after modification");
+
+	net_pkt_unref(pkt);
+	net_pkt_unref(ref);
+}
+
+static void test_net_pkt_chksum_on_copy(void)
+{
+	int i;
+
+	for (i = 0; i < sizeof(small_buffer); i++) {
+		small_buffer[i] = i * 7 + 3;
+	}
+
+	chksum_pkt_check(chksum_pkt_overwrite, false);
+	chksum_pkt_check(chksum_pkt_memset, false);
+	chksum_pkt_check(chksum_pkt_append, false);
+	chksum_pkt_check(chksum_pkt_remove_tail, false);
+	chksum_pkt_check(chksum_pkt_write_header, true);
+
+	memset(small_buffer, 0, sizeof(small_buffer));
+}
+
+#if defined(CONFIG_NET_IF_NET_PKT_POOL)
+#define IFACE_RX_COUNT 2
+#define IFACE_FRAME_LEN 1000
+
+NET_PKT_SLAB_DEFINE(iface_rx_pkts, IFACE_RX_COUNT);
+NET_PKT_DATA_VAR_POOL_DEFINE(iface_rx_bufs, IFACE_RX_COUNT, 4096);
+
+static void test_net_pkt_iface_pools(void)
+{
+	struct net_pkt *pkt[IFACE_RX_COUNT + 1];
+	struct net_buf_pool *rx_data;
+	struct k_mem_slab *rx, *tx;
+	struct net_buf *frag;
+	int i;
+
+	net_pkt_get_info(&rx, &tx, &rx_data, NULL);
+	net_if_setup_pools(eth_if, &iface_rx_pkts, NULL, &iface_rx_bufs, NULL);
+
+	/* Received packets come from the pools of the interface first, and
+	 * their data is held in one buffer.
+	 */
+	for (i = 0; i < IFACE_RX_COUNT; i++) {
+		pkt[i] = net_pkt_rx_alloc_with_buffer(eth_if, IFACE_FRAME_LEN,
+						      AF_UNSPEC, 0, K_NO_WAIT);
+		zassert_not_null(pkt[i], "Pkt not allocated");
+		zassert_equal_ptr(pkt[i]->slab, &iface_rx_pkts,
+				  "Pkt not from the interface slab");
+		zassert_equal_ptr(net_buf_pool_get(pkt[i]->buffer->pool_id),
+				  &iface_rx_bufs,
+				  "Data not from the interface pool");
+		zassert_is_null(pkt[i]->buffer->frags, "Data fragmented");
+		zassert_true(pkt_is_of_size(pkt[i], IFACE_FRAME_LEN),
+			     "Pkt size is not right");
+	}
+
+	/* Once these are empty, the common pools are borrowed from */
+	pkt[i] = net_pkt_rx_alloc_with_buffer(eth_if, IFACE_FRAME_LEN,
+					      AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_not_null(pkt[i], "Pkt not borrowed");
+	zassert_equal_ptr(pkt[i]->slab, rx, "Pkt not from the common slab");
+	zassert_true(pkt_is_of_size(pkt[i], IFACE_FRAME_LEN),
+		     "Pkt size is not right");
+
+	/* Sent packets use the common pools */
+	net_pkt_unref(pkt[i]);
+	pkt[i] = net_pkt_alloc_with_buffer(eth_if, IFACE_FRAME_LEN,
+					   AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_not_null(pkt[i], "Pkt not allocated");
+	zassert_equal_ptr(pkt[i]->slab, tx, "Pkt not from the common slab");
+
+	for (i = 0; i < ARRAY_SIZE(pkt); i++) {
+		net_pkt_unref(pkt[i]);
+	}
+
+	zassert_equal(k_mem_slab_num_free_get(&iface_rx_pkts), IFACE_RX_COUNT,
+		      "Interface pkts not freed");
+
+	/* The data keeps coming from the pools the packet was allocated
+	 * with, even once its interface does not have them anymore.
+	 */
+	pkt[0] = net_pkt_rx_alloc_on_iface(eth_if, K_NO_WAIT);
+	zassert_not_null(pkt[0], "Pkt not allocated");
+
+	net_if_setup_pools(eth_if, NULL, NULL, NULL, NULL);
+
+	zassert_equal(net_pkt_alloc_buffer(pkt[0], IFACE_FRAME_LEN, 0,
+					   K_NO_WAIT), 0,
+		      "Buffer not allocated");
+	zassert_equal_ptr(net_buf_pool_get(pkt[0]->buffer->pool_id),
+			  &iface_rx_bufs, "Data not from the interface pool");
+
+	frag = net_pkt_get_frag(pkt[0], K_NO_WAIT);
+	zassert_not_null(frag, "Frag not allocated");
+	zassert_equal_ptr(net_buf_pool_get(frag->pool_id), &iface_rx_bufs,
+			  "Frag not from the interface pool");
+
+	net_pkt_frag_add(pkt[0], frag);
+	net_pkt_unref(pkt[0]);
+
+	/* A received packet from the common slab keeps using the RX data
+	 * pool on an interface without pools.
+	 */
+	pkt[0] = net_pkt_rx_alloc_on_iface(eth_if, K_NO_WAIT);
+	zassert_not_null(pkt[0], "Pkt not allocated");
+	zassert_equal_ptr(pkt[0]->slab, rx, "Pkt not from the common slab");
+
+	frag = net_pkt_get_frag(pkt[0], K_NO_WAIT);
+	zassert_not_null(frag, "Frag not allocated");
+	net_pkt_frag_add(pkt[0], frag);
+
+	zassert_equal(net_pkt_alloc_buffer(pkt[0], IFACE_FRAME_LEN, 0,
+					   K_NO_WAIT), 0,
+		      "Buffer not allocated");
+	for (frag = pkt[0]->buffer; frag; frag = frag->frags) {
+		zassert_equal_ptr(net_buf_pool_get(frag->pool_id), rx_data,
+				  "Data not from the common RX pool");
+	}
+
+	net_pkt_unref(pkt[0]);
+}
+#else
+static void test_net_pkt_iface_pools(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_NET_IF_NET_PKT_POOL */
+
 void test_main(void)
 {
 	eth_if = net_if_get_default();
@@ -1074,7 +1326,9 @@ void test_main(void)
 			 ztest_unit_test(test_net_pkt_headroom),
 			 ztest_unit_test(test_net_pkt_headroom_copy),
 			 ztest_unit_test(test_net_pkt_get_contiguous_len),
-			 ztest_unit_test(test_net_pkt_remove_tail)
+			 ztest_unit_test(test_net_pkt_remove_tail),
+			 ztest_unit_test(test_net_pkt_chksum_on_copy),
+			 ztest_unit_test(test_net_pkt_iface_pools)
 		);
 
 	ztest_run_test_suite(net_pkt_tests);
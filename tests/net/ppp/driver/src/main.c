@@ -29,6 +29,7 @@ LOG_MODULE_REGISTER(net_test, NET_LOG_LEVEL);
 
 #define NET_LOG_ENABLED 1
 #include "net_private.h"
+#include "ppp_hdlc.h"
 
 typedef enum net_verdict (*ppp_l2_callback_t)(struct net_if *iface,
 					      struct net_pkt *pkt);
@@ -537,6 +538,58 @@ static void test_send_ppp_8(void)
 	}
 }
 
+static void test_ppp_hdlc_fcs(void)
+{
+	uint8_t data[64];
+	size_t off, len;
+	int i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = i * 37 + 11;
+	}
+
+	/* All the lengths and alignments of the slice-by-4 loop */
+	for (off = 0; off < 4; off++) {
+		for (len = 0; len < sizeof(data) - off; len++) {
+			zassert_equal(ppp_hdlc_fcs(0xffff, &data[off], len),
+				      crc16_ccitt(0xffff, &data[off], len),
+				      "FCS mismatch, offset %zd length %zd",
+				      off, len);
+		}
+	}
+}
+
+static void test_ppp_hdlc_escape(void)
+{
+	static const uint8_t data[] = {
+		0x45, 0x00, 0x7e, 0x11, 0x22, 0x33, 0x44, 0x7d,
+		0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0x1f,
+	};
+	static const uint8_t expect[] = {
+		0x45, 0x7d, 0x20, 0x7d, 0x5e, 0x7d, 0x31, 0x22,
+		0x33, 0x44, 0x7d, 0x5d, 0x55, 0x66, 0x77, 0x88,
+		0x99, 0xaa, 0xbb, 0x7d, 0x3f,
+	};
+	uint8_t out[sizeof(expect)];
+	size_t consumed, len;
+
+	zassert_equal(ppp_hdlc_scan_rx(data, sizeof(data)), 2,
+		      "Flag not found");
+	zassert_equal(ppp_hdlc_scan_tx(data, sizeof(data)), 1,
+		      "Control character not found");
+
+	len = ppp_hdlc_escape(out, sizeof(out), data, sizeof(data),
+			      &consumed);
+	zassert_equal(consumed, sizeof(data), "Not all data escaped");
+	zassert_equal(len, sizeof(expect), "Invalid escaped length");
+	zassert_mem_equal(out, expect, sizeof(expect), "Invalid escaping");
+
+	/* An escaped byte is not split at the end of the buffer */
+	len = ppp_hdlc_escape(out, 2, data, sizeof(data), &consumed);
+	zassert_equal(len, 1, "Escaped byte split");
+	zassert_equal(consumed, 1, "Invalid consumed length");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(net_ppp_test,
@@ -551,7 +604,9 @@ void test_main(void)
 			 ztest_unit_test(test_send_ppp_5),
 			 ztest_unit_test(test_send_ppp_6),
 			 ztest_unit_test(test_send_ppp_7),
-			 ztest_unit_test(test_send_ppp_8)
+			 ztest_unit_test(test_send_ppp_8),
+			 ztest_unit_test(test_ppp_hdlc_fcs),
+			 ztest_unit_test(test_ppp_hdlc_escape)
 		);
 
 	ztest_run_test_suite(net_ppp_test);
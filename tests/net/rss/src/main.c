@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+
+#include "net_stats.h"
+
+#define QUEUE_COUNT CONFIG_NET_RX_RSS_QUEUE_COUNT
+
+/* The flows are told apart by their source port */
+#define FLOW_COUNT 16
+#define FLOW_PORT(i) (10000 + (i))
+
+#define VLAN_TAG 100
+#define PAYLOAD_LEN 64
+
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+/* How the packet reaches the RSS queues */
+enum frame {
+	FRAME_ETH,
+	FRAME_VLAN,
+	/* Reassembled from fragments, without a link layer header */
+	FRAME_REASSEMBLED,
+};
+
+static struct net_if *iface;
+
+/* The addresses are not ones of the interface, so that the stack drops
+ * the packets once they have gone through the RSS queues.
+ */
+static const struct in_addr src4 = { { { 192, 0, 2, 1 } } };
+static const struct in_addr dst4 = { { { 198, 51, 100, 1 } } };
+static const struct in6_addr src6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					  0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static const struct in6_addr dst6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1,
+					  0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static int rss_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void rss_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x02 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+	ethernet_init(iface);
+}
+
+static int rss_dev_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static const struct ethernet_api rss_dev_api = {
+	.iface_api.init = rss_iface_init,
+	.send = rss_dev_send,
+};
+
+NET_DEVICE_INIT(net_rss_test, "net_rss_test", rss_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &rss_dev_api, ETHERNET_L2,
+		NET_L2_GET_CTX_TYPE(ETHERNET_L2), NET_ETH_MTU);
+
+/* UDP packet of the flow with the given source port. The payload is
+ * filled with fill, which does not change the flow.
+ */
+static struct net_pkt *flow_pkt(sa_family_t family, uint16_t port,
+				 size_t payload_len, uint8_t fill,
+				 enum frame frame)
+{
+	static const uint8_t eth_addr[] = {
+		0x02, 0x00, 0x5e, 0x00, 0x53, 0x02,
+		0x02, 0x00, 0x5e, 0x00, 0x53, 0x01,
+	};
+	struct net_udp_hdr udp = {
+		.src_port = htons(port),
+		.dst_port = htons(4242),
+		.len = htons(sizeof(udp) + payload_len),
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					   2 * sizeof(uint16_t) +
+					   NET_IPV6UDPH_LEN + payload_len,
+					   AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	if (frame != FRAME_REASSEMBLED) {
+		zassert_equal(net_pkt_write(pkt, eth_addr, sizeof(eth_addr)),
+			      0, "Cannot write Ethernet header");
+
+		if (frame == FRAME_VLAN) {
+			zassert_equal(net_pkt_write_be16(pkt,
+							 NET_ETH_PTYPE_VLAN),
+				      0, "Cannot write VLAN header");
+			zassert_equal(net_pkt_write_be16(pkt, VLAN_TAG), 0,
+				      "Cannot write VLAN header");
+		}
+
+		zassert_equal(net_pkt_write_be16(pkt, family == AF_INET ?
+						 NET_ETH_PTYPE_IP :
+						 NET_ETH_PTYPE_IPV6),
+			      0, "Cannot write Ethernet header");
+	}
+
+	if (family == AF_INET) {
+		struct net_ipv4_hdr ipv4 = {
+			.vhl = 0x45,
+			.len = htons(NET_IPV4UDPH_LEN + payload_len),
+			.ttl = 64U,
+			.proto = IPPROTO_UDP,
+		};
+
+		net_ipaddr_copy(&ipv4.src, &src4);
+		net_ipaddr_copy(&ipv4.dst, &dst4);
+
+		zassert_equal(net_pkt_write(pkt, &ipv4, sizeof(ipv4)), 0,
+			      "Cannot write IPv4 header");
+
+		/* A reassembled IPv4 packet keeps the more fragments flag
+		 * of its first fragment.
+		 */
+		net_pkt_set_ipv4_fragment_more(pkt,
+					       frame == FRAME_REASSEMBLED);
+	} else {
+		struct net_ipv6_hdr ipv6 = {
+			.vtc = 0x60,
+			.len = htons(NET_UDPH_LEN + payload_len),
+			.nexthdr = IPPROTO_UDP,
+			.hop_limit = 64U,
+		};
+
+		net_ipaddr_copy(&ipv6.src, &src6);
+		net_ipaddr_copy(&ipv6.dst, &dst6);
+
+		zassert_equal(net_pkt_write(pkt, &ipv6, sizeof(ipv6)), 0,
+			      "Cannot write IPv6 header");
+
+		/* The fragment header was right after the IPv6 header */
+		net_pkt_set_ipv6_fragment_start(pkt,
+						frame == FRAME_REASSEMBLED ?
+						NET_IPV6H_LEN : 0U);
+	}
+
+	zassert_equal(net_pkt_write(pkt, &udp, sizeof(udp)), 0,
+		      "Cannot write UDP header");
+	zassert_equal(net_pkt_memset(pkt, fill, payload_len), 0,
+		      "Cannot write payload");
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+/* Pass a packet to the RX path and return the RSS queue it went to */
+static int rss_queue(struct net_pkt *pkt)
+{
+	net_stats_t pkts[QUEUE_COUNT];
+	int i, queue = -1;
+
+	for (i = 0; i < QUEUE_COUNT; i++) {
+		pkts[i] = GET_STAT(iface, rss.queue[i].pkts);
+	}
+
+	zassert_equal(net_recv_data(iface, pkt), 0, "Packet not received");
+
+	for (i = 0; i < QUEUE_COUNT; i++) {
+		if (GET_STAT(iface, rss.queue[i].pkts) == pkts[i]) {
+			continue;
+		}
+
+		zassert_equal(queue, -1, "Packet passed to several queues");
+		zassert_equal(GET_STAT(iface, rss.queue[i].pkts), pkts[i] + 1,
+			      "Wrong number of packets in queue %d", i);
+		queue = i;
+	}
+
+	zassert_true(queue >= 0, "Packet not passed to an RSS queue");
+
+	return queue;
+}
+
+static void test_setup(void)
+{
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(ETHERNET));
+	zassert_not_null(iface, "Interface not found");
+
+	zassert_equal(net_if_rx_rss_enable(iface), 0, "Cannot enable RSS");
+}
+
+static void flow_same_queue(sa_family_t family)
+{
+	uint32_t used = 0U;
+	int i, queue;
+
+	for (i = 0; i < FLOW_COUNT; i++) {
+		queue = rss_queue(flow_pkt(family, FLOW_PORT(i), PAYLOAD_LEN,
+					   0x00, FRAME_ETH));
+		used |= BIT(queue);
+
+		/* Neither the payload nor the VLAN tag change the queue */
+		zassert_equal(rss_queue(flow_pkt(family, FLOW_PORT(i),
+						 PAYLOAD_LEN / 2, 0x5a,
+						 FRAME_ETH)),
+			      queue, "Flow %d moved to another queue", i);
+		zassert_equal(rss_queue(flow_pkt(family, FLOW_PORT(i),
+						 PAYLOAD_LEN, 0xa5,
+						 FRAME_VLAN)),
+			      queue, "Tagged flow %d in another queue", i);
+
+		/* The stack feeds the packets it reassembled back to the RX
+		 * path without their link layer header, they have to end up
+		 * in the queue of their flow as well.
+		 */
+		zassert_equal(rss_queue(flow_pkt(family, FLOW_PORT(i),
+						 PAYLOAD_LEN, 0x00,
+						 FRAME_REASSEMBLED)),
+			      queue, "Reassembled flow %d in another queue",
+			      i);
+	}
+
+	/* The queue is picked from the hash, so the flows get spread to
+	 * more than one queue.
+	 */
+	zassert_true(QUEUE_COUNT == 1 || (used & (used - 1U)) != 0U,
+		     "All the flows in one queue");
+}
+
+static void test_ipv4_flow(void)
+{
+	flow_same_queue(AF_INET);
+}
+
+static void test_ipv6_flow(void)
+{
+	flow_same_queue(AF_INET6);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rss,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_ipv4_flow),
+			 ztest_unit_test(test_ipv6_flow)
+			 );
+
+	ztest_run_test_suite(net_rss);
+}
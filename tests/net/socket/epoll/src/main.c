@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <posix/sys/eventfd.h>
+#include <sys/fdtable.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+/* On QEMU, a wait takes +10ms from the requested time. */
+#define FUZZ 10
+
+static int ctl_epfd;
+static int ctl_fd;
+
+static void add_fd(int epfd, int fd, uint32_t events)
+{
+	struct epoll_event ev = {
+		.events = events,
+		.data.fd = fd,
+	};
+	int res;
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+	zassert_equal(res, 0, "epoll_ctl ADD failed (%d)", errno);
+}
+
+void test_epoll_udp(void)
+{
+	struct epoll_event ev, events[2];
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	int c_sock, s_sock, epfd;
+	uint32_t tstamp;
+	ssize_t len;
+	char buf[10];
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	add_fd(epfd, c_sock, EPOLLIN);
+	add_fd(epfd, s_sock, EPOLLIN);
+
+	ev.events = EPOLLIN;
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, EEXIST, "");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &ev);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	/* Wait on non-ready fd's with timeout of 0 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	/* Wait on non-ready fd's with timeout of 30 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp >= 30U && tstamp <= 30 + FUZZ * 2, "tstamp %d",
+		     tstamp);
+	zassert_equal(res, 0, "");
+
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	/* Level-triggered, reported again until the data is read */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	len = recv(s_sock, BUF_AND_SIZE(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	/* Writability is reported once with EPOLLET */
+	ev.events = EPOLLOUT | EPOLLET;
+	ev.data.fd = c_sock;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, c_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl MOD failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLOUT, "");
+	zassert_equal(events[0].data.fd, c_sock, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, c_sock, NULL);
+	zassert_equal(res, 0, "epoll_ctl DEL failed");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, c_sock, NULL);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, ENOENT, "");
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(c_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(s_sock);
+	zassert_equal(res, 0, "close failed");
+}
+
+void test_epoll_eventfd(void)
+{
+	struct epoll_event ev, events[1];
+	int efd, epfd;
+	eventfd_t val;
+	int res;
+
+	efd = eventfd(0, EFD_NONBLOCK);
+	zassert_true(efd >= 0, "eventfd failed");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+
+	add_fd(epfd, efd, EPOLLIN | EPOLLONESHOT);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	res = eventfd_write(efd, 3);
+	zassert_equal(res, 0, "eventfd_write failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+	zassert_equal(events[0].data.fd, efd, "");
+
+	/* Disabled after one event, until it is modified */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = 0x1234;
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, efd, &ev);
+	zassert_equal(res, 0, "epoll_ctl MOD failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.u32, 0x1234, "");
+
+	res = eventfd_read(efd, &val);
+	zassert_equal(res, 0, "eventfd_read failed");
+	zassert_equal(val, 3, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(efd);
+	zassert_equal(res, 0, "close failed");
+}
+
+static void ctl_work_handler(struct k_work *work)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+		.data.fd = ctl_fd,
+	};
+
+	ARG_UNUSED(work);
+
+	(void)epoll_ctl(ctl_epfd, EPOLL_CTL_ADD, ctl_fd, &ev);
+}
+
+static K_WORK_DELAYABLE_DEFINE(ctl_work, ctl_work_handler);
+
+void test_epoll_ctl_while_waiting(void)
+{
+	struct epoll_event events[1];
+	uint32_t tstamp;
+	int res;
+
+	ctl_fd = eventfd(1, EFD_NONBLOCK);
+	zassert_true(ctl_fd >= 0, "eventfd failed");
+
+	ctl_epfd = epoll_create1(0);
+	zassert_true(ctl_epfd >= 0, "epoll_create1 failed");
+
+	/* A ready descriptor added by another thread wakes up the waiter */
+	k_work_schedule(&ctl_work, K_MSEC(50));
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(ctl_epfd, events, ARRAY_SIZE(events), 1000);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, ctl_fd, "");
+	zassert_true(tstamp >= 50U && tstamp <= 50 + FUZZ * 2, "tstamp %d",
+		     tstamp);
+
+	res = close(ctl_epfd);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(ctl_fd);
+	zassert_equal(res, 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_udp),
+			 ztest_unit_test(test_epoll_eventfd),
+			 ztest_unit_test(test_epoll_ctl_while_waiting));
+
+	ztest_run_test_suite(socket_epoll);
+}
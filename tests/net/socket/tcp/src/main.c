@@ -899,6 +899,120 @@ static void spawn_child(int sock)
 }
 #endif
 
+#define RCVBUF_SIZE 100
+#define RCVBUF_DATA_LEN (3 * RCVBUF_SIZE)
+
+void test_v4_so_rcvbuf(void)
+{
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	static uint8_t tx_buf[RCVBUF_DATA_LEN];
+	static uint8_t rx_buf[RCVBUF_DATA_LEN];
+	int optval = RCVBUF_SIZE;
+	socklen_t optlen = sizeof(optval);
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < sizeof(tx_buf); i++) {
+		tx_buf[i] = i;
+	}
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	/* The accepted socket inherits the size from the listening one */
+	ret = setsockopt(s_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+			 sizeof(optval));
+	zassert_equal(ret, 0, "setsockopt failed (%d)", errno);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	optval = 0;
+	ret = getsockopt(new_sock, SOL_SOCKET, SO_RCVBUF, &optval, &optlen);
+	zassert_equal(ret, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, RCVBUF_SIZE, "size not inherited");
+
+	/* The data does not fit to the advertised window at once, the
+	 * sender continues when the window is opened by the reads.
+	 */
+	test_send(c_sock, tx_buf, sizeof(tx_buf), 0);
+
+	ret = recv(new_sock, rx_buf, sizeof(rx_buf), MSG_WAITALL);
+	zassert_equal(ret, sizeof(rx_buf), "recv failed (%d)", errno);
+	zassert_mem_equal(rx_buf, tx_buf, sizeof(rx_buf), "unexpected data");
+
+	test_close(c_sock);
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_recv_loan(void)
+{
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	struct zsock_recv_loan loan;
+	struct iovec iov[2];
+	ssize_t ret;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	loan.iov = iov;
+	loan.iovlen = ARRAY_SIZE(iov);
+
+	ret = zsock_recv_loan(new_sock, &loan, 0);
+	zassert_equal(ret, strlen(TEST_STR_SMALL), "recv_loan failed (%d)",
+		      errno);
+	zassert_equal(loan.iovlen, 1, "wrong number of fragments");
+	zassert_equal(iov[0].iov_len, ret, "wrong fragment length");
+	zassert_mem_equal(iov[0].iov_base, TEST_STR_SMALL, ret,
+			  "unexpected data");
+
+	zassert_equal(zsock_recv_return(new_sock, &loan), 0,
+		      "recv_return failed");
+
+	test_close(c_sock);
+
+	/* End of stream is reported like recv() does */
+	loan.iovlen = ARRAY_SIZE(iov);
+	ret = zsock_recv_loan(new_sock, &loan, 0);
+	zassert_equal(ret, 0, "no EOF (%d)", errno);
+	zassert_equal(loan.iovlen, 0, "data loaned on EOF");
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_socket_permission(void)
 {
 #ifdef CONFIG_USERSPACE
@@ -969,6 +1083,8 @@ void test_main(void)
 		ztest_unit_test(test_v6_so_rcvtimeo),
 		ztest_unit_test(test_v4_msg_waitall),
 		ztest_unit_test(test_v6_msg_waitall),
+		ztest_unit_test(test_v4_so_rcvbuf),
+		ztest_unit_test(test_v4_recv_loan),
 		ztest_user_unit_test(test_socket_permission)
 		);
 
@@ -468,6 +468,139 @@ void test_v6_msg_trunc(void)
 		       (struct sockaddr *)&server_addr, sizeof(server_addr));
 }
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#define SESSION_SERVER_COUNT 3
+
+static void test_session_cache_enable(int sock)
+{
+	int optval = TLS_SESSION_CACHE_ENABLED;
+
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &optval, sizeof(optval)),
+		      0, "Failed to enable session cache");
+}
+
+/* Connect a new client to the server and report whether the handshake
+ * resumed a cached session.
+ */
+static int test_session_connect(int s_sock, struct sockaddr_in *s_saddr,
+				bool cache)
+{
+	sec_tag_t sec_tag_list[] = {
+		PSK_TAG
+	};
+	struct sockaddr_in c_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	socklen_t optlen = sizeof(int);
+	int c_sock, new_sock;
+	int resumed = -1;
+
+	prepare_sock_tls_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr, IPPROTO_TLS_1_2);
+
+	zassert_equal(setsockopt(c_sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				 sec_tag_list, sizeof(sec_tag_list)),
+		      0, "Failed to set PSK on client socket");
+
+	if (cache) {
+		test_session_cache_enable(c_sock);
+	}
+
+	spawn_client_connect_thread(c_sock, (struct sockaddr *)s_saddr);
+
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	k_thread_join(&client_connect_thread, K_FOREVER);
+
+	zassert_equal(getsockopt(c_sock, SOL_TLS, TLS_SESSION_RESUMED,
+				 &resumed, &optlen),
+		      0, "Failed to get session resumption status");
+
+	test_close(new_sock);
+	test_close(c_sock);
+
+	return resumed;
+}
+
+void test_v4_session_cache(void)
+{
+	int s_sock[SESSION_SERVER_COUNT];
+	struct sockaddr_in s_saddr[SESSION_SERVER_COUNT];
+	int optval = 0;
+	int i;
+
+	zassert_equal(CONFIG_NET_SOCKETS_TLS_MAX_CLIENT_SESSION_COUNT, 2,
+		      "The test expects a client cache of 2 sessions");
+
+	for (i = 0; i < SESSION_SERVER_COUNT; i++) {
+		prepare_sock_tls_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				    SERVER_PORT + 10 + i, &s_sock[i],
+				    &s_saddr[i], IPPROTO_TLS_1_2);
+
+		test_config_psk(s_sock[i], s_sock[i]);
+		test_session_cache_enable(s_sock[i]);
+
+		test_bind(s_sock[i], (struct sockaddr *)&s_saddr[i],
+			  sizeof(s_saddr[i]));
+		test_listen(s_sock[i]);
+	}
+
+	zassert_equal(setsockopt(s_sock[0], SOL_TLS, TLS_SESSION_CACHE_PURGE,
+				 &optval, sizeof(optval)),
+		      0, "Failed to purge session cache");
+
+	/* Sessions are not resumed without the option */
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], false), 0,
+		      "Session resumed without cache");
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], false), 0,
+		      "Session resumed without cache");
+
+	/* The second connection to the same server resumes the session */
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], true), 0,
+		      "First session resumed");
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], true), 1,
+		      "Session not resumed");
+
+	/* The cache is full with sessions of servers 0 and 1 and server 0 is
+	 * the most recently used one, so server 2 replaces server 1.
+	 */
+	zassert_equal(test_session_connect(s_sock[1], &s_saddr[1], true), 0,
+		      "First session resumed");
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], true), 1,
+		      "Session not resumed");
+	zassert_equal(test_session_connect(s_sock[2], &s_saddr[2], true), 0,
+		      "First session resumed");
+
+	zassert_equal(test_session_connect(s_sock[2], &s_saddr[2], true), 1,
+		      "Session not resumed");
+	zassert_equal(test_session_connect(s_sock[0], &s_saddr[0], true), 1,
+		      "Recently used session replaced");
+	zassert_equal(test_session_connect(s_sock[1], &s_saddr[1], true), 0,
+		      "Least recently used session not replaced");
+
+	/* Nothing is resumed after a purge */
+	zassert_equal(setsockopt(s_sock[0], SOL_TLS, TLS_SESSION_CACHE_PURGE,
+				 &optval, sizeof(optval)),
+		      0, "Failed to purge session cache");
+	zassert_equal(test_session_connect(s_sock[1], &s_saddr[1], true), 0,
+		      "Session resumed after purge");
+	zassert_equal(test_session_connect(s_sock[1], &s_saddr[1], true), 1,
+		      "Session not resumed");
+
+	for (i = 0; i < SESSION_SERVER_COUNT; i++) {
+		test_close(s_sock[i]);
+	}
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+#else
+void test_v4_session_cache(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 void test_main(void)
 {
 	if (IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE)) {
@@ -484,7 +617,8 @@ void test_main(void)
 		ztest_unit_test(test_v4_msg_waitall),
 		ztest_unit_test(test_v6_msg_waitall),
 		ztest_unit_test(test_v4_msg_trunc),
-		ztest_unit_test(test_v6_msg_trunc)
+		ztest_unit_test(test_v6_msg_trunc),
+		ztest_unit_test(test_v4_session_cache)
 		);
 
 	ztest_run_test_suite(socket_tls);
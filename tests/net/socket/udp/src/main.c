@@ -911,6 +911,84 @@ void test_so_protocol(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+#define RCVBUF_DGRAM_LEN 100
+/* Room for two datagrams with their headers but not for three */
+#define RCVBUF_SIZE 300
+
+void test_so_rcvbuf(void)
+{
+	int rv;
+	int i;
+	int optval;
+	socklen_t optlen = sizeof(optval);
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	char buf[RCVBUF_DGRAM_LEN];
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	optval = -1;
+	rv = setsockopt(server_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+			sizeof(optval));
+	zassert_equal(rv, -1, "negative size accepted");
+	zassert_equal(errno, EINVAL, "unexpected errno %d", errno);
+
+	optval = RCVBUF_SIZE;
+	rv = setsockopt(server_sock, SOL_SOCKET, SO_RCVBUF, &optval,
+			sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed (%d)", errno);
+
+	optval = 0;
+	rv = getsockopt(server_sock, SOL_SOCKET, SO_RCVBUF, &optval, &optlen);
+	zassert_equal(rv, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, RCVBUF_SIZE, "wrong receive buffer size");
+
+	memset(buf, 0, sizeof(buf));
+
+	for (i = 0; i < 3; i++) {
+		rv = sendto(client_sock, buf, sizeof(buf), 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+		zassert_equal(rv, sizeof(buf), "sendto failed");
+	}
+
+	k_msleep(10);
+
+	/* The third datagram did not fit to the receive buffer */
+	for (i = 0; i < 2; i++) {
+		rv = recv(server_sock, buf, sizeof(buf), MSG_DONTWAIT);
+		zassert_equal(rv, sizeof(buf), "recv failed (%d)", errno);
+	}
+
+	rv = recv(server_sock, buf, sizeof(buf), MSG_DONTWAIT);
+	zassert_equal(rv, -1, "datagram not dropped");
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	/* Reading the queue makes room for new datagrams */
+	rv = sendto(client_sock, buf, sizeof(buf), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, sizeof(buf), "sendto failed");
+
+	k_msleep(10);
+
+	rv = recv(server_sock, buf, sizeof(buf), MSG_DONTWAIT);
+	zassert_equal(rv, sizeof(buf), "recv failed (%d)", errno);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 static void comm_sendmsg_with_txtime(int client_sock,
 				     struct sockaddr *client_addr,
 				     socklen_t client_addrlen,
@@ -1212,6 +1290,300 @@ void test_v6_msg_trunc(void)
 		       (struct sockaddr *)&server_addr, sizeof(server_addr));
 }
 
+void test_v4_recvmsg_pktinfo(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	int opt = 1;
+	ssize_t recved;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in addr;
+	struct in_pktinfo *info;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	struct iovec io_vector[2];
+	char first[10], second[sizeof(TEST_STR2)];
+	union {
+		struct cmsghdr hdr;
+		unsigned char  buf[CMSG_SPACE(sizeof(struct in_pktinfo))];
+	} cmsgbuf;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = setsockopt(server_sock, IPPROTO_IP, IP_PKTINFO, &opt,
+			sizeof(opt));
+	zassert_equal(rv, 0, "setsockopt failed (%d)", errno);
+
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	io_vector[0].iov_base = first;
+	io_vector[0].iov_len = sizeof(first);
+	io_vector[1].iov_base = second;
+	io_vector[1].iov_len = sizeof(second);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_control = &cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, STRLEN(TEST_STR2), "recvmsg failed (%d)",
+		      errno);
+	zassert_equal(msg.msg_namelen, sizeof(addr), "unexpected addrlen");
+	zassert_equal(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC), 0,
+		      "unexpected flags 0x%x", msg.msg_flags);
+	zassert_mem_equal(first, TEST_STR2, sizeof(first), "wrong data");
+	zassert_mem_equal(second, TEST_STR2 + sizeof(first),
+			  STRLEN(TEST_STR2) - sizeof(first), "wrong data");
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	zassert_not_null(cmsg, "no ancillary data");
+	zassert_equal(cmsg->cmsg_level, IPPROTO_IP, "wrong level");
+	zassert_equal(cmsg->cmsg_type, IP_PKTINFO, "wrong type");
+
+	info = (struct in_pktinfo *)CMSG_DATA(cmsg);
+	zassert_true(info->ipi_ifindex > 0, "no interface index");
+	zassert_true(net_ipv4_addr_cmp(&info->ipi_addr,
+				       &server_addr.sin_addr),
+		     "wrong destination address");
+
+	/* Too small control buffer truncates the ancillary data and too
+	 * small buffers truncate the datagram.
+	 */
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	msg.msg_controllen = sizeof(struct cmsghdr);
+	msg.msg_iovlen = 1;
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, sizeof(first), "recvmsg failed (%d)", errno);
+	zassert_equal(msg.msg_flags, MSG_TRUNC | MSG_CTRUNC,
+		      "unexpected flags 0x%x", msg.msg_flags);
+	zassert_equal(msg.msg_controllen, 0, "unexpected controllen");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define MMSG_COUNT 4
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	int rv;
+	int i;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in addr[MMSG_COUNT];
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec tx_iov[MMSG_COUNT];
+	struct iovec rx_iov[MMSG_COUNT];
+	char bufs[MMSG_COUNT][16];
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		tx_iov[i].iov_base = TEST_STR2 + i;
+		tx_iov[i].iov_len = i + 1;
+
+		msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &server_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+	}
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "sendmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, i + 1, "wrong sent length");
+	}
+
+	/* Give the datagrams time to arrive */
+	k_msleep(10);
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		rx_iov[i].iov_base = bufs[i];
+		rx_iov[i].iov_len = sizeof(bufs[i]);
+
+		msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &addr[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+	}
+
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "recvmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, i + 1, "wrong received length");
+		zassert_mem_equal(bufs[i], TEST_STR2 + i, i + 1, "wrong data");
+		zassert_equal(msgs[i].msg_hdr.msg_namelen, sizeof(addr[i]),
+			      "unexpected addrlen");
+	}
+
+	/* Nothing left, must not block */
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_DONTWAIT);
+	zassert_equal(rv, -1, "recvmmsg should fail");
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v4_recv_loan(void)
+{
+	int rv;
+	int i;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct iovec iov[4];
+	struct zsock_recv_loan loan;
+	char buf[sizeof(TEST_STR2)];
+	size_t len;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = sendto(client_sock, TEST_STR2, sizeof(TEST_STR2) - 1, 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "sendto failed");
+
+	loan.iov = iov;
+	loan.iovlen = ARRAY_SIZE(iov);
+
+	rv = zsock_recv_loan(server_sock, &loan, 0);
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "recv_loan failed (%d)",
+		      errno);
+	zassert_true(loan.iovlen > 0 && loan.iovlen <= ARRAY_SIZE(iov),
+		     "wrong number of fragments");
+
+	/* Gather the fragments to verify the data */
+	for (i = 0, len = 0; i < loan.iovlen; i++) {
+		zassert_true(len + iov[i].iov_len <= rv, "fragment overflow");
+		memcpy(buf + len, iov[i].iov_base, iov[i].iov_len);
+		len += iov[i].iov_len;
+	}
+
+	zassert_equal(len, rv, "wrong loaned length");
+	zassert_equal(loan.len, len, "wrong loan length");
+	zassert_mem_equal(buf, TEST_STR2, len, "wrong data");
+
+	rv = zsock_recv_return(server_sock, &loan);
+	zassert_equal(rv, 0, "recv_return failed");
+	zassert_is_null(loan.pkt, "loan not released");
+
+	/* Only one fragment fits, the rest of the datagram is dropped */
+	rv = sendto(client_sock, TEST_STR2, sizeof(TEST_STR2) - 1, 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "sendto failed");
+
+	loan.iovlen = 1;
+
+	rv = zsock_recv_loan(server_sock, &loan, 0);
+	zassert_true(rv > 0, "recv_loan failed (%d)", errno);
+	zassert_equal(loan.iovlen, 1, "wrong number of fragments");
+	zassert_equal(iov[0].iov_len, rv, "wrong fragment length");
+	zassert_mem_equal(iov[0].iov_base, TEST_STR2, rv, "wrong data");
+
+	if (rv < sizeof(TEST_STR2) - 1) {
+		zassert_equal(loan.flags, ZSOCK_MSG_TRUNC, "not truncated");
+	}
+
+	rv = zsock_recv_return(server_sock, &loan);
+	zassert_equal(rv, 0, "recv_return failed");
+
+	loan.iovlen = ARRAY_SIZE(iov);
+
+	rv = zsock_recv_loan(server_sock, &loan, MSG_DONTWAIT);
+	zassert_equal(rv, -1, "recv_loan should fail");
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	/* A loan returned after the socket was closed must not touch the
+	 * socket that reuses the descriptor.
+	 */
+	rv = sendto(client_sock, TEST_STR2, sizeof(TEST_STR2) - 1, 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "sendto failed");
+
+	rv = zsock_recv_loan(server_sock, &loan, 0);
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "recv_loan failed (%d)",
+		      errno);
+
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+	rv = bind(server_sock, (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+	zassert_not_equal_ptr(loan.ctx, zsock_get_context_object(server_sock),
+			      "closed context reused while loaned");
+
+	rv = zsock_recv_return(server_sock, &loan);
+	zassert_equal(rv, 0, "recv_return failed");
+	zassert_is_null(loan.pkt, "loan not released");
+
+	rv = sendto(client_sock, TEST_STR2, sizeof(TEST_STR2) - 1, 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "sendto failed");
+
+	loan.iovlen = ARRAY_SIZE(iov);
+
+	rv = zsock_recv_loan(server_sock, &loan, 0);
+	zassert_equal(rv, sizeof(TEST_STR2) - 1, "recv_loan failed (%d)",
+		      errno);
+
+	rv = zsock_recv_return(server_sock, &loan);
+	zassert_equal(rv, 0, "recv_return failed");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_main(void)
 {
 	k_thread_system_pool_assign(k_current_get());
@@ -1228,6 +1600,7 @@ void test_main(void)
 			 ztest_unit_test(test_so_rcvtimeo),
 			 ztest_unit_test(test_so_sndtimeo),
 			 ztest_unit_test(test_so_protocol),
+			 ztest_unit_test(test_so_rcvbuf),
 			 ztest_unit_test(test_v4_sendmsg_recvfrom),
 			 ztest_user_unit_test(test_v4_sendmsg_recvfrom),
 			 ztest_unit_test(test_v4_sendmsg_recvfrom_no_aux_data),
@@ -1242,7 +1615,12 @@ void test_main(void)
 			 ztest_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_user_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_unit_test(test_v4_msg_trunc),
-			 ztest_unit_test(test_v6_msg_trunc)
+			 ztest_unit_test(test_v6_msg_trunc),
+			 ztest_unit_test(test_v4_recvmsg_pktinfo),
+			 ztest_user_unit_test(test_v4_recvmsg_pktinfo),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_unit_test(test_v4_recv_loan)
 		);
 
 	ztest_run_test_suite(socket_udp);
@@ -353,6 +353,28 @@ static void test_send_and_recv_lorem_ipsum(void)
 		      test_msg_len, ret);
 }
 
+static void test_send_and_recv_short_msg(void)
+{
+	static struct websocket_context ctx;
+	int ret;
+
+	memset(&ctx, 0, sizeof(ctx));
+
+	ctx.tmp_buf = temp_recv_buf;
+	ctx.tmp_buf_len = sizeof(temp_recv_buf);
+
+	/* Short enough to be masked without a heap allocation */
+	test_msg_len = 27;
+
+	ret = websocket_send_msg(POINTER_TO_INT(&ctx),
+				 lorem_ipsum, test_msg_len,
+				 WEBSOCKET_OPCODE_DATA_TEXT, true, true,
+				 SYS_FOREVER_MS);
+	zassert_equal(ret, test_msg_len,
+		      "Should have sent %zd bytes but sent %d instead",
+		      test_msg_len, ret);
+}
+
 static void test_recv_two_large_split_msg(void)
 {
 	static struct websocket_context ctx;
@@ -390,6 +412,7 @@ void test_main(void)
 			 ztest_unit_test(test_recv_whole_msg),
 			 ztest_unit_test(test_recv_two_msg),
 			 ztest_unit_test(test_send_and_recv_lorem_ipsum),
+			 ztest_unit_test(test_send_and_recv_short_msg),
 			 ztest_unit_test(test_recv_two_large_split_msg)
 		);
 
@@ -31,6 +31,8 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
 #include "ipv6.h"
 #include "tcp2.h"
 #include "tcp2_priv.h"
+#include "tcp_internal.h"
+#include "net_private.h"
 #include "net_stats.h"
 
 #include <ztest.h>
@@ -98,6 +100,9 @@ static uint8_t test_case_no;
 static uint32_t seq;
 static uint32_t ack;
 
+/* Window advertised by the peer, as it is placed into the TCP header */
+static uint16_t peer_win = NET_IPV6_MTU;
+
 static K_SEM_DEFINE(test_sem, 0, 1);
 static bool sem;
 
@@ -125,6 +130,9 @@ static void handle_syn_resend(void);
 static void handle_client_fin_wait_2_test(sa_family_t af, struct tcphdr *th);
 static void handle_client_closing_test(sa_family_t af, struct tcphdr *th);
 static void handle_server_recv_out_of_order(struct net_pkt *pkt);
+static void handle_client_gso_test(sa_family_t af, struct tcphdr *th,
+				   struct net_pkt *pkt);
+static void handle_server_gro_test(struct tcphdr *th);
 
 static void verify_flags(struct tcphdr *th, uint8_t flags,
 			 const char *fun, int line)
@@ -213,6 +221,11 @@ static uint8_t tcp_options[20] = {
 	0x01, /* NOP */
 	0x03, 0x03, 0x07 /* Win scale*/ };
 
+#define GSO_TEST_MSS 80
+
+static uint8_t gso_mss_option[4] = {
+	0x02, 0x04, 0x00, GSO_TEST_MSS /* Max segment */ };
+
 static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 					      uint16_t src_port,
 					      uint16_t dst_port,
@@ -221,13 +234,18 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 					      size_t len)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
+	const uint8_t *opts = NULL;
 	struct net_pkt *pkt;
 	struct tcphdr *th;
 	uint8_t opts_len = 0;
 	int ret = -EINVAL;
 
 	if ((test_case_no == 4U) && (flags & SYN)) {
+		opts = tcp_options;
 		opts_len = sizeof(tcp_options);
+	} else if ((test_case_no == 10U) && (flags & SYN)) {
+		opts = gso_mss_option;
+		opts_len = sizeof(gso_mss_option);
 	}
 
 	/* Allocate buffer */
@@ -262,14 +280,9 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 	th->th_sport = src_port;
 	th->th_dport = dst_port;
 
-	if ((test_case_no == 4U) && (flags & SYN)) {
-		th->th_off = 10U;
-	} else {
-		th->th_off = 5U;
-	}
-
+	th->th_off = 5U + opts_len / 4U;
 	th->th_flags = flags;
-	th->th_win = NET_IPV6_MTU;
+	th->th_win = peer_win;
 	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
@@ -281,9 +294,9 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 		goto fail;
 	}
 
-	if ((test_case_no == 4U) && (flags & SYN)) {
+	if (opts_len) {
 		/* Add TCP Options */
-		ret = net_pkt_write(pkt, tcp_options, opts_len);
+		ret = net_pkt_write(pkt, opts, opts_len);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -420,6 +433,12 @@ static int tester_send(const struct device *dev, struct net_pkt *pkt)
 	case 9:
 		handle_server_recv_out_of_order(pkt);
 		break;
+	case 10:
+		handle_client_gso_test(net_pkt_family(pkt), &th, pkt);
+		break;
+	case 11:
+		handle_server_gro_test(&th);
+		break;
 	default:
 		zassert_true(false, "Undefined test case");
 	}
@@ -701,6 +720,8 @@ static void test_server_timeout(struct k_work *work)
 	}
 }
 
+static void gro_recv_data(struct net_pkt *pkt);
+
 static void test_tcp_recv_cb(struct net_context *context,
 			     struct net_pkt *pkt,
 			     union net_ip_header *ip_hdr,
@@ -711,6 +732,10 @@ static void test_tcp_recv_cb(struct net_context *context,
 	if (status && status != -ECONNRESET) {
 		zassert_true(false, "failed to recv the data");
 	}
+
+	if (pkt && test_case_no == 11U) {
+		gro_recv_data(pkt);
+	}
 }
 
 static void test_tcp_accept_cb(struct net_context *ctx,
@@ -1334,6 +1359,378 @@ static void test_client_invalid_rst(void)
 	net_tcp_put(ctx);
 }
 
+#define GSO_TEST_LEN (2 * GSO_TEST_MSS + GSO_TEST_MSS / 2)
+
+static uint32_t gso_start;
+static int gso_segs;
+
+static void handle_client_gso_test(sa_family_t af, struct tcphdr *th,
+				   struct net_pkt *pkt)
+{
+	uint8_t data[GSO_TEST_MSS];
+	struct net_pkt *reply;
+	size_t hdr_len, len;
+	int ret;
+
+	switch (t_state) {
+	case T_SYN:
+		test_verify_flags(th, SYN);
+		seq = 0U;
+		ack = ntohl(th->th_seq) + 1U;
+		reply = prepare_syn_ack_packet(af, htons(MY_PORT),
+					       th->th_sport);
+		t_state = T_SYN_ACK;
+		break;
+	case T_SYN_ACK:
+		test_verify_flags(th, ACK);
+		seq++;
+		gso_start = ack;
+		t_state = T_DATA;
+		test_sem_give();
+		return;
+	case T_DATA:
+		hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt) +
+			th->th_off * 4U;
+		len = net_pkt_get_len(pkt) - hdr_len;
+
+		zassert_true(len > 0 && len <= GSO_TEST_MSS,
+			     "Invalid segment length %zd", len);
+		zassert_equal(ntohl(th->th_seq), ack,
+			      "Segment out of order (seq %u, expected %u)",
+			      ntohl(th->th_seq), ack);
+
+		net_pkt_cursor_init(pkt);
+		net_pkt_set_overwrite(pkt, true);
+		zassert_equal(net_pkt_skip(pkt, hdr_len), 0, "Cannot skip");
+		zassert_equal(net_pkt_read(pkt, data, len), 0, "Cannot read");
+		zassert_mem_equal(data, lorem_ipsum + (ack - gso_start), len,
+				  "Invalid data in segment %d", gso_segs);
+
+		ack += len;
+		gso_segs++;
+
+		if (ack - gso_start < GSO_TEST_LEN) {
+			/* Only the last segment carries PSH */
+			test_verify_flags(th, ACK);
+			return;
+		}
+
+		test_verify_flags(th, PSH | ACK);
+		reply = prepare_ack_packet(af, htons(MY_PORT), th->th_sport);
+		t_state = T_FIN;
+		test_sem_give();
+		break;
+	case T_FIN:
+		test_verify_flags(th, FIN | ACK);
+		ack = ntohl(th->th_seq) + 1U;
+		t_state = T_FIN_ACK;
+		reply = prepare_fin_ack_packet(af, htons(MY_PORT),
+					       th->th_sport);
+		break;
+	case T_FIN_ACK:
+		test_verify_flags(th, ACK);
+		test_sem_give();
+		return;
+	default:
+		zassert_true(false, "%s unexpected state", __func__);
+		return;
+	}
+
+	ret = net_recv_data(iface, reply);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	return;
+fail:
+	zassert_true(false, "%s failed", __func__);
+}
+
+/* Test case scenario IPv4
+ *   send SYN,
+ *   expect SYN ACK with a small MSS,
+ *   send ACK,
+ *   send Data that is larger than the MSS,
+ *   expect the data in MSS sized segments, PSH set in the last one,
+ *   send ACK,
+ *   send FIN,
+ *   expect FIN ACK,
+ *   send ACK.
+ *   any failures cause test case to fail.
+ */
+static void test_client_gso_ipv4(void)
+{
+#if defined(CONFIG_NET_TCP_GSO)
+	struct net_context *ctx;
+	int ret;
+
+	t_state = T_SYN;
+	test_case_no = 10;
+	seq = ack = 0;
+	gso_segs = 0;
+	peer_win = htons(NET_IPV6_MTU);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	if (ret < 0) {
+		zassert_true(false, "Failed to get net_context");
+	}
+
+	net_context_ref(ctx);
+
+	ret = net_context_connect(ctx, (struct sockaddr *)&peer_addr_s,
+				  sizeof(struct sockaddr_in),
+				  NULL,
+				  K_MSEC(100), NULL);
+	if (ret < 0) {
+		zassert_true(false, "Failed to connect to peer");
+	}
+
+	/* Peer will release the semaphone after it receives
+	 * proper ACK to SYN | ACK
+	 */
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	ret = net_context_send(ctx, lorem_ipsum, GSO_TEST_LEN, NULL,
+			       K_NO_WAIT, NULL);
+	if (ret < 0) {
+		zassert_true(false, "Failed to send data to peer");
+	}
+
+	/* Peer will release the semaphone after it has received all the
+	 * segments and sent ACK for them.
+	 */
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	zassert_equal(gso_segs, DIV_ROUND_UP(GSO_TEST_LEN, GSO_TEST_MSS),
+		      "Data sent in %d segments", gso_segs);
+
+	net_tcp_put(ctx);
+
+	/* Peer will release the semaphone after it receives
+	 * proper ACK to FIN | ACK
+	 */
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	peer_win = NET_IPV6_MTU;
+
+	/* Connection is in TIME_WAIT state, context will be released
+	 * after K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY), so wait for it.
+	 */
+	k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
+#else
+	ztest_test_skip();
+#endif
+}
+
+#define GRO_TEST_SEG 20
+
+static struct net_context *gro_ctx;
+static uint8_t gro_data[sizeof(lorem_ipsum)];
+static uint32_t gro_seq_base;
+static uint32_t gro_last_ack;
+static size_t gro_rcvd;
+static int gro_cbs;
+static int gro_acks;
+
+static void handle_server_gro_test(struct tcphdr *th)
+{
+	test_verify_flags(th, ACK);
+
+	gro_last_ack = ntohl(th->th_ack);
+	gro_acks++;
+}
+
+static void gro_recv_data(struct net_pkt *pkt)
+{
+	size_t len = net_pkt_remaining_data(pkt);
+
+	zassert_true(gro_rcvd + len <= sizeof(gro_data),
+		     "Too much data received");
+	zassert_equal(net_pkt_read(pkt, gro_data + gro_rcvd, len), 0,
+		      "Cannot read data");
+
+	gro_rcvd += len;
+	gro_cbs++;
+
+	net_pkt_unref(pkt);
+}
+
+static void gro_flush_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	net_tcp_gro_flush();
+}
+
+static K_WORK_DEFINE(gro_flush_work, gro_flush_handler);
+
+static void gro_reset(void)
+{
+	gro_cbs = 0;
+	gro_acks = 0;
+}
+
+/* Send the next len bytes of the stream. The segment is either queued to
+ * the RX thread, or processed right away in this thread, in which case only
+ * this thread or the GRO timer flushes it.
+ */
+static void gro_send(size_t len, uint8_t flags, bool queue)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = tester_prepare_tcp_pkt(AF_INET6, htons(MY_PORT),
+				     htons(PEER_PORT), flags,
+				     lorem_ipsum + (seq - gro_seq_base), len);
+	zassert_not_null(pkt, "Cannot create pkt");
+
+	seq += len;
+
+	if (queue) {
+		ret = net_recv_data(iface, pkt);
+		zassert_true(ret == 0, "recv data failed (%d)", ret);
+		return;
+	}
+
+	net_pkt_set_iface(pkt, iface);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	net_process_rx_packet(pkt);
+}
+
+static void gro_check_stream(void)
+{
+	zassert_equal(gro_rcvd, seq - gro_seq_base,
+		      "Received %zd bytes, expected %u", gro_rcvd,
+		      seq - gro_seq_base);
+	zassert_mem_equal(gro_data, lorem_ipsum, gro_rcvd,
+			  "Received data out of order");
+}
+
+/* Segments without PSH are coalesced and passed up as one when the flush
+ * timer expires.
+ */
+static void test_server_gro_coalesce(void)
+{
+#if defined(CONFIG_NET_TCP_GRO)
+	gro_ctx = create_server_socket(0, 0);
+
+	test_case_no = 11;
+	gro_seq_base = seq;
+	gro_rcvd = 0;
+	gro_reset();
+
+	gro_send(GRO_TEST_SEG, ACK, false);
+	gro_send(GRO_TEST_SEG, ACK, false);
+	gro_send(GRO_TEST_SEG, ACK, false);
+
+	zassert_equal(gro_cbs, 0, "Data was not held");
+
+	k_msleep(CONFIG_NET_TCP_GRO_FLUSH_TIMEOUT + 50);
+
+	zassert_equal(gro_cbs, 1, "Data passed up %d times", gro_cbs);
+	zassert_equal(gro_acks, 1, "Data acked %d times", gro_acks);
+	zassert_equal(gro_last_ack, seq, "Invalid ACK %u, expected %u",
+		      gro_last_ack, seq);
+	gro_check_stream();
+#else
+	ztest_test_skip();
+#endif
+}
+
+/* The held data is passed up once the segment limit is reached, or when a
+ * PSH segment arrives, without waiting for the timer.
+ */
+static void test_server_gro_flush_limits(void)
+{
+#if defined(CONFIG_NET_TCP_GRO)
+	int i;
+
+	gro_reset();
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_MAX_SEGS; i++) {
+		gro_send(GRO_TEST_SEG, ACK, false);
+	}
+
+	zassert_equal(gro_cbs, 1, "Not flushed at the segment limit (%d)",
+		      gro_cbs);
+
+	gro_send(GRO_TEST_SEG, ACK, false);
+	zassert_equal(gro_cbs, 1, "Data was not held");
+
+	gro_send(GRO_TEST_SEG, PSH | ACK, false);
+	zassert_equal(gro_cbs, 2, "Not flushed by PSH (%d)", gro_cbs);
+
+	gro_check_stream();
+#else
+	ztest_test_skip();
+#endif
+}
+
+/* A segment that cannot be coalesced must not overtake the held data, and
+ * data held by one thread is kept in order with data from another thread.
+ */
+static void test_server_gro_order(void)
+{
+#if defined(CONFIG_NET_TCP_GRO)
+	gro_reset();
+
+	gro_send(GRO_TEST_SEG, ACK, false);
+	zassert_equal(gro_cbs, 0, "Data was not held");
+
+	/* Pure ACK, the held data is passed up before it */
+	gro_send(0, ACK, false);
+	zassert_equal(gro_cbs, 1, "Held data not passed up first");
+	gro_check_stream();
+
+	gro_send(GRO_TEST_SEG, ACK, false);
+	gro_send(GRO_TEST_SEG, PSH | ACK, true);
+
+	k_msleep(10);
+
+	gro_check_stream();
+#else
+	ztest_test_skip();
+#endif
+}
+
+/* The end of an RX batch only flushes the data held by that RX thread */
+static void test_server_gro_batch_flush(void)
+{
+#if defined(CONFIG_NET_TCP_GRO)
+	struct net_pkt *pkt;
+	int ret;
+
+	gro_reset();
+
+	gro_send(GRO_TEST_SEG, ACK, false);
+
+	k_work_submit(&gro_flush_work);
+	k_msleep(10);
+
+	zassert_equal(gro_cbs, 0, "Flushed by another thread");
+
+	net_tcp_gro_flush();
+
+	zassert_equal(gro_cbs, 1, "Not flushed at the end of the batch");
+	gro_check_stream();
+
+	/* Close the connection so that the following tests can reuse the
+	 * addresses.
+	 */
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(10);
+
+	net_tcp_put(gro_ctx);
+#else
+	ztest_test_skip();
+#endif
+}
+
 #define MAX_DATA 100
 static uint32_t expected_ack = MAX_DATA + 1 - 15;
 static struct net_context *ooo_ctx;
@@ -1497,7 +1894,12 @@ void test_main(void)
 			 ztest_unit_test(test_client_syn_resend),
 			 ztest_unit_test(test_client_fin_wait_2_ipv4),
 			 ztest_unit_test(test_client_closing_ipv6),
+			 ztest_unit_test(test_client_gso_ipv4),
 			 ztest_unit_test(test_client_invalid_rst),
+			 ztest_unit_test(test_server_gro_coalesce),
+			 ztest_unit_test(test_server_gro_flush_limits),
+			 ztest_unit_test(test_server_gro_order),
+			 ztest_unit_test(test_server_gro_batch_flush),
 			 ztest_unit_test(test_server_recv_out_of_order_data),
 			 ztest_unit_test(test_server_timeout_out_of_order_data)
 			 );
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <stdlib.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#include "net_stats.h"
+
+#define PKT_LEN 512
+#define SMALL_PKT_LEN 128
+
+/* The flows are told apart by their source port. The ports are picked so
+ * that the flows of each test hash to different flow queues.
+ */
+#define PORT_PLUG 1000
+#define PORT_DRR_A 2001
+#define PORT_DRR_B 2002
+#define PORT_LIMIT_A 3001
+#define PORT_LIMIT_B 3002
+#define PORT_CODEL 4001
+#define PORT_SHAPER 5001
+
+/* Number of packets a flow can send in one round */
+#define DRR_ROUND DIV_ROUND_UP(CONFIG_NET_TC_QDISC_QUANTUM, PKT_LEN)
+
+#define TARGET_MS (CONFIG_NET_TC_QDISC_TARGET_US / USEC_PER_MSEC)
+#define INTERVAL_MS (CONFIG_NET_TC_QDISC_INTERVAL_US / USEC_PER_MSEC)
+
+#define SHAPER_PKTS 11
+#define SHAPER_RATE (5 * PKT_LEN)
+
+#define SENT_MAX 32
+#define SENT_TIMEOUT K_MSEC(500)
+
+/* The send function holds the link until the test releases it, so that
+ * the packets stay in the TX queue for as long as the test wants.
+ */
+static K_SEM_DEFINE(link_sem, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(sent_sem, 0, K_SEM_MAX_LIMIT);
+
+static uint16_t sent_port[SENT_MAX];
+static uint32_t sent_time[SENT_MAX];
+static int sent_count;
+
+static struct net_if *iface;
+static uint8_t tc;
+
+static int tx_qdisc_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void tx_qdisc_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x02, 0x00, 0x5e, 0x00, 0x53, 0x02 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int tx_qdisc_send(const struct device *dev, struct net_pkt *pkt)
+{
+	uint16_t port = 0U;
+
+	net_pkt_cursor_init(pkt);
+	(void)net_pkt_skip(pkt, sizeof(struct net_ipv4_hdr));
+	(void)net_pkt_read_be16(pkt, &port);
+
+	if (sent_count < SENT_MAX) {
+		sent_port[sent_count] = port;
+		sent_time[sent_count] = k_uptime_get_32();
+		sent_count++;
+	}
+
+	k_sem_give(&sent_sem);
+	k_sem_take(&link_sem, K_FOREVER);
+
+	return 0;
+}
+
+static struct dummy_api tx_qdisc_if_api = {
+	.iface_api.init = tx_qdisc_iface_init,
+	.send = tx_qdisc_send,
+};
+
+NET_DEVICE_INIT(net_tx_qdisc_test, "net_tx_qdisc_test", tx_qdisc_dev_init,
+		NULL, NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&tx_qdisc_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static void queue_pkt(uint16_t src_port, size_t len)
+{
+	struct net_ipv4_hdr ipv4 = {
+		.vhl = 0x45,
+		.len = htons(len),
+		.ttl = 64U,
+		.proto = IPPROTO_UDP,
+		.src = { { 192, 0, 2, 1 } },
+		.dst = { { 192, 0, 2, 2 } },
+	};
+	struct net_udp_hdr udp = {
+		.src_port = htons(src_port),
+		.dst_port = htons(4242),
+		.len = htons(len - sizeof(ipv4)),
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, len, AF_INET, IPPROTO_UDP,
+					K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	zassert_equal(net_pkt_write(pkt, &ipv4, sizeof(ipv4)), 0,
+		      "Cannot write IPv4 header");
+	zassert_equal(net_pkt_write(pkt, &udp, sizeof(udp)), 0,
+		      "Cannot write UDP header");
+	zassert_equal(net_pkt_memset(pkt, 0x5a,
+				     len - sizeof(ipv4) - sizeof(udp)), 0,
+		      "Cannot write payload");
+
+	net_pkt_cursor_init(pkt);
+	net_if_queue_tx(iface, pkt);
+}
+
+static void link_release(int count)
+{
+	while (count--) {
+		k_sem_give(&link_sem);
+	}
+}
+
+static void wait_sent(int count)
+{
+	while (count--) {
+		zassert_equal(k_sem_take(&sent_sem, SENT_TIMEOUT), 0,
+			      "Packet not sent");
+	}
+}
+
+/* Occupy the link with one packet, so that the packets queued after it
+ * stay in the TX queue until the link is released.
+ */
+static void link_plug(void)
+{
+	sent_count = 0;
+	k_sem_reset(&sent_sem);
+
+	queue_pkt(PORT_PLUG, SMALL_PKT_LEN);
+	wait_sent(1);
+}
+
+static int count_sent(uint16_t port)
+{
+	int i, count = 0;
+
+	for (i = 0; i < sent_count; i++) {
+		if (sent_port[i] == port) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void test_setup(void)
+{
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface not found");
+
+	tc = net_tx_priority2tc(NET_PRIORITY_BE);
+}
+
+static void test_drr_fairness(void)
+{
+	net_stats_t codel_drop = GET_STAT(iface, qdisc.tc[tc].codel_drop);
+	int a = 0, b = 0;
+	int i;
+
+	link_plug();
+
+	/* A bulk flow followed by a smaller one, both of which stay backlogged
+	 * until the smaller one has sent all of its packets.
+	 */
+	for (i = 0; i < 10; i++) {
+		queue_pkt(PORT_DRR_A, PKT_LEN);
+	}
+
+	for (i = 0; i < 5; i++) {
+		queue_pkt(PORT_DRR_B, PKT_LEN);
+	}
+
+	link_release(1 + 15);
+	wait_sent(15);
+
+	zassert_equal(count_sent(PORT_DRR_A), 10, "Flow A packets lost");
+	zassert_equal(count_sent(PORT_DRR_B), 5, "Flow B packets lost");
+
+	for (i = 1; i < sent_count && b < 5; i++) {
+		if (sent_port[i] == PORT_DRR_A) {
+			a++;
+		} else {
+			b++;
+		}
+
+		zassert_true(abs(a - b) <= DRR_ROUND,
+			     "Flows not served in turns (%d vs %d at %d)",
+			     a, b, i);
+	}
+
+	zassert_equal(GET_STAT(iface, qdisc.tc[tc].codel_drop), codel_drop,
+		      "Packets dropped from a short queue");
+}
+
+static void test_overlimit_drop(void)
+{
+	net_stats_t overlimit = GET_STAT(iface, qdisc.tc[tc].overlimit_drop);
+	int i;
+
+	link_plug();
+
+	/* Two more packets than fit in the queue. The flow with the most
+	 * bytes queued loses its oldest packets.
+	 */
+	for (i = 0; i < 12; i++) {
+		queue_pkt(PORT_LIMIT_A, PKT_LEN);
+	}
+
+	for (i = 0; i < CONFIG_NET_TC_QDISC_LIMIT + 2 - 12; i++) {
+		queue_pkt(PORT_LIMIT_B, SMALL_PKT_LEN);
+	}
+
+	zassert_equal(GET_STAT(iface, qdisc.tc[tc].overlimit_drop),
+		      overlimit + 2, "Wrong number of packets dropped");
+
+	link_release(1 + CONFIG_NET_TC_QDISC_LIMIT);
+	wait_sent(CONFIG_NET_TC_QDISC_LIMIT);
+
+	zassert_equal(count_sent(PORT_LIMIT_A), 10,
+		      "Packets not dropped from the largest queue");
+	zassert_equal(count_sent(PORT_LIMIT_B), CONFIG_NET_TC_QDISC_LIMIT - 10,
+		      "Packets dropped from the smaller queue");
+}
+
+static void test_codel_drop(void)
+{
+	net_stats_t codel_drop = GET_STAT(iface, qdisc.tc[tc].codel_drop);
+	int i;
+
+	link_plug();
+
+	for (i = 0; i < 6; i++) {
+		queue_pkt(PORT_CODEL, PKT_LEN);
+	}
+
+	/* The first packet is above the target, which starts the interval.
+	 * Nothing is dropped yet.
+	 */
+	k_msleep(2 * TARGET_MS);
+	link_release(1);
+	wait_sent(1);
+
+	zassert_equal(GET_STAT(iface, qdisc.tc[tc].codel_drop), codel_drop,
+		      "Packet dropped before the interval");
+
+	/* Once the delay has stayed above the target for the interval, the
+	 * next packet is dropped.
+	 */
+	k_msleep(INTERVAL_MS + TARGET_MS);
+	link_release(1);
+	wait_sent(1);
+
+	zassert_equal(GET_STAT(iface, qdisc.tc[tc].codel_drop),
+		      codel_drop + 1, "Packet not dropped after the interval");
+
+	/* The next drop is an interval later, and the last packet of the flow
+	 * is never dropped.
+	 */
+	link_release(4);
+	wait_sent(3);
+
+	zassert_equal(GET_STAT(iface, qdisc.tc[tc].codel_drop),
+		      codel_drop + 1, "Too many packets dropped");
+	zassert_equal(count_sent(PORT_CODEL), 5, "Wrong number of packets sent");
+}
+
+static void test_shaper_rate(void)
+{
+	net_stats_t shaped = GET_STAT(iface, qdisc.tc[tc].shaped);
+	uint32_t expected, elapsed;
+	int i;
+
+	zassert_equal(net_if_tx_shaper_set(iface, tc, SHAPER_RATE, 0),
+		      -EINVAL, "Shaper without burst accepted");
+	zassert_equal(net_if_tx_shaper_set(iface, NET_TC_TX_COUNT,
+					   SHAPER_RATE, PKT_LEN), -EINVAL,
+		      "Invalid traffic class accepted");
+
+	zassert_equal(net_if_tx_shaper_set(iface, tc, SHAPER_RATE, PKT_LEN), 0,
+		      "Cannot set shaper");
+
+	sent_count = 0;
+	k_sem_reset(&sent_sem);
+	link_release(SHAPER_PKTS);
+
+	/* One packet at a time, so that CoDel does not drop any of them */
+	for (i = 0; i < SHAPER_PKTS; i++) {
+		queue_pkt(PORT_SHAPER, PKT_LEN);
+		wait_sent(1);
+	}
+
+	zassert_equal(net_if_tx_shaper_set(iface, tc, 0, 0), 0,
+		      "Cannot clear shaper");
+
+	/* The burst lets the first packet through right away */
+	expected = (SHAPER_PKTS - 1) * PKT_LEN * MSEC_PER_SEC / SHAPER_RATE;
+	elapsed = sent_time[SHAPER_PKTS - 1] - sent_time[0];
+
+	zassert_within(elapsed, expected, expected / 10,
+		       "Wrong rate, %u ms instead of %u ms", elapsed, expected);
+	zassert_true(GET_STAT(iface, qdisc.tc[tc].shaped) > shaped,
+		     "Shaper not counted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tx_qdisc,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_drr_fairness),
+			 ztest_unit_test(test_overlimit_drop),
+			 ztest_unit_test(test_codel_drop),
+			 ztest_unit_test(test_shaper_rate)
+			 );
+
+	ztest_run_test_suite(net_tx_qdisc);
+}